@@ -45,37 +45,57 @@
 #include <utility/logger.h>
 #include <yave_app/app.h>
 
+#include <algorithm>
+#include <filesystem>
 #include <memory>
 
-yave::Object GltfModelApp::buildModel(
-    const yave::GltfModel& model, yave::AssetLoader& loader, yave::ModelTransform& transform)
+yave::Object GltfModelApp::buildNode(
+    yave::NodeInstance& node, yave::AssetLoader& loader, yave::ModelTransform& transform)
 {
+    if (!node.hasMesh())
+    {
+        return {};
+    }
+
     yave::RenderableManager* rendManager = engine_->getRenderManager();
     yave::Renderable* renderable = engine_->createRenderable();
     yave::ObjectManager* objManager = engine_->getObjectManager();
     yave::Object obj = objManager->createObject();
     scene_->addObject(obj);
 
-    size_t primCount = 0;
-    for (auto& node : model.nodes)
-    {
-        primCount += node->getMesh()->primitives_.size();
-    }
+    yave::ModelMesh* mesh = node.getMesh();
+    yave::ModelMaterial* material = mesh->material_.get();
+
+    // each primitive has its own index buffer as the index type depends on
+    // the primitive's vertex count, so is drawn separately
+    const size_t primCount = mesh->primitives_.size();
     renderable->setPrimitiveCount(primCount);
 
-    materials.resize(primCount);
-    for (size_t idx = 0; idx < primCount; ++idx)
+    // load the textures and upload to the gpu - the images are decoded in
+    // parallel and uploaded as a single batch. The textures are shared by
+    // the materials of all primitives.
+    std::vector<yave::Texture*> textures;
+    if (material)
     {
-        materials[idx] = rendManager->createMaterial();
+        std::vector<std::filesystem::path> texturePaths;
+        texturePaths.reserve(material->textures_.size());
+        for (const auto& info : material->textures_)
+        {
+            texturePaths.emplace_back(info.texturePath);
+        }
+        textures = loader.loadFromFiles(texturePaths, backend::TextureFormat::RGBA8);
     }
 
-    int primIdx = 0;
-    for (auto& node : model.nodes)
-    {
-        yave::ModelMesh* mesh = node->getMesh();
-        yave::ModelMaterial* material = mesh->material_.get();
+    // the program state (index type, vertex offset) is held by the material,
+    // so each primitive requires its own
+    auto createMaterial = [&]() {
+        yave::Material* mat = rendManager->createMaterial();
+        materials.emplace_back(mat);
+        if (!material)
+        {
+            return mat;
+        }
 
-        yave::Material* mat = materials[primIdx];
         mat->setPipeline(mat->convertPipeline(material->pipeline_));
 
         yave::Material::MaterialFactors factors;
@@ -97,70 +117,147 @@ yave::Object GltfModelApp::buildModel(
             backend::samplerFilterToYave(material->sampler_.minFilter),
             backend::samplerWrapModeToYave(material->sampler_.addressModeU));
 
-        // load the textures and upload to the gpu
-        for (const auto& info : material->textures_)
+        for (size_t idx = 0; idx < textures.size(); ++idx)
         {
-            yave::Texture* tex =
-                loader.loadFromFile(info.texturePath, backend::TextureFormat::RGBA8);
+            if (!textures[idx])
+            {
+                continue;
+            }
             mat->addTexture(
                 engine_,
-                tex,
-                mat->convertImageType(info.type),
+                textures[idx],
+                mat->convertImageType(material->textures_[idx].type),
                 backend::ShaderStage::Fragment,
                 sampler);
         }
-
-        yave::VertexBuffer* vBuffer = engine_->createVertexBuffer();
-        yave::IndexBuffer* iBuffer = engine_->createIndexBuffer();
-        yave::RenderPrimitive* prim = engine_->createRenderPrimitive();
-
+        return mat;
+    };
+
+    // all primitives share the one vertex buffer
+    yave::VertexBuffer* vBuffer = engine_->createVertexBuffer();
+
+    // the mesh attributes are in binding order - their formats depend on
+    // whether the mesh has been quantised
+    const auto& attributes = mesh->vertices_.attributes;
+    size_t attrIdx = 0;
+    vBuffer->addAttribute(
+        yave::VertexBuffer::BindingType::Position,
+        backend::vertexAttributeToYave(attributes[attrIdx++]));
+
+    auto meshVariants = mesh->variantBits_;
+    if (meshVariants.testBit(yave::ModelMesh::Variant::HasUv))
+    {
         vBuffer->addAttribute(
-            yave::VertexBuffer::BindingType::Position, backend::BufferElementType::Float3);
+            yave::VertexBuffer::BindingType::Uv,
+            backend::vertexAttributeToYave(attributes[attrIdx++]));
+    }
+    if (meshVariants.testBit(yave::ModelMesh::Variant::HasNormal))
+    {
+        vBuffer->addAttribute(
+            yave::VertexBuffer::BindingType::Normal,
+            backend::vertexAttributeToYave(attributes[attrIdx++]));
+    }
+    if (meshVariants.testBit(yave::ModelMesh::Variant::HasWeight))
+    {
+        vBuffer->addAttribute(
+            yave::VertexBuffer::BindingType::Weight,
+            backend::vertexAttributeToYave(attributes[attrIdx++]));
+    }
+    if (meshVariants.testBit(yave::ModelMesh::Variant::HasJoint))
+    {
+        vBuffer->addAttribute(
+            yave::VertexBuffer::BindingType::Bones,
+            backend::vertexAttributeToYave(attributes[attrIdx++]));
+    }
+    vBuffer->setPositionDequantisation(mesh->positionOffset_, mesh->positionScale_);
 
-        auto meshVariants = mesh->variantBits_;
-        if (meshVariants.testBit(yave::ModelMesh::Variant::HasUv))
-        {
-            vBuffer->addAttribute(
-                yave::VertexBuffer::BindingType::Uv, backend::BufferElementType::Float2);
-        }
-        if (meshVariants.testBit(yave::ModelMesh::Variant::HasNormal))
-        {
-            vBuffer->addAttribute(
-                yave::VertexBuffer::BindingType::Normal, backend::BufferElementType::Float3);
-        }
-        if (meshVariants.testBit(yave::ModelMesh::Variant::HasWeight))
-        {
-            vBuffer->addAttribute(
-                yave::VertexBuffer::BindingType::Weight, backend::BufferElementType::Float4);
-        }
-        if (meshVariants.testBit(yave::ModelMesh::Variant::HasJoint))
+    // the mesh data is interleaved straight into the staging memory
+    vBuffer->build(engine_, static_cast<uint32_t>(mesh->vertices_.size), [mesh](void* dst) {
+        mesh->writeVertices(dst);
+    });
+
+    // the lod of the renderable is selected using the first primitive, so all
+    // primitives use the largest error of each level over the mesh
+    std::vector<float> lodErrors;
+    for (const auto& meshPrim : mesh->primitives_)
+    {
+        lodErrors.resize(std::max(lodErrors.size(), meshPrim.lods.size()), 0.0f);
+        for (size_t lod = 0; lod < meshPrim.lods.size(); ++lod)
         {
-            vBuffer->addAttribute(
-                yave::VertexBuffer::BindingType::Bones, backend::BufferElementType::Float4);
+            lodErrors[lod] = std::max(lodErrors[lod], meshPrim.lods[lod].error);
         }
-        vBuffer->build(engine_, mesh->vertices_.size, mesh->vertices_.data);
+    }
+
+    for (size_t primIdx = 0; primIdx < primCount; ++primIdx)
+    {
+        const yave::ModelMesh::Primitive& meshPrim = mesh->primitives_[primIdx];
+        yave::IndexBuffer* iBuffer = engine_->createIndexBuffer();
+        yave::RenderPrimitive* prim = engine_->createRenderPrimitive();
+
         iBuffer->build(
             engine_,
-            mesh->indices_.size(),
-            mesh->indices_.data(),
-            backend::IndexBufferType::Uint32);
+            static_cast<uint32_t>(meshPrim.totalIndexCount()),
+            meshPrim.indexType == yave::ModelMesh::IndexType::Uint16
+                ? backend::IndexBufferType::Uint16
+                : backend::IndexBufferType::Uint32,
+            [mesh, primIdx](void* dst) { mesh->writeIndices(primIdx, dst); });
         prim->setVertexBuffer(vBuffer);
         prim->setIndexBuffer(iBuffer);
+        prim->setVertexOffset(static_cast<uint32_t>(meshPrim.vertexBase));
 
         prim->setTopology(backend::primitiveTopologyToYave(mesh->topology_));
-        for (auto const& p : mesh->primitives_)
+        prim->addMeshDrawData(meshPrim.indexCount, 0, 0);
+        for (size_t lod = 1; lod < meshPrim.lods.size(); ++lod)
         {
-            prim->addMeshDrawData(p.indexCount, p.indexPrimitiveOffset, 0);
+            const yave::ModelMesh::Lod& primLod = meshPrim.lods[lod];
+            prim->addLodDrawData(primLod.indexCount, primLod.indexBase, lodErrors[lod]);
         }
-        prim->setMaterial(mat);
+        // the renderable is culled as a whole using the first primitive
+        prim->setDimensions(mesh->dimensions_.min, mesh->dimensions_.max);
+        if (!meshPrim.clusters.empty())
+        {
+            prim->setClusters(meshPrim.clusters);
+        }
+        prim->setMaterial(createMaterial());
         renderable->setPrimitive(prim, primIdx);
-
-        rendManager->build(scene_, renderable, obj, transform);
     }
 
+    rendManager->build(scene_, renderable, obj, transform);
+    prototypes.emplace_back(obj);
+    prototypeTransform = transform;
+
     return obj;
 }
 
+void GltfModelApp::spawnInstances(uint32_t count)
+{
+    constexpr float Spacing = 0.6f;
+
+    yave::RenderableManager* rendManager = engine_->getRenderManager();
+    yave::ObjectManager* objManager = engine_->getObjectManager();
+
+    ++instanceRows;
+    for (uint32_t idx = 0; idx < count; ++idx)
+    {
+        yave::ModelTransform transform = prototypeTransform;
+        transform.translation.x += (static_cast<float>(idx) - 0.5f * (count - 1)) * Spacing;
+        transform.translation.z -= static_cast<float>(instanceRows) * Spacing;
+
+        // tint each instance along the row - the material is still shared
+        const float t = count > 1 ? static_cast<float>(idx) / static_cast<float>(count - 1) : 0.0f;
+        yave::MaterialOverrides overrides;
+        overrides.baseColourFactor = mathfu::vec4 {1.0f, 1.0f - 0.5f * t, 0.5f + 0.5f * t, 1.0f};
+
+        for (const yave::Object& prototype : prototypes)
+        {
+            yave::Object obj = objManager->createObject();
+            scene_->addObject(obj);
+            yave::Renderable* renderable = rendManager->buildInstance(prototype, obj, transform);
+            renderable->setMaterialOverrides(overrides);
+        }
+    }
+}
+
 void GltfModelApp::addLighting(yave::LightManager* lightManager)
 {
     yave::ObjectManager* objManager = engine_->getObjectManager();
@@ -179,6 +276,8 @@ void GltfModelApp::uiCallback(yave::Engine* engine)
     auto* lightManager = engine->getLightManager();
 
     yave::BloomOptions& bloomOptions = scene_->getBloomOptions();
+    yave::LodOptions& lodOptions = scene_->getLodOptions();
+    yave::ClusterCullOptions& cullOptions = scene_->getClusterCullOptions();
 
     ImGui::SetNextWindowSize(ImVec2(300.0f, 500.0f));
     ImGui::Begin("Example settings");
@@ -212,6 +311,31 @@ void GltfModelApp::uiCallback(yave::Engine* engine)
             ImGui::SliderFloat("gamma", &bloomOptions.gamma, 0.0f, 5.0f);
             ImGui::Unindent();
         }
+        if (ImGui::CollapsingHeader("Level of detail"))
+        {
+            ImGui::Indent();
+            ImGui::Checkbox("Enabled##lod", &lodOptions.enabled);
+            ImGui::SliderFloat("Bias##lod", &lodOptions.bias, 0.1f, 10.0f);
+            ImGui::Unindent();
+        }
+        if (ImGui::CollapsingHeader("Cluster culling"))
+        {
+            ImGui::Indent();
+            ImGui::Checkbox("Enabled##cluster", &cullOptions.enabled);
+            ImGui::Checkbox("Back-face culling##cluster", &cullOptions.backfaceCulling);
+            ImGui::Unindent();
+        }
+        if (ImGui::CollapsingHeader("Instancing"))
+        {
+            ImGui::Indent();
+            ImGui::SliderInt("Per row##instance", &instancesPerRow, 1, 100);
+            if (ImGui::Button("Add row##instance") && !prototypes.empty())
+            {
+                spawnInstances(static_cast<uint32_t>(instancesPerRow));
+            }
+            ImGui::Text("Rows: %u", instanceRows);
+            ImGui::Unindent();
+        }
     }
     ImGui::End();
 
@@ -238,12 +362,15 @@ int main()
 
     // create irradiance/specular maps
     yave::Ibl ibl(app.engine_, YAVE_ASSETS_DIRECTORY);
+    ibl.setCacheDirectory(std::filesystem::temp_directory_path() / "yave" / "ibl_cache");
+    // the diffuse lighting uses spherical harmonics rather than an irradiance map
+    ibl.setIrradianceSh(true);
     if (!ibl.loadEqirectImage("hdr/monoLake.hdr"))
     {
         exit(1);
     }
     yave::IndirectLight* il = app.engine_->createIndirectLight();
-    il->setIrrandianceMap(ibl.getIrradianceMap());
+    il->setIrradianceSh(app.engine_, ibl.getCubeMap());
     il->setSpecularMap(ibl.getSpecularMap(), ibl.getBrdfLut());
     app.scene_->setIndirectLight(il);
 
@@ -265,15 +392,31 @@ int main()
     // add a gltf model to the scene
     yave::GltfModel model;
     model.setDirectory(YAVE_ASSETS_DIRECTORY);
+    model.setLodGeneration(true);
+    model.setClusterGeneration(true);
+    model.setVertexQuantisation(true);
+    // the built model is baked on the first run, and mapped in place of
+    // parsing the gltf file on subsequent runs
+    model.setCacheDirectory(std::filesystem::temp_directory_path() / "yave_model_cache");
     if (!model.load("scenes/teapot.gltf"))
     {
         exit(1);
     }
-    model.build();
 
+    // renderables are created for each node as soon as its mesh has been
+    // built, while the remaining nodes are processed.
     yave::ModelTransform transform;
     transform.translation = {0.0f, 0.2f, -2.0f};
-    app.buildModel(model, loader, transform);
+    model.setProgressCallback([](size_t processed, size_t total) {
+        LOGGER_INFO("Loaded %zu of %zu model nodes.\n", processed, total);
+    });
+    if (!model.build(
+            [&app, &loader, &transform](yave::NodeInstance& node) {
+                app.buildNode(node, loader, transform);
+            }))
+    {
+        exit(1);
+    }
 
     auto lightManager = app.engine_->getLightManager();
 
@@ -44,11 +44,17 @@ public:
 
     GltfModelApp(const yave::AppParams& params, bool showUI) : yave::Application(params, showUI) {}
 
-    yave::Object buildModel(
-        const yave::GltfModel& model, yave::AssetLoader& loader, yave::ModelTransform& transform);
+    // creates a renderable for the mesh of the node - called as each node of
+    // the model becomes ready.
+    yave::Object buildNode(
+        yave::NodeInstance& node, yave::AssetLoader& loader, yave::ModelTransform& transform);
 
     void addLighting(yave::LightManager* lightManager);
 
+    // adds a row of instances of the model, which share the model geometry
+    // and materials.
+    void spawnInstances(uint32_t count);
+
     void uiCallback(yave::Engine* engine) override;
 
     bool showDirLight = true;
@@ -61,4 +67,12 @@ public:
     yave::Object spotLightObj;
 
     std::vector<yave::Material*> materials;
+
+    // the Objects created for each node of the model, and the transform the
+    // model was added with - instances are created from these
+    std::vector<yave::Object> prototypes;
+    yave::ModelTransform prototypeTransform;
+
+    uint32_t instanceRows = 0;
+    int instancesPerRow = 10;
 };
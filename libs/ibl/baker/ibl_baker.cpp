@@ -0,0 +1,105 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "ibl/ibl.h"
+#include "utility/logger.h"
+#include "yave_app/app.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+namespace
+{
+
+void printUsage()
+{
+    printf(
+        "Usage: YaveIblBaker <image.hdr> <cache directory> [options]\n"
+        "Pre-filters the equirectangular environment map and writes the cube map,\n"
+        "irradiance map, specular map and BRDF lut to the cache directory as KTX2\n"
+        "files. These are loaded by Ibl when the same cache directory is set and\n"
+        "the image and options match. A window is briefly opened to create the\n"
+        "device.\n\n"
+        "Options:\n"
+        "    --brdf-samples <n>        BRDF integration sample count (default 1024).\n"
+        "    --specular-samples <n>    Specular convolution sample count (default 32).\n"
+        "    --specular-levels <n>     Specular map mip level count (default 5).\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    const std::filesystem::path imagePath = argv[1];
+    const std::filesystem::path cacheDir = argv[2];
+
+    yave::PreFilter::Options options;
+    for (int i = 3; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--brdf-samples") && i + 1 < argc)
+        {
+            options.brdfSampleCount = std::max(atoi(argv[++i]), 1);
+        }
+        else if (!strcmp(argv[i], "--specular-samples") && i + 1 < argc)
+        {
+            options.specularSampleCount = std::max(atoi(argv[++i]), 1);
+        }
+        else if (!strcmp(argv[i], "--specular-levels") && i + 1 < argc)
+        {
+            options.specularLevelCount = std::max(atoi(argv[++i]), 1);
+        }
+        else
+        {
+            LOGGER_ERROR("Unknown option: %s\n", argv[i]);
+            printUsage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    yave::AppParams params {"ibl baker", 64, 64};
+    yave::Application app(params, false);
+
+    yave::Ibl ibl(app.getEngine());
+    ibl.setOptions(options);
+    ibl.setCacheDirectory(cacheDir);
+    if (!ibl.loadEqirectImage(imagePath))
+    {
+        return EXIT_FAILURE;
+    }
+
+    printf(
+        "%s %s in %s\n",
+        ibl.isCached() ? "Found existing bake of" : "Baked",
+        imagePath.string().c_str(),
+        cacheDir.string().c_str());
+    return EXIT_SUCCESS;
+}
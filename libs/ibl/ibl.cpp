@@ -22,18 +22,32 @@
 
 #include "ibl.h"
 
+#include "ibl_cache.h"
 #include "prefilter.h"
 
 #include <spdlog/spdlog.h>
 #include <stb_image.h>
+#include <utility/assertion.h>
 #include <yave/engine.h>
 #include <yave/texture.h>
 
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
 namespace yave
 {
 
 Ibl::Ibl(Engine* engine, const std::filesystem::path& assetPath)
-    : engine_(engine), assetPath_(assetPath)
+    : engine_(engine),
+      cubeMap_(nullptr),
+      irradianceMap_(nullptr),
+      specularMap_(nullptr),
+      brdfLut_(nullptr),
+      assetPath_(assetPath),
+      irradianceSh_(false),
+      cached_(false)
 {
 }
 
@@ -48,29 +62,50 @@ bool Ibl::loadEqirectImage(const std::filesystem::path& path)
     }
     auto platformPath = imagePath.make_preferred();
 
-    int width, height, comp;
-    float* data = stbi_loadf(platformPath.string().c_str(), &width, &height, &comp, 3);
-    if (!data)
+    // the file contents are needed to key the cache, so the image is decoded
+    // from memory rather than reading the file twice
+    std::ifstream file(platformPath, std::ios::binary);
+    if (!file.is_open())
     {
         SPDLOG_CRITICAL("Unable to load image at path {}.", platformPath.string().c_str());
         return false;
     }
+    std::vector<uint8_t> fileData(
+        (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    uint32_t cacheKey = 0;
+    cached_ = false;
+    if (!cacheDir_.empty())
+    {
+        cacheKey = IblCache::createKey(fileData, options_);
+        if (loadFromCache(cacheKey))
+        {
+            SPDLOG_INFO("Loaded pre-filtered ibl maps for {} from the cache.", path.string());
+            cached_ = true;
+            return true;
+        }
+    }
 
-    if (!stbi_is_hdr(platformPath.string().c_str()))
+    const auto fileSize = static_cast<int>(fileData.size());
+    if (!stbi_is_hdr_from_memory(fileData.data(), fileSize))
     {
         SPDLOG_ERROR("Imge must be in the hdr format for ibl.");
         return false;
     }
 
+    int width, height, comp;
+    float* data = stbi_loadf_from_memory(fileData.data(), fileSize, &width, &height, &comp, 3);
+    if (!data)
+    {
+        SPDLOG_CRITICAL("Unable to load image at path {}.", platformPath.string().c_str());
+        return false;
+    }
+
     ASSERT_FATAL(comp == 3, "Image must contain 3 channels (rgb). This image contains: %d", comp);
 
     // We don't really want to work with RGB as this format isn't supported widely
     // by graphic card vendors so add an extra channel if we only have three.
-    uint32_t oldSize = width * height * 3;
-    uint32_t newSize = width * height * 4;
-    float* newData = new float[newSize];
-    ASSERT_LOG(newData);
-
+    std::vector<float> newData(width * height * 4);
     for (int i = 0; i < height; ++i)
     {
         for (int j = 0; j < width; ++j)
@@ -80,17 +115,16 @@ bool Ibl::loadEqirectImage(const std::filesystem::path& path)
 
             float newPixel[4] = {
                 data[oldPixelIdx], data[oldPixelIdx + 1], data[oldPixelIdx + 2], 1.0f};
-            memcpy(newData + newPixelIdx, newPixel, sizeof(float) * 4);
+            memcpy(newData.data() + newPixelIdx, newPixel, sizeof(float) * 4);
         }
     }
     stbi_image_free(data);
-    data = newData;
 
     uint32_t dataSizeBytes = width * height * 4 * sizeof(float);
 
     Texture* tex = engine_->createTexture();
     Texture::Params params {
-        data,
+        newData.data(),
         dataSizeBytes,
         static_cast<uint32_t>(width),
         static_cast<uint32_t>(height),
@@ -98,17 +132,62 @@ bool Ibl::loadEqirectImage(const std::filesystem::path& path)
         backend::ImageUsage::Sampled};
     tex->setTexture(params);
 
-    stbi_image_free(data);
-
-    PreFilter preIbl(engine_, {});
+    PreFilter preIbl(engine_, options_);
 
     // create a cubemap from a eqirectangular env map
     cubeMap_ = preIbl.eqirectToCubemap(tex);
-    irradianceMap_ = preIbl.createIrradianceEnvMap(cubeMap_);
+    irradianceMap_ = irradianceSh_ ? nullptr : preIbl.createIrradianceEnvMap(cubeMap_);
     specularMap_ = preIbl.createSpecularEnvMap(cubeMap_);
     brdfLut_ = preIbl.createBrdfLut();
 
+    if (!cacheDir_.empty())
+    {
+        storeToCache(cacheKey);
+    }
+
+    return true;
+}
+
+bool Ibl::loadFromCache(uint32_t key)
+{
+    IblCache cache(cacheDir_);
+    if (!cache.contains(key, !irradianceSh_))
+    {
+        return false;
+    }
+
+    Texture* cubeMap = cache.load(engine_, key, IblCache::Map::CubeMap);
+    Texture* irradianceMap =
+        irradianceSh_ ? nullptr : cache.load(engine_, key, IblCache::Map::Irradiance);
+    Texture* specularMap = cache.load(engine_, key, IblCache::Map::Specular);
+    Texture* brdfLut = cache.load(engine_, key, IblCache::Map::BrdfLut);
+    if (!cubeMap || (!irradianceMap && !irradianceSh_) || !specularMap || !brdfLut)
+    {
+        SPDLOG_WARN("Ibl cache entry {:08x} is incomplete - regenerating the maps.", key);
+        return false;
+    }
+
+    cubeMap_ = cubeMap;
+    irradianceMap_ = irradianceMap;
+    specularMap_ = specularMap;
+    brdfLut_ = brdfLut;
     return true;
 }
 
-} // namespace yave
\ No newline at end of file
+void Ibl::storeToCache(uint32_t key)
+{
+    IblCache cache(cacheDir_);
+    bool success = cache.store(key, IblCache::Map::CubeMap, cubeMap_);
+    if (irradianceMap_)
+    {
+        success &= cache.store(key, IblCache::Map::Irradiance, irradianceMap_);
+    }
+    success &= cache.store(key, IblCache::Map::Specular, specularMap_);
+    success &= cache.store(key, IblCache::Map::BrdfLut, brdfLut_);
+    if (!success)
+    {
+        SPDLOG_WARN("Unable to write the pre-filtered ibl maps to {}.", cacheDir_.string());
+    }
+}
+
+} // namespace yave
@@ -22,6 +22,9 @@
 
 #pragma once
 
+#include "prefilter.h"
+
+#include <cstdint>
 #include <filesystem>
 
 namespace yave
@@ -35,14 +38,34 @@ public:
     Ibl(Engine* engine, const std::filesystem::path& assetPath = "");
     ~Ibl();
 
+    // Enables the on-disk cache - the pre-filtered maps are written to the
+    // directory after they are generated and are loaded from it on later runs.
+    void setCacheDirectory(const std::filesystem::path& cacheDir) { cacheDir_ = cacheDir; }
+
+    void setOptions(const PreFilter::Options& options) noexcept { options_ = options; }
+
+    // When set, the irradiance map isn't generated - the diffuse lighting is
+    // instead projected from the cube map onto spherical harmonics with
+    // IndirectLight::setIrradianceSh().
+    void setIrradianceSh(bool enable) noexcept { irradianceSh_ = enable; }
+
     bool loadEqirectImage(const std::filesystem::path& path);
 
+    // Whether the maps from the last call to loadEqirectImage() were loaded
+    // from the cache.
+    [[nodiscard]] bool isCached() const noexcept { return cached_; }
+
     Texture* getCubeMap() noexcept { return cubeMap_; }
 
     Texture* getIrradianceMap() noexcept { return irradianceMap_; }
     Texture* getSpecularMap() noexcept { return specularMap_; }
     Texture* getBrdfLut() noexcept { return brdfLut_; }
 
+private:
+    bool loadFromCache(uint32_t key);
+
+    void storeToCache(uint32_t key);
+
 private:
     Engine* engine_;
 
@@ -52,6 +75,11 @@ private:
     Texture* brdfLut_;
 
     std::filesystem::path assetPath_;
+    std::filesystem::path cacheDir_;
+
+    PreFilter::Options options_;
+    bool irradianceSh_;
+    bool cached_;
 };
 
 } // namespace yave
\ No newline at end of file
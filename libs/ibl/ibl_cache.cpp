@@ -0,0 +1,216 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "ibl_cache.h"
+
+#include <backend/convert_to_vk.h>
+#include <backend/enums.h>
+#include <ktx.h>
+#include <spdlog/spdlog.h>
+#include <utility/assertion.h>
+#include <utility/murmurhash.h>
+#include <yave/engine.h>
+#include <yave/texture.h>
+
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+namespace yave
+{
+
+namespace
+{
+
+struct MapInfo
+{
+    const char* name;
+    // must match the format the pre-filter renders the map into
+    backend::TextureFormat format;
+};
+
+constexpr std::array<MapInfo, static_cast<size_t>(IblCache::Map::Count)> MapInfos = {
+    {{"cubemap", backend::TextureFormat::RGBA32F},
+     {"irradiance", backend::TextureFormat::RGBA32F},
+     {"specular", backend::TextureFormat::RGBA16F},
+     {"brdf_lut", backend::TextureFormat::RGBA16F}}};
+
+const MapInfo& getMapInfo(IblCache::Map map) { return MapInfos[static_cast<size_t>(map)]; }
+
+} // namespace
+
+IblCache::IblCache(const std::filesystem::path& cacheDir) : cacheDir_(cacheDir) {}
+
+uint32_t
+IblCache::createKey(const std::vector<uint8_t>& imageData, const PreFilter::Options& options)
+{
+    // the hasher works on whole words, so the data is padded with zeros
+    std::vector<uint32_t> words((imageData.size() + 3) / 4 + 1, 0);
+    memcpy(words.data(), imageData.data(), imageData.size());
+    uint32_t hash = util::murmurHash3(words.data(), words.size() * sizeof(uint32_t), Version);
+
+    const uint32_t optionWords[] = {
+        static_cast<uint32_t>(options.brdfSampleCount),
+        static_cast<uint32_t>(options.specularSampleCount),
+        static_cast<uint32_t>(options.specularLevelCount)};
+    return util::murmurHash3(optionWords, sizeof(optionWords), hash);
+}
+
+std::filesystem::path IblCache::getPath(uint32_t key, Map map) const
+{
+    std::stringstream ss;
+    ss << std::hex << std::setw(8) << std::setfill('0') << key << "_" << getMapInfo(map).name
+       << ".ktx2";
+    return cacheDir_ / ss.str();
+}
+
+bool IblCache::contains(uint32_t key, bool withIrradiance) const
+{
+    for (size_t i = 0; i < static_cast<size_t>(Map::Count); ++i)
+    {
+        if (!withIrradiance && static_cast<Map>(i) == Map::Irradiance)
+        {
+            continue;
+        }
+        std::error_code ec;
+        if (!std::filesystem::exists(getPath(key, static_cast<Map>(i)), ec))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+Texture* IblCache::load(Engine* engine, uint32_t key, Map map) const
+{
+    const std::filesystem::path path = getPath(key, map);
+
+    ktxTexture* ktx;
+    KTX_error_code result = ktxTexture_CreateFromNamedFile(
+        path.string().c_str(), KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &ktx);
+    if (result != KTX_SUCCESS)
+    {
+        SPDLOG_WARN("Unable to load cached ibl map {}: {}", path.string(), ktxErrorString(result));
+        return nullptr;
+    }
+
+    // the offsets of each face and level, as expected by the texture upload
+    std::vector<size_t> offsets(ktx->numFaces * ktx->numLevels);
+    for (uint32_t face = 0; face < ktx->numFaces; ++face)
+    {
+        for (uint32_t level = 0; level < ktx->numLevels; ++level)
+        {
+            ktx_size_t offset;
+            ktxTexture_GetImageOffset(ktx, level, 0, face, &offset);
+            offsets[face * ktx->numLevels + level] = offset;
+        }
+    }
+
+    Texture::Params params;
+    params.buffer = ktxTexture_GetData(ktx);
+    params.bufferSize = ktxTexture_GetDataSize(ktx);
+    params.width = ktx->baseWidth;
+    params.height = ktx->baseHeight;
+    params.format = getMapInfo(map).format;
+    params.usageFlags = backend::ImageUsage::Sampled;
+    params.levels = ktx->numLevels;
+    params.faces = ktx->numFaces;
+
+    Texture* texture = engine->createTexture();
+    texture->setTexture(params, offsets.data());
+    ktxTexture_Destroy(ktx);
+
+    return texture;
+}
+
+bool IblCache::store(uint32_t key, Map map, Texture* texture) const
+{
+    std::error_code ec;
+    std::filesystem::create_directories(cacheDir_, ec);
+    if (ec)
+    {
+        SPDLOG_WARN("Unable to create ibl cache directory {}.", cacheDir_.string());
+        return false;
+    }
+
+    const Texture::Params texParams = texture->getTextureParams();
+    const std::vector<uint8_t> data = texture->download();
+
+    ktxTextureCreateInfo createInfo = {};
+    createInfo.vkFormat =
+        static_cast<uint32_t>(backend::textureFormatToVk(getMapInfo(map).format));
+    createInfo.baseWidth = texParams.width;
+    createInfo.baseHeight = texParams.height;
+    createInfo.baseDepth = 1;
+    createInfo.numDimensions = 2;
+    createInfo.numLevels = texParams.levels;
+    createInfo.numLayers = 1;
+    createInfo.numFaces = texParams.faces;
+    createInfo.isArray = KTX_FALSE;
+    createInfo.generateMipmaps = KTX_FALSE;
+
+    ktxTexture2* ktx;
+    KTX_error_code result = ktxTexture2_Create(&createInfo, KTX_TEXTURE_CREATE_ALLOC_STORAGE, &ktx);
+    if (result != KTX_SUCCESS)
+    {
+        SPDLOG_WARN("Unable to create ktx texture: {}", ktxErrorString(result));
+        return false;
+    }
+
+    // the downloaded data is packed by face and then level
+    size_t offset = 0;
+    for (uint32_t face = 0; face < texParams.faces; ++face)
+    {
+        for (uint32_t level = 0; level < texParams.levels; ++level)
+        {
+            const size_t levelSize = ktxTexture_GetImageSize(ktxTexture(ktx), level);
+            ASSERT_FATAL(offset + levelSize <= data.size(), "Downloaded texture is truncated.");
+            result = ktxTexture_SetImageFromMemory(
+                ktxTexture(ktx), level, 0, face, data.data() + offset, levelSize);
+            if (result != KTX_SUCCESS)
+            {
+                SPDLOG_WARN("Unable to set ktx image data: {}", ktxErrorString(result));
+                ktxTexture_Destroy(ktxTexture(ktx));
+                return false;
+            }
+            offset += levelSize;
+        }
+    }
+
+    // written to a temporary file first so a partially written entry is never
+    // picked up by a later run
+    const std::filesystem::path path = getPath(key, map);
+    std::filesystem::path tmpPath = path;
+    tmpPath += ".tmp";
+    result = ktxTexture_WriteToNamedFile(ktxTexture(ktx), tmpPath.string().c_str());
+    ktxTexture_Destroy(ktxTexture(ktx));
+    if (result != KTX_SUCCESS)
+    {
+        SPDLOG_WARN("Unable to write {}: {}", tmpPath.string(), ktxErrorString(result));
+        return false;
+    }
+    std::filesystem::rename(tmpPath, path, ec);
+    return !ec;
+}
+
+} // namespace yave
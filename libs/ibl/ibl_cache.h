@@ -0,0 +1,81 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "prefilter.h"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace yave
+{
+class Engine;
+class Texture;
+
+/**
+ * @brief An on-disk cache of the PreFilter outputs, stored as KTX files. The
+ * entries are keyed by a hash of the source image contents and the pre-filter
+ * options, so a change to either results in a new bake rather than a stale
+ * entry.
+ */
+class IblCache
+{
+public:
+    // The maps stored for each entry.
+    enum class Map
+    {
+        CubeMap,
+        Irradiance,
+        Specular,
+        BrdfLut,
+        Count
+    };
+
+    // Bumped when the layout of the entries or pre-filter shaders change.
+    static constexpr uint32_t Version = 2;
+
+    explicit IblCache(const std::filesystem::path& cacheDir);
+
+    static uint32_t
+    createKey(const std::vector<uint8_t>& imageData, const PreFilter::Options& options);
+
+    // Whether all of the maps for the key have been stored. The irradiance
+    // map isn't required when using spherical harmonic irradiance.
+    [[nodiscard]] bool contains(uint32_t key, bool withIrradiance = true) const;
+
+    // Returns nullptr if the map can't be loaded.
+    Texture* load(Engine* engine, uint32_t key, Map map) const;
+
+    // Downloads the texture from the gpu and writes it to the cache.
+    bool store(uint32_t key, Map map, Texture* texture) const;
+
+    [[nodiscard]] std::filesystem::path getPath(uint32_t key, Map map) const;
+
+private:
+    std::filesystem::path cacheDir_;
+};
+
+} // namespace yave
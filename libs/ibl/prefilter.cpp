@@ -273,88 +273,18 @@ Texture* PreFilter::createSpecularEnvMap(Texture* cubeMap)
 {
     ASSERT_FATAL(cubeMap, "Cubemap image is nullptr!");
 
-    float roughness = 0.0f;
-
-    RenderableManager* rManager = engine_->getRenderManager();
-    ObjectManager* objManager = engine_->getObjectManager();
-    Object obj = objManager->createObject();
-    Material* mat = rManager->createMaterial();
-
-    scene_->addObject(obj);
-
-    TextureSampler cubeSampler(
-        backend::SamplerFilter::Linear,
-        backend::SamplerFilter::Linear,
-        backend::SamplerAddressMode::ClampToEdge,
-        16.0f);
-
-    std::array<mathfu::mat4, 6> faceViews;
-    CubeMap::createFaceViews(faceViews);
-    mat->addUboArrayParam(
-        "faceViews",
-        backend::BufferElementType::Mat4,
-        6,
-        backend::ShaderStage::Vertex,
-        faceViews.data());
-    mat->addUboParam(
-        "sampleCount",
-        backend::BufferElementType::Int,
-        backend::ShaderStage::Fragment,
-        &options_.specularSampleCount);
-    mat->addUboParam(
-        "roughness", backend::BufferElementType::Float, backend::ShaderStage::Fragment, &roughness);
-    mat->addTexture(
-        engine_,
-        cubeMap,
-        Material::ImageType::BaseColour,
-        backend::ShaderStage::Fragment,
-        cubeSampler);
-    prim_->setMaterial(mat);
-
-    Renderable* render = engine_->createRenderable();
-    render->setPrimitiveCount(1);
-    render->setPrimitive(prim_, 0);
-    render->skipVisibilityChecks();
-
-    rManager->build(scene_, render, obj, {}, "specular.glsl");
-
-    // create the irradiance cubemap texture to render into
+    // all faces and levels are filtered with a single compute dispatch
     Texture* cubeTex = engine_->createTexture();
     cubeTex->setEmptyTexture(
         512,
         512,
         backend::TextureFormat::RGBA16F,
-        backend::ImageUsage::ColourAttach | backend::ImageUsage::Sampled,
+        backend::ImageUsage::Storage | backend::ImageUsage::Sampled,
         options_.specularLevelCount,
         6);
 
-    // set the empty cube map as the render target for our draws
-    RenderTarget rt;
-    rt.setColourTexture(cubeTex, 0);
-    rt.setLoadFlags(backend::LoadClearFlags::Clear, 0);
-    rt.setStoreFlags(backend::StoreClearFlags::Store, 0);
-
-    // Render each cubemap mip level (faces are drawn in one call with multiview)
-    uint32_t maxMipLevels = cubeTex->getTextureParams().levels;
-    uint32_t dim = cubeTex->getTextureParams().width;
-
-    for (int level = 0; level < maxMipLevels; ++level)
-    {
-        rt.setMipLevel(level, 0);
-        rt.build(engine_, "specular_target", true);
-        mat->setViewport(dim, dim, 0, 0);
-
-        roughness = static_cast<float>(level - (maxMipLevels - 1));
-        mat->updateUboParam("roughness", backend::ShaderStage::Fragment, &roughness);
-
-        renderer_->renderSingleScene(engine_, scene_, rt);
-        engine_->deleteRenderTarget(rt.getHandle());
-        dim >>= 1;
-    }
-
-    scene_->destroyObject(obj);
-    rManager->destroy(mat);
-    engine_->destroy(render);
+    cubeTex->prefilterSpecular(cubeMap, options_.specularSampleCount);
+    engine_->flushCmds();
 
     return cubeTex;
 }
@@ -43,6 +43,7 @@ public:
     {
         int brdfSampleCount = 1024;
 
+        // the sample count at a roughness of one - smoother levels use fewer
         int specularSampleCount = 32;
         int specularLevelCount = 5;
     };
@@ -69,7 +70,7 @@ private:
     VertexBuffer* vBuffer;
     IndexBuffer* iBuffer;
 
-    const Options& options_;
+    Options options_;
 };
 
 } // namespace yave
\ No newline at end of file
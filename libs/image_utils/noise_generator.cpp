@@ -23,15 +23,111 @@
 
 #include "noise_generator.h"
 
-#include <utility/colour.h>
+#include <tbb/tbb.h>
+#include <utility/assertion.h>
+#include <utility/simd.h>
 
 #include <algorithm>
-#include <cstdlib>
+#include <cmath>
+#include <limits>
 #include <numeric>
 #include <random>
+#include <type_traits>
 
 namespace yave
 {
+
+namespace
+{
+
+constexpr uint32_t RowGrainSize = 8;
+
+// The gradients selected by the lower four bits of a hash - the twelve edges
+// of a cube, with four repeated to avoid a modulo.
+constexpr float Gradients[16][3] = {
+    {1.0f, 1.0f, 0.0f},
+    {-1.0f, 1.0f, 0.0f},
+    {1.0f, -1.0f, 0.0f},
+    {-1.0f, -1.0f, 0.0f},
+    {1.0f, 0.0f, 1.0f},
+    {-1.0f, 0.0f, 1.0f},
+    {1.0f, 0.0f, -1.0f},
+    {-1.0f, 0.0f, -1.0f},
+    {0.0f, 1.0f, 1.0f},
+    {0.0f, -1.0f, 1.0f},
+    {0.0f, 1.0f, -1.0f},
+    {0.0f, -1.0f, -1.0f},
+    {1.0f, 1.0f, 0.0f},
+    {0.0f, -1.0f, 1.0f},
+    {-1.0f, 1.0f, 0.0f},
+    {0.0f, -1.0f, -1.0f}};
+
+// the skew factors between the simplex and cubic lattices
+constexpr float F3 = 1.0f / 3.0f;
+constexpr float G3 = 1.0f / 6.0f;
+
+// The noise kernels are written against the SIMD wrappers, which fall back to
+// evaluating a single lane at a time.
+using namespace util::simd;
+
+// the comparisons return 1.0 where true, otherwise 0.0
+inline VecF geF(VecF a, VecF b) noexcept
+{
+    return asFloat(andI(cmpGeF(a, b), asInt(splatF(1.0f))));
+}
+inline VecF gtF(VecF a, VecF b) noexcept
+{
+    return asFloat(andI(cmpGtF(a, b), asInt(splatF(1.0f))));
+}
+
+static_assert(NoiseGenerator::BatchSize % Width == 0, "Batch must be a multiple of the width");
+
+inline VecF lerpF(VecF t, VecF a, VecF b) noexcept { return addF(a, mulF(t, subF(b, a))); }
+
+// 6t^5 - 15t^4 + 10t^3
+inline VecF fadeF(VecF t) noexcept
+{
+    const VecF inner = addF(mulF(t, subF(mulF(t, splatF(6.0f)), splatF(15.0f))), splatF(10.0f));
+    return mulF(mulF(mulF(t, t), t), inner);
+}
+
+inline VecF dotF(const float* g, VecF x, VecF y, VecF z) noexcept
+{
+    return addF(
+        addF(mulF(loadF(g), x), mulF(loadF(g + Width), y)), mulF(loadF(g + 2 * Width), z));
+}
+
+// the gradient components of each lane for a lattice corner, laid out as
+// x[Width], y[Width], z[Width]
+struct CornerGradients
+{
+    alignas(16) float data[3 * Width];
+};
+
+inline void setGradient(CornerGradients& corner, uint32_t lane, int hash) noexcept
+{
+    const float* g = Gradients[hash & 15];
+    corner.data[lane] = g[0];
+    corner.data[Width + lane] = g[1];
+    corner.data[2 * Width + lane] = g[2];
+}
+
+inline float clamp01(float value) noexcept { return std::min(std::max(value, 0.0f), 1.0f); }
+
+inline void toTexel(float value, float* dst) noexcept { *dst = value; }
+inline void toTexel(float value, uint8_t* dst) noexcept
+{
+    *dst = static_cast<uint8_t>(value * 255.0f + 0.5f);
+}
+
+template <typename TYPE>
+constexpr TYPE alphaOne() noexcept
+{
+    return std::is_floating_point_v<TYPE> ? TYPE(1) : std::numeric_limits<TYPE>::max();
+}
+
+} // namespace
+
 NoiseGenerator::NoiseGenerator(uint32_t seed)
 {
     permutations_.resize(256);
@@ -47,61 +143,344 @@ NoiseGenerator::NoiseGenerator(uint32_t seed)
 
 NoiseGenerator::~NoiseGenerator() = default;
 
-double NoiseGenerator::fade(double t) { return t * t * t * (t * (t * 6 - 15) + 10); }
-
-double NoiseGenerator::lerp(double t, double a, double b) { return a + t * (b - a); }
-
-double NoiseGenerator::grad(int hash, double x, double y, double z)
+float NoiseGenerator::generateNoise(float x, float y, float z) const noexcept
 {
-    int h = hash & 15;
-    // Convert lower 4 bits of hash into 12 gradient directions
-    double u = h < 8 ? x : y, v = h < 4 ? y : h == 12 || h == 14 ? x : z;
-    return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
+    float xs[BatchSize] = {x};
+    float ys[BatchSize] = {y};
+    float zs[BatchSize] = {z};
+    float out[BatchSize];
+    perlin(xs, ys, zs, out);
+    return (out[0] + 1.0f) * 0.5f;
 }
 
-double NoiseGenerator::generateNoise(double x, double y, double z)
+void NoiseGenerator::perlin(
+    const float* x, const float* y, const float* z, float* out, uint32_t period) const noexcept
 {
-    int X = (int)floor(x) & 0xFF;
-    int Y = (int)floor(y) & 0xFF;
-    int Z = (int)floor(z) & 0xFF;
+    ASSERT_LOG(period <= MaxPeriod);
+    const int* perm = permutations_.data();
+
+    for (uint32_t offset = 0; offset < BatchSize; offset += Width)
+    {
+        const VecF px = loadF(x + offset);
+        const VecF py = loadF(y + offset);
+        const VecF pz = loadF(z + offset);
+        const VecF fx = floorF(px);
+        const VecF fy = floorF(py);
+        const VecF fz = floorF(pz);
+
+        alignas(16) int32_t ix[Width];
+        alignas(16) int32_t iy[Width];
+        alignas(16) int32_t iz[Width];
+        storeI(ix, truncate(fx));
+        storeI(iy, truncate(fy));
+        storeI(iz, truncate(fz));
 
-    x -= floor(x);
-    y -= floor(y);
-    z -= floor(z);
+        // Hash the eight corners of each cell - the lookups can't be
+        // vectorised without a gather so are done a lane at a time. Corners
+        // are indexed by x | y << 1 | z << 2.
+        CornerGradients corners[8];
+        for (uint32_t lane = 0; lane < Width; ++lane)
+        {
+            int x0 = ix[lane] & 0xFF, y0 = iy[lane] & 0xFF, z0 = iz[lane] & 0xFF;
+            int x1 = x0 + 1, y1 = y0 + 1, z1 = z0 + 1;
+            if (period)
+            {
+                const int p = static_cast<int>(period);
+                x0 = ((ix[lane] % p) + p) % p;
+                y0 = ((iy[lane] % p) + p) % p;
+                z0 = ((iz[lane] % p) + p) % p;
+                x1 = x0 + 1 == p ? 0 : x0 + 1;
+                y1 = y0 + 1 == p ? 0 : y0 + 1;
+                z1 = z0 + 1 == p ? 0 : z0 + 1;
+            }
+            const int a0 = perm[x0] + y0;
+            const int a1 = perm[x0] + y1;
+            const int b0 = perm[x1] + y0;
+            const int b1 = perm[x1] + y1;
+            setGradient(corners[0], lane, perm[perm[a0] + z0]);
+            setGradient(corners[1], lane, perm[perm[b0] + z0]);
+            setGradient(corners[2], lane, perm[perm[a1] + z0]);
+            setGradient(corners[3], lane, perm[perm[b1] + z0]);
+            setGradient(corners[4], lane, perm[perm[a0] + z1]);
+            setGradient(corners[5], lane, perm[perm[b0] + z1]);
+            setGradient(corners[6], lane, perm[perm[a1] + z1]);
+            setGradient(corners[7], lane, perm[perm[b1] + z1]);
+        }
 
-    // Compute fade curves for each of x, y, z
-    double u = fade(x);
-    double v = fade(y);
-    double w = fade(z);
+        const VecF one = splatF(1.0f);
+        const VecF x0 = subF(px, fx);
+        const VecF y0 = subF(py, fy);
+        const VecF z0 = subF(pz, fz);
+        const VecF x1 = subF(x0, one);
+        const VecF y1 = subF(y0, one);
+        const VecF z1 = subF(z0, one);
 
-    // Hash coordinates of the 8 cube corners
-    int A = permutations_[X] + Y;
-    int AA = permutations_[A] + Z;
-    int AB = permutations_[A + 1] + Z;
-    int B = permutations_[X + 1] + Y;
-    int BA = permutations_[B] + Z;
-    int BB = permutations_[B + 1] + Z;
+        const VecF u = fadeF(x0);
+        const VecF v = fadeF(y0);
+        const VecF w = fadeF(z0);
 
-    // Add blended results from 8 corners of cube
-    double res = lerp(
-        w,
-        lerp(
+        const VecF n0 = lerpF(
             v,
-            lerp(u, grad(permutations_[AA], x, y, z), grad(permutations_[BA], x - 1, y, z)),
-            lerp(
-                u, grad(permutations_[AB], x, y - 1, z), grad(permutations_[BB], x - 1, y - 1, z))),
-        lerp(
+            lerpF(u, dotF(corners[0].data, x0, y0, z0), dotF(corners[1].data, x1, y0, z0)),
+            lerpF(u, dotF(corners[2].data, x0, y1, z0), dotF(corners[3].data, x1, y1, z0)));
+        const VecF n1 = lerpF(
             v,
-            lerp(
-                u,
-                grad(permutations_[AA + 1], x, y, z - 1),
-                grad(permutations_[BA + 1], x - 1, y, z - 1)),
-            lerp(
-                u,
-                grad(permutations_[AB + 1], x, y - 1, z - 1),
-                grad(permutations_[BB + 1], x - 1, y - 1, z - 1))));
-    return (res + 1.0) / 2.0;
+            lerpF(u, dotF(corners[4].data, x0, y0, z1), dotF(corners[5].data, x1, y0, z1)),
+            lerpF(u, dotF(corners[6].data, x0, y1, z1), dotF(corners[7].data, x1, y1, z1)));
+        storeF(out + offset, lerpF(w, n0, n1));
+    }
 }
 
+void NoiseGenerator::simplex(const float* x, const float* y, const float* z, float* out) const
+    noexcept
+{
+    const int* perm = permutations_.data();
+
+    for (uint32_t offset = 0; offset < BatchSize; offset += Width)
+    {
+        const VecF px = loadF(x + offset);
+        const VecF py = loadF(y + offset);
+        const VecF pz = loadF(z + offset);
+
+        // skew the input space to find the simplex cell
+        const VecF s = mulF(addF(addF(px, py), pz), splatF(F3));
+        const VecF fi = floorF(addF(px, s));
+        const VecF fj = floorF(addF(py, s));
+        const VecF fk = floorF(addF(pz, s));
+        const VecF t = mulF(addF(addF(fi, fj), fk), splatF(G3));
+        const VecF x0 = subF(px, subF(fi, t));
+        const VecF y0 = subF(py, subF(fj, t));
+        const VecF z0 = subF(pz, subF(fk, t));
+
+        // Rank the axes by the magnitude of the offset - the second and third
+        // corners step along the largest and then the two largest axes.
+        const VecF rx = addF(geF(x0, y0), geF(x0, z0));
+        const VecF ry = addF(gtF(y0, x0), geF(y0, z0));
+        const VecF rz = addF(gtF(z0, x0), gtF(z0, y0));
+        const VecF one = splatF(1.0f);
+        const VecF two = splatF(2.0f);
+        const VecF i1 = geF(rx, two), j1 = geF(ry, two), k1 = geF(rz, two);
+        const VecF i2 = geF(rx, one), j2 = geF(ry, one), k2 = geF(rz, one);
+
+        alignas(16) int32_t ii[Width], ij[Width], ik[Width];
+        alignas(16) int32_t o1[3][Width], o2[3][Width];
+        storeI(ii, truncate(fi));
+        storeI(ij, truncate(fj));
+        storeI(ik, truncate(fk));
+        storeI(o1[0], truncate(i1));
+        storeI(o1[1], truncate(j1));
+        storeI(o1[2], truncate(k1));
+        storeI(o2[0], truncate(i2));
+        storeI(o2[1], truncate(j2));
+        storeI(o2[2], truncate(k2));
+
+        CornerGradients corners[4];
+        for (uint32_t lane = 0; lane < Width; ++lane)
+        {
+            const int i = ii[lane] & 0xFF;
+            const int j = ij[lane] & 0xFF;
+            const int k = ik[lane] & 0xFF;
+            auto hash = [perm, i, j, k](int di, int dj, int dk) {
+                return perm[perm[perm[i + di] + j + dj] + k + dk];
+            };
+            setGradient(corners[0], lane, hash(0, 0, 0));
+            setGradient(corners[1], lane, hash(o1[0][lane], o1[1][lane], o1[2][lane]));
+            setGradient(corners[2], lane, hash(o2[0][lane], o2[1][lane], o2[2][lane]));
+            setGradient(corners[3], lane, hash(1, 1, 1));
+        }
+
+        const VecF cx[4] = {
+            x0, addF(subF(x0, i1), splatF(G3)), addF(subF(x0, i2), splatF(2.0f * G3)),
+            addF(subF(x0, one), splatF(3.0f * G3))};
+        const VecF cy[4] = {
+            y0, addF(subF(y0, j1), splatF(G3)), addF(subF(y0, j2), splatF(2.0f * G3)),
+            addF(subF(y0, one), splatF(3.0f * G3))};
+        const VecF cz[4] = {
+            z0, addF(subF(z0, k1), splatF(G3)), addF(subF(z0, k2), splatF(2.0f * G3)),
+            addF(subF(z0, one), splatF(3.0f * G3))};
+
+        // sum the radially attenuated contribution of each corner
+        VecF n = splatF(0.0f);
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            VecF atten = subF(
+                splatF(0.6f),
+                addF(addF(mulF(cx[c], cx[c]), mulF(cy[c], cy[c])), mulF(cz[c], cz[c])));
+            atten = maxF(atten, splatF(0.0f));
+            atten = mulF(atten, atten);
+            n = addF(n, mulF(mulF(atten, atten), dotF(corners[c].data, cx[c], cy[c], cz[c])));
+        }
+        storeF(out + offset, mulF(n, splatF(32.0f)));
+    }
+}
+
+void NoiseGenerator::evaluate(
+    const Params& params,
+    const float* x,
+    const float* y,
+    const float* z,
+    float* out,
+    uint32_t period) const noexcept
+{
+    ASSERT_LOG(params.type == Type::Perlin || !period);
+
+    auto base = [&](const float* bx, const float* by, const float* bz, float* bOut, uint32_t p) {
+        if (params.type == Type::Simplex)
+        {
+            simplex(bx, by, bz, bOut);
+            return;
+        }
+        perlin(bx, by, bz, bOut, p);
+    };
+
+    if (params.fractal == Fractal::None)
+    {
+        base(x, y, z, out, period);
+        for (uint32_t i = 0; i < BatchSize; ++i)
+        {
+            out[i] = clamp01(out[i] * 0.5f + 0.5f);
+        }
+        return;
+    }
+
+    float sum[BatchSize] = {};
+    float sx[BatchSize], sy[BatchSize], sz[BatchSize], noise[BatchSize];
+    float amplitude = 1.0f;
+    float totalAmplitude = 0.0f;
+    float frequency = 1.0f;
+    uint32_t octavePeriod = period;
+    const bool ridged = params.fractal == Fractal::Ridged;
+
+    for (uint32_t octave = 0; octave < std::max(params.octaves, 1u); ++octave)
+    {
+        for (uint32_t i = 0; i < BatchSize; ++i)
+        {
+            sx[i] = x[i] * frequency;
+            sy[i] = y[i] * frequency;
+            sz[i] = z[i] * frequency;
+        }
+        base(sx, sy, sz, noise, octavePeriod);
+
+        for (uint32_t i = 0; i < BatchSize; ++i)
+        {
+            float n = noise[i];
+            if (ridged)
+            {
+                n = 1.0f - std::abs(n);
+                n *= n;
+            }
+            sum[i] += n * amplitude;
+        }
+        totalAmplitude += amplitude;
+        amplitude *= params.gain;
+
+        if (period)
+        {
+            // keep a whole number of cells per tile so each octave still wraps
+            const float next = static_cast<float>(period) * frequency * params.lacunarity;
+            octavePeriod = std::clamp(
+                static_cast<uint32_t>(std::lround(next)), 1u, MaxPeriod);
+            frequency = static_cast<float>(octavePeriod) / static_cast<float>(period);
+        }
+        else
+        {
+            frequency *= params.lacunarity;
+        }
+    }
+
+    const float invAmplitude = 1.0f / totalAmplitude;
+    for (uint32_t i = 0; i < BatchSize; ++i)
+    {
+        const float n = sum[i] * invAmplitude;
+        out[i] = clamp01(ridged ? n : n * 0.5f + 0.5f);
+    }
+}
+
+template <typename TYPE>
+void NoiseGenerator::generate(
+    TYPE* data,
+    uint32_t width,
+    uint32_t height,
+    uint32_t depth,
+    uint32_t channels,
+    const Params& params) const
+{
+    ASSERT_FATAL(data, "No destination buffer specified for the noise image.");
+    ASSERT_FATAL(
+        channels > 0 && channels <= 4, "Only r, rg, rgb or rgba channels supported for image gen.");
+    ASSERT_FATAL(
+        !params.tileable || params.type == Type::Perlin,
+        "Tileable noise is only supported with Perlin noise.");
+
+    float frequency = params.frequency;
+    uint32_t period = 0;
+    if (params.tileable)
+    {
+        period = std::clamp(static_cast<uint32_t>(std::lround(frequency)), 1u, MaxPeriod);
+        frequency = static_cast<float>(period);
+    }
+    const float xScale = frequency / static_cast<float>(width);
+    const float yScale = frequency / static_cast<float>(height);
+    const float zScale = frequency / static_cast<float>(depth);
+    const uint32_t noiseChannels = std::min(channels, 3u);
+
+    tbb::parallel_for(
+        tbb::blocked_range<uint32_t>(0, height * depth, RowGrainSize),
+        [&](const tbb::blocked_range<uint32_t>& range) {
+            float x[BatchSize], y[BatchSize], z[BatchSize], noise[BatchSize];
+
+            for (uint32_t row = range.begin(); row < range.end(); ++row)
+            {
+                const uint32_t slice = row / height;
+                const float rowY = static_cast<float>(row - slice * height) * yScale;
+                const float sliceZ =
+                    depth > 1 ? static_cast<float>(slice) * zScale : params.z;
+                std::fill_n(y, BatchSize, rowY);
+                std::fill_n(z, BatchSize, sliceZ);
+
+                TYPE* dst = data + static_cast<size_t>(row) * width * channels;
+                for (uint32_t col = 0; col < width; col += BatchSize)
+                {
+                    for (uint32_t i = 0; i < BatchSize; ++i)
+                    {
+                        x[i] = static_cast<float>(col + i) * xScale;
+                    }
+                    evaluate(params, x, y, z, noise, period);
+
+                    const uint32_t count = std::min(BatchSize, width - col);
+                    for (uint32_t i = 0; i < count; ++i)
+                    {
+                        TYPE* texel = dst + (col + i) * channels;
+                        for (uint32_t k = 0; k < noiseChannels; ++k)
+                        {
+                            toTexel(noise[i], texel + k);
+                        }
+                        if (channels == 4)
+                        {
+                            texel[3] = alphaOne<TYPE>();
+                        }
+                    }
+                }
+            }
+        });
+}
+
+void NoiseGenerator::generateImage(
+    float* image, uint32_t width, uint32_t height, uint32_t channels, const Params& params) const
+{
+    generate(image, width, height, 1, channels, params);
+}
+
+void NoiseGenerator::generateImage(
+    uint8_t* image, uint32_t width, uint32_t height, uint32_t channels, const Params& params) const
+{
+    generate(image, width, height, 1, channels, params);
+}
+
+void NoiseGenerator::generateVolume(
+    float* volume, uint32_t width, uint32_t height, uint32_t depth, const Params& params) const
+{
+    generate(volume, width, height, depth, 1, params);
+}
 
-} // namespace yave
\ No newline at end of file
+} // namespace yave
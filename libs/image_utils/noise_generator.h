@@ -20,9 +20,8 @@
  * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
-#pragma once
 
-#include <utility/assertion.h>
+#pragma once
 
 #include <cstdint>
 #include <vector>
@@ -30,53 +29,134 @@
 namespace yave
 {
 
+/**
+ * @brief Generates Perlin and simplex noise, either as single samples or into
+ * images and volumes. The noise is evaluated in batches of eight samples using
+ * SSE2/NEON where available, and image rows are split across TBB tasks.
+ */
 class NoiseGenerator
 {
 public:
+    // the number of samples evaluated by each call to the batch functions
+    static constexpr uint32_t BatchSize = 8;
+
+    // the largest lattice period supported by the tileable variants
+    static constexpr uint32_t MaxPeriod = 256;
+
+    enum class Type
+    {
+        Perlin,
+        Simplex
+    };
+
+    enum class Fractal
+    {
+        None,
+        Fbm,
+        Ridged
+    };
+
+    struct Params
+    {
+        Type type = Type::Perlin;
+        Fractal fractal = Fractal::None;
+        // the number of lattice cells across the image for the first octave
+        float frequency = 10.0f;
+        // the slice through the noise volume used for 2d images
+        float z = 0.8f;
+        uint32_t octaves = 5;
+        float lacunarity = 2.0f;
+        float gain = 0.5f;
+        // When set, the image wraps seamlessly at its edges. The frequency of
+        // each octave is rounded to a whole number of cells. Only supported
+        // with Perlin noise.
+        bool tileable = false;
+    };
+
     explicit NoiseGenerator(uint32_t seed);
     ~NoiseGenerator();
 
-    double generateNoise(double x, double y, double z);
+    /**
+     * @brief Evaluates a single sample of Perlin noise.
+     * @return The noise value in the range [0, 1].
+     */
+    float generateNoise(float x, float y, float z) const noexcept;
 
-    template <typename TYPE>
-    TYPE* generateImage(uint32_t imageWidth, uint32_t imageHeight, uint32_t channels)
-    {
-        ASSERT_FATAL(
-            channels > 0 && channels <= 4, "Only r, rg or rgb channels supported for image gen.");
-        TYPE* imageBuffer = new TYPE[imageWidth * imageHeight * channels];
-
-        for (uint32_t i = 0; i < imageHeight; ++i)
-        {
-            for (uint32_t j = 0; j < imageWidth; j += channels)
-            {
-                double x = static_cast<double>(j) / static_cast<double>(imageWidth);
-                double y = static_cast<double>(i) / static_cast<double>(imageHeight);
-
-                double noise = generateNoise(10 * x, 10 * y, 0.8);
-
-                for (uint32_t k = 0; k < channels; ++k)
-                {
-                    if (k == 3)
-                    {
-                        imageBuffer[(i * imageWidth + j) + 3] = (TYPE)1;
-                        continue;
-                    }
-                    imageBuffer[(i * imageWidth + j) + k] = (TYPE)noise;
-                }
-            }
-        }
-        return imageBuffer;
-    }
+    /**
+     * @brief Evaluates BatchSize samples of Perlin noise. The output is in
+     * the range [-1, 1].
+     * @param period If non-zero, the lattice repeats every period cells on
+     * all axes. Must not be greater than MaxPeriod.
+     */
+    void perlin(
+        const float* x, const float* y, const float* z, float* out, uint32_t period = 0) const
+        noexcept;
 
-private:
-    double fade(double t);
+    /**
+     * @brief Evaluates BatchSize samples of simplex noise. The output is in
+     * the range [-1, 1].
+     */
+    void simplex(const float* x, const float* y, const float* z, float* out) const noexcept;
+
+    /**
+     * @brief Evaluates BatchSize samples using the base noise and fractal
+     * specified by the params. The coordinates are in lattice space - i.e.
+     * scaled by the base frequency. The output is in the range [0, 1].
+     * @param period The period of the first octave when tileable noise has
+     * been requested.
+     */
+    void evaluate(
+        const Params& params,
+        const float* x,
+        const float* y,
+        const float* z,
+        float* out,
+        uint32_t period = 0) const noexcept;
 
-    double lerp(double t, double a, double b);
+    /**
+     * @brief Fills a caller-allocated image of width * height * channels
+     * elements. The noise is written to the rgb channels, with the alpha
+     * channel (if present) set to one. Integer images are normalised.
+     */
+    void generateImage(
+        float* image,
+        uint32_t width,
+        uint32_t height,
+        uint32_t channels,
+        const Params& params) const;
 
-    double grad(int hash, double x, double y, double z);
+    void generateImage(
+        uint8_t* image,
+        uint32_t width,
+        uint32_t height,
+        uint32_t channels,
+        const Params& params) const;
+
+    /**
+     * @brief Fills a caller-allocated volume of width * height * depth
+     * single channel elements, laid out by slice, then row.
+     */
+    void generateVolume(
+        float* volume,
+        uint32_t width,
+        uint32_t height,
+        uint32_t depth,
+        const Params& params) const;
+
+private:
+    template <typename TYPE>
+    void generate(
+        TYPE* data,
+        uint32_t width,
+        uint32_t height,
+        uint32_t depth,
+        uint32_t channels,
+        const Params& params) const;
 
 private:
+    // the shuffled lattice hashes, duplicated so that lookups of the form
+    // perm[perm[x] + y] don't need wrapping
     std::vector<int> permutations_;
 };
 
-} // namespace yave
\ No newline at end of file
+} // namespace yave
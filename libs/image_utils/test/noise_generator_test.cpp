@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include <image_utils/noise_generator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+
+constexpr uint32_t Seed = 1234;
+
+// evaluates a single sample via the batch interface, as written to the image
+// texel at (col, row)
+float evaluateTexel(
+    const yave::NoiseGenerator& gen,
+    const yave::NoiseGenerator::Params& params,
+    float x,
+    float y,
+    uint32_t period = 0)
+{
+    constexpr uint32_t BatchSize = yave::NoiseGenerator::BatchSize;
+    float xs[BatchSize], ys[BatchSize], zs[BatchSize], out[BatchSize];
+    std::fill_n(xs, BatchSize, x);
+    std::fill_n(ys, BatchSize, y);
+    std::fill_n(zs, BatchSize, params.z);
+    gen.evaluate(params, xs, ys, zs, out, period);
+    return out[0];
+}
+
+} // namespace
+
+TEST(NoiseGeneratorTests, ChannelLayout)
+{
+    constexpr uint32_t Width = 16;
+    constexpr uint32_t Height = 4;
+    yave::NoiseGenerator gen(Seed);
+    yave::NoiseGenerator::Params params;
+    params.frequency = 4.0f;
+    const float xScale = params.frequency / static_cast<float>(Width);
+    const float yScale = params.frequency / static_cast<float>(Height);
+
+    // the noise is replicated across the rgb channels with alpha set to one
+    std::vector<float> rgba(Width * Height * 4);
+    gen.generateImage(rgba.data(), Width, Height, 4, params);
+    for (uint32_t row = 0; row < Height; ++row)
+    {
+        for (uint32_t col = 0; col < Width; ++col)
+        {
+            const float* texel = &rgba[(row * Width + col) * 4];
+            const float expected = evaluateTexel(
+                gen, params, static_cast<float>(col) * xScale, static_cast<float>(row) * yScale);
+            EXPECT_FLOAT_EQ(texel[0], expected);
+            EXPECT_FLOAT_EQ(texel[1], expected);
+            EXPECT_FLOAT_EQ(texel[2], expected);
+            EXPECT_EQ(texel[3], 1.0f);
+        }
+    }
+
+    // two channels are packed without an alpha channel
+    std::vector<float> rg(Width * Height * 2);
+    gen.generateImage(rg.data(), Width, Height, 2, params);
+    for (uint32_t idx = 0; idx < Width * Height; ++idx)
+    {
+        EXPECT_EQ(rg[idx * 2], rgba[idx * 4]);
+        EXPECT_EQ(rg[idx * 2 + 1], rgba[idx * 4]);
+    }
+
+    // integer images are normalised, with alpha at the maximum value
+    std::vector<uint8_t> rgba8(Width * Height * 4);
+    gen.generateImage(rgba8.data(), Width, Height, 4, params);
+    for (uint32_t idx = 0; idx < Width * Height; ++idx)
+    {
+        const auto expected = static_cast<uint8_t>(rgba[idx * 4] * 255.0f + 0.5f);
+        EXPECT_EQ(rgba8[idx * 4], expected);
+        EXPECT_EQ(rgba8[idx * 4 + 1], expected);
+        EXPECT_EQ(rgba8[idx * 4 + 2], expected);
+        EXPECT_EQ(rgba8[idx * 4 + 3], 255);
+    }
+}
+
+TEST(NoiseGeneratorTests, TileableWrap)
+{
+    constexpr uint32_t Width = 32;
+    constexpr uint32_t Height = 8;
+    yave::NoiseGenerator gen(Seed);
+    yave::NoiseGenerator::Params params;
+    params.fractal = yave::NoiseGenerator::Fractal::Fbm;
+    params.frequency = 4.0f;
+    params.tileable = true;
+    const auto period = static_cast<uint32_t>(params.frequency);
+    const float yScale = params.frequency / static_cast<float>(Height);
+
+    std::vector<float> image(Width * Height);
+    gen.generateImage(image.data(), Width, Height, 1, params);
+
+    // the texel one past the right edge (x = width) is the first texel of
+    // the row
+    for (uint32_t row = 0; row < Height; ++row)
+    {
+        const float y = static_cast<float>(row) * yScale;
+        const float wrapped = evaluateTexel(gen, params, params.frequency, y, period);
+        EXPECT_NEAR(wrapped, image[row * Width], 1e-5f);
+    }
+
+    // without tiling, the noise doesn't repeat at the edge
+    params.tileable = false;
+    float difference = 0.0f;
+    for (uint32_t row = 0; row < Height; ++row)
+    {
+        const float y = static_cast<float>(row) * yScale;
+        difference += std::abs(
+            evaluateTexel(gen, params, params.frequency, y) - evaluateTexel(gen, params, 0.0f, y));
+    }
+    EXPECT_GT(difference, 1e-3f);
+}
+
+TEST(NoiseGeneratorTests, PartialBatch)
+{
+    // the width isn't a multiple of the batch size so the last batch of each
+    // row is only partially written
+    constexpr uint32_t Width = 13;
+    constexpr uint32_t Height = 3;
+    constexpr uint32_t Channels = 3;
+    static_assert(Width % yave::NoiseGenerator::BatchSize != 0);
+
+    yave::NoiseGenerator gen(Seed);
+    yave::NoiseGenerator::Params params;
+    params.type = yave::NoiseGenerator::Type::Simplex;
+    const float xScale = params.frequency / static_cast<float>(Width);
+    const float yScale = params.frequency / static_cast<float>(Height);
+
+    // a guard region after the image checks the last batch doesn't overrun
+    constexpr float Guard = -1.0f;
+    constexpr size_t ImageSize = Width * Height * Channels;
+    std::vector<float> image(ImageSize + yave::NoiseGenerator::BatchSize * Channels, Guard);
+    gen.generateImage(image.data(), Width, Height, Channels, params);
+
+    for (uint32_t row = 0; row < Height; ++row)
+    {
+        for (uint32_t col = 0; col < Width; ++col)
+        {
+            const float expected = evaluateTexel(
+                gen, params, static_cast<float>(col) * xScale, static_cast<float>(row) * yScale);
+            for (uint32_t k = 0; k < Channels; ++k)
+            {
+                EXPECT_FLOAT_EQ(image[(row * Width + col) * Channels + k], expected)
+                    << "row " << row << ", col " << col;
+            }
+        }
+    }
+    for (size_t idx = ImageSize; idx < image.size(); ++idx)
+    {
+        EXPECT_EQ(image[idx], Guard);
+    }
+}
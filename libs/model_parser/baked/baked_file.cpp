@@ -0,0 +1,370 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "baked_file.h"
+
+#include "utility/assertion.h"
+#include "utility/logger.h"
+
+#include <fstream>
+#include <system_error>
+
+namespace yave
+{
+
+namespace
+{
+
+constexpr uint64_t Prime1 = 11400714785074694791ULL;
+constexpr uint64_t Prime2 = 14029467366897019727ULL;
+constexpr uint64_t Prime3 = 1609587929392839161ULL;
+constexpr uint64_t Prime4 = 9650029242287828579ULL;
+constexpr uint64_t Prime5 = 2870177450012600261ULL;
+
+uint64_t rotl64(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+uint64_t read64(const uint8_t* ptr)
+{
+    uint64_t value;
+    memcpy(&value, ptr, sizeof(uint64_t));
+    return value;
+}
+
+uint32_t read32(const uint8_t* ptr)
+{
+    uint32_t value;
+    memcpy(&value, ptr, sizeof(uint32_t));
+    return value;
+}
+
+uint64_t hashRound(uint64_t acc, uint64_t input)
+{
+    acc += input * Prime2;
+    acc = rotl64(acc, 31);
+    return acc * Prime1;
+}
+
+uint64_t mergeRound(uint64_t acc, uint64_t value)
+{
+    acc ^= hashRound(0, value);
+    return acc * Prime1 + Prime4;
+}
+
+size_t alignUp(size_t value) noexcept
+{
+    return (value + BakedFormat::Alignment - 1) & ~(BakedFormat::Alignment - 1);
+}
+
+} // namespace
+
+uint64_t BakedFile::hash(const void* data, size_t size, uint64_t seed) noexcept
+{
+    const auto* ptr = static_cast<const uint8_t*>(data);
+    const uint8_t* end = ptr + size;
+    uint64_t h;
+
+    // four independent lanes so the multiplies can be pipelined
+    if (size >= 32)
+    {
+        uint64_t v1 = seed + Prime1 + Prime2;
+        uint64_t v2 = seed + Prime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - Prime1;
+        const uint8_t* limit = end - 32;
+        do
+        {
+            v1 = hashRound(v1, read64(ptr));
+            v2 = hashRound(v2, read64(ptr + 8));
+            v3 = hashRound(v3, read64(ptr + 16));
+            v4 = hashRound(v4, read64(ptr + 24));
+            ptr += 32;
+        } while (ptr <= limit);
+
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = mergeRound(h, v1);
+        h = mergeRound(h, v2);
+        h = mergeRound(h, v3);
+        h = mergeRound(h, v4);
+    }
+    else
+    {
+        h = seed + Prime5;
+    }
+    h += static_cast<uint64_t>(size);
+
+    for (; ptr + 8 <= end; ptr += 8)
+    {
+        h ^= hashRound(0, read64(ptr));
+        h = rotl64(h, 27) * Prime1 + Prime4;
+    }
+    if (ptr + 4 <= end)
+    {
+        h ^= static_cast<uint64_t>(read32(ptr)) * Prime1;
+        h = rotl64(h, 23) * Prime2 + Prime3;
+        ptr += 4;
+    }
+    for (; ptr < end; ++ptr)
+    {
+        h ^= static_cast<uint64_t>(*ptr) * Prime5;
+        h = rotl64(h, 11) * Prime1;
+    }
+
+    // final avalanche
+    h ^= h >> 33;
+    h *= Prime2;
+    h ^= h >> 29;
+    h *= Prime3;
+    h ^= h >> 32;
+    return h;
+}
+
+bool BakedFile::hashSources(
+    const std::filesystem::path& sourceDir,
+    const std::vector<std::string>& dependencies,
+    uint64_t optionsHash,
+    uint64_t& result)
+{
+    uint64_t h = hash(&optionsHash, sizeof(uint64_t), BakedFormat::Version);
+    for (const std::string& dependency : dependencies)
+    {
+        const std::filesystem::path path = sourceDir / dependency;
+        std::error_code error;
+        const uint64_t size = std::filesystem::file_size(path, error);
+        if (error)
+        {
+            return false;
+        }
+
+        // empty files can't be mapped
+        uint64_t fileHash = 0;
+        if (size)
+        {
+            util::MappedFile file;
+            if (!file.open(path.string().c_str()))
+            {
+                return false;
+            }
+            fileHash = hash(file.data(), file.size());
+        }
+
+        const uint64_t values[2] = {size, fileHash};
+        h = hash(dependency.data(), dependency.size(), h);
+        h = hash(values, sizeof(values), h);
+    }
+    result = h;
+    return true;
+}
+
+bool BakedFile::open(const std::filesystem::path& path)
+{
+    if (!file_.open(path.string().c_str()))
+    {
+        return false;
+    }
+
+    const BakedFormat::Header* head = header();
+    if (file_.size() < sizeof(BakedFormat::Header) || head->magic != BakedFormat::Magic)
+    {
+        LOGGER_WARN("%s is not a baked model file.\n", path.string().c_str());
+        file_.close();
+        return false;
+    }
+    if (head->version != BakedFormat::Version)
+    {
+        LOGGER_INFO(
+            "Baked model %s is version %u - expected version %u.\n",
+            path.string().c_str(),
+            head->version,
+            BakedFormat::Version);
+        file_.close();
+        return false;
+    }
+
+    for (const BakedFormat::Section& section : head->sections)
+    {
+        if (section.offset % BakedFormat::Alignment || section.size % BakedFormat::Alignment ||
+            section.offset + section.size > file_.size())
+        {
+            LOGGER_WARN("Baked model %s is corrupt.\n", path.string().c_str());
+            file_.close();
+            return false;
+        }
+    }
+
+    // the string section must be terminated so lookups can't overrun it
+    const BakedFormat::Section& strings = head->sections[BakedFormat::Strings];
+    if (!strings.size || file_.data()[strings.offset + strings.size - 1] != '\0')
+    {
+        LOGGER_WARN("Baked model %s is corrupt.\n", path.string().c_str());
+        file_.close();
+        return false;
+    }
+
+    return true;
+}
+
+bool BakedFile::isUpToDate(const std::filesystem::path& sourceDir, uint64_t optionsHash) const
+{
+    ASSERT_LOG(isOpen());
+
+    size_t count = 0;
+    const auto* records = getRecords<BakedFormat::Dependency>(BakedFormat::Dependencies, count);
+
+    // the sizes are a quick check before hashing the files
+    std::vector<std::string> dependencies;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const std::filesystem::path path = sourceDir / getString(records[i].path);
+        std::error_code error;
+        if (std::filesystem::file_size(path, error) != records[i].size || error)
+        {
+            return false;
+        }
+        dependencies.emplace_back(getString(records[i].path));
+    }
+
+    uint64_t sourceHash = 0;
+    if (!hashSources(sourceDir, dependencies, optionsHash, sourceHash))
+    {
+        return false;
+    }
+    return sourceHash == header()->sourceHash;
+}
+
+const char* BakedFile::getString(uint32_t offset) const noexcept
+{
+    const BakedFormat::Section& section = header()->sections[BakedFormat::Strings];
+    if (offset >= section.size)
+    {
+        return "";
+    }
+    return reinterpret_cast<const char*>(file_.data() + section.offset + offset);
+}
+
+const uint8_t* BakedFile::getData(uint64_t offset, uint64_t size) const noexcept
+{
+    const BakedFormat::Section& section = header()->sections[BakedFormat::Data];
+    if (offset > section.size || size > section.size - offset)
+    {
+        return nullptr;
+    }
+    return file_.data() + section.offset + offset;
+}
+
+// ========================================================================================
+
+BakedWriter::BakedWriter()
+{
+    // offset zero is the empty string
+    sections_[BakedFormat::Strings].push_back('\0');
+}
+
+uint32_t BakedWriter::addString(const char* str)
+{
+    std::vector<uint8_t>& section = sections_[BakedFormat::Strings];
+    if (!str || *str == '\0')
+    {
+        return 0;
+    }
+    const auto offset = static_cast<uint32_t>(section.size());
+    section.insert(section.end(), str, str + strlen(str) + 1);
+    return offset;
+}
+
+uint8_t* BakedWriter::reserveData(size_t size, uint64_t& offset)
+{
+    std::vector<uint8_t>& section = sections_[BakedFormat::Data];
+    offset = alignUp(section.size());
+    section.resize(offset + size);
+    return section.data() + offset;
+}
+
+void BakedWriter::addDependency(const std::string& path, uint64_t size)
+{
+    BakedFormat::Dependency record;
+    record.path = addString(path.c_str());
+    record.size = size;
+    addRecord(BakedFormat::Dependencies, record);
+    dependencies_.emplace_back(path);
+}
+
+bool BakedWriter::write(const std::filesystem::path& path, uint64_t sourceHash) const
+{
+    BakedFormat::Header header;
+    header.sourceHash = sourceHash;
+    size_t offset = alignUp(sizeof(BakedFormat::Header));
+    for (size_t type = 0; type < BakedFormat::Count; ++type)
+    {
+        header.sections[type].offset = offset;
+        header.sections[type].size = alignUp(sections_[type].size());
+        offset += header.sections[type].size;
+    }
+
+    std::error_code error;
+    if (path.has_parent_path())
+    {
+        std::filesystem::create_directories(path.parent_path(), error);
+    }
+
+    // written to a temporary file first so a partially written file is never
+    // picked up
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            LOGGER_ERROR("Unable to create baked model file %s.\n", tempPath.string().c_str());
+            return false;
+        }
+
+        const char padding[BakedFormat::Alignment] = {};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(BakedFormat::Header));
+        file.write(padding, alignUp(sizeof(BakedFormat::Header)) - sizeof(BakedFormat::Header));
+        for (size_t type = 0; type < BakedFormat::Count; ++type)
+        {
+            const std::vector<uint8_t>& section = sections_[type];
+            file.write(reinterpret_cast<const char*>(section.data()), section.size());
+            file.write(padding, header.sections[type].size - section.size());
+        }
+        if (!file)
+        {
+            LOGGER_ERROR("Unable to write baked model file %s.\n", tempPath.string().c_str());
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, path, error);
+    if (error)
+    {
+        LOGGER_ERROR(
+            "Unable to write baked model file %s: %s\n",
+            path.string().c_str(),
+            error.message().c_str());
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+    return true;
+}
+
+} // namespace yave
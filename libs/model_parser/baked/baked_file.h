@@ -0,0 +1,161 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "baked_format.h"
+#include "utility/mapped_file.h"
+
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace yave
+{
+
+/**
+ * @brief A read-only view of a baked model file. The file is mapped into memory
+ * and the records are used in place.
+ */
+class BakedFile
+{
+public:
+    BakedFile() = default;
+
+    /**
+     * @brief Maps the file and checks that the header and sections are valid.
+     * This doesn't check whether the file is up to date - see @p isUpToDate.
+     */
+    bool open(const std::filesystem::path& path);
+
+    /**
+     * @brief Checks the source hash stored in the file against the current
+     * state of the dependencies.
+     * @param sourceDir The directory the dependency paths are relative to.
+     * @param optionsHash The hash of the options the model is built with.
+     */
+    [[nodiscard]] bool
+    isUpToDate(const std::filesystem::path& sourceDir, uint64_t optionsHash) const;
+
+    template <typename T>
+    [[nodiscard]] const T* getRecords(BakedFormat::SectionType type, size_t& count) const noexcept
+    {
+        const BakedFormat::Section& section = header()->sections[type];
+        count = section.size / sizeof(T);
+        return reinterpret_cast<const T*>(file_.data() + section.offset);
+    }
+
+    [[nodiscard]] const char* getString(uint32_t offset) const noexcept;
+
+    /**
+     * @brief A pointer to the vertex or index blob at the offset in the data
+     * section.
+     * @return nullptr if the blob lies outside of the data section.
+     */
+    [[nodiscard]] const uint8_t* getData(uint64_t offset, uint64_t size) const noexcept;
+
+    [[nodiscard]] const BakedFormat::Header* header() const noexcept
+    {
+        return reinterpret_cast<const BakedFormat::Header*>(file_.data());
+    }
+
+    [[nodiscard]] bool isOpen() const noexcept { return file_.isOpen(); }
+
+    /**
+     * @brief A 64-bit non-cryptographic hash of the data - an implementation of
+     * xxHash64.
+     */
+    static uint64_t hash(const void* data, size_t size, uint64_t seed = 0) noexcept;
+
+    /**
+     * @brief Hashes the contents of the dependencies along with the options
+     * hash. The dependencies are mapped rather than read.
+     * @return False if a dependency couldn't be opened.
+     */
+    static bool hashSources(
+        const std::filesystem::path& sourceDir,
+        const std::vector<std::string>& dependencies,
+        uint64_t optionsHash,
+        uint64_t& result);
+
+private:
+    util::MappedFile file_;
+};
+
+/**
+ * @brief Accumulates the records of each section of a baked model, before
+ * writing them out with the header.
+ */
+class BakedWriter
+{
+public:
+    BakedWriter();
+
+    template <typename T>
+    uint32_t addRecord(BakedFormat::SectionType type, const T& record)
+    {
+        static_assert(sizeof(T) % BakedFormat::Alignment == 0);
+        std::vector<uint8_t>& section = sections_[type];
+        const auto index = static_cast<uint32_t>(section.size() / sizeof(T));
+        const size_t offset = section.size();
+        section.resize(offset + sizeof(T));
+        memcpy(section.data() + offset, &record, sizeof(T));
+        return index;
+    }
+
+    template <typename T>
+    [[nodiscard]] uint32_t getRecordCount(BakedFormat::SectionType type) const noexcept
+    {
+        return static_cast<uint32_t>(sections_[type].size() / sizeof(T));
+    }
+
+    // returns the offset of the string in the string section
+    uint32_t addString(const char* str);
+
+    /**
+     * @brief Reserves an aligned blob in the data section which can be written
+     * to directly - i.e. by **ModelMesh::writeVertices**. The pointer is only
+     * valid until the next call.
+     * @param offset Set to the offset of the blob within the data section.
+     */
+    uint8_t* reserveData(size_t size, uint64_t& offset);
+
+    // adds a source file, relative to the source directory
+    void addDependency(const std::string& path, uint64_t size);
+
+    [[nodiscard]] const std::vector<std::string>& getDependencies() const noexcept
+    {
+        return dependencies_;
+    }
+
+    bool write(const std::filesystem::path& path, uint64_t sourceHash) const;
+
+private:
+    std::array<std::vector<uint8_t>, BakedFormat::Count> sections_;
+
+    std::vector<std::string> dependencies_;
+};
+
+} // namespace yave
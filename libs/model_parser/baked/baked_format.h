@@ -0,0 +1,260 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace yave
+{
+
+/**
+ * @brief The layout of a baked model file. A baked model holds the output of
+ * building a gltf model - interleaved (and optionally optimised) vertex and
+ * index data, the flattened node hierachies, skins and materials - so it can be
+ * mapped into memory and used without any parsing or conversion.
+ *
+ * The file begins with a @p Header which gives the location of each section.
+ * All sections and vertex/index blobs are aligned to **Alignment** bytes, and
+ * each record is a multiple of this size, so records can be read in place.
+ * Strings are null-terminated and referenced by their offset into the string
+ * section. All values are little endian.
+ */
+struct BakedFormat
+{
+    // "YBMD"
+    static constexpr uint32_t Magic = 0x444d4259;
+
+    // must be incremented whenever the layout of any record changes
+    static constexpr uint32_t Version = 2;
+
+    static constexpr size_t Alignment = 16;
+
+    static constexpr uint32_t MaxAttributes = 12;
+
+    // denotes an unused index
+    static constexpr uint32_t Invalid = UINT32_MAX;
+
+    enum SectionType : uint32_t
+    {
+        // the source files the model was baked from
+        Dependencies,
+        Instances,
+        Nodes,
+        Skins,
+        Matrices,
+        // node indices of skin joints
+        Joints,
+        Meshes,
+        Primitives,
+        Lods,
+        Clusters,
+        Materials,
+        Textures,
+        Strings,
+        // vertex and index blobs
+        Data,
+        Count
+    };
+
+    struct Section
+    {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+    };
+
+    struct Header
+    {
+        uint32_t magic = Magic;
+        uint32_t version = Version;
+        // the hash of the source files and the build options - the file is
+        // stale if this differs from the hash of the current sources.
+        uint64_t sourceHash = 0;
+        Section sections[Count];
+    };
+
+    struct Dependency
+    {
+        // relative to the directory of the model file
+        uint32_t path = 0;
+        uint32_t padding = 0;
+        uint64_t size = 0;
+    };
+
+    // a node hierachy - see **NodeInstance**
+    struct Instance
+    {
+        uint32_t firstNode = 0;
+        uint32_t nodeCount = 0;
+        uint32_t mesh = Invalid;
+        uint32_t skin = Invalid;
+    };
+
+    // the nodes of each instance are stored depth first - the first node of
+    // an instance is its root
+    struct Node
+    {
+        // relative to the first node of the instance
+        uint32_t parent = Invalid;
+        uint32_t id = 0;
+        uint32_t hasMesh = 0;
+        uint32_t padding = 0;
+        uint64_t skinIndex = UINT64_MAX;
+        uint64_t channelIndex = UINT64_MAX;
+        float localTransform[16] = {};
+        float nodeTransform[16] = {};
+    };
+
+    struct Skin
+    {
+        uint32_t name = 0;
+        uint32_t firstMatrix = 0;
+        uint32_t matrixCount = 0;
+        uint32_t firstJoint = 0;
+        uint32_t jointCount = 0;
+        // relative to the first node of the instance
+        uint32_t skeletonRoot = Invalid;
+        uint32_t padding[2] = {};
+    };
+
+    struct Mesh
+    {
+        uint32_t material = Invalid;
+        uint32_t topology = 0;
+        uint32_t strideSize = 0;
+        uint32_t attributeCount = 0;
+        uint64_t variantBits = 0;
+        uint64_t vertexCount = 0;
+        // offsets into the data section
+        uint64_t vertexOffset = 0;
+        uint64_t vertexSize = 0;
+        // the indices of all primitives, including their lods
+        uint64_t indexCount = 0;
+        float dimensionsMin[4] = {};
+        float dimensionsMax[4] = {};
+        float positionOffset[4] = {};
+        float positionScale[4] = {};
+        uint32_t attributes[MaxAttributes] = {};
+        uint32_t firstPrimitive = 0;
+        uint32_t primitiveCount = 0;
+    };
+
+    // a skin inverse bind matrix - column major
+    struct Matrix
+    {
+        float data[16] = {};
+    };
+
+    struct Joint
+    {
+        // relative to the first node of the instance
+        uint32_t node = 0;
+        uint32_t padding[3] = {};
+    };
+
+    // each primitive has its own index blob as the index type depends on the
+    // vertex count of the primitive
+    struct Primitive
+    {
+        uint64_t indexBase = 0;
+        uint64_t indexCount = 0;
+        uint64_t indexPrimitiveOffset = 0;
+        uint64_t vertexBase = 0;
+        uint64_t vertexCount = 0;
+        // offset into the data section
+        uint64_t indexOffset = 0;
+        float dimensionsMin[4] = {};
+        float dimensionsMax[4] = {};
+        uint32_t indexType = 0;
+        uint32_t firstLod = 0;
+        uint32_t lodCount = 0;
+        uint32_t firstCluster = 0;
+        uint32_t clusterCount = 0;
+        uint32_t padding[3] = {};
+    };
+
+    struct Lod
+    {
+        uint64_t indexBase = 0;
+        uint64_t indexCount = 0;
+        float error = 0.0f;
+        uint32_t padding[3] = {};
+    };
+
+    struct Cluster
+    {
+        uint64_t indexOffset = 0;
+        uint64_t indexCount = 0;
+        float center[3] = {};
+        float radius = 0.0f;
+        float coneAxis[3] = {};
+        float coneCutoff = 1.0f;
+    };
+
+    struct Material
+    {
+        uint32_t name = 0;
+        uint32_t pipeline = 0;
+        uint32_t doubleSided = 0;
+        uint32_t firstTexture = 0;
+        uint32_t textureCount = 0;
+        uint32_t magFilter = 0;
+        uint32_t minFilter = 0;
+        uint32_t addressModeU = 0;
+        uint32_t addressModeV = 0;
+        uint32_t addressModeW = 0;
+        uint32_t padding[2] = {};
+        float baseColour[4] = {};
+        float emissive[4] = {};
+        float diffuse[4] = {};
+        float specular[4] = {};
+        float metallic = 0.0f;
+        float roughness = 0.0f;
+        float alphaMask = 0.0f;
+        float alphaMaskCutOff = 0.0f;
+    };
+
+    struct Texture
+    {
+        uint32_t path = 0;
+        uint32_t type = 0;
+        uint32_t padding[2] = {};
+    };
+};
+
+static_assert(sizeof(BakedFormat::Header) % BakedFormat::Alignment == 0);
+static_assert(sizeof(BakedFormat::Dependency) % BakedFormat::Alignment == 0);
+static_assert(sizeof(BakedFormat::Instance) % BakedFormat::Alignment == 0);
+static_assert(sizeof(BakedFormat::Node) % BakedFormat::Alignment == 0);
+static_assert(sizeof(BakedFormat::Skin) % BakedFormat::Alignment == 0);
+static_assert(sizeof(BakedFormat::Mesh) % BakedFormat::Alignment == 0);
+static_assert(sizeof(BakedFormat::Matrix) % BakedFormat::Alignment == 0);
+static_assert(sizeof(BakedFormat::Joint) % BakedFormat::Alignment == 0);
+static_assert(sizeof(BakedFormat::Primitive) % BakedFormat::Alignment == 0);
+static_assert(sizeof(BakedFormat::Lod) % BakedFormat::Alignment == 0);
+static_assert(sizeof(BakedFormat::Cluster) % BakedFormat::Alignment == 0);
+static_assert(sizeof(BakedFormat::Material) % BakedFormat::Alignment == 0);
+static_assert(sizeof(BakedFormat::Texture) % BakedFormat::Alignment == 0);
+
+} // namespace yave
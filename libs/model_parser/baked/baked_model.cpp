@@ -0,0 +1,611 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "baked_model.h"
+
+#include "model_parser/gltf/model_material.h"
+#include "model_parser/gltf/model_mesh.h"
+#include "model_parser/gltf/node_instance.h"
+#include "model_parser/gltf/skin_instance.h"
+#include "utility/assertion.h"
+#include "utility/logger.h"
+
+#include <unordered_map>
+
+namespace yave
+{
+
+namespace
+{
+
+void writeMatrix(const mathfu::mat4& m, float* dst)
+{
+    for (int col = 0; col < 4; ++col)
+    {
+        for (int row = 0; row < 4; ++row)
+        {
+            dst[col * 4 + row] = m(row, col);
+        }
+    }
+}
+
+mathfu::mat4 readMatrix(const float* src)
+{
+    mathfu::mat4 m;
+    for (int col = 0; col < 4; ++col)
+    {
+        for (int row = 0; row < 4; ++row)
+        {
+            m(row, col) = src[col * 4 + row];
+        }
+    }
+    return m;
+}
+
+void writeVec3(const mathfu::vec3& v, float* dst)
+{
+    dst[0] = v.x;
+    dst[1] = v.y;
+    dst[2] = v.z;
+}
+
+mathfu::vec3 readVec3(const float* src) { return {src[0], src[1], src[2]}; }
+
+void writeColour(const util::Colour4& c, float* dst)
+{
+    memcpy(dst, c.getData(), sizeof(float) * 4);
+}
+
+util::Colour4 readColour(const float* src) { return {src[0], src[1], src[2], src[3]}; }
+
+// flattens the hierachy depth first, so a parent always precedes its children
+void flattenNodes(
+    const NodeInfo* node,
+    uint32_t parent,
+    std::vector<const NodeInfo*>& nodes,
+    std::vector<uint32_t>& parents)
+{
+    const auto index = static_cast<uint32_t>(nodes.size());
+    nodes.emplace_back(node);
+    parents.emplace_back(parent);
+    for (const NodeInfo* child : node->children)
+    {
+        flattenNodes(child, index, nodes, parents);
+    }
+}
+
+uint32_t writeMaterial(const ModelMaterial& mat, BakedWriter& writer)
+{
+    BakedFormat::Material record;
+    record.name = writer.addString(mat.name_.c_str());
+    record.pipeline = static_cast<uint32_t>(mat.pipeline_);
+    record.doubleSided = mat.doubleSided_;
+    record.magFilter = mat.sampler_.magFilter;
+    record.minFilter = mat.sampler_.minFilter;
+    record.addressModeU = mat.sampler_.addressModeU;
+    record.addressModeV = mat.sampler_.addressModeV;
+    record.addressModeW = mat.sampler_.addressModeW;
+    writeColour(mat.attributes_.baseColour, record.baseColour);
+    writeColour(mat.attributes_.emissive, record.emissive);
+    writeColour(mat.attributes_.diffuse, record.diffuse);
+    writeColour(mat.attributes_.specular, record.specular);
+    record.metallic = mat.attributes_.metallic;
+    record.roughness = mat.attributes_.roughness;
+    record.alphaMask = mat.attributes_.alphaMask;
+    record.alphaMaskCutOff = mat.attributes_.alphaMaskCutOff;
+
+    // textures are referenced by path rather than embedded - they are decoded
+    // by the image loaders as usual.
+    record.firstTexture = writer.getRecordCount<BakedFormat::Texture>(BakedFormat::Textures);
+    record.textureCount = static_cast<uint32_t>(mat.textures_.size());
+    for (const auto& texture : mat.textures_)
+    {
+        BakedFormat::Texture texRecord;
+        texRecord.path = writer.addString(texture.texturePath.generic_string().c_str());
+        texRecord.type = texture.type;
+        writer.addRecord(BakedFormat::Textures, texRecord);
+    }
+    return writer.addRecord(BakedFormat::Materials, record);
+}
+
+bool writeMesh(const ModelMesh& mesh, BakedWriter& writer, uint32_t& index)
+{
+    if (mesh.vertices_.attributes.size() > BakedFormat::MaxAttributes)
+    {
+        LOGGER_ERROR("Mesh has too many vertex attributes to bake.\n");
+        return false;
+    }
+
+    BakedFormat::Mesh record;
+    if (mesh.material_)
+    {
+        record.material = writeMaterial(*mesh.material_, writer);
+    }
+    record.topology = static_cast<uint32_t>(mesh.topology_);
+    record.strideSize = mesh.vertices_.strideSize;
+    record.variantBits = mesh.variantBits_.getUint64();
+    record.vertexCount = mesh.vertices_.vertCount;
+    writeVec3(mesh.dimensions_.min, record.dimensionsMin);
+    writeVec3(mesh.dimensions_.max, record.dimensionsMax);
+    writeVec3(mesh.positionOffset_, record.positionOffset);
+    writeVec3(mesh.positionScale_, record.positionScale);
+    record.attributeCount = static_cast<uint32_t>(mesh.vertices_.attributes.size());
+    for (size_t i = 0; i < mesh.vertices_.attributes.size(); ++i)
+    {
+        record.attributes[i] = mesh.vertices_.attributes[i];
+    }
+
+    // the vertices and indices are written in the layout expected by the
+    // gpu so they can be copied straight into a staging buffer when loaded.
+    record.vertexSize = mesh.vertices_.size;
+    mesh.writeVertices(writer.reserveData(mesh.vertices_.size, record.vertexOffset));
+    record.indexCount = mesh.indexCount_;
+
+    record.firstPrimitive = writer.getRecordCount<BakedFormat::Primitive>(BakedFormat::Primitives);
+    record.primitiveCount = static_cast<uint32_t>(mesh.primitives_.size());
+    for (size_t primIdx = 0; primIdx < mesh.primitives_.size(); ++primIdx)
+    {
+        const ModelMesh::Primitive& prim = mesh.primitives_[primIdx];
+        BakedFormat::Primitive primRecord;
+        primRecord.indexBase = prim.indexBase;
+        primRecord.indexCount = prim.indexCount;
+        primRecord.indexPrimitiveOffset = prim.indexPrimitiveOffset;
+        primRecord.vertexBase = prim.vertexBase;
+        primRecord.vertexCount = prim.vertexCount;
+        primRecord.indexType = static_cast<uint32_t>(prim.indexType);
+        writeVec3(prim.dimensions.min, primRecord.dimensionsMin);
+        writeVec3(prim.dimensions.max, primRecord.dimensionsMax);
+
+        primRecord.firstLod = writer.getRecordCount<BakedFormat::Lod>(BakedFormat::Lods);
+        primRecord.lodCount = static_cast<uint32_t>(prim.lods.size());
+        for (const auto& lod : prim.lods)
+        {
+            BakedFormat::Lod lodRecord;
+            lodRecord.indexBase = lod.indexBase;
+            lodRecord.indexCount = lod.indexCount;
+            lodRecord.error = lod.error;
+            writer.addRecord(BakedFormat::Lods, lodRecord);
+        }
+
+        primRecord.firstCluster =
+            writer.getRecordCount<BakedFormat::Cluster>(BakedFormat::Clusters);
+        primRecord.clusterCount = static_cast<uint32_t>(prim.clusters.size());
+        for (const auto& cluster : prim.clusters)
+        {
+            BakedFormat::Cluster clusterRecord;
+            clusterRecord.indexOffset = cluster.indexOffset;
+            clusterRecord.indexCount = cluster.indexCount;
+            writeVec3(cluster.center, clusterRecord.center);
+            clusterRecord.radius = cluster.radius;
+            writeVec3(cluster.coneAxis, clusterRecord.coneAxis);
+            clusterRecord.coneCutoff = cluster.coneCutoff;
+            writer.addRecord(BakedFormat::Clusters, clusterRecord);
+        }
+
+        // the lods must be known to size the index blob
+        mesh.writeIndices(
+            primIdx,
+            writer.reserveData(
+                prim.totalIndexCount() * prim.indexSize(), primRecord.indexOffset));
+        writer.addRecord(BakedFormat::Primitives, primRecord);
+    }
+
+    index = writer.addRecord(BakedFormat::Meshes, record);
+    return true;
+}
+
+bool inRange(uint32_t first, uint32_t count, size_t total)
+{
+    return static_cast<size_t>(first) + count <= total;
+}
+
+} // namespace
+
+bool BakedModel::write(
+    const std::filesystem::path& path,
+    const std::vector<std::unique_ptr<NodeInstance>>& nodes,
+    const std::filesystem::path& sourceDir,
+    const std::vector<std::string>& sourceFiles,
+    uint64_t optionsHash)
+{
+    BakedWriter writer;
+
+    for (const auto& file : sourceFiles)
+    {
+        std::error_code ec;
+        const uintmax_t size = std::filesystem::file_size(sourceDir / file, ec);
+        if (ec)
+        {
+            LOGGER_ERROR("Unable to find model source file %s.\n", file.c_str());
+            return false;
+        }
+        writer.addDependency(file, size);
+    }
+
+    for (const auto& node : nodes)
+    {
+        std::vector<const NodeInfo*> flattened;
+        std::vector<uint32_t> parents;
+        flattenNodes(node->rootNode_.get(), BakedFormat::Invalid, flattened, parents);
+
+        std::unordered_map<const NodeInfo*, uint32_t> nodeIndices;
+        BakedFormat::Instance instance;
+        instance.firstNode = writer.getRecordCount<BakedFormat::Node>(BakedFormat::Nodes);
+        instance.nodeCount = static_cast<uint32_t>(flattened.size());
+        for (size_t idx = 0; idx < flattened.size(); ++idx)
+        {
+            const NodeInfo* info = flattened[idx];
+            nodeIndices[info] = static_cast<uint32_t>(idx);
+
+            BakedFormat::Node record;
+            record.parent = parents[idx];
+            record.id = writer.addString(info->id.c_str());
+            record.hasMesh = info->hasMesh;
+            record.skinIndex = info->skinIndex;
+            record.channelIndex = info->channelIndex;
+            writeMatrix(info->localTransform, record.localTransform);
+            writeMatrix(info->nodeTransform, record.nodeTransform);
+            writer.addRecord(BakedFormat::Nodes, record);
+        }
+
+        if (node->mesh_ && !writeMesh(*node->mesh_, writer, instance.mesh))
+        {
+            return false;
+        }
+
+        if (node->skin_)
+        {
+            const SkinInstance& skin = *node->skin_;
+            BakedFormat::Skin record;
+            record.name = writer.addString(skin.name.c_str());
+            record.firstMatrix = writer.getRecordCount<BakedFormat::Matrix>(BakedFormat::Matrices);
+            record.matrixCount = static_cast<uint32_t>(skin.invBindMatrices.size());
+            for (const auto& mat : skin.invBindMatrices)
+            {
+                BakedFormat::Matrix matRecord;
+                writeMatrix(mat, matRecord.data);
+                writer.addRecord(BakedFormat::Matrices, matRecord);
+            }
+            record.firstJoint = writer.getRecordCount<BakedFormat::Joint>(BakedFormat::Joints);
+            record.jointCount = static_cast<uint32_t>(skin.jointNodes.size());
+            for (const NodeInfo* joint : skin.jointNodes)
+            {
+                auto iter = nodeIndices.find(joint);
+                if (iter == nodeIndices.end())
+                {
+                    LOGGER_ERROR("Skin joint is not part of the node hierachy.\n");
+                    return false;
+                }
+                BakedFormat::Joint jointRecord;
+                jointRecord.node = iter->second;
+                writer.addRecord(BakedFormat::Joints, jointRecord);
+            }
+            if (skin.skeletonRoot)
+            {
+                auto iter = nodeIndices.find(skin.skeletonRoot);
+                if (iter != nodeIndices.end())
+                {
+                    record.skeletonRoot = iter->second;
+                }
+            }
+            instance.skin = writer.addRecord(BakedFormat::Skins, record);
+        }
+
+        writer.addRecord(BakedFormat::Instances, instance);
+    }
+
+    uint64_t sourceHash = 0;
+    if (!BakedFile::hashSources(sourceDir, writer.getDependencies(), optionsHash, sourceHash))
+    {
+        return false;
+    }
+    return writer.write(path, sourceHash);
+}
+
+bool BakedModel::open(
+    const std::filesystem::path& path,
+    const std::filesystem::path& sourceDir,
+    uint64_t optionsHash)
+{
+    if (!std::filesystem::exists(path) || !file_.open(path))
+    {
+        return false;
+    }
+    if (!file_.isUpToDate(sourceDir, optionsHash))
+    {
+        LOGGER_INFO("Baked model %s is out of date.\n", path.string().c_str());
+        file_ = BakedFile {};
+        return false;
+    }
+    return true;
+}
+
+bool BakedModel::createNodes(std::vector<std::unique_ptr<NodeInstance>>& nodes) const
+{
+    ASSERT_FATAL(file_.isOpen(), "Baked model file must be opened before creating nodes.");
+
+    size_t instanceCount, nodeCount, skinCount, matrixCount, jointCount, meshCount;
+    size_t primCount, lodCount, clusterCount, materialCount, textureCount;
+    const auto* instances =
+        file_.getRecords<BakedFormat::Instance>(BakedFormat::Instances, instanceCount);
+    const auto* nodeRecords = file_.getRecords<BakedFormat::Node>(BakedFormat::Nodes, nodeCount);
+    const auto* skins = file_.getRecords<BakedFormat::Skin>(BakedFormat::Skins, skinCount);
+    const auto* matrices =
+        file_.getRecords<BakedFormat::Matrix>(BakedFormat::Matrices, matrixCount);
+    const auto* joints = file_.getRecords<BakedFormat::Joint>(BakedFormat::Joints, jointCount);
+    const auto* meshes = file_.getRecords<BakedFormat::Mesh>(BakedFormat::Meshes, meshCount);
+    const auto* prims =
+        file_.getRecords<BakedFormat::Primitive>(BakedFormat::Primitives, primCount);
+    const auto* lods = file_.getRecords<BakedFormat::Lod>(BakedFormat::Lods, lodCount);
+    const auto* clusters =
+        file_.getRecords<BakedFormat::Cluster>(BakedFormat::Clusters, clusterCount);
+    const auto* materials =
+        file_.getRecords<BakedFormat::Material>(BakedFormat::Materials, materialCount);
+    const auto* textures =
+        file_.getRecords<BakedFormat::Texture>(BakedFormat::Textures, textureCount);
+
+    auto readLods = [&](uint32_t first, uint32_t count, std::vector<ModelMesh::Lod>& out) {
+        if (!inRange(first, count, lodCount))
+        {
+            return false;
+        }
+        for (uint32_t i = first; i < first + count; ++i)
+        {
+            ModelMesh::Lod lod;
+            lod.indexBase = lods[i].indexBase;
+            lod.indexCount = lods[i].indexCount;
+            lod.error = lods[i].error;
+            out.emplace_back(lod);
+        }
+        return true;
+    };
+
+    for (size_t instIdx = 0; instIdx < instanceCount; ++instIdx)
+    {
+        const BakedFormat::Instance& instance = instances[instIdx];
+        if (!instance.nodeCount || !inRange(instance.firstNode, instance.nodeCount, nodeCount))
+        {
+            LOGGER_ERROR("Baked model has an invalid node range.\n");
+            return false;
+        }
+
+        auto node = std::make_unique<NodeInstance>();
+
+        // rebuild the hierachy - parents always precede their children.
+        std::vector<NodeInfo*> infos(instance.nodeCount);
+        for (uint32_t idx = 0; idx < instance.nodeCount; ++idx)
+        {
+            const BakedFormat::Node& record = nodeRecords[instance.firstNode + idx];
+            if ((idx == 0) != (record.parent == BakedFormat::Invalid) ||
+                (idx > 0 && record.parent >= idx))
+            {
+                LOGGER_ERROR("Baked model has an invalid node hierachy.\n");
+                return false;
+            }
+
+            auto* info = new NodeInfo();
+            info->id = file_.getString(record.id);
+            info->hasMesh = record.hasMesh;
+            info->skinIndex = static_cast<size_t>(record.skinIndex);
+            info->channelIndex = static_cast<size_t>(record.channelIndex);
+            info->localTransform = readMatrix(record.localTransform);
+            info->nodeTransform = readMatrix(record.nodeTransform);
+            if (idx == 0)
+            {
+                node->rootNode_.reset(info);
+            }
+            else
+            {
+                info->parent = infos[record.parent];
+                info->parent->children.emplace_back(info);
+            }
+            infos[idx] = info;
+        }
+
+        if (instance.mesh != BakedFormat::Invalid)
+        {
+            if (instance.mesh >= meshCount)
+            {
+                LOGGER_ERROR("Baked model has an invalid mesh index.\n");
+                return false;
+            }
+            const BakedFormat::Mesh& record = meshes[instance.mesh];
+            auto mesh = std::make_unique<ModelMesh>();
+
+            mesh->topology_ = static_cast<ModelMesh::Topology>(record.topology);
+            for (uint64_t bit = 0; bit < static_cast<uint64_t>(ModelMesh::Variant::__SENTINEL__);
+                 ++bit)
+            {
+                if (record.variantBits & (1ull << bit))
+                {
+                    mesh->variantBits_.setBit(static_cast<ModelMesh::Variant>(bit));
+                }
+            }
+            mesh->dimensions_.min = readVec3(record.dimensionsMin);
+            mesh->dimensions_.max = readVec3(record.dimensionsMax);
+            mesh->positionOffset_ = readVec3(record.positionOffset);
+            mesh->positionScale_ = readVec3(record.positionScale);
+
+            if (record.attributeCount > BakedFormat::MaxAttributes)
+            {
+                LOGGER_ERROR("Baked mesh has an invalid vertex layout.\n");
+                return false;
+            }
+            for (uint32_t i = 0; i < record.attributeCount; ++i)
+            {
+                mesh->vertices_.attributes.emplace_back(
+                    static_cast<ModelMesh::VertexBuffer::Attribute>(record.attributes[i]));
+            }
+            mesh->vertices_.strideSize = record.strideSize;
+            mesh->vertices_.vertCount = static_cast<uint32_t>(record.vertexCount);
+            mesh->vertices_.size = record.vertexSize;
+            mesh->indexCount_ = record.indexCount;
+
+            // the vertex and index blobs are used in place
+            mesh->bakedVertices_ = file_.getData(record.vertexOffset, record.vertexSize);
+            if ((record.vertexSize && !mesh->bakedVertices_) ||
+                record.vertexSize != record.vertexCount * record.strideSize)
+            {
+                LOGGER_ERROR("Baked mesh has invalid vertex data.\n");
+                return false;
+            }
+
+            if (!inRange(record.firstPrimitive, record.primitiveCount, primCount))
+            {
+                LOGGER_ERROR("Baked mesh has invalid primitive ranges.\n");
+                return false;
+            }
+            for (uint32_t i = 0; i < record.primitiveCount; ++i)
+            {
+                const BakedFormat::Primitive& primRecord = prims[record.firstPrimitive + i];
+                ModelMesh::Primitive prim;
+                prim.indexBase = primRecord.indexBase;
+                prim.indexCount = primRecord.indexCount;
+                prim.indexPrimitiveOffset = primRecord.indexPrimitiveOffset;
+                prim.vertexBase = primRecord.vertexBase;
+                prim.vertexCount = primRecord.vertexCount;
+                prim.indexType = static_cast<ModelMesh::IndexType>(primRecord.indexType);
+                prim.dimensions.min = readVec3(primRecord.dimensionsMin);
+                prim.dimensions.max = readVec3(primRecord.dimensionsMax);
+                if (!readLods(primRecord.firstLod, primRecord.lodCount, prim.lods) ||
+                    !inRange(primRecord.firstCluster, primRecord.clusterCount, clusterCount))
+                {
+                    LOGGER_ERROR("Baked mesh has invalid primitive ranges.\n");
+                    return false;
+                }
+                for (uint32_t c = 0; c < primRecord.clusterCount; ++c)
+                {
+                    const BakedFormat::Cluster& clusterRecord =
+                        clusters[primRecord.firstCluster + c];
+                    ModelMesh::Cluster cluster;
+                    cluster.indexOffset = clusterRecord.indexOffset;
+                    cluster.indexCount = clusterRecord.indexCount;
+                    cluster.center = readVec3(clusterRecord.center);
+                    cluster.radius = clusterRecord.radius;
+                    cluster.coneAxis = readVec3(clusterRecord.coneAxis);
+                    cluster.coneCutoff = clusterRecord.coneCutoff;
+                    prim.clusters.emplace_back(cluster);
+                }
+
+                const uint8_t* indices = file_.getData(
+                    primRecord.indexOffset, prim.totalIndexCount() * prim.indexSize());
+                if (!indices)
+                {
+                    LOGGER_ERROR("Baked mesh has invalid index data.\n");
+                    return false;
+                }
+                mesh->bakedIndices_.emplace_back(indices);
+                mesh->primitives_.emplace_back(std::move(prim));
+            }
+
+            if (record.material != BakedFormat::Invalid)
+            {
+                if (record.material >= materialCount)
+                {
+                    LOGGER_ERROR("Baked mesh has an invalid material index.\n");
+                    return false;
+                }
+                const BakedFormat::Material& matRecord = materials[record.material];
+                auto mat = std::make_unique<ModelMaterial>();
+                mat->name_ = file_.getString(matRecord.name);
+                mat->pipeline_ = static_cast<ModelMaterial::PbrPipeline>(matRecord.pipeline);
+                mat->doubleSided_ = matRecord.doubleSided;
+                using Sampler = ModelMaterial::Sampler;
+                mat->sampler_.magFilter = static_cast<Sampler::Filter>(matRecord.magFilter);
+                mat->sampler_.minFilter = static_cast<Sampler::Filter>(matRecord.minFilter);
+                mat->sampler_.addressModeU =
+                    static_cast<Sampler::AddressMode>(matRecord.addressModeU);
+                mat->sampler_.addressModeV =
+                    static_cast<Sampler::AddressMode>(matRecord.addressModeV);
+                mat->sampler_.addressModeW =
+                    static_cast<Sampler::AddressMode>(matRecord.addressModeW);
+                mat->attributes_.baseColour = readColour(matRecord.baseColour);
+                mat->attributes_.emissive = readColour(matRecord.emissive);
+                mat->attributes_.diffuse = readColour(matRecord.diffuse);
+                mat->attributes_.specular = readColour(matRecord.specular);
+                mat->attributes_.metallic = matRecord.metallic;
+                mat->attributes_.roughness = matRecord.roughness;
+                mat->attributes_.alphaMask = matRecord.alphaMask;
+                mat->attributes_.alphaMaskCutOff = matRecord.alphaMaskCutOff;
+
+                if (!inRange(matRecord.firstTexture, matRecord.textureCount, textureCount))
+                {
+                    LOGGER_ERROR("Baked material has an invalid texture range.\n");
+                    return false;
+                }
+                for (uint32_t t = 0; t < matRecord.textureCount; ++t)
+                {
+                    const BakedFormat::Texture& texRecord = textures[matRecord.firstTexture + t];
+                    mat->textures_.push_back(
+                        {file_.getString(texRecord.path),
+                         static_cast<ModelMaterial::TextureType>(texRecord.type)});
+                }
+                mesh->material_ = std::move(mat);
+            }
+            node->mesh_ = std::move(mesh);
+        }
+
+        if (instance.skin != BakedFormat::Invalid)
+        {
+            if (instance.skin >= skinCount)
+            {
+                LOGGER_ERROR("Baked model has an invalid skin index.\n");
+                return false;
+            }
+            const BakedFormat::Skin& record = skins[instance.skin];
+            if (!inRange(record.firstMatrix, record.matrixCount, matrixCount) ||
+                !inRange(record.firstJoint, record.jointCount, jointCount))
+            {
+                LOGGER_ERROR("Baked skin has invalid joint ranges.\n");
+                return false;
+            }
+            auto skin = std::make_unique<SkinInstance>();
+            skin->name = file_.getString(record.name);
+            for (uint32_t i = 0; i < record.matrixCount; ++i)
+            {
+                skin->invBindMatrices.emplace_back(
+                    readMatrix(matrices[record.firstMatrix + i].data));
+            }
+            for (uint32_t i = 0; i < record.jointCount; ++i)
+            {
+                const uint32_t jointIdx = joints[record.firstJoint + i].node;
+                if (jointIdx >= instance.nodeCount)
+                {
+                    LOGGER_ERROR("Baked skin has an invalid joint index.\n");
+                    return false;
+                }
+                skin->jointNodes.emplace_back(infos[jointIdx]);
+            }
+            if (record.skeletonRoot < instance.nodeCount)
+            {
+                skin->skeletonRoot = infos[record.skeletonRoot];
+            }
+            node->skin_ = std::move(skin);
+        }
+
+        nodes.emplace_back(std::move(node));
+    }
+    return true;
+}
+
+} // namespace yave
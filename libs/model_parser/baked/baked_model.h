@@ -0,0 +1,83 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "baked_file.h"
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace yave
+{
+// forward declarations
+class NodeInstance;
+
+/**
+ * @brief Converts the built nodes of a model to and from the baked model
+ * format - see **BakedFormat**.
+ */
+class BakedModel
+{
+public:
+    static constexpr const char* FileExtension = ".ybm";
+
+    /**
+     * @brief Writes the built nodes of a model to a baked model file.
+     * @param sourceDir The directory which @p sourceFiles are relative to.
+     * @param sourceFiles The files the model was built from - the model file
+     * and any external buffers. The baked model is stale once any of these
+     * change.
+     * @param optionsHash The hash of the options the model was built with.
+     */
+    static bool write(
+        const std::filesystem::path& path,
+        const std::vector<std::unique_ptr<NodeInstance>>& nodes,
+        const std::filesystem::path& sourceDir,
+        const std::vector<std::string>& sourceFiles,
+        uint64_t optionsHash);
+
+    /**
+     * @brief Maps a baked model file, checking it is up to date with the
+     * sources it was baked from.
+     */
+    bool open(
+        const std::filesystem::path& path,
+        const std::filesystem::path& sourceDir,
+        uint64_t optionsHash);
+
+    /**
+     * @brief Creates the node instances of the baked model. The vertex and
+     * index data is not copied - the meshes read it straight from the mapped
+     * file when calling **ModelMesh::writeVertices** and
+     * **ModelMesh::writeIndices**, so this must outlive the meshes.
+     */
+    bool createNodes(std::vector<std::unique_ptr<NodeInstance>>& nodes) const;
+
+private:
+    BakedFile file_;
+};
+
+} // namespace yave
@@ -0,0 +1,104 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "model_parser/gltf/gltf_model.h"
+#include "utility/logger.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+namespace
+{
+
+void printUsage()
+{
+    printf(
+        "Usage: YaveModelBaker <model.gltf|model.glb> <output dir> [options]\n"
+        "Builds the model and writes it out as a baked model which can be mapped\n"
+        "straight into memory by GltfModel - see GltfModel::setCacheDirectory.\n"
+        "The options must match those the model is loaded with at runtime, and\n"
+        "the model must be loaded from the same path it was baked from.\n\n"
+        "Options:\n"
+        "    --no-optimise   Don't optimise the meshes for the vertex cache.\n"
+        "    --lods          Generate levels of detail for each mesh.\n"
+        "    --clusters      Split large meshes into clusters for culling.\n"
+        "    --quantise      Compress the vertex attributes.\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        printUsage();
+        return 1;
+    }
+
+    const std::filesystem::path modelPath = argv[1];
+    const std::filesystem::path outputDir = argv[2];
+
+    yave::GltfModel model;
+    for (int i = 3; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--no-optimise"))
+        {
+            model.setMeshOptimisation(false);
+        }
+        else if (!strcmp(argv[i], "--lods"))
+        {
+            model.setLodGeneration(true);
+        }
+        else if (!strcmp(argv[i], "--clusters"))
+        {
+            model.setClusterGeneration(true);
+        }
+        else if (!strcmp(argv[i], "--quantise"))
+        {
+            model.setVertexQuantisation(true);
+        }
+        else
+        {
+            LOGGER_ERROR("Unknown option: %s\n", argv[i]);
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (!model.load(modelPath) || !model.build())
+    {
+        LOGGER_ERROR("Unable to build model %s.\n", modelPath.string().c_str());
+        return 1;
+    }
+
+    const std::filesystem::path bakedPath = yave::GltfModel::getBakedPath(outputDir, modelPath);
+    if (!model.writeBaked(bakedPath))
+    {
+        LOGGER_ERROR("Unable to write baked model %s.\n", bakedPath.string().c_str());
+        return 1;
+    }
+
+    LOGGER_INFO("Baked %s to %s.\n", modelPath.string().c_str(), bakedPath.string().c_str());
+    return 0;
+}
@@ -0,0 +1,141 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "model_parser/optimiser/mesh_optimiser.h"
+#include "utility/timer.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+
+using yave::MeshOptimiser;
+
+namespace
+{
+
+constexpr uint32_t GridSize = 512;
+constexpr int Iterations = 5;
+
+// returns the best time of all the iterations in milliseconds
+double run(const std::function<void()>& func)
+{
+    double best = 0.0;
+    for (int i = 0; i < Iterations; ++i)
+    {
+        util::Timer<NanoSeconds> timer;
+        func();
+        const double elapsed = timer.getTimeElapsed() / 1.0e6;
+        best = i == 0 ? elapsed : std::min(best, elapsed);
+    }
+    return best;
+}
+
+} // namespace
+
+int main()
+{
+    // a regular grid of quads with the triangles in a shuffled order - the
+    // worst case for the vertex cache, typical of badly exported or scanned
+    // assets.
+    std::vector<float> positions;
+    for (uint32_t y = 0; y <= GridSize; ++y)
+    {
+        for (uint32_t x = 0; x <= GridSize; ++x)
+        {
+            positions.insert(positions.end(), {float(x), float(y), 0.0f});
+        }
+    }
+    const size_t vertexCount = (GridSize + 1) * (GridSize + 1);
+
+    std::vector<std::array<uint32_t, 3>> tris;
+    for (uint32_t y = 0; y < GridSize; ++y)
+    {
+        for (uint32_t x = 0; x < GridSize; ++x)
+        {
+            uint32_t i0 = y * (GridSize + 1) + x;
+            uint32_t i1 = i0 + 1;
+            uint32_t i2 = i0 + GridSize + 1;
+            uint32_t i3 = i2 + 1;
+            tris.push_back({i0, i1, i2});
+            tris.push_back({i1, i3, i2});
+        }
+    }
+    std::shuffle(tris.begin(), tris.end(), std::mt19937 {42});
+    std::vector<uint32_t> indices;
+    for (const auto& tri : tris)
+    {
+        indices.insert(indices.end(), tri.begin(), tri.end());
+    }
+
+    printf("Mesh optimiser benchmark - %zu triangles\n\n", tris.size());
+
+    std::vector<uint32_t> cacheOptimised(indices.size());
+    const double cacheTime = run([&]() {
+        MeshOptimiser::optimiseVertexCache(
+            cacheOptimised.data(), indices.data(), indices.size(), vertexCount);
+    });
+
+    std::vector<uint32_t> optimised(indices.size());
+    const double overdrawTime = run([&]() {
+        MeshOptimiser::optimiseOverdraw(
+            optimised.data(),
+            cacheOptimised.data(),
+            cacheOptimised.size(),
+            positions.data(),
+            vertexCount,
+            sizeof(float) * 3);
+    });
+
+    std::vector<float> fetchOptimised(positions.size());
+    const double fetchTime = run([&]() {
+        // the indices are updated in place so each iteration works on a copy
+        std::vector<uint32_t> fetchIndices = optimised;
+        MeshOptimiser::optimiseVertexFetch(
+            fetchOptimised.data(),
+            fetchIndices.data(),
+            fetchIndices.size(),
+            positions.data(),
+            vertexCount,
+            sizeof(float) * 3);
+    });
+
+    const auto before =
+        MeshOptimiser::analyseVertexCache(indices.data(), indices.size(), vertexCount);
+    const auto after =
+        MeshOptimiser::analyseVertexCache(optimised.data(), optimised.size(), vertexCount);
+
+    printf("%-16s %8.3fms\n", "vertex cache", cacheTime);
+    printf("%-16s %8.3fms\n", "overdraw", overdrawTime);
+    printf("%-16s %8.3fms\n", "vertex fetch", fetchTime);
+    printf(
+        "\nACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n",
+        before.acmr,
+        after.acmr,
+        before.atvr,
+        after.atvr);
+
+    return 0;
+}
@@ -30,13 +30,56 @@
 #define CGLTF_IMPLEMENTATION
 #include <cgltf.h>
 #include <jsmn.h>
+#include <tbb/tbb.h>
 
+#include <cstdio>
+#include <cstring>
 #include <filesystem>
+#include <utility>
 
 
 namespace yave
 {
 
+namespace
+{
+
+// cgltf file callbacks - files are mapped into memory rather than read, so
+// binary buffers are used in place without an additional copy.
+cgltf_result readMappedFile(
+    const cgltf_memory_options* memoryOptions,
+    const cgltf_file_options* fileOptions,
+    const char* path,
+    cgltf_size* size,
+    void** data)
+{
+    auto* files = static_cast<GltfModel::MappedFiles*>(fileOptions->user_data);
+    ASSERT_LOG(files);
+
+    util::MappedFile file;
+    if (!file.open(path))
+    {
+        return cgltf_result_file_not_found;
+    }
+    if (size)
+    {
+        *size = file.size();
+    }
+    *data = file.data();
+    files->emplace(file.data(), std::move(file));
+    return cgltf_result_success;
+}
+
+void releaseMappedFile(
+    const cgltf_memory_options* memoryOptions, const cgltf_file_options* fileOptions, void* data)
+{
+    auto* files = static_cast<GltfModel::MappedFiles*>(fileOptions->user_data);
+    ASSERT_LOG(files);
+    files->erase(data);
+}
+
+} // namespace
+
 GltfExtension::GltfExtension() {}
 GltfExtension::~GltfExtension() {}
 
@@ -128,7 +171,19 @@ bool GltfExtension::build(const cgltf_extras& extras, cgltf_data& data)
 // =====================================================================================================================================================
 
 GltfModel::GltfModel() : extensions_(std::make_unique<GltfExtension>()) {}
-GltfModel::~GltfModel() {}
+GltfModel::~GltfModel()
+{
+    if (gltfData_)
+    {
+        // the node names point at our ids - restore the originals so cgltf
+        // frees the correct memory
+        for (size_t idx = 0; idx < linearisedNodes_.size(); ++idx)
+        {
+            linearisedNodes_[idx]->name = nodeNames_[idx];
+        }
+        cgltf_free(gltfData_);
+    }
+}
 
 NodeInfo* GltfModel::getNode(const util::CString& id)
 {
@@ -157,12 +212,13 @@ uint8_t* GltfModel::getAttributeData(const cgltf_attribute* attrib, size_t& stri
         accessor->buffer_view->offset;
 }
 
-void GltfModel::lineariseRecursive(cgltf_node& node, size_t index)
+void GltfModel::lineariseRecursive(cgltf_node& node, size_t& index)
 {
     // nodes a lot of the time don't possess a name, so we can't rely on this
     // for identifying nodes. So. we will use a stringifyed id instead
-    util::CString indexStr(std::to_string(index).c_str());
-    node.name = indexStr.c_str();
+    nodeIds_.emplace_back(std::to_string(index++).c_str());
+    nodeNames_.emplace_back(node.name);
+    node.name = nodeIds_.back().c_str();
 
     linearisedNodes_.emplace_back(&node);
 
@@ -190,8 +246,10 @@ void GltfModel::lineariseNodes(cgltf_data* data)
 
 bool GltfModel::load(const std::filesystem::path& filename)
 {
-    // no additional options required
     cgltf_options options = {};
+    options.file.read = readMappedFile;
+    options.file.release = releaseMappedFile;
+    options.file.user_data = &mappedFiles_;
 
     std::filesystem::path modelPath = filename;
     if (!modelDir_.empty())
@@ -199,6 +257,20 @@ bool GltfModel::load(const std::filesystem::path& filename)
         modelPath = modelDir_.c_str() / modelPath;
     }
     auto platformPath = modelPath.make_preferred();
+    modelPath_ = platformPath;
+
+    // use the baked model if there is one which is up to date - the gltf file
+    // isn't parsed at all in this case.
+    if (!cacheDir_.empty())
+    {
+        auto baked = std::make_unique<BakedModel>();
+        if (baked->open(
+                getBakedPath(cacheDir_, modelPath_), platformPath.parent_path(), getOptionsHash()))
+        {
+            baked_ = std::move(baked);
+            return true;
+        }
+    }
 
     cgltf_result res = cgltf_parse_file(&options, platformPath.string().c_str(), &gltfData_);
     if (res != cgltf_result_success)
@@ -219,8 +291,13 @@ bool GltfModel::load(const std::filesystem::path& filename)
     return true;
 }
 
-bool GltfModel::build()
+bool GltfModel::build(const NodeCallback& onNodeReady)
 {
+    if (baked_)
+    {
+        return buildBaked(onNodeReady);
+    }
+
     if (!gltfData_)
     {
         LOGGER_ERROR("Looks like you need to load a gltf file before calling "
@@ -256,9 +333,186 @@ bool GltfModel::build()
         }
     }
 
+    // build the meshes for each node in parallel. Finished nodes are passed
+    // back to this thread via the queue so the callback can begin creating
+    // the renderables while the remaining meshes are still being processed.
+    // Without worker threads the tasks would never run while blocked on the
+    // queue, so build in-line instead.
+    const size_t total = nodes.size();
+    bool success = true;
+    if (tbb::this_task_arena::max_concurrency() < 2)
+    {
+        for (size_t idx = 0; idx < total; ++idx)
+        {
+            if (!nodes[idx]->buildMesh(*this))
+            {
+                return false;
+            }
+            if (onNodeReady)
+            {
+                onNodeReady(*nodes[idx]);
+            }
+            if (progressCallback_)
+            {
+                progressCallback_(idx + 1, total);
+            }
+        }
+    }
+    else
+    {
+        tbb::concurrent_bounded_queue<std::pair<NodeInstance*, bool>> readyNodes;
+        tbb::task_group tasks;
+        for (auto& node : nodes)
+        {
+            NodeInstance* instance = node.get();
+            tasks.run([this, instance, &readyNodes]() {
+                bool result = instance->buildMesh(*this);
+                readyNodes.push({instance, result});
+            });
+        }
+
+        for (size_t processed = 1; processed <= total; ++processed)
+        {
+            std::pair<NodeInstance*, bool> ready;
+            readyNodes.pop(ready);
+            if (!ready.second)
+            {
+                success = false;
+            }
+            else if (onNodeReady)
+            {
+                onNodeReady(*ready.first);
+            }
+            if (progressCallback_)
+            {
+                progressCallback_(processed, total);
+            }
+        }
+        tasks.wait();
+    }
+
+    // not fatal - the model will just be parsed again next time
+    if (success && !cacheDir_.empty() && !writeBaked(getBakedPath(cacheDir_, modelPath_)))
+    {
+        LOGGER_WARN("Unable to write the baked model for %s.\n", modelPath_.string().c_str());
+    }
+
+    return success;
+}
+
+bool GltfModel::buildBaked(const NodeCallback& onNodeReady)
+{
+    if (!baked_->createNodes(nodes))
+    {
+        return false;
+    }
+
+    const size_t total = nodes.size();
+    for (size_t idx = 0; idx < total; ++idx)
+    {
+        if (onNodeReady)
+        {
+            onNodeReady(*nodes[idx]);
+        }
+        if (progressCallback_)
+        {
+            progressCallback_(idx + 1, total);
+        }
+    }
     return true;
 }
 
+bool GltfModel::writeBaked(const std::filesystem::path& path)
+{
+    if (!gltfData_)
+    {
+        LOGGER_ERROR("Only models built from a gltf file can be baked.\n");
+        return false;
+    }
+    return BakedModel::write(
+        path, nodes, modelPath_.parent_path(), getSourceFiles(), getOptionsHash());
+}
+
+std::filesystem::path GltfModel::getBakedPath(
+    const std::filesystem::path& cacheDir, const std::filesystem::path& modelPath)
+{
+    // The source dependencies stored in the baked file are relative to the
+    // model's directory, so the name must be unique to the full path of the
+    // model - otherwise model.gltf and model.glb, or models with the same name
+    // in different directories, would share a baked file.
+    std::error_code error;
+    std::filesystem::path fullPath = std::filesystem::absolute(modelPath, error);
+    if (!error)
+    {
+        fullPath = std::filesystem::weakly_canonical(fullPath, error);
+    }
+    if (error)
+    {
+        fullPath = modelPath.lexically_normal();
+    }
+    const std::string pathStr = fullPath.generic_string();
+    const uint64_t pathHash = BakedFile::hash(pathStr.data(), pathStr.size());
+
+    char hashStr[17];
+    snprintf(hashStr, sizeof(hashStr), "%016llx", static_cast<unsigned long long>(pathHash));
+    return cacheDir / (modelPath.stem().string() + '-' + hashStr + BakedModel::FileExtension);
+}
+
+std::vector<std::string> GltfModel::getSourceFiles() const
+{
+    // images aren't included as textures are referenced by path rather than
+    // baked - any change to the paths is covered by the model file.
+    std::vector<std::string> files {modelPath_.filename().string()};
+    for (size_t idx = 0; idx < gltfData_->buffers_count; ++idx)
+    {
+        const char* uri = gltfData_->buffers[idx].uri;
+        if (uri && strncmp(uri, "data:", 5) != 0)
+        {
+            std::string path = uri;
+            cgltf_decode_uri(path.data());
+            files.emplace_back(path.c_str());
+        }
+    }
+    return files;
+}
+
+uint64_t GltfModel::getOptionsHash() const noexcept
+{
+    // the option structs are hashed by field as they may contain padding
+    uint64_t hash = 0;
+    auto add = [&hash](const auto& value) { hash = BakedFile::hash(&value, sizeof(value), hash); };
+
+    add(optimiseMeshes_);
+    add(generateLods_);
+    if (generateLods_)
+    {
+        add(lodOptions_.maxLevels);
+        add(lodOptions_.reduction);
+        add(lodOptions_.maxError);
+    }
+    add(generateClusters_);
+    if (generateClusters_)
+    {
+        add(clusterOptions_.maxVertices);
+        add(clusterOptions_.maxTriangles);
+        add(clusterOptions_.minTriangles);
+    }
+    add(quantiseVertices_);
+    if (quantiseVertices_)
+    {
+        add(quantisationOptions_.positions);
+        add(quantisationOptions_.normals);
+        add(quantisationOptions_.uvs);
+        add(quantisationOptions_.skin);
+    }
+    return hash;
+}
+
+void GltfModel::setProgressCallback(const ProgressCallback& callback)
+{
+    progressCallback_ = callback;
+}
+
 GltfExtension& GltfModel::getExtensions() { return *extensions_; }
 
 // ================ user front-end functions =========================
@@ -284,4 +538,34 @@ GltfModel& GltfModel::setWorldRotation(const mathfu::quat& rot)
 
 void GltfModel::setDirectory(util::CString dirPath) { modelDir_ = dirPath; }
 
+void GltfModel::setCacheDirectory(const std::filesystem::path& dir) { cacheDir_ = dir; }
+
+GltfModel& GltfModel::setMeshOptimisation(bool state)
+{
+    optimiseMeshes_ = state;
+    return *this;
+}
+
+GltfModel& GltfModel::setLodGeneration(bool state, const ModelMesh::LodOptions& options)
+{
+    generateLods_ = state;
+    lodOptions_ = options;
+    return *this;
+}
+
+GltfModel& GltfModel::setClusterGeneration(bool state, const ModelMesh::ClusterOptions& options)
+{
+    generateClusters_ = state;
+    clusterOptions_ = options;
+    return *this;
+}
+
+GltfModel& GltfModel::setVertexQuantisation(
+    bool state, const ModelMesh::QuantisationOptions& options)
+{
+    quantiseVertices_ = state;
+    quantisationOptions_ = options;
+    return *this;
+}
+
 } // namespace yave
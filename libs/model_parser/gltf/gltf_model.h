@@ -23,14 +23,17 @@
 #pragma once
 
 #include "model_material.h"
+#include "model_parser/baked/baked_model.h"
 #include "model_mesh.h"
 #include "node_instance.h"
 #include "skin_instance.h"
 #include "utility/cstring.h"
+#include "utility/mapped_file.h"
 
 #include <cgltf.h>
 #include <mathfu/glsl_mappings.h>
 
+#include <functional>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -69,14 +72,27 @@ private:
 class GltfModel
 {
 public:
+    // called on the thread calling @p build as each node becomes ready
+    using NodeCallback = std::function<void(NodeInstance& node)>;
+
+    // called on the thread calling @p build with the number of nodes processed
+    using ProgressCallback = std::function<void(size_t processed, size_t total)>;
+
+    // files mapped by cgltf, keyed by the pointer to the mapped data
+    using MappedFiles = std::unordered_map<void*, util::MappedFile>;
+
     GltfModel();
     ~GltfModel();
 
+    GltfModel(const GltfModel&) = delete;
+    GltfModel& operator=(const GltfModel&) = delete;
+
     /// atributes
     static uint8_t* getAttributeData(const cgltf_attribute* attrib, size_t& stride);
 
     /**
-     * @brief Load a specified gltf file from disk.
+     * @brief Load a specified gltf file from disk. The gltf/glb file and any
+     * external binary buffers are memory mapped rather than read into memory.
      * @param filename Absolute path to the gltf model file. Binary data must
      * also be present in the directory.
      * @return Whether the file was succesfully loaded.
@@ -85,9 +101,14 @@ public:
 
     /**
      * @brief Parses the file that was loaded in via  @p load
+     * The meshes of each node are built in parallel, with each node handed to
+     * @p onNodeReady as soon as it is complete. This allows the renderables
+     * to be created while the rest of the model is still being processed.
      * Note: You must call @p load before this function.
      */
-    bool build();
+    bool build(const NodeCallback& onNodeReady = nullptr);
+
+    void setProgressCallback(const ProgressCallback& callback);
 
     // =========== helper functions ================
     /**
@@ -119,10 +140,95 @@ public:
 
     void setDirectory(util::CString dir);
 
+    /**
+     * @brief Sets the directory where baked copies of the built model are kept.
+     * When set, @p load maps the baked model instead of parsing the gltf file
+     * if it is up to date with the sources and build options - otherwise the
+     * baked model is (re)written by @p build. Disabled by default.
+     */
+    void setCacheDirectory(const std::filesystem::path& dir);
+
+    /**
+     * @brief The path of the baked model for the specified gltf file within
+     * the cache directory. The name is derived from the full path of the
+     * model, so the model must be loaded from the same location it was baked
+     * from for the baked file to be used.
+     */
+    static std::filesystem::path
+    getBakedPath(const std::filesystem::path& cacheDir, const std::filesystem::path& modelPath);
+
+    /**
+     * @brief Writes the built model to the specified baked model file.
+     * Note: You must call @p build before this function.
+     */
+    bool writeBaked(const std::filesystem::path& path);
+
+    // whether the model was loaded from a baked model rather than parsed
+    [[nodiscard]] bool isBaked() const noexcept { return baked_ != nullptr; }
+
+    /**
+     * @brief Whether the meshes are optimised for the vertex cache, overdraw
+     * and vertex fetch when built. Enabled by default.
+     */
+    GltfModel& setMeshOptimisation(bool state);
+
+    [[nodiscard]] bool isMeshOptimisationEnabled() const noexcept { return optimiseMeshes_; }
+
+    /**
+     * @brief Whether a chain of simplified index ranges is generated for each
+     * mesh when built. Disabled by default.
+     */
+    GltfModel&
+    setLodGeneration(bool state, const ModelMesh::LodOptions& options = ModelMesh::LodOptions {});
+
+    [[nodiscard]] bool isLodGenerationEnabled() const noexcept { return generateLods_; }
+
+    [[nodiscard]] const ModelMesh::LodOptions& getLodOptions() const noexcept
+    {
+        return lodOptions_;
+    }
+
+    /**
+     * @brief Whether large primitives are split into clusters which can be
+     * culled individually when built. Disabled by default.
+     */
+    GltfModel& setClusterGeneration(
+        bool state, const ModelMesh::ClusterOptions& options = ModelMesh::ClusterOptions {});
+
+    [[nodiscard]] bool isClusterGenerationEnabled() const noexcept { return generateClusters_; }
+
+    [[nodiscard]] const ModelMesh::ClusterOptions& getClusterOptions() const noexcept
+    {
+        return clusterOptions_;
+    }
+
+    /**
+     * @brief Whether the vertex attributes of the meshes are compressed when
+     * built. Disabled by default.
+     */
+    GltfModel& setVertexQuantisation(
+        bool state,
+        const ModelMesh::QuantisationOptions& options = ModelMesh::QuantisationOptions {});
+
+    [[nodiscard]] bool isVertexQuantisationEnabled() const noexcept { return quantiseVertices_; }
+
+    [[nodiscard]] const ModelMesh::QuantisationOptions& getQuantisationOptions() const noexcept
+    {
+        return quantisationOptions_;
+    }
+
 private:
-    void lineariseRecursive(cgltf_node& node, size_t index);
+    void lineariseRecursive(cgltf_node& node, size_t& index);
     void lineariseNodes(cgltf_data* data);
 
+    bool buildBaked(const NodeCallback& onNodeReady);
+
+    // the source files of the model - relative to the model directory
+    std::vector<std::string> getSourceFiles() const;
+
+    // a hash of the options which change the built meshes
+    [[nodiscard]] uint64_t getOptionsHash() const noexcept;
+
 
 public:
     std::vector<std::unique_ptr<NodeInstance>> nodes;
@@ -136,12 +242,23 @@ public:
     // std::vector<AnimInstance> animations;
 
 private:
+    // must be declared before the gltf data as cgltf releases the mapped
+    // files when the data is freed
+    MappedFiles mappedFiles_;
+
     cgltf_data* gltfData_ = nullptr;
 
     // linearised nodes - with the name updated to store an id
     // for linking to our own node hierachy
     std::vector<cgltf_node*> linearisedNodes_;
 
+    // the id strings pointed to by the linearised node names and the original
+    // names, which are restored before the gltf data is freed
+    std::vector<util::CString> nodeIds_;
+    std::vector<char*> nodeNames_;
+
+    ProgressCallback progressCallback_;
+
     // all the extensions available for this model
     std::unique_ptr<GltfExtension> extensions_;
 
@@ -152,6 +269,25 @@ private:
 
     // user defined path to the model directory
     util::CString modelDir_;
+
+    // the model file and its directory, as set by @p load
+    std::filesystem::path modelPath_;
+
+    std::filesystem::path cacheDir_;
+
+    // set if the model was loaded from the cache
+    std::unique_ptr<BakedModel> baked_;
+
+    bool optimiseMeshes_ = true;
+
+    bool generateLods_ = false;
+    ModelMesh::LodOptions lodOptions_;
+
+    bool generateClusters_ = false;
+    ModelMesh::ClusterOptions clusterOptions_;
+
+    bool quantiseVertices_ = false;
+    ModelMesh::QuantisationOptions quantisationOptions_;
 };
 
 } // namespace yave
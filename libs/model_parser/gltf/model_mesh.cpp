@@ -20,19 +20,123 @@
  * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+
 #include "model_mesh.h"
 
 #include "gltf_model.h"
 #include "model_material.h"
+#include "model_parser/optimiser/mesh_optimiser.h"
+#include "model_parser/optimiser/vertex_quantiser.h"
+#include "utility/assertion.h"
 #include "utility/logger.h"
+#include "utility/stream_convert.h"
+
+#include <tbb/tbb.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <unordered_map>
 
 namespace yave
 {
 
+namespace
+{
+
+// the number of vertices interleaved per task when writing out the vertex data
+constexpr size_t VertexGrainSize = 4096;
+
+const uint8_t* getAccessorData(const cgltf_accessor* accessor)
+{
+    return static_cast<const uint8_t*>(accessor->buffer_view->buffer->data) +
+        accessor->offset + accessor->buffer_view->offset;
+}
+
+util::stream::Type getStreamType(cgltf_component_type type)
+{
+    switch (type)
+    {
+        case cgltf_component_type_r_8:
+            return util::stream::Type::Int8;
+        case cgltf_component_type_r_8u:
+            return util::stream::Type::Uint8;
+        case cgltf_component_type_r_16:
+            return util::stream::Type::Int16;
+        case cgltf_component_type_r_16u:
+            return util::stream::Type::Uint16;
+        case cgltf_component_type_r_32u:
+            return util::stream::Type::Uint32;
+        default:
+            return util::stream::Type::Float;
+    }
+}
+
+size_t getAccessorStride(const cgltf_accessor* accessor)
+{
+    return accessor->buffer_view->stride ? accessor->buffer_view->stride : accessor->stride;
+}
+
+/**
+ * @brief Writes a single attribute for a range of vertices into interleaved
+ * memory. Float data is copied directly, anything else (normalised or integer
+ * types) is converted to float. If the primitive doesn't have the attribute,
+ * the element is zeroed, as are any components missing from the source.
+ */
+void writeAttribute(
+    const cgltf_accessor* accessor,
+    size_t componentCount,
+    size_t first,
+    size_t last,
+    uint8_t* dst,
+    size_t dstStride)
+{
+    const size_t width = componentCount * sizeof(float);
+    const size_t srcComponents = accessor ? cgltf_num_components(accessor->type) : 0;
+    if (srcComponents < componentCount)
+    {
+        uint8_t* ptr = dst;
+        for (size_t i = first; i < last; ++i, ptr += dstStride)
+        {
+            memset(ptr, 0, width);
+        }
+    }
+    if (!accessor)
+    {
+        return;
+    }
+
+    // sparse accessors and matrices (which have padded columns) are left to cgltf
+    const bool isMatrix = accessor->type == cgltf_type_mat2 ||
+        accessor->type == cgltf_type_mat3 || accessor->type == cgltf_type_mat4;
+    if (accessor->is_sparse || isMatrix || srcComponents > componentCount)
+    {
+        for (size_t i = first; i < last; ++i, dst += dstStride)
+        {
+            float* out = reinterpret_cast<float*>(dst);
+            memset(out, 0, width);
+            cgltf_accessor_read_float(accessor, i, out, componentCount);
+        }
+        return;
+    }
+
+    const size_t srcStride = getAccessorStride(accessor);
+    util::stream::convertStrided(
+        getAccessorData(accessor) + first * srcStride,
+        srcStride,
+        getStreamType(accessor->component_type),
+        dst,
+        dstStride,
+        util::stream::Type::Float,
+        accessor->normalized,
+        srcComponents,
+        last - first);
+}
+
+} // namespace
+
 ModelMesh::ModelMesh() : material_(nullptr), topology_(Topology::TriangleList) {}
-ModelMesh::~ModelMesh() {}
+ModelMesh::~ModelMesh() { delete[] vertices_.data; }
 
 void ModelMesh::create(
     std::vector<mathfu::vec4>& positions,
@@ -41,64 +145,54 @@ void ModelMesh::create(
     const std::vector<int>& indices,
     const Topology& topo)
 {
-    uint8_t* dataPtr = vertices_.data;
-
-    uint8_t* posPtr = reinterpret_cast<uint8_t*>(positions.data());
-    uint8_t* normPtr = reinterpret_cast<uint8_t*>(normals.data());
-    uint8_t* uvPtr = reinterpret_cast<uint8_t*>(texCoords.data());
-
-    size_t posStride = sizeof(mathfu::vec4);
-    size_t normStride = sizeof(mathfu::vec3);
-    size_t uvStride = sizeof(mathfu::vec2);
-
     vertices_.vertCount = static_cast<uint32_t>(positions.size());
+    vertices_.attributes.emplace_back(VertexBuffer::Attribute::Vec4);
 
     // stride size in bytes - also set variant bit for use with shaders
     size_t strideCount = sizeof(mathfu::vec4);
+    if (texCoords.size() > 0)
+    {
+        strideCount += sizeof(mathfu::vec2);
+        variantBits_ |= ModelMesh::Variant::HasUv;
+        vertices_.attributes.emplace_back(VertexBuffer::Attribute::Vec2);
+    }
     if (normals.size() > 0)
     {
         strideCount += sizeof(mathfu::vec3);
         variantBits_ |= ModelMesh::Variant::HasNormal;
+        vertices_.attributes.emplace_back(VertexBuffer::Attribute::Vec3);
     }
+    vertices_.strideSize = static_cast<uint32_t>(strideCount);
+    vertices_.size = vertices_.vertCount * vertices_.strideSize;
+    vertices_.data = new uint8_t[vertices_.size];
+
+    // now contruct the interleaved vertex data - in the same order as the
+    // vertex buffer bindings: position -- texCoord -- normal
+    std::vector<util::stream::ConstAttribute> streams;
+    streams.push_back({positions.data(), sizeof(mathfu::vec4), 0, sizeof(mathfu::vec4)});
+    size_t offset = sizeof(mathfu::vec4);
     if (texCoords.size() > 0)
     {
-        strideCount += sizeof(mathfu::vec2);
-        variantBits_ |= ModelMesh::Variant::HasUv;
+        streams.push_back({texCoords.data(), sizeof(mathfu::vec2), offset, sizeof(mathfu::vec2)});
+        offset += sizeof(mathfu::vec2);
     }
-    vertices_.strideSize = static_cast<uint32_t>(strideCount);
-    vertices_.data = new uint8_t[vertices_.vertCount * vertices_.strideSize];
-
-    // now contruct the interleaved vertex data - in the format:
-    // position -- normal -- texCoord
-    for (size_t i = 0; i < vertices_.vertCount; ++i)
+    if (normals.size() > 0)
     {
-        // positions
-        memcpy(dataPtr, posPtr, posStride);
-        posPtr += posStride;
-        dataPtr += posStride;
-
-        // normals
-        if (normals.size() > 0)
-        {
-            memcpy(dataPtr, normPtr, normStride);
-            normPtr += normStride;
-            dataPtr += normStride;
-        }
-
-        // uvs
-        if (texCoords.size() > 0)
-        {
-            memcpy(dataPtr, uvPtr, uvStride);
-            uvPtr += uvStride;
-            dataPtr += uvStride;
-        }
+        streams.push_back({normals.data(), sizeof(mathfu::vec3), offset, sizeof(mathfu::vec3)});
     }
+    util::stream::interleave(
+        streams.data(), streams.size(), vertices_.data, vertices_.strideSize, vertices_.vertCount);
 
     // copy the indices
-    memcpy(indices_.data(), indices.data(), sizeof(int) * indices.size());
+    indices_.assign(indices.begin(), indices.end());
+    indexCount_ = indices_.size();
 
     // create the primitive info
-    primitives_.push_back({{}, 0, indices.size(), 0});
+    Primitive prim;
+    prim.indexCount = indices.size();
+    prim.vertexCount = vertices_.vertCount;
+    primitives_.emplace_back(prim);
+    updateIndexTypes();
 
     topology_ = topo;
 }
@@ -109,6 +203,7 @@ bool ModelMesh::build(const cgltf_mesh& mesh, GltfModel& model)
     for (const cgltf_primitive* primitive = mesh.primitives; primitive < meshEnd; ++primitive)
     {
         Primitive newPrimitive;
+        PrimitiveSource source;
 
         // must have indices otherwise got to the next primitive
         if (!primitive->indices || primitive->indices->count == 0)
@@ -126,64 +221,43 @@ bool ModelMesh::build(const cgltf_mesh& mesh, GltfModel& model)
 
         // only one material per mesh is allowed which is the case 99% of the
         // time cache the cgltf pointer and use to ensure this is the case
-        if (!material_)
+        if (!material_ && primitive->material)
         {
             material_ = std::make_unique<ModelMaterial>();
             material_->create(*primitive->material, model.getExtensions());
         }
 
-        // get the number of vertices to process
-        size_t vertCount = primitive->attributes[0].data->count;
-
-        // ================ vertices =====================
-        // somewhere to store the base pointers and stride for each attribute
-        uint8_t* posBase = nullptr;
-        uint8_t* normBase = nullptr;
-        uint8_t* uvBase = nullptr;
-        uint8_t* weightsBase = nullptr;
-        uint8_t* jointsBase = nullptr;
-
-        size_t posStride, normStride, uvStride, weightsStride, jointsStride;
-        size_t attribCount = primitive->attributes_count;
-        size_t attribStride = 0;
-
-        cgltf_attribute* attribEnd = primitive->attributes + attribCount;
+        cgltf_attribute* attribEnd = primitive->attributes + primitive->attributes_count;
         for (const cgltf_attribute* attrib = primitive->attributes; attrib < attribEnd; ++attrib)
         {
-            if (attrib->type == cgltf_attribute_type_position)
+            // only the first set of uvs, joints and weights are supported
+            if (attrib->index > 0)
             {
-                posBase = GltfModel::getAttributeData(attrib, posStride);
-                assert(posStride == 12);
-                attribStride += posStride;
+                continue;
             }
 
+            if (attrib->type == cgltf_attribute_type_position)
+            {
+                source.position = attrib->data;
+            }
             else if (attrib->type == cgltf_attribute_type_normal)
             {
-                normBase = GltfModel::getAttributeData(attrib, normStride);
-                assert(normStride == 12);
-                attribStride += normStride;
+                source.normal = attrib->data;
                 variantBits_ |= ModelMesh::Variant::HasNormal;
             }
-
             else if (attrib->type == cgltf_attribute_type_texcoord)
             {
-                uvBase = GltfModel::getAttributeData(attrib, uvStride);
-                assert(uvStride == 8);
-                attribStride += uvStride;
+                source.uv = attrib->data;
                 variantBits_ |= ModelMesh::Variant::HasUv;
             }
-
             else if (attrib->type == cgltf_attribute_type_joints)
             {
-                jointsBase = GltfModel::getAttributeData(attrib, jointsStride);
-                attribStride += jointsStride;
+                source.joints = attrib->data;
                 variantBits_ |= ModelMesh::Variant::HasJoint;
             }
-
             else if (attrib->type == cgltf_attribute_type_weights)
             {
-                weightsBase = GltfModel::getAttributeData(attrib, weightsStride);
-                attribStride += weightsStride;
+                source.weights = attrib->data;
                 variantBits_ |= ModelMesh::Variant::HasWeight;
             }
             else
@@ -193,126 +267,861 @@ bool ModelMesh::build(const cgltf_mesh& mesh, GltfModel& model)
         }
 
         // must have position data otherwise we can't continue
-        if (!posBase)
+        if (!source.position)
         {
             LOGGER_ERROR("Gltf file contains no vertex position data. Unable "
                          "to continue.\n");
             return false;
         }
 
-        // this has to been done here and not above as the we expect these to be
-        // in a specific order
-        vertices_.attributes.emplace_back(VertexBuffer::Attribute::Vec3);
-        if (uvBase)
+        // sort out min/max boundaries of the sub-mesh - the spec requires
+        // the position accessor to state these, but some exporters don't.
+        const cgltf_accessor* pos = source.position;
+        if (pos->has_min && pos->has_max)
         {
-            vertices_.attributes.emplace_back(VertexBuffer::Attribute::Vec2);
+            newPrimitive.dimensions.min = mathfu::vec3 {pos->min[0], pos->min[1], pos->min[2]};
+            newPrimitive.dimensions.max = mathfu::vec3 {pos->max[0], pos->max[1], pos->max[2]};
         }
-        if (normBase)
+        else
         {
-            vertices_.attributes.emplace_back(VertexBuffer::Attribute::Vec3);
+            for (size_t i = 0; i < pos->count; ++i)
+            {
+                float p[3];
+                cgltf_accessor_read_float(pos, i, p, 3);
+                mathfu::vec3 vec {p[0], p[1], p[2]};
+                newPrimitive.dimensions.min = mathfu::MinHelper(newPrimitive.dimensions.min, vec);
+                newPrimitive.dimensions.max = mathfu::MaxHelper(newPrimitive.dimensions.max, vec);
+            }
         }
-        if (weightsBase)
+
+        // ================= indices ===================
+        // Note: if the indices aren't 32-bit ints, they will be converted
+        // into this format when written
+        source.indices = primitive->indices;
+        size_t indicesCount = primitive->indices->count;
+        if ((indicesCount % 3) != 0)
         {
-            vertices_.attributes.emplace_back(VertexBuffer::Attribute::Float);
+            LOGGER_ERROR("Indices data is of incorrect size.\n");
+            return false;
         }
-        if (jointsBase)
+        if (primitive->indices->component_type != cgltf_component_type_r_32u &&
+            primitive->indices->component_type != cgltf_component_type_r_16u &&
+            primitive->indices->component_type != cgltf_component_type_r_8u)
         {
-            vertices_.attributes.emplace_back(VertexBuffer::Attribute::Vec4);
+            LOGGER_ERROR("Unsupported indices type. Unable to proceed.\n");
+            return false;
         }
 
-        // store vertex as a blob of data
-        vertices_.vertCount = static_cast<uint32_t>(vertCount);
-        vertices_.strideSize = static_cast<uint32_t>(attribStride);
-        vertices_.size = attribStride * vertCount;
-        vertices_.data = new uint8_t[vertices_.size];
+        // all primitives share the one vertex allocation
+        newPrimitive.vertexBase = vertices_.vertCount;
+        newPrimitive.vertexCount = pos->count;
+        newPrimitive.indexBase = indexCount_;
+        newPrimitive.indexCount = indicesCount;
+        vertices_.vertCount += static_cast<uint32_t>(pos->count);
+        indexCount_ += indicesCount;
+
+        // adjust the overall model boundaries based on the sub mesh
+        dimensions_.min = mathfu::MinHelper(dimensions_.min, newPrimitive.dimensions.min);
+        dimensions_.max = mathfu::MaxHelper(dimensions_.max, newPrimitive.dimensions.max);
+
+        primitives_.emplace_back(newPrimitive);
+        sources_.emplace_back(source);
+    }
+
+    // the vertex layout is the union of the attributes over all primitives,
+    // in the same order as the vertex buffer bindings. Primitives that lack
+    // an attribute have it zeroed.
+    size_t attribStride = 3 * sizeof(float);
+    vertices_.attributes.emplace_back(VertexBuffer::Attribute::Vec3);
+    if (variantBits_.testBit(Variant::HasUv))
+    {
+        vertices_.attributes.emplace_back(VertexBuffer::Attribute::Vec2);
+        attribStride += 2 * sizeof(float);
+    }
+    if (variantBits_.testBit(Variant::HasNormal))
+    {
+        vertices_.attributes.emplace_back(VertexBuffer::Attribute::Vec3);
+        attribStride += 3 * sizeof(float);
+    }
+    if (variantBits_.testBit(Variant::HasWeight))
+    {
+        vertices_.attributes.emplace_back(VertexBuffer::Attribute::Vec4);
+        attribStride += 4 * sizeof(float);
+    }
+    if (variantBits_.testBit(Variant::HasJoint))
+    {
+        vertices_.attributes.emplace_back(VertexBuffer::Attribute::Vec4);
+        attribStride += 4 * sizeof(float);
+    }
+    vertices_.strideSize = static_cast<uint32_t>(attribStride);
+    vertices_.size = attribStride * vertices_.vertCount;
+    updateIndexTypes();
+
+    return true;
+}
+
+void ModelMesh::writeVertices(void* dst) const
+{
+    ASSERT_LOG(dst);
+
+    // meshes created by the client have already been interleaved
+    if (vertices_.data)
+    {
+        memcpy(dst, vertices_.data, vertices_.size);
+        return;
+    }
+    if (bakedVertices_)
+    {
+        memcpy(dst, bakedVertices_, vertices_.size);
+        return;
+    }
+
+    const bool hasUv = variantBits_.testBit(Variant::HasUv);
+    const bool hasNormal = variantBits_.testBit(Variant::HasNormal);
+    const bool hasWeight = variantBits_.testBit(Variant::HasWeight);
+    const bool hasJoint = variantBits_.testBit(Variant::HasJoint);
+    const size_t stride = vertices_.strideSize;
+
+    tbb::parallel_for(size_t(0), primitives_.size(), [&](size_t primIdx) {
+        const Primitive& prim = primitives_[primIdx];
+        const PrimitiveSource& source = sources_[primIdx];
+        uint8_t* base = static_cast<uint8_t*>(dst) + prim.vertexBase * stride;
+
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, source.position->count, VertexGrainSize),
+            [&](const tbb::blocked_range<size_t>& range) {
+                uint8_t* dataPtr = base + range.begin() * stride;
+                const size_t first = range.begin();
+                const size_t last = range.end();
+
+                writeAttribute(source.position, 3, first, last, dataPtr, stride);
+                dataPtr += 3 * sizeof(float);
+                if (hasUv)
+                {
+                    writeAttribute(source.uv, 2, first, last, dataPtr, stride);
+                    dataPtr += 2 * sizeof(float);
+                }
+                if (hasNormal)
+                {
+                    writeAttribute(source.normal, 3, first, last, dataPtr, stride);
+                    dataPtr += 3 * sizeof(float);
+                }
+                if (hasWeight)
+                {
+                    writeAttribute(source.weights, 4, first, last, dataPtr, stride);
+                    dataPtr += 4 * sizeof(float);
+                }
+                if (hasJoint)
+                {
+                    writeAttribute(source.joints, 4, first, last, dataPtr, stride);
+                }
+            });
+    });
+}
+
+void ModelMesh::writeIndices(size_t primIdx, void* dst) const
+{
+    ASSERT_LOG(dst);
+    ASSERT_LOG(primIdx < primitives_.size());
+    const Primitive& prim = primitives_[primIdx];
+
+    if (!bakedIndices_.empty())
+    {
+        memcpy(dst, bakedIndices_[primIdx], prim.totalIndexCount() * prim.indexSize());
+        return;
+    }
+
+    if (prim.indexType == IndexType::Uint16)
+    {
+        gatherIndices(primIdx, static_cast<uint16_t*>(dst));
+    }
+    else
+    {
+        gatherIndices(primIdx, static_cast<uint32_t*>(dst));
+    }
+}
+
+template <typename T>
+void ModelMesh::gatherIndices(size_t primIdx, T* dst) const
+{
+    const Primitive& prim = primitives_[primIdx];
+
+    // meshes created by the client or optimised have their indices in memory
+    if (!indices_.empty())
+    {
+        util::stream::convertIndices(
+            indices_.data() + prim.indexBase,
+            sizeof(uint32_t),
+            util::stream::Type::Uint32,
+            0,
+            dst,
+            prim.totalIndexCount());
+        return;
+    }
+
+    // the gltf indices are already relative to the primitive vertices
+    const cgltf_accessor* accessor = sources_[primIdx].indices;
+    util::stream::convertIndices(
+        getAccessorData(accessor),
+        getAccessorStride(accessor),
+        getStreamType(accessor->component_type),
+        0,
+        dst,
+        accessor->count);
+}
+
+void ModelMesh::updateIndexTypes() noexcept
+{
+    // the indices are relative to each primitive, so the index type only
+    // depends on the primitive's vertex count. 0xffff is reserved as the
+    // primitive restart value.
+    for (Primitive& prim : primitives_)
+    {
+        prim.indexType = prim.vertexCount <= std::numeric_limits<uint16_t>::max()
+            ? IndexType::Uint16
+            : IndexType::Uint32;
+    }
+}
+
+void ModelMesh::optimise()
+{
+    if (!vertices_.vertCount || !indexCount_)
+    {
+        return;
+    }
+    if (!primitives_[0].lods.empty())
+    {
+        LOGGER_WARN("The mesh must be optimised before generating lods.\n");
+        return;
+    }
+
+    // the optimisations require the interleaved data on the host
+    const size_t stride = vertices_.strideSize;
+    std::vector<uint8_t> vertices(vertices_.size);
+    writeVertices(vertices.data());
 
-        uint8_t* dataPtr = vertices_.data;
+    struct OptimisedPrimitive
+    {
+        std::vector<uint8_t> vertices;
+        std::vector<uint32_t> indices;
+        size_t vertexCount = 0;
+        MeshOptimiser::CacheStats before;
+        MeshOptimiser::CacheStats after;
+    };
+    std::vector<OptimisedPrimitive> results(primitives_.size());
+
+    tbb::parallel_for(size_t(0), primitives_.size(), [&](size_t primIdx) {
+        const Primitive& prim = primitives_[primIdx];
+        const uint8_t* primVertices = vertices.data() + prim.vertexBase * stride;
+        const size_t count = prim.indexCount;
+
+        std::vector<uint32_t> primIndices(count);
+        gatherIndices(primIdx, primIndices.data());
+        OptimisedPrimitive& result = results[primIdx];
+        result.before =
+            MeshOptimiser::analyseVertexCache(primIndices.data(), count, prim.vertexCount);
+
+        std::vector<uint32_t> remap;
+        size_t uniqueCount = MeshOptimiser::generateVertexRemap(
+            remap, primIndices.data(), count, primVertices, prim.vertexCount, stride);
+        std::vector<uint8_t> uniqueVertices(uniqueCount * stride);
+        MeshOptimiser::remapVertices(
+            uniqueVertices.data(), primVertices, prim.vertexCount, stride, remap.data());
+        MeshOptimiser::remapIndices(primIndices.data(), primIndices.data(), count, remap.data());
+
+        MeshOptimiser::optimiseVertexCache(
+            primIndices.data(), primIndices.data(), count, uniqueCount);
+
+        // positions are always the first attribute
+        result.indices.resize(count);
+        MeshOptimiser::optimiseOverdraw(
+            result.indices.data(),
+            primIndices.data(),
+            count,
+            reinterpret_cast<const float*>(uniqueVertices.data()),
+            uniqueCount,
+            stride);
+
+        result.vertices.resize(uniqueCount * stride);
+        result.vertexCount = MeshOptimiser::optimiseVertexFetch(
+            result.vertices.data(),
+            result.indices.data(),
+            count,
+            uniqueVertices.data(),
+            uniqueCount,
+            stride);
+        result.after = MeshOptimiser::analyseVertexCache(
+            result.indices.data(), count, result.vertexCount);
+    });
+
+    size_t vertexCount = 0;
+    for (const auto& result : results)
+    {
+        vertexCount += result.vertexCount;
+    }
+
+    delete[] vertices_.data;
+    vertices_.data = new uint8_t[vertexCount * stride];
+    indices_.resize(indexCount_);
+
+    // the cache statistics over all primitives - the misses are summed and
+    // then normalised by the totals
+    MeshOptimiser::CacheStats before, after;
+    float missesBefore = 0.0f, missesAfter = 0.0f;
+    size_t vertexBase = 0;
+    for (size_t primIdx = 0; primIdx < primitives_.size(); ++primIdx)
+    {
+        Primitive& prim = primitives_[primIdx];
+        const OptimisedPrimitive& result = results[primIdx];
+
+        memcpy(
+            vertices_.data + vertexBase * stride,
+            result.vertices.data(),
+            result.vertexCount * stride);
+        std::copy(result.indices.begin(), result.indices.end(), indices_.begin() + prim.indexBase);
+
+        missesBefore += result.before.acmr * static_cast<float>(result.before.triangleCount);
+        missesAfter += result.after.acmr * static_cast<float>(result.after.triangleCount);
+        before.triangleCount += result.before.triangleCount;
+        before.vertexCount += result.before.vertexCount;
+        after.vertexCount += result.after.vertexCount;
+
+        prim.vertexBase = vertexBase;
+        prim.vertexCount = result.vertexCount;
+        vertexBase += result.vertexCount;
+    }
+
+    const auto triangleCount = static_cast<float>(std::max<size_t>(before.triangleCount, 1));
+    before.acmr = missesBefore / triangleCount;
+    after.acmr = missesAfter / triangleCount;
+    before.atvr = missesBefore / static_cast<float>(std::max<size_t>(before.vertexCount, 1));
+    after.atvr = missesAfter / static_cast<float>(std::max<size_t>(after.vertexCount, 1));
+    LOGGER_INFO(
+        "Optimised mesh: vertices %u -> %zu, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n",
+        vertices_.vertCount,
+        vertexCount,
+        before.acmr,
+        after.acmr,
+        before.atvr,
+        after.atvr);
 
-        // now contruct the interleaved vertex data
-        for (size_t i = 0; i < vertCount; ++i)
+    vertices_.vertCount = static_cast<uint32_t>(vertexCount);
+    vertices_.size = vertexCount * stride;
+    updateIndexTypes();
+}
+
+void ModelMesh::generateLods(const LodOptions& options)
+{
+    if (!vertices_.vertCount || !indexCount_ || options.maxLevels < 2)
+    {
+        return;
+    }
+    if (!primitives_[0].lods.empty())
+    {
+        LOGGER_WARN("Lods have already been generated for this mesh.\n");
+        return;
+    }
+    if (vertices_.attributes[0] != VertexBuffer::Attribute::Vec3 &&
+        vertices_.attributes[0] != VertexBuffer::Attribute::Vec4)
+    {
+        LOGGER_WARN("Lods must be generated before the mesh vertices are quantised.\n");
+        return;
+    }
+
+    // the simplification requires the vertices and indices on the host
+    gatherHostData();
+
+    // the simplified indices of each primitive, per level - positions are
+    // always the first attribute
+    struct PrimitiveLods
+    {
+        std::vector<std::vector<uint32_t>> indices;
+        std::vector<float> errors;
+    };
+    std::vector<PrimitiveLods> results(primitives_.size());
+
+    tbb::parallel_for(size_t(0), primitives_.size(), [&](size_t primIdx) {
+        const Primitive& prim = primitives_[primIdx];
+        const uint32_t* source = indices_.data() + prim.indexBase;
+        const uint8_t* primVertices = vertices_.data + prim.vertexBase * vertices_.strideSize;
+        PrimitiveLods& result = results[primIdx];
+
+        size_t prevCount = prim.indexCount;
+        float targetCount = static_cast<float>(prim.indexCount);
+        for (uint32_t level = 1; level < options.maxLevels; ++level)
         {
-            // we know the positional data exsists - it's mandatory
-            // sort out min/max boundaries of the sub-mesh
-            float* posPtr = reinterpret_cast<float*>(posBase);
-            mathfu::vec3 pos {*posPtr, *(posPtr + 1), *(posPtr + 2)};
-            newPrimitive.dimensions.min = mathfu::MinHelper(newPrimitive.dimensions.min, pos);
-            newPrimitive.dimensions.max = mathfu::MaxHelper(newPrimitive.dimensions.max, pos);
-
-            memcpy(dataPtr, posBase, posStride);
-            posBase += posStride;
-            dataPtr += posStride;
-
-            if (normBase)
-            {
-                memcpy(dataPtr, normBase, normStride);
-                normBase += normStride;
-                dataPtr += normStride;
-            }
-            if (uvBase)
-            {
-                memcpy(dataPtr, uvBase, uvStride);
-                uvBase += uvStride;
-                dataPtr += uvStride;
-            }
-            if (weightsBase)
+            // each level is simplified from the full detail mesh so the
+            // errors don't accumulate
+            targetCount *= options.reduction;
+            auto target = static_cast<size_t>(targetCount) / 3 * 3;
+
+            std::vector<uint32_t> lodIndices(prim.indexCount);
+            float error = 0.0f;
+            size_t count = MeshOptimiser::simplify(
+                lodIndices.data(),
+                source,
+                prim.indexCount,
+                reinterpret_cast<const float*>(primVertices),
+                prim.vertexCount,
+                vertices_.strideSize,
+                target,
+                options.maxError,
+                &error);
+
+            // stop once the error bound prevents any worthwhile reduction
+            if (count > prevCount * 9 / 10 || !count)
             {
-                memcpy(dataPtr, weightsBase, weightsStride);
-                weightsBase += weightsStride;
-                dataPtr += weightsStride;
+                break;
             }
-            if (jointsBase)
+            lodIndices.resize(count);
+            MeshOptimiser::optimiseVertexCache(
+                lodIndices.data(), lodIndices.data(), count, prim.vertexCount);
+
+            result.indices.emplace_back(std::move(lodIndices));
+            result.errors.emplace_back(error);
+            prevCount = count;
+        }
+    });
+
+    size_t levelCount = 0;
+    for (const auto& result : results)
+    {
+        levelCount = std::max(levelCount, result.indices.size());
+    }
+    if (!levelCount)
+    {
+        return;
+    }
+
+    // the levels of each primitive follow its full detail indices, so each
+    // primitive can be uploaded as one index buffer. Primitives which can't be
+    // simplified any further reuse their coarsest range for the remaining levels.
+    std::vector<uint32_t> indices;
+    size_t fullCount = 0;
+    size_t coarsestCount = 0;
+    float maxError = 0.0f;
+    for (size_t primIdx = 0; primIdx < primitives_.size(); ++primIdx)
+    {
+        Primitive& prim = primitives_[primIdx];
+        const PrimitiveLods& result = results[primIdx];
+        const size_t indexBase = indices.size();
+
+        indices.insert(
+            indices.end(),
+            indices_.begin() + prim.indexBase,
+            indices_.begin() + prim.indexBase + prim.indexCount);
+        prim.lods = {{0, prim.indexCount, 0.0f}};
+        for (size_t level = 0; level < levelCount; ++level)
+        {
+            if (level >= result.indices.size())
             {
-                memcpy(dataPtr, jointsBase, jointsStride);
-                jointsBase += jointsStride;
-                dataPtr += jointsStride;
+                prim.lods.emplace_back(prim.lods.back());
+                continue;
             }
+            const std::vector<uint32_t>& lodIndices = result.indices[level];
+            prim.lods.push_back(
+                {indices.size() - indexBase, lodIndices.size(), result.errors[level]});
+            indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
         }
+        prim.indexBase = indexBase;
+        fullCount += prim.indexCount;
+        coarsestCount += prim.lods.back().indexCount;
+        maxError = std::max(maxError, prim.lods.back().error);
+    }
+    indices_ = std::move(indices);
+    indexCount_ = indices_.size();
 
-        // ================= indices ===================
-        size_t indicesCount = primitive->indices->count;
-        newPrimitive.indexBase = indices_.size();
-        newPrimitive.indexCount = indicesCount;
-        indices_.reserve(indicesCount);
+    LOGGER_INFO(
+        "Generated %zu lods: triangles %zu -> %zu (error: %f)\n",
+        levelCount,
+        fullCount / 3,
+        coarsestCount / 3,
+        maxError);
+}
 
-        // now for the indices - Note: if the idices aren't 32-bit ints, they
-        // will be casted into this format
-        if ((indicesCount % 3) != 0)
+void ModelMesh::buildClusters(const ClusterOptions& options)
+{
+    if (!vertices_.vertCount || !indexCount_ || topology_ != Topology::TriangleList)
+    {
+        return;
+    }
+    if (vertices_.attributes[0] != VertexBuffer::Attribute::Vec3 &&
+        vertices_.attributes[0] != VertexBuffer::Attribute::Vec4)
+    {
+        LOGGER_WARN("Clusters must be built before the mesh vertices are quantised.\n");
+        return;
+    }
+
+    bool hasLargePrimitive = false;
+    for (const Primitive& prim : primitives_)
+    {
+        hasLargePrimitive |= prim.indexCount / 3 >= options.minTriangles;
+    }
+    if (!hasLargePrimitive)
+    {
+        return;
+    }
+    gatherHostData();
+
+    tbb::parallel_for(size_t(0), primitives_.size(), [&](size_t primIdx) {
+        Primitive& prim = primitives_[primIdx];
+        if (prim.indexCount / 3 < options.minTriangles)
         {
-            LOGGER_ERROR("Indices data is of incorrect size.\n");
-            return false;
+            // kept as a single cluster so the clusters cover the whole mesh
+            Cluster cluster;
+            cluster.indexOffset = 0;
+            cluster.indexCount = prim.indexCount;
+            cluster.center = (prim.dimensions.min + prim.dimensions.max) * 0.5f;
+            cluster.radius = (prim.dimensions.max - prim.dimensions.min).Length() * 0.5f;
+            prim.clusters = {cluster};
+            return;
         }
 
-        const uint8_t* base =
-            static_cast<const uint8_t*>(primitive->indices->buffer_view->buffer->data) +
-            primitive->indices->offset + primitive->indices->buffer_view->offset;
+        // the triangles are reordered in place - the lods either reference
+        // separate index ranges or the same set of triangles so aren't affected.
+        uint32_t* primIndices = indices_.data() + prim.indexBase;
+        const uint8_t* primVertices = vertices_.data + prim.vertexBase * vertices_.strideSize;
+        std::vector<uint32_t> source(primIndices, primIndices + prim.indexCount);
+        std::vector<MeshOptimiser::Meshlet> meshlets;
+        MeshOptimiser::buildMeshlets(
+            meshlets,
+            primIndices,
+            source.data(),
+            prim.indexCount,
+            reinterpret_cast<const float*>(primVertices),
+            prim.vertexCount,
+            vertices_.strideSize,
+            options.maxVertices,
+            options.maxTriangles);
 
-        for (size_t i = 0; i < primitive->indices->count; ++i)
+        prim.clusters.clear();
+        prim.clusters.reserve(meshlets.size());
+        for (const MeshOptimiser::Meshlet& meshlet : meshlets)
         {
-            uint32_t index = 0;
-            if (primitive->indices->component_type == cgltf_component_type_r_32u)
-            {
-                index = *reinterpret_cast<const uint32_t*>(base + sizeof(uint32_t) * i);
-            }
-            else if (primitive->indices->component_type == cgltf_component_type_r_16u)
-            {
-                index = *reinterpret_cast<const uint16_t*>(base + sizeof(uint16_t) * i);
-            }
-            else
-            {
-                LOGGER_ERROR("Unsupported indices type. Unable to proceed.\n");
-                return false;
-            }
+            Cluster cluster;
+            cluster.indexOffset = meshlet.indexOffset;
+            cluster.indexCount = meshlet.triangleCount * 3;
+            cluster.center = {meshlet.center[0], meshlet.center[1], meshlet.center[2]};
+            cluster.radius = meshlet.radius;
+            cluster.coneAxis = {meshlet.coneAxis[0], meshlet.coneAxis[1], meshlet.coneAxis[2]};
+            cluster.coneCutoff = meshlet.coneCutoff;
+            prim.clusters.emplace_back(cluster);
+        }
+    });
 
-            indices_.emplace_back(index);
+    size_t clusterCount = 0;
+    size_t coneCount = 0;
+    for (const Primitive& prim : primitives_)
+    {
+        clusterCount += prim.clusters.size();
+        for (const Cluster& cluster : prim.clusters)
+        {
+            coneCount += cluster.coneCutoff < 1.0f;
         }
+    }
+    LOGGER_INFO("Built %zu clusters (%zu can be back-face culled)\n", clusterCount, coneCount);
+}
 
-        // adjust the overall model boundaries based on the sub mesh
-        dimensions_.min = mathfu::MinHelper(dimensions_.min, newPrimitive.dimensions.min);
-        dimensions_.max = mathfu::MaxHelper(dimensions_.max, newPrimitive.dimensions.max);
+void ModelMesh::gatherHostData()
+{
+    if (!vertices_.data)
+    {
+        auto* data = new uint8_t[vertices_.size];
+        writeVertices(data);
+        vertices_.data = data;
+    }
+    if (indices_.empty())
+    {
+        std::vector<uint32_t> indices(indexCount_);
+        tbb::parallel_for(size_t(0), primitives_.size(), [&](size_t primIdx) {
+            gatherIndices(primIdx, indices.data() + primitives_[primIdx].indexBase);
+        });
+        indices_ = std::move(indices);
+    }
+}
 
-        primitives_.emplace_back(newPrimitive);
+ModelMesh::QuantisationError ModelMesh::quantise(const QuantisationOptions& options)
+{
+    QuantisationError error;
+    if (!vertices_.vertCount || vertices_.attributes.empty())
+    {
+        return error;
     }
-    return true;
+
+    // the source layout must be the full precision one
+    const size_t posWidth = vertices_.attributes[0] == VertexBuffer::Attribute::Vec4 ? 4 : 3;
+    if (posWidth == 3 && vertices_.attributes[0] != VertexBuffer::Attribute::Vec3)
+    {
+        LOGGER_WARN("Mesh vertices have already been quantised.\n");
+        return error;
+    }
+
+    const bool hasUv = variantBits_.testBit(Variant::HasUv);
+    const bool hasNormal = variantBits_.testBit(Variant::HasNormal);
+    const bool hasSkin =
+        variantBits_.testBit(Variant::HasWeight) && variantBits_.testBit(Variant::HasJoint);
+    if (variantBits_.testBit(Variant::HasWeight) != variantBits_.testBit(Variant::HasJoint))
+    {
+        LOGGER_WARN("Mesh has weights or joints but not both - skin data won't be quantised.\n");
+    }
+
+    const size_t srcStride = vertices_.strideSize;
+    std::vector<uint8_t> source(vertices_.size);
+    writeVertices(source.data());
+
+    // offsets of each attribute within the source vertex
+    const size_t srcUvOffset = posWidth * sizeof(float);
+    const size_t srcNormalOffset = srcUvOffset + (hasUv ? 2 * sizeof(float) : 0);
+    const size_t srcWeightOffset = srcNormalOffset + (hasNormal ? 3 * sizeof(float) : 0);
+    const size_t srcJointOffset = srcWeightOffset + 4 * sizeof(float);
+
+    // the position bounds and the largest joint index over all vertices
+    mathfu::vec3 posMin {std::numeric_limits<float>::max()};
+    mathfu::vec3 posMax {std::numeric_limits<float>::lowest()};
+    float maxJoint = 0.0f;
+    for (size_t i = 0; i < vertices_.vertCount; ++i)
+    {
+        const uint8_t* vertex = source.data() + i * srcStride;
+        float pos[3];
+        memcpy(pos, vertex, sizeof(pos));
+        mathfu::vec3 vec {pos[0], pos[1], pos[2]};
+        posMin = mathfu::MinHelper(posMin, vec);
+        posMax = mathfu::MaxHelper(posMax, vec);
+
+        if (hasSkin && options.skin)
+        {
+            float joints[4];
+            memcpy(joints, vertex + srcJointOffset, sizeof(joints));
+            maxJoint = std::max({maxJoint, joints[0], joints[1], joints[2], joints[3]});
+        }
+    }
+
+    const bool quantisePos = options.positions;
+    const bool quantiseUv = hasUv && options.uvs;
+    const bool quantiseNormal = hasNormal && options.normals;
+    const bool quantiseSkin = hasSkin && options.skin;
+    const bool wideJoints = maxJoint > std::numeric_limits<uint8_t>::max();
+
+    mathfu::vec3 offset {0.0f};
+    mathfu::vec3 scale {1.0f};
+    if (quantisePos)
+    {
+        offset = posMin;
+        scale = posMax - posMin;
+        for (int c = 0; c < 3; ++c)
+        {
+            // flat meshes have a zero extent on one axis
+            scale[c] = scale[c] > 0.0f ? scale[c] : 1.0f;
+        }
+    }
+
+    // the new layout - in the same order as the vertex buffer bindings
+    std::vector<VertexBuffer::Attribute> attributes;
+    size_t dstStride = 0;
+    auto addAttribute = [&](VertexBuffer::Attribute attr, size_t width) {
+        attributes.emplace_back(attr);
+        dstStride += width;
+    };
+    quantisePos ? addAttribute(VertexBuffer::Attribute::Unorm16x4, 4 * sizeof(uint16_t))
+                : addAttribute(vertices_.attributes[0], posWidth * sizeof(float));
+    if (hasUv)
+    {
+        quantiseUv ? addAttribute(VertexBuffer::Attribute::Half2, 2 * sizeof(uint16_t))
+                   : addAttribute(VertexBuffer::Attribute::Vec2, 2 * sizeof(float));
+    }
+    if (hasNormal)
+    {
+        quantiseNormal ? addAttribute(VertexBuffer::Attribute::Snorm16x2, 2 * sizeof(int16_t))
+                       : addAttribute(VertexBuffer::Attribute::Vec3, 3 * sizeof(float));
+    }
+    if (hasSkin)
+    {
+        if (quantiseSkin)
+        {
+            addAttribute(VertexBuffer::Attribute::Unorm8x4, 4 * sizeof(uint8_t));
+            wideJoints ? addAttribute(VertexBuffer::Attribute::Uint16x4, 4 * sizeof(uint16_t))
+                       : addAttribute(VertexBuffer::Attribute::Uint8x4, 4 * sizeof(uint8_t));
+        }
+        else
+        {
+            addAttribute(VertexBuffer::Attribute::Vec4, 4 * sizeof(float));
+            addAttribute(VertexBuffer::Attribute::Vec4, 4 * sizeof(float));
+        }
+    }
+
+    auto* data = new uint8_t[dstStride * vertices_.vertCount];
+    tbb::combinable<QuantisationError> errors;
+
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, vertices_.vertCount, VertexGrainSize),
+        [&](const tbb::blocked_range<size_t>& range) {
+            QuantisationError& localError = errors.local();
+            for (size_t i = range.begin(); i < range.end(); ++i)
+            {
+                const uint8_t* src = source.data() + i * srcStride;
+                uint8_t* dst = data + i * dstStride;
+
+                if (quantisePos)
+                {
+                    float pos[3];
+                    memcpy(pos, src, sizeof(pos));
+                    uint16_t q[4] = {0, 0, 0, std::numeric_limits<uint16_t>::max()};
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        q[c] = VertexQuantiser::toUnorm16((pos[c] - offset[c]) / scale[c]);
+                        float decoded = offset[c] + VertexQuantiser::fromUnorm16(q[c]) * scale[c];
+                        localError.position =
+                            std::max(localError.position, std::abs(decoded - pos[c]));
+                    }
+                    memcpy(dst, q, sizeof(q));
+                    dst += sizeof(q);
+                }
+                else
+                {
+                    memcpy(dst, src, posWidth * sizeof(float));
+                    dst += posWidth * sizeof(float);
+                }
+
+                if (hasUv)
+                {
+                    float uv[2];
+                    memcpy(uv, src + srcUvOffset, sizeof(uv));
+                    if (quantiseUv)
+                    {
+                        uint16_t q[2];
+                        for (int c = 0; c < 2; ++c)
+                        {
+                            q[c] = VertexQuantiser::floatToHalf(uv[c]);
+                            localError.uv = std::max(
+                                localError.uv, std::abs(VertexQuantiser::halfToFloat(q[c]) - uv[c]));
+                        }
+                        memcpy(dst, q, sizeof(q));
+                        dst += sizeof(q);
+                    }
+                    else
+                    {
+                        memcpy(dst, uv, sizeof(uv));
+                        dst += sizeof(uv);
+                    }
+                }
+
+                if (hasNormal)
+                {
+                    float normal[3];
+                    memcpy(normal, src + srcNormalOffset, sizeof(normal));
+                    if (quantiseNormal)
+                    {
+                        // zero length normals (from primitives without normals) encode as +z
+                        float length = std::sqrt(
+                            normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+                        if (length > 0.0f)
+                        {
+                            for (float& c : normal)
+                            {
+                                c /= length;
+                            }
+                        }
+                        else
+                        {
+                            normal[0] = normal[1] = 0.0f;
+                            normal[2] = 1.0f;
+                        }
+
+                        int16_t q[2];
+                        float decoded[3];
+                        VertexQuantiser::encodeOctahedral(normal, q);
+                        VertexQuantiser::decodeOctahedral(q, decoded);
+                        // in double precision as the errors are tiny
+                        double dot = double(normal[0]) * decoded[0] +
+                            double(normal[1]) * decoded[1] + double(normal[2]) * decoded[2];
+                        auto angle = static_cast<float>(
+                            std::acos(std::clamp(dot, -1.0, 1.0)) * 180.0 / M_PI);
+                        localError.normal = std::max(localError.normal, angle);
+                        memcpy(dst, q, sizeof(q));
+                        dst += sizeof(q);
+                    }
+                    else
+                    {
+                        memcpy(dst, normal, sizeof(normal));
+                        dst += sizeof(normal);
+                    }
+                }
+
+                if (hasSkin)
+                {
+                    float weights[4];
+                    float joints[4];
+                    memcpy(weights, src + srcWeightOffset, sizeof(weights));
+                    memcpy(joints, src + srcJointOffset, sizeof(joints));
+                    if (quantiseSkin)
+                    {
+                        uint8_t qWeights[4];
+                        VertexQuantiser::quantiseWeights(weights, qWeights);
+                        float sum = weights[0] + weights[1] + weights[2] + weights[3];
+                        for (int c = 0; c < 4; ++c)
+                        {
+                            float weight = sum > 0.0f ? weights[c] / sum : 0.0f;
+                            localError.weight = std::max(
+                                localError.weight,
+                                std::abs(VertexQuantiser::fromUnorm8(qWeights[c]) - weight));
+                        }
+                        memcpy(dst, qWeights, sizeof(qWeights));
+                        dst += sizeof(qWeights);
+
+                        if (wideJoints)
+                        {
+                            uint16_t qJoints[4];
+                            for (int c = 0; c < 4; ++c)
+                            {
+                                qJoints[c] = static_cast<uint16_t>(joints[c]);
+                            }
+                            memcpy(dst, qJoints, sizeof(qJoints));
+                        }
+                        else
+                        {
+                            uint8_t qJoints[4];
+                            for (int c = 0; c < 4; ++c)
+                            {
+                                qJoints[c] = static_cast<uint8_t>(joints[c]);
+                            }
+                            memcpy(dst, qJoints, sizeof(qJoints));
+                        }
+                    }
+                    else
+                    {
+                        memcpy(dst, weights, sizeof(weights));
+                        memcpy(dst + sizeof(weights), joints, sizeof(joints));
+                    }
+                }
+            }
+        });
+
+    errors.combine_each([&error](const QuantisationError& local) {
+        error.position = std::max(error.position, local.position);
+        error.normal = std::max(error.normal, local.normal);
+        error.uv = std::max(error.uv, local.uv);
+        error.weight = std::max(error.weight, local.weight);
+    });
+
+    LOGGER_INFO(
+        "Quantised mesh: stride %u -> %zu bytes; max error - position: %f, normal: %f deg, "
+        "uv: %f, weight: %f\n",
+        vertices_.strideSize,
+        dstStride,
+        error.position,
+        error.normal,
+        error.uv,
+        error.weight);
+
+    delete[] vertices_.data;
+    vertices_.data = data;
+    vertices_.attributes = std::move(attributes);
+    vertices_.strideSize = static_cast<uint32_t>(dstStride);
+    vertices_.size = dstStride * vertices_.vertCount;
+    positionOffset_ = offset;
+    positionScale_ = scale;
+
+    return error;
 }
 
 } // namespace yave
@@ -44,7 +44,7 @@ public:
     {
         Dimensions()
             : min(mathfu::vec3 {std::numeric_limits<float>::max()}),
-              max(mathfu::vec3 {std::numeric_limits<float>::min()})
+              max(mathfu::vec3 {std::numeric_limits<float>::lowest()})
         {
         }
         mathfu::vec3 min;
@@ -63,6 +63,12 @@ public:
         Undefined
     };
 
+    enum class IndexType
+    {
+        Uint16,
+        Uint32
+    };
+
     /**
      * @brief Specifies a variant to use when compiling the shader
      */
@@ -95,7 +101,15 @@ public:
             Vec3,
             Vec4,
             Mat3,
-            Mat4
+            Mat4,
+            // quantised formats - see **quantise**
+            Half2,
+            Snorm16x2,
+            Unorm16x2,
+            Unorm16x4,
+            Unorm8x4,
+            Uint8x4,
+            Uint16x4
         };
 
         struct Descriptor
@@ -111,6 +125,54 @@ public:
         std::vector<Attribute> attributes;
     };
 
+    /**
+     * @brief A level of detail - an index range into the primitive indices
+     * which references the same vertices as the full detail primitive.
+     */
+    struct Lod
+    {
+        size_t indexBase = 0;
+        size_t indexCount = 0;
+        // the simplification error as a fraction of the mesh extent
+        float error = 0.0f;
+    };
+
+    struct LodOptions
+    {
+        // the maximum number of levels, including the full detail mesh
+        uint32_t maxLevels = 4;
+        // the fraction of triangles retained by each level relative to the
+        // previous one
+        float reduction = 0.5f;
+        // the maximum simplification error as a fraction of the mesh extent
+        float maxError = 0.05f;
+    };
+
+    /**
+     * @brief A cluster of triangles of a primitive - an index range into the
+     * full detail indices with the bounds required for culling the cluster.
+     */
+    struct Cluster
+    {
+        size_t indexOffset = 0;
+        size_t indexCount = 0;
+        mathfu::vec3 center {0.0f};
+        float radius = 0.0f;
+        // the cluster is back facing if:
+        // dot(center - eye, coneAxis) >= coneCutoff * (|center - eye| + radius) + radius
+        mathfu::vec3 coneAxis {0.0f};
+        float coneCutoff = 1.0f;
+    };
+
+    struct ClusterOptions
+    {
+        uint32_t maxVertices = 64;
+        uint32_t maxTriangles = 124;
+        // primitives with fewer triangles are kept as a single cluster -
+        // culling is only worthwhile for large primitives.
+        uint32_t minTriangles = 1024;
+    };
+
     struct Primitive
     {
         Primitive() = default;
@@ -118,13 +180,74 @@ public:
         // sub-mesh dimensions.
         Dimensions dimensions;
 
-        // index offsets
+        // index offsets - the full detail indices of the primitive start at
+        // **indexBase** within the mesh indices and are followed by the
+        // indices of each lod.
         size_t indexBase = 0;
         size_t indexCount = 0;
 
         // ============ vulakn backend ==========================
         // set by calling **update**
         size_t indexPrimitiveOffset = 0;
+
+        // the first vertex of this primitive within the mesh vertex data. The
+        // indices are relative to this vertex, so it is used as the vertex
+        // offset when drawing the primitive.
+        size_t vertexBase = 0;
+        size_t vertexCount = 0;
+
+        // 16-bit indices are used when the primitive's vertex count allows
+        IndexType indexType = IndexType::Uint32;
+
+        // the simplified index ranges of this primitive relative to
+        // **indexBase**, ordered from the full detail (lod 0) to the coarsest.
+        // Empty if no lods were generated.
+        std::vector<Lod> lods;
+
+        // the clusters of the full detail indices, relative to **indexBase**.
+        // Empty if clusters haven't been built for the mesh.
+        std::vector<Cluster> clusters;
+
+        [[nodiscard]] size_t indexSize() const noexcept
+        {
+            return indexType == IndexType::Uint16 ? sizeof(uint16_t) : sizeof(uint32_t);
+        }
+
+        // the number of indices including those of the lods
+        [[nodiscard]] size_t totalIndexCount() const noexcept
+        {
+            return lods.empty() ? indexCount : lods.back().indexBase + lods.back().indexCount;
+        }
+    };
+
+    /**
+     * @brief The attributes to compress when calling **quantise**. Attributes
+     * that are disabled are kept as 32-bit floats.
+     */
+    struct QuantisationOptions
+    {
+        // unorm16 positions relative to the mesh bounds - the shader
+        // dequantises using **positionOffset_** and **positionScale_**.
+        bool positions = true;
+        // octahedral encoded as 2 x snorm16.
+        bool normals = true;
+        // half floats - uvs outside of the [0, 1] range are preserved.
+        bool uvs = true;
+        // unorm8 weights and uint8 (or uint16 if more than 256 joints) indices.
+        bool skin = true;
+    };
+
+    /**
+     * @brief The maximum error introduced by the quantisation for each attribute.
+     */
+    struct QuantisationError
+    {
+        // in model space units
+        float position = 0.0f;
+        // the angle in degrees between the original and decoded normal
+        float normal = 0.0f;
+        float uv = 0.0f;
+        float weight = 0.0f;
     };
 
     ModelMesh();
@@ -142,8 +265,64 @@ public:
         const std::vector<int>& indices,
         const Topology& topo);
 
+    /**
+     * @brief Prepares the vertex layout, counts and bounds of the mesh. No
+     * vertex data is copied at this point - the attributes are read straight
+     * from the gltf buffers when calling @p writeVertices.
+     */
     bool build(const cgltf_mesh& mesh, GltfModel& model);
 
+    /**
+     * @brief Interleaves the vertex attributes of all primitives into the
+     * specified memory. This is intended to be called with mapped staging
+     * memory so no intermediate copy of the vertices is required.
+     * @param dst Must be at least **vertices_.size** bytes in size.
+     */
+    void writeVertices(void* dst) const;
+
+    /**
+     * @brief Writes the indices of a primitive, including its lods, into the
+     * specified memory in the format given by **Primitive::indexType**. The
+     * indices are relative to **Primitive::vertexBase**.
+     * @param dst Must be at least **Primitive::totalIndexCount()** *
+     * **Primitive::indexSize()** bytes in size.
+     */
+    void writeIndices(size_t primIdx, void* dst) const;
+
+    /**
+     * @brief Runs the import-time optimisations over each primitive: removes
+     * duplicate vertices, reorders the triangles for the vertex cache and
+     * overdraw and the vertices for fetch locality. The optimised data is kept
+     * on the host and copied out by @p writeVertices / @p writeIndices.
+     */
+    void optimise();
+
+    /**
+     * @brief Generates a chain of simplified index ranges for each primitive
+     * which share the primitive vertices - see **Primitive::lods**. All
+     * primitives have the same number of levels. This must be called after
+     * @p optimise and before @p quantise.
+     */
+    void generateLods(const LodOptions& options);
+
+    /**
+     * @brief Splits the full detail indices of large primitives into clusters
+     * which can be culled individually - see **Primitive::clusters**. Once
+     * built, the clusters of all primitives cover the full detail mesh. The
+     * triangles are reordered within each primitive so that each cluster is a
+     * contiguous index range. This must be called before @p quantise.
+     */
+    void buildClusters(const ClusterOptions& options);
+
+    /**
+     * @brief Compresses the vertex attributes into the formats given by
+     * **options**, updating the vertex layout. This must be called after
+     * @p optimise as the optimisations expect float positions. All primitives
+     * share the vertex layout so the options apply to the whole mesh.
+     * @returns The error introduced by the quantisation.
+     */
+    QuantisationError quantise(const QuantisationOptions& options);
+
     // bool prepare(const cgltf_mesh& mesh, GltfModel& model);
 
     // bool prepare(aiScene* scene);
@@ -167,13 +346,55 @@ public:
     /// All vertivces associated with the particular model
     VertexBuffer vertices_;
 
-    /// All indices associated with this particular model
+    /// All indices associated with this particular model. Only used by
+    /// meshes created via **create** - gltf meshes write their indices
+    /// directly via **writeIndices**
     std::vector<uint32_t> indices_;
 
+    /// the total number of indices over all primitives, including the lods
+    size_t indexCount_ = 0;
+
+    /// the mesh space position is **positionOffset_** + **positionScale_** * p
+    /// where p is the quantised position. If positions aren't quantised this
+    /// is the identity.
+    mathfu::vec3 positionOffset_ = mathfu::vec3 {0.0f};
+    mathfu::vec3 positionScale_ = mathfu::vec3 {1.0f};
+
     /// variation of the mesh shader
     util::BitSetEnum<Variant> variantBits_;
 
+    friend class BakedModel;
+
+private:
+    template <typename T>
+    void gatherIndices(size_t primIdx, T* dst) const;
+
+    void updateIndexTypes() noexcept;
+
+    // copies the vertices and indices to the host if they are still in the
+    // gltf buffers
+    void gatherHostData();
+
 private:
+    // the gltf accessors for each primitive - read from when writing the
+    // vertex and index data
+    struct PrimitiveSource
+    {
+        const cgltf_accessor* position = nullptr;
+        const cgltf_accessor* uv = nullptr;
+        const cgltf_accessor* normal = nullptr;
+        const cgltf_accessor* weights = nullptr;
+        const cgltf_accessor* joints = nullptr;
+        const cgltf_accessor* indices = nullptr;
+    };
+
+    std::vector<PrimitiveSource> sources_;
+
+    // the vertex and index data of meshes loaded from a baked model - these
+    // point into the mapped file, already in the gpu layout. There is an
+    // index blob per primitive.
+    const uint8_t* bakedVertices_ = nullptr;
+    std::vector<const uint8_t*> bakedIndices_;
 };
 
 } // namespace yave
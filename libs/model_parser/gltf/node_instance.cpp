@@ -122,19 +122,23 @@ bool NodeInstance::prepareNodeHierachy(
 {
     ASSERT_LOG(newNode);
     newNode->parent = parent;
-    // newNode->id = nodeIdx++;
+
+    // the node name has been replaced by its linearised id by the model
+    newNode->id = node->name;
 
     if (node->mesh)
     {
-        mesh_ = std::make_unique<ModelMesh>();
-        mesh_->build(*node->mesh, model);
-        newNode->hasMesh = true;
-
-        if (node->skin)
+        if (meshSource_)
         {
-            skin_ = std::make_unique<SkinInstance>();
-            skin_->prepare(*node->skin, *this);
+            LOGGER_WARN("Node hierachy contains more than one mesh - only the first will be "
+                        "used.\n");
         }
+        else
+        {
+            meshSource_ = node->mesh;
+            skinSource_ = node->skin;
+        }
+        newNode->hasMesh = true;
 
         // propogate transforms through node list
         prepareTranslation(node, newNode);
@@ -146,7 +150,8 @@ bool NodeInstance::prepareNodeHierachy(
     for (cgltf_node* const* child = node->children; child < childEnd; ++child)
     {
         NodeInfo* childNode = new NodeInfo();
-        if (!prepareNodeHierachy(node, childNode, newNode, newNode->nodeTransform, model, nodeIdx))
+        if (!prepareNodeHierachy(
+                *child, childNode, newNode, newNode->nodeTransform, model, nodeIdx))
         {
             return false;
         }
@@ -200,6 +205,43 @@ bool NodeInstance::prepare(cgltf_node* node, GltfModel& model)
         return false;
     }
 
+    // the joints can only be found once the whole hierachy is known
+    if (skinSource_)
+    {
+        skin_ = std::make_unique<SkinInstance>();
+        skin_->prepare(*skinSource_, *this);
+    }
+
+    return true;
+}
+
+bool NodeInstance::buildMesh(GltfModel& model)
+{
+    if (!meshSource_)
+    {
+        return true;
+    }
+    mesh_ = std::make_unique<ModelMesh>();
+    if (!mesh_->build(*meshSource_, model))
+    {
+        return false;
+    }
+    if (model.isMeshOptimisationEnabled())
+    {
+        mesh_->optimise();
+    }
+    if (model.isLodGenerationEnabled())
+    {
+        mesh_->generateLods(model.getLodOptions());
+    }
+    if (model.isClusterGenerationEnabled())
+    {
+        mesh_->buildClusters(model.getClusterOptions());
+    }
+    if (model.isVertexQuantisationEnabled())
+    {
+        mesh_->quantise(model.getQuantisationOptions());
+    }
     return true;
 }
 
@@ -90,14 +90,29 @@ public:
 
     void prepareTranslation(cgltf_node* node, NodeInfo* newNode);
 
+    /**
+     * @brief Prepares the node hierachy and skin. The mesh is not built at
+     * this point - see @p buildMesh.
+     */
     bool prepare(cgltf_node* node, GltfModel& model);
 
+    /**
+     * @brief Builds the mesh found in the node hierachy (if there is one).
+     * Separated from @p prepare so meshes can be built in parallel once all
+     * hierachies are known.
+     */
+    bool buildMesh(GltfModel& model);
+
     NodeInfo* getNode(util::CString id);
 
+    [[nodiscard]] bool hasMesh() const noexcept { return mesh_ != nullptr; }
+
     ModelMesh* getMesh();
     SkinInstance* getSkin();
     NodeInfo* getRootNode();
 
+    friend class BakedModel;
+
 private:
     bool prepareNodeHierachy(
         cgltf_node* node,
@@ -113,6 +128,10 @@ private:
     // we expect one mesh per node hierachy.
     std::unique_ptr<ModelMesh> mesh_;
 
+    // the gltf mesh and skin found when preparing the hierachy
+    const cgltf_mesh* meshSource_ = nullptr;
+    cgltf_skin* skinSource_ = nullptr;
+
     // the node hierachy
     std::unique_ptr<NodeInfo> rootNode_;
 
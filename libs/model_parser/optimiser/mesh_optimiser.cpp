@@ -0,0 +1,1170 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "mesh_optimiser.h"
+
+#include "utility/assertion.h"
+#include "utility/murmurhash.h"
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+
+namespace yave
+{
+
+namespace
+{
+
+// ============================ vertex hashing ==============================
+
+struct VertexHasher
+{
+    const uint8_t* vertices;
+    size_t stride;
+
+    size_t operator()(uint32_t index) const noexcept
+    {
+        return util::murmurHash3(
+            reinterpret_cast<const uint32_t*>(vertices + index * stride), stride, 0);
+    }
+};
+
+struct VertexEqual
+{
+    const uint8_t* vertices;
+    size_t stride;
+
+    bool operator()(uint32_t lhs, uint32_t rhs) const noexcept
+    {
+        return memcmp(vertices + lhs * stride, vertices + rhs * stride, stride) == 0;
+    }
+};
+
+// ========================== forsyth scoring ===============================
+
+constexpr float CacheDecayPower = 1.5f;
+constexpr float LastTriScore = 0.75f;
+constexpr float ValenceBoostScale = 2.0f;
+constexpr float ValenceBoostPower = 0.5f;
+
+// valence scores are tabulated up to this count
+constexpr uint32_t MaxValence = 64;
+
+struct ScoreTable
+{
+    ScoreTable()
+    {
+        for (uint32_t pos = 0; pos < MeshOptimiser::VertexCacheSize; ++pos)
+        {
+            if (pos < 3)
+            {
+                // the vertices of the last triangle are given a fixed score
+                // so the next triangle doesn't just reuse the same edge.
+                cache[pos] = LastTriScore;
+            }
+            else
+            {
+                const float scale = 1.0f / (MeshOptimiser::VertexCacheSize - 3);
+                cache[pos] = std::pow(1.0f - (pos - 3) * scale, CacheDecayPower);
+            }
+        }
+        valence[0] = 0.0f;
+        for (uint32_t count = 1; count < MaxValence; ++count)
+        {
+            valence[count] = ValenceBoostScale * std::pow(float(count), -ValenceBoostPower);
+        }
+    }
+
+    float score(int32_t cachePos, uint32_t remainingTris) const noexcept
+    {
+        if (!remainingTris)
+        {
+            return -1.0f;
+        }
+        float result = cachePos >= 0 ? cache[cachePos] : 0.0f;
+        return result + valence[std::min(remainingTris, MaxValence - 1)];
+    }
+
+    std::array<float, MeshOptimiser::VertexCacheSize> cache;
+    std::array<float, MaxValence> valence;
+};
+
+// Simulates a FIFO cache using timestamps - a vertex is in the cache if it was
+// one of the last @p cacheSize vertices to be inserted.
+class FifoCache
+{
+public:
+    FifoCache(size_t vertexCount, uint32_t cacheSize)
+        : timestamps_(vertexCount, 0), time_(cacheSize + 1), cacheSize_(cacheSize)
+    {
+    }
+
+    // returns whether the vertex was a cache miss
+    bool access(uint32_t vertex) noexcept
+    {
+        if (time_ - timestamps_[vertex] > cacheSize_)
+        {
+            timestamps_[vertex] = time_++;
+            return true;
+        }
+        return false;
+    }
+
+    uint32_t triangleMisses(const uint32_t* tri) noexcept
+    {
+        return access(tri[0]) + access(tri[1]) + access(tri[2]);
+    }
+
+private:
+    std::vector<uint32_t> timestamps_;
+    uint32_t time_;
+    uint32_t cacheSize_;
+};
+
+struct Vec3
+{
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+};
+
+Vec3 getPosition(const float* positions, size_t stride, uint32_t index)
+{
+    const float* p = reinterpret_cast<const float*>(
+        reinterpret_cast<const uint8_t*>(positions) + index * stride);
+    return {p[0], p[1], p[2]};
+}
+
+// ============================ simplification ==============================
+
+// the maximum number of collapse passes - each pass collapses a set of
+// independent edges, usually reducing the triangle count by 10-20%.
+constexpr uint32_t MaxSimplifyPasses = 100;
+
+/**
+ * @brief A symmetric 4x4 matrix representing the sum of squared distances to
+ * a set of planes, weighted by the area of the triangle the plane was taken
+ * from.
+ */
+struct Quadric
+{
+    double a00 = 0.0, a11 = 0.0, a22 = 0.0;
+    double a10 = 0.0, a20 = 0.0, a21 = 0.0;
+    double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+    double c = 0.0;
+    double weight = 0.0;
+
+    static Quadric fromPlane(double a, double b, double cc, double d, double w)
+    {
+        Quadric q;
+        q.a00 = a * a * w;
+        q.a11 = b * b * w;
+        q.a22 = cc * cc * w;
+        q.a10 = a * b * w;
+        q.a20 = a * cc * w;
+        q.a21 = b * cc * w;
+        q.b0 = a * d * w;
+        q.b1 = b * d * w;
+        q.b2 = cc * d * w;
+        q.c = d * d * w;
+        q.weight = w;
+        return q;
+    }
+
+    Quadric& operator+=(const Quadric& rhs)
+    {
+        a00 += rhs.a00;
+        a11 += rhs.a11;
+        a22 += rhs.a22;
+        a10 += rhs.a10;
+        a20 += rhs.a20;
+        a21 += rhs.a21;
+        b0 += rhs.b0;
+        b1 += rhs.b1;
+        b2 += rhs.b2;
+        c += rhs.c;
+        weight += rhs.weight;
+        return *this;
+    }
+
+    // the weighted squared distance of the point to the planes
+    [[nodiscard]] double error(const Vec3& p) const
+    {
+        double x = p.x, y = p.y, z = p.z;
+        double result = a00 * x * x + a11 * y * y + a22 * z * z;
+        result += 2.0 * (a10 * x * y + a20 * x * z + a21 * y * z);
+        result += 2.0 * (b0 * x + b1 * y + b2 * z);
+        result += c;
+        return std::abs(result);
+    }
+};
+
+struct Collapse
+{
+    uint32_t from;
+    uint32_t to;
+    float error;
+};
+
+Vec3 sub(const Vec3& lhs, const Vec3& rhs) { return {lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z}; }
+
+Vec3 cross(const Vec3& lhs, const Vec3& rhs)
+{
+    return {
+        lhs.y * rhs.z - lhs.z * rhs.y,
+        lhs.z * rhs.x - lhs.x * rhs.z,
+        lhs.x * rhs.y - lhs.y * rhs.x};
+}
+
+float dot(const Vec3& lhs, const Vec3& rhs)
+{
+    return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
+}
+
+// whether moving vertex @p from to @p to flips the triangle (or makes it degenerate)
+bool collapseFlipsTriangle(
+    const std::vector<Vec3>& positions, const uint32_t* tri, uint32_t from, uint32_t to)
+{
+    const Vec3& p0 = positions[tri[0]];
+    const Vec3& p1 = positions[tri[1]];
+    const Vec3& p2 = positions[tri[2]];
+    Vec3 before = cross(sub(p1, p0), sub(p2, p0));
+
+    const Vec3& q0 = positions[tri[0] == from ? to : tri[0]];
+    const Vec3& q1 = positions[tri[1] == from ? to : tri[1]];
+    const Vec3& q2 = positions[tri[2] == from ? to : tri[2]];
+    Vec3 after = cross(sub(q1, q0), sub(q2, q0));
+
+    // the triangle must keep facing in roughly the same direction
+    return dot(before, after) <= 0.25f * std::sqrt(dot(before, before) * dot(after, after));
+}
+
+
+// ================== meshlets ==================================
+
+Vec3 triangleCentroid(const float* positions, size_t stride, const uint32_t* tri)
+{
+    Vec3 p0 = getPosition(positions, stride, tri[0]);
+    Vec3 p1 = getPosition(positions, stride, tri[1]);
+    Vec3 p2 = getPosition(positions, stride, tri[2]);
+    return {(p0.x + p1.x + p2.x) / 3.0f, (p0.y + p1.y + p2.y) / 3.0f, (p0.z + p1.z + p2.z) / 3.0f};
+}
+
+// the bounding sphere and normal cone of the triangles referenced by the meshlet
+void computeMeshletBounds(
+    MeshOptimiser::Meshlet& meshlet, const uint32_t* indices, const float* positions, size_t stride)
+{
+    const uint32_t* tris = indices + meshlet.indexOffset;
+    const size_t indexCount = meshlet.triangleCount * 3;
+
+    // the sphere is centered on the bounding box, which is close enough to
+    // the minimal sphere for the small clusters dealt with here
+    Vec3 minPos {FLT_MAX, FLT_MAX, FLT_MAX};
+    Vec3 maxPos {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        Vec3 p = getPosition(positions, stride, tris[i]);
+        minPos = {std::min(minPos.x, p.x), std::min(minPos.y, p.y), std::min(minPos.z, p.z)};
+        maxPos = {std::max(maxPos.x, p.x), std::max(maxPos.y, p.y), std::max(maxPos.z, p.z)};
+    }
+    Vec3 center {
+        (minPos.x + maxPos.x) * 0.5f, (minPos.y + maxPos.y) * 0.5f, (minPos.z + maxPos.z) * 0.5f};
+    float radiusSq = 0.0f;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        Vec3 dist = sub(getPosition(positions, stride, tris[i]), center);
+        radiusSq = std::max(radiusSq, dot(dist, dist));
+    }
+    meshlet.center[0] = center.x;
+    meshlet.center[1] = center.y;
+    meshlet.center[2] = center.z;
+    meshlet.radius = std::sqrt(radiusSq);
+
+    // the cone axis is the average of the unit triangle normals - degenerate
+    // triangles are ignored as they are never rasterised
+    std::vector<Vec3> normals;
+    normals.reserve(meshlet.triangleCount);
+    Vec3 axis;
+    for (size_t i = 0; i < indexCount; i += 3)
+    {
+        Vec3 p0 = getPosition(positions, stride, tris[i]);
+        Vec3 n = cross(
+            sub(getPosition(positions, stride, tris[i + 1]), p0),
+            sub(getPosition(positions, stride, tris[i + 2]), p0));
+        float len = std::sqrt(dot(n, n));
+        if (len == 0.0f)
+        {
+            continue;
+        }
+        n = {n.x / len, n.y / len, n.z / len};
+        normals.emplace_back(n);
+        axis = {axis.x + n.x, axis.y + n.y, axis.z + n.z};
+    }
+
+    float axisLen = std::sqrt(dot(axis, axis));
+    if (normals.empty() || axisLen == 0.0f)
+    {
+        meshlet.coneCutoff = 1.0f;
+        return;
+    }
+    axis = {axis.x / axisLen, axis.y / axisLen, axis.z / axisLen};
+
+    float minDot = 1.0f;
+    for (const Vec3& n : normals)
+    {
+        minDot = std::min(minDot, dot(n, axis));
+    }
+    meshlet.coneAxis[0] = axis.x;
+    meshlet.coneAxis[1] = axis.y;
+    meshlet.coneAxis[2] = axis.z;
+    // cones approaching a hemisphere will rarely be culled, so these are
+    // never tested rather than paying for the test
+    meshlet.coneCutoff = minDot <= 0.1f ? 1.0f : std::sqrt(1.0f - minDot * minDot);
+}
+
+} // namespace
+
+size_t MeshOptimiser::generateVertexRemap(
+    std::vector<uint32_t>& remap,
+    const uint32_t* indices,
+    size_t indexCount,
+    const void* vertices,
+    size_t vertexCount,
+    size_t vertexStride)
+{
+    ASSERT_FATAL(
+        vertexStride >= 4 && (vertexStride % 4) == 0,
+        "Vertex stride must be a multiple of four bytes (stride: %d).",
+        vertexStride);
+
+    const auto* data = static_cast<const uint8_t*>(vertices);
+    std::unordered_map<uint32_t, uint32_t, VertexHasher, VertexEqual> uniqueVertices(
+        vertexCount, VertexHasher {data, vertexStride}, VertexEqual {data, vertexStride});
+
+    remap.assign(vertexCount, Unused);
+
+    uint32_t nextVertex = 0;
+    for (size_t idx = 0; idx < indexCount; ++idx)
+    {
+        uint32_t index = indices[idx];
+        ASSERT_LOG(index < vertexCount);
+        if (remap[index] != Unused)
+        {
+            continue;
+        }
+        auto [iter, inserted] = uniqueVertices.emplace(index, nextVertex);
+        remap[index] = iter->second;
+        if (inserted)
+        {
+            ++nextVertex;
+        }
+    }
+    return nextVertex;
+}
+
+void MeshOptimiser::remapVertices(
+    void* dst, const void* vertices, size_t vertexCount, size_t vertexStride, const uint32_t* remap)
+{
+    const auto* src = static_cast<const uint8_t*>(vertices);
+    auto* out = static_cast<uint8_t*>(dst);
+    for (size_t idx = 0; idx < vertexCount; ++idx)
+    {
+        if (remap[idx] != Unused)
+        {
+            memcpy(out + remap[idx] * vertexStride, src + idx * vertexStride, vertexStride);
+        }
+    }
+}
+
+void MeshOptimiser::remapIndices(
+    uint32_t* dst, const uint32_t* indices, size_t indexCount, const uint32_t* remap)
+{
+    for (size_t idx = 0; idx < indexCount; ++idx)
+    {
+        ASSERT_LOG(remap[indices[idx]] != Unused);
+        dst[idx] = remap[indices[idx]];
+    }
+}
+
+void MeshOptimiser::optimiseVertexCache(
+    uint32_t* dst, const uint32_t* indices, size_t indexCount, size_t vertexCount)
+{
+    ASSERT_FATAL((indexCount % 3) == 0, "Index count must be a multiple of three.");
+    static const ScoreTable scoreTable;
+
+    const size_t triCount = indexCount / 3;
+    if (!triCount)
+    {
+        return;
+    }
+
+    // keep a copy of the source as the output may alias it
+    std::vector<uint32_t> src(indices, indices + indexCount);
+
+    // the triangles which reference each vertex - the first remainingTris
+    // entries of each list are the triangles still to be emitted.
+    std::vector<uint32_t> remainingTris(vertexCount, 0);
+    for (uint32_t index : src)
+    {
+        ++remainingTris[index];
+    }
+    std::vector<uint32_t> adjOffsets(vertexCount + 1, 0);
+    std::partial_sum(remainingTris.begin(), remainingTris.end(), adjOffsets.begin() + 1);
+
+    std::vector<uint32_t> adjacency(indexCount);
+    {
+        std::vector<uint32_t> fill(adjOffsets.begin(), adjOffsets.end() - 1);
+        for (size_t idx = 0; idx < indexCount; ++idx)
+        {
+            adjacency[fill[src[idx]]++] = static_cast<uint32_t>(idx / 3);
+        }
+    }
+
+    std::vector<int32_t> cachePos(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        vertexScores[v] = scoreTable.score(-1, remainingTris[v]);
+    }
+
+    std::vector<float> triScores(triCount);
+    for (size_t tri = 0; tri < triCount; ++tri)
+    {
+        const uint32_t* t = &src[tri * 3];
+        triScores[tri] = vertexScores[t[0]] + vertexScores[t[1]] + vertexScores[t[2]];
+    }
+    std::vector<bool> emitted(triCount, false);
+
+    std::array<uint32_t, VertexCacheSize + 3> cache;
+    std::array<uint32_t, VertexCacheSize + 3> newCache;
+    size_t cacheCount = 0;
+
+    constexpr uint32_t InvalidTri = UINT32_MAX;
+    uint32_t bestTri = static_cast<uint32_t>(
+        std::max_element(triScores.begin(), triScores.end()) - triScores.begin());
+    size_t cursor = 0;
+
+    for (size_t outTri = 0; outTri < triCount; ++outTri)
+    {
+        if (bestTri == InvalidTri)
+        {
+            // nothing in the cache has any triangles left - continue from
+            // the next triangle in the original order.
+            while (emitted[cursor])
+            {
+                ++cursor;
+            }
+            bestTri = static_cast<uint32_t>(cursor);
+        }
+
+        const uint32_t* tri = &src[bestTri * 3];
+        memcpy(dst + outTri * 3, tri, sizeof(uint32_t) * 3);
+        emitted[bestTri] = true;
+
+        // remove the triangle from the adjacency of its vertices
+        for (size_t i = 0; i < 3; ++i)
+        {
+            uint32_t v = tri[i];
+            uint32_t* begin = adjacency.data() + adjOffsets[v];
+            uint32_t* end = begin + remainingTris[v];
+            uint32_t* found = std::find(begin, end, bestTri);
+            ASSERT_LOG(found != end);
+            std::swap(*found, *(end - 1));
+            --remainingTris[v];
+        }
+
+        // the triangle's vertices move to the front of the cache
+        size_t newCount = 0;
+        newCache[newCount++] = tri[0];
+        newCache[newCount++] = tri[1];
+        newCache[newCount++] = tri[2];
+        for (size_t i = 0; i < cacheCount; ++i)
+        {
+            uint32_t v = cache[i];
+            if (v != tri[0] && v != tri[1] && v != tri[2])
+            {
+                newCache[newCount++] = v;
+            }
+        }
+
+        // update the vertex scores and propagate the change to the triangles
+        for (size_t i = 0; i < newCount; ++i)
+        {
+            uint32_t v = newCache[i];
+            cachePos[v] = i < VertexCacheSize ? static_cast<int32_t>(i) : -1;
+
+            float score = scoreTable.score(cachePos[v], remainingTris[v]);
+            float delta = score - vertexScores[v];
+            vertexScores[v] = score;
+
+            const uint32_t* adjBegin = adjacency.data() + adjOffsets[v];
+            for (uint32_t j = 0; j < remainingTris[v]; ++j)
+            {
+                triScores[adjBegin[j]] += delta;
+            }
+        }
+
+        // the next triangle is the best scoring one referenced by the cache
+        bestTri = InvalidTri;
+        float bestScore = -1.0f;
+        cacheCount = std::min(newCount, static_cast<size_t>(VertexCacheSize));
+        for (size_t i = 0; i < cacheCount; ++i)
+        {
+            uint32_t v = newCache[i];
+            cache[i] = v;
+
+            const uint32_t* adjBegin = adjacency.data() + adjOffsets[v];
+            for (uint32_t j = 0; j < remainingTris[v]; ++j)
+            {
+                uint32_t t = adjBegin[j];
+                if (triScores[t] > bestScore)
+                {
+                    bestScore = triScores[t];
+                    bestTri = t;
+                }
+            }
+        }
+    }
+}
+
+void MeshOptimiser::optimiseOverdraw(
+    uint32_t* dst,
+    const uint32_t* indices,
+    size_t indexCount,
+    const float* positions,
+    size_t vertexCount,
+    size_t positionStride,
+    float threshold)
+{
+    ASSERT_FATAL((indexCount % 3) == 0, "Index count must be a multiple of three.");
+    ASSERT_FATAL(dst != indices, "The output indices must not alias the input.");
+
+    const size_t triCount = indexCount / 3;
+    if (!triCount)
+    {
+        return;
+    }
+
+    // cache misses per triangle for the current order
+    std::vector<uint32_t> triMisses(triCount);
+    {
+        FifoCache cache(vertexCount, AnalyseCacheSize);
+        for (size_t tri = 0; tri < triCount; ++tri)
+        {
+            triMisses[tri] = cache.triangleMisses(&indices[tri * 3]);
+        }
+    }
+
+    // hard boundaries are where the cache has been flushed (all three vertices
+    // missed) - the cache state is independent of what came before, so the
+    // clusters can be reordered without affecting the vertex cache.
+    std::vector<uint32_t> hardClusters;
+    for (size_t tri = 0; tri < triCount; ++tri)
+    {
+        if (tri == 0 || triMisses[tri] == 3)
+        {
+            hardClusters.emplace_back(static_cast<uint32_t>(tri));
+        }
+    }
+
+    // split further at points where the cluster ACMR is within the
+    // threshold - this gives more clusters to sort at a small cache cost.
+    std::vector<uint32_t> clusters;
+    for (size_t i = 0; i < hardClusters.size(); ++i)
+    {
+        const uint32_t start = hardClusters[i];
+        const uint32_t end =
+            i + 1 < hardClusters.size() ? hardClusters[i + 1] : static_cast<uint32_t>(triCount);
+
+        uint32_t clusterMisses = 0;
+        for (uint32_t tri = start; tri < end; ++tri)
+        {
+            clusterMisses += triMisses[tri];
+        }
+        const float clusterThreshold = threshold * float(clusterMisses) / float(end - start);
+
+        clusters.emplace_back(start);
+        uint32_t softStart = start;
+        uint32_t runningMisses = 0;
+        for (uint32_t tri = start; tri < end; ++tri)
+        {
+            runningMisses += triMisses[tri];
+            const float acmr = float(runningMisses) / float(tri + 1 - softStart);
+            if (tri + 1 < end && acmr <= clusterThreshold)
+            {
+                clusters.emplace_back(tri + 1);
+                softStart = tri + 1;
+                runningMisses = 0;
+            }
+        }
+    }
+
+    // the area weighted centroid and normal of each cluster
+    struct ClusterInfo
+    {
+        Vec3 centroid;
+        Vec3 normal;
+        float area = 0.0f;
+    };
+    std::vector<ClusterInfo> infos(clusters.size());
+
+    Vec3 meshCentroid;
+    float meshArea = 0.0f;
+    for (size_t i = 0; i < clusters.size(); ++i)
+    {
+        const uint32_t start = clusters[i];
+        const uint32_t end =
+            i + 1 < clusters.size() ? clusters[i + 1] : static_cast<uint32_t>(triCount);
+
+        ClusterInfo& info = infos[i];
+        for (uint32_t tri = start; tri < end; ++tri)
+        {
+            Vec3 p0 = getPosition(positions, positionStride, indices[tri * 3]);
+            Vec3 p1 = getPosition(positions, positionStride, indices[tri * 3 + 1]);
+            Vec3 p2 = getPosition(positions, positionStride, indices[tri * 3 + 2]);
+
+            Vec3 e0 {p1.x - p0.x, p1.y - p0.y, p1.z - p0.z};
+            Vec3 e1 {p2.x - p0.x, p2.y - p0.y, p2.z - p0.z};
+            Vec3 n {e0.y * e1.z - e0.z * e1.y, e0.z * e1.x - e0.x * e1.z, e0.x * e1.y - e0.y * e1.x};
+            float area = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+
+            info.centroid.x += (p0.x + p1.x + p2.x) * (area / 3.0f);
+            info.centroid.y += (p0.y + p1.y + p2.y) * (area / 3.0f);
+            info.centroid.z += (p0.z + p1.z + p2.z) * (area / 3.0f);
+            info.normal.x += n.x;
+            info.normal.y += n.y;
+            info.normal.z += n.z;
+            info.area += area;
+        }
+
+        meshCentroid.x += info.centroid.x;
+        meshCentroid.y += info.centroid.y;
+        meshCentroid.z += info.centroid.z;
+        meshArea += info.area;
+
+        if (info.area > 0.0f)
+        {
+            info.centroid.x /= info.area;
+            info.centroid.y /= info.area;
+            info.centroid.z /= info.area;
+        }
+    }
+    if (meshArea > 0.0f)
+    {
+        meshCentroid.x /= meshArea;
+        meshCentroid.y /= meshArea;
+        meshCentroid.z /= meshArea;
+    }
+
+    // clusters facing away from the centre of the mesh are likely to occlude
+    // the rest so are drawn first
+    std::vector<float> sortKeys(clusters.size());
+    for (size_t i = 0; i < clusters.size(); ++i)
+    {
+        const ClusterInfo& info = infos[i];
+        Vec3 dir {
+            info.centroid.x - meshCentroid.x,
+            info.centroid.y - meshCentroid.y,
+            info.centroid.z - meshCentroid.z};
+        float length = std::sqrt(
+            info.normal.x * info.normal.x + info.normal.y * info.normal.y +
+            info.normal.z * info.normal.z);
+        float invLength = length > 0.0f ? 1.0f / length : 0.0f;
+        sortKeys[i] = (dir.x * info.normal.x + dir.y * info.normal.y + dir.z * info.normal.z) *
+            invLength;
+    }
+
+    std::vector<uint32_t> order(clusters.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&sortKeys](uint32_t lhs, uint32_t rhs) {
+        return sortKeys[lhs] > sortKeys[rhs];
+    });
+
+    uint32_t* out = dst;
+    for (uint32_t cluster : order)
+    {
+        const uint32_t start = clusters[cluster];
+        const uint32_t end = cluster + 1 < clusters.size() ? clusters[cluster + 1]
+                                                            : static_cast<uint32_t>(triCount);
+        const size_t count = (end - start) * 3;
+        memcpy(out, indices + start * 3, count * sizeof(uint32_t));
+        out += count;
+    }
+}
+
+size_t MeshOptimiser::optimiseVertexFetch(
+    void* dst,
+    uint32_t* indices,
+    size_t indexCount,
+    const void* vertices,
+    size_t vertexCount,
+    size_t vertexStride)
+{
+    ASSERT_FATAL(dst != vertices, "The output vertices must not alias the input.");
+
+    const auto* src = static_cast<const uint8_t*>(vertices);
+    auto* out = static_cast<uint8_t*>(dst);
+
+    std::vector<uint32_t> remap(vertexCount, Unused);
+    uint32_t nextVertex = 0;
+    for (size_t idx = 0; idx < indexCount; ++idx)
+    {
+        uint32_t& index = indices[idx];
+        ASSERT_LOG(index < vertexCount);
+        if (remap[index] == Unused)
+        {
+            memcpy(out + nextVertex * vertexStride, src + index * vertexStride, vertexStride);
+            remap[index] = nextVertex++;
+        }
+        index = remap[index];
+    }
+    return nextVertex;
+}
+
+size_t MeshOptimiser::simplify(
+    uint32_t* dst,
+    const uint32_t* indices,
+    size_t indexCount,
+    const float* positions,
+    size_t vertexCount,
+    size_t positionStride,
+    size_t targetIndexCount,
+    float targetError,
+    float* resultError)
+{
+    ASSERT_LOG(indexCount % 3 == 0);
+
+    std::vector<uint32_t> result(indices, indices + indexCount);
+    if (resultError)
+    {
+        *resultError = 0.0f;
+    }
+    if (indexCount <= targetIndexCount)
+    {
+        std::copy(result.begin(), result.end(), dst);
+        return indexCount;
+    }
+
+    // positions are normalised to the mesh extent so the error is scale independent
+    Vec3 minPos {FLT_MAX, FLT_MAX, FLT_MAX};
+    Vec3 maxPos {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    for (uint32_t idx : result)
+    {
+        Vec3 p = getPosition(positions, positionStride, idx);
+        minPos = {std::min(minPos.x, p.x), std::min(minPos.y, p.y), std::min(minPos.z, p.z)};
+        maxPos = {std::max(maxPos.x, p.x), std::max(maxPos.y, p.y), std::max(maxPos.z, p.z)};
+    }
+    float extent = std::max({maxPos.x - minPos.x, maxPos.y - minPos.y, maxPos.z - minPos.z});
+    float invExtent = extent > 0.0f ? 1.0f / extent : 0.0f;
+
+    std::vector<Vec3> vertPositions(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        Vec3 p = getPosition(positions, positionStride, static_cast<uint32_t>(i));
+        vertPositions[i] = {
+            (p.x - minPos.x) * invExtent,
+            (p.y - minPos.y) * invExtent,
+            (p.z - minPos.z) * invExtent};
+    }
+
+    // Vertices on an edge without an opposing half-edge are locked - this
+    // covers open borders and attribute seams, where the two sides of the seam
+    // reference different vertices.
+    std::vector<bool> locked(vertexCount, false);
+    {
+        std::unordered_map<uint64_t, uint32_t> halfEdges;
+        halfEdges.reserve(indexCount);
+        for (size_t i = 0; i < indexCount; i += 3)
+        {
+            for (int e = 0; e < 3; ++e)
+            {
+                uint64_t v0 = result[i + e];
+                uint64_t v1 = result[i + (e + 1) % 3];
+                ++halfEdges[(v0 << 32) | v1];
+            }
+        }
+        for (const auto& [edge, count] : halfEdges)
+        {
+            auto v0 = static_cast<uint32_t>(edge >> 32);
+            auto v1 = static_cast<uint32_t>(edge & 0xffffffff);
+            if (halfEdges.find((static_cast<uint64_t>(v1) << 32) | v0) == halfEdges.end())
+            {
+                locked[v0] = true;
+                locked[v1] = true;
+            }
+        }
+    }
+
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i < indexCount; i += 3)
+    {
+        const Vec3& p0 = vertPositions[result[i]];
+        const Vec3& p1 = vertPositions[result[i + 1]];
+        const Vec3& p2 = vertPositions[result[i + 2]];
+        Vec3 normal = cross(sub(p1, p0), sub(p2, p0));
+        float area = std::sqrt(dot(normal, normal));
+        if (area > 0.0f)
+        {
+            normal = {normal.x / area, normal.y / area, normal.z / area};
+        }
+        Quadric q = Quadric::fromPlane(normal.x, normal.y, normal.z, -dot(normal, p0), area);
+        for (int v = 0; v < 3; ++v)
+        {
+            quadrics[result[i + v]] += q;
+        }
+    }
+
+    const double errorLimit = static_cast<double>(targetError) * targetError;
+    double maxError = 0.0;
+
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<bool> touched(vertexCount);
+    std::vector<uint32_t> triOffsets(vertexCount + 1);
+    std::vector<uint32_t> vertexTris;
+    std::vector<Collapse> collapses;
+
+    for (uint32_t pass = 0; pass < MaxSimplifyPasses && result.size() > targetIndexCount; ++pass)
+    {
+        const size_t triCount = result.size() / 3;
+
+        // the triangles adjacent to each vertex
+        std::fill(triOffsets.begin(), triOffsets.end(), 0);
+        for (uint32_t idx : result)
+        {
+            ++triOffsets[idx + 1];
+        }
+        std::partial_sum(triOffsets.begin(), triOffsets.end(), triOffsets.begin());
+        vertexTris.resize(result.size());
+        std::vector<uint32_t> fill(triOffsets.begin(), triOffsets.end() - 1);
+        for (size_t i = 0; i < result.size(); ++i)
+        {
+            vertexTris[fill[result[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+
+        // the cost of collapsing each edge, in the cheapest valid direction
+        collapses.clear();
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            for (int e = 0; e < 3; ++e)
+            {
+                uint32_t v0 = result[i + e];
+                uint32_t v1 = result[i + (e + 1) % 3];
+                // each interior edge is seen from both triangles - only
+                // consider it once
+                if (v0 > v1 && !locked[v0] && !locked[v1])
+                {
+                    continue;
+                }
+
+                Quadric q = quadrics[v0];
+                q += quadrics[v1];
+                double weight = std::max(q.weight, 1e-12);
+                if (!locked[v0])
+                {
+                    double error = q.error(vertPositions[v1]) / weight;
+                    collapses.push_back({v0, v1, static_cast<float>(error)});
+                }
+                if (!locked[v1])
+                {
+                    double error = q.error(vertPositions[v0]) / weight;
+                    collapses.push_back({v1, v0, static_cast<float>(error)});
+                }
+            }
+        }
+        if (collapses.empty())
+        {
+            break;
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& lhs, const Collapse& rhs) {
+            return lhs.error < rhs.error;
+        });
+
+        // each collapse removes two triangles for a closed mesh
+        const size_t trianglesToRemove = triCount - targetIndexCount / 3;
+        std::iota(remap.begin(), remap.end(), 0);
+        std::fill(touched.begin(), touched.end(), false);
+        size_t removed = 0;
+
+        for (const Collapse& collapse : collapses)
+        {
+            if (collapse.error > errorLimit || removed >= trianglesToRemove)
+            {
+                break;
+            }
+            if (touched[collapse.from] || touched[collapse.to])
+            {
+                continue;
+            }
+
+            bool valid = true;
+            size_t collapsedTris = 0;
+            for (uint32_t t = triOffsets[collapse.from]; t < triOffsets[collapse.from + 1]; ++t)
+            {
+                const uint32_t* tri = &result[vertexTris[t] * 3];
+                if (tri[0] == collapse.to || tri[1] == collapse.to || tri[2] == collapse.to)
+                {
+                    ++collapsedTris;
+                    continue;
+                }
+                if (collapseFlipsTriangle(vertPositions, tri, collapse.from, collapse.to))
+                {
+                    valid = false;
+                    break;
+                }
+            }
+            if (!valid)
+            {
+                continue;
+            }
+
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to] += quadrics[collapse.from];
+            maxError = std::max(maxError, static_cast<double>(collapse.error));
+            removed += collapsedTris;
+
+            // the triangles around the collapsed vertex have changed so can't
+            // be used to validate any further collapses in this pass
+            for (uint32_t t = triOffsets[collapse.from]; t < triOffsets[collapse.from + 1]; ++t)
+            {
+                const uint32_t* tri = &result[vertexTris[t] * 3];
+                touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = true;
+            }
+        }
+
+        if (!removed)
+        {
+            break;
+        }
+
+        // apply the collapses and remove the degenerate triangles
+        size_t writeIdx = 0;
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            uint32_t v0 = remap[result[i]];
+            uint32_t v1 = remap[result[i + 1]];
+            uint32_t v2 = remap[result[i + 2]];
+            if (v0 != v1 && v0 != v2 && v1 != v2)
+            {
+                result[writeIdx++] = v0;
+                result[writeIdx++] = v1;
+                result[writeIdx++] = v2;
+            }
+        }
+        result.resize(writeIdx);
+    }
+
+    if (resultError)
+    {
+        *resultError = static_cast<float>(std::sqrt(maxError));
+    }
+    std::copy(result.begin(), result.end(), dst);
+    return result.size();
+}
+
+size_t MeshOptimiser::buildMeshlets(
+    std::vector<Meshlet>& meshlets,
+    uint32_t* dst,
+    const uint32_t* indices,
+    size_t indexCount,
+    const float* positions,
+    size_t vertexCount,
+    size_t positionStride,
+    size_t maxVertices,
+    size_t maxTriangles)
+{
+    ASSERT_LOG(indexCount % 3 == 0);
+    ASSERT_LOG(dst != indices);
+    ASSERT_LOG(maxVertices >= 3 && maxTriangles > 0);
+
+    meshlets.clear();
+    const size_t triangleCount = indexCount / 3;
+    if (!triangleCount)
+    {
+        return 0;
+    }
+
+    // the triangles adjacent to each vertex
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        ++adjacencyOffsets[indices[i] + 1];
+    }
+    std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+    std::vector<uint32_t> adjacency(indexCount);
+    std::vector<uint32_t> adjacencyFill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        adjacency[adjacencyFill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    // the meshlet that each vertex was last added to
+    std::vector<uint32_t> vertexMeshlet(vertexCount, Unused);
+    std::vector<uint32_t> meshletVertices;
+    meshletVertices.reserve(maxVertices);
+
+    Meshlet meshlet;
+    auto meshletId = static_cast<uint32_t>(meshlets.size());
+    // the sum of the triangle centroids - used to keep the meshlet compact
+    Vec3 centroidSum;
+    size_t seed = 0;
+
+    // the number of vertices the triangle would add to the current meshlet
+    auto newVertexCount = [&](size_t tri) {
+        const uint32_t* v = indices + tri * 3;
+        uint32_t count = vertexMeshlet[v[0]] != meshletId;
+        count += vertexMeshlet[v[1]] != meshletId && v[1] != v[0];
+        count += vertexMeshlet[v[2]] != meshletId && v[2] != v[0] && v[2] != v[1];
+        return count;
+    };
+
+    auto finishMeshlet = [&]() {
+        computeMeshletBounds(meshlet, dst, positions, positionStride);
+        meshlets.emplace_back(meshlet);
+        meshlet = {};
+        meshlet.indexOffset = meshlets.back().indexOffset + meshlets.back().triangleCount * 3;
+        meshletId = static_cast<uint32_t>(meshlets.size());
+        meshletVertices.clear();
+        centroidSum = {};
+    };
+
+    for (size_t triIdx = 0; triIdx < triangleCount; ++triIdx)
+    {
+        // find the adjacent triangle which adds the fewest vertices, using
+        // the distance to the meshlet centroid to break ties
+        uint32_t best = Unused;
+        uint32_t bestNew = UINT32_MAX;
+        float bestDist = FLT_MAX;
+        if (meshlet.triangleCount)
+        {
+            const float invCount = 1.0f / static_cast<float>(meshlet.triangleCount);
+            const Vec3 centroid {
+                centroidSum.x * invCount, centroidSum.y * invCount, centroidSum.z * invCount};
+
+            for (uint32_t vertex : meshletVertices)
+            {
+                for (uint32_t i = adjacencyOffsets[vertex]; i < adjacencyOffsets[vertex + 1]; ++i)
+                {
+                    uint32_t tri = adjacency[i];
+                    if (emitted[tri])
+                    {
+                        continue;
+                    }
+                    uint32_t newCount = newVertexCount(tri);
+                    if (newCount > bestNew)
+                    {
+                        continue;
+                    }
+                    Vec3 dist = sub(
+                        triangleCentroid(positions, positionStride, indices + tri * 3), centroid);
+                    float distSq = dot(dist, dist);
+                    if (newCount < bestNew || distSq < bestDist)
+                    {
+                        best = tri;
+                        bestNew = newCount;
+                        bestDist = distSq;
+                    }
+                }
+            }
+        }
+
+        // no connected triangles left - continue from the next triangle in
+        // the source order, which is coherent if the cache was optimised.
+        if (best == Unused)
+        {
+            while (emitted[seed])
+            {
+                ++seed;
+            }
+            best = static_cast<uint32_t>(seed);
+            bestNew = newVertexCount(best);
+        }
+
+        if (meshlet.triangleCount + 1 > maxTriangles ||
+            meshlet.vertexCount + bestNew > maxVertices)
+        {
+            finishMeshlet();
+        }
+
+        const uint32_t* tri = indices + best * 3;
+        for (size_t i = 0; i < 3; ++i)
+        {
+            if (vertexMeshlet[tri[i]] != meshletId)
+            {
+                vertexMeshlet[tri[i]] = meshletId;
+                meshletVertices.emplace_back(tri[i]);
+                ++meshlet.vertexCount;
+            }
+        }
+        uint32_t* out = dst + meshlet.indexOffset + meshlet.triangleCount * 3;
+        out[0] = tri[0];
+        out[1] = tri[1];
+        out[2] = tri[2];
+        ++meshlet.triangleCount;
+        emitted[best] = 1;
+
+        Vec3 centroid = triangleCentroid(positions, positionStride, tri);
+        centroidSum = {
+            centroidSum.x + centroid.x, centroidSum.y + centroid.y, centroidSum.z + centroid.z};
+    }
+    finishMeshlet();
+
+    return meshlets.size();
+}
+
+MeshOptimiser::CacheStats MeshOptimiser::analyseVertexCache(
+    const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+{
+    CacheStats stats;
+    stats.triangleCount = indexCount / 3;
+
+    FifoCache cache(vertexCount, cacheSize);
+    std::vector<bool> referenced(vertexCount, false);
+    size_t misses = 0;
+    for (size_t idx = 0; idx < indexCount; ++idx)
+    {
+        misses += cache.access(indices[idx]);
+        if (!referenced[indices[idx]])
+        {
+            referenced[indices[idx]] = true;
+            ++stats.vertexCount;
+        }
+    }
+
+    if (stats.triangleCount)
+    {
+        stats.acmr = float(misses) / float(stats.triangleCount);
+    }
+    if (stats.vertexCount)
+    {
+        stats.atvr = float(misses) / float(stats.vertexCount);
+    }
+    return stats;
+}
+
+} // namespace yave
@@ -0,0 +1,220 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace yave
+{
+
+/**
+ * @brief Import-time optimisations for indexed triangle lists. These are
+ * intended to be run in order: @p generateVertexRemap to remove duplicated
+ * vertices, @p optimiseVertexCache and @p optimiseOverdraw to reorder the
+ * triangles and finally @p optimiseVertexFetch to reorder the vertices into the
+ * order they are referenced.
+ * All functions work on 32-bit indices - these can be narrowed to 16-bit once
+ * optimised if the vertex count allows.
+ */
+class MeshOptimiser
+{
+public:
+    // the cache size used when scoring triangles for the vertex cache
+    static constexpr uint32_t VertexCacheSize = 32;
+
+    // the FIFO cache size used when analysing a mesh - deliberately smaller
+    // than the optimisation cache so results are conservative across hardware.
+    static constexpr uint32_t AnalyseCacheSize = 16;
+
+    // the marker for vertices that are not referenced by the index buffer
+    static constexpr uint32_t Unused = UINT32_MAX;
+
+    // the default meshlet limits - these match the preferred limits of mesh
+    // shading hardware so the meshlets can later be drawn by a mesh shader.
+    static constexpr uint32_t MaxMeshletVertices = 64;
+    static constexpr uint32_t MaxMeshletTriangles = 124;
+
+    /**
+     * @brief A small cluster of triangles which is contiguous in the index
+     * buffer, along with the bounds used for culling the cluster.
+     */
+    struct Meshlet
+    {
+        uint32_t indexOffset = 0;
+        uint32_t triangleCount = 0;
+        uint32_t vertexCount = 0;
+        // the bounding sphere of the cluster
+        float center[3] = {0.0f, 0.0f, 0.0f};
+        float radius = 0.0f;
+        // all triangle normals lie within the cone described by the axis and
+        // cutoff (the sine of the cone angle). A cutoff of one denotes that the
+        // cluster can't be back-face culled. The cluster is back facing if:
+        // dot(center - camera, axis) >= cutoff * (length(center - camera) + radius) + radius
+        float coneAxis[3] = {0.0f, 0.0f, 0.0f};
+        float coneCutoff = 1.0f;
+    };
+
+    struct CacheStats
+    {
+        // average cache miss ratio - vertex shader invocations per triangle.
+        // Ranges between 0.5 (ideal for large grids) and 3.0 (no reuse).
+        float acmr = 0.0f;
+        // average transform to vertex ratio - 1.0 is the ideal.
+        float atvr = 0.0f;
+        size_t vertexCount = 0;
+        size_t triangleCount = 0;
+    };
+
+    /**
+     * @brief Generates a remap table which maps each vertex to its first
+     * binary identical vertex. New vertices are numbered in the order they are
+     * first referenced by the indices.
+     * @param remap Resized to @p vertexCount; unreferenced vertices are set to
+     * **Unused**.
+     * @return The number of unique vertices.
+     */
+    static size_t generateVertexRemap(
+        std::vector<uint32_t>& remap,
+        const uint32_t* indices,
+        size_t indexCount,
+        const void* vertices,
+        size_t vertexCount,
+        size_t vertexStride);
+
+    static void remapVertices(
+        void* dst,
+        const void* vertices,
+        size_t vertexCount,
+        size_t vertexStride,
+        const uint32_t* remap);
+
+    static void
+    remapIndices(uint32_t* dst, const uint32_t* indices, size_t indexCount, const uint32_t* remap);
+
+    /**
+     * @brief Reorders the triangles to improve post-transform cache locality
+     * using Tom Forsyth's linear-speed vertex cache optimisation.
+     * @param dst Can be the same as @p indices.
+     */
+    static void optimiseVertexCache(
+        uint32_t* dst, const uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+    /**
+     * @brief Reorders clusters of triangles so that outward facing clusters
+     * are drawn first, reducing overdraw (Sander et al. 2007). This should be
+     * run after @p optimiseVertexCache - the clusters are split at cache flush
+     * points so the vertex cache efficiency is mostly retained.
+     * @param positions Pointer to the first position - three floats.
+     * @param threshold How much the ACMR is allowed to worsen in exchange for
+     * a reduction in overdraw - 1.05 allows a 5% increase.
+     * @param dst Must not be the same as @p indices.
+     */
+    static void optimiseOverdraw(
+        uint32_t* dst,
+        const uint32_t* indices,
+        size_t indexCount,
+        const float* positions,
+        size_t vertexCount,
+        size_t positionStride,
+        float threshold = 1.05f);
+
+    /**
+     * @brief Reorders the vertices into the order they are first referenced
+     * by the indices, improving the locality of vertex fetches. Unreferenced
+     * vertices are removed. The indices are updated in place.
+     * @param dst Must not be the same as @p vertices.
+     * @return The number of vertices written to @p dst.
+     */
+    static size_t optimiseVertexFetch(
+        void* dst,
+        uint32_t* indices,
+        size_t indexCount,
+        const void* vertices,
+        size_t vertexCount,
+        size_t vertexStride);
+
+    /**
+     * @brief Reduces the triangle count by collapsing edges in order of the
+     * quadric error metric (Garland and Heckbert 1997). Vertices are only ever
+     * collapsed onto existing vertices, so the simplified indices can share
+     * the vertex data of the source mesh. Vertices on open borders and
+     * attribute seams are locked in place, which preserves the silhouette and
+     * the uv layout.
+     * @param positions Pointer to the first position - three floats.
+     * @param targetIndexCount The index count to reduce to. The result will
+     * be larger if **targetError** is reached first.
+     * @param targetError The maximum error as a fraction of the mesh extent.
+     * @param resultError If not null, set to the error of the simplified mesh
+     * as a fraction of the mesh extent.
+     * @param dst Can be the same as @p indices.
+     * @return The number of indices written to @p dst.
+     */
+    static size_t simplify(
+        uint32_t* dst,
+        const uint32_t* indices,
+        size_t indexCount,
+        const float* positions,
+        size_t vertexCount,
+        size_t positionStride,
+        size_t targetIndexCount,
+        float targetError,
+        float* resultError = nullptr);
+
+    /**
+     * @brief Splits a triangle list into meshlets of at most @p maxVertices
+     * unique vertices and @p maxTriangles triangles. Meshlets are grown
+     * greedily from adjacent triangles, preferring those which add the fewest
+     * new vertices, so the clusters are spatially compact and their bounds
+     * are tight.
+     * @param dst The triangles reordered so each meshlet is a contiguous range
+     * of indices - see **Meshlet::indexOffset**. Must not be the same as
+     * @p indices.
+     * @param positions Pointer to the first position - three floats.
+     * @return The number of meshlets.
+     */
+    static size_t buildMeshlets(
+        std::vector<Meshlet>& meshlets,
+        uint32_t* dst,
+        const uint32_t* indices,
+        size_t indexCount,
+        const float* positions,
+        size_t vertexCount,
+        size_t positionStride,
+        size_t maxVertices = MaxMeshletVertices,
+        size_t maxTriangles = MaxMeshletTriangles);
+
+    /**
+     * @brief Simulates a FIFO post-transform cache of @p cacheSize entries to
+     * measure the efficiency of the triangle order.
+     */
+    static CacheStats analyseVertexCache(
+        const uint32_t* indices,
+        size_t indexCount,
+        size_t vertexCount,
+        uint32_t cacheSize = AnalyseCacheSize);
+};
+
+} // namespace yave
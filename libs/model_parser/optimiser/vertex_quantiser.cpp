@@ -0,0 +1,156 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "vertex_quantiser.h"
+
+#include "utility/stream_convert.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace yave
+{
+
+namespace
+{
+
+float signNotZero(float value) { return value >= 0.0f ? 1.0f : -1.0f; }
+
+void octahedralProject(const float* n, float& u, float& v)
+{
+    float invL1 = 1.0f / (std::abs(n[0]) + std::abs(n[1]) + std::abs(n[2]));
+    u = n[0] * invL1;
+    v = n[1] * invL1;
+    if (n[2] < 0.0f)
+    {
+        float x = u;
+        u = (1.0f - std::abs(v)) * signNotZero(x);
+        v = (1.0f - std::abs(x)) * signNotZero(v);
+    }
+}
+
+} // namespace
+
+uint16_t VertexQuantiser::floatToHalf(float value) noexcept
+{
+    return util::stream::floatToHalf(value);
+}
+
+float VertexQuantiser::halfToFloat(uint16_t value) noexcept
+{
+    return util::stream::halfToFloat(value);
+}
+
+uint16_t VertexQuantiser::toUnorm16(float value) noexcept
+{
+    return static_cast<uint16_t>(std::clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+}
+
+int16_t VertexQuantiser::toSnorm16(float value) noexcept
+{
+    return static_cast<int16_t>(std::round(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+uint8_t VertexQuantiser::toUnorm8(float value) noexcept
+{
+    return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+float VertexQuantiser::fromUnorm16(uint16_t value) noexcept { return value / 65535.0f; }
+
+float VertexQuantiser::fromSnorm16(int16_t value) noexcept
+{
+    // as per the Vulkan spec, -32768 and -32767 both map to -1.0
+    return std::max(value / 32767.0f, -1.0f);
+}
+
+float VertexQuantiser::fromUnorm8(uint8_t value) noexcept { return value / 255.0f; }
+
+void VertexQuantiser::encodeOctahedral(const float* normal, int16_t* out) noexcept
+{
+    float u, v;
+    octahedralProject(normal, u, v);
+
+    // test the floor/ceil combinations and keep the most accurate
+    const float su = std::clamp(u, -1.0f, 1.0f) * 32767.0f;
+    const float sv = std::clamp(v, -1.0f, 1.0f) * 32767.0f;
+    float bestDot = -2.0f;
+    for (int i = 0; i < 4; ++i)
+    {
+        int16_t candidate[2] = {
+            static_cast<int16_t>((i & 1) ? std::ceil(su) : std::floor(su)),
+            static_cast<int16_t>((i & 2) ? std::ceil(sv) : std::floor(sv))};
+
+        float decoded[3];
+        decodeOctahedral(candidate, decoded);
+        float dot = decoded[0] * normal[0] + decoded[1] * normal[1] + decoded[2] * normal[2];
+        if (dot > bestDot)
+        {
+            bestDot = dot;
+            out[0] = candidate[0];
+            out[1] = candidate[1];
+        }
+    }
+}
+
+void VertexQuantiser::decodeOctahedral(const int16_t* encoded, float* normal) noexcept
+{
+    float x = fromSnorm16(encoded[0]);
+    float y = fromSnorm16(encoded[1]);
+    float z = 1.0f - std::abs(x) - std::abs(y);
+    float t = std::max(-z, 0.0f);
+    x += x >= 0.0f ? -t : t;
+    y += y >= 0.0f ? -t : t;
+
+    float length = std::sqrt(x * x + y * y + z * z);
+    normal[0] = x / length;
+    normal[1] = y / length;
+    normal[2] = z / length;
+}
+
+void VertexQuantiser::quantiseWeights(const float* weights, uint8_t* out) noexcept
+{
+    float sum = weights[0] + weights[1] + weights[2] + weights[3];
+    float scale = sum > 0.0f ? 1.0f / sum : 0.0f;
+
+    int total = 0;
+    int largest = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        out[i] = toUnorm8(weights[i] * scale);
+        total += out[i];
+        if (out[i] > out[largest])
+        {
+            largest = i;
+        }
+    }
+
+    // add the rounding error to the largest weight, where the relative
+    // change is the smallest
+    if (sum > 0.0f)
+    {
+        out[largest] = static_cast<uint8_t>(std::clamp(out[largest] + 255 - total, 0, 255));
+    }
+}
+
+} // namespace yave
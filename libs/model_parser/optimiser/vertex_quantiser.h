@@ -0,0 +1,70 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+
+namespace yave
+{
+
+/**
+ * @brief Conversion functions for compressing vertex attributes into the
+ * reduced precision formats supported as vertex inputs. All functions that
+ * encode have a matching decode so the introduced error can be measured.
+ */
+class VertexQuantiser
+{
+public:
+    // IEEE 754 half-precision, rounding to nearest even.
+    static uint16_t floatToHalf(float value) noexcept;
+    static float halfToFloat(uint16_t value) noexcept;
+
+    // the value is clamped to the range of the normalised type
+    static uint16_t toUnorm16(float value) noexcept;
+    static int16_t toSnorm16(float value) noexcept;
+    static uint8_t toUnorm8(float value) noexcept;
+
+    static float fromUnorm16(uint16_t value) noexcept;
+    static float fromSnorm16(int16_t value) noexcept;
+    static float fromUnorm8(uint8_t value) noexcept;
+
+    /**
+     * @brief Encodes a unit vector by projecting onto an octahedron, which is
+     * then unfolded onto a square (Cigolle et al. 2014). Of the four nearest
+     * snorm16 points, the one that decodes closest to the input is chosen.
+     * @param normal A normalised vector - three floats.
+     * @param out Two snorm16 values.
+     */
+    static void encodeOctahedral(const float* normal, int16_t* out) noexcept;
+
+    static void decodeOctahedral(const int16_t* encoded, float* normal) noexcept;
+
+    /**
+     * @brief Quantises four joint weights to unorm8, distributing the rounding
+     * error so the weights still sum to exactly one after decoding.
+     */
+    static void quantiseWeights(const float* weights, uint8_t* out) noexcept;
+};
+
+} // namespace yave
@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+#include <model_parser/baked/baked_file.h>
+#include <model_parser/gltf/gltf_model.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace
+{
+
+void writeFile(const std::filesystem::path& path, const std::string& contents)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << contents;
+}
+
+class BakedFileTests : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        dir = std::filesystem::temp_directory_path() / "yave_baked_file_test";
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        writeFile(dir / "model.gltf", "{\"asset\": {\"version\": \"2.0\"}}");
+        writeFile(dir / "model.bin", std::string(1000, 'x'));
+    }
+
+    void TearDown() override { std::filesystem::remove_all(dir); }
+
+    // writes a baked file with a single mesh record and vertex blob
+    bool writeBaked(uint64_t optionsHash)
+    {
+        yave::BakedWriter writer;
+        for (const char* source : {"model.gltf", "model.bin"})
+        {
+            writer.addDependency(source, std::filesystem::file_size(dir / source));
+        }
+
+        yave::BakedFormat::Mesh mesh;
+        mesh.vertexCount = 3;
+        mesh.strideSize = 12;
+        mesh.vertexSize = 36;
+        uint8_t* vertices = writer.reserveData(mesh.vertexSize, mesh.vertexOffset);
+        for (size_t i = 0; i < mesh.vertexSize; ++i)
+        {
+            vertices[i] = static_cast<uint8_t>(i);
+        }
+        // a second blob to check the alignment
+        yave::BakedFormat::Primitive prim;
+        uint8_t* indices = writer.reserveData(6, prim.indexOffset);
+        memset(indices, 0xff, 6);
+        prim.indexCount = 3;
+        mesh.indexCount = 3;
+        mesh.primitiveCount = 1;
+        writer.addRecord(yave::BakedFormat::Primitives, prim);
+        writer.addRecord(yave::BakedFormat::Meshes, mesh);
+
+        yave::BakedFormat::Texture texture;
+        texture.path = writer.addString("textures/base_colour.png");
+        writer.addRecord(yave::BakedFormat::Textures, texture);
+
+        uint64_t sourceHash = 0;
+        if (!yave::BakedFile::hashSources(
+                dir, writer.getDependencies(), optionsHash, sourceHash))
+        {
+            return false;
+        }
+        return writer.write(dir / "cache" / "model.ybm", sourceHash);
+    }
+
+    std::filesystem::path dir;
+};
+
+} // namespace
+
+TEST(BakedFileHashTests, Hash)
+{
+    // xxHash64 reference values
+    EXPECT_EQ(yave::BakedFile::hash("", 0), 0xef46db3751d8e999ULL);
+    EXPECT_EQ(yave::BakedFile::hash("abc", 3), 0x44bc2cf5ad770999ULL);
+
+    std::string data(100, 'a');
+    const uint64_t hash = yave::BakedFile::hash(data.data(), data.size());
+    EXPECT_EQ(hash, yave::BakedFile::hash(data.data(), data.size()));
+    EXPECT_NE(hash, yave::BakedFile::hash(data.data(), data.size(), 1));
+    data[77] = 'b';
+    EXPECT_NE(hash, yave::BakedFile::hash(data.data(), data.size()));
+}
+
+TEST_F(BakedFileTests, WriteAndOpen)
+{
+    ASSERT_TRUE(writeBaked(42));
+
+    yave::BakedFile file;
+    ASSERT_TRUE(file.open(dir / "cache" / "model.ybm"));
+    EXPECT_TRUE(file.isUpToDate(dir, 42));
+
+    size_t meshCount = 0;
+    const auto* meshes =
+        file.getRecords<yave::BakedFormat::Mesh>(yave::BakedFormat::Meshes, meshCount);
+    ASSERT_EQ(meshCount, 1u);
+    EXPECT_EQ(meshes[0].vertexCount, 3u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(meshes) % yave::BakedFormat::Alignment, 0u);
+
+    const uint8_t* vertices = file.getData(meshes[0].vertexOffset, meshes[0].vertexSize);
+    ASSERT_TRUE(vertices);
+    EXPECT_EQ(vertices[35], 35);
+    size_t primCount = 0;
+    const auto* prims =
+        file.getRecords<yave::BakedFormat::Primitive>(yave::BakedFormat::Primitives, primCount);
+    ASSERT_EQ(primCount, 1u);
+    const uint8_t* indices = file.getData(prims[0].indexOffset, 6);
+    ASSERT_TRUE(indices);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(indices) % yave::BakedFormat::Alignment, 0u);
+    EXPECT_EQ(indices[5], 0xff);
+
+    // out of range blobs are rejected
+    EXPECT_FALSE(file.getData(prims[0].indexOffset, 1 << 20));
+
+    size_t textureCount = 0;
+    const auto* textures =
+        file.getRecords<yave::BakedFormat::Texture>(yave::BakedFormat::Textures, textureCount);
+    ASSERT_EQ(textureCount, 1u);
+    EXPECT_STREQ(file.getString(textures[0].path), "textures/base_colour.png");
+    EXPECT_STREQ(file.getString(0xffffff), "");
+}
+
+TEST_F(BakedFileTests, Invalidation)
+{
+    ASSERT_TRUE(writeBaked(42));
+
+    yave::BakedFile file;
+    ASSERT_TRUE(file.open(dir / "cache" / "model.ybm"));
+
+    // different build options
+    EXPECT_FALSE(file.isUpToDate(dir, 43));
+
+    // a source changed without changing its size
+    writeFile(dir / "model.bin", std::string(999, 'x') + "y");
+    EXPECT_FALSE(file.isUpToDate(dir, 42));
+
+    // a missing source
+    std::filesystem::remove(dir / "model.bin");
+    EXPECT_FALSE(file.isUpToDate(dir, 42));
+}
+
+TEST_F(BakedFileTests, Corrupt)
+{
+    writeFile(dir / "garbage.ybm", std::string(512, 'g'));
+    yave::BakedFile file;
+    EXPECT_FALSE(file.open(dir / "garbage.ybm"));
+    EXPECT_FALSE(file.open(dir / "missing.ybm"));
+}
+
+TEST_F(BakedFileTests, BakedPathIsUniquePerModel)
+{
+    const std::filesystem::path cacheDir = dir / "cache";
+    const auto gltfPath = yave::GltfModel::getBakedPath(cacheDir, dir / "model.gltf");
+
+    EXPECT_EQ(gltfPath.parent_path(), cacheDir);
+    EXPECT_EQ(gltfPath.extension(), yave::BakedModel::FileExtension);
+    EXPECT_EQ(gltfPath.filename().string().rfind("model-", 0), 0u);
+
+    // the same model referred to by a different path shares the baked file
+    EXPECT_EQ(yave::GltfModel::getBakedPath(cacheDir, dir / "sub" / ".." / "model.gltf"), gltfPath);
+
+    // models with the same name don't
+    EXPECT_NE(yave::GltfModel::getBakedPath(cacheDir, dir / "model.glb"), gltfPath);
+    EXPECT_NE(yave::GltfModel::getBakedPath(cacheDir, dir / "sub" / "model.gltf"), gltfPath);
+}
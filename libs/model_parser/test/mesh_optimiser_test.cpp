@@ -0,0 +1,319 @@
+#include <gtest/gtest.h>
+#include <model_parser/optimiser/mesh_optimiser.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+
+namespace
+{
+
+struct GridMesh
+{
+    std::vector<float> positions;
+    std::vector<uint32_t> indices;
+    size_t vertexCount = 0;
+};
+
+// a regular grid of quads with the triangles in a shuffled order - the worst
+// case for the vertex cache, typical of badly exported or scanned assets.
+GridMesh createShuffledGrid(uint32_t size)
+{
+    GridMesh mesh;
+    for (uint32_t y = 0; y <= size; ++y)
+    {
+        for (uint32_t x = 0; x <= size; ++x)
+        {
+            mesh.positions.insert(mesh.positions.end(), {float(x), float(y), 0.0f});
+        }
+    }
+    mesh.vertexCount = (size + 1) * (size + 1);
+
+    std::vector<std::array<uint32_t, 3>> tris;
+    for (uint32_t y = 0; y < size; ++y)
+    {
+        for (uint32_t x = 0; x < size; ++x)
+        {
+            uint32_t i0 = y * (size + 1) + x;
+            uint32_t i1 = i0 + 1;
+            uint32_t i2 = i0 + size + 1;
+            uint32_t i3 = i2 + 1;
+            tris.push_back({i0, i1, i2});
+            tris.push_back({i1, i3, i2});
+        }
+    }
+    std::shuffle(tris.begin(), tris.end(), std::mt19937 {42});
+    for (const auto& tri : tris)
+    {
+        mesh.indices.insert(mesh.indices.end(), tri.begin(), tri.end());
+    }
+    return mesh;
+}
+
+std::vector<std::array<uint32_t, 3>> sortedTriangles(const std::vector<uint32_t>& indices)
+{
+    std::vector<std::array<uint32_t, 3>> tris;
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        // rotate so the smallest index is first, keeping the winding
+        std::array<uint32_t, 3> tri {indices[i], indices[i + 1], indices[i + 2]};
+        std::rotate(tri.begin(), std::min_element(tri.begin(), tri.end()), tri.end());
+        tris.push_back(tri);
+    }
+    std::sort(tris.begin(), tris.end());
+    return tris;
+}
+
+} // namespace
+
+TEST(MeshOptimiserTests, VertexRemap)
+{
+    // a quad with the shared edge duplicated
+    std::vector<float> vertices {
+        0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,
+        1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f};
+    std::vector<uint32_t> indices {0, 1, 2, 3, 4, 5};
+
+    std::vector<uint32_t> remap;
+    size_t uniqueCount = yave::MeshOptimiser::generateVertexRemap(
+        remap, indices.data(), indices.size(), vertices.data(), 6, sizeof(float) * 3);
+    ASSERT_EQ(uniqueCount, 4);
+    ASSERT_EQ(remap[3], remap[1]);
+    ASSERT_EQ(remap[5], remap[2]);
+
+    std::vector<uint32_t> newIndices(indices.size());
+    yave::MeshOptimiser::remapIndices(
+        newIndices.data(), indices.data(), indices.size(), remap.data());
+    std::vector<uint32_t> expected {0, 1, 2, 1, 3, 2};
+    ASSERT_EQ(newIndices, expected);
+}
+
+TEST(MeshOptimiserTests, VertexCache)
+{
+    GridMesh mesh = createShuffledGrid(64);
+    auto before = yave::MeshOptimiser::analyseVertexCache(
+        mesh.indices.data(), mesh.indices.size(), mesh.vertexCount);
+
+    std::vector<uint32_t> optimised(mesh.indices.size());
+    yave::MeshOptimiser::optimiseVertexCache(
+        optimised.data(), mesh.indices.data(), mesh.indices.size(), mesh.vertexCount);
+    auto after = yave::MeshOptimiser::analyseVertexCache(
+        optimised.data(), optimised.size(), mesh.vertexCount);
+
+    // the same triangles with the same winding, just reordered
+    ASSERT_EQ(sortedTriangles(optimised), sortedTriangles(mesh.indices));
+    ASSERT_EQ(after.vertexCount, mesh.vertexCount);
+    ASSERT_GT(before.acmr, 2.0f);
+    ASSERT_LT(after.acmr, 1.0f);
+}
+
+TEST(MeshOptimiserTests, OverdrawAndFetch)
+{
+    GridMesh mesh = createShuffledGrid(32);
+    std::vector<uint32_t> cacheOptimised(mesh.indices.size());
+    yave::MeshOptimiser::optimiseVertexCache(
+        cacheOptimised.data(), mesh.indices.data(), mesh.indices.size(), mesh.vertexCount);
+    auto cacheStats = yave::MeshOptimiser::analyseVertexCache(
+        cacheOptimised.data(), cacheOptimised.size(), mesh.vertexCount);
+
+    std::vector<uint32_t> optimised(mesh.indices.size());
+    yave::MeshOptimiser::optimiseOverdraw(
+        optimised.data(),
+        cacheOptimised.data(),
+        cacheOptimised.size(),
+        mesh.positions.data(),
+        mesh.vertexCount,
+        sizeof(float) * 3);
+    ASSERT_EQ(sortedTriangles(optimised), sortedTriangles(mesh.indices));
+
+    // the cluster split points should mostly preserve the cache efficiency
+    auto overdrawStats = yave::MeshOptimiser::analyseVertexCache(
+        optimised.data(), optimised.size(), mesh.vertexCount);
+    ASSERT_LT(overdrawStats.acmr, cacheStats.acmr * 1.25f);
+
+    std::vector<float> fetchOptimised(mesh.positions.size());
+    size_t vertexCount = yave::MeshOptimiser::optimiseVertexFetch(
+        fetchOptimised.data(),
+        optimised.data(),
+        optimised.size(),
+        mesh.positions.data(),
+        mesh.vertexCount,
+        sizeof(float) * 3);
+    ASSERT_EQ(vertexCount, mesh.vertexCount);
+
+    // vertices are now in the order they are first referenced
+    uint32_t maxIndex = 0;
+    for (uint32_t index : optimised)
+    {
+        ASSERT_LE(index, maxIndex + 1);
+        maxIndex = std::max(maxIndex, index);
+    }
+}
+
+TEST(MeshOptimiserTests, CacheAndOverdraw)
+{
+    // the overdraw pass must retain the gains of the vertex cache pass
+    GridMesh mesh = createShuffledGrid(32);
+    auto before = yave::MeshOptimiser::analyseVertexCache(
+        mesh.indices.data(), mesh.indices.size(), mesh.vertexCount);
+
+    std::vector<uint32_t> cacheOptimised(mesh.indices.size());
+    yave::MeshOptimiser::optimiseVertexCache(
+        cacheOptimised.data(), mesh.indices.data(), mesh.indices.size(), mesh.vertexCount);
+    std::vector<uint32_t> optimised(mesh.indices.size());
+    yave::MeshOptimiser::optimiseOverdraw(
+        optimised.data(),
+        cacheOptimised.data(),
+        cacheOptimised.size(),
+        mesh.positions.data(),
+        mesh.vertexCount,
+        sizeof(float) * 3);
+
+    auto after = yave::MeshOptimiser::analyseVertexCache(
+        optimised.data(), optimised.size(), mesh.vertexCount);
+    ASSERT_LT(after.acmr, before.acmr);
+}
+
+TEST(MeshOptimiserTests, Simplify)
+{
+    // a flat grid can be reduced with no error, with the locked border
+    // preserving the outline.
+    GridMesh mesh = createShuffledGrid(32);
+    std::vector<uint32_t> simplified(mesh.indices.size());
+    float error = 1.0f;
+    size_t count = yave::MeshOptimiser::simplify(
+        simplified.data(),
+        mesh.indices.data(),
+        mesh.indices.size(),
+        mesh.positions.data(),
+        mesh.vertexCount,
+        sizeof(float) * 3,
+        mesh.indices.size() / 4,
+        0.01f,
+        &error);
+    simplified.resize(count);
+    EXPECT_LE(count, mesh.indices.size() / 4);
+    EXPECT_NEAR(error, 0.0f, 1e-4f);
+
+    float area = 0.0f;
+    for (size_t i = 0; i < count; i += 3)
+    {
+        const float* p0 = &mesh.positions[simplified[i] * 3];
+        const float* p1 = &mesh.positions[simplified[i + 1] * 3];
+        const float* p2 = &mesh.positions[simplified[i + 2] * 3];
+        // the winding must be retained - all triangles face +z
+        float z = (p1[0] - p0[0]) * (p2[1] - p0[1]) - (p1[1] - p0[1]) * (p2[0] - p0[0]);
+        EXPECT_GT(z, 0.0f);
+        area += 0.5f * z;
+    }
+    EXPECT_NEAR(area, 32.0f * 32.0f, 1e-2f);
+}
+
+TEST(MeshOptimiserTests, SimplifyErrorLimit)
+{
+    // a grid displaced by a sine wave - the simplification must stop once
+    // the error limit is reached.
+    GridMesh mesh = createShuffledGrid(64);
+    for (size_t i = 0; i < mesh.vertexCount; ++i)
+    {
+        float x = mesh.positions[i * 3];
+        float y = mesh.positions[i * 3 + 1];
+        mesh.positions[i * 3 + 2] = 4.0f * std::sin(x * 0.2f) * std::cos(y * 0.2f);
+    }
+
+    size_t prevCount = mesh.indices.size();
+    for (float targetError : {0.001f, 0.01f, 0.05f})
+    {
+        std::vector<uint32_t> simplified(mesh.indices.size());
+        float error = 0.0f;
+        size_t count = yave::MeshOptimiser::simplify(
+            simplified.data(),
+            mesh.indices.data(),
+            mesh.indices.size(),
+            mesh.positions.data(),
+            mesh.vertexCount,
+            sizeof(float) * 3,
+            0,
+            targetError,
+            &error);
+        EXPECT_LE(error, targetError);
+        EXPECT_LT(count, prevCount);
+        prevCount = count;
+    }
+}
+
+TEST(MeshOptimiserTests, Meshlets)
+{
+    GridMesh mesh = createShuffledGrid(64);
+    std::vector<uint32_t> indices(mesh.indices.size());
+    yave::MeshOptimiser::optimiseVertexCache(
+        indices.data(), mesh.indices.data(), mesh.indices.size(), mesh.vertexCount);
+
+    std::vector<yave::MeshOptimiser::Meshlet> meshlets;
+    std::vector<uint32_t> meshletIndices(indices.size());
+    size_t count = yave::MeshOptimiser::buildMeshlets(
+        meshlets,
+        meshletIndices.data(),
+        indices.data(),
+        indices.size(),
+        mesh.positions.data(),
+        mesh.vertexCount,
+        sizeof(float) * 3);
+    EXPECT_EQ(count, meshlets.size());
+
+    // the meshlets should be reasonably full - a 64 vertex meshlet of a grid
+    // holds at most ~100 triangles
+    EXPECT_LT(count, indices.size() / 3 / 64);
+
+    // all triangles are kept and the meshlets cover the indices contiguously
+    EXPECT_EQ(sortedTriangles(meshletIndices), sortedTriangles(indices));
+    size_t offset = 0;
+    for (const auto& meshlet : meshlets)
+    {
+        EXPECT_EQ(meshlet.indexOffset, offset);
+        EXPECT_LE(meshlet.triangleCount, yave::MeshOptimiser::MaxMeshletTriangles);
+        EXPECT_LE(meshlet.vertexCount, yave::MeshOptimiser::MaxMeshletVertices);
+        offset += meshlet.triangleCount * 3;
+
+        std::vector<uint32_t> vertices(
+            meshletIndices.begin() + meshlet.indexOffset,
+            meshletIndices.begin() + meshlet.indexOffset + meshlet.triangleCount * 3);
+        std::sort(vertices.begin(), vertices.end());
+        vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+        EXPECT_EQ(vertices.size(), meshlet.vertexCount);
+
+        // the bounding sphere contains all vertices
+        for (uint32_t v : vertices)
+        {
+            float dx = mesh.positions[v * 3] - meshlet.center[0];
+            float dy = mesh.positions[v * 3 + 1] - meshlet.center[1];
+            float dz = mesh.positions[v * 3 + 2] - meshlet.center[2];
+            EXPECT_LE(std::sqrt(dx * dx + dy * dy + dz * dz), meshlet.radius + 1e-5f);
+        }
+
+        // a flat grid faces +z so the cone is a single direction
+        EXPECT_NEAR(meshlet.coneAxis[2], 1.0f, 1e-5f);
+        EXPECT_NEAR(meshlet.coneCutoff, 0.0f, 1e-3f);
+    }
+    EXPECT_EQ(offset, indices.size());
+
+    // all meshlets are back facing when viewed from below and none are from above
+    auto isBackFacing = [](const yave::MeshOptimiser::Meshlet& meshlet, float cameraZ) {
+        float d[3] = {
+            meshlet.center[0] - 32.0f, meshlet.center[1] - 32.0f, meshlet.center[2] - cameraZ};
+        float len = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+        float dp = d[0] * meshlet.coneAxis[0] + d[1] * meshlet.coneAxis[1] +
+            d[2] * meshlet.coneAxis[2];
+        return dp >= meshlet.coneCutoff * (len + meshlet.radius) + meshlet.radius;
+    };
+    size_t culledBelow = 0;
+    size_t culledAbove = 0;
+    for (const auto& meshlet : meshlets)
+    {
+        culledBelow += isBackFacing(meshlet, -100.0f);
+        culledAbove += isBackFacing(meshlet, 100.0f);
+    }
+    EXPECT_EQ(culledBelow, meshlets.size());
+    EXPECT_EQ(culledAbove, 0u);
+}
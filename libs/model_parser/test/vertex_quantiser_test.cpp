@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include <model_parser/optimiser/vertex_quantiser.h>
+
+#include <cmath>
+#include <random>
+
+using namespace yave;
+
+TEST(VertexQuantiserTests, HalfFloat)
+{
+    // exactly representable values must round trip
+    for (float value : {0.0f, -0.0f, 1.0f, -2.0f, 0.5f, 1024.0f, 65504.0f, 0.000061035156f})
+    {
+        EXPECT_EQ(VertexQuantiser::halfToFloat(VertexQuantiser::floatToHalf(value)), value);
+    }
+    EXPECT_EQ(VertexQuantiser::floatToHalf(1.0f), 0x3c00);
+    EXPECT_EQ(VertexQuantiser::floatToHalf(-2.0f), 0xc000);
+    EXPECT_EQ(VertexQuantiser::floatToHalf(100000.0f), 0x7c00);
+    EXPECT_TRUE(std::isnan(VertexQuantiser::halfToFloat(VertexQuantiser::floatToHalf(NAN))));
+
+    // denormals
+    EXPECT_EQ(VertexQuantiser::floatToHalf(5.9604645e-8f), 0x0001);
+    EXPECT_FLOAT_EQ(VertexQuantiser::halfToFloat(0x0001), 5.9604645e-8f);
+
+    // the relative error of normalised values is bound by the 10-bit mantissa
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-1000.0f, 1000.0f);
+    for (int i = 0; i < 10000; ++i)
+    {
+        float value = dist(rng);
+        float result = VertexQuantiser::halfToFloat(VertexQuantiser::floatToHalf(value));
+        EXPECT_LE(std::abs(result - value), std::abs(value) * (1.0f / 2048.0f));
+    }
+}
+
+TEST(VertexQuantiserTests, Normalised)
+{
+    EXPECT_EQ(VertexQuantiser::toUnorm16(0.0f), 0);
+    EXPECT_EQ(VertexQuantiser::toUnorm16(1.0f), 65535);
+    EXPECT_EQ(VertexQuantiser::toUnorm16(2.0f), 65535);
+    EXPECT_EQ(VertexQuantiser::toSnorm16(-1.0f), -32767);
+    EXPECT_EQ(VertexQuantiser::toSnorm16(1.0f), 32767);
+    EXPECT_EQ(VertexQuantiser::toUnorm8(0.5f), 128);
+
+    EXPECT_FLOAT_EQ(VertexQuantiser::fromSnorm16(-32768), -1.0f);
+    EXPECT_FLOAT_EQ(VertexQuantiser::fromUnorm8(255), 1.0f);
+
+    for (float value = 0.0f; value <= 1.0f; value += 0.001f)
+    {
+        EXPECT_NEAR(
+            VertexQuantiser::fromUnorm16(VertexQuantiser::toUnorm16(value)), value, 0.5f / 65535.0f);
+    }
+}
+
+TEST(VertexQuantiserTests, Octahedral)
+{
+    std::mt19937 rng(11);
+    std::normal_distribution<float> dist;
+
+    float maxAngle = 0.0f;
+    for (int i = 0; i < 100000; ++i)
+    {
+        float n[3] = {dist(rng), dist(rng), dist(rng)};
+        float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        for (float& c : n)
+        {
+            c /= length;
+        }
+
+        int16_t encoded[2];
+        VertexQuantiser::encodeOctahedral(n, encoded);
+        float decoded[3];
+        VertexQuantiser::decodeOctahedral(encoded, decoded);
+
+        // the cross product is used as acos lacks precision for small angles
+        float cross[3] = {
+            n[1] * decoded[2] - n[2] * decoded[1],
+            n[2] * decoded[0] - n[0] * decoded[2],
+            n[0] * decoded[1] - n[1] * decoded[0]};
+        float dot = n[0] * decoded[0] + n[1] * decoded[1] + n[2] * decoded[2];
+        float sinAngle =
+            std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+        maxAngle = std::max(maxAngle, std::atan2(sinAngle, dot));
+    }
+    // 2x16 bits gives an error well below 0.01 degrees
+    EXPECT_LT(maxAngle * 180.0f / M_PI, 0.01f);
+
+    // the axes must be exact
+    const float axes[6][3] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+    for (const auto& axis : axes)
+    {
+        int16_t encoded[2];
+        VertexQuantiser::encodeOctahedral(axis, encoded);
+        float decoded[3];
+        VertexQuantiser::decodeOctahedral(encoded, decoded);
+        for (int c = 0; c < 3; ++c)
+        {
+            EXPECT_FLOAT_EQ(decoded[c], axis[c]);
+        }
+    }
+}
+
+TEST(VertexQuantiserTests, Weights)
+{
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    for (int i = 0; i < 10000; ++i)
+    {
+        float weights[4] = {dist(rng), dist(rng), dist(rng), dist(rng)};
+        uint8_t out[4];
+        VertexQuantiser::quantiseWeights(weights, out);
+        EXPECT_EQ(out[0] + out[1] + out[2] + out[3], 255);
+    }
+
+    const float single[4] = {1.0f, 0.0f, 0.0f, 0.0f};
+    uint8_t out[4];
+    VertexQuantiser::quantiseWeights(single, out);
+    EXPECT_EQ(out[0], 255);
+    EXPECT_EQ(out[1] + out[2] + out[3], 0);
+}
@@ -0,0 +1,188 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "utility/stream_convert.h"
+#include "utility/timer.h"
+
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <vector>
+
+using namespace util::stream;
+
+namespace
+{
+
+constexpr size_t VertexCount = 1 << 20;
+constexpr int Iterations = 20;
+
+// returns the best time of all the iterations in milliseconds
+double run(const std::function<void()>& func)
+{
+    double best = 0.0;
+    for (int i = 0; i < Iterations; ++i)
+    {
+        util::Timer<NanoSeconds> timer;
+        func();
+        const double elapsed = timer.getTimeElapsed() / 1.0e6;
+        best = i == 0 ? elapsed : std::min(best, elapsed);
+    }
+    return best;
+}
+
+void report(const char* name, double scalarTime, double simdTime)
+{
+    printf(
+        "%-36s scalar: %8.3fms  %s: %8.3fms  (x%.2f)\n",
+        name,
+        scalarTime,
+        getInstructionSet(),
+        simdTime,
+        scalarTime / simdTime);
+}
+
+void benchFromFloat(
+    const char* name, Type type, bool normalised, const std::vector<float>& src, void* dst)
+{
+    const double scalarTime = run(
+        [&]() { scalar::convertFromFloat(src.data(), type, normalised, dst, src.size()); });
+    const double simdTime =
+        run([&]() { convertFromFloat(src.data(), type, normalised, dst, src.size()); });
+    report(name, scalarTime, simdTime);
+}
+
+void benchToFloat(
+    const char* name, const void* src, Type type, bool normalised, std::vector<float>& dst)
+{
+    const double scalarTime =
+        run([&]() { scalar::convertToFloat(src, type, normalised, dst.data(), dst.size()); });
+    const double simdTime =
+        run([&]() { convertToFloat(src, type, normalised, dst.data(), dst.size()); });
+    report(name, scalarTime, simdTime);
+}
+
+} // namespace
+
+int main()
+{
+    printf("Stream conversion benchmark - %zu vertices\n\n", VertexCount);
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> floats(VertexCount * 4);
+    for (float& value : floats)
+    {
+        value = dist(rng);
+    }
+    std::vector<uint16_t> shorts(floats.size());
+    std::vector<uint8_t> bytes(floats.size());
+    std::vector<float> floatsOut(floats.size());
+
+    benchFromFloat("float -> half", Type::Half, false, floats, shorts.data());
+    benchToFloat("half -> float", shorts.data(), Type::Half, false, floatsOut);
+    benchFromFloat("float -> snorm16", Type::Int16, true, floats, shorts.data());
+    benchFromFloat("float -> unorm8", Type::Uint8, true, floats, bytes.data());
+    benchToFloat("unorm16 -> float", shorts.data(), Type::Uint16, true, floatsOut);
+
+    // indices
+    std::vector<uint32_t> indices(VertexCount * 3);
+    std::vector<uint16_t> indices16(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        indices16[i] = static_cast<uint16_t>(rng());
+    }
+    double scalarTime = run([&]() {
+        scalar::convertIndices(
+            indices16.data(), 2, Type::Uint16, 100, indices.data(), indices.size());
+    });
+    double simdTime = run([&]() {
+        convertIndices(indices16.data(), 2, Type::Uint16, 100, indices.data(), indices.size());
+    });
+    report("u16 -> u32 indices", scalarTime, simdTime);
+
+    // interleaving - the per-vertex memcpy with runtime sizes as a baseline
+    const size_t stride = 12 + 8 + 12;
+    std::vector<uint8_t> interleaved(VertexCount * stride);
+    const float* positions = floats.data();
+    const float* uvs = floats.data() + VertexCount * 3;
+    const float* normals = floatsOut.data();
+    size_t sizes[3] = {12, 8, 12};
+    scalarTime = run([&]() {
+        uint8_t* dst = interleaved.data();
+        for (size_t i = 0; i < VertexCount; ++i)
+        {
+            memcpy(dst, positions + i * 3, sizes[0]);
+            dst += sizes[0];
+            memcpy(dst, uvs + i * 2, sizes[1]);
+            dst += sizes[1];
+            memcpy(dst, normals + i * 3, sizes[2]);
+            dst += sizes[2];
+        }
+    });
+    const ConstAttribute attributes[] = {
+        {positions, 12, 0, 12}, {uvs, 8, 12, 8}, {normals, 12, 20, 12}};
+    simdTime = run([&]() { interleave(attributes, 3, interleaved.data(), stride, VertexCount); });
+    report("interleave pos/uv/normal", scalarTime, simdTime);
+
+    // strided conversion of the uvs to half
+    std::vector<uint8_t> quantised(VertexCount * 8);
+    scalarTime = run([&]() {
+        const uint8_t* src = interleaved.data() + 12;
+        uint8_t* dst = quantised.data();
+        for (size_t i = 0; i < VertexCount; ++i, src += stride, dst += 8)
+        {
+            float uv[2];
+            memcpy(uv, src, sizeof(uv));
+            uint16_t half[2] = {floatToHalf(uv[0]), floatToHalf(uv[1])};
+            memcpy(dst, half, sizeof(half));
+        }
+    });
+    simdTime = run([&]() {
+        convertStrided(
+            interleaved.data() + 12,
+            stride,
+            Type::Float,
+            quantised.data(),
+            8,
+            Type::Half,
+            false,
+            2,
+            VertexCount);
+    });
+    report("strided uv -> half", scalarTime, simdTime);
+
+    // image data without an alpha channel
+    std::vector<uint8_t> rgb(VertexCount * 3);
+    std::vector<uint8_t> rgba(VertexCount * 4);
+    for (size_t i = 0; i < rgb.size(); ++i)
+    {
+        rgb[i] = static_cast<uint8_t>(rng());
+    }
+    scalarTime = run([&]() { scalar::expandRgbToRgba(rgb.data(), rgba.data(), VertexCount, 255); });
+    simdTime = run([&]() { expandRgbToRgba(rgb.data(), rgba.data(), VertexCount, 255); });
+    report("rgb -> rgba", scalarTime, simdTime);
+
+    return 0;
+}
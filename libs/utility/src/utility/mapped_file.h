@@ -0,0 +1,76 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace util
+{
+
+/**
+ * @brief A view of a file mapped into memory. Pages are only read from disk
+ * when first accessed, so large files can be opened without copying them into
+ * an intermediate buffer. The mapping is private - any writes to the memory are
+ * not written back to the file.
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& rhs) noexcept;
+    MappedFile& operator=(MappedFile&& rhs) noexcept;
+
+    /**
+     * @brief Maps the whole of the specified file into memory.
+     * @param path The path to the file to map.
+     * @return Whether the file was successfully mapped. Empty files can not be
+     * mapped.
+     */
+    bool open(const char* path);
+
+    void close() noexcept;
+
+    [[nodiscard]] bool isOpen() const noexcept { return data_ != nullptr; }
+
+    [[nodiscard]] uint8_t* data() const noexcept { return static_cast<uint8_t*>(data_); }
+
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+
+#ifdef _WIN32
+    void* fileHandle_ = nullptr;
+    void* mapHandle_ = nullptr;
+#endif
+};
+
+} // namespace util
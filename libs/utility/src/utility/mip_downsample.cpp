@@ -0,0 +1,189 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "mip_downsample.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace util
+{
+namespace mip
+{
+
+namespace
+{
+
+void loadTexel(
+    const float* src,
+    uint32_t width,
+    uint32_t height,
+    int64_t x,
+    int64_t y,
+    bool srgb,
+    float* texel) noexcept
+{
+    x = std::clamp<int64_t>(x, 0, width - 1);
+    y = std::clamp<int64_t>(y, 0, height - 1);
+    const float* value = src + (y * width + x) * 4;
+    for (int c = 0; c < 3; ++c)
+    {
+        texel[c] = srgb ? srgbToLinear(value[c]) : value[c];
+    }
+    texel[3] = value[3];
+}
+
+// the kaiser weight of a tap, where the taps are offset from 2x - 2 to 2x + 3
+float getKaiserWeight(int tap) noexcept
+{
+    return KaiserWeights[tap < 3 ? 2 - tap : tap - 3];
+}
+
+} // namespace
+
+uint32_t getLevelSize(uint32_t size, uint32_t level) noexcept
+{
+    return std::max(size >> level, 1u);
+}
+
+uint32_t getLevelCount(uint32_t width, uint32_t height) noexcept
+{
+    uint32_t count = 1;
+    for (uint32_t size = std::max(width, height); size > 1; size >>= 1)
+    {
+        ++count;
+    }
+    return count;
+}
+
+float srgbToLinear(float value) noexcept
+{
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+float linearToSrgb(float value) noexcept
+{
+    value = std::max(value, 0.0f);
+    return value <= 0.0031308f ? value * 12.92f
+                               : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+void downsample(
+    const float* src,
+    uint32_t srcWidth,
+    uint32_t srcHeight,
+    float* dst,
+    Filter filter,
+    bool first,
+    bool srgb) noexcept
+{
+    const uint32_t dstWidth = getLevelSize(srcWidth, 1);
+    const uint32_t dstHeight = getLevelSize(srcHeight, 1);
+
+    for (uint32_t y = 0; y < dstHeight; ++y)
+    {
+        for (uint32_t x = 0; x < dstWidth; ++x)
+        {
+            float result[4] = {};
+            const int64_t srcX = 2 * static_cast<int64_t>(x);
+            const int64_t srcY = 2 * static_cast<int64_t>(y);
+
+            if (filter == Filter::Kaiser && first)
+            {
+                for (int j = 0; j < 6; ++j)
+                {
+                    for (int i = 0; i < 6; ++i)
+                    {
+                        float texel[4];
+                        loadTexel(
+                            src, srcWidth, srcHeight, srcX + i - 2, srcY + j - 2, srgb, texel);
+                        const float weight = getKaiserWeight(i) * getKaiserWeight(j);
+                        for (int c = 0; c < 4; ++c)
+                        {
+                            result[c] += texel[c] * weight;
+                        }
+                    }
+                }
+            }
+            else
+            {
+                float texels[4][4];
+                for (int i = 0; i < 4; ++i)
+                {
+                    loadTexel(
+                        src, srcWidth, srcHeight, srcX + (i & 1), srcY + (i >> 1), srgb, texels[i]);
+                }
+                for (int c = 0; c < 4; ++c)
+                {
+                    const float a = texels[0][c];
+                    const float b = texels[1][c];
+                    const float d = texels[2][c];
+                    const float e = texels[3][c];
+                    switch (filter)
+                    {
+                        case Filter::Min:
+                            result[c] = std::min({a, b, d, e});
+                            break;
+                        case Filter::Max:
+                            result[c] = std::max({a, b, d, e});
+                            break;
+                        default:
+                            result[c] = (a + b + d + e) * 0.25f;
+                            break;
+                    }
+                }
+            }
+
+            float* out = dst + (static_cast<size_t>(y) * dstWidth + x) * 4;
+            for (int c = 0; c < 3; ++c)
+            {
+                out[c] = srgb ? linearToSrgb(result[c]) : result[c];
+            }
+            out[3] = result[3];
+        }
+    }
+}
+
+void generateMips(
+    float* const* levels,
+    uint32_t width,
+    uint32_t height,
+    uint32_t levelCount,
+    Filter filter,
+    bool srgb) noexcept
+{
+    for (uint32_t level = 1; level < levelCount; ++level)
+    {
+        downsample(
+            levels[level - 1],
+            getLevelSize(width, level - 1),
+            getLevelSize(height, level - 1),
+            levels[level],
+            filter,
+            level == 1,
+            srgb);
+    }
+}
+
+} // namespace mip
+} // namespace util
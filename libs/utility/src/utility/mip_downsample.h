@@ -0,0 +1,98 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+
+namespace util
+{
+namespace mip
+{
+
+/**
+ * @brief A cpu reference for the single pass compute downsampler used to
+ * generate the mip chains of textures on the gpu (see downsample.comp). The
+ * images are tightly packed RGBA floats.
+ *
+ * Each level is filtered from the level above it, with the edge texels
+ * clamped. The level dimensions are halved and rounded down, so with odd
+ * dimensions the last row or column of the source level is dropped - as with
+ * a blit.
+ */
+
+enum class Filter : uint8_t
+{
+    // averages each 2x2 block
+    Box,
+    // a 6x6 Kaiser windowed sinc for the first level - the remaining levels
+    // use the box filter as they are reduced in workgroup memory on the gpu
+    Kaiser,
+    Min,
+    Max
+};
+
+// The separable weights of the Kaiser filter (alpha = 4), from the centre
+// outwards, in source texels.
+constexpr float KaiserWeights[3] = {0.42649015f, 0.09450233f, -0.02099248f};
+
+// The size of a dimension at the given level - never less than one.
+uint32_t getLevelSize(uint32_t size, uint32_t level) noexcept;
+
+// The number of levels in the full mip chain of an image.
+uint32_t getLevelCount(uint32_t width, uint32_t height) noexcept;
+
+float srgbToLinear(float value) noexcept;
+float linearToSrgb(float value) noexcept;
+
+/**
+ * @brief Filters the level below src into dst.
+ * @param first Whether src is the first level of the chain - only this level
+ * is filtered with the Kaiser filter.
+ * @param srgb If true, the rgb channels are sRGB encoded and are filtered in
+ * linear space. The alpha channel is always linear.
+ */
+void downsample(
+    const float* src,
+    uint32_t srcWidth,
+    uint32_t srcHeight,
+    float* dst,
+    Filter filter,
+    bool first,
+    bool srgb) noexcept;
+
+/**
+ * @brief Generates levels [1, levelCount) of a single image layer.
+ * @param levels The images of each level, with levels[0] the source. These
+ * must be sized as given by getLevelSize().
+ */
+void generateMips(
+    float* const* levels,
+    uint32_t width,
+    uint32_t height,
+    uint32_t levelCount,
+    Filter filter,
+    bool srgb) noexcept;
+
+} // namespace mip
+} // namespace util
@@ -0,0 +1,338 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "ocean_spectrum.h"
+
+#include "assertion.h"
+#include "simd.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace util
+{
+namespace ocean
+{
+
+namespace
+{
+
+constexpr float Pi = 3.14159265358979f;
+
+// the damping of the smallest waves, as initial_spectrum.comp
+constexpr float MinWaveLength = 0.02f;
+
+// the spectrum of the mode, zero outside of the band
+float getEnergy(const SpectrumParams& params, float kx, float kz) noexcept
+{
+    const float mag = std::sqrt(kx * kx + kz * kz);
+    if (mag < params.minWaveNumber || mag >= params.maxWaveNumber)
+    {
+        return 0.0f;
+    }
+    return params.amplitude * phillips(params, kx, kz);
+}
+
+// the wave vector of the grid point - the grid is centred on k = 0
+inline float getWaveNumber(uint32_t idx, uint32_t size, float patchSize) noexcept
+{
+    return 2.0f * Pi * (static_cast<float>(idx) - static_cast<float>(size / 2)) / patchSize;
+}
+
+/**
+ * @brief The butterfly between the rows a and b with the twiddle factor w:
+ * a' = a + w * b, b' = a - w * b.
+ */
+void butterflyRows(
+    float* aRe, float* aIm, float* bRe, float* bIm, float wRe, float wIm, uint32_t size) noexcept
+{
+    uint32_t x = 0;
+#ifdef YAVE_SIMD
+    using namespace simd;
+    const VecF wr = splatF(wRe);
+    const VecF wi = splatF(wIm);
+    for (; x + 4 <= size; x += 4)
+    {
+        const VecF ar = loadF(aRe + x);
+        const VecF ai = loadF(aIm + x);
+        const VecF br = loadF(bRe + x);
+        const VecF bi = loadF(bIm + x);
+        const VecF tr = subF(mulF(wr, br), mulF(wi, bi));
+        const VecF ti = addF(mulF(wr, bi), mulF(wi, br));
+        storeF(aRe + x, addF(ar, tr));
+        storeF(aIm + x, addF(ai, ti));
+        storeF(bRe + x, subF(ar, tr));
+        storeF(bIm + x, subF(ai, ti));
+    }
+#endif
+    for (; x < size; ++x)
+    {
+        const float tr = wRe * bRe[x] - wIm * bIm[x];
+        const float ti = wRe * bIm[x] + wIm * bRe[x];
+        bRe[x] = aRe[x] - tr;
+        bIm[x] = aIm[x] - ti;
+        aRe[x] += tr;
+        aIm[x] += ti;
+    }
+}
+
+void transpose(float* data, uint32_t size) noexcept
+{
+    for (uint32_t y = 0; y < size; ++y)
+    {
+        for (uint32_t x = y + 1; x < size; ++x)
+        {
+            std::swap(data[y * size + x], data[x * size + y]);
+        }
+    }
+}
+
+} // namespace
+
+void DisplacementGrid::resize(uint32_t gridSize)
+{
+    size = gridSize;
+    height.resize(gridSize * gridSize);
+    dispX.resize(gridSize * gridSize);
+    dispZ.resize(gridSize * gridSize);
+}
+
+float phillips(const SpectrumParams& params, float kx, float kz) noexcept
+{
+    const float mag2 = kx * kx + kz * kz;
+    if (mag2 == 0.0f)
+    {
+        return 0.0f;
+    }
+    const float mag = std::sqrt(mag2);
+    const float windLen = std::sqrt(
+        params.windDirection[0] * params.windDirection[0] +
+        params.windDirection[1] * params.windDirection[1]);
+    const float kdotw =
+        (kx * params.windDirection[0] + kz * params.windDirection[1]) / (mag * windLen);
+
+    // the largest wave arising from the wind speed
+    const float len = params.windSpeed * params.windSpeed / Gravity;
+
+    return kdotw * kdotw * std::exp(-mag2 * MinWaveLength * MinWaveLength) *
+        std::exp(-1.0f / (mag2 * len * len)) / (mag2 * mag2);
+}
+
+float heightVariance(const SpectrumParams& params, float scale) noexcept
+{
+    // E|h0(k)|^2 is half of the spectrum, and the height is the real part of
+    // the sum of the independent modes
+    double sum = 0.0;
+    for (uint32_t y = 0; y < params.size; ++y)
+    {
+        const float kz = getWaveNumber(y, params.size, params.patchSize);
+        for (uint32_t x = 0; x < params.size; ++x)
+        {
+            const float kx = getWaveNumber(x, params.size, params.patchSize);
+            sum += 0.25 * (getEnergy(params, kx, kz) + getEnergy(params, -kx, -kz));
+        }
+    }
+    return static_cast<float>(sum) * scale * scale;
+}
+
+void inverseFftColumns(float* re, float* im, uint32_t size) noexcept
+{
+    ASSERT_LOG(size > 0 && (size & (size - 1)) == 0);
+
+    // reorder the rows by the bit reversed index
+    uint32_t bits = 0;
+    while ((1u << bits) < size)
+    {
+        ++bits;
+    }
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        uint32_t j = 0;
+        for (uint32_t b = 0; b < bits; ++b)
+        {
+            j |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        if (i < j)
+        {
+            std::swap_ranges(re + i * size, re + (i + 1) * size, re + j * size);
+            std::swap_ranges(im + i * size, im + (i + 1) * size, im + j * size);
+        }
+    }
+
+    for (uint32_t m = 2; m <= size; m <<= 1)
+    {
+        const uint32_t half = m >> 1;
+        for (uint32_t j = 0; j < half; ++j)
+        {
+            const float angle = 2.0f * Pi * static_cast<float>(j) / static_cast<float>(m);
+            const float wRe = std::cos(angle);
+            const float wIm = std::sin(angle);
+            for (uint32_t k = j; k < size; k += m)
+            {
+                butterflyRows(
+                    re + k * size,
+                    im + k * size,
+                    re + (k + half) * size,
+                    im + (k + half) * size,
+                    wRe,
+                    wIm,
+                    size);
+            }
+        }
+    }
+}
+
+void inverseFft2d(float* re, float* im, uint32_t size) noexcept
+{
+    // the rows are transformed as columns of the transposed grid
+    inverseFftColumns(re, im, size);
+    transpose(re, size);
+    transpose(im, size);
+    inverseFftColumns(re, im, size);
+    transpose(re, size);
+    transpose(im, size);
+}
+
+void sample(const DisplacementGrid& grid, float x, float z, float* out) noexcept
+{
+    ASSERT_LOG(grid.size > 0 && (grid.size & (grid.size - 1)) == 0);
+
+    const float fx = std::floor(x);
+    const float fz = std::floor(z);
+    const float tx = x - fx;
+    const float tz = z - fz;
+
+    // the grid is a power of two so wrapping negative coords is a mask
+    const auto mask = static_cast<int32_t>(grid.size - 1);
+    const auto x0 = static_cast<int32_t>(fx) & mask;
+    const auto z0 = static_cast<int32_t>(fz) & mask;
+    const int32_t x1 = (x0 + 1) & mask;
+    const int32_t z1 = (z0 + 1) & mask;
+
+    const size_t i00 = z0 * grid.size + x0;
+    const size_t i10 = z0 * grid.size + x1;
+    const size_t i01 = z1 * grid.size + x0;
+    const size_t i11 = z1 * grid.size + x1;
+
+    auto bilerp = [&](const std::vector<float>& v) {
+        const float top = v[i00] + (v[i10] - v[i00]) * tx;
+        const float bottom = v[i01] + (v[i11] - v[i01]) * tx;
+        return top + (bottom - top) * tz;
+    };
+    out[0] = bilerp(grid.height);
+    out[1] = bilerp(grid.dispX);
+    out[2] = bilerp(grid.dispZ);
+}
+
+void WaveSpectrum::init(const SpectrumParams& params, const float* noise, uint32_t noiseSize)
+{
+    ASSERT_LOG(params.size > 0 && (params.size & (params.size - 1)) == 0);
+    ASSERT_LOG(noiseSize >= params.size);
+
+    params_ = params;
+    const uint32_t size = params.size;
+    const size_t count = size * size;
+
+    h0k_.resize(count * 2);
+    h0minusk_.resize(count * 2);
+    omega_.resize(count);
+    dirX_.resize(count);
+    dirZ_.resize(count);
+    dyRe_.resize(count);
+    dyIm_.resize(count);
+    dxRe_.resize(count);
+    dxIm_.resize(count);
+
+    // both grids are centred on k = 0
+    const uint32_t offset = (noiseSize - size) / 2;
+
+    for (uint32_t y = 0; y < size; ++y)
+    {
+        const float kz = getWaveNumber(y, size, params.patchSize);
+        for (uint32_t x = 0; x < size; ++x)
+        {
+            const float kx = getWaveNumber(x, size, params.patchSize);
+            const size_t idx = y * size + x;
+            const float* gaussRnd = noise + ((y + offset) * noiseSize + x + offset) * 4;
+
+            const float h0 = std::sqrt(getEnergy(params, kx, kz)) * 0.5f;
+            const float h0minus = std::sqrt(getEnergy(params, -kx, -kz)) * 0.5f;
+            h0k_[idx * 2] = gaussRnd[0] * h0;
+            h0k_[idx * 2 + 1] = gaussRnd[1] * h0;
+            h0minusk_[idx * 2] = gaussRnd[2] * h0minus;
+            h0minusk_[idx * 2 + 1] = gaussRnd[3] * h0minus;
+
+            const float mag = std::max(std::sqrt(kx * kx + kz * kz), 0.000001f);
+            omega_[idx] = std::sqrt(Gravity * mag);
+            dirX_[idx] = -kz / (mag + 0.00001f);
+            dirZ_[idx] = kx / (mag + 0.00001f);
+        }
+    }
+}
+
+void WaveSpectrum::evaluate(float time, float scale, float choppyFactor, DisplacementGrid& out)
+{
+    const uint32_t size = params_.size;
+    const size_t count = size * size;
+    ASSERT_LOG(!h0k_.empty());
+
+    for (size_t idx = 0; idx < count; ++idx)
+    {
+        const float c = std::cos(omega_[idx] * time);
+        const float s = std::sin(omega_[idx] * time);
+
+        // h0(k) * exp(iwt) + conj(h0(-k)) * exp(-iwt)
+        const float ar = h0k_[idx * 2];
+        const float ai = h0k_[idx * 2 + 1];
+        const float br = h0minusk_[idx * 2];
+        const float bi = -h0minusk_[idx * 2 + 1];
+        const float dyr = (ar * c - ai * s) + (br * c + bi * s);
+        const float dyi = (ai * c + ar * s) + (bi * c - br * s);
+
+        dyRe_[idx] = dyr;
+        dyIm_[idx] = dyi;
+        dxRe_[idx] = dirX_[idx] * dyr - dirZ_[idx] * dyi;
+        dxIm_[idx] = dirX_[idx] * dyi + dirZ_[idx] * dyr;
+    }
+
+    inverseFft2d(dyRe_.data(), dyIm_.data(), size);
+    inverseFft2d(dxRe_.data(), dxIm_.data(), size);
+
+    out.resize(size);
+    for (uint32_t y = 0; y < size; ++y)
+    {
+        for (uint32_t x = 0; x < size; ++x)
+        {
+            // the grid is centred on k = 0, which shifts the phase of every
+            // other point by pi
+            const size_t idx = y * size + x;
+            const float sign = ((x + y) & 1) ? -scale : scale;
+            out.height[idx] = dyRe_[idx] * sign;
+            out.dispX[idx] = dxRe_[idx] * sign * choppyFactor;
+            out.dispZ[idx] = dxIm_[idx] * sign * choppyFactor;
+        }
+    }
+}
+
+} // namespace ocean
+} // namespace util
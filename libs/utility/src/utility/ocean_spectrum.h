@@ -0,0 +1,146 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace util
+{
+namespace ocean
+{
+
+/**
+ * @brief A cpu mirror of the ocean spectrum simulated on the gpu (see
+ * initial_spectrum.comp and fft_spectrum.comp), used to query the displacement
+ * of the surface on the host. The mirror can be of a lower resolution than the
+ * gpu spectrum - it then holds the modes with the smallest wave numbers, which
+ * are identical to those of the gpu as the same noise is used. The omitted
+ * modes are the finer waves, so the error is small in relation to the height.
+ */
+
+constexpr float Gravity = 9.81f;
+
+struct SpectrumParams
+{
+    // the resolution of the grid - must be a power of two
+    uint32_t size = 64;
+    // the size of the tile which the spectrum is simulated over
+    float patchSize = 1000.0f;
+    float amplitude = 4.0f;
+    float windSpeed = 40.0f;
+    float windDirection[2] = {4.0f, 2.0f};
+    // the band of wave numbers included - modes outside of this are zero
+    float minWaveNumber = 0.0f;
+    float maxWaveNumber = std::numeric_limits<float>::max();
+};
+
+/**
+ * @brief The displacement of the surface sampled at size x size points over
+ * the tile. The point (x, y) is at (x, y) * patchSize / size.
+ */
+struct DisplacementGrid
+{
+    uint32_t size = 0;
+    std::vector<float> height;
+    std::vector<float> dispX;
+    std::vector<float> dispZ;
+
+    void resize(uint32_t gridSize);
+};
+
+// The phillips spectrum for the wave vector (kx, kz), matching the gpu.
+float phillips(const SpectrumParams& params, float kx, float kz) noexcept;
+
+/**
+ * @brief The expected variance of the heights, as produced by the gpu from a
+ * spectrum with these parameters.
+ * @param scale The normalisation applied to the inverse transform.
+ */
+float heightVariance(const SpectrumParams& params, float scale) noexcept;
+
+/**
+ * @brief Inverse transforms each column of a row-major size x size grid of
+ * complex values, held as separate real and imaginary parts. The butterflies
+ * are between whole rows, so four columns are transformed at a time with SSE2
+ * or NEON where available. The transform is not normalised.
+ */
+void inverseFftColumns(float* re, float* im, uint32_t size) noexcept;
+
+// The unnormalised 2D inverse transform of a size x size grid.
+void inverseFft2d(float* re, float* im, uint32_t size) noexcept;
+
+/**
+ * @brief Bilinearly samples the grid with wrapping, as the tile is periodic.
+ * The coordinates are in grid points - i.e. world position * size / patchSize.
+ * The height, x and z displacement are written to out.
+ */
+void sample(const DisplacementGrid& grid, float x, float z, float* out) noexcept;
+
+class WaveSpectrum
+{
+public:
+    WaveSpectrum() = default;
+
+    /**
+     * @brief Generates the initial spectrum (h0k and h0-k).
+     * @param noise The RGBA gaussian noise used by the gpu - the noise of the
+     * mode k is at the same grid point for both, so the grid must be at least
+     * the size of the spectrum.
+     * @param noiseSize The width and height of the noise grid.
+     */
+    void init(const SpectrumParams& params, const float* noise, uint32_t noiseSize);
+
+    /**
+     * @brief Evaluates the displacement at the specified time. This can be
+     * called from any thread, but not concurrently for the same spectrum.
+     * @param scale The normalisation applied to the inverse transform - this
+     * must match the gpu, i.e. 1 / (N * N) for a gpu resolution of N.
+     */
+    void evaluate(float time, float scale, float choppyFactor, DisplacementGrid& out);
+
+    [[nodiscard]] const SpectrumParams& getParams() const noexcept { return params_; }
+
+private:
+    SpectrumParams params_;
+
+    // interleaved complex values, as the gpu
+    std::vector<float> h0k_;
+    std::vector<float> h0minusk_;
+
+    // the angular frequency and the direction of each mode
+    std::vector<float> omega_;
+    std::vector<float> dirX_;
+    std::vector<float> dirZ_;
+
+    // the dy and dx spectra which are transformed in place
+    std::vector<float> dyRe_;
+    std::vector<float> dyIm_;
+    std::vector<float> dxRe_;
+    std::vector<float> dxIm_;
+};
+
+} // namespace ocean
+} // namespace util
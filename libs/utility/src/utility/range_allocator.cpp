@@ -0,0 +1,136 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "range_allocator.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace util
+{
+
+RangeAllocator::RangeAllocator(uint64_t capacity) : capacity_(0), freeSize_(0) { reset(capacity); }
+
+uint64_t RangeAllocator::allocate(uint64_t size, uint64_t alignment)
+{
+    assert(size > 0);
+    assert(alignment > 0);
+
+    for (auto iter = freeBlocks_.begin(); iter != freeBlocks_.end(); ++iter)
+    {
+        const uint64_t blockOffset = iter->first;
+        const uint64_t blockSize = iter->second;
+
+        const uint64_t alignedOffset = (blockOffset + alignment - 1) / alignment * alignment;
+        const uint64_t padding = alignedOffset - blockOffset;
+        if (padding + size > blockSize)
+        {
+            continue;
+        }
+
+        // split the block - any space used for padding stays in the free list
+        // at the original offset, the remainder goes after the allocation.
+        freeBlocks_.erase(iter);
+        if (padding > 0)
+        {
+            freeBlocks_.emplace(blockOffset, padding);
+        }
+        const uint64_t remainder = blockSize - padding - size;
+        if (remainder > 0)
+        {
+            freeBlocks_.emplace(alignedOffset + size, remainder);
+        }
+        freeSize_ -= size;
+        return alignedOffset;
+    }
+    return InvalidOffset;
+}
+
+void RangeAllocator::release(uint64_t offset, uint64_t size)
+{
+    assert(size > 0);
+    assert(offset + size <= capacity_);
+    insertFreeBlock(offset, size);
+    freeSize_ += size;
+}
+
+void RangeAllocator::grow(uint64_t newCapacity)
+{
+    if (newCapacity <= capacity_)
+    {
+        return;
+    }
+    const uint64_t extra = newCapacity - capacity_;
+    insertFreeBlock(capacity_, extra);
+    capacity_ = newCapacity;
+    freeSize_ += extra;
+}
+
+void RangeAllocator::reset(uint64_t capacity)
+{
+    freeBlocks_.clear();
+    capacity_ = capacity;
+    freeSize_ = capacity;
+    if (capacity > 0)
+    {
+        freeBlocks_.emplace(0, capacity);
+    }
+}
+
+uint64_t RangeAllocator::largestFreeBlock() const noexcept
+{
+    uint64_t largest = 0;
+    for (const auto& [offset, size] : freeBlocks_)
+    {
+        largest = std::max(largest, size);
+    }
+    return largest;
+}
+
+void RangeAllocator::insertFreeBlock(uint64_t offset, uint64_t size)
+{
+    auto next = freeBlocks_.lower_bound(offset);
+    assert(next == freeBlocks_.end() || next->first >= offset + size);
+
+    // merge with the following block if adjacent
+    if (next != freeBlocks_.end() && next->first == offset + size)
+    {
+        size += next->second;
+        next = freeBlocks_.erase(next);
+    }
+
+    // merge with the preceding block if adjacent
+    if (next != freeBlocks_.begin())
+    {
+        auto prev = std::prev(next);
+        assert(prev->first + prev->second <= offset);
+        if (prev->first + prev->second == offset)
+        {
+            prev->second += size;
+            return;
+        }
+    }
+    freeBlocks_.emplace_hint(next, offset, size);
+}
+
+} // namespace util
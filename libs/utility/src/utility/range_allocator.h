@@ -0,0 +1,90 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+namespace util
+{
+
+/**
+ A first-fit free-list allocator for sub-allocating offset ranges from a
+ linear block of memory, i.e. a large GPU buffer. No memory is owned by the
+ allocator - it only tracks which ranges are free. Free ranges are kept
+ ordered by offset so that released ranges can be coalesced with their
+ neighbours.
+ */
+class RangeAllocator
+{
+public:
+    static constexpr uint64_t InvalidOffset = UINT64_MAX;
+
+    explicit RangeAllocator(uint64_t capacity = 0);
+
+    /**
+     * @brief Allocates a range from the first free block that is large enough.
+     * @param size The size of the range to allocate in bytes.
+     * @param alignment The required alignment of the returned offset. This
+     * does not need to be a power of two.
+     * @return The offset of the allocated range, or InvalidOffset if there is
+     * no free block large enough to hold the range.
+     */
+    uint64_t allocate(uint64_t size, uint64_t alignment = 1);
+
+    /**
+     * @brief Returns a range to the allocator. The offset and size must match
+     * those of a prior allocation.
+     */
+    void release(uint64_t offset, uint64_t size);
+
+    /**
+     * @brief Increases the capacity of the allocator - the extra space is
+     * appended as a free block at the end of the current range.
+     */
+    void grow(uint64_t newCapacity);
+
+    // Releases all allocations and sets the capacity.
+    void reset(uint64_t capacity);
+
+    [[nodiscard]] uint64_t capacity() const noexcept { return capacity_; }
+    [[nodiscard]] uint64_t freeSize() const noexcept { return freeSize_; }
+    [[nodiscard]] uint64_t usedSize() const noexcept { return capacity_ - freeSize_; }
+    [[nodiscard]] size_t freeBlockCount() const noexcept { return freeBlocks_.size(); }
+
+    [[nodiscard]] uint64_t largestFreeBlock() const noexcept;
+
+private:
+    void insertFreeBlock(uint64_t offset, uint64_t size);
+
+private:
+    // free blocks keyed by offset, the value being the block size
+    std::map<uint64_t, uint64_t> freeBlocks_;
+
+    uint64_t capacity_;
+    uint64_t freeSize_;
+};
+
+} // namespace util
@@ -0,0 +1,365 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define YAVE_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define YAVE_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+// defined when the vector types hold four lanes
+#if defined(YAVE_SIMD_SSE2) || defined(YAVE_SIMD_NEON)
+#define YAVE_SIMD
+#endif
+
+namespace util
+{
+namespace simd
+{
+
+/**
+ * @brief A thin layer over the SSE2 and NEON intrinsics so that vectorised
+ * kernels are only written once. Float vectors (VecF) hold Width 32-bit float
+ * lanes and integer vectors (VecI) hold Width 32-bit integer lanes.
+ *
+ * Where neither instruction set is available, the vectors are a single
+ * scalar lane so kernels written in terms of Width still work. The functions
+ * which load or store 8 and 16-bit values assume four lanes, so are only
+ * available when YAVE_SIMD is defined.
+ */
+
+#if defined(YAVE_SIMD_SSE2)
+
+constexpr uint32_t Width = 4;
+using VecF = __m128;
+using VecI = __m128i;
+
+inline VecF loadF(const float* p) noexcept { return _mm_loadu_ps(p); }
+inline void storeF(float* p, VecF v) noexcept { _mm_storeu_ps(p, v); }
+inline VecI loadI(const void* p) noexcept
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+inline void storeI(void* p, VecI v) noexcept { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+inline VecI splatI(int32_t value) noexcept { return _mm_set1_epi32(value); }
+inline VecF splatF(float value) noexcept { return _mm_set1_ps(value); }
+
+inline VecI andI(VecI a, VecI b) noexcept { return _mm_and_si128(a, b); }
+inline VecI orI(VecI a, VecI b) noexcept { return _mm_or_si128(a, b); }
+inline VecI addI(VecI a, VecI b) noexcept { return _mm_add_epi32(a, b); }
+inline VecI subI(VecI a, VecI b) noexcept { return _mm_sub_epi32(a, b); }
+inline VecI cmpGtI(VecI a, VecI b) noexcept { return _mm_cmpgt_epi32(a, b); }
+// selects a where the mask is set, otherwise b
+inline VecI selectI(VecI mask, VecI a, VecI b) noexcept
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+template <int N>
+inline VecI shiftLeft(VecI v) noexcept
+{
+    return _mm_slli_epi32(v, N);
+}
+template <int N>
+inline VecI shiftRight(VecI v) noexcept
+{
+    return _mm_srli_epi32(v, N);
+}
+template <int N>
+inline VecI shiftRightArith(VecI v) noexcept
+{
+    return _mm_srai_epi32(v, N);
+}
+
+inline VecF addF(VecF a, VecF b) noexcept { return _mm_add_ps(a, b); }
+inline VecF subF(VecF a, VecF b) noexcept { return _mm_sub_ps(a, b); }
+inline VecF mulF(VecF a, VecF b) noexcept { return _mm_mul_ps(a, b); }
+inline VecF divF(VecF a, VecF b) noexcept { return _mm_div_ps(a, b); }
+inline VecF sqrtF(VecF v) noexcept { return _mm_sqrt_ps(v); }
+// the order of the operands ensures a nan is replaced by the limit
+inline VecF maxF(VecF v, VecF limit) noexcept { return _mm_max_ps(v, limit); }
+inline VecF minF(VecF v, VecF limit) noexcept { return _mm_min_ps(v, limit); }
+inline VecF floorF(VecF v) noexcept
+{
+    // SSE2 has no floor - truncate and correct the negative values
+    const VecF t = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+    return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, v), _mm_set1_ps(1.0f)));
+}
+inline VecI isNanF(VecF v) noexcept { return _mm_castps_si128(_mm_cmpunord_ps(v, v)); }
+inline VecI cmpGtF(VecF a, VecF b) noexcept { return _mm_castps_si128(_mm_cmpgt_ps(a, b)); }
+inline VecI cmpGeF(VecF a, VecF b) noexcept { return _mm_castps_si128(_mm_cmpge_ps(a, b)); }
+inline VecI cmpLeF(VecF a, VecF b) noexcept { return _mm_castps_si128(_mm_cmple_ps(a, b)); }
+inline VecF toFloat(VecI v) noexcept { return _mm_cvtepi32_ps(v); }
+inline VecI truncate(VecF v) noexcept { return _mm_cvttps_epi32(v); }
+inline VecF asFloat(VecI v) noexcept { return _mm_castsi128_ps(v); }
+inline VecI asInt(VecF v) noexcept { return _mm_castps_si128(v); }
+
+// loads four 16 or 8-bit values, extending them to 32 bits
+inline VecI loadU16(const void* p) noexcept
+{
+    const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+    return _mm_unpacklo_epi16(v, _mm_setzero_si128());
+}
+inline VecI loadI16(const void* p) noexcept
+{
+    const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+    return _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+}
+inline VecI loadU8(const void* p) noexcept
+{
+    int32_t bits;
+    memcpy(&bits, p, sizeof(int32_t));
+    const __m128i v = _mm_unpacklo_epi8(_mm_cvtsi32_si128(bits), _mm_setzero_si128());
+    return _mm_unpacklo_epi16(v, _mm_setzero_si128());
+}
+inline VecI loadI8(const void* p) noexcept
+{
+    int32_t bits;
+    memcpy(&bits, p, sizeof(int32_t));
+    __m128i v = _mm_cvtsi32_si128(bits);
+    v = _mm_unpacklo_epi8(v, v);
+    return _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 24);
+}
+
+// stores the low 16 or 8 bits of each lane
+inline void storeLow16(void* p, VecI v) noexcept
+{
+    // sign extend the low half so the saturating pack keeps it unchanged
+    v = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packs_epi32(v, v));
+}
+inline void storeLow8(void* p, VecI v) noexcept
+{
+    v = _mm_srai_epi32(_mm_slli_epi32(v, 24), 24);
+    v = _mm_packs_epi32(v, v);
+    v = _mm_packs_epi16(v, v);
+    const int32_t bits = _mm_cvtsi128_si32(v);
+    memcpy(p, &bits, sizeof(int32_t));
+}
+
+#elif defined(YAVE_SIMD_NEON)
+
+constexpr uint32_t Width = 4;
+using VecF = float32x4_t;
+using VecI = int32x4_t;
+
+inline VecF loadF(const float* p) noexcept { return vld1q_f32(p); }
+inline void storeF(float* p, VecF v) noexcept { vst1q_f32(p, v); }
+inline VecI loadI(const void* p) noexcept
+{
+    return vreinterpretq_s32_u8(vld1q_u8(static_cast<const uint8_t*>(p)));
+}
+inline void storeI(void* p, VecI v) noexcept
+{
+    vst1q_u8(static_cast<uint8_t*>(p), vreinterpretq_u8_s32(v));
+}
+inline VecI splatI(int32_t value) noexcept { return vdupq_n_s32(value); }
+inline VecF splatF(float value) noexcept { return vdupq_n_f32(value); }
+
+inline VecI andI(VecI a, VecI b) noexcept { return vandq_s32(a, b); }
+inline VecI orI(VecI a, VecI b) noexcept { return vorrq_s32(a, b); }
+inline VecI addI(VecI a, VecI b) noexcept { return vaddq_s32(a, b); }
+inline VecI subI(VecI a, VecI b) noexcept { return vsubq_s32(a, b); }
+inline VecI cmpGtI(VecI a, VecI b) noexcept { return vreinterpretq_s32_u32(vcgtq_s32(a, b)); }
+inline VecI selectI(VecI mask, VecI a, VecI b) noexcept
+{
+    return vbslq_s32(vreinterpretq_u32_s32(mask), a, b);
+}
+template <int N>
+inline VecI shiftLeft(VecI v) noexcept
+{
+    return vshlq_n_s32(v, N);
+}
+template <int N>
+inline VecI shiftRight(VecI v) noexcept
+{
+    return vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(v), N));
+}
+template <int N>
+inline VecI shiftRightArith(VecI v) noexcept
+{
+    return vshrq_n_s32(v, N);
+}
+
+inline VecF addF(VecF a, VecF b) noexcept { return vaddq_f32(a, b); }
+inline VecF subF(VecF a, VecF b) noexcept { return vsubq_f32(a, b); }
+inline VecF mulF(VecF a, VecF b) noexcept { return vmulq_f32(a, b); }
+inline VecF divF(VecF a, VecF b) noexcept { return vdivq_f32(a, b); }
+inline VecF sqrtF(VecF v) noexcept { return vsqrtq_f32(v); }
+// the "nm" variants return the number if one of the operands is a nan
+inline VecF maxF(VecF v, VecF limit) noexcept { return vmaxnmq_f32(v, limit); }
+inline VecF minF(VecF v, VecF limit) noexcept { return vminnmq_f32(v, limit); }
+inline VecF floorF(VecF v) noexcept { return vrndmq_f32(v); }
+inline VecI isNanF(VecF v) noexcept { return vreinterpretq_s32_u32(vmvnq_u32(vceqq_f32(v, v))); }
+inline VecI cmpGtF(VecF a, VecF b) noexcept { return vreinterpretq_s32_u32(vcgtq_f32(a, b)); }
+inline VecI cmpGeF(VecF a, VecF b) noexcept { return vreinterpretq_s32_u32(vcgeq_f32(a, b)); }
+inline VecI cmpLeF(VecF a, VecF b) noexcept { return vreinterpretq_s32_u32(vcleq_f32(a, b)); }
+inline VecF toFloat(VecI v) noexcept { return vcvtq_f32_s32(v); }
+inline VecI truncate(VecF v) noexcept { return vcvtq_s32_f32(v); }
+inline VecF asFloat(VecI v) noexcept { return vreinterpretq_f32_s32(v); }
+inline VecI asInt(VecF v) noexcept { return vreinterpretq_s32_f32(v); }
+
+inline VecI loadU16(const void* p) noexcept
+{
+    const uint16x4_t v = vreinterpret_u16_u8(vld1_u8(static_cast<const uint8_t*>(p)));
+    return vreinterpretq_s32_u32(vmovl_u16(v));
+}
+inline VecI loadI16(const void* p) noexcept
+{
+    return vmovl_s16(vreinterpret_s16_u8(vld1_u8(static_cast<const uint8_t*>(p))));
+}
+inline VecI loadU8(const void* p) noexcept
+{
+    uint32_t bits;
+    memcpy(&bits, p, sizeof(uint32_t));
+    const uint8x8_t v = vreinterpret_u8_u32(vdup_n_u32(bits));
+    return vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(vmovl_u8(v))));
+}
+inline VecI loadI8(const void* p) noexcept
+{
+    uint32_t bits;
+    memcpy(&bits, p, sizeof(uint32_t));
+    const int8x8_t v = vreinterpret_s8_u32(vdup_n_u32(bits));
+    return vmovl_s16(vget_low_s16(vmovl_s8(v)));
+}
+
+inline void storeLow16(void* p, VecI v) noexcept
+{
+    vst1_u8(static_cast<uint8_t*>(p), vreinterpret_u8_s16(vmovn_s32(v)));
+}
+inline void storeLow8(void* p, VecI v) noexcept
+{
+    const int16x4_t narrow = vmovn_s32(v);
+    const int8x8_t bytes = vmovn_s16(vcombine_s16(narrow, narrow));
+    const uint32_t bits = vget_lane_u32(vreinterpret_u32_s8(bytes), 0);
+    memcpy(p, &bits, sizeof(uint32_t));
+}
+
+#else
+
+constexpr uint32_t Width = 1;
+using VecF = float;
+using VecI = int32_t;
+
+inline VecF loadF(const float* p) noexcept { return *p; }
+inline void storeF(float* p, VecF v) noexcept { *p = v; }
+inline VecI loadI(const void* p) noexcept
+{
+    VecI v;
+    memcpy(&v, p, sizeof(VecI));
+    return v;
+}
+inline void storeI(void* p, VecI v) noexcept { memcpy(p, &v, sizeof(VecI)); }
+inline VecI splatI(int32_t value) noexcept { return value; }
+inline VecF splatF(float value) noexcept { return value; }
+
+inline VecI andI(VecI a, VecI b) noexcept { return a & b; }
+inline VecI orI(VecI a, VecI b) noexcept { return a | b; }
+inline VecI addI(VecI a, VecI b) noexcept
+{
+    return static_cast<VecI>(static_cast<uint32_t>(a) + static_cast<uint32_t>(b));
+}
+inline VecI subI(VecI a, VecI b) noexcept
+{
+    return static_cast<VecI>(static_cast<uint32_t>(a) - static_cast<uint32_t>(b));
+}
+inline VecI cmpGtI(VecI a, VecI b) noexcept { return a > b ? -1 : 0; }
+inline VecI selectI(VecI mask, VecI a, VecI b) noexcept { return (mask & a) | (~mask & b); }
+template <int N>
+inline VecI shiftLeft(VecI v) noexcept
+{
+    return static_cast<VecI>(static_cast<uint32_t>(v) << N);
+}
+template <int N>
+inline VecI shiftRight(VecI v) noexcept
+{
+    return static_cast<VecI>(static_cast<uint32_t>(v) >> N);
+}
+template <int N>
+inline VecI shiftRightArith(VecI v) noexcept
+{
+    return v >> N;
+}
+
+inline VecF addF(VecF a, VecF b) noexcept { return a + b; }
+inline VecF subF(VecF a, VecF b) noexcept { return a - b; }
+inline VecF mulF(VecF a, VecF b) noexcept { return a * b; }
+inline VecF divF(VecF a, VecF b) noexcept { return a / b; }
+inline VecF sqrtF(VecF v) noexcept { return std::sqrt(v); }
+// written so a nan is replaced by the limit, as with the vector versions
+inline VecF maxF(VecF v, VecF limit) noexcept { return v > limit ? v : limit; }
+inline VecF minF(VecF v, VecF limit) noexcept { return v < limit ? v : limit; }
+inline VecF floorF(VecF v) noexcept { return std::floor(v); }
+inline VecI isNanF(VecF v) noexcept { return v != v ? -1 : 0; }
+inline VecI cmpGtF(VecF a, VecF b) noexcept { return a > b ? -1 : 0; }
+inline VecI cmpGeF(VecF a, VecF b) noexcept { return a >= b ? -1 : 0; }
+inline VecI cmpLeF(VecF a, VecF b) noexcept { return a <= b ? -1 : 0; }
+inline VecF toFloat(VecI v) noexcept { return static_cast<VecF>(v); }
+inline VecI truncate(VecF v) noexcept { return static_cast<VecI>(v); }
+inline VecF asFloat(VecI v) noexcept
+{
+    VecF f;
+    memcpy(&f, &v, sizeof(VecF));
+    return f;
+}
+inline VecI asInt(VecF v) noexcept
+{
+    VecI i;
+    memcpy(&i, &v, sizeof(VecI));
+    return i;
+}
+
+#endif
+
+inline float sumLanes(VecF v) noexcept
+{
+#ifdef YAVE_SIMD
+    float lanes[4];
+    storeF(lanes, v);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#else
+    return v;
+#endif
+}
+
+// the name of the instruction set the vector types map to
+constexpr const char* getInstructionSet() noexcept
+{
+#if defined(YAVE_SIMD_SSE2)
+    return "SSE2";
+#elif defined(YAVE_SIMD_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+} // namespace simd
+} // namespace util
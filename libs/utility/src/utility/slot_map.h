@@ -0,0 +1,226 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "assertion.h"
+#include "handle.h"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace util
+{
+
+/**
+ A pooled container which hands out generational handles to its elements.
+
+ Elements are stored in fixed size chunks so pointers to an element remain
+ stable for its lifetime, and erased slots are recycled via a free list.
+ A handle is a 32-bit key split into a slot index and a generation count -
+ the generation is incremented each time a slot is erased, so handles
+ referring to a previous occupant of the slot can be detected as stale.
+
+ Lookups are O(1) - the generation is only validated in debug builds; use
+ isValid() where a handle may legitimately be stale.
+
+ @tparam T The element type.
+ @tparam ChunkSize The number of elements in each storage chunk.
+ */
+template <typename T, uint32_t ChunkSize = 64>
+class SlotMap
+{
+public:
+    using HandleType = Handle<T>;
+
+    static constexpr uint32_t IndexBits = 20;
+    static constexpr uint32_t IndexMask = (1u << IndexBits) - 1;
+    static constexpr uint32_t GenerationMask = (1u << (32u - IndexBits)) - 1;
+
+    // The last index is reserved so a valid handle never equals HandleBase::UNINITIALISED
+    static constexpr uint32_t MaxSlotCount = IndexMask;
+
+    SlotMap() : slotCount_(0), size_(0) {}
+    ~SlotMap() { clear(); }
+
+    // not copyable
+    SlotMap(const SlotMap&) = delete;
+    SlotMap& operator=(const SlotMap&) = delete;
+
+    template <typename... Args>
+    HandleType emplace(Args&&... args)
+    {
+        uint32_t index;
+        if (!freeList_.empty())
+        {
+            index = freeList_.back();
+            freeList_.pop_back();
+        }
+        else
+        {
+            // the handle index would overflow into the generation bits
+            ASSERT_FATAL(
+                slotCount_ < MaxSlotCount,
+                "Slot map is full - the maximum number of slots is %u.",
+                MaxSlotCount);
+            if (slotCount_ % ChunkSize == 0)
+            {
+                chunks_.emplace_back(std::make_unique<Chunk>());
+            }
+            index = slotCount_++;
+        }
+
+        Slot& s = slot(index);
+        new (s.storage) T(std::forward<Args>(args)...);
+        s.alive = true;
+        ++size_;
+        return HandleType {makeKey(index, s.generation)};
+    }
+
+    void erase(const HandleType& handle) noexcept
+    {
+        assert(isValid(handle));
+        uint32_t index = getIndex(handle);
+        Slot& s = slot(index);
+        s.get()->~T();
+        s.alive = false;
+        // invalidates all existing handles to this slot
+        s.generation = (s.generation + 1) & GenerationMask;
+        freeList_.push_back(index);
+        --size_;
+    }
+
+    [[nodiscard]] bool isValid(const HandleType& handle) const noexcept
+    {
+        if (!handle)
+        {
+            return false;
+        }
+        uint32_t index = getIndex(handle);
+        if (index >= slotCount_)
+        {
+            return false;
+        }
+        const Slot& s = slot(index);
+        return s.alive && s.generation == getGeneration(handle);
+    }
+
+    T* get(const HandleType& handle) noexcept
+    {
+        if (!handle)
+        {
+            return nullptr;
+        }
+        assert(isValid(handle) && "Stale or invalid slot map handle.");
+        return slot(getIndex(handle)).get();
+    }
+
+    const T* get(const HandleType& handle) const noexcept
+    {
+        return const_cast<SlotMap*>(this)->get(handle);
+    }
+
+    // Calls func(HandleType, T&) for each live element.
+    template <typename Func>
+    void forEach(Func&& func)
+    {
+        for (uint32_t index = 0; index < slotCount_; ++index)
+        {
+            Slot& s = slot(index);
+            if (s.alive)
+            {
+                func(HandleType {makeKey(index, s.generation)}, *s.get());
+            }
+        }
+    }
+
+    void clear() noexcept
+    {
+        for (uint32_t index = 0; index < slotCount_; ++index)
+        {
+            Slot& s = slot(index);
+            if (s.alive)
+            {
+                s.get()->~T();
+                s.alive = false;
+            }
+        }
+        chunks_.clear();
+        freeList_.clear();
+        slotCount_ = 0;
+        size_ = 0;
+    }
+
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+    static uint32_t getIndex(const HandleType& handle) noexcept
+    {
+        return handle.getKey() & IndexMask;
+    }
+
+    static uint32_t getGeneration(const HandleType& handle) noexcept
+    {
+        return handle.getKey() >> IndexBits;
+    }
+
+private:
+    struct Slot
+    {
+        alignas(T) unsigned char storage[sizeof(T)];
+        uint32_t generation = 0;
+        bool alive = false;
+
+        T* get() noexcept { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+    using Chunk = std::array<Slot, ChunkSize>;
+
+    static uint32_t makeKey(uint32_t index, uint32_t generation) noexcept
+    {
+        return (generation << IndexBits) | index;
+    }
+
+    Slot& slot(uint32_t index) noexcept { return (*chunks_[index / ChunkSize])[index % ChunkSize]; }
+
+    const Slot& slot(uint32_t index) const noexcept
+    {
+        return (*chunks_[index / ChunkSize])[index % ChunkSize];
+    }
+
+private:
+    std::vector<std::unique_ptr<Chunk>> chunks_;
+    std::vector<uint32_t> freeList_;
+
+    // the number of slots that have been used - live or free
+    uint32_t slotCount_;
+    // the number of live elements
+    size_t size_;
+};
+
+} // namespace util
@@ -0,0 +1,317 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "spherical_harmonics.h"
+
+#include "simd.h"
+
+#include <cmath>
+
+namespace util
+{
+namespace sh
+{
+
+namespace
+{
+
+constexpr float Pi = 3.14159265358979f;
+
+// the normalisation constants of each basis function
+constexpr float Y00 = 0.282095f;
+constexpr float Y1 = 0.488603f;
+constexpr float Y2 = 1.092548f;
+constexpr float Y20 = 0.315392f;
+constexpr float Y22 = 0.546274f;
+
+// the clamped cosine lobe of each band, divided by pi
+constexpr float BandFactors[CoeffCount] = {
+    1.0f, 2.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f};
+
+// The direction through a texel of a face is u * uAxis + v * vAxis + normal.
+struct FaceAxes
+{
+    float uAxis[3];
+    float vAxis[3];
+    float normal[3];
+};
+
+constexpr FaceAxes Faces[6] = {
+    {{0.0f, 0.0f, -1.0f}, {0.0f, -1.0f, 0.0f}, {1.0f, 0.0f, 0.0f}},
+    {{0.0f, 0.0f, 1.0f}, {0.0f, -1.0f, 0.0f}, {-1.0f, 0.0f, 0.0f}},
+    {{1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f}},
+    {{1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, -1.0f}, {0.0f, -1.0f, 0.0f}},
+    {{1.0f, 0.0f, 0.0f}, {0.0f, -1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
+    {{-1.0f, 0.0f, 0.0f}, {0.0f, -1.0f, 0.0f}, {0.0f, 0.0f, -1.0f}}};
+
+void projectTexel(
+    const FaceAxes& axes, float u, float v, const float* texel, Projection& proj) noexcept
+{
+    // the solid angle of a texel is proportional to 1 / (1 + u^2 + v^2)^(3/2)
+    const float invLen = 1.0f / std::sqrt(1.0f + u * u + v * v);
+    const float weight = invLen * invLen * invLen;
+
+    float dir[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        dir[i] = (u * axes.uAxis[i] + v * axes.vAxis[i] + axes.normal[i]) * invLen;
+    }
+    float basis[CoeffCount];
+    evalBasis(dir[0], dir[1], dir[2], basis);
+
+    const float r = texel[0] * weight;
+    const float g = texel[1] * weight;
+    const float b = texel[2] * weight;
+    for (uint32_t i = 0; i < CoeffCount; ++i)
+    {
+        proj.r[i] += r * basis[i];
+        proj.g[i] += g * basis[i];
+        proj.b[i] += b * basis[i];
+    }
+    proj.weight += weight;
+}
+
+#ifdef YAVE_SIMD
+
+using namespace simd;
+
+// loads four RGBA texels, returning the rgb channels of each in a vector
+inline void loadTexels(const float* p, VecF& r, VecF& g, VecF& b) noexcept
+{
+#ifdef YAVE_SIMD_SSE2
+    VecF t0 = loadF(p);
+    VecF t1 = loadF(p + 4);
+    VecF t2 = loadF(p + 8);
+    VecF t3 = loadF(p + 12);
+    _MM_TRANSPOSE4_PS(t0, t1, t2, t3);
+    r = t0;
+    g = t1;
+    b = t2;
+#else
+    const float32x4x4_t texels = vld4q_f32(p);
+    r = texels.val[0];
+    g = texels.val[1];
+    b = texels.val[2];
+#endif
+}
+
+// Projects four texels of a row at a time. Returns the number of texels
+// projected - the remainder is left to the scalar path.
+uint32_t projectRowSimd(
+    const float* row, uint32_t size, const FaceAxes& axes, float v, Projection& proj) noexcept
+{
+    const float scale = 2.0f / static_cast<float>(size);
+    const float laneOffsets[4] = {0.5f, 1.5f, 2.5f, 3.5f};
+    const VecF laneU = subF(mulF(loadF(laneOffsets), splatF(scale)), splatF(1.0f));
+    const VecF scaleV = splatF(scale);
+    const VecF oneV = splatF(1.0f);
+    const VecF vSq = splatF(1.0f + v * v);
+
+    // the direction before normalisation is linear in u, so each component
+    // is a constant plus a multiple of u
+    VecF dirBase[3];
+    VecF dirU[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        dirBase[i] = splatF(v * axes.vAxis[i] + axes.normal[i]);
+        dirU[i] = splatF(axes.uAxis[i]);
+    }
+
+    const VecF y00 = splatF(Y00);
+    const VecF y1 = splatF(Y1);
+    const VecF y2 = splatF(Y2);
+    const VecF y20 = splatF(Y20);
+    const VecF y22 = splatF(Y22);
+    const VecF three = splatF(3.0f);
+
+    VecF accR[CoeffCount];
+    VecF accG[CoeffCount];
+    VecF accB[CoeffCount];
+    for (uint32_t i = 0; i < CoeffCount; ++i)
+    {
+        accR[i] = splatF(0.0f);
+        accG[i] = splatF(0.0f);
+        accB[i] = splatF(0.0f);
+    }
+    VecF accWeight = splatF(0.0f);
+
+    uint32_t x = 0;
+    for (; x + 4 <= size; x += 4)
+    {
+        const VecF u = addF(mulF(splatF(static_cast<float>(x)), scaleV), laneU);
+        const VecF invLen = divF(oneV, sqrtF(addF(vSq, mulF(u, u))));
+        const VecF weight = mulF(mulF(invLen, invLen), invLen);
+
+        const VecF dx = mulF(addF(dirBase[0], mulF(u, dirU[0])), invLen);
+        const VecF dy = mulF(addF(dirBase[1], mulF(u, dirU[1])), invLen);
+        const VecF dz = mulF(addF(dirBase[2], mulF(u, dirU[2])), invLen);
+
+        VecF basis[CoeffCount];
+        basis[0] = y00;
+        basis[1] = mulF(y1, dy);
+        basis[2] = mulF(y1, dz);
+        basis[3] = mulF(y1, dx);
+        basis[4] = mulF(y2, mulF(dx, dy));
+        basis[5] = mulF(y2, mulF(dy, dz));
+        basis[6] = mulF(y20, subF(mulF(three, mulF(dz, dz)), oneV));
+        basis[7] = mulF(y2, mulF(dx, dz));
+        basis[8] = mulF(y22, subF(mulF(dx, dx), mulF(dy, dy)));
+
+        VecF r, g, b;
+        loadTexels(row + x * 4, r, g, b);
+        r = mulF(r, weight);
+        g = mulF(g, weight);
+        b = mulF(b, weight);
+
+        for (uint32_t i = 0; i < CoeffCount; ++i)
+        {
+            accR[i] = addF(accR[i], mulF(r, basis[i]));
+            accG[i] = addF(accG[i], mulF(g, basis[i]));
+            accB[i] = addF(accB[i], mulF(b, basis[i]));
+        }
+        accWeight = addF(accWeight, weight);
+    }
+
+    for (uint32_t i = 0; i < CoeffCount; ++i)
+    {
+        proj.r[i] += sumLanes(accR[i]);
+        proj.g[i] += sumLanes(accG[i]);
+        proj.b[i] += sumLanes(accB[i]);
+    }
+    proj.weight += sumLanes(accWeight);
+    return x;
+}
+
+#endif
+
+} // namespace
+
+Projection& Projection::operator+=(const Projection& rhs) noexcept
+{
+    for (uint32_t i = 0; i < CoeffCount; ++i)
+    {
+        r[i] += rhs.r[i];
+        g[i] += rhs.g[i];
+        b[i] += rhs.b[i];
+    }
+    weight += rhs.weight;
+    return *this;
+}
+
+void evalBasis(float x, float y, float z, float* out) noexcept
+{
+    out[0] = Y00;
+    out[1] = Y1 * y;
+    out[2] = Y1 * z;
+    out[3] = Y1 * x;
+    out[4] = Y2 * x * y;
+    out[5] = Y2 * y * z;
+    out[6] = Y20 * (3.0f * z * z - 1.0f);
+    out[7] = Y2 * x * z;
+    out[8] = Y22 * (x * x - y * y);
+}
+
+void getCubeDirection(uint32_t face, float u, float v, float* dir) noexcept
+{
+    const FaceAxes& axes = Faces[face];
+    for (int i = 0; i < 3; ++i)
+    {
+        dir[i] = u * axes.uAxis[i] + v * axes.vAxis[i] + axes.normal[i];
+    }
+}
+
+void projectRows(
+    const float* faceData,
+    uint32_t size,
+    uint32_t face,
+    uint32_t rowBegin,
+    uint32_t rowEnd,
+    Projection& proj) noexcept
+{
+    const FaceAxes& axes = Faces[face];
+    const float scale = 2.0f / static_cast<float>(size);
+
+    for (uint32_t y = rowBegin; y < rowEnd; ++y)
+    {
+        const float* row = faceData + static_cast<size_t>(y) * size * 4;
+        const float v = (static_cast<float>(y) + 0.5f) * scale - 1.0f;
+
+        uint32_t x = 0;
+#ifdef YAVE_SIMD
+        x = projectRowSimd(row, size, axes, v, proj);
+#endif
+        for (; x < size; ++x)
+        {
+            const float u = (static_cast<float>(x) + 0.5f) * scale - 1.0f;
+            projectTexel(axes, u, v, row + x * 4, proj);
+        }
+    }
+}
+
+Coefficients toIrradiance(const Projection& proj) noexcept
+{
+    Coefficients coeffs;
+    if (proj.weight <= 0.0f)
+    {
+        return coeffs;
+    }
+    // the weights sum to the area of the sphere
+    const float norm = 4.0f * Pi / proj.weight;
+    for (uint32_t i = 0; i < CoeffCount; ++i)
+    {
+        const float scale = norm * BandFactors[i];
+        coeffs.data[i][0] = proj.r[i] * scale;
+        coeffs.data[i][1] = proj.g[i] * scale;
+        coeffs.data[i][2] = proj.b[i] * scale;
+    }
+    return coeffs;
+}
+
+Coefficients projectCubeMap(const float* data, uint32_t size) noexcept
+{
+    const size_t faceSize = static_cast<size_t>(size) * size * 4;
+    Projection proj;
+    for (uint32_t face = 0; face < 6; ++face)
+    {
+        projectRows(data + face * faceSize, size, face, 0, size, proj);
+    }
+    return toIrradiance(proj);
+}
+
+void evaluate(const Coefficients& coeffs, float x, float y, float z, float* out) noexcept
+{
+    float basis[CoeffCount];
+    evalBasis(x, y, z, basis);
+    for (int c = 0; c < 3; ++c)
+    {
+        float sum = 0.0f;
+        for (uint32_t i = 0; i < CoeffCount; ++i)
+        {
+            sum += coeffs.data[i][c] * basis[i];
+        }
+        out[c] = sum;
+    }
+}
+
+} // namespace sh
+} // namespace util
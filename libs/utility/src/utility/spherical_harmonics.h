@@ -0,0 +1,109 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+
+namespace util
+{
+namespace sh
+{
+
+/**
+ * @brief Projection of a cube map onto the first three bands (L2) of the real
+ * spherical harmonics, used as a compact representation of the diffuse
+ * irradiance of an environment. The irradiance is the radiance convolved with
+ * a clamped cosine lobe which, in the SH domain, is a scale of each band - see
+ * "An Efficient Representation for Irradiance Environment Maps" (Ramamoorthi
+ * and Hanrahan).
+ *
+ * The cube faces are tightly packed RGBA floats, using the Vulkan face order
+ * and orientation (+X, -X, +Y, -Y, +Z, -Z).
+ */
+
+constexpr uint32_t CoeffCount = 9;
+
+/**
+ * @brief The radiance projected onto the basis and weighted by the solid angle
+ * of each texel. This is not normalised, so projections of separate rows and
+ * faces - for instance from different threads - can be summed.
+ */
+struct Projection
+{
+    float r[CoeffCount] = {};
+    float g[CoeffCount] = {};
+    float b[CoeffCount] = {};
+    // the sum of the texel weights - the weights are proportional to the
+    // solid angle of each texel
+    float weight = 0.0f;
+
+    Projection& operator+=(const Projection& rhs) noexcept;
+};
+
+/**
+ * @brief The rgb coefficients of each basis function. These are padded to four
+ * floats so they can be copied straight into a std140 vec4 array.
+ */
+struct Coefficients
+{
+    float data[CoeffCount][4] = {};
+};
+
+// Evaluates the nine basis functions for a normalised direction.
+void evalBasis(float x, float y, float z, float* out) noexcept;
+
+// The (unnormalised) direction through a texel of a cube face - u and v are in
+// the range [-1, 1] with v pointing down the face.
+void getCubeDirection(uint32_t face, float u, float v, float* dir) noexcept;
+
+/**
+ * @brief Projects the rows [rowBegin, rowEnd) of a face, adding the result to
+ * proj. Four texels are projected at a time with SSE2 or NEON where available.
+ * @param faceData The RGBA float texels of the face.
+ * @param size The width and height of the face.
+ */
+void projectRows(
+    const float* faceData,
+    uint32_t size,
+    uint32_t face,
+    uint32_t rowBegin,
+    uint32_t rowEnd,
+    Projection& proj) noexcept;
+
+/**
+ * @brief Normalises a projection to the sphere and convolves it with the
+ * cosine lobe. The result is the irradiance divided by pi, so it can be
+ * multiplied by the albedo directly as with the irradiance cube map.
+ */
+Coefficients toIrradiance(const Projection& proj) noexcept;
+
+// Projects all six faces on the calling thread.
+Coefficients projectCubeMap(const float* data, uint32_t size) noexcept;
+
+// Evaluates the coefficients in the normalised direction, writing the rgb
+// result to out.
+void evaluate(const Coefficients& coeffs, float x, float y, float z, float* out) noexcept;
+
+} // namespace sh
+} // namespace util
@@ -0,0 +1,869 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "stream_convert.h"
+
+#include "assertion.h"
+#include "simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace util
+{
+namespace stream
+{
+
+namespace
+{
+
+// the size of the temporary blocks used when converting strided streams
+constexpr size_t BlockSize = 4096;
+
+// the number of elements interleaved at a time - small enough that the
+// destination block stays in the cache while each attribute is written
+constexpr size_t InterleaveBlockCount = 256;
+
+struct IntRange
+{
+    float min;
+    float max;
+    float scale;
+    bool isSigned;
+};
+
+// the clamp range and scale applied to floats when converting to an integer type
+IntRange getIntRange(Type type, bool normalised) noexcept
+{
+    switch (type)
+    {
+        case Type::Int8:
+            return normalised ? IntRange {-1.0f, 1.0f, 127.0f, true}
+                              : IntRange {-128.0f, 127.0f, 1.0f, true};
+        case Type::Uint8:
+            return normalised ? IntRange {0.0f, 1.0f, 255.0f, false}
+                              : IntRange {0.0f, 255.0f, 1.0f, false};
+        case Type::Int16:
+            return normalised ? IntRange {-1.0f, 1.0f, 32767.0f, true}
+                              : IntRange {-32768.0f, 32767.0f, 1.0f, true};
+        case Type::Uint16:
+            return normalised ? IntRange {0.0f, 1.0f, 65535.0f, false}
+                              : IntRange {0.0f, 65535.0f, 1.0f, false};
+        default:
+            return IntRange {0.0f, 1.0f, 1.0f, false};
+    }
+}
+
+// written so a nan is clamped to the minimum, as with the vector versions
+float clampValue(float value, float minValue, float maxValue) noexcept
+{
+    value = value > minValue ? value : minValue;
+    return value < maxValue ? value : maxValue;
+}
+
+int32_t toInt(float value, const IntRange& range) noexcept
+{
+    const float scaled = clampValue(value, range.min, range.max) * range.scale;
+    return range.isSigned ? static_cast<int32_t>(std::round(scaled))
+                          : static_cast<int32_t>(scaled + 0.5f);
+}
+
+template <typename T>
+void fromFloatScalar(const float* src, const IntRange& range, T* dst, size_t count) noexcept
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        dst[i] = static_cast<T>(toInt(src[i], range));
+    }
+}
+
+template <typename T>
+void toFloatScalar(const T* src, bool normalised, float* dst, size_t count) noexcept
+{
+    if (!normalised)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            dst[i] = static_cast<float>(src[i]);
+        }
+        return;
+    }
+    constexpr auto maxValue = static_cast<float>(std::numeric_limits<T>::max());
+    for (size_t i = 0; i < count; ++i)
+    {
+        // as per the Vulkan spec, the minimum signed value is mapped to -1.0
+        dst[i] = std::max(src[i] / maxValue, -1.0f);
+    }
+}
+
+template <typename SrcType, typename DstType>
+void indicesScalar(
+    const uint8_t* src, size_t srcStride, uint32_t base, DstType* dst, size_t count) noexcept
+{
+    for (size_t i = 0; i < count; ++i, src += srcStride)
+    {
+        SrcType index;
+        memcpy(&index, src, sizeof(SrcType));
+        dst[i] = static_cast<DstType>(index + base);
+    }
+}
+
+template <typename DstType>
+void convertIndicesScalar(
+    const void* src,
+    size_t srcStride,
+    Type srcType,
+    uint32_t base,
+    DstType* dst,
+    size_t count) noexcept
+{
+    ASSERT_LOG(srcType == Type::Uint8 || srcType == Type::Uint16 || srcType == Type::Uint32);
+    const auto* srcPtr = static_cast<const uint8_t*>(src);
+    switch (srcType)
+    {
+        case Type::Uint8:
+            indicesScalar<uint8_t>(srcPtr, srcStride, base, dst, count);
+            break;
+        case Type::Uint16:
+            indicesScalar<uint16_t>(srcPtr, srcStride, base, dst, count);
+            break;
+        case Type::Uint32:
+            indicesScalar<uint32_t>(srcPtr, srcStride, base, dst, count);
+            break;
+        default:
+            break;
+    }
+}
+
+template <size_t Size>
+void copyElements(
+    const uint8_t* src, size_t srcStride, uint8_t* dst, size_t dstStride, size_t count) noexcept
+{
+    // a fixed size copy is compiled down to a few register moves
+    for (size_t i = 0; i < count; ++i, src += srcStride, dst += dstStride)
+    {
+        memcpy(dst, src, Size);
+    }
+}
+
+#ifdef YAVE_SIMD
+
+using namespace simd;
+
+// Float to half with round to nearest even, matching floatToHalf(). Based on
+// the branchless SSE2 conversion described by F. Giesen.
+VecI floatToHalf4(VecF value) noexcept
+{
+    const VecI bits = asInt(value);
+    const VecI sign = andI(bits, splatI(static_cast<int32_t>(0x80000000)));
+    const VecI absBits = andI(bits, splatI(0x7fffffff));
+
+    // denormalised halfs - adding the magic value shifts the mantissa into
+    // place, with the rounding carried out by the float addition
+    const VecI subnormMagic = splatI(((127 - 15) + (23 - 10) + 1) << 23);
+    const VecI subnorm = subI(asInt(addF(asFloat(absBits), asFloat(subnormMagic))), subnormMagic);
+
+    // normalised halfs - rebias the exponent and round on the discarded bits
+    const VecI mantissaOdd = shiftRightArith<31>(shiftLeft<31 - 13>(absBits));
+    VecI normal = addI(absBits, splatI(0xfff - ((127 - 15) << 23)));
+    normal = shiftRight<13>(subI(normal, mantissaOdd));
+
+    const VecI isSubnorm = cmpGtI(splatI((127 - 14) << 23), absBits);
+    VecI result = selectI(isSubnorm, subnorm, normal);
+
+    // anything too large for a half (including infinity) becomes infinity, nan
+    // becomes a quiet nan
+    const VecI infOrNan = orI(splatI(0x7c00), andI(isNanF(asFloat(absBits)), splatI(0x200)));
+    const VecI isRegular = cmpGtI(splatI((127 + 16) << 23), absBits);
+    result = selectI(isRegular, result, infOrNan);
+
+    return orI(result, shiftRight<16>(sign));
+}
+
+// Half to float, matching halfToFloat(). The input lanes hold the half in the
+// lower 16 bits.
+VecF halfToFloat4(VecI value) noexcept
+{
+    const VecI expMantissa = andI(value, splatI(0x7fff));
+    const VecI sign = shiftLeft<16>(andI(value, splatI(0x8000)));
+
+    // shifting the exponent and mantissa into place and scaling by 2^112 rebiases
+    // the exponent - this also normalises denormal halfs
+    const VecF magic = asFloat(splatI((254 - 15) << 23));
+    const VecF scaled = mulF(asFloat(shiftLeft<13>(expMantissa)), magic);
+
+    const VecI isInfNan = cmpGtI(expMantissa, splatI(0x7bff));
+    const VecI infNanExp = andI(isInfNan, splatI(255 << 23));
+    return asFloat(orI(asInt(scaled), orI(sign, infNanExp)));
+}
+
+VecI floatToInt4(VecF value, const IntRange& range) noexcept
+{
+    // the clamp maps nans to the minimum
+    VecF scaled = minF(maxF(value, splatF(range.min)), splatF(range.max));
+    scaled = mulF(scaled, splatF(range.scale));
+    if (!range.isSigned)
+    {
+        return truncate(addF(scaled, splatF(0.5f)));
+    }
+    // round halfway values away from zero, as with std::round - the difference
+    // with the truncated value is exact for the ranges used here
+    VecI result = truncate(scaled);
+    const VecF diff = subF(scaled, toFloat(result));
+    result = subI(result, cmpGeF(diff, splatF(0.5f)));
+    return addI(result, cmpLeF(diff, splatF(-0.5f)));
+}
+
+template <VecI (*Load)(const void*), size_t Size>
+size_t intToFloatSimd(const void* src, bool normalised, float maxValue, float* dst, size_t count)
+{
+    const auto* srcPtr = static_cast<const uint8_t*>(src);
+    const VecF maxVec = splatF(maxValue);
+    const VecF minusOne = splatF(-1.0f);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        VecF value = toFloat(Load(srcPtr + i * Size));
+        if (normalised)
+        {
+            value = maxF(divF(value, maxVec), minusOne);
+        }
+        storeF(dst + i, value);
+    }
+    return i;
+}
+
+// The vectorised kernels process blocks of four and return the number of
+// values converted - the remainder is handled by the scalar functions.
+size_t toFloatSimd(const void* src, Type type, bool normalised, float* dst, size_t count) noexcept
+{
+    switch (type)
+    {
+        case Type::Int8:
+            return intToFloatSimd<loadI8, 1>(src, normalised, 127.0f, dst, count);
+        case Type::Uint8:
+            return intToFloatSimd<loadU8, 1>(src, normalised, 255.0f, dst, count);
+        case Type::Int16:
+            return intToFloatSimd<loadI16, 2>(src, normalised, 32767.0f, dst, count);
+        case Type::Uint16:
+            return intToFloatSimd<loadU16, 2>(src, normalised, 65535.0f, dst, count);
+        case Type::Half: {
+            const auto* srcPtr = static_cast<const uint16_t*>(src);
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                storeF(dst + i, halfToFloat4(loadU16(srcPtr + i)));
+            }
+            return i;
+        }
+        default:
+            // 32-bit unsigned integers don't fit into the signed lanes
+            return 0;
+    }
+}
+
+size_t fromFloatSimd(const float* src, Type type, bool normalised, void* dst, size_t count) noexcept
+{
+    auto* dstPtr = static_cast<uint8_t*>(dst);
+    size_t i = 0;
+    switch (type)
+    {
+        case Type::Half:
+            for (; i + 4 <= count; i += 4)
+            {
+                storeLow16(dstPtr + i * sizeof(uint16_t), floatToHalf4(loadF(src + i)));
+            }
+            break;
+        case Type::Int16:
+        case Type::Uint16: {
+            const IntRange range = getIntRange(type, normalised);
+            for (; i + 4 <= count; i += 4)
+            {
+                storeLow16(dstPtr + i * sizeof(uint16_t), floatToInt4(loadF(src + i), range));
+            }
+            break;
+        }
+        case Type::Int8:
+        case Type::Uint8: {
+            const IntRange range = getIntRange(type, normalised);
+            for (; i + 4 <= count; i += 4)
+            {
+                storeLow8(dstPtr + i, floatToInt4(loadF(src + i), range));
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    return i;
+}
+
+template <typename DstType>
+void storeIndices(DstType* dst, VecI indices) noexcept
+{
+    if constexpr (sizeof(DstType) == sizeof(uint32_t))
+    {
+        storeI(dst, indices);
+    }
+    else
+    {
+        storeLow16(dst, indices);
+    }
+}
+
+template <typename DstType>
+size_t indicesSimd(
+    const void* src, size_t srcStride, Type srcType, uint32_t base, DstType* dst, size_t count)
+{
+    // only tightly packed indices are vectorised
+    if (srcStride != getTypeSize(srcType))
+    {
+        return 0;
+    }
+    const auto* srcPtr = static_cast<const uint8_t*>(src);
+    const VecI baseVec = splatI(static_cast<int32_t>(base));
+    size_t i = 0;
+    switch (srcType)
+    {
+        case Type::Uint8:
+            for (; i + 4 <= count; i += 4)
+            {
+                storeIndices(dst + i, addI(loadU8(srcPtr + i), baseVec));
+            }
+            break;
+        case Type::Uint16:
+            for (; i + 4 <= count; i += 4)
+            {
+                storeIndices(dst + i, addI(loadU16(srcPtr + i * sizeof(uint16_t)), baseVec));
+            }
+            break;
+        case Type::Uint32:
+            for (; i + 4 <= count; i += 4)
+            {
+                storeIndices(dst + i, addI(loadI(srcPtr + i * sizeof(uint32_t)), baseVec));
+            }
+            break;
+        default:
+            break;
+    }
+    return i;
+}
+
+size_t expandRgbSimd(const uint8_t* src, uint8_t* dst, size_t pixelCount, uint8_t alpha) noexcept
+{
+    size_t i = 0;
+#ifdef YAVE_SIMD_SSE2
+    // each pixel is shifted along by its index within the block of four - a 16
+    // byte load reads four pixels, so six pixels must remain to stay in bounds
+    const __m128i mask = _mm_setr_epi32(0x00ffffff, 0, 0, 0);
+    const __m128i alphaMask = _mm_set1_epi32(static_cast<int32_t>(uint32_t(alpha) << 24));
+    for (; i + 6 <= pixelCount; i += 4)
+    {
+        const __m128i rgb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+        __m128i rgba = _mm_and_si128(rgb, mask);
+        rgba = _mm_or_si128(rgba, _mm_and_si128(_mm_slli_si128(rgb, 1), _mm_slli_si128(mask, 4)));
+        rgba = _mm_or_si128(rgba, _mm_and_si128(_mm_slli_si128(rgb, 2), _mm_slli_si128(mask, 8)));
+        rgba = _mm_or_si128(rgba, _mm_and_si128(_mm_slli_si128(rgb, 3), _mm_slli_si128(mask, 12)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_or_si128(rgba, alphaMask));
+    }
+#else
+    const uint8x16_t alphaVec = vdupq_n_u8(alpha);
+    for (; i + 16 <= pixelCount; i += 16)
+    {
+        const uint8x16x3_t rgb = vld3q_u8(src + i * 3);
+        const uint8x16x4_t rgba = {{rgb.val[0], rgb.val[1], rgb.val[2], alphaVec}};
+        vst4q_u8(dst + i * 4, rgba);
+    }
+#endif
+    return i;
+}
+
+#endif
+
+void convertFlat(
+    const void* src, Type srcType, void* dst, Type dstType, bool normalised, size_t count)
+{
+    if (srcType == dstType)
+    {
+        memcpy(dst, src, count * getTypeSize(srcType));
+    }
+    else if (dstType == Type::Float)
+    {
+        convertToFloat(src, srcType, normalised, static_cast<float*>(dst), count);
+    }
+    else
+    {
+        convertFromFloat(static_cast<const float*>(src), dstType, normalised, dst, count);
+    }
+}
+
+} // namespace
+
+size_t getTypeSize(Type type) noexcept
+{
+    switch (type)
+    {
+        case Type::Int8:
+        case Type::Uint8:
+            return 1;
+        case Type::Int16:
+        case Type::Uint16:
+        case Type::Half:
+            return 2;
+        case Type::Uint32:
+        case Type::Float:
+            return 4;
+    }
+    return 0;
+}
+
+uint16_t floatToHalf(float value) noexcept
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(float));
+
+    const uint32_t sign = (bits >> 16) & 0x8000;
+    const uint32_t absBits = bits & 0x7fffffff;
+
+    // nan - keep a quiet nan
+    if (absBits > 0x7f800000)
+    {
+        return static_cast<uint16_t>(sign | 0x7e00);
+    }
+    // overflow to infinity - values rounding above the max half (65504)
+    if (absBits >= 0x477ff000)
+    {
+        return static_cast<uint16_t>(sign | 0x7c00);
+    }
+    // normalised half
+    if (absBits >= 0x38800000)
+    {
+        uint32_t mantissa = absBits - 0x38000000;
+        // round to nearest even on the 13 discarded bits
+        mantissa += 0x0fff + ((mantissa >> 13) & 1);
+        return static_cast<uint16_t>(sign | (mantissa >> 13));
+    }
+    // denormalised half or zero
+    if (absBits < 0x33000000)
+    {
+        return static_cast<uint16_t>(sign);
+    }
+    const uint32_t exponent = absBits >> 23;
+    const uint32_t mantissa = (absBits & 0x7fffff) | 0x800000;
+    const uint32_t shift = 126 - exponent;
+    uint32_t result = mantissa >> shift;
+    const uint32_t remainder = mantissa & ((1u << shift) - 1);
+    const uint32_t halfway = 1u << (shift - 1);
+    if (remainder > halfway || (remainder == halfway && (result & 1)))
+    {
+        ++result;
+    }
+    return static_cast<uint16_t>(sign | result);
+}
+
+float halfToFloat(uint16_t value) noexcept
+{
+    const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+    const uint32_t exponent = (value >> 10) & 0x1f;
+    uint32_t mantissa = value & 0x3ff;
+
+    uint32_t bits;
+    if (exponent == 0x1f)
+    {
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    }
+    else if (exponent)
+    {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    else if (mantissa)
+    {
+        // denormal - normalise the mantissa
+        uint32_t e = 113;
+        while (!(mantissa & 0x400))
+        {
+            mantissa <<= 1;
+            --e;
+        }
+        bits = sign | (e << 23) | ((mantissa & 0x3ff) << 13);
+    }
+    else
+    {
+        bits = sign;
+    }
+
+    float result;
+    memcpy(&result, &bits, sizeof(float));
+    return result;
+}
+
+void convertToFloat(const void* src, Type type, bool normalised, float* dst, size_t count) noexcept
+{
+    size_t done = 0;
+#ifdef YAVE_SIMD
+    done = toFloatSimd(src, type, normalised, dst, count);
+#endif
+    scalar::convertToFloat(
+        static_cast<const uint8_t*>(src) + done * getTypeSize(type),
+        type,
+        normalised,
+        dst + done,
+        count - done);
+}
+
+void convertFromFloat(
+    const float* src, Type type, bool normalised, void* dst, size_t count) noexcept
+{
+    size_t done = 0;
+#ifdef YAVE_SIMD
+    done = fromFloatSimd(src, type, normalised, dst, count);
+#endif
+    scalar::convertFromFloat(
+        src + done,
+        type,
+        normalised,
+        static_cast<uint8_t*>(dst) + done * getTypeSize(type),
+        count - done);
+}
+
+void convertStrided(
+    const void* src,
+    size_t srcStride,
+    Type srcType,
+    void* dst,
+    size_t dstStride,
+    Type dstType,
+    bool normalised,
+    size_t componentCount,
+    size_t count) noexcept
+{
+    ASSERT_LOG(srcType == dstType || srcType == Type::Float || dstType == Type::Float);
+    ASSERT_LOG(componentCount > 0 && componentCount * sizeof(float) <= BlockSize);
+
+    const size_t srcSize = componentCount * getTypeSize(srcType);
+    const size_t dstSize = componentCount * getTypeSize(dstType);
+    if (srcType == dstType)
+    {
+        copyStrided(src, srcStride, dst, dstStride, srcSize, count);
+        return;
+    }
+
+    // strided elements are gathered into a packed block, converted and then
+    // scattered to the destination
+    alignas(16) uint8_t srcBlock[BlockSize];
+    alignas(16) uint8_t dstBlock[BlockSize];
+    const size_t blockCount = BlockSize / (componentCount * sizeof(float));
+
+    const auto* srcPtr = static_cast<const uint8_t*>(src);
+    auto* dstPtr = static_cast<uint8_t*>(dst);
+    for (size_t first = 0; first < count;)
+    {
+        // packed streams are converted in a single pass
+        const bool isPacked = srcStride == srcSize && dstStride == dstSize;
+        const size_t blockSize = isPacked ? count - first : std::min(blockCount, count - first);
+
+        const void* in = srcPtr;
+        if (srcStride != srcSize)
+        {
+            copyStrided(srcPtr, srcStride, srcBlock, srcSize, srcSize, blockSize);
+            in = srcBlock;
+        }
+        void* out = dstStride == dstSize ? dstPtr : dstBlock;
+
+        convertFlat(in, srcType, out, dstType, normalised, blockSize * componentCount);
+
+        if (out == dstBlock)
+        {
+            copyStrided(dstBlock, dstSize, dstPtr, dstStride, dstSize, blockSize);
+        }
+        first += blockSize;
+        srcPtr += blockSize * srcStride;
+        dstPtr += blockSize * dstStride;
+    }
+}
+
+void copyStrided(
+    const void* src,
+    size_t srcStride,
+    void* dst,
+    size_t dstStride,
+    size_t elementSize,
+    size_t count) noexcept
+{
+    const auto* srcPtr = static_cast<const uint8_t*>(src);
+    auto* dstPtr = static_cast<uint8_t*>(dst);
+    if (srcStride == elementSize && dstStride == elementSize)
+    {
+        memcpy(dstPtr, srcPtr, elementSize * count);
+        return;
+    }
+
+    switch (elementSize)
+    {
+        case 2:
+            copyElements<2>(srcPtr, srcStride, dstPtr, dstStride, count);
+            break;
+        case 4:
+            copyElements<4>(srcPtr, srcStride, dstPtr, dstStride, count);
+            break;
+        case 8:
+            copyElements<8>(srcPtr, srcStride, dstPtr, dstStride, count);
+            break;
+        case 12:
+            copyElements<12>(srcPtr, srcStride, dstPtr, dstStride, count);
+            break;
+        case 16:
+            copyElements<16>(srcPtr, srcStride, dstPtr, dstStride, count);
+            break;
+        default:
+            for (size_t i = 0; i < count; ++i, srcPtr += srcStride, dstPtr += dstStride)
+            {
+                memcpy(dstPtr, srcPtr, elementSize);
+            }
+            break;
+    }
+}
+
+void convertIndices(
+    const void* src,
+    size_t srcStride,
+    Type srcType,
+    uint32_t base,
+    uint32_t* dst,
+    size_t count) noexcept
+{
+    size_t done = 0;
+#ifdef YAVE_SIMD
+    done = indicesSimd(src, srcStride, srcType, base, dst, count);
+#endif
+    scalar::convertIndices(
+        static_cast<const uint8_t*>(src) + done * srcStride,
+        srcStride,
+        srcType,
+        base,
+        dst + done,
+        count - done);
+}
+
+void convertIndices(
+    const void* src,
+    size_t srcStride,
+    Type srcType,
+    uint32_t base,
+    uint16_t* dst,
+    size_t count) noexcept
+{
+    size_t done = 0;
+#ifdef YAVE_SIMD
+    done = indicesSimd(src, srcStride, srcType, base, dst, count);
+#endif
+    scalar::convertIndices(
+        static_cast<const uint8_t*>(src) + done * srcStride,
+        srcStride,
+        srcType,
+        base,
+        dst + done,
+        count - done);
+}
+
+void interleave(
+    const ConstAttribute* attributes,
+    size_t attributeCount,
+    void* dst,
+    size_t dstStride,
+    size_t count) noexcept
+{
+    auto* dstPtr = static_cast<uint8_t*>(dst);
+    for (size_t first = 0; first < count; first += InterleaveBlockCount)
+    {
+        const size_t blockCount = std::min(InterleaveBlockCount, count - first);
+        for (size_t i = 0; i < attributeCount; ++i)
+        {
+            const ConstAttribute& attr = attributes[i];
+            ASSERT_LOG(attr.offset + attr.size <= dstStride);
+            copyStrided(
+                static_cast<const uint8_t*>(attr.data) + first * attr.stride,
+                attr.stride,
+                dstPtr + first * dstStride + attr.offset,
+                dstStride,
+                attr.size,
+                blockCount);
+        }
+    }
+}
+
+void deinterleave(
+    const void* src,
+    size_t srcStride,
+    const Attribute* attributes,
+    size_t attributeCount,
+    size_t count) noexcept
+{
+    const auto* srcPtr = static_cast<const uint8_t*>(src);
+    for (size_t first = 0; first < count; first += InterleaveBlockCount)
+    {
+        const size_t blockCount = std::min(InterleaveBlockCount, count - first);
+        for (size_t i = 0; i < attributeCount; ++i)
+        {
+            const Attribute& attr = attributes[i];
+            ASSERT_LOG(attr.offset + attr.size <= srcStride);
+            copyStrided(
+                srcPtr + first * srcStride + attr.offset,
+                srcStride,
+                static_cast<uint8_t*>(attr.data) + first * attr.stride,
+                attr.stride,
+                attr.size,
+                blockCount);
+        }
+    }
+}
+
+void expandRgbToRgba(const uint8_t* src, uint8_t* dst, size_t pixelCount, uint8_t alpha) noexcept
+{
+    size_t done = 0;
+#ifdef YAVE_SIMD
+    done = expandRgbSimd(src, dst, pixelCount, alpha);
+#endif
+    scalar::expandRgbToRgba(src + done * 3, dst + done * 4, pixelCount - done, alpha);
+}
+
+const char* getInstructionSet() noexcept { return simd::getInstructionSet(); }
+
+namespace scalar
+{
+
+void convertToFloat(const void* src, Type type, bool normalised, float* dst, size_t count) noexcept
+{
+    switch (type)
+    {
+        case Type::Int8:
+            toFloatScalar(static_cast<const int8_t*>(src), normalised, dst, count);
+            break;
+        case Type::Uint8:
+            toFloatScalar(static_cast<const uint8_t*>(src), normalised, dst, count);
+            break;
+        case Type::Int16:
+            toFloatScalar(static_cast<const int16_t*>(src), normalised, dst, count);
+            break;
+        case Type::Uint16:
+            toFloatScalar(static_cast<const uint16_t*>(src), normalised, dst, count);
+            break;
+        case Type::Uint32:
+            toFloatScalar(static_cast<const uint32_t*>(src), normalised, dst, count);
+            break;
+        case Type::Half: {
+            const auto* srcPtr = static_cast<const uint16_t*>(src);
+            for (size_t i = 0; i < count; ++i)
+            {
+                dst[i] = halfToFloat(srcPtr[i]);
+            }
+            break;
+        }
+        case Type::Float:
+            memcpy(dst, src, count * sizeof(float));
+            break;
+    }
+}
+
+void convertFromFloat(
+    const float* src, Type type, bool normalised, void* dst, size_t count) noexcept
+{
+    const IntRange range = getIntRange(type, normalised);
+    switch (type)
+    {
+        case Type::Int8:
+            fromFloatScalar(src, range, static_cast<int8_t*>(dst), count);
+            break;
+        case Type::Uint8:
+            fromFloatScalar(src, range, static_cast<uint8_t*>(dst), count);
+            break;
+        case Type::Int16:
+            fromFloatScalar(src, range, static_cast<int16_t*>(dst), count);
+            break;
+        case Type::Uint16:
+            fromFloatScalar(src, range, static_cast<uint16_t*>(dst), count);
+            break;
+        case Type::Uint32: {
+            // no normalised form, the value is clamped to the range of the type
+            auto* dstPtr = static_cast<uint32_t*>(dst);
+            for (size_t i = 0; i < count; ++i)
+            {
+                double value = src[i] > 0.0f ? src[i] : 0.0;
+                value = std::min(value, 4294967295.0);
+                dstPtr[i] = static_cast<uint32_t>(value + 0.5);
+            }
+            break;
+        }
+        case Type::Half: {
+            auto* dstPtr = static_cast<uint16_t*>(dst);
+            for (size_t i = 0; i < count; ++i)
+            {
+                dstPtr[i] = floatToHalf(src[i]);
+            }
+            break;
+        }
+        case Type::Float:
+            memcpy(dst, src, count * sizeof(float));
+            break;
+    }
+}
+
+void convertIndices(
+    const void* src,
+    size_t srcStride,
+    Type srcType,
+    uint32_t base,
+    uint32_t* dst,
+    size_t count) noexcept
+{
+    convertIndicesScalar(src, srcStride, srcType, base, dst, count);
+}
+
+void convertIndices(
+    const void* src,
+    size_t srcStride,
+    Type srcType,
+    uint32_t base,
+    uint16_t* dst,
+    size_t count) noexcept
+{
+    convertIndicesScalar(src, srcStride, srcType, base, dst, count);
+}
+
+void expandRgbToRgba(const uint8_t* src, uint8_t* dst, size_t pixelCount, uint8_t alpha) noexcept
+{
+    for (size_t i = 0; i < pixelCount; ++i, src += 3, dst += 4)
+    {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+        dst[3] = alpha;
+    }
+}
+
+} // namespace scalar
+
+} // namespace stream
+} // namespace util
@@ -0,0 +1,204 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace util
+{
+namespace stream
+{
+
+/**
+ * @brief Kernels for converting, interleaving and deinterleaving streams of
+ * vertex attributes and indices. Where SSE2 (x86-64) or NEON (AArch64) are
+ * available the conversions are vectorised, otherwise a scalar fallback is used.
+ * Both paths produce bit-identical results - the scalar versions are exposed in
+ * the `scalar` namespace for testing and benchmarking.
+ *
+ * Streams are described by a pointer and a stride in bytes. The strided
+ * functions process the data in small blocks so that the vectorised conversion
+ * runs over tightly packed memory which stays in the cache.
+ */
+
+enum class Type : uint8_t
+{
+    Int8,
+    Uint8,
+    Int16,
+    Uint16,
+    Uint32,
+    Half,
+    Float
+};
+
+size_t getTypeSize(Type type) noexcept;
+
+// IEEE 754 half-precision, rounding to nearest even.
+uint16_t floatToHalf(float value) noexcept;
+float halfToFloat(uint16_t value) noexcept;
+
+/**
+ * @brief Converts tightly packed components to float.
+ * @param normalised If true, integer types are mapped to [0, 1] (unsigned) or
+ * [-1, 1] (signed) as per the Vulkan/glTF rules. Otherwise the integer value is
+ * converted as is. Has no effect on half or float sources.
+ */
+void convertToFloat(const void* src, Type type, bool normalised, float* dst, size_t count) noexcept;
+
+/**
+ * @brief Converts tightly packed floats to the specified type. Normalised
+ * integers are clamped to [0, 1] or [-1, 1] before scaling, non-normalised
+ * integers are clamped to the range of the type. Unsigned types are rounded by
+ * adding 0.5 and truncating, signed types round halfway values away from zero.
+ */
+void convertFromFloat(
+    const float* src, Type type, bool normalised, void* dst, size_t count) noexcept;
+
+/**
+ * @brief Converts between strided streams of elements, each made up of
+ * componentCount components. Either the source or the destination must be
+ * float; if both types are the same, the elements are copied.
+ */
+void convertStrided(
+    const void* src,
+    size_t srcStride,
+    Type srcType,
+    void* dst,
+    size_t dstStride,
+    Type dstType,
+    bool normalised,
+    size_t componentCount,
+    size_t count) noexcept;
+
+/**
+ * @brief Copies elements between strided streams - i.e. a gather if the
+ * destination is tightly packed or a scatter if the source is.
+ */
+void copyStrided(
+    const void* src,
+    size_t srcStride,
+    void* dst,
+    size_t dstStride,
+    size_t elementSize,
+    size_t count) noexcept;
+
+/**
+ * @brief Converts indices to 32 or 16-bit, adding base to each. When narrowing,
+ * the caller must ensure the offset indices fit into 16 bits.
+ * @param srcType Either Uint8, Uint16 or Uint32.
+ */
+void convertIndices(
+    const void* src,
+    size_t srcStride,
+    Type srcType,
+    uint32_t base,
+    uint32_t* dst,
+    size_t count) noexcept;
+void convertIndices(
+    const void* src,
+    size_t srcStride,
+    Type srcType,
+    uint32_t base,
+    uint16_t* dst,
+    size_t count) noexcept;
+
+// A single attribute of an interleaved stream.
+struct ConstAttribute
+{
+    const void* data;
+    // the stride of the attribute data in bytes
+    size_t stride;
+    // the offset of the attribute within the interleaved element
+    size_t offset;
+    size_t size;
+};
+
+struct Attribute
+{
+    void* data;
+    size_t stride;
+    size_t offset;
+    size_t size;
+};
+
+/**
+ * @brief Interleaves the attribute streams into dst - the attribute offsets and
+ * sizes must lie within dstStride. Gaps between attributes are left untouched.
+ */
+void interleave(
+    const ConstAttribute* attributes,
+    size_t attributeCount,
+    void* dst,
+    size_t dstStride,
+    size_t count) noexcept;
+
+// The reverse of the above - splits an interleaved stream into its attributes.
+void deinterleave(
+    const void* src,
+    size_t srcStride,
+    const Attribute* attributes,
+    size_t attributeCount,
+    size_t count) noexcept;
+
+/**
+ * @brief Expands packed 8-bit RGB pixels to RGBA, setting the alpha of each
+ * pixel. Used for images which aren't stored with an alpha channel, as three
+ * component formats are rarely supported for sampling.
+ */
+void expandRgbToRgba(const uint8_t* src, uint8_t* dst, size_t pixelCount, uint8_t alpha) noexcept;
+
+// The name of the instruction set used by the vectorised kernels.
+const char* getInstructionSet() noexcept;
+
+namespace scalar
+{
+
+void convertToFloat(const void* src, Type type, bool normalised, float* dst, size_t count) noexcept;
+
+void convertFromFloat(
+    const float* src, Type type, bool normalised, void* dst, size_t count) noexcept;
+
+void convertIndices(
+    const void* src,
+    size_t srcStride,
+    Type srcType,
+    uint32_t base,
+    uint32_t* dst,
+    size_t count) noexcept;
+void convertIndices(
+    const void* src,
+    size_t srcStride,
+    Type srcType,
+    uint32_t base,
+    uint16_t* dst,
+    size_t count) noexcept;
+
+void expandRgbToRgba(const uint8_t* src, uint8_t* dst, size_t pixelCount, uint8_t alpha) noexcept;
+
+} // namespace scalar
+
+} // namespace stream
+} // namespace util
@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+#include <utility/mapped_file.h>
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+TEST(MappedFileTests, MapFile)
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "mapped_file_test.bin";
+    const char contents[] = "Some data to map into memory";
+
+    FILE* fp = fopen(path.string().c_str(), "wb");
+    ASSERT_TRUE(fp);
+    fwrite(contents, 1, sizeof(contents), fp);
+    fclose(fp);
+
+    util::MappedFile file;
+    ASSERT_TRUE(file.open(path.string().c_str()));
+    ASSERT_TRUE(file.isOpen());
+    ASSERT_EQ(file.size(), sizeof(contents));
+    ASSERT_EQ(memcmp(file.data(), contents, sizeof(contents)), 0);
+
+    // ownership of the mapping is transferred on move
+    util::MappedFile movedFile = std::move(file);
+    ASSERT_FALSE(file.isOpen());
+    ASSERT_TRUE(movedFile.isOpen());
+
+    movedFile.close();
+    ASSERT_FALSE(movedFile.isOpen());
+
+    std::filesystem::remove(path);
+}
+
+TEST(MappedFileTests, MissingFile)
+{
+    util::MappedFile file;
+    ASSERT_FALSE(file.open("this_file_does_not_exist.bin"));
+    ASSERT_FALSE(file.isOpen());
+}
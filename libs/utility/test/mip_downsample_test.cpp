@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+#include <utility/mip_downsample.h>
+
+#include <vector>
+
+using namespace util::mip;
+
+namespace
+{
+
+std::vector<float> createImage(uint32_t width, uint32_t height, const float* texel)
+{
+    std::vector<float> image(width * height * 4);
+    for (size_t i = 0; i < width * height; ++i)
+    {
+        std::copy(texel, texel + 4, image.data() + i * 4);
+    }
+    return image;
+}
+
+} // namespace
+
+TEST(MipDownsampleTests, LevelSizes)
+{
+    EXPECT_EQ(getLevelCount(1, 1), 1u);
+    EXPECT_EQ(getLevelCount(256, 256), 9u);
+    EXPECT_EQ(getLevelCount(13, 5), 4u);
+    EXPECT_EQ(getLevelCount(4, 1024), 11u);
+
+    EXPECT_EQ(getLevelSize(13, 1), 6u);
+    EXPECT_EQ(getLevelSize(13, 2), 3u);
+    EXPECT_EQ(getLevelSize(13, 3), 1u);
+    EXPECT_EQ(getLevelSize(5, 3), 1u);
+}
+
+TEST(MipDownsampleTests, BoxFilter)
+{
+    // a 4x2 image, the red channel holding the texel index
+    std::vector<float> src(4 * 2 * 4, 1.0f);
+    for (int i = 0; i < 8; ++i)
+    {
+        src[i * 4] = static_cast<float>(i);
+    }
+    std::vector<float> dst(2 * 1 * 4);
+    downsample(src.data(), 4, 2, dst.data(), Filter::Box, true, false);
+    EXPECT_FLOAT_EQ(dst[0], (0.0f + 1.0f + 4.0f + 5.0f) * 0.25f);
+    EXPECT_FLOAT_EQ(dst[4], (2.0f + 3.0f + 6.0f + 7.0f) * 0.25f);
+    EXPECT_FLOAT_EQ(dst[3], 1.0f);
+}
+
+TEST(MipDownsampleTests, OddAndUnitDimensions)
+{
+    // with an odd width, the last column is dropped
+    std::vector<float> src = {1.0f, 0, 0, 1.0f, 3.0f, 0, 0, 1.0f, 100.0f, 0, 0, 1.0f};
+    std::vector<float> dst(4);
+    downsample(src.data(), 3, 1, dst.data(), Filter::Box, true, false);
+    EXPECT_FLOAT_EQ(dst[0], 2.0f);
+
+    // a single column is clamped rather than read out of bounds
+    std::vector<float> column = {
+        1.0f, 0, 0, 1.0f, 3.0f, 0, 0, 1.0f, 5.0f, 0, 0, 1.0f, 7.0f, 0, 0, 1.0f};
+    std::vector<float> result(2 * 4);
+    downsample(column.data(), 1, 4, result.data(), Filter::Box, true, false);
+    EXPECT_FLOAT_EQ(result[0], 2.0f);
+    EXPECT_FLOAT_EQ(result[4], 6.0f);
+}
+
+TEST(MipDownsampleTests, MinMaxFilter)
+{
+    std::vector<float> src = {
+        0.5f, 0.1f, 0, 0, 0.2f, 0.9f, 0, 0, 0.7f, 0.3f, 0, 0, 0.4f, 0.6f, 0, 0};
+    std::vector<float> dst(4);
+    downsample(src.data(), 2, 2, dst.data(), Filter::Min, true, false);
+    EXPECT_FLOAT_EQ(dst[0], 0.2f);
+    EXPECT_FLOAT_EQ(dst[1], 0.1f);
+    downsample(src.data(), 2, 2, dst.data(), Filter::Max, true, false);
+    EXPECT_FLOAT_EQ(dst[0], 0.7f);
+    EXPECT_FLOAT_EQ(dst[1], 0.9f);
+}
+
+TEST(MipDownsampleTests, KaiserFilter)
+{
+    float sum = 2.0f * (KaiserWeights[0] + KaiserWeights[1] + KaiserWeights[2]);
+    EXPECT_NEAR(sum, 1.0f, 1e-6f);
+
+    // a constant image is unchanged, including at the clamped edges
+    const float texel[4] = {0.25f, 0.5f, 0.75f, 1.0f};
+    std::vector<float> src = createImage(7, 5, texel);
+    std::vector<float> dst(3 * 2 * 4);
+    downsample(src.data(), 7, 5, dst.data(), Filter::Kaiser, true, false);
+    for (size_t i = 0; i < dst.size(); ++i)
+    {
+        EXPECT_NEAR(dst[i], texel[i % 4], 1e-5f);
+    }
+
+    // a single bright texel is spread over the neighbouring texels, with the
+    // negative lobes darkening those further away
+    std::vector<float> spike(8 * 8 * 4, 0.0f);
+    spike[(3 * 8 + 3) * 4] = 1.0f;
+    std::vector<float> result(4 * 4 * 4);
+    downsample(spike.data(), 8, 8, result.data(), Filter::Kaiser, true, false);
+    EXPECT_NEAR(result[(1 * 4 + 1) * 4], KaiserWeights[0] * KaiserWeights[0], 1e-6f);
+    EXPECT_NEAR(result[(1 * 4 + 2) * 4], KaiserWeights[0] * KaiserWeights[1], 1e-6f);
+    EXPECT_LT(result[(1 * 4 + 0) * 4], 0.0f);
+
+    // only the first level uses the kaiser filter
+    downsample(spike.data(), 8, 8, result.data(), Filter::Kaiser, false, false);
+    EXPECT_FLOAT_EQ(result[(1 * 4 + 1) * 4], 0.25f);
+    EXPECT_FLOAT_EQ(result[(1 * 4 + 2) * 4], 0.0f);
+}
+
+TEST(MipDownsampleTests, SrgbFilter)
+{
+    EXPECT_NEAR(linearToSrgb(srgbToLinear(0.3f)), 0.3f, 1e-6f);
+    EXPECT_FLOAT_EQ(linearToSrgb(-1.0f), 0.0f);
+
+    // black and white average to mid-grey in linear space, alpha isn't converted
+    std::vector<float> src = {0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f};
+    std::vector<float> dst(4);
+    downsample(src.data(), 2, 1, dst.data(), Filter::Box, true, true);
+    EXPECT_NEAR(dst[0], linearToSrgb(0.5f), 1e-6f);
+    EXPECT_NEAR(dst[0], 0.7354f, 1e-4f);
+    EXPECT_FLOAT_EQ(dst[3], 0.5f);
+
+    downsample(src.data(), 2, 1, dst.data(), Filter::Box, true, false);
+    EXPECT_FLOAT_EQ(dst[0], 0.5f);
+}
+
+TEST(MipDownsampleTests, GenerateNonSquareChain)
+{
+    const uint32_t width = 24;
+    const uint32_t height = 5;
+    const uint32_t levelCount = getLevelCount(width, height);
+    ASSERT_EQ(levelCount, 5u);
+
+    // a horizontal gradient which is preserved by the box filter for even widths
+    std::vector<std::vector<float>> images(levelCount);
+    std::vector<float*> levels(levelCount);
+    for (uint32_t level = 0; level < levelCount; ++level)
+    {
+        images[level].resize(getLevelSize(width, level) * getLevelSize(height, level) * 4);
+        levels[level] = images[level].data();
+    }
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            float* texel = levels[0] + (y * width + x) * 4;
+            texel[0] = static_cast<float>(x);
+            texel[1] = static_cast<float>(y);
+            texel[2] = 0.0f;
+            texel[3] = 1.0f;
+        }
+    }
+
+    generateMips(levels.data(), width, height, levelCount, Filter::Box, false);
+
+    // level 1 is 12x2, level 2 is 6x1, level 3 is 3x1 and level 4 1x1
+    EXPECT_FLOAT_EQ(levels[1][0], 0.5f);
+    EXPECT_FLOAT_EQ(levels[1][(1 * 12 + 11) * 4], 22.5f);
+    EXPECT_FLOAT_EQ(levels[1][(1 * 12 + 11) * 4 + 1], 2.5f);
+    EXPECT_FLOAT_EQ(levels[2][5 * 4], 21.5f);
+    EXPECT_FLOAT_EQ(levels[2][1], 1.5f);
+    EXPECT_FLOAT_EQ(levels[3][2 * 4], 19.5f);
+    // the odd column of level 3 is dropped
+    EXPECT_FLOAT_EQ(levels[4][0], 7.5f);
+    EXPECT_FLOAT_EQ(levels[4][3], 1.0f);
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include <utility/ocean_spectrum.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace util::ocean;
+
+namespace
+{
+
+std::vector<float> createNoise(uint32_t size)
+{
+    std::mt19937 gen {42};
+    std::normal_distribution<float> d {0, 1};
+    std::vector<float> noise(size * size * 4);
+    for (float& n : noise)
+    {
+        n = d(gen);
+    }
+    return noise;
+}
+
+} // namespace
+
+TEST(OceanSpectrumTests, InverseFftMatchesDft)
+{
+    const uint32_t size = 8;
+    std::mt19937 gen {1};
+    std::uniform_real_distribution<float> d {-1.0f, 1.0f};
+
+    std::vector<float> re(size * size);
+    std::vector<float> im(size * size);
+    for (size_t i = 0; i < re.size(); ++i)
+    {
+        re[i] = d(gen);
+        im[i] = d(gen);
+    }
+    std::vector<float> outRe = re;
+    std::vector<float> outIm = im;
+    inverseFft2d(outRe.data(), outIm.data(), size);
+
+    const double pi = 3.14159265358979;
+    for (uint32_t v = 0; v < size; ++v)
+    {
+        for (uint32_t u = 0; u < size; ++u)
+        {
+            double sumRe = 0.0;
+            double sumIm = 0.0;
+            for (uint32_t y = 0; y < size; ++y)
+            {
+                for (uint32_t x = 0; x < size; ++x)
+                {
+                    const double angle = 2.0 * pi * double(x * u + y * v) / double(size);
+                    const size_t idx = y * size + x;
+                    sumRe += re[idx] * std::cos(angle) - im[idx] * std::sin(angle);
+                    sumIm += re[idx] * std::sin(angle) + im[idx] * std::cos(angle);
+                }
+            }
+            EXPECT_NEAR(outRe[v * size + u], sumRe, 1e-4);
+            EXPECT_NEAR(outIm[v * size + u], sumIm, 1e-4);
+        }
+    }
+}
+
+TEST(OceanSpectrumTests, LowResolutionMirror)
+{
+    // when the band only holds modes common to both grids, the low resolution
+    // spectrum is the full spectrum sampled at a lower rate
+    const uint32_t fullSize = 64;
+    const uint32_t mirrorSize = 16;
+    auto noise = createNoise(fullSize);
+
+    SpectrumParams params;
+    params.patchSize = 100.0f;
+    params.windSpeed = 10.0f;
+    params.maxWaveNumber = 2.0f * 3.14159265f * 6.0f / params.patchSize;
+
+    const float scale = 1.0f / (fullSize * fullSize);
+    const float time = 3.7f;
+
+    WaveSpectrum full;
+    params.size = fullSize;
+    full.init(params, noise.data(), fullSize);
+    DisplacementGrid fullGrid;
+    full.evaluate(time, scale, 1.0f, fullGrid);
+
+    WaveSpectrum mirror;
+    params.size = mirrorSize;
+    mirror.init(params, noise.data(), fullSize);
+    DisplacementGrid mirrorGrid;
+    mirror.evaluate(time, scale, 1.0f, mirrorGrid);
+
+    float maxHeight = 0.0f;
+    const uint32_t step = fullSize / mirrorSize;
+    for (uint32_t y = 0; y < mirrorSize; ++y)
+    {
+        for (uint32_t x = 0; x < mirrorSize; ++x)
+        {
+            const size_t fullIdx = (y * fullSize + x) * step;
+            const size_t mirrorIdx = y * mirrorSize + x;
+            EXPECT_NEAR(mirrorGrid.height[mirrorIdx], fullGrid.height[fullIdx], 1e-5f);
+            EXPECT_NEAR(mirrorGrid.dispX[mirrorIdx], fullGrid.dispX[fullIdx], 1e-5f);
+            EXPECT_NEAR(mirrorGrid.dispZ[mirrorIdx], fullGrid.dispZ[fullIdx], 1e-5f);
+            maxHeight = std::max(maxHeight, std::abs(fullGrid.height[fullIdx]));
+        }
+    }
+    EXPECT_GT(maxHeight, 0.0f);
+
+    // the variance only depends on the modes, so is the same for both
+    params.size = fullSize;
+    const float fullVariance = heightVariance(params, scale);
+    params.size = mirrorSize;
+    EXPECT_NEAR(heightVariance(params, scale), fullVariance, fullVariance * 1e-4f);
+}
+
+TEST(OceanSpectrumTests, SampleWraps)
+{
+    DisplacementGrid grid;
+    grid.resize(4);
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        grid.height[i] = static_cast<float>(i);
+        grid.dispX[i] = 1.0f;
+        grid.dispZ[i] = -1.0f;
+    }
+
+    float out[3];
+    sample(grid, 1.0f, 2.0f, out);
+    EXPECT_FLOAT_EQ(out[0], 9.0f);
+    EXPECT_FLOAT_EQ(out[1], 1.0f);
+    EXPECT_FLOAT_EQ(out[2], -1.0f);
+
+    // halfway between the last and first column
+    sample(grid, 3.5f, 0.0f, out);
+    EXPECT_FLOAT_EQ(out[0], 1.5f);
+    sample(grid, -0.5f, 0.0f, out);
+    EXPECT_FLOAT_EQ(out[0], 1.5f);
+    sample(grid, 7.0f, -4.0f, out);
+    EXPECT_FLOAT_EQ(out[0], 3.0f);
+}
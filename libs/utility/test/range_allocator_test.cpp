@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include <utility/range_allocator.h>
+
+TEST(RangeAllocatorTests, Basic)
+{
+    util::RangeAllocator allocator(1024);
+    ASSERT_EQ(allocator.freeSize(), 1024);
+
+    uint64_t a = allocator.allocate(100);
+    uint64_t b = allocator.allocate(200);
+    ASSERT_EQ(a, 0);
+    ASSERT_EQ(b, 100);
+    ASSERT_EQ(allocator.usedSize(), 300);
+
+    // not enough space left
+    ASSERT_EQ(allocator.allocate(1000), util::RangeAllocator::InvalidOffset);
+
+    allocator.release(a, 100);
+    allocator.release(b, 200);
+    ASSERT_EQ(allocator.freeSize(), 1024);
+    ASSERT_EQ(allocator.freeBlockCount(), 1);
+    ASSERT_EQ(allocator.largestFreeBlock(), 1024);
+}
+
+TEST(RangeAllocatorTests, Alignment)
+{
+    util::RangeAllocator allocator(1024);
+
+    uint64_t a = allocator.allocate(10);
+    // non power-of-two alignment, i.e. a vertex stride
+    uint64_t b = allocator.allocate(60, 12);
+    ASSERT_EQ(a, 0);
+    ASSERT_EQ(b, 12);
+    ASSERT_EQ(allocator.usedSize(), 70);
+
+    // the padding is still available for small allocations
+    uint64_t c = allocator.allocate(2);
+    ASSERT_EQ(c, 10);
+}
+
+TEST(RangeAllocatorTests, CoalesceAndGrow)
+{
+    util::RangeAllocator allocator(300);
+
+    uint64_t a = allocator.allocate(100);
+    uint64_t b = allocator.allocate(100);
+    uint64_t c = allocator.allocate(100);
+    ASSERT_EQ(allocator.freeSize(), 0);
+
+    // releasing the outer blocks leaves two fragments
+    allocator.release(a, 100);
+    allocator.release(c, 100);
+    ASSERT_EQ(allocator.freeBlockCount(), 2);
+    ASSERT_EQ(allocator.allocate(150), util::RangeAllocator::InvalidOffset);
+
+    // releasing the middle block merges everything into a single block
+    allocator.release(b, 100);
+    ASSERT_EQ(allocator.freeBlockCount(), 1);
+    ASSERT_EQ(allocator.allocate(300), 0);
+
+    // growing appends free space at the end
+    allocator.grow(500);
+    ASSERT_EQ(allocator.allocate(200), 300);
+    ASSERT_EQ(allocator.freeSize(), 0);
+}
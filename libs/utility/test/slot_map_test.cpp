@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include <utility/slot_map.h>
+
+#include <string>
+#include <vector>
+
+TEST(SlotMapTests, Basic)
+{
+    util::SlotMap<std::string> slotMap;
+    ASSERT_TRUE(slotMap.empty());
+
+    auto h1 = slotMap.emplace("First");
+    auto h2 = slotMap.emplace("Second");
+    auto h3 = slotMap.emplace("Third");
+
+    ASSERT_TRUE(slotMap.size() == 3);
+    ASSERT_TRUE(slotMap.isValid(h1));
+    ASSERT_TRUE(slotMap.isValid(h2));
+    ASSERT_TRUE(slotMap.isValid(h3));
+
+    ASSERT_STREQ(slotMap.get(h1)->c_str(), "First");
+    ASSERT_STREQ(slotMap.get(h2)->c_str(), "Second");
+    ASSERT_STREQ(slotMap.get(h3)->c_str(), "Third");
+
+    // an uninitialised handle is never valid
+    util::Handle<std::string> invalidHandle;
+    ASSERT_FALSE(slotMap.isValid(invalidHandle));
+    ASSERT_TRUE(slotMap.get(invalidHandle) == nullptr);
+}
+
+TEST(SlotMapTests, StaleHandles)
+{
+    util::SlotMap<int> slotMap;
+
+    auto h1 = slotMap.emplace(10);
+    slotMap.erase(h1);
+
+    ASSERT_TRUE(slotMap.empty());
+    ASSERT_FALSE(slotMap.isValid(h1));
+
+    // the slot is recycled but the old handle should remain stale
+    auto h2 = slotMap.emplace(20);
+    ASSERT_EQ(util::SlotMap<int>::getIndex(h1), util::SlotMap<int>::getIndex(h2));
+    ASSERT_NE(util::SlotMap<int>::getGeneration(h1), util::SlotMap<int>::getGeneration(h2));
+    ASSERT_FALSE(slotMap.isValid(h1));
+    ASSERT_TRUE(slotMap.isValid(h2));
+    ASSERT_EQ(*slotMap.get(h2), 20);
+}
+
+TEST(SlotMapTests, StablePointersAndIteration)
+{
+    util::SlotMap<int, 4> slotMap;
+
+    std::vector<util::Handle<int>> handles;
+    auto first = slotMap.emplace(0);
+    int* firstPtr = slotMap.get(first);
+
+    // force the allocation of multiple chunks
+    for (int i = 1; i < 20; ++i)
+    {
+        handles.emplace_back(slotMap.emplace(i));
+    }
+    ASSERT_EQ(firstPtr, slotMap.get(first));
+
+    // remove all of the odd values
+    for (size_t i = 0; i < handles.size(); i += 2)
+    {
+        slotMap.erase(handles[i]);
+    }
+    ASSERT_TRUE(slotMap.size() == 10);
+
+    int count = 0;
+    int sum = 0;
+    slotMap.forEach([&](const util::Handle<int>& handle, int& value) {
+        ASSERT_TRUE(slotMap.isValid(handle));
+        ++count;
+        sum += value;
+    });
+    ASSERT_EQ(count, 10);
+    // only the even values remain
+    ASSERT_EQ(sum, 0 + 2 + 4 + 6 + 8 + 10 + 12 + 14 + 16 + 18);
+
+    slotMap.clear();
+    ASSERT_TRUE(slotMap.empty());
+    ASSERT_FALSE(slotMap.isValid(first));
+}
+
+TEST(SlotMapTests, ReuseErasedSlot)
+{
+    util::SlotMap<std::string> slotMap;
+
+    auto h1 = slotMap.emplace("First");
+    auto h2 = slotMap.emplace("Second");
+    auto h3 = slotMap.emplace("Third");
+
+    // erasing a slot in the middle and re-emplacing recycles that slot
+    slotMap.erase(h2);
+    auto h4 = slotMap.emplace("Fourth");
+    ASSERT_EQ(
+        util::SlotMap<std::string>::getIndex(h2), util::SlotMap<std::string>::getIndex(h4));
+    ASSERT_EQ(slotMap.size(), 3u);
+
+    // the handle to the previous occupant is rejected, the others are unaffected
+    ASSERT_FALSE(slotMap.isValid(h2));
+    ASSERT_TRUE(slotMap.isValid(h1));
+    ASSERT_TRUE(slotMap.isValid(h3));
+    ASSERT_TRUE(slotMap.isValid(h4));
+    ASSERT_STREQ(slotMap.get(h4)->c_str(), "Fourth");
+    ASSERT_STREQ(slotMap.get(h1)->c_str(), "First");
+    ASSERT_STREQ(slotMap.get(h3)->c_str(), "Third");
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include <utility/spherical_harmonics.h>
+
+#include <cmath>
+#include <functional>
+#include <vector>
+
+using namespace util::sh;
+
+namespace
+{
+
+// fills a cube map with the radiance returned for the normalised direction
+// through each texel
+std::vector<float>
+createCubeMap(uint32_t size, const std::function<float(float, float, float)>& radiance)
+{
+    std::vector<float> data(size * size * 4 * 6);
+    float* texel = data.data();
+    for (uint32_t face = 0; face < 6; ++face)
+    {
+        for (uint32_t y = 0; y < size; ++y)
+        {
+            for (uint32_t x = 0; x < size; ++x, texel += 4)
+            {
+                const float u = (x + 0.5f) * 2.0f / size - 1.0f;
+                const float v = (y + 0.5f) * 2.0f / size - 1.0f;
+                float dir[3];
+                getCubeDirection(face, u, v, dir);
+                const float len = std::sqrt(dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2]);
+                const float value = radiance(dir[0] / len, dir[1] / len, dir[2] / len);
+                texel[0] = value;
+                texel[1] = value * 0.5f;
+                texel[2] = value * 0.25f;
+                texel[3] = 1.0f;
+            }
+        }
+    }
+    return data;
+}
+
+} // namespace
+
+TEST(SphericalHarmonicsTests, CubeDirections)
+{
+    // the centre of each face points along its axis
+    const float expected[6][3] = {
+        {1.0f, 0, 0}, {-1.0f, 0, 0}, {0, 1.0f, 0}, {0, -1.0f, 0}, {0, 0, 1.0f}, {0, 0, -1.0f}};
+    for (uint32_t face = 0; face < 6; ++face)
+    {
+        float dir[3];
+        getCubeDirection(face, 0.0f, 0.0f, dir);
+        for (int i = 0; i < 3; ++i)
+        {
+            EXPECT_FLOAT_EQ(dir[i], expected[face][i]);
+        }
+    }
+
+    // the top left texel of +Z is towards -X and +Y
+    float dir[3];
+    getCubeDirection(4, -1.0f, -1.0f, dir);
+    EXPECT_FLOAT_EQ(dir[0], -1.0f);
+    EXPECT_FLOAT_EQ(dir[1], 1.0f);
+}
+
+TEST(SphericalHarmonicsTests, ConstantRadiance)
+{
+    auto data = createCubeMap(16, [](float, float, float) { return 2.0f; });
+    Coefficients coeffs = projectCubeMap(data.data(), 16);
+
+    // the irradiance over pi of a constant environment is the radiance
+    float rgb[3];
+    evaluate(coeffs, 0.0f, 0.0f, 1.0f, rgb);
+    EXPECT_NEAR(rgb[0], 2.0f, 1e-4f);
+    EXPECT_NEAR(rgb[1], 1.0f, 1e-4f);
+    EXPECT_NEAR(rgb[2], 0.5f, 1e-4f);
+    for (uint32_t i = 1; i < CoeffCount; ++i)
+    {
+        EXPECT_NEAR(coeffs.data[i][0], 0.0f, 1e-4f);
+    }
+}
+
+TEST(SphericalHarmonicsTests, LinearRadiance)
+{
+    // a radiance of 1 + z lies within the first two bands, so the irradiance
+    // over pi is exactly 1 + 2/3 z
+    auto data = createCubeMap(32, [](float, float, float z) { return 1.0f + z; });
+    Coefficients coeffs = projectCubeMap(data.data(), 32);
+
+    float rgb[3];
+    evaluate(coeffs, 0.0f, 0.0f, 1.0f, rgb);
+    EXPECT_NEAR(rgb[0], 5.0f / 3.0f, 1e-3f);
+    evaluate(coeffs, 0.0f, 0.0f, -1.0f, rgb);
+    EXPECT_NEAR(rgb[0], 1.0f / 3.0f, 1e-3f);
+    evaluate(coeffs, 1.0f, 0.0f, 0.0f, rgb);
+    EXPECT_NEAR(rgb[0], 1.0f, 1e-3f);
+}
+
+TEST(SphericalHarmonicsTests, MatchesScalarProjection)
+{
+    // an odd size so the rows have a scalar tail
+    const uint32_t size = 7;
+    auto data = createCubeMap(size, [](float x, float y, float z) {
+        return std::fmax(0.0f, x * 0.3f + y * y + z * 2.0f);
+    });
+
+    Projection proj;
+    for (uint32_t face = 0; face < 6; ++face)
+    {
+        const float* faceData = data.data() + face * size * size * 4;
+        // splitting the rows gives the same result as a single projection
+        projectRows(faceData, size, face, 0, 3, proj);
+        projectRows(faceData, size, face, 3, size, proj);
+    }
+
+    Projection expected;
+    const float* texel = data.data();
+    for (uint32_t face = 0; face < 6; ++face)
+    {
+        for (uint32_t y = 0; y < size; ++y)
+        {
+            for (uint32_t x = 0; x < size; ++x, texel += 4)
+            {
+                const float u = (x + 0.5f) * 2.0f / size - 1.0f;
+                const float v = (y + 0.5f) * 2.0f / size - 1.0f;
+                float dir[3];
+                getCubeDirection(face, u, v, dir);
+                const float t = 1.0f + u * u + v * v;
+                const float len = std::sqrt(t);
+                const float weight = 1.0f / (t * len);
+                float basis[CoeffCount];
+                evalBasis(dir[0] / len, dir[1] / len, dir[2] / len, basis);
+                for (uint32_t i = 0; i < CoeffCount; ++i)
+                {
+                    expected.r[i] += texel[0] * weight * basis[i];
+                    expected.g[i] += texel[1] * weight * basis[i];
+                }
+                expected.weight += weight;
+            }
+        }
+    }
+
+    EXPECT_NEAR(proj.weight, expected.weight, 1e-3f);
+    for (uint32_t i = 0; i < CoeffCount; ++i)
+    {
+        EXPECT_NEAR(proj.r[i], expected.r[i], 1e-3f);
+        EXPECT_NEAR(proj.g[i], expected.g[i], 1e-3f);
+    }
+}
@@ -0,0 +1,301 @@
+#include <gtest/gtest.h>
+#include <utility/stream_convert.h>
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace util::stream;
+
+namespace
+{
+
+// a mix of values within and outside of the normalised range, including the
+// halfway cases for rounding and values which overflow a half
+std::vector<float> getTestValues()
+{
+    std::vector<float> values = {
+        0.0f,    -0.0f,  1.0f,         -1.0f,    0.5f,     -0.5f,     2.5f,    -2.5f,
+        65504.0f, 65520.0f, 1.0e6f,    -1.0e6f,  5.9604645e-8f, 2.9802322e-8f, 1.0e-10f,
+        INFINITY, -INFINITY, NAN,      127.5f,   255.5f,   -128.5f,   32767.5f};
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> dist(-2.0f, 2.0f);
+    std::uniform_real_distribution<float> wide(-70000.0f, 70000.0f);
+    for (int i = 0; i < 1000; ++i)
+    {
+        values.emplace_back(dist(rng));
+        values.emplace_back(wide(rng));
+    }
+    return values;
+}
+
+bool bitEqual(float a, float b) { return memcmp(&a, &b, sizeof(float)) == 0; }
+
+} // namespace
+
+TEST(StreamConvertTests, HalfConversion)
+{
+    EXPECT_EQ(floatToHalf(1.0f), 0x3c00);
+    EXPECT_EQ(floatToHalf(-2.0f), 0xc000);
+    EXPECT_EQ(floatToHalf(100000.0f), 0x7c00);
+    EXPECT_EQ(floatToHalf(5.9604645e-8f), 0x0001);
+    EXPECT_FLOAT_EQ(halfToFloat(0x0001), 5.9604645e-8f);
+
+    // the vectorised conversion must match the scalar version for every half
+    std::vector<uint16_t> halfs(0x10000);
+    for (size_t i = 0; i < halfs.size(); ++i)
+    {
+        halfs[i] = static_cast<uint16_t>(i);
+    }
+    std::vector<float> floats(halfs.size());
+    convertToFloat(halfs.data(), Type::Half, false, floats.data(), halfs.size());
+    for (size_t i = 0; i < halfs.size(); ++i)
+    {
+        ASSERT_TRUE(bitEqual(floats[i], halfToFloat(halfs[i]))) << i;
+    }
+
+    // and back again - every half (apart from nans) survives the round trip
+    std::vector<uint16_t> result(halfs.size());
+    convertFromFloat(floats.data(), Type::Half, false, result.data(), floats.size());
+    for (size_t i = 0; i < halfs.size(); ++i)
+    {
+        if (!std::isnan(floats[i]))
+        {
+            ASSERT_EQ(result[i], halfs[i]) << i;
+        }
+    }
+}
+
+TEST(StreamConvertTests, FromFloatMatchesScalar)
+{
+    const std::vector<float> values = getTestValues();
+    const Type types[] = {Type::Int8, Type::Uint8, Type::Int16, Type::Uint16, Type::Half};
+
+    for (Type type : types)
+    {
+        for (bool normalised : {false, true})
+        {
+            const size_t size = values.size() * getTypeSize(type);
+            std::vector<uint8_t> expected(size);
+            std::vector<uint8_t> result(size);
+            scalar::convertFromFloat(
+                values.data(), type, normalised, expected.data(), values.size());
+            convertFromFloat(values.data(), type, normalised, result.data(), values.size());
+            EXPECT_EQ(result, expected) << static_cast<int>(type) << " " << normalised;
+        }
+    }
+
+    // the normalised conversions round as expected
+    const float unorm[] = {0.0f, 1.0f, 0.5f, 2.0f, -1.0f};
+    uint8_t unorm8[5];
+    convertFromFloat(unorm, Type::Uint8, true, unorm8, 5);
+    EXPECT_EQ(unorm8[0], 0);
+    EXPECT_EQ(unorm8[1], 255);
+    EXPECT_EQ(unorm8[2], 128);
+    EXPECT_EQ(unorm8[3], 255);
+    EXPECT_EQ(unorm8[4], 0);
+
+    const float snorm[] = {-1.0f, 1.0f, -2.0f, 0.5f, -0.5f};
+    int16_t snorm16[5];
+    convertFromFloat(snorm, Type::Int16, true, snorm16, 5);
+    EXPECT_EQ(snorm16[0], -32767);
+    EXPECT_EQ(snorm16[1], 32767);
+    EXPECT_EQ(snorm16[2], -32767);
+    EXPECT_EQ(snorm16[3], 16384);
+    EXPECT_EQ(snorm16[4], -16384);
+}
+
+TEST(StreamConvertTests, ToFloatMatchesScalar)
+{
+    std::mt19937 rng(5678);
+    std::vector<uint8_t> data(4099 * sizeof(uint32_t));
+    for (uint8_t& byte : data)
+    {
+        byte = static_cast<uint8_t>(rng());
+    }
+
+    const Type types[] = {Type::Int8, Type::Uint8, Type::Int16, Type::Uint16, Type::Uint32};
+    for (Type type : types)
+    {
+        for (bool normalised : {false, true})
+        {
+            // an odd count so the scalar tail is also tested
+            const size_t count = data.size() / getTypeSize(type) - 1;
+            std::vector<float> expected(count);
+            std::vector<float> result(count);
+            scalar::convertToFloat(data.data(), type, normalised, expected.data(), count);
+            convertToFloat(data.data(), type, normalised, result.data(), count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                ASSERT_TRUE(bitEqual(result[i], expected[i]))
+                    << static_cast<int>(type) << " " << i;
+            }
+        }
+    }
+
+    // the minimum signed value is clamped to -1
+    const int8_t snorm8[] = {-128, -127, 127, 0};
+    float result[4];
+    convertToFloat(snorm8, Type::Int8, true, result, 4);
+    EXPECT_EQ(result[0], -1.0f);
+    EXPECT_EQ(result[1], -1.0f);
+    EXPECT_EQ(result[2], 1.0f);
+    EXPECT_EQ(result[3], 0.0f);
+}
+
+TEST(StreamConvertTests, Strided)
+{
+    // uvs stored as unorm16 in a 12 byte stride, converted into a 20 byte stride
+    const size_t count = 1027;
+    const size_t srcStride = 12;
+    const size_t dstStride = 20;
+    std::vector<uint8_t> src(count * srcStride);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint16_t uv[2] = {static_cast<uint16_t>(i * 7), static_cast<uint16_t>(i * 13)};
+        memcpy(src.data() + i * srcStride + 4, uv, sizeof(uv));
+    }
+
+    std::vector<uint8_t> dst(count * dstStride, 0xff);
+    convertStrided(
+        src.data() + 4,
+        srcStride,
+        Type::Uint16,
+        dst.data(),
+        dstStride,
+        Type::Float,
+        true,
+        2,
+        count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        float uv[2];
+        memcpy(uv, dst.data() + i * dstStride, sizeof(uv));
+        EXPECT_FLOAT_EQ(uv[0], static_cast<uint16_t>(i * 7) / 65535.0f);
+        EXPECT_FLOAT_EQ(uv[1], static_cast<uint16_t>(i * 13) / 65535.0f);
+        // the rest of the element is untouched
+        EXPECT_EQ(dst[i * dstStride + 8], 0xff);
+    }
+
+    // and back to the original stream
+    std::vector<uint8_t> back(count * srcStride, 0);
+    convertStrided(
+        dst.data(),
+        dstStride,
+        Type::Float,
+        back.data() + 4,
+        srcStride,
+        Type::Uint16,
+        true,
+        2,
+        count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        EXPECT_EQ(memcmp(back.data() + i * srcStride + 4, src.data() + i * srcStride + 4, 4), 0);
+    }
+}
+
+TEST(StreamConvertTests, Indices)
+{
+    const size_t count = 1001;
+    std::vector<uint8_t> indices8(count);
+    std::vector<uint16_t> indices16(count);
+    std::vector<uint32_t> indices32(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        indices8[i] = static_cast<uint8_t>(i);
+        indices16[i] = static_cast<uint16_t>(i * 31);
+        indices32[i] = static_cast<uint32_t>(i * 1023);
+    }
+    const uint32_t base = 100;
+
+    std::vector<uint32_t> wide(count);
+    convertIndices(indices8.data(), 1, Type::Uint8, base, wide.data(), count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        ASSERT_EQ(wide[i], indices8[i] + base);
+    }
+    convertIndices(indices16.data(), 2, Type::Uint16, base, wide.data(), count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        ASSERT_EQ(wide[i], indices16[i] + base);
+    }
+
+    // narrowing to 16-bit
+    std::vector<uint16_t> narrow(count);
+    std::vector<uint16_t> expected(count);
+    convertIndices(indices32.data(), 4, Type::Uint32, base, narrow.data(), count);
+    scalar::convertIndices(indices32.data(), 4, Type::Uint32, base, expected.data(), count);
+    EXPECT_EQ(narrow, expected);
+    EXPECT_EQ(narrow[10], 10 * 1023 + base);
+
+    // strided indices - every other 16-bit value
+    convertIndices(indices16.data(), 4, Type::Uint16, 0, wide.data(), count / 2);
+    for (size_t i = 0; i < count / 2; ++i)
+    {
+        ASSERT_EQ(wide[i], indices16[i * 2]);
+    }
+}
+
+TEST(StreamConvertTests, Interleave)
+{
+    const size_t count = 600;
+    std::vector<float> positions(count * 3);
+    std::vector<uint16_t> uvs(count * 2);
+    std::vector<float> normals(count * 3);
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        positions[i] = static_cast<float>(i);
+        normals[i] = -static_cast<float>(i);
+    }
+    for (size_t i = 0; i < uvs.size(); ++i)
+    {
+        uvs[i] = static_cast<uint16_t>(i);
+    }
+
+    const size_t stride = 28;
+    const ConstAttribute attributes[] = {
+        {positions.data(), 12, 0, 12}, {uvs.data(), 4, 12, 4}, {normals.data(), 12, 16, 12}};
+    std::vector<uint8_t> interleaved(count * stride);
+    interleave(attributes, 3, interleaved.data(), stride, count);
+
+    float pos[3];
+    memcpy(pos, interleaved.data() + 500 * stride, sizeof(pos));
+    EXPECT_EQ(pos[0], 1500.0f);
+    EXPECT_EQ(pos[2], 1502.0f);
+
+    std::vector<float> outPositions(count * 3);
+    std::vector<uint16_t> outUvs(count * 2);
+    std::vector<float> outNormals(count * 3);
+    const Attribute outAttributes[] = {
+        {outPositions.data(), 12, 0, 12},
+        {outUvs.data(), 4, 12, 4},
+        {outNormals.data(), 12, 16, 12}};
+    deinterleave(interleaved.data(), stride, outAttributes, 3, count);
+    EXPECT_EQ(outPositions, positions);
+    EXPECT_EQ(outUvs, uvs);
+    EXPECT_EQ(outNormals, normals);
+}
+
+TEST(StreamConvertTests, ExpandRgb)
+{
+    // an odd pixel count so the scalar tail is also tested
+    const size_t count = 1037;
+    std::vector<uint8_t> rgb(count * 3);
+    for (size_t i = 0; i < rgb.size(); ++i)
+    {
+        rgb[i] = static_cast<uint8_t>(i * 7);
+    }
+
+    std::vector<uint8_t> rgba(count * 4);
+    std::vector<uint8_t> expected(count * 4);
+    expandRgbToRgba(rgb.data(), rgba.data(), count, 0xff);
+    scalar::expandRgbToRgba(rgb.data(), expected.data(), count, 0xff);
+    EXPECT_EQ(rgba, expected);
+
+    EXPECT_EQ(rgba[4 * 5 + 0], rgb[3 * 5 + 0]);
+    EXPECT_EQ(rgba[4 * 5 + 1], rgb[3 * 5 + 1]);
+    EXPECT_EQ(rgba[4 * 5 + 2], rgb[3 * 5 + 2]);
+    EXPECT_EQ(rgba[4 * 5 + 3], 0xff);
+}
@@ -22,7 +22,9 @@
 
 #include "asset_loader.h"
 
+#include <backend/convert_to_vk.h>
 #include <utility/assertion.h>
+#include <utility/stream_convert.h>
 #include <yave/engine.h>
 #include <yave/texture.h>
 
@@ -31,11 +33,67 @@
 #include <spdlog/spdlog.h>
 #include <stb_image.h>
 
+#include <array>
+#include <cstring>
 #include <filesystem>
+#include <memory>
 
 namespace yave
 {
 
+namespace
+{
+
+struct TranscodeTarget
+{
+    ktx_transcode_fmt_e ktxFormat;
+    backend::TextureFormat format;
+};
+
+// Selects the block compressed format that the basis data is transcoded to,
+// in order of quality, from those supported by the device. Falls back to
+// uncompressed rgba if the device supports none of them.
+TranscodeTarget selectTranscodeTarget(Engine* engine, uint32_t compCount)
+{
+    using backend::TextureFormat;
+    std::array<TranscodeTarget, 4> targets;
+    size_t targetCount = 0;
+    switch (compCount)
+    {
+        case 1:
+            targets[targetCount++] = {KTX_TTF_BC4_R, TextureFormat::BC4};
+            targets[targetCount++] = {KTX_TTF_ETC2_EAC_R11, TextureFormat::EAC_R11};
+            break;
+        case 2:
+            targets[targetCount++] = {KTX_TTF_BC5_RG, TextureFormat::BC5};
+            targets[targetCount++] = {KTX_TTF_ETC2_EAC_RG11, TextureFormat::EAC_RG11};
+            break;
+        case 3:
+            targets[targetCount++] = {KTX_TTF_BC7_RGBA, TextureFormat::BC7};
+            targets[targetCount++] = {KTX_TTF_ASTC_4x4_RGBA, TextureFormat::ASTC_4x4};
+            targets[targetCount++] = {KTX_TTF_ETC1_RGB, TextureFormat::ETC2_RGB8};
+            targets[targetCount++] = {KTX_TTF_BC1_RGB, TextureFormat::BC1};
+            break;
+        default:
+            targets[targetCount++] = {KTX_TTF_BC7_RGBA, TextureFormat::BC7};
+            targets[targetCount++] = {KTX_TTF_ASTC_4x4_RGBA, TextureFormat::ASTC_4x4};
+            targets[targetCount++] = {KTX_TTF_ETC2_RGBA, TextureFormat::ETC2_RGBA8};
+            targets[targetCount++] = {KTX_TTF_BC3_RGBA, TextureFormat::BC3};
+            break;
+    }
+
+    for (size_t i = 0; i < targetCount; ++i)
+    {
+        if (Texture::isFormatSupported(engine, targets[i].format))
+        {
+            return targets[i];
+        }
+    }
+    return {KTX_TTF_RGBA32, TextureFormat::RGBA8};
+}
+
+} // namespace
+
 AssetLoader::AssetLoader(Engine* engine) : engine_(engine) {}
 AssetLoader::~AssetLoader() {}
 
@@ -70,22 +128,32 @@ uint32_t AssetLoader::compSizeFromFormat(backend::TextureFormat format)
     return output;
 }
 
-Texture*
-AssetLoader::loadFromFile(const std::filesystem::path& filePath, backend::TextureFormat format)
+std::filesystem::path AssetLoader::getAssetPath(const std::filesystem::path& filePath) const
 {
     std::filesystem::path assetPath = filePath;
     if (!assetFolder_.empty())
     {
         assetPath = assetFolder_ / filePath;
     }
-    auto platformAssetPath = assetPath.make_preferred();
+    return assetPath.make_preferred();
+}
+
+bool AssetLoader::isImageFile(const std::filesystem::path& filePath)
+{
+    return filePath.extension() == ".png" || filePath.extension() == ".jpg";
+}
+
+Texture*
+AssetLoader::loadFromFile(const std::filesystem::path& filePath, backend::TextureFormat format)
+{
+    auto platformAssetPath = getAssetPath(filePath);
 
     Texture* tex = nullptr;
-    if (platformAssetPath.extension() == ".ktx")
+    if (platformAssetPath.extension() == ".ktx" || platformAssetPath.extension() == ".ktx2")
     {
         tex = parseKtxFile(platformAssetPath, format);
     }
-    else if (platformAssetPath.extension() == ".png" || platformAssetPath.extension() == ".jpg")
+    else if (isImageFile(platformAssetPath))
     {
         tex = parseImageFile(platformAssetPath, format);
     }
@@ -99,57 +167,105 @@ AssetLoader::loadFromFile(const std::filesystem::path& filePath, backend::Textur
     return tex;
 }
 
-Texture*
-AssetLoader::parseImageFile(const std::filesystem::path& filePath, backend::TextureFormat format)
+std::vector<Texture*> AssetLoader::loadFromFiles(
+    const std::vector<std::filesystem::path>& filePaths, backend::TextureFormat format)
 {
-    ImageParams params;
+    std::vector<Texture*> textures(filePaths.size(), nullptr);
+    std::vector<Texture::Upload> uploads;
+    uploads.reserve(filePaths.size());
 
-    uint32_t reqComp = compSizeFromFormat(format);
-    if (reqComp < 3)
+    for (size_t idx = 0; idx < filePaths.size(); ++idx)
     {
-        SPDLOG_ERROR("Only comp of 3 or 4 supported for .png and .jpg images.");
-        return {};
+        auto platformAssetPath = getAssetPath(filePaths[idx]);
+        if (!isImageFile(platformAssetPath))
+        {
+            textures[idx] = loadFromFile(filePaths[idx], format);
+            continue;
+        }
+
+        Texture::Upload upload;
+        if (createImageUpload(platformAssetPath, format, upload))
+        {
+            upload.texture = engine_->createTexture();
+            textures[idx] = upload.texture;
+            uploads.emplace_back(std::move(upload));
+        }
     }
 
-    int width, height, comp;
-    params.data = stbi_load((const char*)filePath.c_str(), &width, &height, &comp, reqComp);
+    // the images are decoded in parallel as part of the upload
+    if (!uploads.empty())
+    {
+        Texture::setTextures(engine_, uploads);
+    }
+    return textures;
+}
 
-    if (!params.data)
+bool AssetLoader::createImageUpload(
+    const std::filesystem::path& filePath, backend::TextureFormat format, Texture::Upload& upload)
+{
+    const int reqComp = static_cast<int>(compSizeFromFormat(format));
+    if (reqComp < 3)
     {
-        return {};
+        SPDLOG_ERROR("Only comp of 3 or 4 supported for .png and .jpg images.");
+        return false;
     }
 
-    // only images with four components supported, so convert to four
-    if (comp == 3)
+    // only the header is read here - the image is decoded by the fill function
+    int width, height, comp;
+    const std::string path = filePath.string();
+    if (!stbi_info(path.c_str(), &width, &height, &comp))
     {
-        // create a new buffer to hold all four components
-        uint8_t* newBuffer = new uint8_t[width * height * 4];
+        SPDLOG_ERROR("Unable to open image file {}: {}", path.c_str(), stbi_failure_reason());
+        return false;
+    }
 
-        size_t oldSize = width * height * 3;
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    upload.params.width = width;
+    upload.params.height = height;
+    upload.params.bufferSize = pixelCount * reqComp;
+    upload.params.format = format;
+    upload.params.usageFlags = backend::ImageUsage::Sampled; // should be user defined
+
+    upload.fillFunc = [path, width, height, comp, reqComp, pixelCount](void* dst) {
+        // rgb images are expanded to rgba here rather than by stb, so the
+        // expansion is written straight into the upload memory
+        const bool expandRgb = comp == 3 && reqComp == 4;
+
+        int w, h, c;
+        stbi_uc* data = stbi_load(path.c_str(), &w, &h, &c, expandRgb ? 3 : reqComp);
+        if (!data || w != width || h != height)
+        {
+            SPDLOG_ERROR("Unable to decode image file {}.", path.c_str());
+            memset(dst, 0, pixelCount * reqComp);
+            stbi_image_free(data);
+            return;
+        }
 
-        // the alpha channel will be empty (memset here?)
-        memcpy(newBuffer, params.data, oldSize);
+        if (expandRgb)
+        {
+            util::stream::expandRgbToRgba(data, static_cast<uint8_t*>(dst), pixelCount, 0xff);
+        }
+        else
+        {
+            memcpy(dst, data, pixelCount * reqComp);
+        }
+        stbi_image_free(data);
+    };
+    return true;
+}
 
-        // delete the old buffer now we are finished with it
-        stbi_image_free(params.data);
-        params.data = newBuffer;
+Texture*
+AssetLoader::parseImageFile(const std::filesystem::path& filePath, backend::TextureFormat format)
+{
+    Texture::Upload upload;
+    if (!createImageUpload(filePath, format, upload))
+    {
+        return nullptr;
     }
-    params.dataSize = width * height * comp;
 
-    Texture* tex = engine_->createTexture();
-    Texture::Params texParams {
-        params.data,
-        params.dataSize,
-        params.width,
-        params.height,
-        format,
-        backend::ImageUsage::Sampled, // should be user defined
-        params.mipLevels,
-        params.faceCount};
-    tex->setTexture(texParams);
-    stbi_image_free(params.data);
-
-    return tex;
+    upload.texture = engine_->createTexture();
+    Texture::setTextures(engine_, {upload});
+    return upload.texture;
 }
 
 Texture*
@@ -172,13 +288,96 @@ AssetLoader::parseKtxFile(const std::filesystem::path& filePath, backend::Textur
     ASSERT_FATAL(
         texture->numDimensions == 2, "Only 2D textures supported by the engine currently.");
 
+    if (texture->classId == ktxTexture2_c)
+    {
+        auto* texture2 = reinterpret_cast<ktxTexture2*>(texture);
+        if (ktxTexture2_NeedsTranscoding(texture2))
+        {
+            // basis supercompressed data is transcoded to the best block
+            // compressed format the device supports - this overrides the
+            // requested format
+            TranscodeTarget target =
+                selectTranscodeTarget(engine_, ktxTexture2_GetNumComponents(texture2));
+            result = ktxTexture2_TranscodeBasis(texture2, target.ktxFormat, 0);
+            if (result != KTX_error_code::KTX_SUCCESS)
+            {
+                SPDLOG_CRITICAL(
+                    "Unable to transcode ktx image file {}: {}",
+                    filePath.string().c_str(),
+                    ktxErrorString(result));
+                ktxTexture_Destroy(texture);
+                return {};
+            }
+            format = target.format;
+        }
+        else
+        {
+            // ktx2 files state their format so use this if it's one we know of
+            auto vkFormat = static_cast<vk::Format>(texture2->vkFormat);
+            for (int i = 0; i < static_cast<int>(backend::TextureFormat::Undefined); ++i)
+            {
+                auto texFormat = static_cast<backend::TextureFormat>(i);
+                if (backend::textureFormatToVk(texFormat) == vkFormat)
+                {
+                    format = texFormat;
+                    break;
+                }
+            }
+        }
+    }
+
     params.width = texture->baseWidth;
     params.height = texture->baseHeight;
     params.faceCount = texture->numFaces;
     params.mipLevels = texture->numLevels;
     params.arrayCount = texture->numLayers;
-    params.data = texture->pData;
-    params.dataSize = static_cast<uint32_t>(texture->dataSize);
+    params.data = ktxTexture_GetData(texture);
+    params.dataSize = static_cast<uint32_t>(ktxTexture_GetDataSize(texture));
+
+    Texture* tex = engine_->createTexture();
+
+    if (engine_->getStreamingOptions().enabled && params.mipLevels > 1 && params.arrayCount == 1)
+    {
+        // only the mip tail is uploaded now - the file data is kept for
+        // loading the larger levels when they are required
+        std::shared_ptr<ktxTexture> ktxData(
+            texture, [](ktxTexture* ktx) { ktxTexture_Destroy(ktx); });
+
+        Texture::StreamParams streamParams;
+        streamParams.params = {
+            nullptr,
+            0,
+            params.width,
+            params.height,
+            format,
+            backend::ImageUsage::Sampled,
+            params.mipLevels,
+            params.faceCount};
+        streamParams.levelSizes.resize(params.mipLevels);
+        for (uint32_t level = 0; level < params.mipLevels; ++level)
+        {
+            streamParams.levelSizes[level] =
+                ktxTexture_GetImageSize(texture, level) * params.faceCount;
+        }
+
+        const uint32_t faceCount = params.faceCount;
+        streamParams.fillFunc = [ktxData, faceCount](uint32_t level, void* dst) {
+            const size_t faceSize = ktxTexture_GetImageSize(ktxData.get(), level);
+            for (uint32_t face = 0; face < faceCount; ++face)
+            {
+                ktx_size_t offset;
+                KTX_error_code ret =
+                    ktxTexture_GetImageOffset(ktxData.get(), level, 0, face, &offset);
+                ASSERT_FATAL(ret == KTX_SUCCESS, "Error whilst generating image offsets.");
+                memcpy(
+                    static_cast<uint8_t*>(dst) + face * faceSize,
+                    ktxTexture_GetData(ktxData.get()) + offset,
+                    faceSize);
+            }
+        };
+        tex->setStreamedTexture(streamParams);
+        return tex;
+    }
 
     size_t* offsets = new size_t[params.faceCount * params.mipLevels];
     for (uint32_t face = 0; face < params.faceCount; face++)
@@ -191,7 +390,6 @@ AssetLoader::parseKtxFile(const std::filesystem::path& filePath, backend::Textur
         }
     }
 
-    Texture* tex = engine_->createTexture();
     Texture::Params texParams {
         params.data,
         params.dataSize,
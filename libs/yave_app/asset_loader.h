@@ -25,13 +25,14 @@
 #include "utility/cstring.h"
 
 #include <backend/enums.h>
+#include <yave/texture.h>
 
 #include <filesystem>
+#include <vector>
 
 namespace yave
 {
 class Engine;
-class Texture;
 
 class AssetLoader
 {
@@ -76,12 +77,33 @@ public:
      */
     Texture* loadFromFile(const std::filesystem::path& filePath, backend::TextureFormat format);
 
+    /**
+     * @brief Loads a number of images. The png and jpg images are decoded in
+     * parallel, straight into the upload memory, and uploaded as one batch -
+     * any other types are loaded one at a time.
+     * @return The textures in the same order as the paths - nullptr for any
+     * image which couldn't be opened.
+     */
+    std::vector<Texture*> loadFromFiles(
+        const std::vector<std::filesystem::path>& filePaths, backend::TextureFormat format);
+
     Texture* parseImageFile(const std::filesystem::path& filePath, backend::TextureFormat format);
 
     Texture* parseKtxFile(const std::filesystem::path& filePath, backend::TextureFormat format);
 
     void setAssetFolder(const std::filesystem::path& assetPath);
 
+private:
+    [[nodiscard]] std::filesystem::path getAssetPath(const std::filesystem::path& filePath) const;
+
+    static bool isImageFile(const std::filesystem::path& filePath);
+
+    // reads the image header and sets up an upload which decodes the image
+    static bool createImageUpload(
+        const std::filesystem::path& filePath,
+        backend::TextureFormat format,
+        Texture::Upload& upload);
+
 private:
     Engine* engine_;
 
@@ -0,0 +1,224 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "utility/logger.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <ktx.h>
+#include <stb_image.h>
+#include <vulkan/vulkan_core.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+constexpr uint32_t ComponentCount = 4;
+
+void printUsage()
+{
+    printf(
+        "Usage: YaveTextureEncoder <image.png|image.jpg> <output.ktx2> [options]\n"
+        "Encodes the image as a Basis Universal supercompressed KTX2 texture which\n"
+        "is transcoded by the AssetLoader to a block compressed format supported\n"
+        "by the device.\n\n"
+        "Options:\n"
+        "    --uastc          Use UASTC rather than ETC1S - higher quality, larger files.\n"
+        "    --quality <n>    ETC1S quality level from 1 to 255 (default 128).\n"
+        "    --normal-map     Tune the encoder for normal maps.\n"
+        "    --no-mips        Don't generate a mip chain.\n");
+}
+
+uint32_t getMipCount(uint32_t width, uint32_t height)
+{
+    uint32_t levels = 1;
+    while ((width | height) >> levels)
+    {
+        ++levels;
+    }
+    return levels;
+}
+
+// A 2x2 box filter - odd sized edges clamp to the last texel.
+std::vector<uint8_t>
+downsample(const std::vector<uint8_t>& src, uint32_t srcWidth, uint32_t srcHeight)
+{
+    const uint32_t dstWidth = std::max(srcWidth >> 1, 1u);
+    const uint32_t dstHeight = std::max(srcHeight >> 1, 1u);
+    std::vector<uint8_t> dst(dstWidth * dstHeight * ComponentCount);
+
+    for (uint32_t y = 0; y < dstHeight; ++y)
+    {
+        const uint32_t y0 = std::min(y * 2, srcHeight - 1);
+        const uint32_t y1 = std::min(y * 2 + 1, srcHeight - 1);
+        for (uint32_t x = 0; x < dstWidth; ++x)
+        {
+            const uint32_t x0 = std::min(x * 2, srcWidth - 1);
+            const uint32_t x1 = std::min(x * 2 + 1, srcWidth - 1);
+            for (uint32_t c = 0; c < ComponentCount; ++c)
+            {
+                const uint32_t sum = src[(y0 * srcWidth + x0) * ComponentCount + c] +
+                    src[(y0 * srcWidth + x1) * ComponentCount + c] +
+                    src[(y1 * srcWidth + x0) * ComponentCount + c] +
+                    src[(y1 * srcWidth + x1) * ComponentCount + c];
+                dst[(y * dstWidth + x) * ComponentCount + c] = static_cast<uint8_t>((sum + 2) / 4);
+            }
+        }
+    }
+    return dst;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        printUsage();
+        return 1;
+    }
+
+    const std::filesystem::path imagePath = argv[1];
+    const std::filesystem::path outputPath = argv[2];
+
+    bool uastc = false;
+    bool normalMap = false;
+    bool generateMips = true;
+    uint32_t quality = 128;
+    for (int i = 3; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--uastc"))
+        {
+            uastc = true;
+        }
+        else if (!strcmp(argv[i], "--quality") && i + 1 < argc)
+        {
+            quality = std::clamp(atoi(argv[++i]), 1, 255);
+        }
+        else if (!strcmp(argv[i], "--normal-map"))
+        {
+            normalMap = true;
+        }
+        else if (!strcmp(argv[i], "--no-mips"))
+        {
+            generateMips = false;
+        }
+        else
+        {
+            LOGGER_ERROR("Unknown option: %s\n", argv[i]);
+            printUsage();
+            return 1;
+        }
+    }
+
+    int width, height, comp;
+    stbi_uc* pixels = stbi_load(imagePath.string().c_str(), &width, &height, &comp, ComponentCount);
+    if (!pixels)
+    {
+        LOGGER_ERROR("Unable to open image file %s.\n", imagePath.string().c_str());
+        return 1;
+    }
+    std::vector<uint8_t> level(pixels, pixels + width * height * ComponentCount);
+    stbi_image_free(pixels);
+
+    ktxTextureCreateInfo createInfo = {};
+    createInfo.vkFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    createInfo.baseWidth = width;
+    createInfo.baseHeight = height;
+    createInfo.baseDepth = 1;
+    createInfo.numDimensions = 2;
+    createInfo.numLevels = generateMips ? getMipCount(width, height) : 1;
+    createInfo.numLayers = 1;
+    createInfo.numFaces = 1;
+    createInfo.isArray = KTX_FALSE;
+    createInfo.generateMipmaps = KTX_FALSE;
+
+    ktxTexture2* texture;
+    KTX_error_code result =
+        ktxTexture2_Create(&createInfo, KTX_TEXTURE_CREATE_ALLOC_STORAGE, &texture);
+    if (result != KTX_SUCCESS)
+    {
+        LOGGER_ERROR("Unable to create ktx texture: %s\n", ktxErrorString(result));
+        return 1;
+    }
+
+    // the mip chain is generated here as levels can't be generated at runtime
+    // for block compressed formats
+    uint32_t levelWidth = width;
+    uint32_t levelHeight = height;
+    for (uint32_t mip = 0; mip < createInfo.numLevels; ++mip)
+    {
+        if (mip > 0)
+        {
+            level = downsample(level, levelWidth, levelHeight);
+            levelWidth = std::max(levelWidth >> 1, 1u);
+            levelHeight = std::max(levelHeight >> 1, 1u);
+        }
+        result = ktxTexture_SetImageFromMemory(
+            ktxTexture(texture), mip, 0, 0, level.data(), level.size());
+        if (result != KTX_SUCCESS)
+        {
+            LOGGER_ERROR("Unable to set mip level %d: %s\n", mip, ktxErrorString(result));
+            ktxTexture_Destroy(ktxTexture(texture));
+            return 1;
+        }
+    }
+
+    ktxBasisParams params = {};
+    params.structSize = sizeof(params);
+    params.uastc = uastc ? KTX_TRUE : KTX_FALSE;
+    params.uastcFlags = KTX_PACK_UASTC_LEVEL_DEFAULT;
+    params.qualityLevel = quality;
+    params.normalMap = normalMap ? KTX_TRUE : KTX_FALSE;
+    params.threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+    result = ktxTexture2_CompressBasisEx(texture, &params);
+    if (result == KTX_SUCCESS && uastc)
+    {
+        // UASTC data compresses poorly on its own so is supercompressed with zstd
+        result = ktxTexture2_DeflateZstd(texture, 18);
+    }
+    if (result != KTX_SUCCESS)
+    {
+        LOGGER_ERROR("Unable to encode texture: %s\n", ktxErrorString(result));
+        ktxTexture_Destroy(ktxTexture(texture));
+        return 1;
+    }
+
+    result = ktxTexture_WriteToNamedFile(ktxTexture(texture), outputPath.string().c_str());
+    ktxTexture_Destroy(ktxTexture(texture));
+    if (result != KTX_SUCCESS)
+    {
+        LOGGER_ERROR(
+            "Unable to write %s: %s\n", outputPath.string().c_str(), ktxErrorString(result));
+        return 1;
+    }
+
+    LOGGER_INFO("Encoded %s to %s.\n", imagePath.string().c_str(), outputPath.string().c_str());
+    return 0;
+}
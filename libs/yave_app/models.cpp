@@ -27,46 +27,62 @@
 #include "yave/render_primitive.h"
 #include "yave/vertex_buffer.h"
 
+#include <model_parser/optimiser/vertex_quantiser.h>
+#include <utility/stream_convert.h>
+
 #include <array>
 #include <cmath>
+#include <cstring>
 #include <memory>
 #include <vector>
 
 namespace yave
 {
 
-float* generateInterleavedData(
+/**
+ * @brief Interleaves the vertex data in the quantised layout: float positions,
+ * half float uvs and octahedral encoded normals (2 x snorm16).
+ */
+std::vector<uint8_t> generateInterleavedData(
     mathfu::vec3* positions, mathfu::vec2* texCoords, mathfu::vec3* normals, size_t vertexCount)
 {
     if (!positions)
     {
-        return nullptr;
+        return {};
     }
 
-    const size_t totalBufferSize = 3 * vertexCount + 2 * vertexCount + 3 * vertexCount;
-    float* buffer = new float[totalBufferSize];
-
-    float* bufferPtr = buffer;
-    mathfu::vec3* posPtr = positions;
-    mathfu::vec2* texPtr = texCoords;
-    mathfu::vec3* normPtr = normals;
+    size_t stride = 3 * sizeof(float);
+    stride += texCoords ? 2 * sizeof(uint16_t) : 0;
+    stride += normals ? 2 * sizeof(int16_t) : 0;
+    std::vector<uint8_t> buffer(stride * vertexCount);
 
-    for (uint32_t idx = 0; idx < vertexCount; ++idx)
+    util::stream::copyStrided(
+        positions, sizeof(mathfu::vec3), buffer.data(), stride, 3 * sizeof(float), vertexCount);
+    size_t offset = 3 * sizeof(float);
+    if (texCoords)
     {
-        memcpy(bufferPtr, posPtr, sizeof(mathfu::vec3));
-        bufferPtr += 3;
-        ++posPtr;
-        if (texCoords)
-        {
-            memcpy(bufferPtr, texPtr, sizeof(mathfu::vec2));
-            bufferPtr += 2;
-            ++texPtr;
-        }
-        if (normals)
+        util::stream::convertStrided(
+            texCoords,
+            sizeof(mathfu::vec2),
+            util::stream::Type::Float,
+            buffer.data() + offset,
+            stride,
+            util::stream::Type::Half,
+            false,
+            2,
+            vertexCount);
+        offset += 2 * sizeof(uint16_t);
+    }
+    if (normals)
+    {
+        uint8_t* bufferPtr = buffer.data() + offset;
+        for (size_t idx = 0; idx < vertexCount; ++idx, bufferPtr += stride)
         {
-            memcpy(bufferPtr, normPtr, sizeof(mathfu::vec3));
-            bufferPtr += 3;
-            ++normPtr;
+            mathfu::vec3 n = mathfu::NormalizedHelper(normals[idx]);
+            float normal[3] = {n.x, n.y, n.z};
+            int16_t encoded[2];
+            VertexQuantiser::encodeOctahedral(normal, encoded);
+            memcpy(bufferPtr, encoded, sizeof(encoded));
         }
     }
 
@@ -81,7 +97,6 @@ void generateQuadMesh(
     yave::RenderPrimitive* prim)
 {
     static constexpr int vertexCount = 4;
-    static constexpr int totalVertexCount = vertexCount * 3;
 
     mathfu::vec3 positions[] = {
         mathfu::vec3 {size, size, 0.0f},
@@ -102,17 +117,18 @@ void generateQuadMesh(
         mathfu::vec3 {0.0f, 0.0f, -1.0f}};
 
     // interleave data
-    float* buffer = generateInterleavedData(positions, texCoords, normals, vertexCount);
+    std::vector<uint8_t> buffer =
+        generateInterleavedData(positions, texCoords, normals, vertexCount);
 
     // quad made up of two triangles
     const std::vector<int> indices = {0, 1, 2, 2, 3, 0};
 
     vBuffer->addAttribute(
         yave::VertexBuffer::BindingType::Position, backend::BufferElementType::Float3);
-    vBuffer->addAttribute(yave::VertexBuffer::BindingType::Uv, backend::BufferElementType::Float2);
+    vBuffer->addAttribute(yave::VertexBuffer::BindingType::Uv, backend::BufferElementType::Half2);
     vBuffer->addAttribute(
-        yave::VertexBuffer::BindingType::Normal, backend::BufferElementType::Float3);
-    vBuffer->build(engine, totalVertexCount, (void*)buffer);
+        yave::VertexBuffer::BindingType::Normal, backend::BufferElementType::Snorm16x2);
+    vBuffer->build(engine, static_cast<uint32_t>(buffer.size()), buffer.data());
 
     iBuffer->build(
         engine,
@@ -121,10 +137,6 @@ void generateQuadMesh(
         backend::IndexBufferType::Uint32);
 
     prim->addMeshDrawData(indices.size(), 0, 0);
-
-    // we have uploaded the data to the device so no longer need the allocated
-    // space
-    delete[] buffer;
 }
 
 void generateSphereMesh(
@@ -204,13 +216,13 @@ void generateSphereMesh(
 
     // interleave data
     const uint32_t vertexCount = static_cast<uint32_t>(positions.size());
-    float* buffer =
+    std::vector<uint8_t> buffer =
         generateInterleavedData(positions.data(), texCoords.data(), nullptr, vertexCount);
 
     vBuffer->addAttribute(
         yave::VertexBuffer::BindingType::Position, backend::BufferElementType::Float3);
-    vBuffer->addAttribute(yave::VertexBuffer::BindingType::Uv, backend::BufferElementType::Float2);
-    vBuffer->build(engine, vertexCount * 20, (void*)buffer);
+    vBuffer->addAttribute(yave::VertexBuffer::BindingType::Uv, backend::BufferElementType::Half2);
+    vBuffer->build(engine, static_cast<uint32_t>(buffer.size()), buffer.data());
 
     iBuffer->build(
         engine,
@@ -223,10 +235,6 @@ void generateSphereMesh(
     prim->addMeshDrawData(indices.size(), 0, 0);
     prim->setTopology(backend::PrimitiveTopology::TriangleStrip);
     prim->enablePrimitiveRestart();
-
-    // we have uploaded the data to the device so no longer need the allocated
-    // space
-    delete[] buffer;
 }
 
 void generateCapsuleMesh(
@@ -327,16 +335,16 @@ void generateCapsuleMesh(
 
     // interleave data
     const uint32_t vertexCount = static_cast<uint32_t>(positions.size());
-    float* buffer =
+    std::vector<uint8_t> buffer =
         generateInterleavedData(positions.data(), texCoords.data(), normals.data(), vertexCount);
 
     vBuffer->addAttribute(
         yave::VertexBuffer::BindingType::Position, backend::BufferElementType::Float3);
-    vBuffer->addAttribute(yave::VertexBuffer::BindingType::Uv, backend::BufferElementType::Float2);
+    vBuffer->addAttribute(yave::VertexBuffer::BindingType::Uv, backend::BufferElementType::Half2);
     vBuffer->addAttribute(
-        yave::VertexBuffer::BindingType::Normal, backend::BufferElementType::Float3);
+        yave::VertexBuffer::BindingType::Normal, backend::BufferElementType::Snorm16x2);
 
-    vBuffer->build(engine, vertexCount * 32, (void*)buffer);
+    vBuffer->build(engine, static_cast<uint32_t>(buffer.size()), buffer.data());
 
     iBuffer->build(
         engine,
@@ -345,10 +353,6 @@ void generateCapsuleMesh(
         backend::IndexBufferType::Uint32);
 
     prim->addMeshDrawData(indices.size(), 0, 0);
-
-    // we have uploaded the data to the device so no longer need the allocated
-    // space
-    delete[] buffer;
 }
 
 void generateCubeMesh(
@@ -458,14 +462,15 @@ void generateCubeMesh(
 
     // interleave data
     const uint32_t vertexCount = static_cast<uint32_t>(normals.size());
-    float* buffer = generateInterleavedData(positions, texCoords, normals.data(), vertexCount);
+    std::vector<uint8_t> buffer =
+        generateInterleavedData(positions, texCoords, normals.data(), vertexCount);
 
     vBuffer->addAttribute(
         yave::VertexBuffer::BindingType::Position, backend::BufferElementType::Float3);
-    vBuffer->addAttribute(yave::VertexBuffer::BindingType::Uv, backend::BufferElementType::Float2);
+    vBuffer->addAttribute(yave::VertexBuffer::BindingType::Uv, backend::BufferElementType::Half2);
     vBuffer->addAttribute(
-        yave::VertexBuffer::BindingType::Normal, backend::BufferElementType::Float3);
-    vBuffer->build(engine, vertexCount * 32, (void*)buffer);
+        yave::VertexBuffer::BindingType::Normal, backend::BufferElementType::Snorm16x2);
+    vBuffer->build(engine, static_cast<uint32_t>(buffer.size()), buffer.data());
 
     iBuffer->build(
         engine,
@@ -474,10 +479,6 @@ void generateCubeMesh(
         backend::IndexBufferType::Uint32);
 
     prim->addMeshDrawData(indices.size(), 0, 0);
-
-    // we have uploaded the data to the device so no longer need the allocated
-    // space
-    delete[] buffer;
 }
 
 
@@ -6,4 +6,24 @@
 
 #define GRAVITY 9.81
 
+// The unnormalised direction through the point uv ([-1, 1]) on a cube map
+// face, following the Vulkan face order (+x, -x, +y, -y, +z, -z).
+vec3 getCubeDirection(int face, vec2 uv)
+{
+    switch (face)
+    {
+        case 0:
+            return vec3(1.0, -uv.y, -uv.x);
+        case 1:
+            return vec3(-1.0, -uv.y, uv.x);
+        case 2:
+            return vec3(uv.x, 1.0, uv.y);
+        case 3:
+            return vec3(uv.x, -1.0, -uv.y);
+        case 4:
+            return vec3(uv.x, -uv.y, 1.0);
+    }
+    return vec3(-uv.x, -uv.y, -1.0);
+}
+
 #endif
\ No newline at end of file
@@ -15,6 +15,32 @@ layout(constant_id = 2) const int LightTypeDir = 2;
 layout(constant_id = 3) const int BufferEndSignal = 255;
 
 #if defined(IBL_ENABLED)
+// Evaluates the L2 spherical harmonic irradiance in the direction of the
+// normal. The coefficients are pre-convolved with the cosine lobe and divided
+// by pi, so the result matches a sample of the irradiance map.
+vec3 evaluateIrradianceSh(vec3 N)
+{
+    vec3 result = scene_ubo.irradianceSh[0].rgb * 0.282095;
+    result += scene_ubo.irradianceSh[1].rgb * 0.488603 * N.y;
+    result += scene_ubo.irradianceSh[2].rgb * 0.488603 * N.z;
+    result += scene_ubo.irradianceSh[3].rgb * 0.488603 * N.x;
+    result += scene_ubo.irradianceSh[4].rgb * 1.092548 * N.x * N.y;
+    result += scene_ubo.irradianceSh[5].rgb * 1.092548 * N.y * N.z;
+    result += scene_ubo.irradianceSh[6].rgb * 0.315392 * (3.0 * N.z * N.z - 1.0);
+    result += scene_ubo.irradianceSh[7].rgb * 1.092548 * N.x * N.z;
+    result += scene_ubo.irradianceSh[8].rgb * 0.546274 * (N.x * N.x - N.y * N.y);
+    return max(result, vec3(0.0));
+}
+
+vec3 getIrradiance(vec3 N)
+{
+    if (scene_ubo.useIrradianceSh != 0)
+    {
+        return evaluateIrradianceSh(N);
+    }
+    return texture(IrradianceSampler, N).rgb;
+}
+
 vec3 calculateIBL(vec3 N, float NdotV, float roughness, vec3 reflection, vec3 diffuseColour, vec3 specularColour)
 {	
 	vec3 bdrf = (texture(BrdfSampler, vec2(NdotV, 1.0 - roughness))).rgb;
@@ -33,7 +59,7 @@ vec3 calculateIBL(vec3 N, float NdotV, float roughness, vec3 reflection, vec3 di
 	vec3 specular = specularLight * (specularColour * bdrf.x + bdrf.y);
 	
 	// diffuse contribution
-	vec3 diffuseLight = texture(IrradianceSampler, N).rgb;
+	vec3 diffuseLight = getIrradiance(N);
 	vec3 diffuse = diffuseLight * diffuseColour;
 	
 	return diffuse + specular;
@@ -144,7 +170,7 @@ void main()
     vec3 kD = 1.0 - kS;
     kD *= 1.0 - metallic;	  
     
-    vec3 irradiance = texture(IrradianceSampler, N).rgb;
+    vec3 irradiance = getIrradiance(N);
     vec3 diffuse = irradiance * baseColour;
     
     const float maxLod = scene_ubo.iblMipLevels;
@@ -163,6 +163,11 @@ void main()
         diffuse.a);
 #endif
 
+    // the per-instance overrides scale the values of the shared material
+    baseColour *= mesh_ubo.baseColourFactor;
+    roughness = clamp(roughness * mesh_ubo.pbrFactors.x, 0.0, 1.0);
+    metallic = clamp(metallic * mesh_ubo.pbrFactors.y, 0.0, 1.0);
+
 // =========== fragment outputs ====================
 
     outColour = baseColour;
@@ -189,7 +194,7 @@ void main()
 #elif defined(HAS_EMISSIVE_FACTOR)
     emissive = material_ubo.emissiveFactor.rgb;
 #endif
-    outEmissive = vec4(emissive, 1.0);
+    outEmissive = vec4(emissive * mesh_ubo.emissiveFactor.rgb, 1.0);
 #endif
 
     materialFragment();
@@ -1,10 +1,14 @@
-#if defined(HAS_POS_ATTR_INPUT)
+#if defined(HAS_QUANTISED_POS_INPUT)
+layout(location = 0) in vec4 inPos;
+#elif defined(HAS_POS_ATTR_INPUT)
 layout(location = 0) in vec3 inPos;
 #endif
 #if defined(HAS_UV_ATTR_INPUT)
 layout(location = 1) in vec2 inUv;
 #endif
-#if defined(HAS_NORMAL_ATTR_INPUT)
+#if defined(HAS_OCT_NORMAL_INPUT)
+layout(location = 2) in vec2 inNormal;
+#elif defined(HAS_NORMAL_ATTR_INPUT)
 layout(location = 2) in vec3 inNormal;
 #endif
 #if defined(HAS_COLOUR_ATTR_INPUT)
@@ -12,8 +16,12 @@ layout(location = 3) in vec4 inColour;
 #endif
 #if defined(HAS_SKIN)
 layout(location = 4) in vec4 inWeights;
+#if defined(HAS_UINT_BONES_INPUT)
+layout(location = 5) in uvec4 inBoneId;
+#else
 layout(location = 5) in vec4 inBoneId;
 #endif
+#endif
 
 #if defined(HAS_UV_ATTR_INPUT)
 layout(location = 0) out vec2 outUv;
@@ -32,8 +40,25 @@ layout(location = 3) out vec3 outPos;
 
 #define MAX_BONES 250
 
+#if defined(HAS_OCT_NORMAL_INPUT)
+// unfolds an octahedral encoded normal
+vec3 octDecode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += mix(vec2(t), vec2(-t), greaterThanEqual(n.xy, vec2(0.0)));
+    return normalize(n);
+}
+#endif
+
 void main()
 {
+#if defined(HAS_QUANTISED_POS_INPUT)
+    vec3 position = mesh_ubo.positionOffset.xyz + inPos.xyz * mesh_ubo.positionScale.xyz;
+#elif defined(HAS_POS_ATTR_INPUT)
+    vec3 position = inPos;
+#endif
+
 #if defined(HAS_SKIN)
     mat4 boneTransform = skin_ubo.bones[int(inBoneId.x)] * inWeights.x;
     boneTransform += skin_ubo.bones[int(inBoneId.y)] * inWeights.y;
@@ -41,9 +66,10 @@ void main()
     boneTransform += skin_ubo.bones[int(inBoneId.w)] * inWeights.w;
 
     mat4 normalTransform = scene_ubo.model * boneTransform;
+    vec4 pos = normalTransform * vec4(position, 1.0);
 #elif defined(HAS_POS_ATTR_INPUT)
     mat4 normalTransform = scene_ubo.model;
-    vec4 pos = normalTransform * vec4(inPos, 1.0);
+    vec4 pos = normalTransform * vec4(position, 1.0);
 #else
     vec4 pos = vec4(0.0);
 #endif
@@ -51,7 +77,12 @@ void main()
 #if defined(HAS_NORMAL_ATTR_INPUT)
     // inverse-transpose for non-uniform scaling - expensive computations here -
     // maybe remove this?
-    outNormal = normalize(transpose(inverse(mat3(normalTransform))) * inNormal);
+#if defined(HAS_OCT_NORMAL_INPUT)
+    vec3 normal = octDecode(inNormal);
+#else
+    vec3 normal = inNormal;
+#endif
+    outNormal = normalize(transpose(inverse(mat3(normalTransform))) * normal);
 #endif
 #if defined(HAS_UV_ATTR_INPUT)
     outUv = inUv;
@@ -2,8 +2,10 @@
 
 void materialVertex(vec4 pos)
 {
-    gl_Position = vec4(inPos, 1.0);
+    // the clipmap is centred on the camera
+    gl_Position = vec4(inPos.x + material_ubo.gridOffset.x, inPos.y, inPos.z + material_ubo.gridOffset.y, 1.0);
 	
+	// the position relative to the clipmap is used to match the edges of the rings
 	outPos = inPos;
 	outUv = inUv;
 }
@@ -33,37 +35,107 @@ float screenSpaceTessFactor(vec4 p0, vec4 p1)
 	return clamp(distance(clip0, clip1) / material_ubo.tessEdgeSize * material_ubo.tessFactor, 1.0, 64.0);
 }
 
-void materialTessControl()
+// The tessellation limit of the ring - the coarser rings are further from the
+// camera so are limited to fewer subdivisions.
+float ringTessLimit(float ring)
 {
-    if(gl_InvocationID == 0) 
+    return max(material_ubo.maxTessLevel * pow(material_ubo.ringTessFalloff, ring), 2.0);
+}
+
+// The factors are rounded to a power of two of at least two, so an edge of a
+// coarser patch can be split exactly in half between the finer patches along it.
+float edgeTessFactor(vec4 p0, vec4 p1, float ring)
+{
+    float factor = exp2(round(log2(screenSpaceTessFactor(p0, p1))));
+    float limit = exp2(floor(log2(ringTessLimit(ring))));
+    return clamp(factor, 2.0, limit);
+}
+
+vec4 toWorldPos(vec3 pos)
+{
+    return vec4(pos.x + material_ubo.gridOffset.x, pos.y, pos.z + material_ubo.gridOffset.y, 1.0);
+}
+
+// The factor of an edge on the outer edge of a ring - half that of the edge of
+// the coarser patch which contains it, so the vertices of both line up.
+float boundaryTessFactor(vec3 p0, vec3 p1, float ring)
+{
+    float coarseSize = material_ubo.clipmapPatchSize * exp2(ring + 1.0);
+    vec3 c0 = min(p0, p1);
+    vec3 c1 = max(p0, p1);
+    if (c1.x - c0.x > c1.z - c0.z)
+    {
+        c0.x = floor(c0.x / coarseSize + 0.25) * coarseSize;
+        c1.x = c0.x + coarseSize;
+    }
+    else
     {
-        /*vec4 vp00 = scene_ubo.view * gl_in[0].gl_Position;
-        vec4 vp01 = scene_ubo.view * gl_in[1].gl_Position;
-        vec4 vp10 = scene_ubo.view * gl_in[2].gl_Position;
-        vec4 vp11 = scene_ubo.view * gl_in[3].gl_Position;
-        
-        float d00 = clamp((abs(vp00.z) - material_ubo.minDistance) / (material_ubo.maxDistance - material_ubo.minDistance), 0.0, 1.0);
-        float d01 = clamp((abs(vp01.z) - material_ubo.minDistance) / (material_ubo.maxDistance - material_ubo.minDistance), 0.0, 1.0);
-        float d10 = clamp((abs(vp10.z) - material_ubo.minDistance) / (material_ubo.maxDistance - material_ubo.minDistance), 0.0, 1.0);
-        float d11 = clamp((abs(vp11.z) - material_ubo.minDistance) / (material_ubo.maxDistance - material_ubo.minDistance), 0.0, 1.0);
-
-        float tessFactor0 = mix(material_ubo.maxTessLevel, material_ubo.minTessLevel, min(d10, d00));
-        float tessFactor1 = mix(material_ubo.maxTessLevel, material_ubo.minTessLevel, min(d00, d01));
-        float tessFactor2 = mix(material_ubo.maxTessLevel, material_ubo.minTessLevel, min(d01, d11));
-        float tessFactor3 = mix(material_ubo.maxTessLevel, material_ubo.minTessLevel, min(d11, d10));
-
-        gl_TessLevelOuter[0] = tessFactor0;
-        gl_TessLevelOuter[1] = tessFactor1;
-        gl_TessLevelOuter[2] = tessFactor2;
-        gl_TessLevelOuter[3] = tessFactor3;
+        c0.z = floor(c0.z / coarseSize + 0.25) * coarseSize;
+        c1.z = c0.z + coarseSize;
+    }
+    return 0.5 * edgeTessFactor(toWorldPos(c0), toWorldPos(c1), ring + 1.0);
+}
 
-        gl_TessLevelInner[0] = mix(gl_TessLevelOuter[0], gl_TessLevelOuter[3], 0.5);
-        gl_TessLevelInner[1] = mix(gl_TessLevelOuter[2], gl_TessLevelOuter[1], 0.5);*/
+// Tests the bounds of the patch against the frustum, with the bounds expanded
+// to cover the displacement of the surface.
+bool patchVisible()
+{
+    vec3 minPos = min(
+        min(gl_in[0].gl_Position.xyz, gl_in[1].gl_Position.xyz),
+        min(gl_in[2].gl_Position.xyz, gl_in[3].gl_Position.xyz));
+    vec3 maxPos = max(
+        max(gl_in[0].gl_Position.xyz, gl_in[1].gl_Position.xyz),
+        max(gl_in[2].gl_Position.xyz, gl_in[3].gl_Position.xyz));
+
+    vec3 centre = 0.5 * (minPos + maxPos);
+    vec3 extent = 0.5 * (maxPos - minPos) + vec3(material_ubo.cullMargin);
+
+    for (int i = 0; i < 6; ++i)
+    {
+        vec4 plane = material_ubo.frustumPlanes[i];
+        if (dot(plane.xyz, centre) - dot(abs(plane.xyz), extent) + plane.w > 0.0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
 
-        gl_TessLevelOuter[0] = screenSpaceTessFactor(gl_in[3].gl_Position, gl_in[0].gl_Position);
-        gl_TessLevelOuter[1] = screenSpaceTessFactor(gl_in[0].gl_Position, gl_in[1].gl_Position);
-        gl_TessLevelOuter[2] = screenSpaceTessFactor(gl_in[1].gl_Position, gl_in[2].gl_Position);
-        gl_TessLevelOuter[3] = screenSpaceTessFactor(gl_in[2].gl_Position, gl_in[3].gl_Position);
+void materialTessControl()
+{
+    if(gl_InvocationID == 0) 
+    {
+        // a patch with zero tessellation levels is discarded
+        if (!patchVisible())
+        {
+            gl_TessLevelOuter[0] = 0.0;
+            gl_TessLevelOuter[1] = 0.0;
+            gl_TessLevelOuter[2] = 0.0;
+            gl_TessLevelOuter[3] = 0.0;
+            gl_TessLevelInner[0] = 0.0;
+            gl_TessLevelInner[1] = 0.0;
+            return;
+        }
+
+        // the ring and the mask of edges bordering the coarser ring
+        float ring = inUv[0].x;
+        int edgeMask = int(inUv[0].y + 0.5);
+
+        // the corners of the edge of each outer level
+        const int edgeCorners[8] = int[8](3, 0, 0, 1, 1, 2, 2, 3);
+        for (int i = 0; i < 4; ++i)
+        {
+            int c0 = edgeCorners[i * 2];
+            int c1 = edgeCorners[i * 2 + 1];
+            if ((edgeMask & (1 << i)) != 0)
+            {
+                gl_TessLevelOuter[i] = boundaryTessFactor(inPos[c0], inPos[c1], ring);
+            }
+            else
+            {
+                gl_TessLevelOuter[i] = edgeTessFactor(gl_in[c0].gl_Position, gl_in[c1].gl_Position, ring);
+            }
+        }
         gl_TessLevelInner[0] = mix(gl_TessLevelOuter[0], gl_TessLevelOuter[3], 0.5);
         gl_TessLevelInner[1] = mix(gl_TessLevelOuter[2], gl_TessLevelOuter[1], 0.5);
 	}
@@ -71,33 +143,88 @@ void materialTessControl()
 
 [[tesse-eval]]
 
+// The maps of cascade c are bound at 2 * c and 2 * c + 1 - these are double
+// buffered and blended by the cascade weight.
+vec4 sampleDisplacement(int index, vec2 uv)
+{
+    switch (index)
+    {
+        case 0: return textureLod(DisplacementMap0, uv, 0.0);
+        case 1: return textureLod(DisplacementMap1, uv, 0.0);
+        case 2: return textureLod(DisplacementMap2, uv, 0.0);
+        case 3: return textureLod(DisplacementMap3, uv, 0.0);
+        case 4: return textureLod(DisplacementMap4, uv, 0.0);
+        case 5: return textureLod(DisplacementMap5, uv, 0.0);
+        case 6: return textureLod(DisplacementMap6, uv, 0.0);
+        default: return textureLod(DisplacementMap7, uv, 0.0);
+    }
+}
+
 void materialTessEval(TessEvalInput tessInput)
 {	
+    // sum the displacement of each cascade - the maps are tiled over the
+    // patch at the size of the cascade
+    vec3 displacement = vec3(0.0);
+    for (int c = 0; c < material_ubo.cascadeCount; ++c)
+    {
+        vec2 uv = tessInput.pos.xz / material_ubo.patchSizes[c];
+        vec3 prev = sampleDisplacement(c * 2, uv).xyz;
+        vec3 next = sampleDisplacement(c * 2 + 1, uv).xyz;
+        displacement += mix(prev, next, material_ubo.cascadeWeights[c]);
+    }
+
+    // the fragment shader samples the cascades with the undisplaced position
+    outUv = tessInput.pos.xz;
+
 	// displace the y coord depending on height derived from map
-    vec2 displacement = textureLod(DisplacementMap, tessInput.uv, 0.0).yz;
-	tessInput.pos.y = textureLod(DisplacementMap, tessInput.uv, 0.0).r * material_ubo.dispFactor;
-    tessInput.pos.x += displacement.x;
-    tessInput.pos.z += displacement.y;
+	tessInput.pos.y = displacement.x * material_ubo.dispFactor;
+    tessInput.pos.x += displacement.y;
+    tessInput.pos.z += displacement.z;
 
 	// convert everything to world space
 	gl_Position = scene_ubo.project * scene_ubo.view * tessInput.pos;
 	
 	// position (world space)
 	outPos = vec3(scene_ubo.model * tessInput.pos);
-
-    outUv = tessInput.uv;
 }
 
 [[fragment]]
 
+vec4 sampleGradient(int index, vec2 uv)
+{
+    switch (index)
+    {
+        case 0: return texture(GradientMap0, uv);
+        case 1: return texture(GradientMap1, uv);
+        case 2: return texture(GradientMap2, uv);
+        case 3: return texture(GradientMap3, uv);
+        case 4: return texture(GradientMap4, uv);
+        case 5: return texture(GradientMap5, uv);
+        case 6: return texture(GradientMap6, uv);
+        default: return texture(GradientMap7, uv);
+    }
+}
+
 void materialFragment()
 {
-    vec2 gradient = texture(GradientMap, inUv).xy;
-    float jacobian = texture(GradientMap, inUv).z;
-    vec2 N = texture(NormalMap, inUv).xy;
-    
-    vec2 noiseGradient = 0.30 * N;
-    float turbulence = max(2.0 - jacobian + dot(abs(noiseGradient), vec2(1.2)), 0.0);
+    // the gradients are scaled to the texel size of the coarsest cascade,
+    // whereas the jacobians are combined by summing the deviation from one
+    vec2 gradient = vec2(0.0);
+    float jacobian = 1.0;
+    float noiseGradient = 0.0;
+    for (int c = 0; c < material_ubo.cascadeCount; ++c)
+    {
+        vec2 uv = inUv / material_ubo.patchSizes[c];
+        vec4 prev = sampleGradient(c * 2, uv);
+        vec4 next = sampleGradient(c * 2 + 1, uv);
+        vec4 g = mix(prev, next, material_ubo.cascadeWeights[c]);
+
+        gradient += g.xy * material_ubo.gradientScales[c];
+        jacobian += g.z - 1.0;
+        noiseGradient += g.w;
+    }
+
+    float turbulence = max(2.0 - jacobian + 0.36 * noiseGradient, 0.0);
 
     float colourMod = 1.0 + 3.0 * smoothstep(1.2, 1.8, turbulence);
 	
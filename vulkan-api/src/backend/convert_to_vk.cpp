@@ -310,6 +310,38 @@ vk::Format textureFormatToVk(backend::TextureFormat type)
         case backend::TextureFormat::RGBA32F:
             output = vk::Format::eR32G32B32A32Sfloat;
             break;
+        case backend::TextureFormat::BC1:
+            output = vk::Format::eBc1RgbUnormBlock;
+            break;
+        case backend::TextureFormat::BC3:
+            output = vk::Format::eBc3UnormBlock;
+            break;
+        case backend::TextureFormat::BC4:
+            output = vk::Format::eBc4UnormBlock;
+            break;
+        case backend::TextureFormat::BC5:
+            output = vk::Format::eBc5UnormBlock;
+            break;
+        case backend::TextureFormat::BC7:
+            output = vk::Format::eBc7UnormBlock;
+            break;
+        case backend::TextureFormat::ETC2_RGB8:
+            output = vk::Format::eEtc2R8G8B8UnormBlock;
+            break;
+        case backend::TextureFormat::ETC2_RGBA8:
+            output = vk::Format::eEtc2R8G8B8A8UnormBlock;
+            break;
+        case backend::TextureFormat::EAC_R11:
+            output = vk::Format::eEacR11UnormBlock;
+            break;
+        case backend::TextureFormat::EAC_RG11:
+            output = vk::Format::eEacR11G11UnormBlock;
+            break;
+        case backend::TextureFormat::ASTC_4x4:
+            output = vk::Format::eAstc4x4UnormBlock;
+            break;
+        case backend::TextureFormat::Undefined:
+            break;
     }
     return output;
 }
@@ -88,4 +88,55 @@ backend::PrimitiveTopology primitiveTopologyToYave(yave::ModelMesh::Topology top
     return output;
 }
 
+backend::BufferElementType vertexAttributeToYave(yave::ModelMesh::VertexBuffer::Attribute attr)
+{
+    backend::BufferElementType output;
+    switch (attr)
+    {
+        case yave::ModelMesh::VertexBuffer::Attribute::Float:
+            output = BufferElementType::Float;
+            break;
+        case yave::ModelMesh::VertexBuffer::Attribute::Int:
+            output = BufferElementType::Int;
+            break;
+        case yave::ModelMesh::VertexBuffer::Attribute::Vec2:
+            output = BufferElementType::Float2;
+            break;
+        case yave::ModelMesh::VertexBuffer::Attribute::Vec3:
+            output = BufferElementType::Float3;
+            break;
+        case yave::ModelMesh::VertexBuffer::Attribute::Vec4:
+            output = BufferElementType::Float4;
+            break;
+        case yave::ModelMesh::VertexBuffer::Attribute::Mat3:
+            output = BufferElementType::Mat3;
+            break;
+        case yave::ModelMesh::VertexBuffer::Attribute::Mat4:
+            output = BufferElementType::Mat4;
+            break;
+        case yave::ModelMesh::VertexBuffer::Attribute::Half2:
+            output = BufferElementType::Half2;
+            break;
+        case yave::ModelMesh::VertexBuffer::Attribute::Snorm16x2:
+            output = BufferElementType::Snorm16x2;
+            break;
+        case yave::ModelMesh::VertexBuffer::Attribute::Unorm16x2:
+            output = BufferElementType::Unorm16x2;
+            break;
+        case yave::ModelMesh::VertexBuffer::Attribute::Unorm16x4:
+            output = BufferElementType::Unorm16x4;
+            break;
+        case yave::ModelMesh::VertexBuffer::Attribute::Unorm8x4:
+            output = BufferElementType::Unorm8x4;
+            break;
+        case yave::ModelMesh::VertexBuffer::Attribute::Uint8x4:
+            output = BufferElementType::Uint8x4;
+            break;
+        case yave::ModelMesh::VertexBuffer::Attribute::Uint16x4:
+            output = BufferElementType::Uint16x4;
+            break;
+    }
+    return output;
+}
+
 } // namespace backend
@@ -36,4 +36,6 @@ backend::SamplerAddressMode samplerWrapModeToYave(yave::ModelMaterial::Sampler::
 
 backend::PrimitiveTopology primitiveTopologyToYave(yave::ModelMesh::Topology topo);
 
+backend::BufferElementType vertexAttributeToYave(yave::ModelMesh::VertexBuffer::Attribute attr);
+
 } // namespace backend
\ No newline at end of file
@@ -128,6 +128,14 @@ enum class BufferElementType
     Float4,
     Mat3,
     Mat4,
+    // quantised formats - only valid as vertex attributes
+    Half2,
+    Snorm16x2,
+    Unorm16x2,
+    Unorm16x4,
+    Unorm8x4,
+    Uint8x4,
+    Uint16x4,
     Struct
 };
 
@@ -157,9 +165,30 @@ enum class TextureFormat
     RGBA8,
     RGBA16F,
     RGBA32F,
+    // block compressed formats - 4x4 texel blocks
+    BC1,
+    BC3,
+    BC4,
+    BC5,
+    BC7,
+    ETC2_RGB8,
+    ETC2_RGBA8,
+    EAC_R11,
+    EAC_RG11,
+    ASTC_4x4,
     Undefined
 };
 
+// The filter used when generating mip levels. Min and max are used for
+// reduction chains such as a hierarchical depth buffer.
+enum class MipFilter
+{
+    Box,
+    Kaiser,
+    Min,
+    Max
+};
+
 enum class IndexBufferType
 {
     Uint32,
@@ -26,15 +26,20 @@
 #include "common.h"
 #include "context.h"
 #include "driver.h"
+#include "garbage_collector.h"
 #include "utility/assertion.h"
 
+#include <algorithm>
 #include <cstring>
 
 namespace vkapi
 {
 
 // ================== StagingPool =======================
-StagingPool::StagingPool(VmaAllocator& vmaAlloc) : vmaAlloc_(vmaAlloc) {}
+StagingPool::StagingPool(VmaAllocator& vmaAlloc, MemoryTracker& tracker)
+    : vmaAlloc_(vmaAlloc), tracker_(tracker)
+{
+}
 
 StagingPool::StageInfo* StagingPool::create(const VkDeviceSize size)
 {
@@ -49,17 +54,16 @@ StagingPool::StageInfo* StagingPool::create(const VkDeviceSize size)
     bufferInfo.size = size;
 
     // cpu staging pool
-    VmaAllocationCreateInfo createInfo = {};
-    createInfo.usage = VMA_MEMORY_USAGE_AUTO;
-    createInfo.flags =
-        VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    VmaAllocationCreateInfo createInfo =
+        MemoryTracker::getAllocationCreateInfo(MemoryUsage::DynamicUpload);
     VMA_CHECK_RESULT(vmaCreateBuffer(
         vmaAlloc_, &bufferInfo, &createInfo, &stage->buffer, &stage->mem, &stage->allocInfo));
+    tracker_.add(vmaAlloc_, stage->mem, MemoryUsage::DynamicUpload);
 
     return stage;
 }
 
-StagingPool::StageInfo* StagingPool::getStage(VkDeviceSize reqSize)
+StagingPool::StageInfo* StagingPool::getStage(VkDeviceSize reqSize, uint64_t currentFrame)
 {
     // check for a free staging space that is equal or greater than the required
     // size
@@ -75,11 +79,13 @@ StagingPool::StageInfo* StagingPool::getStage(VkDeviceSize reqSize)
     {
         StageInfo* stage = *iter;
         freeStages_.erase(iter);
+        stage->frameLastUsed = currentFrame;
         inUseStages_.insert(stage);
         return stage;
     }
 
     StageInfo* newStage = create(reqSize);
+    newStage->frameLastUsed = currentFrame;
     inUseStages_.insert(newStage);
     return newStage;
 }
@@ -93,12 +99,13 @@ void StagingPool::garbageCollection(uint64_t currentFrame)
         uint64_t collectionFrame = stage->frameLastUsed + Commands::MaxCommandBufferSize;
         if (collectionFrame < currentFrame)
         {
+            tracker_.remove(vmaAlloc_, stage->mem);
             vmaDestroyBuffer(vmaAlloc_, stage->buffer, stage->mem);
             delete stage;
         }
         else
         {
-            freeStages_.emplace_back(stage);
+            newFreeStages.emplace_back(stage);
         }
     }
     freeStages_.swap(newFreeStages);
@@ -119,18 +126,26 @@ void StagingPool::garbageCollection(uint64_t currentFrame)
         }
     }
     inUseStages_.swap(newInUseStages);
+
+    // the free stages are searched by size
+    std::sort(
+        freeStages_.begin(), freeStages_.end(), [](const StageInfo* lhs, const StageInfo* rhs) {
+            return lhs->size < rhs->size;
+        });
 }
 
 void StagingPool::clear()
 {
     for (const auto* stage : freeStages_)
     {
+        tracker_.remove(vmaAlloc_, stage->mem);
         vmaDestroyBuffer(vmaAlloc_, stage->buffer, stage->mem);
         delete stage;
     }
 
     for (auto* stage : inUseStages_)
     {
+        tracker_.remove(vmaAlloc_, stage->mem);
         vmaDestroyBuffer(vmaAlloc_, stage->buffer, stage->mem);
         delete stage;
     }
@@ -141,22 +156,25 @@ void StagingPool::clear()
 Buffer::Buffer() = default;
 
 void Buffer::alloc(
-    VmaAllocator& vmaAlloc, vk::DeviceSize buffSize, VkBufferUsageFlags usage) noexcept
+    VkDriver& driver,
+    vk::DeviceSize buffSize,
+    VkBufferUsageFlags usage,
+    MemoryUsage memUsage) noexcept
 {
     size_ = buffSize;
+    memUsage_ = memUsage;
 
     VkBufferCreateInfo bufferInfo = {};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     bufferInfo.size = buffSize;
     bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | usage;
 
-    VmaAllocationCreateInfo allocCreateInfo = {};
-    allocCreateInfo.usage = VMA_MEMORY_USAGE_AUTO;
-    allocCreateInfo.flags =
-        VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    VmaAllocationCreateInfo allocCreateInfo = MemoryTracker::getAllocationCreateInfo(memUsage);
 
+    VmaAllocator& vmaAlloc = driver.vmaAlloc();
     VMA_CHECK_RESULT(
         vmaCreateBuffer(vmaAlloc, &bufferInfo, &allocCreateInfo, &buffer_, &mem_, &allocInfo_));
+    driver.memoryTracker().add(vmaAlloc, mem_, memUsage);
 }
 
 void Buffer::mapToStage(void* data, size_t dataSize, StagingPool::StageInfo* stage) noexcept
@@ -168,25 +186,31 @@ void Buffer::mapToStage(void* data, size_t dataSize, StagingPool::StageInfo* sta
 void Buffer::mapToGpuBuffer(void* data, size_t dataSize) const noexcept
 {
     ASSERT_FATAL(data, "Data pointer is nullptr for buffer mapping.");
+    ASSERT_FATAL(isMapped(), "Buffer is not host visible - it must be written via a stage.");
     memcpy(allocInfo_.pMappedData, data, dataSize);
 }
 
 void Buffer::mapAndCopyToGpu(
     VkDriver& driver, VkDeviceSize size, VkBufferUsageFlags usage, void* data)
 {
-    StagingPool::StageInfo* stage = driver.stagingPool().getStage(size);
+    StagingPool::StageInfo* stage =
+        driver.stagingPool().getStage(size, driver.getCurrentFrame());
     mapToStage(data, size, stage);
     copyStagedToGpu(driver, size, stage, usage);
 }
 
 void Buffer::copyStagedToGpu(
-    VkDriver& driver, VkDeviceSize size, StagingPool::StageInfo* stage, VkBufferUsageFlags usage)
+    VkDriver& driver,
+    VkDeviceSize size,
+    StagingPool::StageInfo* stage,
+    VkBufferUsageFlags usage,
+    VkDeviceSize dstOffset)
 {
     // copy from the staging area to the allocated GPU memory
     auto& cmds = driver.getCommands();
     auto& cmd = cmds.getCmdBuffer();
 
-    vk::BufferCopy copyRegion {0, 0, size};
+    vk::BufferCopy copyRegion {0, dstOffset, size};
     cmd.cmdBuffer.copyBuffer(stage->buffer, buffer_, 1, &copyRegion);
 
     vk::BufferMemoryBarrier memBarrier {};
@@ -255,6 +279,7 @@ void Buffer::downloadToHost(VkDriver& driver, void* hostBuffer, size_t dataSize)
 {
     ASSERT_FATAL(hostBuffer, "Host buffer point is NULL");
     ASSERT_FATAL(dataSize > 0, "Data size to download must be greater than zero");
+    ASSERT_FATAL(isMapped(), "Buffer is not host visible - unable to download to host.");
 
     auto& cmds = driver.getCommands();
     auto& cmd = cmds.getCmdBuffer();
@@ -274,53 +299,23 @@ void Buffer::downloadToHost(VkDriver& driver, void* hostBuffer, size_t dataSize)
     memcpy(hostBuffer, allocInfo_.pMappedData, dataSize);
 }
 
-void Buffer::destroy(VmaAllocator& vmaAlloc) noexcept { vmaDestroyBuffer(vmaAlloc, buffer_, mem_); }
-
-vk::Buffer Buffer::get() { return vk::Buffer {buffer_}; }
-
-uint64_t Buffer::getSize() const { return size_; }
-
-// ================ Vertex buffer =======================
-// Note: The following functions use VMA hence don't use the vulkan hpp C++
-// style vulkan bindings. Hence, the code has been left in this verbose format -
-// as it doesn't follow the format of the rest of the codebase
-
-void VertexBuffer::create(
-    VkDriver& driver,
-    VmaAllocator& vmaAlloc,
-    StagingPool& pool,
-    void* data,
-    const VkDeviceSize dataSize)
+void Buffer::destroy(VkDriver& driver) noexcept
 {
-    ASSERT_FATAL(data, "Data pointer is nullptr for buffer copy.");
-
-    // get a staging pool for hosting on the CPU side
-    StagingPool::StageInfo* stage = pool.getStage(dataSize);
-
-    mapToStage(data, dataSize, stage);
-    alloc(vmaAlloc, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, dataSize);
-    copyStagedToGpu(driver, dataSize, stage, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+    driver.memoryTracker().remove(driver.vmaAlloc(), mem_);
+    vmaDestroyBuffer(driver.vmaAlloc(), buffer_, mem_);
+    buffer_ = VK_NULL_HANDLE;
+    mem_ = VK_NULL_HANDLE;
 }
 
-// ======================= IndexBuffer ================================
-
-void IndexBuffer::create(
-    VkDriver& driver,
-    VmaAllocator& vmaAlloc,
-    StagingPool& pool,
-    void* data,
-    const VkDeviceSize dataSize)
+void Buffer::destroy(GarbageCollector& gc) noexcept
 {
-    ASSERT_FATAL(data, "Data pointer is nullptr for index buffer initialisation.");
-
-    // get a staging pool for hosting on the CPU side
-    StagingPool::StageInfo* stage = pool.getStage(dataSize);
-    ASSERT_LOG(stage);
-
-    mapToStage(data, dataSize, stage);
-    alloc(vmaAlloc, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, dataSize);
-    copyStagedToGpu(driver, dataSize, stage, VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+    gc.add(buffer_, mem_);
+    buffer_ = VK_NULL_HANDLE;
+    mem_ = VK_NULL_HANDLE;
 }
 
+vk::Buffer Buffer::get() { return vk::Buffer {buffer_}; }
+
+uint64_t Buffer::getSize() const { return size_; }
 
 } // namespace vkapi
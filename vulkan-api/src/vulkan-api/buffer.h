@@ -23,6 +23,7 @@
 #pragma once
 
 #include "common.h"
+#include "memory.h"
 
 #include <unordered_set>
 #include <vector>
@@ -33,6 +34,7 @@ namespace vkapi
 // forward declarations
 class VkContext;
 class VkDriver;
+class GarbageCollector;
 
 /**
  * @brief A simplistic staging pool for CPU-only stages. Used when copying to and from
@@ -41,7 +43,7 @@ class VkDriver;
 class StagingPool
 {
 public:
-    explicit StagingPool(VmaAllocator& vmaAlloc);
+    StagingPool(VmaAllocator& vmaAlloc, MemoryTracker& tracker);
 
     struct StageInfo
     {
@@ -49,10 +51,12 @@ public:
         VkDeviceSize size;
         VmaAllocation mem;
         VmaAllocationInfo allocInfo;
-        uint64_t frameLastUsed;
+        uint64_t frameLastUsed = 0;
     };
 
-    StageInfo* getStage(VkDeviceSize reqSize);
+    // Returns a stage of at least the requested size. The stage is only
+    // reused once the frames that may be reading from it have completed.
+    StageInfo* getStage(VkDeviceSize reqSize, uint64_t currentFrame);
 
     StageInfo* create(VkDeviceSize size);
 
@@ -63,6 +67,7 @@ public:
 private:
     // keep a reference to the memory allocator here
     VmaAllocator& vmaAlloc_;
+    MemoryTracker& tracker_;
 
     // a list of free stages and their size
     std::vector<StageInfo*> freeStages_;
@@ -71,7 +76,9 @@ private:
 
 
 /** @brief A wrapper around a VkBuffer allowing easier mem allocation using VMA
- * This is for dynamic mem type allocation, i.e. uniform buffers, etc.
+ * The memory type is selected by the usage class - dynamic uniform buffers, etc.
+ * are persistently mapped whereas static resources are device local and must be
+ * filled via a staging copy.
  */
 class Buffer
 {
@@ -79,9 +86,17 @@ public:
     Buffer();
     virtual ~Buffer() = default;
 
-    void alloc(VmaAllocator& vmaAlloc, vk::DeviceSize size, VkBufferUsageFlags usage) noexcept;
+    void alloc(
+        VkDriver& driver,
+        vk::DeviceSize size,
+        VkBufferUsageFlags usage,
+        MemoryUsage memUsage = MemoryUsage::DynamicUpload) noexcept;
+
+    // destroys the buffer immediately - it must not be in use by the GPU
+    void destroy(VkDriver& driver) noexcept;
 
-    void destroy(VmaAllocator& vmaAlloc) noexcept;
+    // passes the buffer to the garbage collector for deferred destruction
+    void destroy(GarbageCollector& gc) noexcept;
 
     static void mapToStage(void* data, size_t size, StagingPool::StageInfo* stage) noexcept;
 
@@ -93,7 +108,8 @@ public:
         VkDriver& driver,
         VkDeviceSize size,
         StagingPool::StageInfo* stage,
-        VkBufferUsageFlags usage);
+        VkBufferUsageFlags usage,
+        VkDeviceSize dstOffset = 0);
 
     void mapAndCopyToGpu(VkDriver& driver, VkDeviceSize size, VkBufferUsageFlags usage, void* data);
 
@@ -101,34 +117,19 @@ public:
 
     [[nodiscard]] uint64_t getSize() const;
 
-    friend class ResourceCache;
-
-protected:
-    VmaAllocationInfo allocInfo_;
-    VmaAllocation mem_;
-    VkDeviceSize size_;
-    VkBuffer buffer_;
-
-    uint32_t framesUntilGc_;
-};
-
-class VertexBuffer : public Buffer
-{
-public:
-    VertexBuffer() = default;
-
-    void create(
-        VkDriver& driver, VmaAllocator& vmaAlloc, StagingPool& pool, void* data, VkDeviceSize size);
-};
+    // whether the buffer is host visible and can be written to directly
+    [[nodiscard]] bool isMapped() const noexcept { return allocInfo_.pMappedData != nullptr; }
 
+    [[nodiscard]] MemoryUsage getMemoryUsage() const noexcept { return memUsage_; }
 
-class IndexBuffer : public Buffer
-{
-public:
-    IndexBuffer() = default;
+    friend class ResourceCache;
 
-    void create(
-        VkDriver& driver, VmaAllocator& vmaAlloc, StagingPool& pool, void* data, VkDeviceSize size);
+protected:
+    VmaAllocationInfo allocInfo_ = {};
+    VmaAllocation mem_ = VK_NULL_HANDLE;
+    VkDeviceSize size_ = 0;
+    VkBuffer buffer_ = VK_NULL_HANDLE;
+    MemoryUsage memUsage_ = MemoryUsage::DynamicUpload;
 };
 
 } // namespace vkapi
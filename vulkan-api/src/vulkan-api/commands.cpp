@@ -140,7 +140,14 @@ void Commands::freeCmdBuffers()
         VK_CHECK_RESULT(context.device().waitForFences(count, fences, VK_TRUE, UINT64_MAX));
     }
 
-    // Get all currently allocated fences and wait for them to finish
+    releaseFinishedCmdBuffers();
+}
+
+void Commands::releaseFinishedCmdBuffers()
+{
+    auto& context = driver_.context();
+
+    // Poll all currently allocated fences and free those buffers which have finished
     for (auto& buffer : cmdBuffers_)
     {
         if (buffer.cmdBuffer)
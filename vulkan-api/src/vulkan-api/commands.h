@@ -74,8 +74,12 @@ public:
 
     CmdBuffer& getCmdBuffer();
 
+    // waits for all submitted cmd buffers to finish before freeing them.
     void freeCmdBuffers();
 
+    // frees any cmd buffers which have finished executing - non-blocking.
+    void releaseFinishedCmdBuffers();
+
     void flush();
 
     vk::Semaphore* getFinishedSignal() noexcept;
@@ -417,6 +417,10 @@ bool VkContext::prepareDevice(vk::SurfaceKHR windowSurface)
     {
         reqFeatures2.features.textureCompressionBC = VK_TRUE;
     }
+    if (devFeatures.textureCompressionASTC_LDR)
+    {
+        reqFeatures2.features.textureCompressionASTC_LDR = VK_TRUE;
+    }
     if (devFeatures.samplerAnisotropy)
     {
         reqFeatures2.features.samplerAnisotropy = VK_TRUE;
@@ -449,6 +453,12 @@ bool VkContext::prepareDevice(vk::SurfaceKHR windowSurface)
         }
         reqExtensions.emplace_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
     }
+    // allows VMA to query the actual heap usage and budget from the driver
+    if (findExtensionProperties(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME, extensions))
+    {
+        reqExtensions.emplace_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        deviceExtensions_.hasMemoryBudget = true;
+    }
 #if __APPLE__
     reqExtensions.emplace_back("VK_KHR_portability_subset");
 #endif
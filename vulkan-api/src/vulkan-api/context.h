@@ -42,6 +42,7 @@ public:
         bool hasExternalCapabilities = false;
         bool hasDebugUtils = false;
         bool hasMultiView = false;
+        bool hasMemoryBudget = false;
     };
 
     struct QueueInfo
@@ -91,6 +92,7 @@ public:
     [[nodiscard]] const vk::Device& device() const { return device_; }
     [[nodiscard]] const vk::PhysicalDevice& physical() const { return physical_; }
     [[nodiscard]] const vk::PhysicalDeviceFeatures& features() const { return features_; }
+    [[nodiscard]] const Extensions& deviceExtensions() const { return deviceExtensions_; }
     [[nodiscard]] const QueueInfo& queueIndices() const { return queueFamilyIndex_; }
     [[nodiscard]] const vk::Queue& graphicsQueue() const { return graphicsQueue_; }
     [[nodiscard]] const vk::Queue& presentQueue() const { return presentQueue_; }
@@ -39,6 +39,8 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+
 namespace vkapi
 {
 
@@ -52,6 +54,7 @@ VkDriver::VkDriver()
       pipelineCache_(std::make_unique<PipelineCache>(*context_, *this)),
       framebufferCache_(std::make_unique<FramebufferCache>(*context_, *this)),
       samplerCache_(std::make_unique<SamplerCache>(*this)),
+      gc_(*this),
       currentFrame_(0)
 {
 }
@@ -84,27 +87,36 @@ bool VkDriver::init(vk::SurfaceKHR surface)
     createInfo.physicalDevice = context_->physical();
     createInfo.device = context_->device();
     createInfo.instance = context_->instance();
+    if (context_->deviceExtensions().hasMemoryBudget)
+    {
+        createInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+    }
     VkResult result = vmaCreateAllocator(&createInfo, &vmaAlloc_);
     ASSERT_LOG(result == VK_SUCCESS);
 
     // create the staging pool
-    stagingPool_ = std::make_unique<StagingPool>(vmaAlloc_);
+    stagingPool_ = std::make_unique<StagingPool>(vmaAlloc_, memoryTracker_);
 
     // command buffers for graphics and presentation - we make the assumption
     // that both queues are the same which is the case on all common devices.
     commands_ = std::make_unique<Commands>(*this, context().graphicsQueue());
 
-    // create a semaphore for signalling that a image is ready for presentation
-    vk::SemaphoreCreateInfo semaphoreCreateInfo;
-    VK_CHECK_RESULT(
-        context().device().createSemaphore(&semaphoreCreateInfo, nullptr, &imageReadySignal_));
+    // create the fences and image semaphores for each frame in flight
+    frameContext_ = std::make_unique<FrameContext>(*context_);
+    frameContext_->init();
 
     return true;
 }
 
 void VkDriver::shutdown()
 {
-    context_->device().destroy(imageReadySignal_, nullptr);
+    // all resources awaiting destruction are destroyed regardless of age
+    context_->device().waitIdle();
+    resourceCache_->clear();
+    geometryArena_.destroy(gc_);
+    gc_.reset();
+
+    frameContext_->destroy();
     vmaDestroyAllocator(vmaAlloc_);
 }
 
@@ -131,109 +143,72 @@ RenderTargetHandle VkDriver::createRenderTarget(
 // =========== functions for buffer/texture creation ================
 
 
-VertexBufferHandle VkDriver::addVertexBuffer(size_t size, void* data)
+VertexBufferHandle VkDriver::addVertexBuffer(size_t size, void* data, uint32_t stride)
 {
     ASSERT_FATAL(data, "Data is nullptr when trying to add vertex buffer to vk backend.");
-    auto* buffer = new VertexBuffer();
-    buffer->create(*this, vmaAlloc_, *stagingPool_, data, size);
-    VertexBufferHandle handle {static_cast<uint32_t>(vertBuffers_.size())};
-    vertBuffers_.emplace_back(buffer);
-    return handle;
+    return geometryArena_.vertices().add(*this, data, size, stride);
 }
 
-void VkDriver::mapVertexBuffer(const VertexBufferHandle& handle, size_t count, void* data)
+VertexBufferHandle
+VkDriver::addVertexBuffer(size_t size, uint32_t stride, const GeometryFillFunc& fillFunc)
 {
-    ASSERT_FATAL(data, "Can not map vertex buffer when data pointer is NULL.");
-
-    VertexBuffer* buffer = getVertexBuffer(handle);
-    ASSERT_LOG(buffer);
-
-    if (count > buffer->getSize())
-    {
-        deleteVertexBuffer(handle);
-        addVertexBuffer(count, data);
-        return;
-    }
-    buffer->mapAndCopyToGpu(*this, count, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, data);
+    return geometryArena_.vertices().add(*this, size, stride, fillFunc);
 }
 
-IndexBufferHandle VkDriver::addIndexBuffer(size_t size, void* data)
+void VkDriver::mapVertexBuffer(const VertexBufferHandle& handle, size_t size, void* data)
 {
-    ASSERT_FATAL(data, "Data is nullptr when trying to add index buffer to vk backend.");
-    auto* buffer = new IndexBuffer();
-    buffer->create(*this, vmaAlloc_, *stagingPool_, data, size);
-    IndexBufferHandle handle {static_cast<uint32_t>(indexBuffers_.size())};
-    indexBuffers_.emplace_back(buffer);
-    return handle;
+    ASSERT_FATAL(data, "Can not map vertex buffer when data pointer is NULL.");
+    geometryArena_.vertices().update(*this, handle, data, size);
 }
 
-void VkDriver::mapIndexBuffer(const IndexBufferHandle& handle, size_t count, void* data)
+IndexBufferHandle VkDriver::addIndexBuffer(size_t size, void* data, vk::IndexType indexType)
 {
-    ASSERT_FATAL(data, "Can not map vertex buffer when data pointer is NULL.");
-
-    IndexBuffer* buffer = getIndexBuffer(handle);
-    ASSERT_LOG(buffer);
-
-    if (count > buffer->getSize())
-    {
-        deleteIndexBuffer(handle);
-        addIndexBuffer(count, data);
-        return;
-    }
-    buffer->mapAndCopyToGpu(*this, count, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, data);
+    ASSERT_FATAL(data, "Data is nullptr when trying to add index buffer to vk backend.");
+    uint32_t indexSize = indexType == vk::IndexType::eUint16 ? sizeof(uint16_t) : sizeof(uint32_t);
+    return geometryArena_.indices().add(*this, data, size, indexSize);
 }
 
-VertexBuffer* VkDriver::getVertexBuffer(const VertexBufferHandle& vbHandle) noexcept
+IndexBufferHandle
+VkDriver::addIndexBuffer(size_t size, vk::IndexType indexType, const GeometryFillFunc& fillFunc)
 {
-    ASSERT_FATAL(
-        vbHandle.getKey() < vertBuffers_.size(),
-        "Invalid vertex buffer handle: %d",
-        vbHandle.getKey());
-    return vertBuffers_[vbHandle.getKey()];
+    uint32_t indexSize = indexType == vk::IndexType::eUint16 ? sizeof(uint16_t) : sizeof(uint32_t);
+    return geometryArena_.indices().add(*this, size, indexSize, fillFunc);
 }
 
-IndexBuffer* VkDriver::getIndexBuffer(const IndexBufferHandle& ibHandle) noexcept
+void VkDriver::mapIndexBuffer(const IndexBufferHandle& handle, size_t size, void* data)
 {
-    ASSERT_FATAL(
-        ibHandle.getKey() < indexBuffers_.size(),
-        "Invalid index buffer handle: %d",
-        ibHandle.getKey());
-    return indexBuffers_[ibHandle.getKey()];
+    ASSERT_FATAL(data, "Can not map index buffer when data pointer is NULL.");
+    geometryArena_.indices().update(*this, handle, data, size);
 }
 
-void VkDriver::deleteVertexBuffer(const VertexBufferHandle& handle)
+void VkDriver::deleteVertexBuffer(VertexBufferHandle& handle)
 {
-    ASSERT_FATAL(
-        handle.getKey() < vertBuffers_.size(), "Invalid vertex buffer handle: %d", handle.getKey());
-    VertexBuffer* buffer = vertBuffers_[handle.getKey()];
-    // We get the vulkan buffer handle, so it's safe to delete the associated
-    // VertexBuffer object.
-    gc.add([buffer, this]() {
-        buffer->destroy(vmaAlloc_);
-        delete buffer;
-    });
-    vertBuffers_.erase(vertBuffers_.begin() + handle.getKey());
+    geometryArena_.vertices().remove(*this, handle);
 }
 
-void VkDriver::deleteIndexBuffer(const IndexBufferHandle& handle)
+void VkDriver::deleteIndexBuffer(IndexBufferHandle& handle)
 {
-    ASSERT_FATAL(
-        handle.getKey() < indexBuffers_.size(), "Invalid index buffer handle: %d", handle.getKey());
-    IndexBuffer* buffer = indexBuffers_[handle.getKey()];
-    gc.add([buffer, this]() {
-        buffer->destroy(vmaAlloc_);
-        delete buffer;
-    });
-    indexBuffers_.erase(indexBuffers_.begin() + handle.getKey());
+    geometryArena_.indices().remove(*this, handle);
 }
 
 // ============ begin/end frame functions ======================
 
 bool VkDriver::beginFrame(Swapchain& swapchain)
 {
+    uint32_t frameIdx = getFrameIndex();
+
+    // Wait for the GPU to finish with the resources used by this frame slot -
+    // this will only block if the CPU is more than MaxFramesInFlight ahead.
+    frameContext_->waitForFrame(frameIdx);
+    commands_->releaseFinishedCmdBuffers();
+
     // get the next image index which will be the framebuffer we draw too
     vk::Result result = context_->device().acquireNextImageKHR(
-        swapchain.get(), std::numeric_limits<uint64_t>::max(), imageReadySignal_, {}, &imageIndex_);
+        swapchain.get(),
+        std::numeric_limits<uint64_t>::max(),
+        frameContext_->getImageSignal(frameIdx),
+        {},
+        &imageIndex_);
 
     if (result == vk::Result::eErrorOutOfDateKHR || result == vk::Result::eSuboptimalKHR)
     {
@@ -241,15 +216,21 @@ bool VkDriver::beginFrame(Swapchain& swapchain)
     }
 
     ASSERT_LOG(result == vk::Result::eSuccess);
+
+    frameContext_->writeBeginTimestamp(commands_->getCmdBuffer().cmdBuffer, frameIdx);
     return true;
 }
 
 void VkDriver::endFrame(Swapchain& swapchain)
 {
-    commands_->setExternalWaitSignal(&imageReadySignal_);
+    uint32_t frameIdx = getFrameIndex();
+
+    frameContext_->writeEndTimestamp(commands_->getCmdBuffer().cmdBuffer, frameIdx);
+    commands_->setExternalWaitSignal(&frameContext_->getImageSignal(frameIdx));
 
     // submit the present cmd buffer and send to the queue
     commands_->flush();
+    frameContext_->submitFrame(context_->graphicsQueue(), frameIdx);
 
     vk::Semaphore* renderCompleteSignal = commands_->getFinishedSignal();
 
@@ -281,7 +262,7 @@ void VkDriver::beginRenderpass(
     rpassKey.depth = vk::Format::eUndefined;
     if (depth.handle)
     {
-        auto depthTexture = depth.handle.getResource();
+        Texture* depthTexture = getTexture(depth.handle);
         rpassKey.depth = depthTexture->context().format;
     }
     rpassKey.samples = renderTarget.samples;
@@ -293,7 +274,7 @@ void VkDriver::beginRenderpass(
         rpassKey.colourFormats[i] = vk::Format::eUndefined;
         if (colour.handle)
         {
-            Texture* tex = colour.handle.getResource();
+            Texture* tex = getTexture(colour.handle);
             rpassKey.colourFormats[i] = tex->context().format;
             ASSERT_LOG(data.finalLayouts[i] != vk::ImageLayout::eUndefined);
             rpassKey.finalLayout[i] = data.finalLayouts[i];
@@ -323,7 +304,7 @@ void VkDriver::beginRenderpass(
         RenderTarget::AttachmentInfo colour = renderTarget.colours[idx];
         if (colour.handle)
         {
-            vkapi::Texture* tex = colour.handle.getResource();
+            Texture* tex = getTexture(colour.handle);
             fboKey.views[idx] = tex->getImageView(colour.level)->get();
             ASSERT_FATAL(fboKey.views[idx], "ImageView for attachment %d is invalid.", idx);
             ++count;
@@ -331,7 +312,7 @@ void VkDriver::beginRenderpass(
     }
     if (renderTarget.depth.handle)
     {
-        auto tex = renderTarget.depth.handle.getResource();
+        Texture* tex = getTexture(renderTarget.depth.handle);
         fboKey.views[count++] = tex->getImageView()->get();
     }
 
@@ -392,6 +373,9 @@ void VkDriver::beginRenderpass(
     // bind the renderpass to the pipeline
     pipelineCache_->bindRenderPass(rpass->get());
     pipelineCache_->bindColourAttachCount(rpass->colAttachCount());
+
+    // vertex/index buffer bindings don't carry over between command buffers
+    boundGeometry_ = {};
 }
 
 void VkDriver::endRenderpass(vk::CommandBuffer& cmdBuffer) { cmdBuffer.endRenderPass(); }
@@ -401,8 +385,8 @@ Commands& VkDriver::getCommands() noexcept { return *commands_; }
 void VkDriver::draw(
     vk::CommandBuffer cmdBuffer,
     ShaderProgramBundle& programBundle,
-    vk::Buffer vertexBuffer,
-    vk::Buffer indexBuffer,
+    const VertexBufferHandle& vbHandle,
+    const IndexBufferHandle& ibHandle,
     vk::VertexInputAttributeDescription* vertexAttr,
     vk::VertexInputBindingDescription* vertexBinding,
     const std::vector<uint32_t>& dynamicOffsets)
@@ -423,29 +407,32 @@ void VkDriver::draw(
 
         if (handle)
         {
-            const auto& tex = handle.getResource();
+            const Texture* tex = getTexture(handle);
             vkapi::PipelineCache::DescriptorImage& image = samplers[idx];
             image.imageSampler = sampler;
-            image.imageView = tex->getImageView()->get();
+            image.imageView = tex->getSampledView()->get();
             image.imageLayout = tex->getImageLayout();
         }
     }
     pipelineCache_->bindSampler(samplers);
 
-    // Bind all the buffers associated with this pipeline
+    // Bind all the buffers associated with this pipeline - the buffer used is
+    // the one associated with the current frame in flight.
+    uint32_t frameIdx = getFrameIndex();
     for (const auto& info : programBundle.descBindInfo_)
     {
+        vk::Buffer buffer = info.buffers[frameIdx];
         if (info.type == vk::DescriptorType::eUniformBuffer)
         {
-            pipelineCache_->bindUbo(info.binding, info.buffer, info.size);
+            pipelineCache_->bindUbo(info.binding, buffer, info.size);
         }
         else if (info.type == vk::DescriptorType::eUniformBufferDynamic)
         {
-            pipelineCache_->bindUboDynamic(info.binding, info.buffer, info.size);
+            pipelineCache_->bindUboDynamic(info.binding, buffer, info.size);
         }
         else if (info.type == vk::DescriptorType::eStorageBuffer)
         {
-            pipelineCache_->bindSsbo(info.binding, info.buffer, info.size);
+            pipelineCache_->bindSsbo(info.binding, buffer, info.size);
         }
     }
     plineLayout.build(context());
@@ -524,18 +511,59 @@ void VkDriver::draw(
         }
     }
 
-    // We only used interleaved vertex data so this will only ever
-    // be binding a single buffer and the offset will be zero.
-    if (vertexBuffer)
+    // We only use interleaved vertex data so this will only ever be binding
+    // a single buffer. All meshes share the arena buffers, so these are only
+    // re-bound if they have changed (i.e. the arena has grown) - the mesh is
+    // selected via the vertex offset and first index.
+    uint32_t vertexOffset = 0;
+    if (vbHandle)
     {
-        vk::DeviceSize offset[1] = {0};
-        cmdBuffer.bindVertexBuffers(0, 1, &vertexBuffer, offset);
+        auto& vertices = geometryArena_.vertices();
+        vk::Buffer vertexBuffer = vertices.buffer();
+        if (vertexBuffer != boundGeometry_.vertexBuffer)
+        {
+            vk::DeviceSize offset[1] = {0};
+            cmdBuffer.bindVertexBuffers(0, 1, &vertexBuffer, offset);
+            boundGeometry_.vertexBuffer = vertexBuffer;
+        }
+        vertexOffset =
+            vertices.getElementOffset(vbHandle) + programBundle.renderPrim_.vertexOffset;
     }
-    if (indexBuffer)
+    if (ibHandle)
     {
-        cmdBuffer.bindIndexBuffer(indexBuffer, 0, programBundle.renderPrim_.indexBufferType);
-        cmdBuffer.drawIndexed(
-            programBundle.renderPrim_.indicesCount, 1, programBundle.renderPrim_.offset, 0, 0);
+        auto& indices = geometryArena_.indices();
+        vk::Buffer indexBuffer = indices.buffer();
+        vk::IndexType indexType = programBundle.renderPrim_.indexBufferType;
+        if (indexBuffer != boundGeometry_.indexBuffer || indexType != boundGeometry_.indexType)
+        {
+            cmdBuffer.bindIndexBuffer(indexBuffer, 0, indexType);
+            boundGeometry_.indexBuffer = indexBuffer;
+            boundGeometry_.indexType = indexType;
+        }
+        const uint32_t indexOffset = indices.getElementOffset(ibHandle);
+        const auto& renderPrim = programBundle.renderPrim_;
+        if (renderPrim.rangeCount > 0)
+        {
+            ASSERT_LOG(renderPrim.ranges);
+            for (uint32_t i = 0; i < renderPrim.rangeCount; ++i)
+            {
+                cmdBuffer.drawIndexed(
+                    renderPrim.ranges[i].indicesCount,
+                    1,
+                    indexOffset + renderPrim.ranges[i].offset,
+                    static_cast<int32_t>(vertexOffset),
+                    0);
+            }
+        }
+        else
+        {
+            cmdBuffer.drawIndexed(
+                renderPrim.indicesCount,
+                1,
+                indexOffset + renderPrim.offset,
+                static_cast<int32_t>(vertexOffset),
+                0);
+        }
     }
     else
     {
@@ -543,7 +571,7 @@ void VkDriver::draw(
             programBundle.renderPrim_.vertexCount > 0,
             "When no index buffer is declared, the vertex count must be "
             "specified.");
-        cmdBuffer.draw(programBundle.renderPrim_.vertexCount, 1, 0, 0);
+        cmdBuffer.draw(programBundle.renderPrim_.vertexCount, 1, vertexOffset, 0);
     }
 }
 
@@ -561,12 +589,13 @@ void VkDriver::dispatchCompute(
         storageImages[vkapi::PipelineCache::MaxStorageImageBindCount];
     for (int idx = 0; idx < vkapi::PipelineCache::MaxStorageImageBindCount; ++idx)
     {
-        const vkapi::TextureHandle& handle = bundle->storageImages_[idx];
-        if (handle)
+        const auto& params = bundle->storageImages_[idx];
+        if (params.texHandle)
         {
-            const auto& tex = handle.getResource();
+            Texture* tex = getTexture(params.texHandle);
             vkapi::PipelineCache::DescriptorImage& image = storageImages[idx];
-            image.imageView = tex->getImageView()->get();
+            image.imageView = params.layered ? tex->getLayeredView(params.level)->get()
+                                             : tex->getImageView(params.level)->get();
             image.imageLayout = tex->getImageLayout();
         }
     }
@@ -581,25 +610,27 @@ void VkDriver::dispatchCompute(
 
         if (handle)
         {
-            const auto& tex = handle.getResource();
+            const Texture* tex = getTexture(handle);
             vkapi::PipelineCache::DescriptorImage& image = imageSamplers[idx];
             image.imageSampler = sampler;
-            image.imageView = tex->getImageView()->get();
+            image.imageView = tex->getSampledView()->get();
             image.imageLayout = tex->getImageLayout();
         }
     }
     pipelineCache_->bindSampler(imageSamplers);
 
     // Bind all the buffers associated with this pipeline
+    uint32_t frameIdx = getFrameIndex();
     for (const auto& info : bundle->descBindInfo_)
     {
+        vk::Buffer buffer = info.buffers[frameIdx];
         if (info.type == vk::DescriptorType::eUniformBuffer)
         {
-            pipelineCache_->bindUbo(info.binding, info.buffer, info.size);
+            pipelineCache_->bindUbo(info.binding, buffer, info.size);
         }
         else if (info.type == vk::DescriptorType::eStorageBuffer)
         {
-            pipelineCache_->bindSsbo(info.binding, info.buffer, info.size);
+            pipelineCache_->bindSsbo(info.binding, buffer, info.size);
         }
     }
     plineLayout.build(context());
@@ -641,23 +672,49 @@ vk::Format VkDriver::getSupportedDepthFormat() const
     return output;
 }
 
-BufferHandle VkDriver::addUbo(const size_t size, VkBufferUsageFlags usage)
+bool VkDriver::isTextureFormatSupported(vk::Format format) const
 {
-    return resourceCache_->createUbo(size, usage);
+    if (format == vk::Format::eUndefined)
+    {
+        return false;
+    }
+    vk::FormatFeatureFlags formatFeature =
+        vk::FormatFeatureFlagBits::eSampledImage | vk::FormatFeatureFlagBits::eTransferDst;
+    vk::FormatProperties properties = context_->physical().getFormatProperties(format);
+    return formatFeature == (properties.optimalTilingFeatures & formatFeature);
+}
+
+bool VkDriver::isStorageFormatSupported(vk::Format format) const
+{
+    if (format == vk::Format::eUndefined)
+    {
+        return false;
+    }
+    vk::FormatProperties properties = context_->physical().getFormatProperties(format);
+    return static_cast<bool>(
+        properties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eStorageImage);
+}
+
+BufferHandle VkDriver::addUbo(const size_t size, VkBufferUsageFlags usage, MemoryUsage memUsage)
+{
+    return resourceCache_->createUbo(size, usage, memUsage);
 }
 
 void VkDriver::generateMipMaps(const TextureHandle& handle, const vk::CommandBuffer& cmdBuffer)
 {
-    const Texture* texture = handle.getResource();
+    const Texture* texture = getTexture(handle);
     const TextureContext& texParams = texture->context();
 
     ASSERT_LOG(texParams.width > 0 && texParams.height > 0);
-    ASSERT_LOG(texParams.width == texParams.height);
+    ASSERT_FATAL(
+        !getBlockByteSize(texParams.format),
+        "Mip maps can not be generated for block compressed formats.");
 
-    if (texParams.mipLevels == 1 || (texParams.width == 2 && texParams.height == 2))
+    if (texParams.mipLevels == 1)
     {
         return;
     }
+    const uint32_t layerCount = texParams.faceCount * texParams.arrayCount;
 
     Image* image = texture->getImage();
 
@@ -673,12 +730,20 @@ void VkDriver::generateMipMaps(const TextureHandle& handle, const vk::CommandBuf
     for (uint8_t i = 1; i < texParams.mipLevels; ++i)
     {
         // source
-        vk::ImageSubresourceLayers src(vk::ImageAspectFlagBits::eColor, i - 1, 0, 1);
-        vk::Offset3D srcOffset(texParams.width >> (i - 1), texParams.height >> (i - 1), 1);
+        // the dimensions are clamped to one so non-square textures can be
+        // reduced along the longest axis
+        vk::ImageSubresourceLayers src(vk::ImageAspectFlagBits::eColor, i - 1, 0, layerCount);
+        vk::Offset3D srcOffset(
+            static_cast<int32_t>(std::max(texParams.width >> (i - 1), 1u)),
+            static_cast<int32_t>(std::max(texParams.height >> (i - 1), 1u)),
+            1);
 
         // destination
-        vk::ImageSubresourceLayers dst(vk::ImageAspectFlagBits::eColor, i, 0, 1);
-        vk::Offset3D dstOffset(texParams.width >> i, texParams.height >> i, 1);
+        vk::ImageSubresourceLayers dst(vk::ImageAspectFlagBits::eColor, i, 0, layerCount);
+        vk::Offset3D dstOffset(
+            static_cast<int32_t>(std::max(texParams.width >> i, 1u)),
+            static_cast<int32_t>(std::max(texParams.height >> i, 1u)),
+            1);
 
         vk::ImageBlit imageBlit;
         imageBlit.srcSubresource = src;
@@ -746,14 +811,179 @@ VkDriver::createTexture2d(vk::Format format, uint32_t width, uint32_t height, vk
 void VkDriver::mapTexture(
     const TextureHandle& handle, void* data, uint32_t dataSize, size_t* offsets)
 {
-    auto* tex = const_cast<Texture*>(handle.getResource());
+    Texture* tex = getTexture(handle);
     tex->map(*this, data, dataSize, offsets);
 }
 
+void VkDriver::downloadTexture(const TextureHandle& handle, void* hostBuffer, size_t dataSize)
+{
+    ASSERT_FATAL(hostBuffer, "Host buffer pointer is NULL");
+    Texture* texture = getTexture(handle);
+    const size_t textureSize = texture->getDataSize();
+    ASSERT_FATAL(
+        dataSize >= textureSize,
+        "Host buffer size of %zu is too small for the texture data (%zu bytes).",
+        dataSize,
+        textureSize);
+
+    StagingPool::StageInfo* stage = stagingPool_->getStage(textureSize, currentFrame_);
+
+    auto& cmds = getCommands();
+    auto& cmd = cmds.getCmdBuffer();
+    texture->copyToStage(cmd.cmdBuffer, stage->buffer);
+
+    VkContext::GlobalBarrier(
+        cmd.cmdBuffer,
+        vk::PipelineStageFlagBits::eTransfer,
+        vk::PipelineStageFlagBits::eHost,
+        vk::AccessFlagBits::eTransferWrite,
+        vk::AccessFlagBits::eHostRead);
+    cmds.flush();
+
+    VK_CHECK_RESULT(context_->device().waitForFences(1, &cmd.fence->fence, VK_TRUE, UINT64_MAX));
+
+    vmaInvalidateAllocation(vmaAlloc_, stage->mem, 0, textureSize);
+    memcpy(hostBuffer, stage->allocInfo.pMappedData, textureSize);
+}
+
+StagingPool::StageInfo* VkDriver::beginTextureUploads(std::vector<TextureUpload>& uploads)
+{
+    // each texture is aligned to the largest texel size
+    constexpr VkDeviceSize Alignment = 16;
+
+    VkDeviceSize stageSize = 0;
+    for (TextureUpload& upload : uploads)
+    {
+        ASSERT_LOG(upload.dataSize > 0);
+        upload.stageOffset = stageSize;
+        stageSize += (upload.dataSize + Alignment - 1) & ~(Alignment - 1);
+    }
+    return stagingPool_->getStage(stageSize, currentFrame_);
+}
+
+void VkDriver::reallocateTexture(
+    const TextureHandle& handle,
+    uint32_t width,
+    uint32_t height,
+    uint32_t mipLevels,
+    StagingPool::StageInfo* stage,
+    const std::vector<size_t>& offsets)
+{
+    Texture* tex = getTexture(handle);
+    const uint32_t oldMipLevels = tex->context().mipLevels;
+    vk::CommandBuffer cmdBuffer = commands_->getCmdBuffer().cmdBuffer;
+
+    tex->reallocate(*this, cmdBuffer, width, height, mipLevels);
+
+    // the levels which weren't in the old image are copied from the stage
+    if (stage && mipLevels > oldMipLevels)
+    {
+        const uint32_t newLevels = mipLevels - oldMipLevels;
+        ASSERT_LOG(offsets.size() == newLevels * tex->context().faceCount);
+        vmaFlushAllocation(vmaAlloc_, stage->mem, 0, VK_WHOLE_SIZE);
+        tex->copyFromStage(cmdBuffer, stage->buffer, 0, offsets.data(), newLevels);
+    }
+
+    Image::transition(
+        *tex->getImage(),
+        vk::ImageLayout::eTransferDstOptimal,
+        tex->getImageLayout(),
+        cmdBuffer,
+        vk::PipelineStageFlagBits::eTransfer,
+        vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader);
+}
+
+void VkDriver::endTextureUploads(
+    StagingPool::StageInfo* stage, const std::vector<TextureUpload>& uploads)
+{
+    if (uploads.empty())
+    {
+        return;
+    }
+    vmaFlushAllocation(vmaAlloc_, stage->mem, 0, VK_WHOLE_SIZE);
+
+    auto getBarrier = [](Texture* tex, vk::ImageLayout oldLayout, vk::ImageLayout newLayout) {
+        const TextureContext& context = tex->context();
+        vk::ImageSubresourceRange range(
+            vk::ImageAspectFlagBits::eColor,
+            0,
+            context.mipLevels,
+            0,
+            context.arrayCount * context.faceCount);
+        return vk::ImageMemoryBarrier(
+            oldLayout == vk::ImageLayout::eUndefined ? vk::AccessFlags {}
+                                                     : vk::AccessFlagBits::eTransferWrite,
+            oldLayout == vk::ImageLayout::eUndefined ? vk::AccessFlagBits::eTransferWrite
+                                                     : vk::AccessFlagBits::eShaderRead,
+            oldLayout,
+            newLayout,
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED,
+            tex->getImage()->get(),
+            range);
+    };
+
+    std::vector<vk::ImageMemoryBarrier> barriers;
+    barriers.reserve(uploads.size());
+    for (const TextureUpload& upload : uploads)
+    {
+        barriers.emplace_back(getBarrier(
+            getTexture(upload.handle),
+            vk::ImageLayout::eUndefined,
+            vk::ImageLayout::eTransferDstOptimal));
+    }
+
+    vk::CommandBuffer cmdBuffer = commands_->getCmdBuffer().cmdBuffer;
+    cmdBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTopOfPipe,
+        vk::PipelineStageFlagBits::eTransfer,
+        vk::DependencyFlags {},
+        0,
+        nullptr,
+        0,
+        nullptr,
+        static_cast<uint32_t>(barriers.size()),
+        barriers.data());
+
+    barriers.clear();
+    for (const TextureUpload& upload : uploads)
+    {
+        Texture* tex = getTexture(upload.handle);
+        tex->copyFromStage(
+            cmdBuffer,
+            stage->buffer,
+            upload.stageOffset,
+            upload.offsets.empty() ? nullptr : upload.offsets.data());
+        barriers.emplace_back(getBarrier(
+            tex, vk::ImageLayout::eTransferDstOptimal, tex->getImageLayout()));
+    }
+
+    cmdBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer,
+        vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader,
+        vk::DependencyFlags {},
+        0,
+        nullptr,
+        0,
+        nullptr,
+        static_cast<uint32_t>(barriers.size()),
+        barriers.data());
+}
+
 void VkDriver::destroyTexture2D(TextureHandle& handle) { resourceCache_->deleteTexture(handle); }
 
 void VkDriver::destroyBuffer(BufferHandle& handle) { resourceCache_->deleteUbo(handle); }
 
+Texture* VkDriver::getTexture(const TextureHandle& handle) noexcept
+{
+    return resourceCache_->getTexture(handle);
+}
+
+Buffer* VkDriver::getBuffer(const BufferHandle& handle) noexcept
+{
+    return resourceCache_->getBuffer(handle);
+}
+
 void VkDriver::deleteRenderTarget(const RenderTargetHandle& rtHandle)
 {
     ASSERT_FATAL(
@@ -763,11 +993,66 @@ void VkDriver::deleteRenderTarget(const RenderTargetHandle& rtHandle)
 
 void VkDriver::collectGarbage() noexcept
 {
-    gc.collectGarbage();
+    gc_.collectGarbage(currentFrame_);
+    geometryArena_.collectGarbage(currentFrame_);
     framebufferCache_->cleanCache(currentFrame_);
     pipelineCache_->cleanCache(currentFrame_);
-    resourceCache_->garbageCollection();
     stagingPool_->garbageCollection(currentFrame_);
 }
 
+std::vector<HeapBudget> VkDriver::getHeapBudgets() const
+{
+    const VkPhysicalDeviceMemoryProperties* memProps;
+    vmaGetMemoryProperties(vmaAlloc_, &memProps);
+
+    VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+    vmaGetHeapBudgets(vmaAlloc_, budgets);
+
+    std::vector<HeapBudget> output(memProps->memoryHeapCount);
+    for (uint32_t i = 0; i < memProps->memoryHeapCount; ++i)
+    {
+        const VmaBudget& budget = budgets[i];
+        output[i].usage = budget.usage;
+        output[i].budget = budget.budget;
+        output[i].blockBytes = budget.statistics.blockBytes;
+        output[i].allocationBytes = budget.statistics.allocationBytes;
+        output[i].allocationCount = budget.statistics.allocationCount;
+        output[i].deviceLocal =
+            (memProps->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+    }
+    return output;
+}
+
+void VkDriver::logMemoryStats() const
+{
+    constexpr float toMb = 1.0f / (1024.0f * 1024.0f);
+
+    auto heaps = getHeapBudgets();
+    for (size_t i = 0; i < heaps.size(); ++i)
+    {
+        const HeapBudget& heap = heaps[i];
+        SPDLOG_INFO(
+            "Heap {} ({}): usage {:.2f}MB / budget {:.2f}MB; {} allocations ({:.2f}MB) in "
+            "{:.2f}MB of blocks",
+            i,
+            heap.deviceLocal ? "device local" : "host",
+            static_cast<float>(heap.usage) * toMb,
+            static_cast<float>(heap.budget) * toMb,
+            heap.allocationCount,
+            static_cast<float>(heap.allocationBytes) * toMb,
+            static_cast<float>(heap.blockBytes) * toMb);
+    }
+
+    for (size_t i = 0; i < static_cast<size_t>(MemoryUsage::Count); ++i)
+    {
+        auto usage = static_cast<MemoryUsage>(i);
+        const auto& stats = memoryTracker_.getStats(usage);
+        SPDLOG_INFO(
+            "{}: {} allocations ({:.2f}MB)",
+            memoryUsageToString(usage),
+            stats.allocationCount,
+            static_cast<float>(stats.bytes) * toMb);
+    }
+}
+
 } // namespace vkapi
@@ -26,7 +26,10 @@
 #include "commands.h"
 #include "common.h"
 #include "context.h"
+#include "frame_context.h"
 #include "garbage_collector.h"
+#include "geometry_arena.h"
+#include "memory.h"
 #include "pipeline_cache.h"
 #include "renderpass.h"
 #include "utility/compiler.h"
@@ -34,6 +37,7 @@
 
 #include <memory>
 #include <unordered_set>
+#include <vector>
 
 namespace vkapi
 {
@@ -49,8 +53,19 @@ class ProgramManager;
 class ShaderProgramBundle;
 class Swapchain;
 
-using VertexBufferHandle = util::Handle<VertexBuffer>;
-using IndexBufferHandle = util::Handle<IndexBuffer>;
+/**
+ * A texture to be uploaded as part of a batch - see VkDriver::beginTextureUploads.
+ */
+struct TextureUpload
+{
+    TextureHandle handle;
+    uint32_t dataSize = 0;
+    // the offset of each face and mip level within the data - if empty, the
+    // levels are assumed to be tightly packed
+    std::vector<size_t> offsets;
+    // set by the driver - the offset of the texture data within the stage
+    VkDeviceSize stageOffset = 0;
+};
 
 class VkDriver
 {
@@ -67,19 +82,27 @@ public:
     /// Make sure you call this before closing down the engine!
     void shutdown();
 
-    BufferHandle addUbo(size_t size, VkBufferUsageFlags usage);
+    BufferHandle addUbo(
+        size_t size,
+        VkBufferUsageFlags usage,
+        MemoryUsage memUsage = MemoryUsage::DynamicUpload);
 
-    VertexBufferHandle addVertexBuffer(size_t size, void* data);
+    // Vertex and index data is sub-allocated from the geometry arena. The
+    // stride/index type is required so that ranges can be aligned for use with
+    // vertexOffset/firstIndex.
+    VertexBufferHandle addVertexBuffer(size_t size, void* data, uint32_t stride);
 
-    void mapVertexBuffer(const VertexBufferHandle& handle, size_t count, void* data);
+    VertexBufferHandle
+    addVertexBuffer(size_t size, uint32_t stride, const GeometryFillFunc& fillFunc);
 
-    IndexBufferHandle addIndexBuffer(size_t size, void* data);
+    void mapVertexBuffer(const VertexBufferHandle& handle, size_t size, void* data);
 
-    void mapIndexBuffer(const IndexBufferHandle& handle, size_t count, void* data);
+    IndexBufferHandle addIndexBuffer(size_t size, void* data, vk::IndexType indexType);
 
-    VertexBuffer* getVertexBuffer(const VertexBufferHandle& vbHandle) noexcept;
+    IndexBufferHandle
+    addIndexBuffer(size_t size, vk::IndexType indexType, const GeometryFillFunc& fillFunc);
 
-    IndexBuffer* getIndexBuffer(const IndexBufferHandle& ibHandle) noexcept;
+    void mapIndexBuffer(const IndexBufferHandle& handle, size_t size, void* data);
 
     RenderTargetHandle createRenderTarget(
         bool multiView,
@@ -93,11 +116,19 @@ public:
 
     [[nodiscard]] vk::Format getSupportedDepthFormat() const;
 
+    // Whether the format can be sampled from and uploaded to with optimal
+    // tiling - used to select a target format for compressed textures.
+    [[nodiscard]] bool isTextureFormatSupported(vk::Format format) const;
+
+    // Whether the format can be bound as a storage image - required for
+    // generating mip levels on the compute queue.
+    [[nodiscard]] bool isStorageFormatSupported(vk::Format format) const;
+
     // =============== delete buffer =======================================
 
-    void deleteVertexBuffer(const VertexBufferHandle& handle);
+    void deleteVertexBuffer(VertexBufferHandle& handle);
 
-    void deleteIndexBuffer(const IndexBufferHandle& handle);
+    void deleteIndexBuffer(IndexBufferHandle& handle);
 
     // ======== begin/end frame functions =================================
 
@@ -105,6 +136,17 @@ public:
 
     void endFrame(Swapchain& swapchain);
 
+    // the per-frame resource slot for the frame currently being recorded.
+    [[nodiscard]] uint32_t getFrameIndex() const noexcept
+    {
+        return static_cast<uint32_t>(currentFrame_ % FrameContext::MaxFramesInFlight);
+    }
+
+    [[nodiscard]] const FrameContext::FrameTimings& getFrameTimings() const noexcept
+    {
+        return frameContext_->getTimings();
+    }
+
     void beginRenderpass(
         vk::CommandBuffer cmds, const RenderPassData& data, const RenderTargetHandle& rtHandle);
 
@@ -112,12 +154,50 @@ public:
 
     Commands& getCommands() noexcept;
 
-    static void generateMipMaps(const TextureHandle& handle, const vk::CommandBuffer& cmdBuffer);
+    // Generates the mip chain with a series of linear blits. Used as the
+    // fallback when the format can't be bound as a storage image.
+    void generateMipMaps(const TextureHandle& handle, const vk::CommandBuffer& cmdBuffer);
 
     // ============= retrieve and delete resources ============================
 
     void mapTexture(const TextureHandle& handle, void* data, uint32_t dataSize, size_t* offsets);
 
+    /**
+     * @brief Copies all faces and mip levels of the texture back to the host,
+     * tightly packed by face and then level. This blocks until the copy has
+     * completed, so should only be used for offline work such as baking.
+     */
+    void downloadTexture(const TextureHandle& handle, void* hostBuffer, size_t dataSize);
+
+    /**
+     * @brief Reserves a single staging buffer for a batch of texture uploads,
+     * setting the stage offset of each upload. The texture data can then be
+     * written directly into the mapped stage - from multiple threads if
+     * required - before the batch is submitted with endTextureUploads().
+     * @return The stage which the texture data must be written to.
+     */
+    StagingPool::StageInfo* beginTextureUploads(std::vector<TextureUpload>& uploads);
+
+    // Records the copies for all textures in the batch, using one set of
+    // layout transitions for all of the images.
+    void endTextureUploads(
+        StagingPool::StageInfo* stage, const std::vector<TextureUpload>& uploads);
+
+    /**
+     * @brief Changes the number of mip levels that are resident for a texture,
+     * re-creating the image at the size of the new top level. The levels
+     * shared with the old image are copied on the gpu. When levels are added,
+     * these are copied from the stage - the offsets are indexed by
+     * face * newLevelCount + level, where level zero is the new top level.
+     */
+    void reallocateTexture(
+        const TextureHandle& handle,
+        uint32_t width,
+        uint32_t height,
+        uint32_t mipLevels,
+        StagingPool::StageInfo* stage = nullptr,
+        const std::vector<size_t>& offsets = {});
+
     TextureHandle createTexture2d(
         vk::Format format,
         uint32_t width,
@@ -134,11 +214,15 @@ public:
 
     void destroyBuffer(BufferHandle& handle);
 
+    Texture* getTexture(const TextureHandle& handle) noexcept;
+
+    Buffer* getBuffer(const BufferHandle& handle) noexcept;
+
     void draw(
         vk::CommandBuffer cmdBuffer,
         ShaderProgramBundle& programBundle,
-        vk::Buffer vertexBuffer = VK_NULL_HANDLE,
-        vk::Buffer indexBuffer = VK_NULL_HANDLE,
+        const VertexBufferHandle& vbHandle = {},
+        const IndexBufferHandle& ibHandle = {},
         vk::VertexInputAttributeDescription* vertexAttr = nullptr,
         vk::VertexInputBindingDescription* vertexBinding = nullptr,
         const std::vector<uint32_t>& dynamicOffsets = {});
@@ -158,20 +242,37 @@ public:
 
     void collectGarbage() noexcept;
 
+    // ============= memory statistics =====================================
+
+    // The current usage and budget of each memory heap.
+    [[nodiscard]] std::vector<HeapBudget> getHeapBudgets() const;
+
+    [[nodiscard]] const MemoryTracker::UsageStats& getMemoryStats(MemoryUsage usage) const noexcept
+    {
+        return memoryTracker_.getStats(usage);
+    }
+
+    // Logs the heap budgets and the bytes allocated for each usage class.
+    void logMemoryStats() const;
+
     // =============== getters =============================================
 
     VkContext& context() { return *context_; }
     VmaAllocator& vmaAlloc() { return vmaAlloc_; }
-    [[nodiscard]] const vk::Semaphore& imageSignal() const { return imageReadySignal_; }
+    [[nodiscard]] const vk::Semaphore& imageSignal() const
+    {
+        return frameContext_->getImageSignal(getFrameIndex());
+    }
     [[nodiscard]] StagingPool& stagingPool() { return *stagingPool_; }
     ProgramManager& progManager() { return *programManager_; }
     PipelineCache& pipelineCache() { return *pipelineCache_; }
     SamplerCache& getSamplerCache() { return *samplerCache_; }
+    ResourceCache& resourceCache() { return *resourceCache_; }
+    GarbageCollector& garbageCollector() { return gc_; }
+    GeometryArena& geometryArena() { return geometryArena_; }
+    MemoryTracker& memoryTracker() { return memoryTracker_; }
     [[nodiscard]] uint64_t getCurrentFrame() const noexcept { return currentFrame_; }
 
-    using VertexBufferMap = std::vector<VertexBuffer*>;
-    using IndexBufferMap = std::vector<IndexBuffer*>;
-
 private:
     // current device context
     std::unique_ptr<VkContext> context_;
@@ -182,6 +283,9 @@ private:
     // external mem allocator
     VmaAllocator vmaAlloc_;
 
+    // bytes allocated per memory usage class
+    MemoryTracker memoryTracker_;
+
     // staging pool used for managing CPU stages
     std::unique_ptr<StagingPool> stagingPool_;
 
@@ -189,9 +293,18 @@ private:
 
     std::vector<RenderTarget> renderTargets_;
 
-    // vertex/index buffers
-    VertexBufferMap vertBuffers_;
-    IndexBufferMap indexBuffers_;
+    // all vertex/index data is sub-allocated from the arena buffers
+    GeometryArena geometryArena_;
+
+    // the arena buffers currently bound - as all draws share the same buffers
+    // these only need binding once per renderpass.
+    struct GeometryBindState
+    {
+        vk::Buffer vertexBuffer;
+        vk::Buffer indexBuffer;
+        vk::IndexType indexType = vk::IndexType::eUint32;
+    };
+    GeometryBindState boundGeometry_;
 
     // caches
     std::unique_ptr<ResourceCache> resourceCache_;
@@ -201,10 +314,11 @@ private:
 
     std::unique_ptr<Commands> commands_;
 
-    GarbageCollector gc;
+    // deferred destruction of resources which may still be in use by the GPU
+    GarbageCollector gc_;
 
-    // used for ensuring that the image has completed
-    vk::Semaphore imageReadySignal_;
+    // per-frame fences and image signals for the frames in flight
+    std::unique_ptr<FrameContext> frameContext_;
 
     // frame number as designated by the number of times
     // a presentation queue flush has been carried out.
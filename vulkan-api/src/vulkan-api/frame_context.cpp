@@ -0,0 +1,178 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "frame_context.h"
+
+#include "context.h"
+#include "utility/assertion.h"
+#include "utility/timer.h"
+
+#include <spdlog/spdlog.h>
+
+namespace vkapi
+{
+
+FrameContext::FrameContext(VkContext& context)
+    : context_(context), timestampsSupported_(false), timestampPeriod_(0.0f), lastEndTimestamp_(0)
+{
+}
+
+FrameContext::~FrameContext() = default;
+
+void FrameContext::init()
+{
+    for (auto& frame : frames_)
+    {
+        // fences are created signalled so the first wait on each slot doesn't block.
+        vk::FenceCreateInfo fenceInfo(vk::FenceCreateFlagBits::eSignaled);
+        VK_CHECK_RESULT(context_.device().createFence(&fenceInfo, nullptr, &frame.fence));
+
+        vk::SemaphoreCreateInfo semaphoreCreateInfo;
+        VK_CHECK_RESULT(context_.device().createSemaphore(
+            &semaphoreCreateInfo, nullptr, &frame.imageReadySignal));
+    }
+
+    const vk::PhysicalDeviceLimits& limits = context_.physical().getProperties().limits;
+    timestampsSupported_ = limits.timestampComputeAndGraphics;
+    timestampPeriod_ = limits.timestampPeriod;
+
+    if (timestampsSupported_)
+    {
+        vk::QueryPoolCreateInfo queryInfo {{}, vk::QueryType::eTimestamp, MaxFramesInFlight * 2};
+        VK_CHECK_RESULT(context_.device().createQueryPool(&queryInfo, nullptr, &queryPool_));
+    }
+    else
+    {
+        SPDLOG_WARN("Timestamp queries are not supported on this device - GPU frame timings "
+                    "will be unavailable.");
+    }
+}
+
+void FrameContext::destroy() noexcept
+{
+    for (auto& frame : frames_)
+    {
+        context_.device().destroy(frame.fence, nullptr);
+        context_.device().destroy(frame.imageReadySignal, nullptr);
+    }
+    if (queryPool_)
+    {
+        context_.device().destroy(queryPool_, nullptr);
+    }
+}
+
+void FrameContext::waitForFrame(uint32_t frameIdx)
+{
+    ASSERT_LOG(frameIdx < MaxFramesInFlight);
+    Frame& frame = frames_[frameIdx];
+
+    util::Timer<NanoSeconds> timer;
+    VK_CHECK_RESULT(context_.device().waitForFences(1, &frame.fence, VK_TRUE, UINT64_MAX));
+    timings_.cpuWaitTime = static_cast<float>(timer.getTimeElapsed() / 1.0e6);
+
+    resolveTimestamps(frameIdx);
+}
+
+void FrameContext::submitFrame(vk::Queue queue, uint32_t frameIdx)
+{
+    ASSERT_LOG(frameIdx < MaxFramesInFlight);
+    Frame& frame = frames_[frameIdx];
+
+    // The fence is reset at submission rather than after the wait so a frame
+    // which is dropped (i.e. due to an out of date swapchain) doesn't leave
+    // the slot with a fence that will never be signalled.
+    VK_CHECK_RESULT(context_.device().resetFences(1, &frame.fence));
+
+    // An empty submit will signal the fence once all previously submitted
+    // work on this queue has completed.
+    VK_CHECK_RESULT(queue.submit(0, nullptr, frame.fence));
+}
+
+void FrameContext::writeBeginTimestamp(vk::CommandBuffer cmdBuffer, uint32_t frameIdx) noexcept
+{
+    if (!timestampsSupported_)
+    {
+        return;
+    }
+    uint32_t query = frameIdx * 2;
+    cmdBuffer.resetQueryPool(queryPool_, query, 2);
+    cmdBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, queryPool_, query);
+    frames_[frameIdx].hasBeginTimestamp = true;
+    frames_[frameIdx].hasEndTimestamp = false;
+}
+
+void FrameContext::writeEndTimestamp(vk::CommandBuffer cmdBuffer, uint32_t frameIdx) noexcept
+{
+    if (!timestampsSupported_ || !frames_[frameIdx].hasBeginTimestamp)
+    {
+        return;
+    }
+    cmdBuffer.writeTimestamp(
+        vk::PipelineStageFlagBits::eBottomOfPipe, queryPool_, frameIdx * 2 + 1);
+    frames_[frameIdx].hasEndTimestamp = true;
+}
+
+vk::Semaphore& FrameContext::getImageSignal(uint32_t frameIdx) noexcept
+{
+    ASSERT_LOG(frameIdx < MaxFramesInFlight);
+    return frames_[frameIdx].imageReadySignal;
+}
+
+void FrameContext::resolveTimestamps(uint32_t frameIdx) noexcept
+{
+    Frame& frame = frames_[frameIdx];
+    if (!frame.hasBeginTimestamp || !frame.hasEndTimestamp)
+    {
+        return;
+    }
+    frame.hasBeginTimestamp = false;
+    frame.hasEndTimestamp = false;
+
+    // The frame fence has been signalled so the results are guaranteed to be available.
+    std::array<uint64_t, 2> results;
+    auto result = context_.device().getQueryPoolResults(
+        queryPool_,
+        frameIdx * 2,
+        2,
+        sizeof(results),
+        results.data(),
+        sizeof(uint64_t),
+        vk::QueryResultFlagBits::e64);
+    if (result != vk::Result::eSuccess)
+    {
+        return;
+    }
+
+    const float nsToMs = timestampPeriod_ / 1.0e6f;
+    timings_.gpuFrameTime = static_cast<float>(results[1] - results[0]) * nsToMs;
+
+    // Frames are resolved in submission order, so the last end timestamp is
+    // that of the previous frame. A begin timestamp prior to this denotes
+    // that the GPU wasn't starved of work.
+    timings_.gpuWaitTime = lastEndTimestamp_ && results[0] > lastEndTimestamp_
+        ? static_cast<float>(results[0] - lastEndTimestamp_) * nsToMs
+        : 0.0f;
+    lastEndTimestamp_ = results[1];
+}
+
+} // namespace vkapi
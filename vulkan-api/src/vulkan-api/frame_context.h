@@ -0,0 +1,119 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "common.h"
+
+#include <array>
+#include <cstdint>
+
+namespace vkapi
+{
+// forward declarations
+class VkContext;
+
+/**
+ Tracks the resources that are required to keep multiple frames in flight.
+ Each frame slot has its own fence, signalled once all work submitted for
+ that frame has completed on the GPU, and its own image acquire semaphore.
+ Per-frame resources on the client side (uniform buffers, etc.) are
+ indexed by the frame slot so the CPU can record frame N+1 whilst the GPU
+ is still executing frame N.
+ */
+class FrameContext
+{
+public:
+    // The number of frames that the CPU can get ahead of the GPU.
+    constexpr static uint32_t MaxFramesInFlight = 2;
+
+    // Timings (in milliseconds) for the most recently completed frame.
+    struct FrameTimings
+    {
+        // time the CPU spent blocked waiting for the frame slot to be freed by the GPU
+        float cpuWaitTime = 0.0f;
+        // time the GPU spent idle between the end of the previous frame and the start of this one
+        float gpuWaitTime = 0.0f;
+        // time the GPU spent executing the frame
+        float gpuFrameTime = 0.0f;
+    };
+
+    explicit FrameContext(VkContext& context);
+    ~FrameContext();
+
+    // not copyable
+    FrameContext(const FrameContext&) = delete;
+    FrameContext& operator=(const FrameContext&) = delete;
+
+    void init();
+
+    void destroy() noexcept;
+
+    /**
+     Blocks until the GPU has finished with all work submitted for the
+     specified frame slot. The time blocked is recorded as the CPU wait time
+     and the GPU timestamps for the frame are resolved if available.
+     */
+    void waitForFrame(uint32_t frameIdx);
+
+    /// Should be called once all work for the frame has been submitted to the queue.
+    void submitFrame(vk::Queue queue, uint32_t frameIdx);
+
+    void writeBeginTimestamp(vk::CommandBuffer cmdBuffer, uint32_t frameIdx) noexcept;
+
+    void writeEndTimestamp(vk::CommandBuffer cmdBuffer, uint32_t frameIdx) noexcept;
+
+    vk::Semaphore& getImageSignal(uint32_t frameIdx) noexcept;
+
+    [[nodiscard]] const FrameTimings& getTimings() const noexcept { return timings_; }
+
+private:
+    void resolveTimestamps(uint32_t frameIdx) noexcept;
+
+private:
+    VkContext& context_;
+
+    struct Frame
+    {
+        // signalled when all work for this frame has completed
+        vk::Fence fence;
+        // signalled when the swapchain image for this frame is ready
+        vk::Semaphore imageReadySignal;
+        // whether begin and end timestamps have been written for this frame
+        bool hasBeginTimestamp = false;
+        bool hasEndTimestamp = false;
+    };
+    std::array<Frame, MaxFramesInFlight> frames_;
+
+    // begin/end timestamp pairs for each frame slot
+    vk::QueryPool queryPool_;
+    bool timestampsSupported_;
+    float timestampPeriod_;
+
+    // the end timestamp of the last resolved frame - used for working out GPU idle time
+    uint64_t lastEndTimestamp_;
+
+    FrameTimings timings_;
+};
+
+} // namespace vkapi
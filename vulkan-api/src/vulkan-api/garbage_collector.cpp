@@ -20,45 +20,79 @@
  * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+
 #include "garbage_collector.h"
 
+#include "context.h"
+#include "driver.h"
+
 namespace vkapi
 {
 
-GarbageCollector::GarbageCollector() { gcObjects_.reserve(50); }
+GarbageCollector::GarbageCollector(VkDriver& driver) : driver_(driver) {}
 GarbageCollector::~GarbageCollector() = default;
 
-void GarbageCollector::add(std::function<void()> destructor) noexcept
+GarbageCollector::Bucket& GarbageCollector::currentBucket() noexcept
+{
+    return buckets_[driver_.getCurrentFrame() % BucketCount];
+}
+
+void GarbageCollector::add(VkBuffer buffer, VmaAllocation allocation) noexcept
 {
-    gcObjects_.push_back({std::move(destructor), FramesUntilCollection});
+    currentBucket().buffers.emplace_back(buffer, allocation);
 }
 
-void GarbageCollector::collectGarbage() noexcept
+void GarbageCollector::add(vk::Image image, VmaAllocation allocation) noexcept
 {
-    std::vector<CollectionInfo> remaining;
-    remaining.reserve(50);
+    currentBucket().images.emplace_back(image, allocation);
+}
 
-    for (auto& object : gcObjects_)
+void GarbageCollector::add(vk::ImageView imageView) noexcept
+{
+    currentBucket().imageViews.emplace_back(imageView);
+}
+
+void GarbageCollector::collectGarbage(uint64_t currentFrame) noexcept
+{
+    // The oldest bucket is the one that the next frame will write into - this
+    // holds resources deleted FramesUntilCollection frames ago.
+    destroyBucket(buckets_[(currentFrame + 1) % BucketCount]);
+}
+
+void GarbageCollector::reset() noexcept
+{
+    for (auto& bucket : buckets_)
     {
-        if (!--object.frames)
-        {
-            object.destructor();
-        }
-        else
-        {
-            remaining.emplace_back(object);
-        }
+        destroyBucket(bucket);
     }
-    remaining.swap(gcObjects_);
 }
 
-void GarbageCollector::reset() noexcept
+void GarbageCollector::destroyBucket(Bucket& bucket) noexcept
 {
-    for (auto& object : gcObjects_)
+    const vk::Device& device = driver_.context().device();
+
+    // image views first as these reference the images.
+    for (const auto& view : bucket.imageViews)
     {
-        object.destructor();
+        device.destroy(view, nullptr);
     }
-    gcObjects_.clear();
+    VmaAllocator& vmaAlloc = driver_.vmaAlloc();
+    MemoryTracker& tracker = driver_.memoryTracker();
+    for (const auto& [image, allocation] : bucket.images)
+    {
+        tracker.remove(vmaAlloc, allocation);
+        vmaDestroyImage(vmaAlloc, image, allocation);
+    }
+    for (const auto& [buffer, allocation] : bucket.buffers)
+    {
+        tracker.remove(vmaAlloc, allocation);
+        vmaDestroyBuffer(vmaAlloc, buffer, allocation);
+    }
+
+    // clear rather than shrink so the capacity is reused by later frames.
+    bucket.imageViews.clear();
+    bucket.images.clear();
+    bucket.buffers.clear();
 }
 
 } // namespace vkapi
@@ -20,43 +20,77 @@
  * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+
 #pragma once
 
-#include <functional>
+#include "common.h"
+#include "frame_context.h"
+
+#include <array>
+#include <cstdint>
 #include <vector>
 
 namespace vkapi
 {
+// forward declarations
+class VkDriver;
 
+/**
+ Deferred destruction of vulkan resources. Resources are added to a bucket
+ associated with the frame in which they were deleted and the whole bucket is
+ destroyed in bulk once that frame has been retired by the GPU. Buckets are
+ typed vectors of handles, so there are no per-object allocations and no
+ per-frame scans of the resources awaiting destruction.
+ */
 class GarbageCollector
 {
 public:
-    // The number of frames to wait until running the destructor
-    // for an object. This should be at least three frames due to
-    // triple buffering and ensuring that resources are not deleted
-    // whilst still in use by a cmd buffer.
-    static constexpr int FramesUntilCollection = 10;
+    // The number of frames to wait until destroying a resource. A frame is
+    // retired by the GPU once the CPU is MaxFramesInFlight frames ahead, but
+    // the framebuffer and descriptor set caches key on raw vulkan handles, so
+    // handles must not be recycled until those cache entries have expired
+    // (LifetimeFrameCount + 1 frames).
+    static constexpr uint32_t FramesUntilCollection = 11;
+    static_assert(FramesUntilCollection >= FrameContext::MaxFramesInFlight);
 
-    GarbageCollector();
+    static constexpr uint32_t BucketCount = FramesUntilCollection + 1;
+
+    explicit GarbageCollector(VkDriver& driver);
     ~GarbageCollector();
 
     GarbageCollector(const GarbageCollector&) = delete;
     GarbageCollector& operator=(const GarbageCollector&) = delete;
 
-    void add(std::function<void()> destructor) noexcept;
+    void add(VkBuffer buffer, VmaAllocation allocation) noexcept;
+
+    void add(vk::Image image, VmaAllocation allocation) noexcept;
 
-    void collectGarbage() noexcept;
+    void add(vk::ImageView imageView) noexcept;
 
+    // Destroys all resources which were deleted in a frame that has now been
+    // retired. Should be called once per frame, after the frame fence wait.
+    void collectGarbage(uint64_t currentFrame) noexcept;
+
+    // Destroys all resources regardless of the frame they were deleted in.
+    // The device must be idle before calling this.
     void reset() noexcept;
 
 private:
-    struct CollectionInfo
+    struct Bucket
     {
-        std::function<void()> destructor;
-        int frames;
+        std::vector<std::pair<VkBuffer, VmaAllocation>> buffers;
+        std::vector<std::pair<vk::Image, VmaAllocation>> images;
+        std::vector<vk::ImageView> imageViews;
     };
 
-    std::vector<CollectionInfo> gcObjects_;
+    Bucket& currentBucket() noexcept;
+
+    void destroyBucket(Bucket& bucket) noexcept;
+
+private:
+    VkDriver& driver_;
+
+    std::array<Bucket, BucketCount> buckets_;
 };
 
 } // namespace vkapi
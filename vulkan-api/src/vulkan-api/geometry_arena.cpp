@@ -0,0 +1,323 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "geometry_arena.h"
+
+#include "commands.h"
+#include "context.h"
+#include "driver.h"
+#include "frame_context.h"
+#include "garbage_collector.h"
+#include "utility/assertion.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace vkapi
+{
+
+template <typename RangeT>
+GeometryPool<RangeT>::GeometryPool(VkBufferUsageFlags usage, VkDeviceSize initialCapacity)
+    : usage_(usage), initialCapacity_(initialCapacity)
+{
+}
+
+template <typename RangeT>
+typename GeometryPool<RangeT>::Handle
+GeometryPool<RangeT>::add(VkDriver& driver, void* data, VkDeviceSize size, uint32_t elementSize)
+{
+    ASSERT_FATAL(data, "Data is nullptr when trying to add geometry to the arena.");
+    return add(driver, size, elementSize, [data, size](void* dst) { memcpy(dst, data, size); });
+}
+
+template <typename RangeT>
+typename GeometryPool<RangeT>::Handle GeometryPool<RangeT>::add(
+    VkDriver& driver, VkDeviceSize size, uint32_t elementSize, const GeometryFillFunc& fillFunc)
+{
+    ASSERT_FATAL(size > 0 && elementSize > 0, "Geometry size and element size must be non-zero.");
+
+    RangeT range;
+    range.offset = allocateRange(driver, size, elementSize);
+    range.size = size;
+    range.elementSize = elementSize;
+    upload(driver, range.offset, size, fillFunc);
+    return ranges_.emplace(range);
+}
+
+template <typename RangeT>
+void GeometryPool<RangeT>::update(
+    VkDriver& driver, const Handle& handle, void* data, VkDeviceSize size)
+{
+    ASSERT_FATAL(data, "Can not update geometry when data pointer is NULL.");
+    ASSERT_FATAL(ranges_.isValid(handle), "Invalid geometry handle.");
+
+    // The current range may still be read by frames in flight, so the data is
+    // always written to a new range rather than over the old one. The new
+    // range is allocated before releasing the old one - the allocation may
+    // defragment the buffer, which would otherwise see a range that has
+    // already been freed.
+    RangeT* range = ranges_.get(handle);
+    VkDeviceSize newOffset = allocateRange(driver, size, range->elementSize);
+    releaseRange(driver, range->offset, range->size);
+    range->offset = newOffset;
+    range->size = size;
+    upload(driver, range->offset, size, [data, size](void* dst) { memcpy(dst, data, size); });
+}
+
+template <typename RangeT>
+void GeometryPool<RangeT>::remove(VkDriver& driver, Handle& handle)
+{
+    // If the handle is stale we assume that the range has already been
+    // removed and allow this to fail silently.
+    if (!ranges_.isValid(handle))
+    {
+        return;
+    }
+    const RangeT* range = ranges_.get(handle);
+    releaseRange(driver, range->offset, range->size);
+    ranges_.erase(handle);
+    handle = {};
+}
+
+template <typename RangeT>
+const RangeT* GeometryPool<RangeT>::get(const Handle& handle) const noexcept
+{
+    return ranges_.get(handle);
+}
+
+template <typename RangeT>
+uint32_t GeometryPool<RangeT>::getElementOffset(const Handle& handle) const noexcept
+{
+    ASSERT_LOG(ranges_.isValid(handle));
+    const RangeT* range = ranges_.get(handle);
+    return static_cast<uint32_t>(range->offset / range->elementSize);
+}
+
+template <typename RangeT>
+void GeometryPool<RangeT>::defragment(VkDriver& driver)
+{
+    if (buffer_)
+    {
+        reallocate(driver, allocator_.capacity(), true);
+    }
+}
+
+template <typename RangeT>
+void GeometryPool<RangeT>::collectGarbage(uint64_t currentFrame) noexcept
+{
+    auto iter = std::remove_if(
+        pendingReleases_.begin(), pendingReleases_.end(), [&](const PendingRelease& pending) {
+            if (pending.frame + FrameContext::MaxFramesInFlight > currentFrame)
+            {
+                return false;
+            }
+            allocator_.release(pending.offset, pending.size);
+            return true;
+        });
+    pendingReleases_.erase(iter, pendingReleases_.end());
+}
+
+template <typename RangeT>
+void GeometryPool<RangeT>::destroy(GarbageCollector& gc) noexcept
+{
+    if (buffer_)
+    {
+        buffer_->destroy(gc);
+        buffer_.reset();
+    }
+    ranges_.clear();
+    pendingReleases_.clear();
+    allocator_.reset(0);
+}
+
+template <typename RangeT>
+VkDeviceSize
+GeometryPool<RangeT>::allocateRange(VkDriver& driver, VkDeviceSize size, uint32_t alignment)
+{
+    // the worst case space required taking into account alignment padding
+    const VkDeviceSize reqSize = size + alignment - 1;
+
+    if (!buffer_)
+    {
+        reallocate(driver, std::max(initialCapacity_, reqSize), false);
+    }
+
+    uint64_t offset = allocator_.allocate(size, alignment);
+    if (offset != util::RangeAllocator::InvalidOffset)
+    {
+        return offset;
+    }
+
+    // There may be enough space, just too fragmented. Compaction also
+    // reclaims any pending releases as they only refer to the old buffer.
+    VkDeviceSize reclaimableSize = allocator_.freeSize();
+    for (const auto& pending : pendingReleases_)
+    {
+        reclaimableSize += pending.size;
+    }
+    if (reclaimableSize >= reqSize)
+    {
+        reallocate(driver, allocator_.capacity(), true);
+        offset = allocator_.allocate(size, alignment);
+        if (offset != util::RangeAllocator::InvalidOffset)
+        {
+            return offset;
+        }
+    }
+
+    const VkDeviceSize currCapacity = allocator_.capacity();
+    reallocate(driver, std::max(currCapacity * 2, currCapacity + reqSize), false);
+    offset = allocator_.allocate(size, alignment);
+    ASSERT_FATAL(
+        offset != util::RangeAllocator::InvalidOffset,
+        "Unable to allocate a geometry range of %lu bytes.",
+        size);
+    return offset;
+}
+
+template <typename RangeT>
+void GeometryPool<RangeT>::releaseRange(VkDriver& driver, VkDeviceSize offset, VkDeviceSize size)
+{
+    // the range may still be read by frames in flight so defer returning it
+    // to the allocator until those frames have been retired.
+    pendingReleases_.push_back({offset, size, driver.getCurrentFrame()});
+}
+
+template <typename RangeT>
+void GeometryPool<RangeT>::upload(
+    VkDriver& driver, VkDeviceSize offset, VkDeviceSize size, const GeometryFillFunc& fillFunc)
+{
+    StagingPool::StageInfo* stage =
+        driver.stagingPool().getStage(size, driver.getCurrentFrame());
+    fillFunc(stage->allocInfo.pMappedData);
+    buffer_->copyStagedToGpu(driver, size, stage, usage_, offset);
+}
+
+template <typename RangeT>
+void GeometryPool<RangeT>::reallocate(VkDriver& driver, VkDeviceSize newCapacity, bool compact)
+{
+    auto newBuffer = std::make_unique<Buffer>();
+    newBuffer->alloc(driver, newCapacity, usage_, MemoryUsage::StaticDeviceLocal);
+
+    if (!buffer_)
+    {
+        allocator_.reset(newCapacity);
+        buffer_ = std::move(newBuffer);
+        return;
+    }
+
+    std::vector<vk::BufferCopy> regions;
+    regions.reserve(ranges_.size());
+
+    if (compact)
+    {
+        // keep the ranges in the same order so large ranges don't end up
+        // fragmenting the start of the new buffer
+        std::vector<RangeT*> liveRanges;
+        liveRanges.reserve(ranges_.size());
+        ranges_.forEach([&liveRanges](const Handle&, RangeT& range) {
+            liveRanges.emplace_back(&range);
+        });
+        std::sort(liveRanges.begin(), liveRanges.end(), [](const RangeT* lhs, const RangeT* rhs) {
+            return lhs->offset < rhs->offset;
+        });
+
+        allocator_.reset(newCapacity);
+        pendingReleases_.clear();
+        for (RangeT* range : liveRanges)
+        {
+            uint64_t newOffset = allocator_.allocate(range->size, range->elementSize);
+            ASSERT_LOG(newOffset != util::RangeAllocator::InvalidOffset);
+            regions.push_back({range->offset, newOffset, range->size});
+            range->offset = newOffset;
+        }
+    }
+    else
+    {
+        allocator_.grow(newCapacity);
+        ranges_.forEach([&regions](const Handle&, RangeT& range) {
+            regions.push_back({range.offset, range.offset, range.size});
+        });
+    }
+
+    if (!regions.empty())
+    {
+        auto& cmd = driver.getCommands().getCmdBuffer();
+
+        // uploads to the old buffer this frame must complete before the copy
+        VkContext::GlobalBarrier(
+            cmd.cmdBuffer,
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::AccessFlagBits::eTransferWrite,
+            vk::AccessFlagBits::eTransferRead);
+
+        cmd.cmdBuffer.copyBuffer(
+            buffer_->get(),
+            newBuffer->get(),
+            static_cast<uint32_t>(regions.size()),
+            regions.data());
+
+        VkContext::GlobalBarrier(
+            cmd.cmdBuffer,
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eVertexInput,
+            vk::AccessFlagBits::eTransferWrite,
+            vk::AccessFlagBits::eTransferWrite | vk::AccessFlagBits::eVertexAttributeRead |
+                vk::AccessFlagBits::eIndexRead);
+    }
+
+    buffer_->destroy(driver.garbageCollector());
+    buffer_ = std::move(newBuffer);
+}
+
+template class GeometryPool<VertexRange>;
+template class GeometryPool<IndexRange>;
+
+// ===================== GeometryArena =============================
+
+GeometryArena::GeometryArena()
+    : vertices_(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, InitialVertexCapacity),
+      indices_(VK_BUFFER_USAGE_INDEX_BUFFER_BIT, InitialIndexCapacity)
+{
+}
+
+void GeometryArena::defragment(VkDriver& driver)
+{
+    vertices_.defragment(driver);
+    indices_.defragment(driver);
+}
+
+void GeometryArena::collectGarbage(uint64_t currentFrame) noexcept
+{
+    vertices_.collectGarbage(currentFrame);
+    indices_.collectGarbage(currentFrame);
+}
+
+void GeometryArena::destroy(GarbageCollector& gc) noexcept
+{
+    vertices_.destroy(gc);
+    indices_.destroy(gc);
+}
+
+} // namespace vkapi
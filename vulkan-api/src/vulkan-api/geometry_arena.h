@@ -0,0 +1,178 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "buffer.h"
+#include "common.h"
+#include "utility/handle.h"
+#include "utility/range_allocator.h"
+#include "utility/slot_map.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace vkapi
+{
+// forward declarations
+class VkDriver;
+class GarbageCollector;
+
+/**
+ A range sub-allocated from one of the geometry arena buffers. The offset is
+ always a multiple of the element size (the vertex stride or index size) so
+ the range can be addressed with vertexOffset/firstIndex when drawing.
+ */
+struct GeometryRange
+{
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    uint32_t elementSize = 0;
+};
+
+// distinct types so vertex and index handles can't be mixed up
+struct VertexRange : public GeometryRange
+{
+};
+struct IndexRange : public GeometryRange
+{
+};
+
+using VertexBufferHandle = util::Handle<VertexRange>;
+using IndexBufferHandle = util::Handle<IndexRange>;
+
+// Writes geometry directly into the mapped staging memory passed as the
+// argument, avoiding an intermediate copy on the host.
+using GeometryFillFunc = std::function<void(void*)>;
+
+/**
+ A single large GPU buffer from which geometry ranges are sub-allocated. When
+ a range can't be allocated, the buffer is first defragmented if there is
+ enough free space overall, otherwise it is grown. In both cases a new buffer
+ is created, the live ranges are copied across on the GPU and the old buffer
+ is handed to the garbage collector - handles remain valid throughout.
+ */
+template <typename RangeT>
+class GeometryPool
+{
+public:
+    using Handle = util::Handle<RangeT>;
+
+    GeometryPool(VkBufferUsageFlags usage, VkDeviceSize initialCapacity);
+
+    Handle add(VkDriver& driver, void* data, VkDeviceSize size, uint32_t elementSize);
+
+    Handle add(
+        VkDriver& driver, VkDeviceSize size, uint32_t elementSize, const GeometryFillFunc& fillFunc);
+
+    // Uploads new data to a newly allocated range - the old range is only
+    // released once the frames in flight which may read it have retired.
+    void update(VkDriver& driver, const Handle& handle, void* data, VkDeviceSize size);
+
+    // Releases the range and resets the handle. Stale handles are ignored.
+    void remove(VkDriver& driver, Handle& handle);
+
+    [[nodiscard]] const RangeT* get(const Handle& handle) const noexcept;
+
+    // The offset of the range in elements rather than bytes.
+    [[nodiscard]] uint32_t getElementOffset(const Handle& handle) const noexcept;
+
+    // Compacts all live ranges to the start of a new buffer.
+    void defragment(VkDriver& driver);
+
+    // Returns ranges freed in frames which the GPU has now retired to the
+    // allocator.
+    void collectGarbage(uint64_t currentFrame) noexcept;
+
+    void destroy(GarbageCollector& gc) noexcept;
+
+    [[nodiscard]] vk::Buffer buffer() const noexcept
+    {
+        return buffer_ ? buffer_->get() : vk::Buffer {};
+    }
+
+    [[nodiscard]] VkDeviceSize capacity() const noexcept { return allocator_.capacity(); }
+    [[nodiscard]] VkDeviceSize usedSize() const noexcept { return allocator_.usedSize(); }
+    [[nodiscard]] size_t rangeCount() const noexcept { return ranges_.size(); }
+
+private:
+    VkDeviceSize allocateRange(VkDriver& driver, VkDeviceSize size, uint32_t alignment);
+
+    void releaseRange(VkDriver& driver, VkDeviceSize offset, VkDeviceSize size);
+
+    void upload(
+        VkDriver& driver, VkDeviceSize offset, VkDeviceSize size, const GeometryFillFunc& fillFunc);
+
+    void reallocate(VkDriver& driver, VkDeviceSize newCapacity, bool compact);
+
+private:
+    struct PendingRelease
+    {
+        VkDeviceSize offset;
+        VkDeviceSize size;
+        uint64_t frame;
+    };
+
+    VkBufferUsageFlags usage_;
+    VkDeviceSize initialCapacity_;
+
+    // the buffer is only allocated upon the first range being added
+    std::unique_ptr<Buffer> buffer_;
+
+    util::RangeAllocator allocator_;
+    util::SlotMap<RangeT> ranges_;
+
+    // ranges which may still be in use by frames in flight
+    std::vector<PendingRelease> pendingReleases_;
+};
+
+/**
+ All vertex and index data is held in two arena buffers rather than a buffer
+ per mesh. This means the buffers only need binding once per pass, with draws
+ offset into them via vertexOffset/firstIndex.
+ */
+class GeometryArena
+{
+public:
+    static constexpr VkDeviceSize InitialVertexCapacity = 32 * 1024 * 1024;
+    static constexpr VkDeviceSize InitialIndexCapacity = 8 * 1024 * 1024;
+
+    GeometryArena();
+
+    GeometryPool<VertexRange>& vertices() noexcept { return vertices_; }
+    GeometryPool<IndexRange>& indices() noexcept { return indices_; }
+
+    void defragment(VkDriver& driver);
+
+    void collectGarbage(uint64_t currentFrame) noexcept;
+
+    void destroy(GarbageCollector& gc) noexcept;
+
+private:
+    GeometryPool<VertexRange> vertices_;
+    GeometryPool<IndexRange> indices_;
+};
+
+} // namespace vkapi
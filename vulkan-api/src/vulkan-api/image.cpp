@@ -25,6 +25,7 @@
 #include "commands.h"
 #include "context.h"
 #include "driver.h"
+#include "garbage_collector.h"
 #include "utility/assertion.h"
 
 namespace vkapi
@@ -87,7 +88,8 @@ void ImageView::create(
     vk::Format format,
     uint8_t faceCount,
     uint8_t arrayCount,
-    uint32_t level)
+    uint32_t level,
+    uint32_t levelCount)
 {
     device_ = dev;
 
@@ -105,12 +107,33 @@ void ImageView::create(
          vk::ComponentSwizzle::eIdentity,
          vk::ComponentSwizzle::eIdentity,
          vk::ComponentSwizzle::eIdentity},
-        vk::ImageSubresourceRange(aspect, level, 1, 0, faceCount));
+        vk::ImageSubresourceRange(aspect, level, levelCount, 0, faceCount * arrayCount));
 
     VK_CHECK_RESULT(device_.createImageView(&createInfo, nullptr, &imageView_));
 }
 
-void ImageView::create(const vk::Device& dev, const Image& image, uint32_t level)
+void ImageView::createLayered(const vk::Device& dev, const Image& image, uint32_t level)
+{
+    device_ = dev;
+
+    const TextureContext& tex = image.context();
+    vk::ImageViewCreateInfo createInfo(
+        {},
+        image.get(),
+        vk::ImageViewType::e2DArray,
+        tex.format,
+        {vk::ComponentSwizzle::eIdentity,
+         vk::ComponentSwizzle::eIdentity,
+         vk::ComponentSwizzle::eIdentity,
+         vk::ComponentSwizzle::eIdentity},
+        vk::ImageSubresourceRange(
+            getImageAspect(tex.format), level, 1, 0, tex.faceCount * tex.arrayCount));
+
+    VK_CHECK_RESULT(device_.createImageView(&createInfo, nullptr, &imageView_));
+}
+
+void ImageView::create(
+    const vk::Device& dev, const Image& image, uint32_t level, uint32_t levelCount)
 {
     create(
         dev,
@@ -118,7 +141,8 @@ void ImageView::create(const vk::Device& dev, const Image& image, uint32_t level
         image.context().format,
         image.context().faceCount,
         image.context().arrayCount,
-        level);
+        level,
+        levelCount);
 }
 
 // ==================== Image ===================
@@ -143,10 +167,14 @@ Image::Image(
 
 Image::~Image() = default;
 
-void Image::destroy() noexcept
+void Image::destroy(GarbageCollector& gc) noexcept
 {
-    context_.device().freeMemory(imageMem_);
-    context_.device().destroyImage(image_, nullptr);
+    if (allocation_)
+    {
+        gc.add(image_, allocation_);
+    }
+    image_ = VK_NULL_HANDLE;
+    allocation_ = VK_NULL_HANDLE;
 }
 
 vk::Filter Image::getFilterType(const vk::Format& format)
@@ -165,7 +193,7 @@ vk::Filter Image::getFilterType(const vk::Format& format)
     return filter;
 }
 
-void Image::create(vk::ImageUsageFlags usageFlags)
+void Image::create(VkDriver& driver, vk::ImageUsageFlags usageFlags)
 {
     ASSERT_LOG(tex_.format != vk::Format::eUndefined);
 
@@ -175,7 +203,7 @@ void Image::create(vk::ImageUsageFlags usageFlags)
         tex_.format,
         {tex_.width, tex_.height, 1},
         tex_.mipLevels,
-        tex_.faceCount,
+        tex_.faceCount * tex_.arrayCount,
         vk::SampleCountFlagBits::e1,
         vk::ImageTiling::eOptimal,
         vk::ImageUsageFlagBits::eTransferDst | usageFlags,
@@ -186,23 +214,19 @@ void Image::create(vk::ImageUsageFlags usageFlags)
 
     if (tex_.faceCount == 6)
     {
-        imageInfo.arrayLayers = 6;
         imageInfo.flags = vk::ImageCreateFlagBits::eCubeCompatible;
     }
 
-    VK_CHECK_RESULT(device_.createImage(&imageInfo, nullptr, &image_));
-
-    // allocate memory for the image....
-    vk::MemoryRequirements memReq = {};
-    device_.getImageMemoryRequirements(image_, &memReq);
-    vk::MemoryAllocateInfo allocInfo = {
-        memReq.size,
-        context_.selectMemoryType(memReq.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal)};
-
-    VK_CHECK_RESULT(device_.allocateMemory(&allocInfo, nullptr, &imageMem_));
+    // images are only ever filled via a staging copy or written by the GPU
+    VmaAllocationCreateInfo allocCreateInfo =
+        MemoryTracker::getAllocationCreateInfo(MemoryUsage::StaticDeviceLocal);
 
-    // and bind the image to the allocated memory.
-    device_.bindImageMemory(image_, imageMem_, 0);
+    const VkImageCreateInfo& vkImageInfo = imageInfo;
+    VkImage image;
+    VMA_CHECK_RESULT(vmaCreateImage(
+        driver.vmaAlloc(), &vkImageInfo, &allocCreateInfo, &image, &allocation_, nullptr));
+    image_ = image;
+    driver.memoryTracker().add(driver.vmaAlloc(), allocation_, MemoryUsage::StaticDeviceLocal);
 }
 
 void Image::transition(
@@ -235,6 +259,9 @@ void Image::transition(
         case vk::ImageLayout::eShaderReadOnlyOptimal:
             srcBarrier = vk::AccessFlagBits::eShaderRead;
             break;
+        case vk::ImageLayout::eGeneral:
+            srcBarrier = vk::AccessFlagBits::eShaderWrite;
+            break;
         default:
             srcBarrier = (vk::AccessFlagBits)0;
     }
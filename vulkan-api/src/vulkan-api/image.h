@@ -34,6 +34,8 @@ namespace vkapi
 class VkContext;
 class Commands;
 class Image;
+class GarbageCollector;
+class VkDriver;
 
 class ImageView
 {
@@ -45,7 +47,7 @@ public:
 
     static vk::ImageViewType getTextureType(uint32_t faceCount, uint32_t arrayCount);
 
-    void create(const vk::Device& dev, const Image& image, uint32_t level);
+    void create(const vk::Device& dev, const Image& image, uint32_t level, uint32_t levelCount = 1);
 
     void create(
         const vk::Device& dev,
@@ -53,10 +55,25 @@ public:
         vk::Format format,
         uint8_t faceCount,
         uint8_t arrayCount,
-        uint32_t level);
+        uint32_t level,
+        uint32_t levelCount = 1);
+
+    // A 2d array view of a single level covering all faces and array layers,
+    // so that cube maps and arrays can be written to as one image in compute
+    // shaders.
+    void createLayered(const vk::Device& dev, const Image& image, uint32_t level);
 
     [[nodiscard]] const vk::ImageView& get() const { return imageView_; }
 
+    // Relinquishes ownership of the image view - the caller is responsible
+    // for its destruction.
+    vk::ImageView release() noexcept
+    {
+        vk::ImageView view = imageView_;
+        imageView_ = VK_NULL_HANDLE;
+        return view;
+    }
+
 private:
     vk::Device device_;
     vk::ImageView imageView_;
@@ -74,11 +91,13 @@ public:
     Image(VkContext& context, const Texture& tex);
     ~Image();
 
-    void destroy() noexcept;
+    // Passes the image and memory to the garbage collector. Images which are
+    // not owned by this object (i.e. swapchain images) are not destroyed.
+    void destroy(GarbageCollector& gc) noexcept;
 
     static vk::Filter getFilterType(const vk::Format& format);
 
-    void create(vk::ImageUsageFlags usageFlags);
+    void create(VkDriver& driver, vk::ImageUsageFlags usageFlags);
 
     static void transition(
         const Image& image,
@@ -100,7 +119,8 @@ private:
     vk::Device device_;
     TextureContext tex_;
     vk::Image image_;
-    vk::DeviceMemory imageMem_;
+    // only set if the image memory is owned by this object
+    VmaAllocation allocation_ = VK_NULL_HANDLE;
 };
 
 } // namespace vkapi
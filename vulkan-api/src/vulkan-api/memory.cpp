@@ -0,0 +1,119 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "memory.h"
+
+#include "utility/assertion.h"
+
+namespace vkapi
+{
+
+const char* memoryUsageToString(MemoryUsage usage) noexcept
+{
+    switch (usage)
+    {
+        case MemoryUsage::StaticDeviceLocal:
+            return "StaticDeviceLocal";
+        case MemoryUsage::DynamicUpload:
+            return "DynamicUpload";
+        case MemoryUsage::Readback:
+            return "Readback";
+        case MemoryUsage::DeviceLocalMapped:
+            return "DeviceLocalMapped";
+        default:
+            break;
+    }
+    return "Unknown";
+}
+
+VmaAllocationCreateInfo MemoryTracker::getAllocationCreateInfo(MemoryUsage usage) noexcept
+{
+    VmaAllocationCreateInfo createInfo = {};
+    switch (usage)
+    {
+        case MemoryUsage::StaticDeviceLocal:
+            createInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+            break;
+        case MemoryUsage::DynamicUpload:
+            createInfo.usage = VMA_MEMORY_USAGE_AUTO;
+            createInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+                VMA_ALLOCATION_CREATE_MAPPED_BIT;
+            break;
+        case MemoryUsage::Readback:
+            createInfo.usage = VMA_MEMORY_USAGE_AUTO;
+            createInfo.flags =
+                VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+            break;
+        case MemoryUsage::DeviceLocalMapped:
+            createInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+            createInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+                VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT |
+                VMA_ALLOCATION_CREATE_MAPPED_BIT;
+            break;
+        default:
+            ASSERT_LOG(false);
+    }
+    return createInfo;
+}
+
+void MemoryTracker::add(
+    VmaAllocator vmaAlloc, VmaAllocation allocation, MemoryUsage usage) noexcept
+{
+    ASSERT_LOG(usage < MemoryUsage::Count);
+
+    // offset by one so that untracked allocations have null user data
+    vmaSetAllocationUserData(
+        vmaAlloc, allocation, reinterpret_cast<void*>(static_cast<uintptr_t>(usage) + 1));
+
+    VmaAllocationInfo info;
+    vmaGetAllocationInfo(vmaAlloc, allocation, &info);
+
+    UsageStats& stats = stats_[static_cast<size_t>(usage)];
+    stats.bytes += info.size;
+    ++stats.allocationCount;
+}
+
+void MemoryTracker::remove(VmaAllocator vmaAlloc, VmaAllocation allocation) noexcept
+{
+    if (!allocation)
+    {
+        return;
+    }
+
+    VmaAllocationInfo info;
+    vmaGetAllocationInfo(vmaAlloc, allocation, &info);
+    if (!info.pUserData)
+    {
+        return;
+    }
+
+    auto idx = reinterpret_cast<uintptr_t>(info.pUserData) - 1;
+    ASSERT_LOG(idx < stats_.size());
+
+    UsageStats& stats = stats_[idx];
+    ASSERT_LOG(stats.bytes >= info.size && stats.allocationCount > 0);
+    stats.bytes -= info.size;
+    --stats.allocationCount;
+}
+
+} // namespace vkapi
@@ -0,0 +1,107 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "common.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace vkapi
+{
+
+/**
+ The intended use of an allocation. This determines the memory type selected
+ by VMA and whether the allocation is persistently mapped.
+ */
+enum class MemoryUsage : uint8_t
+{
+    // Only accessed by the GPU and filled via a staging copy, i.e. geometry
+    // and textures.
+    StaticDeviceLocal,
+    // Written sequentially by the host, usually every frame, i.e. uniform
+    // buffers and staging buffers.
+    DynamicUpload,
+    // Written by the GPU and read back on the host.
+    Readback,
+    // Device local memory which is also host visible (resizable BAR). If not
+    // available, VMA will fall back to device local memory which isn't
+    // mappable, so Buffer::isMapped() must be checked before writing directly.
+    DeviceLocalMapped,
+    Count
+};
+
+const char* memoryUsageToString(MemoryUsage usage) noexcept;
+
+/**
+ The current state of a memory heap as reported by VMA. If VK_EXT_memory_budget
+ is supported, the usage and budget are those reported by the driver and
+ include other processes, otherwise they are estimates.
+ */
+struct HeapBudget
+{
+    // bytes used and bytes available to this process
+    VkDeviceSize usage;
+    VkDeviceSize budget;
+    // bytes allocated by VMA as device memory blocks, and the bytes of
+    // those blocks in use by allocations.
+    VkDeviceSize blockBytes;
+    VkDeviceSize allocationBytes;
+    uint32_t allocationCount;
+    bool deviceLocal;
+};
+
+/**
+ Tracks the bytes allocated for each memory usage class. The usage class is
+ stored as the user data of the VMA allocation so it can be retrieved when the
+ allocation is destroyed.
+ */
+class MemoryTracker
+{
+public:
+    struct UsageStats
+    {
+        VkDeviceSize bytes = 0;
+        uint32_t allocationCount = 0;
+    };
+
+    MemoryTracker() = default;
+
+    static VmaAllocationCreateInfo getAllocationCreateInfo(MemoryUsage usage) noexcept;
+
+    void add(VmaAllocator vmaAlloc, VmaAllocation allocation, MemoryUsage usage) noexcept;
+
+    void remove(VmaAllocator vmaAlloc, VmaAllocation allocation) noexcept;
+
+    [[nodiscard]] const UsageStats& getStats(MemoryUsage usage) const noexcept
+    {
+        return stats_[static_cast<size_t>(usage)];
+    }
+
+private:
+    std::array<UsageStats, static_cast<size_t>(MemoryUsage::Count)> stats_;
+};
+
+} // namespace vkapi
@@ -276,9 +276,21 @@ std::vector<vk::PipelineShaderStageCreateInfo> ShaderProgramBundle::getShaderSta
 void ShaderProgramBundle::addDescriptorBinding(
     uint32_t size, uint32_t binding, vk::Buffer buffer, vk::DescriptorType type)
 {
-    ASSERT_FATAL(buffer, "VkBuffer has not been initialised.");
+    // a single buffer is shared across all frames in flight
+    FrameBuffers buffers;
+    buffers.fill(buffer);
+    addDescriptorBinding(size, binding, buffers, type);
+}
+
+void ShaderProgramBundle::addDescriptorBinding(
+    uint32_t size, uint32_t binding, const FrameBuffers& buffers, vk::DescriptorType type)
+{
+    for (const auto& buffer : buffers)
+    {
+        ASSERT_FATAL(buffer, "VkBuffer has not been initialised.");
+    }
     ASSERT_LOG(size > 0);
-    descBindInfo_.push_back({binding, buffer, size, type});
+    descBindInfo_.push_back({binding, buffers, size, type});
 }
 
 ShaderProgram* ShaderProgramBundle::getProgram(backend::ShaderStage type) noexcept
@@ -311,14 +323,15 @@ void ShaderProgramBundle::setImageSampler(
     imageSamplers_[binding] = {handle, sampler};
 }
 
-void ShaderProgramBundle::setStorageImage(const TextureHandle& handle, uint8_t binding)
+void ShaderProgramBundle::setStorageImage(
+    const TextureHandle& handle, uint8_t binding, uint32_t level, bool layered)
 {
     ASSERT_FATAL(handle, "Invalid texture handle.");
     ASSERT_FATAL(
         binding < PipelineCache::MaxStorageImageBindCount,
         "Binding of %d is out of bounds.",
         binding);
-    storageImages_[binding] = handle;
+    storageImages_[binding] = {handle, level, layered};
 }
 
 void ShaderProgramBundle::setPushBlockData(backend::ShaderStage stage, void* data)
@@ -333,6 +346,7 @@ void ShaderProgramBundle::addRenderPrimitive(
     vk::IndexType indexBufferType,
     uint32_t indicesCount,
     uint32_t indicesOffset,
+    uint32_t vertexOffset,
     VkBool32 primRestart)
 {
     renderPrim_.primitiveRestart = primRestart;
@@ -340,14 +354,16 @@ void ShaderProgramBundle::addRenderPrimitive(
     renderPrim_.indexBufferType = indexBufferType;
     renderPrim_.indicesCount = indicesCount;
     renderPrim_.offset = indicesOffset;
+    renderPrim_.vertexOffset = vertexOffset;
 }
 
 void ShaderProgramBundle::addRenderPrimitive(
-    vk::PrimitiveTopology topo, uint32_t vertexCount, VkBool32 primRestart)
+    vk::PrimitiveTopology topo, uint32_t vertexCount, uint32_t vertexOffset, VkBool32 primRestart)
 {
     renderPrim_.primitiveRestart = primRestart;
     renderPrim_.topology = topo;
     renderPrim_.vertexCount = vertexCount;
+    renderPrim_.vertexOffset = vertexOffset;
 }
 
 void ShaderProgramBundle::addRenderPrimitive(uint32_t vertexCount)
@@ -355,6 +371,18 @@ void ShaderProgramBundle::addRenderPrimitive(uint32_t vertexCount)
     renderPrim_.vertexCount = vertexCount;
 }
 
+void ShaderProgramBundle::setIndexRange(uint32_t indicesCount, uint32_t indicesOffset) noexcept
+{
+    renderPrim_.indicesCount = indicesCount;
+    renderPrim_.offset = indicesOffset;
+}
+
+void ShaderProgramBundle::setIndexRanges(const IndexRange* ranges, uint32_t count) noexcept
+{
+    renderPrim_.ranges = ranges;
+    renderPrim_.rangeCount = count;
+}
+
 void ShaderProgramBundle::setTesselationVertCount(size_t count) noexcept
 {
     tesselationVertCount_ = count;
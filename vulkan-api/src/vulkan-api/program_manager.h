@@ -24,6 +24,7 @@
 
 #include "backend/enums.h"
 #include "common.h"
+#include "frame_context.h"
 #include "pipeline.h"
 #include "pipeline_cache.h"
 #include "resource_cache.h"
@@ -134,14 +135,26 @@ public:
         vk::BlendOp alpha = vk::BlendOp::eAdd;
     };
 
+    struct IndexRange
+    {
+        uint32_t indicesCount = 0;
+        uint32_t offset = 0;
+    };
+
     struct RenderPrimitive
     {
         uint32_t indicesCount = 0;
         uint32_t offset = 0;
         uint32_t vertexCount = 0;
+        // added to the offset of the vertex buffer - the first vertex of the
+        // primitive if the buffer is shared between primitives
+        uint32_t vertexOffset = 0;
         vk::PrimitiveTopology topology = vk::PrimitiveTopology::eTriangleList;
         VkBool32 primitiveRestart = VK_FALSE;
         vk::IndexType indexBufferType = vk::IndexType::eUint32;
+        // if set, these ranges are drawn instead of the single index range
+        const IndexRange* ranges = nullptr;
+        uint32_t rangeCount = 0;
     };
 
     ShaderProgramBundle();
@@ -157,7 +170,10 @@ public:
 
     void setImageSampler(const TextureHandle& handle, uint8_t binding, vk::Sampler sampler);
 
-    void setStorageImage(const TextureHandle& handle, uint8_t binding);
+    // If layered is set, the level is bound as a 2d array covering all faces
+    // and array layers of the texture.
+    void setStorageImage(
+        const TextureHandle& handle, uint8_t binding, uint32_t level = 0, bool layered = false);
 
     void setPushBlockData(backend::ShaderStage stage, void* data);
 
@@ -174,14 +190,28 @@ public:
         vk::IndexType indexBufferType,
         uint32_t indicesCount,
         uint32_t indicesOffset,
+        uint32_t vertexOffset,
         VkBool32 primRestart = VK_FALSE);
 
     // used when no indices are to be used for the draw
-    void addRenderPrimitive(vk::PrimitiveTopology topo, uint32_t vertexCount, VkBool32 primRestart);
+    void addRenderPrimitive(
+        vk::PrimitiveTopology topo,
+        uint32_t vertexCount,
+        uint32_t vertexOffset,
+        VkBool32 primRestart);
 
     // used when no index buffer is to be bound.
     void addRenderPrimitive(uint32_t count);
 
+    // updates the index range of the render primitive - i.e. when drawing a
+    // different level of detail.
+    void setIndexRange(uint32_t indicesCount, uint32_t indicesOffset) noexcept;
+
+    // draws a number of index ranges with a single bind - i.e. the visible
+    // clusters of a mesh. The ranges must remain valid until the draw has been
+    // recorded. Passing no ranges reverts to the render primitive index range.
+    void setIndexRanges(const IndexRange* ranges, uint32_t count) noexcept;
+
     static util::CString loadShader(const util::CString& filename);
 
     void buildShader(const util::CString& shaderCode, backend::ShaderStage shaderType);
@@ -234,14 +264,23 @@ private:
     // Index into the resource cache for the texture for each attachment.
     std::array<ImageSamplerParams, PipelineCache::MaxSamplerBindCount> imageSamplers_;
 
-    std::array<TextureHandle, PipelineCache::MaxStorageImageBindCount> storageImages_;
+    struct StorageImageParams
+    {
+        TextureHandle texHandle;
+        uint32_t level = 0;
+        bool layered = false;
+    };
+
+    std::array<StorageImageParams, PipelineCache::MaxStorageImageBindCount> storageImages_;
 
     // We keep a record of descriptors here and their binding info for
-    // use at the pipeline binding draw stage
+    // use at the pipeline binding draw stage. Buffers which are updated by
+    // the CPU each frame have a buffer per frame in flight.
+    using FrameBuffers = std::array<vk::Buffer, FrameContext::MaxFramesInFlight>;
     struct DescriptorBindInfo
     {
         uint32_t binding = 0;
-        vk::Buffer buffer;
+        FrameBuffers buffers;
         uint32_t size = 0;
         vk::DescriptorType type;
     };
@@ -263,6 +302,9 @@ public:
 
     void addDescriptorBinding(
         uint32_t size, uint32_t binding, vk::Buffer buffer, vk::DescriptorType type);
+
+    void addDescriptorBinding(
+        uint32_t size, uint32_t binding, const FrameBuffers& buffers, vk::DescriptorType type);
 };
 
 template <typename... ShaderArgs>
@@ -45,111 +45,71 @@ TextureHandle ResourceCache::createTexture2d(
     const uint8_t faceCount,
     const uint8_t arrayCount)
 {
-    auto tex = new Texture(context_);
-    TextureHandle handle {tex};
-    tex->createTexture2d(
+    TextureHandle handle = textures_.emplace(context_);
+    textures_.get(handle)->createTexture2d(
         driver_, format, width, height, mipLevels, faceCount, arrayCount, usageFlags);
-    textures_.insert(tex);
     return handle;
 }
 
 TextureHandle ResourceCache::createTexture2d(
     vk::Format format, const uint32_t width, const uint32_t height, vk::Image image)
 {
-    auto tex = new Texture(context_);
-    TextureHandle handle {tex};
-    tex->createTexture2d(driver_, format, width, height, image);
-    textures_.insert(tex);
+    TextureHandle handle = textures_.emplace(context_);
+    textures_.get(handle)->createTexture2d(driver_, format, width, height, image);
     return handle;
 }
 
-BufferHandle ResourceCache::createUbo(const size_t size, VkBufferUsageFlags usage)
+BufferHandle
+ResourceCache::createUbo(const size_t size, VkBufferUsageFlags usage, MemoryUsage memUsage)
 {
-    auto buffer = new Buffer;
-    BufferHandle handle {buffer};
-    buffer->alloc(driver_.vmaAlloc(), static_cast<VkDeviceSize>(size), usage);
-    buffers_.insert(buffer);
+    BufferHandle handle = buffers_.emplace();
+    buffers_.get(handle)->alloc(driver_, static_cast<VkDeviceSize>(size), usage, memUsage);
     return handle;
 }
 
 void ResourceCache::deleteUbo(BufferHandle& handle)
 {
-    Buffer* buffer = handle.getResource();
-    // If the handle is invalidated we assume that the resource has already been
+    // If the handle is stale we assume that the resource has already been
     // deleted and allow this to fail silently.
-    if (!buffer)
+    if (!buffers_.isValid(handle))
     {
         return;
     }
-    auto iter = buffers_.find(const_cast<Buffer*>(buffer));
-    if (iter != buffers_.end())
-    {
-        buffer->framesUntilGc_ = Commands::MaxCommandBufferSize;
-        bufferGc_.insert(buffer);
-        buffers_.erase(iter);
-    }
+    // the vulkan resources are destroyed once the GPU has finished with
+    // them, so the slot can be recycled now.
+    buffers_.get(handle)->destroy(driver_.garbageCollector());
+    buffers_.erase(handle);
+    handle = {};
 }
 
 void ResourceCache::deleteTexture(TextureHandle& handle)
 {
-    Texture* tex = handle.getResource();
-    // If the handle is invalidated we assume that the resource has already been
-    // deleted and allow this to fail silently.
-    if (!tex)
+    if (!textures_.isValid(handle))
     {
         return;
     }
-    auto iter = textures_.find(const_cast<Texture*>(tex));
-    if (iter != textures_.end())
-    {
-        tex->framesUntilGc_ = Commands::MaxCommandBufferSize;
-        textureGc_.insert(tex);
-        textures_.erase(iter);
-    }
+    textures_.get(handle)->destroy(driver_.garbageCollector());
+    textures_.erase(handle);
+    handle = {};
 }
 
-void ResourceCache::garbageCollection() noexcept
+Texture* ResourceCache::getTexture(const TextureHandle& handle) noexcept
 {
-    std::unordered_set<Texture*> newTextureGc;
-    for (auto* tex : textureGc_)
-    {
-        if (!--tex->framesUntilGc_)
-        {
-            tex->destroy();
-        }
-        else
-        {
-            newTextureGc.insert(tex);
-        }
-    }
-    textureGc_.swap(newTextureGc);
+    return textures_.get(handle);
+}
 
-    std::unordered_set<Buffer*> newBufferGc;
-    for (auto* buffer : bufferGc_)
-    {
-        if (!--buffer->framesUntilGc_)
-        {
-            context_.device().destroy(buffer->get(), nullptr);
-        }
-        else
-        {
-            newBufferGc.insert(buffer);
-        }
-    }
-    bufferGc_.swap(newBufferGc);
+Buffer* ResourceCache::getBuffer(const BufferHandle& handle) noexcept
+{
+    return buffers_.get(handle);
 }
 
 void ResourceCache::clear() noexcept
 {
-    for (auto* tex : textureGc_)
-    {
-        tex->destroy();
-    }
-    for (auto* buffer : bufferGc_)
-    {
-        context_.device().destroy(buffer->get(), nullptr);
-    }
+    auto& gc = driver_.garbageCollector();
+    textures_.forEach([&gc](const TextureHandle&, Texture& tex) { tex.destroy(gc); });
+    buffers_.forEach([&gc](const BufferHandle&, Buffer& buffer) { buffer.destroy(gc); });
     textures_.clear();
+    buffers_.clear();
 }
 
 } // namespace vkapi
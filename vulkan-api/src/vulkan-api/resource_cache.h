@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "buffer.h"
 #include "common.h"
 #include "texture.h"
 #include "unordered_map"
@@ -30,50 +31,22 @@
 #include "utility/cstring.h"
 #include "utility/handle.h"
 #include "utility/murmurhash.h"
+#include "utility/slot_map.h"
 
 #include <memory>
-#include <unordered_set>
 #include <vector>
 
 namespace vkapi
 {
 // forward declerations
-class Buffer;
 class VkDriver;
 class VkContext;
 class GarbageCollector;
 
-template <typename T>
-class ResourceHandle
-{
-public:
-    explicit operator bool() const noexcept { return resource_ != nullptr; }
-
-    bool operator==(const ResourceHandle& rhs) const { return resource_ == rhs.getResource(); }
-    bool operator!=(const ResourceHandle& rhs) const { return resource_ != rhs.getResource(); }
-
-    ResourceHandle() : resource_(nullptr) {}
-    explicit ResourceHandle(T* key) : resource_(key) {}
-
-    ~ResourceHandle() = default;
-
-    ResourceHandle(const ResourceHandle&) = default;
-    ResourceHandle& operator=(const ResourceHandle&) = default;
-    ResourceHandle(ResourceHandle&&) noexcept = default;
-    ResourceHandle& operator=(ResourceHandle&&) = default;
-
-    const T* getResource() const noexcept { return resource_; }
-
-    T* getResource() noexcept { return resource_; }
-
-    void invalidate() noexcept { resource_ = nullptr; }
-
-private:
-    T* resource_ = nullptr;
-};
-
-using TextureHandle = ResourceHandle<Texture>;
-using BufferHandle = ResourceHandle<Buffer>;
+// Handles are a slot index and generation into the resource cache - use
+// VkDriver::getTexture()/getBuffer() to retrieve the resource.
+using TextureHandle = util::Handle<Texture>;
+using BufferHandle = util::Handle<Buffer>;
 
 class ResourceCache
 {
@@ -92,18 +65,37 @@ public:
     TextureHandle
     createTexture2d(vk::Format format, uint32_t width, uint32_t height, vk::Image image);
 
-    BufferHandle createUbo(size_t size, VkBufferUsageFlags usage);
+    BufferHandle createUbo(size_t size, VkBufferUsageFlags usage, MemoryUsage memUsage);
 
     void deleteUbo(BufferHandle& handle);
 
     void deleteTexture(TextureHandle& handle);
 
-    void garbageCollection() noexcept;
+    Texture* getTexture(const TextureHandle& handle) noexcept;
+
+    Buffer* getBuffer(const BufferHandle& handle) noexcept;
 
+    // Iterate over all live resources - i.e. for memory reporting.
+    template <typename Func>
+    void forEachTexture(Func&& func)
+    {
+        textures_.forEach(std::forward<Func>(func));
+    }
+
+    template <typename Func>
+    void forEachBuffer(Func&& func)
+    {
+        buffers_.forEach(std::forward<Func>(func));
+    }
+
+    [[nodiscard]] size_t textureCount() const noexcept { return textures_.size(); }
+    [[nodiscard]] size_t bufferCount() const noexcept { return buffers_.size(); }
+
+    // destroys all resources currently held by the cache
     void clear() noexcept;
 
-    using TextureMap = std::unordered_set<Texture*>;
-    using BufferMap = std::unordered_set<Buffer*>;
+    using TextureMap = util::SlotMap<Texture>;
+    using BufferMap = util::SlotMap<Buffer>;
 
 private:
     VkDriver& driver_;
@@ -112,9 +104,6 @@ private:
     // texture/buffer resources
     TextureMap textures_;
     BufferMap buffers_;
-
-    std::unordered_set<Texture*> textureGc_;
-    std::unordered_set<Buffer*> bufferGc_;
 };
 
 } // namespace vkapi
@@ -62,6 +62,11 @@ public:
 
     TextureHandle& getTexture(uint32_t index);
 
+    [[nodiscard]] uint32_t imageCount() const noexcept
+    {
+        return static_cast<uint32_t>(contexts_.size());
+    }
+
 private:
     /// creates the image views for the swapchain
     void prepareImageViews(VkDriver& driver, const vk::SurfaceFormatKHR& surfaceFormat);
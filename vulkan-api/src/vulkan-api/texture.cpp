@@ -30,12 +30,16 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 
 namespace vkapi
 {
 
 Texture::Texture(VkContext& context)
-    : context_(context), imageLayout_(vk::ImageLayout::eUndefined), framesUntilGc_(0)
+    : context_(context), imageLayout_(vk::ImageLayout::eUndefined)
 {
 }
 Texture::~Texture() = default;
@@ -164,15 +168,29 @@ uint32_t Texture::getFormatByteSize(vk::Format format)
     return output;
 }
 
-void Texture::destroy() const
+void Texture::destroy(GarbageCollector& gc)
 {
     if (image_)
     {
-        image_->destroy();
+        image_->destroy(gc);
     }
     for (uint32_t level = 0; level < texContext_.mipLevels; ++level)
     {
-        context_.device().destroyImageView(imageView_[level]->get(), nullptr);
+        if (imageView_[level])
+        {
+            gc.add(imageView_[level]->release());
+        }
+    }
+    if (sampledView_)
+    {
+        gc.add(sampledView_->release());
+    }
+    for (auto& view : layeredViews_)
+    {
+        if (view)
+        {
+            gc.add(view->release());
+        }
     }
 }
 
@@ -193,10 +211,11 @@ void Texture::createTexture2d(
         MaxMipCount);
 
     texContext_ = {format, width, height, mipLevels, faceCount, arrayCount};
+    usageFlags_ = usageFlags;
 
     // create an empty image
     image_ = std::make_unique<Image>(driver.context(), *this);
-    image_->create(usageFlags);
+    image_->create(driver, usageFlags);
 
     // and a image view for each mip level
     for (int level = 0; level < mipLevels; ++level)
@@ -228,66 +247,235 @@ void Texture::createTexture2d(
 
 void Texture::map(VkDriver& driver, void* data, uint32_t dataSize, size_t* offsets)
 {
-    StagingPool stagePool = driver.stagingPool();
-    StagingPool::StageInfo* stage = stagePool.create(dataSize);
+    StagingPool::StageInfo* stage =
+        driver.stagingPool().getStage(dataSize, driver.getCurrentFrame());
 
     memcpy(stage->allocInfo.pMappedData, data, dataSize);
     vmaFlushAllocation(driver.vmaAlloc(), stage->mem, 0, dataSize);
 
+    // now copy image to local device - first prepare the image for copying via
+    // transitioning to a transfer state. After copying, the image is
+    // transistioned ready for reading by the shader
+    auto& cmds = driver.getCommands();
+    auto& cBuffer = cmds.getCmdBuffer();
+
+    Image::transition(
+        *image_,
+        vk::ImageLayout::eUndefined,
+        vk::ImageLayout::eTransferDstOptimal,
+        cBuffer.cmdBuffer);
+
+    copyFromStage(cBuffer.cmdBuffer, stage->buffer, 0, offsets);
+
+    // the final transition here may need improving on....
+    Image::transition(
+        *image_, vk::ImageLayout::eTransferDstOptimal, imageLayout_, cBuffer.cmdBuffer);
+}
+
+std::vector<vk::BufferImageCopy> Texture::getLevelCopies(
+    VkDeviceSize stageOffset, const size_t* offsets, uint32_t levelCount) const
+{
+    const uint32_t mipLevels = levelCount ? levelCount : texContext_.mipLevels;
+    ASSERT_LOG(mipLevels <= texContext_.mipLevels);
+    const uint32_t copyCount = texContext_.faceCount * mipLevels;
+
+    // if no offsets are given, the faces and levels are tightly packed
+    std::vector<size_t> packedOffsets;
     if (!offsets)
     {
-        offsets = new size_t[texContext_.faceCount * texContext_.mipLevels];
-        uint32_t offset = 0;
+        packedOffsets.resize(copyCount);
+        size_t offset = 0;
         for (uint32_t face = 0; face < texContext_.faceCount; face++)
         {
-            for (uint32_t level = 0; level < texContext_.mipLevels; ++level)
+            for (uint32_t level = 0; level < mipLevels; ++level)
             {
-                offsets[face * texContext_.mipLevels + level] = offset;
-                offset += (texContext_.width >> level) * (texContext_.height >> level) *
-                    getFormatCompSize(texContext_.format) * getFormatByteSize(texContext_.format);
+                packedOffsets[face * mipLevels + level] = offset;
+                offset += getLevelSize(level);
             }
         }
+        offsets = packedOffsets.data();
     }
 
     // create the info required for the copy
     std::vector<vk::BufferImageCopy> copyBuffers;
+    copyBuffers.reserve(copyCount);
     for (uint32_t face = 0; face < texContext_.faceCount; ++face)
     {
-        for (uint32_t level = 0; level < texContext_.mipLevels; ++level)
+        for (uint32_t level = 0; level < mipLevels; ++level)
         {
             vk::BufferImageCopy imageCopy(
-                offsets[face * texContext_.mipLevels + level],
+                stageOffset + offsets[face * mipLevels + level],
                 0,
                 0,
                 {vk::ImageAspectFlagBits::eColor, level, face, 1},
                 {0, 0, 0},
-                {texContext_.width >> level, texContext_.height >> level, 1});
+                {std::max(texContext_.width >> level, 1u),
+                 std::max(texContext_.height >> level, 1u),
+                 1});
             copyBuffers.emplace_back(imageCopy);
         }
     }
+    return copyBuffers;
+}
 
-    // now copy image to local device - first prepare the image for copying via
-    // transitioning to a transfer state. After copying, the image is
-    // transistioned ready for reading by the shader
-    auto& cmds = driver.getCommands();
-    auto& cBuffer = cmds.getCmdBuffer();
+size_t Texture::getLevelSize(uint32_t level) const
+{
+    const uint32_t width = std::max(texContext_.width >> level, 1u);
+    const uint32_t height = std::max(texContext_.height >> level, 1u);
+    const uint32_t blockSize = getBlockByteSize(texContext_.format);
+    if (blockSize)
+    {
+        // compressed levels are stored as whole 4x4 blocks
+        return ((width + 3) / 4) * ((height + 3) / 4) * blockSize;
+    }
+    return width * height * getFormatCompSize(texContext_.format) *
+        getFormatByteSize(texContext_.format);
+}
 
-    Image::transition(
-        *image_,
-        vk::ImageLayout::eUndefined,
-        vk::ImageLayout::eTransferDstOptimal,
-        cBuffer.cmdBuffer);
+size_t Texture::getDataSize() const
+{
+    size_t size = 0;
+    for (uint32_t level = 0; level < texContext_.mipLevels; ++level)
+    {
+        size += getLevelSize(level);
+    }
+    return size * texContext_.faceCount;
+}
 
-    cBuffer.cmdBuffer.copyBufferToImage(
-        stage->buffer,
+void Texture::copyFromStage(
+    vk::CommandBuffer cmdBuffer,
+    vk::Buffer stage,
+    VkDeviceSize stageOffset,
+    const size_t* offsets,
+    uint32_t levelCount) const
+{
+    auto copyBuffers = getLevelCopies(stageOffset, offsets, levelCount);
+    cmdBuffer.copyBufferToImage(
+        stage,
         image_->get(),
         vk::ImageLayout::eTransferDstOptimal,
         static_cast<uint32_t>(copyBuffers.size()),
         copyBuffers.data());
+}
+
+void Texture::copyToStage(vk::CommandBuffer cmdBuffer, vk::Buffer stage)
+{
+    Image::transition(*image_, imageLayout_, vk::ImageLayout::eTransferSrcOptimal, cmdBuffer);
+
+    auto copyBuffers = getLevelCopies(0, nullptr, 0);
+    cmdBuffer.copyImageToBuffer(
+        image_->get(),
+        vk::ImageLayout::eTransferSrcOptimal,
+        stage,
+        static_cast<uint32_t>(copyBuffers.size()),
+        copyBuffers.data());
+
+    Image::transition(*image_, vk::ImageLayout::eTransferSrcOptimal, imageLayout_, cmdBuffer);
+}
+
+void Texture::reallocate(
+    VkDriver& driver,
+    vk::CommandBuffer cmdBuffer,
+    uint32_t width,
+    uint32_t height,
+    uint32_t mipLevels)
+{
+    ASSERT_FATAL(
+        mipLevels < MaxMipCount,
+        "Requested mip levels of %d exceed max allowed count: %d",
+        mipLevels,
+        MaxMipCount);
+    ASSERT_LOG(image_);
+
+    std::unique_ptr<Image> oldImage = std::move(image_);
+    const uint32_t oldMipLevels = texContext_.mipLevels;
+
+    texContext_.width = width;
+    texContext_.height = height;
+    texContext_.mipLevels = mipLevels;
+    image_ = std::make_unique<Image>(driver.context(), *this);
+    image_->create(driver, usageFlags_);
 
-    // the final transition here may need improving on....
     Image::transition(
-        *image_, vk::ImageLayout::eTransferDstOptimal, imageLayout_, cBuffer.cmdBuffer);
+        *oldImage,
+        imageLayout_,
+        vk::ImageLayout::eTransferSrcOptimal,
+        cmdBuffer,
+        vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eTransfer);
+    Image::transition(
+        *image_,
+        vk::ImageLayout::eUndefined,
+        vk::ImageLayout::eTransferDstOptimal,
+        cmdBuffer,
+        vk::PipelineStageFlagBits::eTopOfPipe,
+        vk::PipelineStageFlagBits::eTransfer);
+
+    // the smallest levels of both images line up
+    const uint32_t sharedLevels = std::min(oldMipLevels, mipLevels);
+    const uint32_t oldFirstLevel = oldMipLevels - sharedLevels;
+    const uint32_t newFirstLevel = mipLevels - sharedLevels;
+    const vk::ImageAspectFlags aspect = ImageView::getImageAspect(texContext_.format);
+    const uint32_t layerCount = texContext_.faceCount;
+
+    std::vector<vk::ImageCopy> copies;
+    copies.reserve(sharedLevels);
+    for (uint32_t i = 0; i < sharedLevels; ++i)
+    {
+        const uint32_t level = newFirstLevel + i;
+        copies.emplace_back(
+            vk::ImageSubresourceLayers {aspect, oldFirstLevel + i, 0, layerCount},
+            vk::Offset3D {0, 0, 0},
+            vk::ImageSubresourceLayers {aspect, level, 0, layerCount},
+            vk::Offset3D {0, 0, 0},
+            vk::Extent3D {std::max(width >> level, 1u), std::max(height >> level, 1u), 1});
+    }
+    if (!copies.empty())
+    {
+        cmdBuffer.copyImage(
+            oldImage->get(),
+            vk::ImageLayout::eTransferSrcOptimal,
+            image_->get(),
+            vk::ImageLayout::eTransferDstOptimal,
+            static_cast<uint32_t>(copies.size()),
+            copies.data());
+    }
+
+    // the old image may still be in use by frames in flight
+    GarbageCollector& gc = driver.garbageCollector();
+    oldImage->destroy(gc);
+    for (uint32_t level = 0; level < oldMipLevels; ++level)
+    {
+        if (imageView_[level])
+        {
+            gc.add(imageView_[level]->release());
+            imageView_[level].reset();
+        }
+    }
+    for (uint32_t level = 0; level < mipLevels; ++level)
+    {
+        imageView_[level] = std::make_unique<ImageView>(driver.context());
+        imageView_[level]->create(driver.context().device(), *image_, level);
+    }
+    for (auto& view : layeredViews_)
+    {
+        if (view)
+        {
+            gc.add(view->release());
+            view.reset();
+        }
+    }
+    if (sampledView_)
+    {
+        gc.add(sampledView_->release());
+        createSampledView(driver);
+    }
+}
+
+void Texture::createSampledView(VkDriver& driver)
+{
+    sampledView_ = std::make_unique<ImageView>(driver.context());
+    sampledView_->create(driver.context().device(), *image_, 0, texContext_.mipLevels);
 }
 
 void Texture::transition(
@@ -332,6 +520,23 @@ ImageView* Texture::getImageView(uint32_t level) const
     return imageView_[level].get();
 }
 
+ImageView* Texture::getSampledView() const
+{
+    return sampledView_ ? sampledView_.get() : getImageView(0);
+}
+
+ImageView* Texture::getLayeredView(uint32_t level)
+{
+    ASSERT_LOG(level < texContext_.mipLevels);
+    ASSERT_LOG(image_);
+    if (!layeredViews_[level])
+    {
+        layeredViews_[level] = std::make_unique<ImageView>(context_);
+        layeredViews_[level]->createLayered(context_.device(), *image_, level);
+    }
+    return layeredViews_[level].get();
+}
+
 Image* Texture::getImage() const
 {
     ASSERT_LOG(image_);
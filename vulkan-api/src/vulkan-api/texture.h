@@ -26,6 +26,7 @@
 #include "utility/compiler.h"
 
 #include <memory>
+#include <vector>
 
 namespace vkapi
 {
@@ -34,7 +35,7 @@ class Image;
 class ImageView;
 class VkDriver;
 class VkContext;
-class VkDriver;
+class GarbageCollector;
 
 /**
  * A simple struct for storing all texture info and ease of passing around
@@ -76,10 +77,44 @@ public:
     void createTexture2d(
         VkDriver& driver, vk::Format format, uint32_t width, uint32_t height, vk::Image image);
 
-    void destroy() const;
+    // passes all vulkan resources to the garbage collector for destruction
+    void destroy(GarbageCollector& gc);
 
     void map(VkDriver& driver, void* data, uint32_t dataSize, size_t* offsets);
 
+    // records the copy of all faces and mip levels from a staging buffer.
+    // The image must be in the transfer dst layout. If a level count is given,
+    // only the first levelCount levels are copied and the offsets are indexed
+    // by face * levelCount + level.
+    void copyFromStage(
+        vk::CommandBuffer cmdBuffer,
+        vk::Buffer stage,
+        VkDeviceSize stageOffset,
+        const size_t* offsets,
+        uint32_t levelCount = 0) const;
+
+    // records the copy of all faces and mip levels to a staging buffer,
+    // tightly packed by face and then level.
+    void copyToStage(vk::CommandBuffer cmdBuffer, vk::Buffer stage);
+
+    /**
+     * @brief Re-creates the image with new dimensions and mip level count,
+     * keeping the texture handle valid. The levels of the old and new images
+     * are aligned at the smallest level, and the levels common to both are
+     * copied across on the gpu. The old image is passed to the garbage
+     * collector and the new image is left in the transfer dst layout.
+     */
+    void reallocate(
+        VkDriver& driver,
+        vk::CommandBuffer cmdBuffer,
+        uint32_t width,
+        uint32_t height,
+        uint32_t mipLevels);
+
+    // Creates a view of all mip levels which is used when sampling the
+    // texture, rather than the view of the first level only.
+    void createSampledView(VkDriver& driver);
+
     void transition(
         vk::ImageLayout oldLayout,
         vk::ImageLayout newLayout,
@@ -97,14 +132,28 @@ public:
     // ================= getters =======================
 
     [[nodiscard]] ImageView* getImageView(uint32_t level = 0) const;
+    [[nodiscard]] ImageView* getSampledView() const;
+    // A 2d array view of the level covering all faces and layers - created on
+    // first use. Used for binding the levels as storage images.
+    ImageView* getLayeredView(uint32_t level);
     [[nodiscard]] Image* getImage() const;
     [[nodiscard]] const vk::ImageLayout& getImageLayout() const;
 
     [[nodiscard]] const TextureContext& context() const;
     [[nodiscard]] bool isCubeMap() const noexcept { return texContext_.faceCount == 6; }
+    [[nodiscard]] vk::ImageUsageFlags getUsageFlags() const noexcept { return usageFlags_; }
+
+    // the size in bytes of a single face of the level
+    [[nodiscard]] size_t getLevelSize(uint32_t level) const;
+    // the size in bytes of all faces and levels when tightly packed
+    [[nodiscard]] size_t getDataSize() const;
 
     friend class ResourceCache;
 
+private:
+    std::vector<vk::BufferImageCopy>
+    getLevelCopies(VkDeviceSize stageOffset, const size_t* offsets, uint32_t levelCount) const;
+
 private:
     VkContext& context_;
 
@@ -112,10 +161,12 @@ private:
 
     vk::ImageLayout imageLayout_;
 
+    vk::ImageUsageFlags usageFlags_;
+
     std::unique_ptr<Image> image_;
     std::unique_ptr<ImageView> imageView_[MaxMipCount];
-
-    uint64_t framesUntilGc_;
+    std::unique_ptr<ImageView> sampledView_;
+    std::unique_ptr<ImageView> layeredViews_[MaxMipCount];
 };
 
 } // namespace vkapi
@@ -174,6 +174,32 @@ bool isStencil(const vk::Format format)
         std::end(stencilFormats);
 }
 
+uint32_t getBlockByteSize(vk::Format format)
+{
+    uint32_t output = 0;
+    switch (format)
+    {
+        case vk::Format::eBc1RgbUnormBlock:
+        case vk::Format::eBc1RgbaUnormBlock:
+        case vk::Format::eBc4UnormBlock:
+        case vk::Format::eEtc2R8G8B8UnormBlock:
+        case vk::Format::eEacR11UnormBlock:
+            output = 8;
+            break;
+        case vk::Format::eBc3UnormBlock:
+        case vk::Format::eBc5UnormBlock:
+        case vk::Format::eBc7UnormBlock:
+        case vk::Format::eEtc2R8G8B8A8UnormBlock:
+        case vk::Format::eEacR11G11UnormBlock:
+        case vk::Format::eAstc4x4UnormBlock:
+            output = 16;
+            break;
+        default:
+            break;
+    }
+    return output;
+}
+
 bool isBufferType(const vk::DescriptorType& type)
 {
     if (type == vk::DescriptorType::eUniformBuffer || type == vk::DescriptorType::eStorageBuffer ||
@@ -31,6 +31,10 @@ namespace vkapi
 
 bool isDepth(vk::Format format);
 bool isStencil(vk::Format format);
+
+// The size in bytes of a 4x4 texel block if the format is block compressed,
+// otherwise zero.
+uint32_t getBlockByteSize(vk::Format format);
 bool isBufferType(const vk::DescriptorType& type);
 bool isSamplerType(const vk::DescriptorType& type);
 
@@ -23,6 +23,7 @@
 
 #include "vulkan-api/driver.h"
 #include "vulkan-api/swapchain.h"
+#include "options.h"
 #include "yave_api.h"
 
 #include <filesystem>
@@ -88,10 +89,13 @@ public:
 
     Camera* createCamera();
 
-    WaveGenerator* createWaveGenerator(Scene* scene);
+    WaveGenerator* createWaveGenerator(Scene* scene, const OceanOptions& options = {});
 
     void flushCmds();
 
+    void setStreamingOptions(const StreamingOptions& options);
+    StreamingOptions& getStreamingOptions();
+
     void destroy(IndexBuffer* buffer);
     void destroy(VertexBuffer* buffer);
     void destroy(RenderPrimitive* buffer);
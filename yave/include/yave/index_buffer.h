@@ -26,6 +26,7 @@
 #include <backend/enums.h>
 
 #include <cstdint>
+#include <functional>
 
 namespace yave
 {
@@ -37,6 +38,18 @@ public:
     void
     build(Engine* engine, uint32_t indicesCount, void* indicesData, backend::IndexBufferType type);
 
+    /**
+     * @brief Builds the index buffer, with the indices written by the fill function
+     * directly into the mapped upload memory.
+     * @param fillFunc Called with a pointer to mapped memory large enough to hold
+     * indicesCount indices of the specified type.
+     */
+    void build(
+        Engine* engine,
+        uint32_t indicesCount,
+        backend::IndexBufferType type,
+        const std::function<void(void*)>& fillFunc);
+
 protected:
     IndexBuffer() = default;
     ~IndexBuffer() = default;
@@ -23,19 +23,43 @@
 
 #include "yave_api.h"
 
+#include <utility/spherical_harmonics.h>
+
 #include <cstdint>
 
 namespace yave
 {
+class Engine;
 class Texture;
 
 class IndirectLight
 {
 public:
+    enum class ShProjection
+    {
+        Cpu,
+        Compute
+    };
+
     void setIrrandianceMap(Texture* irradianceMap) noexcept;
 
     void setSpecularMap(Texture* specularMap, Texture* brdfLut);
 
+    /**
+     * @brief Uses L2 spherical harmonics for the diffuse lighting in place of
+     * the irradiance map - this saves the memory of the map and a texture
+     * fetch per pixel. The environment cube map is projected on the cpu, or
+     * with a compute dispatch, and this blocks until the projection has
+     * completed. It is cheap enough to be called again as the sky changes.
+     * @param envMap The environment cube map - an RGBA float format is
+     * required for the cpu projection.
+     */
+    void setIrradianceSh(
+        Engine* engine, Texture* envMap, ShProjection projection = ShProjection::Compute);
+
+    // Sets previously projected coefficients - see util::sh::projectCubeMap().
+    void setIrradianceSh(const util::sh::Coefficients& coeffs) noexcept;
+
 protected:
     IndirectLight() = default;
     ~IndirectLight() = default;
@@ -21,6 +21,9 @@
  */
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
 namespace yave
 {
 
@@ -38,4 +41,69 @@ struct GbufferOptions
     size_t height = 2048;
 };
 
+struct LodOptions
+{
+    bool enabled = true;
+    // the maximum projected error of a lod as a fraction of the screen height.
+    float screenError = 0.001f;
+    // scales the allowed error - values greater than one select coarser lods.
+    float bias = 1.0f;
+    // switching to a coarser lod requires the error to be this fraction below
+    // the limit, stopping renderables on the boundary flicking between levels.
+    float hysteresis = 0.2f;
+};
+
+struct ClusterCullOptions
+{
+    // culls the clusters of meshes which have them against the frustum
+    bool enabled = true;
+    // additionally culls clusters whose triangles all face away from the camera
+    bool backfaceCulling = true;
+};
+
+struct StreamingOptions
+{
+    // if disabled, streamed textures are fully loaded when set
+    bool enabled = true;
+    // the mip levels no larger than this are always resident
+    uint32_t mipTailSize = 128;
+    // the maximum size in bytes of the streamed mip levels resident on the
+    // gpu - the least recently used levels are evicted above this.
+    size_t budget = 256 * 1024 * 1024;
+    // the maximum size in bytes of the mip levels that may be loading at once
+    size_t maxPendingSize = 32 * 1024 * 1024;
+    // added to the mip level required by the texel density - positive values
+    // stream in lower resolution levels.
+    float bias = 0.0f;
+};
+
+struct OceanOptions
+{
+    static constexpr uint32_t MaxCascadeCount = 4;
+
+    // the resolution of the fft grid - must be a power of two between 64 and
+    // 1024. Higher resolutions add finer detail at a higher gpu cost.
+    uint32_t resolution = 256;
+    // the number of spectrum cascades - each simulates the waves of a
+    // different band of wavelengths over a tile of its own size.
+    uint32_t cascadeCount = 3;
+    // the size of the tile of each cascade in world units, largest first
+    float patchSizes[MaxCascadeCount] = {1000.0f, 250.0f, 64.0f, 16.0f};
+    // The number of frames between updates of the coarsest cascade. The
+    // interval halves with each finer cascade, with the finest updated every
+    // frame. Cascades are interpolated between updates.
+    uint32_t coarsestUpdateInterval = 4;
+    // The resolution of the cpu mirror of the spectrum used for displacement
+    // queries - zero disables queries. Must be a power of two no greater than
+    // the resolution. Higher resolutions add the shorter waves to the queried
+    // height at a higher cpu cost.
+    uint32_t queryResolution = 64;
+    // The ocean surface is drawn as nested rings of patches centred on the
+    // camera, with the patch size doubling with each ring. The extent of the
+    // surface is 4 * clipmapPatchSize * 2^(clipmapRingCount - 1), so it can
+    // reach the horizon with few patches. At most 16 rings.
+    float clipmapPatchSize = 8.0f;
+    uint32_t clipmapRingCount = 10;
+};
+
 } // namespace yave
\ No newline at end of file
@@ -38,6 +38,24 @@ public:
 
     void addMeshDrawData(size_t indexCount, size_t offset, size_t vertexCount);
 
+    /**
+     * @brief Adds a level of detail - an index range which references the same
+     * vertex buffer. Levels must be added in order of increasing error, after the
+     * full detail range has been set with **addMeshDrawData**.
+     * @param error The simplification error as a fraction of the primitive extent.
+     */
+    void addLodDrawData(size_t indexCount, size_t offset, float error);
+
+    /**
+     * @brief Sets the clusters of the full detail index range. Clusters which
+     * are outside of the frustum or back facing are culled each frame - the
+     * clusters must cover the whole full detail range.
+     */
+    void setClusters(const std::vector<ModelMesh::Cluster>& clusters);
+
+    // the object space extents, used for culling and lod selection
+    void setDimensions(const mathfu::vec3& min, const mathfu::vec3& max);
+
     void setTopology(Topology topo);
 
     void enablePrimitiveRestart() noexcept;
@@ -46,6 +64,12 @@ public:
 
     void setIndexBuffer(IndexBuffer* iBuffer);
 
+    /**
+     * @brief Sets the first vertex of the primitive when its vertex buffer is
+     * shared with other primitives - the indices are relative to this vertex.
+     */
+    void setVertexOffset(uint32_t offset);
+
     void setMaterial(Material* mat);
 
 protected:
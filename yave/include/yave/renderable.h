@@ -23,12 +23,27 @@
 
 #include "yave_api.h"
 
+#include <mathfu/glsl_mappings.h>
+
 #include <memory>
 
 namespace yave
 {
 class RenderPrimitive;
 
+/**
+ * @brief Per-instance overrides of the material parameters. The factors scale
+ * the values of the material, which is shared between all instances of a
+ * model, so the defaults leave the material unchanged.
+ */
+struct MaterialOverrides
+{
+    mathfu::vec4 baseColourFactor {1.0f};
+    mathfu::vec4 emissiveFactor {1.0f};
+    float roughnessFactor = 1.0f;
+    float metallicFactor = 1.0f;
+};
+
 class Renderable : public YaveApi
 {
 public:
@@ -38,6 +53,8 @@ public:
 
     void skipVisibilityChecks();
 
+    void setMaterialOverrides(const MaterialOverrides& overrides) noexcept;
+
 protected:
     Renderable() = default;
     ~Renderable() = default;
@@ -44,6 +44,17 @@ public:
         const ModelTransform& transform,
         const std::string& matShader = "default.glsl");
 
+    /**
+     * @brief Creates an instance of the renderable of the prototype Object,
+     * sharing its geometry, materials and node hierachy. This is much cheaper
+     * than building a new renderable for each copy of a model. The materials
+     * can be varied per instance with @p Renderable::setMaterialOverrides.
+     * Note: The prototype must have been built with **build** and the instance
+     * Object still needs adding to the scene.
+     */
+    Renderable*
+    buildInstance(const Object& prototype, Object& obj, const ModelTransform& transform);
+
     Material* createMaterial() noexcept;
 
     void destroy(const Object& obj);
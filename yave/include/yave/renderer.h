@@ -27,6 +27,7 @@
 #include <utility/colour.h>
 #include <utility/cstring.h>
 #include <utility/timer.h>
+#include <vulkan-api/frame_context.h>
 #include <vulkan-api/renderpass.h>
 
 #include <memory>
@@ -92,6 +93,9 @@ public:
 
     void endFrame();
 
+    // CPU and GPU wait times for the most recently completed frame.
+    [[nodiscard]] const vkapi::FrameContext::FrameTimings& getFrameTimings() const;
+
     void render(
         Engine* engine,
         Scene* scene,
@@ -55,8 +55,12 @@ public:
 
     void setBloomOptions(const BloomOptions& bloom);
     void setGbufferOptions(const GbufferOptions& gb);
+    void setLodOptions(const LodOptions& lod);
+    void setClusterCullOptions(const ClusterCullOptions& cull);
     BloomOptions& getBloomOptions();
     GbufferOptions& getGbufferOptions();
+    LodOptions& getLodOptions();
+    ClusterCullOptions& getClusterCullOptions();
 
 protected:
     Scene() = default;
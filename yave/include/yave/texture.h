@@ -25,14 +25,19 @@
 
 #include <backend/enums.h>
 
+#include <functional>
+#include <vector>
+
 namespace yave
 {
+class Engine;
 
 class Texture : public YaveApi
 {
 public:
     using TextureFormat = backend::TextureFormat;
     using ImageUsage = backend::ImageUsage;
+    using MipFilter = backend::MipFilter;
 
     struct Params
     {
@@ -48,6 +53,49 @@ public:
 
     void setTexture(const Params& params, size_t* offsets = nullptr) noexcept;
 
+    struct Upload
+    {
+        Texture* texture = nullptr;
+        // the params buffer is unused - the data is written by the fill function
+        Params params;
+        // Called with a pointer to mapped upload memory of params.bufferSize bytes.
+        std::function<void(void*)> fillFunc;
+    };
+
+    /**
+     * @brief Sets the image data of a number of textures, which are uploaded as a
+     * single batch through one staging buffer. The fill functions are called
+     * concurrently, writing the image data directly into the mapped upload memory,
+     * so expensive work such as image decoding can be carried out in the fill
+     * function.
+     */
+    static void setTextures(Engine* engine, const std::vector<Upload>& uploads) noexcept;
+
+    /**
+     * @brief Whether the device can sample from textures of the specified
+     * format - block compressed formats depend on the device.
+     */
+    static bool isFormatSupported(Engine* engine, TextureFormat format) noexcept;
+
+    struct StreamParams
+    {
+        // the dimensions of the complete mip chain - the buffer is unused
+        Params params;
+        // the size in bytes of each mip level, including all faces
+        std::vector<size_t> levelSizes;
+        // Writes the data of a mip level to dst, with the faces tightly packed.
+        // Called from worker threads, possibly for different levels at once.
+        std::function<void(uint32_t level, void* dst)> fillFunc;
+    };
+
+    /**
+     * @brief Sets a texture whose mip levels are streamed. Only the mip tail is
+     * loaded here - the larger levels are loaded asynchronously once the
+     * texture is drawn at a size which requires them, and evicted again when
+     * over the streaming budget. See StreamingOptions.
+     */
+    void setStreamedTexture(const StreamParams& params) noexcept;
+
     void setEmptyTexture(
         uint32_t width,
         uint32_t height,
@@ -58,7 +106,31 @@ public:
 
     Params getTextureParams() noexcept;
 
-    void generateMipMaps();
+    /**
+     * @brief Copies all faces and mip levels of the texture back from the
+     * gpu, tightly packed by face and then level. Blocks until the copy has
+     * completed - intended for offline work such as baking textures to disk.
+     */
+    std::vector<uint8_t> download();
+
+    /**
+     * @brief Generates all levels below the first level. Textures created
+     * with storage usage are downsampled in a single compute pass, which
+     * supports each of the filters; other textures use a linear blit.
+     * @param srgb Whether the colour channels should be filtered in linear
+     * space, for sRGB data stored in a unorm format.
+     */
+    void generateMipMaps(MipFilter filter = MipFilter::Box, bool srgb = false);
+
+    /**
+     * @brief Fills each level of this cube map with the environment map
+     * convolved with the GGX lobe, for specular image based lighting. The
+     * roughness increases linearly over the levels. This texture must be
+     * created with storage usage, and the environment map should have a full
+     * mip chain.
+     * @param sampleCount The number of samples taken at a roughness of one.
+     */
+    void prefilterSpecular(Texture* envMap, uint32_t sampleCount = 32);
 
 protected:
     Texture() = default;
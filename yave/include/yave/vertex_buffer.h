@@ -25,8 +25,10 @@
 #include "yave_api.h"
 
 #include <backend/enums.h>
+#include <mathfu/glsl_mappings.h>
 
 #include <cstdint>
+#include <functional>
 
 namespace yave
 {
@@ -54,6 +56,22 @@ public:
 
     void build(Engine* engine, uint32_t vertexCount, void* vertexData);
 
+    /**
+     * @brief Builds the vertex buffer, with the vertex data written by the fill function
+     * directly into the mapped upload memory. This avoids an intermediate copy when the
+     * vertices are being assembled from some other source (i.e. a model file).
+     * @param vertexSize The size of the vertex data in bytes.
+     * @param fillFunc Called with a pointer to mapped memory of at least vertexSize bytes.
+     */
+    void build(Engine* engine, uint32_t vertexSize, const std::function<void(void*)>& fillFunc);
+
+    /**
+     * @brief Sets the transform applied in the vertex shader to positions stored as
+     * normalised integers (i.e. **Unorm16x4**): p = offset + scale * position. Not
+     * required for float positions.
+     */
+    void setPositionDequantisation(const mathfu::vec3& offset, const mathfu::vec3& scale);
+
 protected:
     VertexBuffer() = default;
     ~VertexBuffer() = default;
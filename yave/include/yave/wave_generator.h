@@ -23,12 +23,46 @@
 
 #include "yave_api.h"
 
+#include <mathfu/glsl_mappings.h>
+
+#include <cstddef>
+#include <cstdint>
+
 namespace yave
 {
 
 class WaveGenerator : public YaveApi
 {
 public:
+    /**
+     * @brief The latency and accuracy of the displacement queries. The queries
+     * are answered from a low resolution cpu mirror of the spectrum, which only
+     * holds the longer waves, so the height is an approximation.
+     */
+    struct QueryStats
+    {
+        // the time the displacement was evaluated at, relative to the current
+        // frame in seconds - negative if the worker has fallen behind.
+        float latency = 0.0f;
+        // the estimated rms error of the height in world units
+        float heightError = 0.0f;
+        // the fraction of the height variance of the gpu surface captured
+        float varianceCaptured = 0.0f;
+        // the resolution of the cpu spectrum - zero if queries are disabled
+        uint32_t resolution = 0;
+    };
+
+    /**
+     * @brief Samples the displacement of the surface at positions on the
+     * plane, in the local space of the water. The horizontal displacement is
+     * written to x and z of the output, and the height to y. This can be called
+     * from any thread, with the cost of a batch spread over the task arena.
+     * @return false if queries are disabled - see OceanOptions::queryResolution.
+     */
+    bool sampleDisplacement(const mathfu::vec2* positions, size_t count, mathfu::vec3* out);
+
+    QueryStats getQueryStats();
+
 protected:
     WaveGenerator() = default;
     ~WaveGenerator() = default;
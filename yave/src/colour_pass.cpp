@@ -163,13 +163,41 @@ void ColourPass::drawCallback(
         dynamicOffsets.emplace_back(renderData->getSkinDynamicOffset());
     }
 
-    vk::Buffer vertexBuffer = vBuffer ? vBuffer->getGpuBuffer(driver)->get() : nullptr;
-    vk::Buffer indexBuffer = iBuffer ? iBuffer->getGpuBuffer(driver)->get() : nullptr;
+    vkapi::VertexBufferHandle vbHandle;
+    vkapi::IndexBufferHandle ibHandle;
+    if (vBuffer)
+    {
+        vbHandle = vBuffer->getHandle();
+    }
+    if (iBuffer)
+    {
+        ibHandle = iBuffer->getHandle();
+    }
+    if (iBuffer && prim->getLodCount() > 1)
+    {
+        // the index range of the level of detail selected for this frame
+        const auto& drawData = prim->getDrawData(renderData->getLod());
+        programBundle->setIndexRange(
+            static_cast<uint32_t>(drawData.indexCount),
+            static_cast<uint32_t>(drawData.indexPrimitiveOffset));
+    }
+
+    // only the clusters which passed culling are drawn
+    programBundle->setIndexRanges(nullptr, 0);
+    const auto* ranges = renderData->getVisibleClusterRanges(prim);
+    if (iBuffer && ranges)
+    {
+        if (ranges->empty())
+        {
+            return;
+        }
+        programBundle->setIndexRanges(ranges->data(), static_cast<uint32_t>(ranges->size()));
+    }
+
     vk::VertexInputAttributeDescription* attrDesc = vBuffer ? vBuffer->getInputAttr() : nullptr;
     vk::VertexInputBindingDescription* bindDesc = vBuffer ? vBuffer->getInputBind() : nullptr;
 
-    driver.draw(
-        cmdBuffer, *programBundle, vertexBuffer, indexBuffer, attrDesc, bindDesc, dynamicOffsets);
+    driver.draw(cmdBuffer, *programBundle, vbHandle, ibHandle, attrDesc, bindDesc, dynamicOffsets);
 }
 
 } // namespace yave
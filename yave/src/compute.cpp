@@ -31,7 +31,7 @@
 namespace yave
 {
 
-Compute::Compute(IEngine& engine, const util::CString& shaderStr)
+Compute::Compute(IEngine& engine, const util::CString& shaderStr) : driver_(engine.driver())
 {
     ubo_ = std::make_unique<UniformBuffer>(
         vkapi::PipelineCache::UboSetValue, UboBindPoint, "ComputeUbo", "compute_ubo");
@@ -47,7 +47,9 @@ void Compute::addStorageImage(
     const std::string& name,
     const vkapi::TextureHandle& texture,
     uint32_t binding,
-    ImageStorageSet::StorageType storageType)
+    ImageStorageSet::StorageType storageType,
+    ImageStorageSet::SamplerType samplerType,
+    uint32_t level)
 {
     ASSERT_FATAL(
         binding < vkapi::PipelineCache::MaxStorageImageBindCount,
@@ -59,11 +61,12 @@ void Compute::addStorageImage(
         name,
         vkapi::PipelineCache::StorageImageSetValue,
         binding,
-        ImageStorageSet::SamplerType::e2d, // TODO: make a paramater
+        samplerType,
         storageType,
-        ImageStorageSet::texFormatToFormatLayout(texture.getResource()->context().format));
+        ImageStorageSet::texFormatToFormatLayout(driver_.getTexture(texture)->context().format));
 
-    bundle_->setStorageImage(texture, binding);
+    bundle_->setStorageImage(
+        texture, binding, level, samplerType == ImageStorageSet::SamplerType::e2dArray);
 }
 
 void Compute::addImageSampler(
@@ -71,11 +74,11 @@ void Compute::addImageSampler(
     const std::string& name,
     const vkapi::TextureHandle& texture,
     uint8_t binding,
-    const TextureSampler& sampler)
+    const TextureSampler& sampler,
+    SamplerSet::SamplerType samplerType)
 {
     // all samplers use the same set
-    samplerSet_.pushSampler(
-        name, vkapi::PipelineCache::SamplerSetValue, binding, SamplerSet::SamplerType::e2d);
+    samplerSet_.pushSampler(name, vkapi::PipelineCache::SamplerSetValue, binding, samplerType);
 
     bundle_->setImageSampler(
         texture, binding, driver.getSamplerCache().createSampler(sampler.get()));
@@ -192,9 +195,10 @@ vkapi::ShaderProgramBundle* Compute::build(IEngine& engine)
         program->addAttributeBlock(ubo_->createShaderStr());
         ubo_->createGpuBuffer(driver);
         ubo_->mapGpuBuffer(driver, ubo_->getBlockData());
+
+        auto params = ubo_->getBufferParams(driver);
+        bundle_->addDescriptorBinding(params.size, params.binding, params.buffers, params.type);
     }
-    auto params = ubo_->getBufferParams(driver);
-    bundle_->addDescriptorBinding(params.size, params.binding, params.buffer, params.type);
 
     // storage buffers
     for (const auto& ssbo : ssbos_)
@@ -211,8 +215,8 @@ vkapi::ShaderProgramBundle* Compute::build(IEngine& engine)
                 ssbo->mapGpuBuffer(driver, data);
             }
 
-            params = ssbo->getBufferParams(driver);
-            bundle_->addDescriptorBinding(params.size, params.binding, params.buffer, params.type);
+            auto params = ssbo->getBufferParams(driver);
+            bundle_->addDescriptorBinding(params.size, params.binding, params.buffers, params.type);
         }
     }
 
@@ -53,18 +53,23 @@ public:
     explicit Compute(IEngine& engine, const util::CString& shaderCode);
     ~Compute();
 
+    // The level of the texture to bind. If an array sampler type is
+    // specified, all faces and layers of the level are bound.
     void addStorageImage(
         const std::string& name,
         const vkapi::TextureHandle& handle,
         uint32_t binding,
-        ImageStorageSet::StorageType storageType);
+        ImageStorageSet::StorageType storageType,
+        ImageStorageSet::SamplerType samplerType = ImageStorageSet::SamplerType::e2d,
+        uint32_t level = 0);
 
     void addImageSampler(
         vkapi::VkDriver& driver,
         const std::string& name,
         const vkapi::TextureHandle& texture,
         uint8_t binding,
-        const TextureSampler& sampler);
+        const TextureSampler& sampler,
+        SamplerSet::SamplerType samplerType = SamplerSet::SamplerType::e2d);
 
     void addUboParam(
         const std::string& elementName,
@@ -116,6 +121,7 @@ private:
 
     // ================ vulkan backend ===============
 
+    vkapi::VkDriver& driver_;
     vkapi::ShaderProgramBundle* bundle_;
 };
 
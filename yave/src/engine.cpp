@@ -8,6 +8,7 @@
 #include "private/render_primitive.h"
 #include "private/renderable.h"
 #include "private/scene.h"
+#include "private/texture_streamer.h"
 #include "private/vertex_buffer.h"
 #include "private/wave_generator.h"
 
@@ -79,13 +80,24 @@ IndirectLight* Engine::createIndirectLight()
 
 Camera* Engine::createCamera() { return static_cast<IEngine*>(this)->createCamera(); }
 
-WaveGenerator* Engine::createWaveGenerator(Scene* scene)
+WaveGenerator* Engine::createWaveGenerator(Scene* scene, const OceanOptions& options)
 {
-    return static_cast<IEngine*>(this)->createWaveGenerator(*(static_cast<IScene*>(scene)));
+    return static_cast<IEngine*>(this)->createWaveGenerator(
+        *(static_cast<IScene*>(scene)), options);
 }
 
 void Engine::flushCmds() { static_cast<IEngine*>(this)->flush(); }
 
+void Engine::setStreamingOptions(const StreamingOptions& options)
+{
+    static_cast<IEngine*>(this)->getTextureStreamer().setOptions(options);
+}
+
+StreamingOptions& Engine::getStreamingOptions()
+{
+    return static_cast<IEngine*>(this)->getTextureStreamer().getOptions();
+}
+
 void Engine::destroy(VertexBuffer* buffer)
 {
     static_cast<IEngine*>(this)->destroy(static_cast<IVertexBuffer*>(buffer));
@@ -46,13 +46,29 @@ void Frustum::projection(const mathfu::mat4& viewProj)
     planes_[Front] = viewProj.GetColumn(3) - viewProj.GetColumn(2);
     planes_[Back] = viewProj.GetColumn(3) + viewProj.GetColumn(2);
 
+    // normalised by the plane normal so the distance to the plane can be
+    // compared against a radius
     for (uint8_t i = 0; i < 6; ++i)
     {
-        float len = mathfu::LengthHelper(planes_[i]);
+        float len = planes_[i].xyz().Length();
         planes_[i] /= len;
     }
 }
 
+Frustum Frustum::toObjectSpace(const mathfu::mat4& world) const noexcept
+{
+    // the object space plane is the world plane multiplied by the world
+    // transform - dot(plane, world * p) == dot(transpose(world) * plane, p)
+    Frustum ret;
+    const mathfu::mat4 transposed = world.Transpose();
+    for (size_t i = 0; i < 6; ++i)
+    {
+        mathfu::vec4 plane = transposed * planes_[i];
+        ret.planes_[i] = plane / plane.xyz().Length();
+    }
+    return ret;
+}
+
 void Frustum::checkIntersection(
     const mathfu::vec3* __restrict centers,
     const mathfu::vec3* __restrict extents,
@@ -85,18 +101,33 @@ bool Frustum::checkIntersection(const AABBox& box)
     return static_cast<bool>(result);
 }
 
-bool Frustum::checkSphereIntersect(const mathfu::vec3& center, float radius)
+void Frustum::checkSphereIntersection(
+    const mathfu::vec3* __restrict centers,
+    const float* __restrict radii,
+    size_t count,
+    uint8_t* __restrict results) const noexcept
 {
-    for (size_t i = 0; i < 6; ++i)
+    for (size_t i = 0; i < count; ++i)
     {
-        const float dot = planes_[i].x * center.x + planes_[i].y * center.y * planes_[i].z +
-            center.z + planes_[i].w;
-        if (dot <= -radius)
+        bool visible = true;
+
+#pragma unroll
+        for (size_t j = 0; j < 6; ++j)
         {
-            return false;
+            const float dot = planes_[j].x * centers[i].x + planes_[j].y * centers[i].y +
+                planes_[j].z * centers[i].z + planes_[j].w - radii[i];
+
+            visible &= dot <= 0.0f;
         }
+        results[i] = static_cast<uint8_t>(visible);
     }
-    return true;
+}
+
+bool Frustum::checkSphereIntersect(const mathfu::vec3& center, float radius)
+{
+    uint8_t result = 0;
+    checkSphereIntersection(&center, &radius, 1, &result);
+    return static_cast<bool>(result);
 }
 
 } // namespace yave
@@ -38,8 +38,20 @@ public:
 
     void projection(const mathfu::mat4& viewProj);
 
+    /**
+     * @brief Transforms the planes into the object space of @p world, so object
+     * space bounds can be tested without transforming each of them.
+     */
+    [[nodiscard]] Frustum toObjectSpace(const mathfu::mat4& world) const noexcept;
+
     bool checkSphereIntersect(const mathfu::vec3& pos, float radius);
 
+    void checkSphereIntersection(
+        const mathfu::vec3* __restrict centers,
+        const float* __restrict radii,
+        size_t count,
+        uint8_t* __restrict results) const noexcept;
+
     void checkIntersection(
         const mathfu::vec3* __restrict centers,
         const mathfu::vec3* __restrict extents,
@@ -48,6 +60,10 @@ public:
 
     bool checkIntersection(const AABBox& box);
 
+    // the planes, normalised - a point is inside when the signed distance to
+    // all planes is no greater than zero
+    [[nodiscard]] const std::array<mathfu::vec4, 6>& getPlanes() const noexcept { return planes_; }
+
 private:
     std::array<mathfu::vec4, 6> planes_;
 };
@@ -12,4 +12,14 @@ void IndexBuffer::build(
         static_cast<IEngine*>(engine)->driver(), indicesCount, indicesData, type);
 }
 
+void IndexBuffer::build(
+    Engine* engine,
+    uint32_t indicesCount,
+    backend::IndexBufferType type,
+    const std::function<void(void*)>& fillFunc)
+{
+    static_cast<IIndexBuffer*>(this)->build(
+        static_cast<IEngine*>(engine)->driver(), indicesCount, type, fillFunc);
+}
+
 } // namespace yave
\ No newline at end of file
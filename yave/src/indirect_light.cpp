@@ -1,4 +1,6 @@
+#include "private/engine.h"
 #include "private/indirect_light.h"
+#include "private/sh_projector.h"
 
 namespace yave
 {
@@ -15,4 +17,18 @@ void IndirectLight::setSpecularMap(Texture* specularMap, Texture* brdfLut)
         static_cast<IMappedTexture*>(specularMap), static_cast<IMappedTexture*>(brdfLut));
 }
 
+void IndirectLight::setIrradianceSh(Engine* engine, Texture* envMap, ShProjection projection)
+{
+    ShProjector& projector = static_cast<IEngine*>(engine)->getShProjector();
+    vkapi::TextureHandle handle = static_cast<IMappedTexture*>(envMap)->getBackendHandle();
+    static_cast<IIndirectLight*>(this)->setIrradianceSh(
+        projection == ShProjection::Cpu ? projector.projectCpu(handle)
+                                        : projector.projectGpu(handle));
+}
+
+void IndirectLight::setIrradianceSh(const util::sh::Coefficients& coeffs) noexcept
+{
+    static_cast<IIndirectLight*>(this)->setIrradianceSh(coeffs);
+}
+
 } // namespace yave
\ No newline at end of file
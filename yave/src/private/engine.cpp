@@ -28,10 +28,14 @@
 #include "managers/light_manager.h"
 #include "managers/renderable_manager.h"
 #include "mapped_texture.h"
+#include "mip_generator.h"
 #include "post_process.h"
 #include "renderable.h"
 #include "scene.h"
+#include "sh_projector.h"
 #include "skybox.h"
+#include "specular_filter.h"
+#include "texture_streamer.h"
 #include "vulkan-api/swapchain.h"
 #include "wave_generator.h"
 #include "yave/renderable.h"
@@ -66,6 +70,10 @@ IEngine* IEngine::create(vkapi::VkDriver* driver)
     // (requires the device to be init)
     engine->lightManager_ = std::make_unique<ILightManager>(*engine);
     engine->postProcess_ = std::make_unique<PostProcess>(*engine);
+    engine->textureStreamer_ = std::make_unique<TextureStreamer>(*engine);
+    engine->mipGenerator_ = std::make_unique<MipGenerator>(*engine);
+    engine->shProjector_ = std::make_unique<ShProjector>(*engine);
+    engine->specularFilter_ = std::make_unique<SpecularFilter>(*engine);
 
     engine->init();
 
@@ -81,7 +89,12 @@ void IEngine::destroy(IEngine* engine)
     }
 }
 
-void IEngine::shutdown() { driver_->shutdown(); }
+void IEngine::shutdown()
+{
+    // the streamed levels still loading must complete before the driver is destroyed
+    textureStreamer_->shutDown();
+    driver_->shutdown();
+}
 
 void IEngine::init() noexcept
 {
@@ -181,9 +194,9 @@ IIndirectLight* IEngine::createIndirectLight() noexcept { return createResource(
 
 ICamera* IEngine::createCamera() noexcept { return createResource(cameras_); }
 
-IWaveGenerator* IEngine::createWaveGenerator(IScene& scene) noexcept
+IWaveGenerator* IEngine::createWaveGenerator(IScene& scene, const OceanOptions& options) noexcept
 {
-    return createResource(waterGens_, *this, scene);
+    return createResource(waterGens_, *this, scene, options);
 }
 
 void IEngine::flush()
@@ -212,6 +225,7 @@ void IEngine::destroy(IRenderable* renderable) noexcept
 
 void IEngine::destroy(IMappedTexture* texture) noexcept
 {
+    textureStreamer_->remove(*texture);
     destroyResource(texture, mappedTextures_);
 }
 
@@ -57,6 +57,10 @@ class ISkybox;
 class IIndirectLight;
 class ICamera;
 class IWaveGenerator;
+class TextureStreamer;
+class MipGenerator;
+class ShProjector;
+class SpecularFilter;
 
 using SwapchainHandle = vkapi::SwapchainHandle;
 
@@ -84,7 +88,7 @@ public:
     ISkybox* createSkybox(IScene& scene) noexcept;
     IIndirectLight* createIndirectLight() noexcept;
     ICamera* createCamera() noexcept;
-    IWaveGenerator* createWaveGenerator(IScene& scene) noexcept;
+    IWaveGenerator* createWaveGenerator(IScene& scene, const OceanOptions& options) noexcept;
 
     void destroy(IRenderer* renderer);
     void destroy(IScene* scene);
@@ -133,6 +137,10 @@ public:
     ILightManager* getLightManager() noexcept { return lightManager_.get(); }
     IObjectManager* getObjManager() noexcept { return objManager_.get(); }
     PostProcess* getPostProcess() noexcept { return postProcess_.get(); }
+    TextureStreamer& getTextureStreamer() noexcept { return *textureStreamer_; }
+    MipGenerator& getMipGenerator() noexcept { return *mipGenerator_; }
+    ShProjector& getShProjector() noexcept { return *shProjector_; }
+    SpecularFilter& getSpecularFilter() noexcept { return *specularFilter_; }
 
     [[maybe_unused]] auto getQuadBuffers() noexcept
     {
@@ -149,6 +157,10 @@ private:
     std::unique_ptr<ILightManager> lightManager_;
     std::unique_ptr<IObjectManager> objManager_;
     std::unique_ptr<PostProcess> postProcess_;
+    std::unique_ptr<TextureStreamer> textureStreamer_;
+    std::unique_ptr<MipGenerator> mipGenerator_;
+    std::unique_ptr<ShProjector> shProjector_;
+    std::unique_ptr<SpecularFilter> specularFilter_;
 
     std::unordered_set<IVertexBuffer*> vBuffers_;
     std::unordered_set<IIndexBuffer*> iBuffers_;
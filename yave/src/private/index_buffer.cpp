@@ -22,6 +22,7 @@
 
 #include "index_buffer.h"
 
+#include "backend/convert_to_vk.h"
 #include "engine.h"
 
 namespace yave
@@ -43,18 +44,32 @@ void IIndexBuffer::build(
 
     if (ihandle_)
     {
+        ASSERT_FATAL(type == bufferType_, "The index type can not be changed once built.");
         driver.mapIndexBuffer(ihandle_, indicesCount * byteSize, indicesData);
+        indicesCount_ = indicesCount;
         return;
     }
     indicesCount_ = indicesCount;
     bufferType_ = type;
 
-    ihandle_ = driver.addIndexBuffer(indicesCount * byteSize, indicesData);
+    ihandle_ = driver.addIndexBuffer(
+        indicesCount * byteSize, indicesData, backend::indexBufferTypeToVk(type));
 }
 
-vkapi::IndexBuffer* IIndexBuffer::getGpuBuffer(vkapi::VkDriver& driver) noexcept
+void IIndexBuffer::build(
+    vkapi::VkDriver& driver,
+    uint32_t indicesCount,
+    backend::IndexBufferType type,
+    const vkapi::GeometryFillFunc& fillFunc)
 {
-    return driver.getIndexBuffer(ihandle_);
+    ASSERT_FATAL(!ihandle_, "The index buffer has already been built.");
+    uint32_t byteSize =
+        type == backend::IndexBufferType::Uint16 ? sizeof(uint16_t) : sizeof(uint32_t);
+    indicesCount_ = indicesCount;
+    bufferType_ = type;
+
+    ihandle_ = driver.addIndexBuffer(
+        indicesCount * byteSize, backend::indexBufferTypeToVk(type), fillFunc);
 }
 
 } // namespace yave
@@ -45,7 +45,13 @@ public:
         void* indicesData,
         backend::IndexBufferType type);
 
-    vkapi::IndexBuffer* getGpuBuffer(vkapi::VkDriver& driver) noexcept;
+    void build(
+        vkapi::VkDriver& driver,
+        uint32_t indicesCount,
+        backend::IndexBufferType type,
+        const vkapi::GeometryFillFunc& fillFunc);
+
+    [[nodiscard]] const vkapi::IndexBufferHandle& getHandle() const noexcept { return ihandle_; }
 
     [[nodiscard]] uint64_t getIndicesSize() const noexcept { return indicesCount_; }
 
@@ -29,7 +29,11 @@
 namespace yave
 {
 IIndirectLight::IIndirectLight()
-    : irradianceMap_(nullptr), specularMap_(nullptr), brdfLut_(nullptr), mipLevels_(0)
+    : irradianceMap_(nullptr),
+      specularMap_(nullptr),
+      brdfLut_(nullptr),
+      hasIrradianceSh_(false),
+      mipLevels_(0)
 {
 }
 IIndirectLight::~IIndirectLight() = default;
@@ -41,6 +45,12 @@ void IIndirectLight::setIrradianceMap(IMappedTexture* cubeMap)
     irradianceMap_ = cubeMap;
 }
 
+void IIndirectLight::setIrradianceSh(const util::sh::Coefficients& coeffs) noexcept
+{
+    irradianceSh_ = coeffs;
+    hasIrradianceSh_ = true;
+}
+
 void IIndirectLight::setSpecularMap(IMappedTexture* specCubeMap, IMappedTexture* brdfLut)
 {
     ASSERT_FATAL(specCubeMap, "Specular cube map is nullptr");
@@ -24,6 +24,8 @@
 #include "mapped_texture.h"
 #include "yave/indirect_light.h"
 
+#include <utility/spherical_harmonics.h>
+
 namespace yave
 {
 class IIndirectLight : public IndirectLight
@@ -35,12 +37,23 @@ public:
     void setIrradianceMap(IMappedTexture* cubeMap);
     void setSpecularMap(IMappedTexture* specCubeMap, IMappedTexture* brdfLut);
 
+    // When set, the diffuse lighting is evaluated from the coefficients and
+    // the irradiance map is no longer required.
+    void setIrradianceSh(const util::sh::Coefficients& coeffs) noexcept;
+
     vkapi::TextureHandle getIrradianceMapHandle() noexcept;
     vkapi::TextureHandle getSpecularMapHandle() noexcept;
     vkapi::TextureHandle getBrdfLutHandle() noexcept;
 
     [[nodiscard]] uint32_t getMipLevels() const noexcept { return mipLevels_; }
 
+    [[nodiscard]] bool hasIrradianceMap() const noexcept { return irradianceMap_ != nullptr; }
+    [[nodiscard]] bool hasIrradianceSh() const noexcept { return hasIrradianceSh_; }
+    [[nodiscard]] const util::sh::Coefficients& getIrradianceSh() const noexcept
+    {
+        return irradianceSh_;
+    }
+
     [[maybe_unused]] void shutDown(vkapi::VkDriver& driver) { YAVE_UNUSED(driver); }
 
 private:
@@ -48,6 +61,9 @@ private:
     IMappedTexture* specularMap_;
     IMappedTexture* brdfLut_;
 
+    util::sh::Coefficients irradianceSh_;
+    bool hasIrradianceSh_;
+
     uint32_t mipLevels_;
 };
 } // namespace yave
\ No newline at end of file
@@ -51,7 +51,8 @@ ILightManager::ILightManager(IEngine& engine)
         vkapi::PipelineCache::SsboSetValue,
         0,
         "LightSsbo",
-        "light_ssbo");
+        "light_ssbo",
+        true);
 
     ssbo_->addElement("params", backend::BufferElementType::Struct, nullptr, 0, 1, "LightParams");
     ssbo_->createGpuBuffer(engine_.driver(), MaxLightCount * sizeof(ILightManager::LightSsbo));
@@ -155,7 +156,7 @@ void ILightManager::prepare(IScene* scene)
     programBundle_->addDescriptorBinding(
         static_cast<uint32_t>(camUbo.size),
         camUbo.binding,
-        camUbo.buffer,
+        camUbo.buffers,
         vk::DescriptorType::eUniformBuffer);
 
     // Storage buffer
@@ -163,7 +164,7 @@ void ILightManager::prepare(IScene* scene)
     programBundle_->addDescriptorBinding(
         MaxLightCount * sizeof(ILightManager::LightSsbo),
         ssboParams.binding,
-        ssboParams.buffer,
+        ssboParams.buffers,
         vk::DescriptorType::eStorageBuffer);
 }
 
@@ -530,8 +531,12 @@ rg::RenderGraphHandle ILightManager::render(
             IIndirectLight* il = scene.getIndirectLight();
             if (il)
             {
+                // the irradiance map isn't required when using spherical harmonics
                 programBundle_->setImageSampler(
-                    il->getIrradianceMapHandle(), SamplerIrradianceBinding, iblSampler);
+                    il->hasIrradianceMap() ? il->getIrradianceMapHandle()
+                                           : engine_.getDummyCubeMap()->getBackendHandle(),
+                    SamplerIrradianceBinding,
+                    iblSampler);
                 programBundle_->setImageSampler(
                     il->getSpecularMapHandle(), SamplerSpecularBinding, iblSampler);
                 programBundle_->setImageSampler(
@@ -57,7 +57,25 @@ void IRenderableManager::build(
     }
 
     engine_.getTransformManager()->addModelTransform(transform, obj);
+    addRenderable(renderable, obj);
+}
+
+IRenderable* IRenderableManager::buildInstance(
+    const Object& prototype, Object& obj, const ModelTransform& transform)
+{
+    IRenderable* renderable = engine_.createRenderable();
+    renderable->setInstanceOf(*getMesh(prototype));
 
+    // the materials were built along with the prototype so there is nothing to
+    // build here
+    engine_.getTransformManager()->addInstance(
+        prototype, ITransformManager::createLocalTransform(transform), obj);
+    addRenderable(renderable, obj);
+    return renderable;
+}
+
+void IRenderableManager::addRenderable(IRenderable* renderable, Object& obj)
+{
     // first add the Object which will give us a free slot
     ObjectHandle objHandle = addObject(obj);
 
@@ -67,12 +67,26 @@ public:
         const std::string& matShader,
         const std::string& mainShaderPath = "material");
 
+    /**
+     * @brief Creates a renderable for @p obj which is an instance of the
+     * renderable of the prototype Object. The primitives, buffers, materials
+     * and node hierachy of the prototype are shared rather than copied or
+     * rebuilt - the instance only holds its transform, material overrides and
+     * per-frame state.
+     * Note: The prototype must have been built with **build**.
+     */
+    IRenderable*
+    buildInstance(const Object& prototype, Object& obj, const ModelTransform& transform);
+
     IMaterial* createMaterial() noexcept;
 
     void destroy(const Object& obj);
 
     void destroy(IMaterial* mat);
 
+private:
+    void addRenderable(IRenderable* renderable, Object& obj);
+
 private:
     IEngine& engine_;
 
@@ -34,59 +34,105 @@
 namespace yave
 {
 
-ITransformManager::ITransformManager(IEngine& engine) {}
-
-ITransformManager::~ITransformManager() = default;
+namespace
+{
 
-bool ITransformManager::addNodeHierachy(NodeInstance& node, Object& obj, SkinInstance* skin)
+NodeInfo* findNode(NodeInfo* node, const util::CString& id)
 {
-    if (!node.getRootNode())
+    if (node->id == id)
     {
-        LOGGER_ERROR("Trying to add a root node that is null.\n");
-        return false;
+        return node;
     }
-
-    TransformInfo info;
-    info.root = new NodeInfo(*node.getRootNode());
-
-    // add skins to the manager - these don't require a slot to be requested as
-    // there may be numerous skins per mesh. Instead, the starting index of this
-    // group will be used to offset the skin indices to point at the correct
-    // skin
-    if (skin)
+    for (NodeInfo* child : node->children)
     {
-        info.skinOffset = static_cast<uint32_t>(skins_.size());
-        skins_.emplace_back(*skin);
+        if (NodeInfo* found = findNode(child, id))
+        {
+            return found;
+        }
     }
+    return nullptr;
+}
 
-    // update the model transform, and if skinned, joint matrices
-    updateModelTransform(info.root, info);
+} // namespace
 
-    // request a slot for this Object
-    ObjectHandle handle = addObject(obj);
+TransformPrototype::TransformPrototype() = default;
+TransformPrototype::~TransformPrototype() = default;
 
-    if (handle.get() >= nodes_.size())
+const std::vector<mathfu::mat4>& TransformInfo::getJointMatrices() const noexcept
+{
+    static const std::vector<mathfu::mat4> noJoints;
+    return prototype ? prototype->jointMatrices : noJoints;
+}
+
+ITransformManager::ITransformManager(IEngine& engine) {}
+
+ITransformManager::~ITransformManager() = default;
+
+std::shared_ptr<TransformPrototype>
+ITransformManager::createPrototype(NodeInstance& node, SkinInstance* skin)
+{
+    auto prototype = std::make_shared<TransformPrototype>();
+    prototype->root = std::make_unique<NodeInfo>(*node.getRootNode());
+
+    if (skin)
     {
-        nodes_.emplace_back(std::move(info));
+        // the joints point into the source hierachy - relink them to the copy
+        prototype->skin = std::make_unique<SkinInstance>(*skin);
+        for (NodeInfo*& joint : prototype->skin->jointNodes)
+        {
+            joint = findNode(prototype->root.get(), joint->id);
+            ASSERT_FATAL(joint, "Skin joint not found in the node hierachy.");
+        }
+        if (skin->skeletonRoot)
+        {
+            prototype->skin->skeletonRoot =
+                findNode(prototype->root.get(), skin->skeletonRoot->id);
+        }
     }
-    else
+
+    // the bind pose is the same for all instances so only needs calculating once
+    updatePrototype(prototype->root.get(), *prototype);
+    return prototype;
+}
+
+bool ITransformManager::addNodeHierachy(NodeInstance& node, Object& obj, SkinInstance* skin)
+{
+    if (!node.getRootNode())
     {
-        nodes_[handle.get()] = std::move(info);
+        LOGGER_ERROR("Trying to add a root node that is null.\n");
+        return false;
     }
 
+    TransformInfo info;
+    info.prototype = createPrototype(node, skin);
+    info.modelTransform = info.prototype->meshTransform;
+    addInfo(std::move(info), obj);
     return true;
 }
 
 void ITransformManager::addTransform(const mathfu::mat4& local, Object& obj)
 {
     TransformInfo info;
-    info.root = new NodeInfo();
-    info.root->nodeTransform = local;
-    info.root->hasMesh = true;
+    info.localTransform = local;
+    info.modelTransform = local;
+    addInfo(std::move(info), obj);
+}
 
-    // update the model transform, and if skinned, joint matrices
-    updateModelTransform(info.root, info);
+void ITransformManager::addInstance(
+    const Object& prototype, const mathfu::mat4& local, Object& obj)
+{
+    const TransformInfo* protoInfo = getTransform(prototype);
+
+    // only the reference to the prototype is copied
+    TransformInfo info;
+    info.prototype = protoInfo->prototype;
+    info.localTransform = local;
+    info.modelTransform = info.prototype ? local * info.prototype->meshTransform : local;
+    addInfo(std::move(info), obj);
+}
 
+void ITransformManager::addInfo(TransformInfo&& info, Object& obj)
+{
     // request a slot for this Object
     ObjectHandle handle = addObject(obj);
 
@@ -112,31 +158,32 @@ mathfu::mat4 ITransformManager::updateMatrix(NodeInfo* node)
     return mat;
 }
 
-void ITransformManager::updateModelTransform(NodeInfo* parent, TransformInfo& transInfo)
+mathfu::mat4 ITransformManager::createLocalTransform(const ModelTransform& transform)
+{
+    mathfu::mat4 r = transform.rot.ToMatrix4();
+    mathfu::mat4 s = mathfu::mat4::FromScaleVector(transform.scale);
+    mathfu::mat4 t = mathfu::mat4::FromTranslationVector(transform.translation);
+    return t * r * s;
+}
+
+void ITransformManager::updatePrototype(NodeInfo* parent, TransformPrototype& prototype)
 {
     // we need to find the mesh node first - we will then update matrices
     // working back towards the root node
     if (parent->hasMesh)
     {
-        mathfu::mat4 mat;
-
         // update the matrices - child node transform * parent transform
-        mat = updateMatrix(parent);
-
-        // add updated local transfrom to the ubo buffer
-        transInfo.modelTransform = mat;
+        mathfu::mat4 mat = updateMatrix(parent);
+        prototype.meshTransform = mat;
 
-        if (transInfo.skinOffset != TransformInfo::Uninitialised)
+        if (prototype.skin)
         {
-            // the transform data index for this Object is stored on the
-            // component
-            auto skinIndex = static_cast<uint32_t>(parent->skinIndex);
-            ASSERT_LOG(skinIndex >= 0);
-            SkinInstance& skin = skins_[skinIndex];
+            const SkinInstance& skin = *prototype.skin;
 
             // get the number of joints in the skeleton
             uint32_t jointCount =
                 std::min(static_cast<uint32_t>(skin.jointNodes.size()), MaxBoneCount);
+            prototype.jointMatrices.resize(jointCount);
 
             // transform to local space
             mathfu::mat4 inverseMat = mat.Inverse();
@@ -150,8 +197,7 @@ void ITransformManager::updateModelTransform(NodeInfo* parent, TransformInfo& tr
                 mathfu::mat4 jointMatrix = updateMatrix(jointNode) * skin.invBindMatrices[i];
 
                 // transform joint to local (joint) space
-                mathfu::mat4 localMatrix = inverseMat * jointMatrix;
-                transInfo.jointMatrices[i] = localMatrix;
+                prototype.jointMatrices[i] = inverseMat * jointMatrix;
             }
         }
 
@@ -162,15 +208,16 @@ void ITransformManager::updateModelTransform(NodeInfo* parent, TransformInfo& tr
     // now work up the child nodes - until we find a mesh
     for (NodeInfo* child : parent->children)
     {
-        updateModelTransform(child, transInfo);
+        updatePrototype(child, prototype);
     }
 }
 
-void ITransformManager::updateModel(const Object& obj)
+void ITransformManager::updateModel(const Object& obj, const mathfu::mat4& local)
 {
     ObjectHandle handle = getObjIndex(obj);
     TransformInfo& info = nodes_[handle.get()];
-    updateModelTransform(info.root->parent, info);
+    info.localTransform = local;
+    info.modelTransform = info.prototype ? local * info.prototype->meshTransform : local;
 }
 
 TransformInfo* ITransformManager::getTransform(const Object& obj)
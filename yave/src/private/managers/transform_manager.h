@@ -43,21 +43,45 @@ struct NodeInfo;
 class NodeInstance;
 class IEngine;
 
+/**
+ * @brief The immutable part of a node hierachy - the hierachy topology, skin
+ * and bind pose. This is created once per model node and shared by all of its
+ * instances.
+ */
+struct TransformPrototype
+{
+    TransformPrototype();
+    ~TransformPrototype();
+
+    std::unique_ptr<NodeInfo> root;
+
+    // the joints of the skin point at nodes of this hierachy. Null if the
+    // model isn't skinned.
+    std::unique_ptr<SkinInstance> skin;
+
+    // the transform of the mesh node relative to the root of the hierachy
+    mathfu::mat4 meshTransform = mathfu::mat4::Identity();
+
+    // the joint matrices of the bind pose
+    std::vector<mathfu::mat4> jointMatrices;
+};
+
 struct TransformInfo
 {
     static constexpr uint32_t Uninitialised = std::numeric_limits<uint32_t>::max();
 
-    NodeInfo* root = nullptr;
+    // shared between all instances of a model. Null for objects added with a
+    // transform only.
+    std::shared_ptr<const TransformPrototype> prototype;
 
-    // the transform of this model - calculated by calling updateTransform()
-    mathfu::mat4 modelTransform;
+    // the transform of this instance
+    mathfu::mat4 localTransform = mathfu::mat4::Identity();
 
-    // the offset all skin indices will be adjusted by within this
-    // node hierachy. We use this also to signify if this model has a skin
-    uint32_t skinOffset = Uninitialised;
+    // the transform of this model - the local transform * the prototype mesh
+    // transform.
+    mathfu::mat4 modelTransform = mathfu::mat4::Identity();
 
-    // skinning data - set by calling updateTransform()
-    std::vector<mathfu::mat4> jointMatrices;
+    [[nodiscard]] const std::vector<mathfu::mat4>& getJointMatrices() const noexcept;
 };
 
 class ITransformManager : public ComponentManager, public TransformManager
@@ -69,27 +93,49 @@ public:
     virtual ~ITransformManager();
 
 
+    /**
+     * @brief Adds the node hierachy of a model. Further instances of the model
+     * should be added with @p addInstance, which shares the hierachy rather
+     * than copying it.
+     */
     [[maybe_unused]] bool addNodeHierachy(NodeInstance& node, Object& obj, SkinInstance* skin);
 
     void addTransform(const mathfu::mat4& local, Object& obj);
 
+    /**
+     * @brief Adds an instance of the model of the prototype object. The node
+     * hierachy and skin of the prototype are shared - only the transform is
+     * held by the instance.
+     */
+    void addInstance(const Object& prototype, const mathfu::mat4& local, Object& obj);
+
+    /**
+     * @brief Creates the shared part of a node hierachy. The hierachy and skin
+     * are copied once, with the skin joints relinked to the copied nodes.
+     */
+    static std::shared_ptr<TransformPrototype>
+    createPrototype(NodeInstance& node, SkinInstance* skin);
+
     static mathfu::mat4 updateMatrix(NodeInfo* node);
 
-    void updateModelTransform(NodeInfo* parent, TransformInfo& transInfo);
+    // the local matrix of a model transform - T * R * S
+    static mathfu::mat4 createLocalTransform(const ModelTransform& transform);
 
-    [[maybe_unused]] void updateModel(const Object& obj);
+    [[maybe_unused]] void updateModel(const Object& obj, const mathfu::mat4& local);
 
     // =================== getters ==========================
 
     TransformInfo* getTransform(const Object& obj);
 
 private:
-    // transform data preserved in the node hierarchical format
-    // referenced by associated Object
-    std::vector<TransformInfo> nodes_;
+    static void updatePrototype(NodeInfo* parent, TransformPrototype& prototype);
+
+    void addInfo(TransformInfo&& info, Object& obj);
 
-    // skinned data - inverse bind matrices and bone info
-    std::vector<SkinInstance> skins_;
+private:
+    // the transform of each Object - node hierachies are held by the shared
+    // prototypes
+    std::vector<TransformInfo> nodes_;
 };
 
 } // namespace yave
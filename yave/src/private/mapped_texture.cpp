@@ -22,12 +22,23 @@
 
 #include "mapped_texture.h"
 
+#include "backend/convert_to_vk.h"
 #include "backend/convert_to_yave.h"
 #include "backend/enums.h"
 #include "engine.h"
+#include "mip_generator.h"
+#include "specular_filter.h"
+#include "texture_streamer.h"
 #include "utility/assertion.h"
+#include "vulkan-api/texture.h"
+#include "vulkan-api/utility.h"
 #include "yave/texture.h"
 
+#include <spdlog/spdlog.h>
+#include <tbb/tbb.h>
+
+#include <algorithm>
+
 namespace yave
 {
 
@@ -68,6 +79,17 @@ uint32_t IMappedTexture::getFormatByteSize(backend::TextureFormat format)
         case backend::TextureFormat::RGBA32F:
             output = 8;
             break;
+        // block compressed sizes are calculated per block
+        case backend::TextureFormat::BC1:
+        case backend::TextureFormat::BC3:
+        case backend::TextureFormat::BC4:
+        case backend::TextureFormat::BC5:
+        case backend::TextureFormat::BC7:
+        case backend::TextureFormat::ETC2_RGB8:
+        case backend::TextureFormat::ETC2_RGBA8:
+        case backend::TextureFormat::EAC_R11:
+        case backend::TextureFormat::EAC_RG11:
+        case backend::TextureFormat::ASTC_4x4:
         case backend::TextureFormat::Undefined:
             break;
     }
@@ -83,10 +105,18 @@ uint32_t IMappedTexture::totalTextureSize(
     backend::TextureFormat format) noexcept
 {
     size_t byteSize = getFormatByteSize(format);
+    const uint32_t blockSize = vkapi::getBlockByteSize(backend::textureFormatToVk(format));
 
     size_t totalSize = 0;
     for (uint32_t i = 0; i < mipLevels; ++i)
     {
+        if (blockSize)
+        {
+            const uint32_t blockWidth = (std::max(width >> i, 1u) + 3) / 4;
+            const uint32_t blockHeight = (std::max(height >> i, 1u) + 3) / 4;
+            totalSize += blockWidth * blockHeight * blockSize * faceCount * layerCount;
+            continue;
+        }
         totalSize += ((width >> i) * (height >> i) * 4 * byteSize) * faceCount * layerCount;
     }
     return totalSize;
@@ -103,18 +133,91 @@ void IMappedTexture::setTexture(
     uint32_t usageFlags,
     size_t* offsets)
 {
-    auto& driver = engine_.driver();
-
     buffer_ = buffer;
+    createBackendTexture(width, height, levels, faces, format, usageFlags);
+    engine_.driver().mapTexture(tHandle_, buffer, bufferSize, offsets);
+}
+
+void IMappedTexture::setTextures(IEngine& engine, const std::vector<Texture::Upload>& uploads)
+{
+    auto& driver = engine.driver();
+
+    std::vector<vkapi::TextureUpload> backendUploads(uploads.size());
+    for (size_t idx = 0; idx < uploads.size(); ++idx)
+    {
+        const Texture::Upload& upload = uploads[idx];
+        ASSERT_FATAL(upload.texture && upload.fillFunc, "Texture upload is missing its data.");
+
+        auto* tex = static_cast<IMappedTexture*>(upload.texture);
+        const Texture::Params& params = upload.params;
+        tex->buffer_ = nullptr;
+        tex->createBackendTexture(
+            params.width,
+            params.height,
+            params.levels,
+            params.faces,
+            params.format,
+            params.usageFlags);
+
+        backendUploads[idx].handle = tex->tHandle_;
+        backendUploads[idx].dataSize = static_cast<uint32_t>(params.bufferSize);
+    }
+
+    // the image data is written straight into the stage by the workers
+    vkapi::StagingPool::StageInfo* stage = driver.beginTextureUploads(backendUploads);
+    auto* stageData = static_cast<uint8_t*>(stage->allocInfo.pMappedData);
+    tbb::parallel_for(size_t(0), uploads.size(), [&](size_t idx) {
+        uploads[idx].fillFunc(stageData + backendUploads[idx].stageOffset);
+    });
+
+    driver.endTextureUploads(stage, backendUploads);
+}
+
+void IMappedTexture::setStreamedTexture(const Texture::StreamParams& params)
+{
+    const Texture::Params& texParams = params.params;
+    ASSERT_FATAL(params.fillFunc, "A streamed texture requires a fill function.");
+    ASSERT_FATAL(
+        params.levelSizes.size() == texParams.levels,
+        "The level sizes (%zu) don't match the mip level count (%d).",
+        params.levelSizes.size(),
+        texParams.levels);
+
+    // the dimensions are those of the complete mip chain, not of the levels
+    // which are resident.
+    buffer_ = nullptr;
+    width_ = texParams.width;
+    height_ = texParams.height;
+    mipLevels_ = texParams.levels;
+    faceCount_ = texParams.faces;
+    format_ = backend::textureFormatToVk(texParams.format);
+
+    tHandle_ = engine_.getTextureStreamer().add(*this, params);
+}
+
+bool IMappedTexture::isFormatSupported(IEngine& engine, backend::TextureFormat format)
+{
+    return engine.driver().isTextureFormatSupported(backend::textureFormatToVk(format));
+}
+
+void IMappedTexture::createBackendTexture(
+    uint32_t width,
+    uint32_t height,
+    uint32_t levels,
+    uint32_t faces,
+    backend::TextureFormat format,
+    uint32_t usageFlags)
+{
     width_ = width;
     height_ = height;
-    mipLevels_ = levels == 0xFFFF ? static_cast<uint32_t>(floor(log2(width))) + 1 : levels;
+    mipLevels_ = levels == 0xFFFF
+        ? static_cast<uint32_t>(floor(log2(std::max(width, height)))) + 1
+        : levels;
     faceCount_ = faces;
     format_ = backend::textureFormatToVk(format);
 
-    tHandle_ = driver.createTexture2d(
+    tHandle_ = engine_.driver().createTexture2d(
         format_, width, height, mipLevels_, faces, 1, backend::imageUsageToVk(usageFlags));
-    driver.mapTexture(tHandle_, buffer, bufferSize, offsets);
 }
 
 void IMappedTexture::setTexture(
@@ -131,13 +234,44 @@ void IMappedTexture::setTexture(
     setTexture(buffer, bufferSize, width, height, levels, faces, format, usageFlags, offsets);
 }
 
-void IMappedTexture::generateMipMaps()
+void IMappedTexture::generateMipMaps(MipFilter filter, bool srgb)
 {
     ASSERT_FATAL(tHandle_, "Texture must have been set before generating lod.");
 
     auto& driver = engine_.driver();
     auto& cmds = driver.getCommands();
-    vkapi::VkDriver::generateMipMaps(tHandle_, cmds.getCmdBuffer().cmdBuffer);
+    MipGenerator& generator = engine_.getMipGenerator();
+    if (generator.isSupported(tHandle_))
+    {
+        generator.generate(cmds.getCmdBuffer().cmdBuffer, tHandle_, filter, srgb);
+        return;
+    }
+    if (filter != MipFilter::Box || srgb)
+    {
+        SPDLOG_WARN("Compute mip generation is unsupported for this texture; the filter is "
+                    "ignored and the levels will be blitted.");
+    }
+    driver.generateMipMaps(tHandle_, cmds.getCmdBuffer().cmdBuffer);
+}
+
+void IMappedTexture::prefilterSpecular(IMappedTexture* envMap, uint32_t sampleCount)
+{
+    ASSERT_FATAL(tHandle_, "Texture must have been set before pre-filtering.");
+    ASSERT_FATAL(envMap, "The environment map is nullptr.");
+
+    auto& cmds = engine_.driver().getCommands();
+    engine_.getSpecularFilter().filter(
+        cmds.getCmdBuffer().cmdBuffer, envMap->getBackendHandle(), tHandle_, sampleCount);
+}
+
+std::vector<uint8_t> IMappedTexture::download()
+{
+    ASSERT_FATAL(tHandle_, "Texture must have been set before downloading.");
+
+    auto& driver = engine_.driver();
+    std::vector<uint8_t> data(driver.getTexture(tHandle_)->getDataSize());
+    driver.downloadTexture(tHandle_, data.data(), data.size());
+    return data;
 }
 
 Texture::Params IMappedTexture::getTextureParams() noexcept
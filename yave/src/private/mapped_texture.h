@@ -66,6 +66,14 @@ public:
         uint32_t usageFlags,
         size_t* offsets = nullptr);
 
+    // Only the mip tail is uploaded here - the remaining levels are managed by
+    // the texture streamer.
+    void setStreamedTexture(const Texture::StreamParams& params);
+
+    // Creates and uploads the textures as a single batch - the fill functions
+    // are run in parallel.
+    static void setTextures(IEngine& engine, const std::vector<Texture::Upload>& uploads);
+
     static uint32_t totalTextureSize(
         uint32_t width,
         uint32_t height,
@@ -74,10 +82,16 @@ public:
         uint32_t mipLevels,
         backend::TextureFormat format) noexcept;
 
-    void generateMipMaps();
+    // Uses the compute downsampler if the texture has storage usage and the
+    // format supports it, otherwise the levels are blitted.
+    void generateMipMaps(MipFilter filter = MipFilter::Box, bool srgb = false);
+
+    void prefilterSpecular(IMappedTexture* envMap, uint32_t sampleCount);
 
     static uint32_t getFormatByteSize(backend::TextureFormat format);
 
+    static bool isFormatSupported(IEngine& engine, backend::TextureFormat format);
+
     [[nodiscard]] bool isCubeMap() const noexcept { return faceCount_ == 6; }
 
     // ================= getters =====================
@@ -93,10 +107,21 @@ public:
 
     Params getTextureParams() noexcept;
 
+    std::vector<uint8_t> download();
+
     [[maybe_unused]] void shutDown(vkapi::VkDriver& driver) { YAVE_UNUSED(driver); }
 
     // ================== client api ===================
 
+private:
+    void createBackendTexture(
+        uint32_t width,
+        uint32_t height,
+        uint32_t levels,
+        uint32_t faces,
+        TextureFormat format,
+        uint32_t usageFlags);
+
 private:
     IEngine& engine_;
 
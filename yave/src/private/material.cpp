@@ -38,6 +38,8 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+
 namespace yave
 {
 
@@ -233,6 +235,11 @@ void IMaterial::addImageTexture(
     params.mipLevels = texture->getMipLevels();
     programBundle_->setImageSampler(
         texture->getBackendHandle(), binding, driver.getSamplerCache().createSampler(params));
+
+    if (std::find(textures_.begin(), textures_.end(), texture) == textures_.end())
+    {
+        textures_.emplace_back(texture);
+    }
 }
 
 void IMaterial::addImageTexture(
@@ -338,10 +345,8 @@ void IMaterial::build(
                     prog->addAttributeBlock(buffer->createShaderStr());
 
                     auto params = buffer->getBufferParams(driver);
-                    ASSERT_FATAL(params.buffer, "Vulkan buffer handle is invalid.");
-
                     programBundle_->addDescriptorBinding(
-                        params.size, params.binding, params.buffer, params.type);
+                        params.size, params.binding, params.buffers, params.type);
                 }
             }
 
@@ -351,7 +356,7 @@ void IMaterial::build(
                 ubos_[idx]->createGpuBuffer(driver);
                 auto uboParams = ubos_[idx]->getBufferParams(driver);
                 programBundle_->addDescriptorBinding(
-                    uboParams.size, uboParams.binding, uboParams.buffer, uboParams.type);
+                    uboParams.size, uboParams.binding, uboParams.buffers, uboParams.type);
             }
 
             // add ubo and push block strings to shader block
@@ -369,7 +374,9 @@ void IMaterial::build(
 
     if (withDynMeshTransformUbo_)
     {
+        // the fragment stage reads the per-instance material overrides
         addBuffer(&scene.getTransUbo(), backend::ShaderStage::Vertex);
+        addBuffer(&scene.getTransUbo(), backend::ShaderStage::Fragment);
     }
 
     addElements(backend::ShaderStage::Vertex, vProgram);
@@ -392,12 +399,16 @@ void IMaterial::build(
             backend::indexBufferTypeToVk(prim->getIndexBuffer()->getBufferType()),
             drawData.indexCount,
             drawData.indexPrimitiveOffset,
+            prim->getVertexOffset(),
             prim->getPrimRestartState());
     }
     else
     {
         programBundle_->addRenderPrimitive(
-            prim->getTopology(), drawData.vertexCount, prim->getPrimRestartState());
+            prim->getTopology(),
+            drawData.vertexCount,
+            prim->getVertexOffset(),
+            prim->getPrimRestartState());
     }
 
     // create the vertex shader (renderable)
@@ -200,6 +200,7 @@ public:
 
     [[nodiscard]] uint8_t getViewLayer() const noexcept { return viewLayer_; }
     [[nodiscard]] uint32_t getPipelineId() const noexcept { return pipelineId_; }
+    const std::vector<IMappedTexture*>& getTextures() const noexcept { return textures_; }
 
 private:
     // handle to ourself
@@ -218,6 +219,10 @@ private:
 
     std::vector<std::pair<backend::ShaderStage, BufferBase*>> buffers_;
 
+    // the image textures sampled by this material - used to request the mip
+    // levels of streamed textures.
+    std::vector<IMappedTexture*> textures_;
+
     // used to generate the samplers for this material
     SamplerSet samplerSet_[util::ecast(backend::ShaderStage::Count)];
 
@@ -0,0 +1,170 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "mip_generator.h"
+
+#include "compute.h"
+#include "engine.h"
+#include "utility/assertion.h"
+
+#include <vulkan-api/image.h>
+#include <vulkan-api/program_manager.h>
+#include <vulkan-api/texture.h>
+
+#include <algorithm>
+#include <array>
+#include <string>
+
+namespace yave
+{
+
+MipGenerator::MipGenerator(IEngine& engine) : engine_(engine) {}
+MipGenerator::~MipGenerator() = default;
+
+bool MipGenerator::isSupported(const vkapi::TextureHandle& handle)
+{
+    auto& driver = engine_.driver();
+    const vkapi::Texture* texture = driver.getTexture(handle);
+    const vkapi::TextureContext& params = texture->context();
+    return (texture->getUsageFlags() & vk::ImageUsageFlagBits::eStorage) &&
+        params.faceCount * params.arrayCount <= MaxLayerCount &&
+        !ImageStorageSet::texFormatToFormatLayout(params.format).empty() &&
+        driver.isStorageFormatSupported(params.format);
+}
+
+MipGenerator::Program& MipGenerator::getProgram(vk::Format format)
+{
+    auto iter = programs_.find(format);
+    if (iter != programs_.end())
+    {
+        return iter->second;
+    }
+
+    auto shaderCode = vkapi::ShaderProgramBundle::loadShader("downsample.comp");
+    ASSERT_FATAL(!shaderCode.empty(), "Error loading downsample compute shader.");
+    auto compute = std::make_unique<Compute>(engine_, shaderCode);
+
+    // the number of workgroups which have completed for each layer
+    std::array<uint32_t, MaxLayerCount> counters {};
+    compute->addSsbo(
+        "counters",
+        backend::BufferElementType::Uint,
+        StorageBuffer::AccessType::ReadWrite,
+        0,
+        "counter_ssbo",
+        counters.data(),
+        MaxLayerCount);
+
+    compute->addPushConstantParam("mipCount", backend::BufferElementType::Int);
+    compute->addPushConstantParam("filter", backend::BufferElementType::Int);
+    compute->addPushConstantParam("srgb", backend::BufferElementType::Int);
+
+    return programs_.emplace(format, Program {std::move(compute)}).first->second;
+}
+
+void MipGenerator::generate(
+    vk::CommandBuffer cmdBuffer,
+    const vkapi::TextureHandle& handle,
+    backend::MipFilter filter,
+    bool srgb)
+{
+    ASSERT_FATAL(isSupported(handle), "The texture does not support compute mip generation.");
+
+    auto& driver = engine_.driver();
+    vkapi::Texture* texture = driver.getTexture(handle);
+    const vkapi::TextureContext& params = texture->context();
+    if (params.mipLevels == 1)
+    {
+        return;
+    }
+
+    Program& program = getProgram(params.format);
+    Compute* compute = program.compute.get();
+
+    // unused levels are bound to the last level - the shader doesn't write
+    // to levels beyond the mip count
+    const auto lastLevel = params.mipLevels - 1;
+    compute->addStorageImage(
+        "SrcImage",
+        handle,
+        0,
+        ImageStorageSet::StorageType::ReadOnly,
+        ImageStorageSet::SamplerType::e2dArray);
+    for (uint32_t level = 1; level < static_cast<uint32_t>(vkapi::Texture::MaxMipCount); ++level)
+    {
+        // the last level generated from each tile is read back by the last
+        // workgroup of each layer
+        compute->addStorageImage(
+            "DstLevel" + std::to_string(level),
+            handle,
+            level,
+            level == TileLevelCount ? ImageStorageSet::StorageType::Coherent
+                                    : ImageStorageSet::StorageType::WriteOnly,
+            ImageStorageSet::SamplerType::e2dArray,
+            std::min(level, lastLevel));
+    }
+    if (!program.bundle)
+    {
+        program.bundle = compute->build(engine_);
+    }
+
+    int mipCount = static_cast<int>(params.mipLevels);
+    int filterType = static_cast<int>(filter);
+    int isSrgb = srgb;
+    compute->updatePushConstantParam("mipCount", &mipCount);
+    compute->updatePushConstantParam("filter", &filterType);
+    compute->updatePushConstantParam("srgb", &isSrgb);
+    compute->updateGpuPush();
+
+    // all levels are written to, so the image is transitioned as a whole
+    const vk::ImageLayout layout = texture->getImageLayout();
+    vkapi::Image::transition(
+        *texture->getImage(),
+        layout,
+        vk::ImageLayout::eGeneral,
+        cmdBuffer,
+        vk::PipelineStageFlagBits::eAllCommands,
+        vk::PipelineStageFlagBits::eComputeShader);
+
+    // the workgroup counters may still be being reset by a previous dispatch
+    vkapi::VkContext::writeReadComputeBarrier(cmdBuffer);
+
+    const uint32_t xGroupCount = (params.width + TileSize - 1) / TileSize;
+    const uint32_t yGroupCount = (params.height + TileSize - 1) / TileSize;
+    driver.dispatchCompute(
+        cmdBuffer,
+        program.bundle,
+        xGroupCount,
+        yGroupCount,
+        params.faceCount * params.arrayCount);
+
+    vkapi::Image::transition(
+        *texture->getImage(),
+        vk::ImageLayout::eGeneral,
+        layout,
+        cmdBuffer,
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader);
+}
+
+} // namespace yave
@@ -0,0 +1,97 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "backend/enums.h"
+
+#include <vulkan-api/common.h>
+#include <vulkan-api/driver.h>
+
+#include <memory>
+#include <unordered_map>
+
+namespace yave
+{
+class IEngine;
+class Compute;
+
+/**
+ * @brief Generates the mip chain of a texture with a single compute dispatch
+ * (see downsample.comp). Non-square and non power of two textures are
+ * supported, along with cube maps and array textures - each layer is reduced
+ * by its own set of workgroups. The texture must have been created with
+ * storage usage and a format that can be bound as a storage image.
+ */
+class MipGenerator
+{
+public:
+    // the largest layer count which can be reduced in one dispatch
+    static constexpr int MaxLayerCount = 64;
+    // the size of the tile of the first level reduced by each workgroup
+    static constexpr int TileSize = 64;
+    // the number of levels each workgroup generates from its tile - the last
+    // of these is read back to generate the remaining levels
+    static constexpr uint32_t TileLevelCount = 6;
+
+    explicit MipGenerator(IEngine& engine);
+    ~MipGenerator();
+
+    MipGenerator(const MipGenerator&) = delete;
+    MipGenerator& operator=(const MipGenerator&) = delete;
+
+    [[nodiscard]] bool isSupported(const vkapi::TextureHandle& handle);
+
+    /**
+     * @brief Records the generation of all levels below the first level.
+     * Can be called from within a render graph executor pass, for instance to
+     * reduce a depth buffer with the min/max filters.
+     * @param srgb If set, the colour channels are treated as sRGB encoded and
+     * filtered in linear space. There are no sRGB storage formats, so this is
+     * for sRGB data held in a unorm image.
+     */
+    void generate(
+        vk::CommandBuffer cmdBuffer,
+        const vkapi::TextureHandle& handle,
+        backend::MipFilter filter,
+        bool srgb = false);
+
+private:
+    struct Program
+    {
+        std::unique_ptr<Compute> compute;
+        // set once the shader has been built
+        vkapi::ShaderProgramBundle* bundle = nullptr;
+    };
+
+    Program& getProgram(vk::Format format);
+
+private:
+    IEngine& engine_;
+
+    // the storage image format layout is declared in the shader, so a
+    // variant is required for each format
+    std::unordered_map<vk::Format, Program> programs_;
+};
+
+} // namespace yave
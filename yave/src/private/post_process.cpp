@@ -149,7 +149,7 @@ rg::RenderGraphHandle PostProcess::bloom(
         // images need to be in VK_IMAGE_LAYOUT_GENERAL for use as image stores.
         // we also add a memory barrier to make sure the fragment shader has
         // finished before using the light image.
-        lightHandle.getResource()->transition(
+        driver.getTexture(lightHandle)->transition(
             vk::ImageLayout::eShaderReadOnlyOptimal,
             vk::ImageLayout::eGeneral,
             cmdBuffer,
@@ -189,7 +189,7 @@ rg::RenderGraphHandle PostProcess::bloom(
 
         // memory barrier to ensure the last compute shader has finished writing to the image
         // before we start reading from it.
-        lightHandle.getResource()->memoryBarrier(
+        driver.getTexture(lightHandle)->memoryBarrier(
             cmdBuffer,
             vk::AccessFlagBits::eShaderWrite,
             vk::AccessFlagBits::eShaderRead,
@@ -252,7 +252,7 @@ rg::RenderGraphHandle PostProcess::bloom(
             auto& cmds = driver.getCommands();
             vk::CommandBuffer cmdBuffer = cmds.getCmdBuffer().cmdBuffer;
 
-            lightHandle.getResource()->transition(
+            driver.getTexture(lightHandle)->transition(
                 vk::ImageLayout::eGeneral,
                 vk::ImageLayout::eShaderReadOnlyOptimal,
                 cmdBuffer,
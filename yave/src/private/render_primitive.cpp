@@ -39,6 +39,7 @@ IRenderPrimitive::IRenderPrimitive()
       primitiveRestart_(false),
       vertBuffer_(nullptr),
       indexBuffer_(nullptr),
+      vertexOffset_(0),
       material_(nullptr)
 {
 }
@@ -54,10 +55,20 @@ vkapi::VDefinitions IRenderPrimitive::createVertexAttributeVariants()
     if (bits.testBit(VertexBuffer::BindingType::Position))
     {
         map.emplace("HAS_POS_ATTR_INPUT", 1);
+        if (vertBuffer_->getAttributeFormat(VertexBuffer::BindingType::Position) ==
+            vk::Format::eR16G16B16A16Unorm)
+        {
+            map.emplace("HAS_QUANTISED_POS_INPUT", 1);
+        }
     }
     if (bits.testBit(VertexBuffer::BindingType::Normal))
     {
         map.emplace("HAS_NORMAL_ATTR_INPUT", 1);
+        if (vertBuffer_->getAttributeFormat(VertexBuffer::BindingType::Normal) ==
+            vk::Format::eR16G16Snorm)
+        {
+            map.emplace("HAS_OCT_NORMAL_INPUT", 1);
+        }
     }
     if (bits.testBit(VertexBuffer::BindingType::Uv))
     {
@@ -74,6 +85,11 @@ vkapi::VDefinitions IRenderPrimitive::createVertexAttributeVariants()
     if (bits.testBit(VertexBuffer::BindingType::Bones))
     {
         map.emplace("HAS_BONES_ATTR_INPUT", 1);
+        vk::Format format = vertBuffer_->getAttributeFormat(VertexBuffer::BindingType::Bones);
+        if (format == vk::Format::eR8G8B8A8Uint || format == vk::Format::eR16G16B16A16Uint)
+        {
+            map.emplace("HAS_UINT_BONES_INPUT", 1);
+        }
     }
     return map;
 }
@@ -86,6 +102,55 @@ void IRenderPrimitive::addMeshDrawData(size_t indexCount, size_t offset, size_t
     drawData_ = {indexCount, offset, vertexCount};
 }
 
+void IRenderPrimitive::addLodDrawData(size_t indexCount, size_t offset, float error)
+{
+    ASSERT_FATAL(
+        drawData_.indexCount > 0, "The full detail index range must be added before any lods.");
+    ASSERT_FATAL(
+        lods_.empty() || lods_.back().error <= error,
+        "Lods must be added in order of increasing error.");
+    lods_.push_back({indexCount, offset, 0, error});
+}
+
+void IRenderPrimitive::setClusters(const std::vector<ModelMesh::Cluster>& clusters)
+{
+    clusterCenters_.clear();
+    clusterRadii_.clear();
+    clusterCones_.clear();
+    clusterRanges_.clear();
+    for (const ModelMesh::Cluster& cluster : clusters)
+    {
+        clusterCenters_.emplace_back(cluster.center);
+        clusterRadii_.emplace_back(cluster.radius);
+        clusterCones_.emplace_back(cluster.coneAxis, cluster.coneCutoff);
+        clusterRanges_.push_back(
+            {static_cast<uint32_t>(cluster.indexCount),
+             static_cast<uint32_t>(cluster.indexOffset)});
+    }
+}
+
+void IRenderPrimitive::getVisibleClusterRanges(
+    const uint8_t* visible,
+    std::vector<vkapi::ShaderProgramBundle::IndexRange>& ranges) const noexcept
+{
+    ranges.clear();
+    for (size_t i = 0; i < clusterRanges_.size(); ++i)
+    {
+        if (!visible[i])
+        {
+            continue;
+        }
+        // clusters which are adjacent in the index buffer are drawn as one range
+        const auto& range = clusterRanges_[i];
+        if (!ranges.empty() && ranges.back().offset + ranges.back().indicesCount == range.offset)
+        {
+            ranges.back().indicesCount += range.indicesCount;
+            continue;
+        }
+        ranges.push_back(range);
+    }
+}
+
 void IRenderPrimitive::setTopology(backend::PrimitiveTopology topo)
 {
     topology_ = backend::primitiveTopologyToVk(topo);
@@ -95,8 +160,16 @@ void IRenderPrimitive::setVertexBuffer(IVertexBuffer* vBuffer) noexcept { vertBu
 
 void IRenderPrimitive::setIndexBuffer(IIndexBuffer* iBuffer) noexcept { indexBuffer_ = iBuffer; }
 
+void IRenderPrimitive::setVertexOffset(uint32_t offset) noexcept { vertexOffset_ = offset; }
+
 void IRenderPrimitive::setMaterial(IMaterial* mat) noexcept { material_ = mat; }
 
+void IRenderPrimitive::setDimensions(const mathfu::vec3& min, const mathfu::vec3& max) noexcept
+{
+    box_.min = min;
+    box_.max = max;
+}
+
 void IRenderPrimitive::enablePrimitiveRestart() noexcept { primitiveRestart_ = true; }
 
 } // namespace yave
@@ -30,9 +30,13 @@
 #include <vulkan-api/common.h>
 #include <vulkan-api/driver.h>
 #include <vulkan-api/pipeline_cache.h>
+#include <vulkan-api/program_manager.h>
 #include <yave/engine.h>
 #include <yave/render_primitive.h>
 
+#include <algorithm>
+#include <vector>
+
 namespace yave
 {
 class VkDriver;
@@ -55,6 +59,8 @@ public:
         size_t indexCount = 0;
         size_t indexPrimitiveOffset = 0;
         size_t vertexCount = 0;
+        // the simplification error of a lod as a fraction of the extent
+        float error = 0.0f;
     };
 
     IRenderPrimitive();
@@ -64,6 +70,10 @@ public:
 
     void addMeshDrawData(size_t indexCount, size_t offset, size_t vertexCount);
 
+    void addLodDrawData(size_t indexCount, size_t offset, float error);
+
+    void setClusters(const std::vector<ModelMesh::Cluster>& clusters);
+
     vkapi::VDefinitions createVertexAttributeVariants();
 
     void enablePrimitiveRestart() noexcept;
@@ -73,14 +83,53 @@ public:
     void setTopology(backend::PrimitiveTopology topo);
     void setVertexBuffer(IVertexBuffer* vBuffer) noexcept;
     void setIndexBuffer(IIndexBuffer* iBuffer) noexcept;
+    void setVertexOffset(uint32_t offset) noexcept;
     void setMaterial(IMaterial* mat) noexcept;
+    void setDimensions(const mathfu::vec3& min, const mathfu::vec3& max) noexcept;
 
     // =================== getters ============================
 
     [[nodiscard]] vk::PrimitiveTopology getTopology() const noexcept { return topology_; }
     [[nodiscard]] bool getPrimRestartState() const noexcept { return primitiveRestart_; }
     [[nodiscard]] const AABBox& getDimensions() const noexcept { return box_; }
+    [[nodiscard]] uint32_t getVertexOffset() const noexcept { return vertexOffset_; }
     [[nodiscard]] const MeshDrawData& getDrawData() const noexcept { return drawData_; }
+
+    // lod 0 is the full detail draw data - the lod is clamped to the levels available
+    [[nodiscard]] const MeshDrawData& getDrawData(uint32_t lod) const noexcept
+    {
+        return lod && !lods_.empty() ? lods_[std::min<size_t>(lod, lods_.size()) - 1] : drawData_;
+    }
+
+    [[nodiscard]] uint32_t getLodCount() const noexcept
+    {
+        return static_cast<uint32_t>(lods_.size() + 1);
+    }
+
+    [[nodiscard]] size_t getClusterCount() const noexcept { return clusterRanges_.size(); }
+
+    // the cluster bounds - stored as separate arrays for the culling loops
+    [[nodiscard]] const mathfu::vec3* getClusterCenters() const noexcept
+    {
+        return clusterCenters_.data();
+    }
+    [[nodiscard]] const float* getClusterRadii() const noexcept { return clusterRadii_.data(); }
+    // the cone axis (xyz) and cutoff (w)
+    [[nodiscard]] const mathfu::vec4* getClusterCones() const noexcept
+    {
+        return clusterCones_.data();
+    }
+
+    /**
+     * @brief Merges the index ranges of the visible clusters into draw ranges.
+     * The ranges are returned rather than stored as primitives may be shared
+     * between instances - see **IRenderable::setVisibleClusters**.
+     * @param visible One entry per cluster, non-zero if visible.
+     */
+    void getVisibleClusterRanges(
+        const uint8_t* visible,
+        std::vector<vkapi::ShaderProgramBundle::IndexRange>& ranges) const noexcept;
+
     util::BitSetEnum<Variants>& getVariantBits() noexcept { return variants_; }
 
     IVertexBuffer* getVertexBuffer() noexcept { return vertBuffer_; }
@@ -100,9 +149,23 @@ private:
     IVertexBuffer* vertBuffer_;
     IIndexBuffer* indexBuffer_;
 
+    // the first vertex of this primitive within the vertex buffer, which may
+    // be shared with other primitives
+    uint32_t vertexOffset_;
+
     // index offsets
     MeshDrawData drawData_;
 
+    // the index offsets of the simplified levels - the full detail level
+    // is **drawData_**
+    std::vector<MeshDrawData> lods_;
+
+    // the cluster bounds and index ranges of the full detail level
+    std::vector<mathfu::vec3> clusterCenters_;
+    std::vector<float> clusterRadii_;
+    std::vector<mathfu::vec4> clusterCones_;
+    std::vector<vkapi::ShaderProgramBundle::IndexRange> clusterRanges_;
+
     // the material for this primitive. This isn't owned by the
     // primitive - this is the "property" of the renderable manager.
     IMaterial* material_;
@@ -29,7 +29,8 @@ IRenderable::IRenderable()
     : program_(nullptr),
       meshDynamicOffset_(0),
       skinDynamicOffset_(IRenderable::UNINITIALISED),
-      tesselationVertCount_(0)
+      tesselationVertCount_(0),
+      lod_(0)
 {
 }
 
@@ -58,6 +59,47 @@ void IRenderable::setPrimitiveCountI(size_t count) noexcept
 {
     ASSERT_LOG(count > 0);
     primitives_.resize(count);
+    clusterVisibility_.resize(count);
+}
+
+void IRenderable::setInstanceOf(const IRenderable& prototype) noexcept
+{
+    ASSERT_LOG(!prototype.primitives_.empty());
+    primitives_ = prototype.primitives_;
+    program_ = prototype.program_;
+    tesselationVertCount_ = prototype.tesselationVertCount_;
+    if (prototype.visibility_.testBit(Visible::Ignore))
+    {
+        visibility_.setBit(Visible::Ignore);
+    }
+    clusterVisibility_.resize(primitives_.size());
+}
+
+void IRenderable::setVisibleClusters(size_t primIdx, const uint8_t* visible) noexcept
+{
+    ASSERT_LOG(primIdx < primitives_.size());
+    ClusterVisibility& clusters = clusterVisibility_[primIdx];
+    primitives_[primIdx]->getVisibleClusterRanges(visible, clusters.ranges);
+    clusters.enabled = true;
+}
+
+void IRenderable::resetVisibleClusters(size_t primIdx) noexcept
+{
+    ASSERT_LOG(primIdx < primitives_.size());
+    clusterVisibility_[primIdx].enabled = false;
+}
+
+const std::vector<vkapi::ShaderProgramBundle::IndexRange>*
+IRenderable::getVisibleClusterRanges(const IRenderPrimitive* prim) const noexcept
+{
+    for (size_t idx = 0; idx < primitives_.size(); ++idx)
+    {
+        if (primitives_[idx] == prim)
+        {
+            return clusterVisibility_[idx].enabled ? &clusterVisibility_[idx].ranges : nullptr;
+        }
+    }
+    return nullptr;
 }
 
 IRenderPrimitive* IRenderable::getRenderPrimitive(size_t idx) noexcept
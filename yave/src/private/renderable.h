@@ -71,6 +71,30 @@ public:
 
     void setTesselationVertCount(size_t count) noexcept { tesselationVertCount_ = count; }
 
+    void setLod(uint32_t lod) noexcept { lod_ = lod; }
+
+    void setMaterialOverridesI(const MaterialOverrides& overrides) noexcept
+    {
+        materialOverrides_ = overrides;
+    }
+
+    /**
+     * @brief Makes this renderable an instance of the prototype - the
+     * primitives, and so their buffers and materials, are shared rather than
+     * copied. Only the per-frame state is held by the instance.
+     */
+    void setInstanceOf(const IRenderable& prototype) noexcept;
+
+    /**
+     * @brief Sets the clusters of the primitive which passed culling this frame.
+     * @param visible One entry per cluster of the primitive, non-zero if visible.
+     */
+    void setVisibleClusters(size_t primIdx, const uint8_t* visible) noexcept;
+
+    // disables cluster culling of the primitive for this frame - the full
+    // index range is drawn
+    void resetVisibleClusters(size_t primIdx) noexcept;
+
     // ================= getters ========================
 
     IRenderPrimitive* getRenderPrimitive(size_t idx = 0) noexcept;
@@ -83,6 +107,20 @@ public:
 
     [[nodiscard]] size_t getTesselationVertCount() const noexcept { return tesselationVertCount_; }
 
+    [[nodiscard]] uint32_t getLod() const noexcept { return lod_; }
+
+    [[nodiscard]] const MaterialOverrides& getMaterialOverrides() const noexcept
+    {
+        return materialOverrides_;
+    }
+
+    /**
+     * @brief The merged index ranges of the visible clusters of the primitive.
+     * @return nullptr if cluster culling isn't used for the primitive this frame.
+     */
+    [[nodiscard]] const std::vector<vkapi::ShaderProgramBundle::IndexRange>*
+    getVisibleClusterRanges(const IRenderPrimitive* prim) const noexcept;
+
     friend class IRenderableManager;
 
 private:
@@ -101,7 +139,24 @@ private:
     // shader pipeline is used.
     size_t tesselationVertCount_;
 
+    // the level of detail selected for the current frame - kept between frames
+    // for the lod hysteresis
+    uint32_t lod_;
+
+    // applied on top of the materials of the primitives, which may be shared
+    // with other instances
+    MaterialOverrides materialOverrides_;
+
     std::vector<IRenderPrimitive*> primitives_;
+
+    // the visible clusters of each primitive for the current frame. Held here
+    // rather than by the primitive as primitives are shared between instances.
+    struct ClusterVisibility
+    {
+        std::vector<vkapi::ShaderProgramBundle::IndexRange> ranges;
+        bool enabled = false;
+    };
+    std::vector<ClusterVisibility> clusterVisibility_;
 };
 
 } // namespace yave
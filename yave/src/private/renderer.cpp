@@ -65,8 +65,9 @@ void IRenderer::createBackbufferRT() noexcept
         1,
         vk::ImageUsageFlagBits::eDepthStencilAttachment);
 
-    // assume triple buffered backbuffer
-    for (uint8_t idx = 0; idx < 3; ++idx)
+    // a render target is required for each image in the swapchain
+    rtHandles_.resize(swapchain->imageCount());
+    for (uint32_t idx = 0; idx < swapchain->imageCount(); ++idx)
     {
         auto scTextureHandle = swapchain->getTexture(idx);
 
@@ -96,6 +97,12 @@ void IRenderer::endFrame() noexcept
     engine_->driver().endFrame(*swapchain);
 }
 
+const vkapi::FrameContext::FrameTimings& IRenderer::getFrameTimings() const noexcept
+{
+    ASSERT_LOG(engine_);
+    return engine_->driver().getFrameTimings();
+}
+
 void IRenderer::renderSingleScene(vkapi::VkDriver& driver, IScene* scene, RenderTarget& rTarget)
 {
     auto& cmds = driver.getCommands();
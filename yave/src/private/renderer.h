@@ -30,6 +30,7 @@
 #include "yave/scene.h"
 
 #include <array>
+#include <vector>
 
 namespace yave
 {
@@ -51,6 +52,8 @@ public:
 
     void endFrame() noexcept;
 
+    [[nodiscard]] const vkapi::FrameContext::FrameTimings& getFrameTimings() const noexcept;
+
     void render(
         vkapi::VkDriver& driver,
         IScene* scene,
@@ -66,8 +69,8 @@ private:
 
     rg::RenderGraph rGraph_;
 
-    // render targets for the backbuffer
-    std::array<vkapi::RenderTargetHandle, 3> rtHandles_;
+    // render targets for the backbuffer - one per swapchain image
+    std::vector<vkapi::RenderTargetHandle> rtHandles_;
 
     // keep track of the depth texture - set by createBackBufferRT
     vkapi::TextureHandle depthHandle_;
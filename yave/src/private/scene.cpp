@@ -30,7 +30,12 @@
 #include "managers/component_manager.h"
 #include "managers/renderable_manager.h"
 #include "managers/transform_manager.h"
+#include "render_primitive.h"
+#include "mapped_texture.h"
+#include "material.h"
 #include "renderable.h"
+#include "texture_streamer.h"
+#include "vertex_buffer.h"
 
 #include <tbb/tbb.h>
 #include <utility/aligned_alloc.h>
@@ -40,7 +45,9 @@
 #include <yave/skybox.h>
 
 #include <algorithm>
+#include <cmath>
 #include <cstring>
+#include <limits>
 
 namespace yave
 {
@@ -60,6 +67,12 @@ IScene::IScene(IEngine& engine)
     transUbo_ = std::make_unique<UniformBuffer>(
         vkapi::PipelineCache::UboDynamicSetValue, 0, "TransformUbo", "mesh_ubo");
     transUbo_->addElement("modelMatrix", backend::BufferElementType::Mat4);
+    transUbo_->addElement("positionScale", backend::BufferElementType::Float4);
+    transUbo_->addElement("positionOffset", backend::BufferElementType::Float4);
+    // the per-instance material overrides - see MaterialOverrides
+    transUbo_->addElement("baseColourFactor", backend::BufferElementType::Float4);
+    transUbo_->addElement("emissiveFactor", backend::BufferElementType::Float4);
+    transUbo_->addElement("pbrFactors", backend::BufferElementType::Float4);
     transUbo_->createGpuBuffer(driver, ModelBufferInitialSize * transUbo_->size());
 
     skinUbo_ = std::make_unique<UniformBuffer>(
@@ -167,6 +180,12 @@ bool IScene::update()
     // NOTE: These checks will eventually be done in a compute shader.
     getVisibleRenderables(frustum, candRenderableObjs_);
 
+    selectLods(candRenderableObjs_);
+
+    requestTextureLevels(candRenderableObjs_);
+
+    cullClusters(frustum, candRenderableObjs_);
+
     getVisibleLights(frustum, candLightObjs);
 
     // ============ render queue generation =========================
@@ -177,6 +196,10 @@ bool IScene::update()
     size_t staticModelCount = 0;
     size_t skinnedModelCount = 0;
 
+    // instances share the materials of their prototype - these only need
+    // updating once per frame
+    updatedMaterials_.clear();
+
     for (const VisibleCandidate& cand : candRenderableObjs_)
     {
         IRenderable* rend = cand.renderable;
@@ -200,7 +223,10 @@ bool IScene::update()
         for (IRenderPrimitive* prim : rend->getAllRenderPrimitives())
         {
             IMaterial* mat = prim->getMaterial();
-            mat->update(engine_);
+            if (updatedMaterials_.insert(mat).second)
+            {
+                mat->update(engine_);
+            }
 
             RenderableQueueInfo queueInfo;
             queueInfo.renderableData = (void*)rend;
@@ -271,6 +297,224 @@ void IScene::getVisibleRenderables(
         });
 }
 
+void IScene::selectLods(std::vector<IScene::VisibleCandidate>& renderables)
+{
+    if (!lodOptions_.enabled)
+    {
+        return;
+    }
+
+    const mathfu::vec3 cameraPos = camera_->position();
+    // converts a size at unit distance to a fraction of the screen height -
+    // the screen height at unit distance is 2 * tan(fov / 2)
+    const float projScale = 0.5f * std::abs(camera_->projMatrix()(1, 1));
+
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, renderables.size()), [&](tbb::blocked_range<size_t> range) {
+            for (size_t idx = range.begin(); idx < range.end(); ++idx)
+            {
+                const VisibleCandidate& cand = renderables[idx];
+                IRenderable* rend = cand.renderable;
+                IRenderPrimitive* prim = rend->getRenderPrimitive();
+                if (!rend->getVisibility().testBit(IRenderable::Visible::Render) ||
+                    rend->getVisibility().testBit(IRenderable::Visible::Ignore) ||
+                    prim->getLodCount() < 2)
+                {
+                    continue;
+                }
+
+                uint32_t lod = 0;
+                float projectedSize = getProjectedSize(cand, cameraPos, projScale);
+                if (!std::isinf(projectedSize))
+                {
+                    lod = selectLod(*prim, projectedSize, rend->getLod(), lodOptions_);
+                }
+                rend->setLod(lod);
+            }
+        });
+}
+
+float IScene::getProjectedSize(
+    const VisibleCandidate& cand, const mathfu::vec3& cameraPos, float projScale) noexcept
+{
+    // the world space bounding sphere of the object space box, taking into
+    // account any scaling
+    const AABBox& box = cand.renderable->getRenderPrimitive()->getDimensions();
+    const mathfu::mat4& world = cand.worldTransform;
+    float scale = std::max(
+        {world.GetColumn(0).xyz().Length(),
+         world.GetColumn(1).xyz().Length(),
+         world.GetColumn(2).xyz().Length()});
+    float radius = box.getHalfExtent().Length() * scale;
+    float distance = (world * box.getCenter() - cameraPos).Length();
+
+    if (distance <= radius)
+    {
+        return std::numeric_limits<float>::infinity();
+    }
+    return 2.0f * radius * projScale / distance;
+}
+
+void IScene::requestTextureLevels(const std::vector<IScene::VisibleCandidate>& renderables)
+{
+    TextureStreamer& streamer = engine_.getTextureStreamer();
+    const float bias = streamer.getOptions().bias;
+
+    const mathfu::vec3 cameraPos = camera_->position();
+    const float projScale = 0.5f * std::abs(camera_->projMatrix()(1, 1));
+    const auto screenHeight = static_cast<float>(gbufferOptions_.height);
+
+    for (const VisibleCandidate& cand : renderables)
+    {
+        IRenderable* rend = cand.renderable;
+        if (!rend->getVisibility().testBit(IRenderable::Visible::Render) ||
+            rend->getVisibility().testBit(IRenderable::Visible::Ignore))
+        {
+            continue;
+        }
+
+        // Assumes the uvs cover the texture once across the object - the
+        // texel density is approximated by the pixels covered by the bounding
+        // sphere rather than from the uv derivatives.
+        float pixels = getProjectedSize(cand, cameraPos, projScale) * screenHeight;
+        for (IRenderPrimitive* prim : rend->getAllRenderPrimitives())
+        {
+            IMaterial* mat = prim->getMaterial();
+            if (!mat)
+            {
+                continue;
+            }
+            for (IMappedTexture* texture : mat->getTextures())
+            {
+                auto size = static_cast<uint32_t>(
+                    std::max(texture->getWidth(), texture->getHeight()));
+                streamer.request(texture, TextureStreamer::getRequiredLevel(size, pixels, bias));
+            }
+        }
+    }
+
+    streamer.update();
+}
+
+uint32_t IScene::selectLod(
+    const IRenderPrimitive& prim,
+    float projectedSize,
+    uint32_t currentLod,
+    const LodOptions& options) noexcept
+{
+    const float limit = options.screenError * options.bias;
+    for (uint32_t lod = prim.getLodCount() - 1; lod > 0; --lod)
+    {
+        float screenError = prim.getDrawData(lod).error * projectedSize;
+        float lodLimit = lod > currentLod ? limit * (1.0f - options.hysteresis) : limit;
+        if (screenError <= lodLimit)
+        {
+            return lod;
+        }
+    }
+    return 0;
+}
+
+void IScene::cullClusters(Frustum& frustum, std::vector<IScene::VisibleCandidate>& renderables)
+{
+    const mathfu::vec3 cameraPos = camera_->position();
+    const ClusterCullOptions& options = clusterCullOptions_;
+
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, renderables.size()), [&](tbb::blocked_range<size_t> range) {
+            std::vector<uint8_t> visible;
+            for (size_t idx = range.begin(); idx < range.end(); ++idx)
+            {
+                const VisibleCandidate& cand = renderables[idx];
+                IRenderable* rend = cand.renderable;
+
+                // the clusters only cover the full detail lod
+                bool cull = options.enabled && rend->getLod() == 0 &&
+                    rend->getVisibility().testBit(IRenderable::Visible::Render) &&
+                    !rend->getVisibility().testBit(IRenderable::Visible::Ignore);
+
+                Frustum objFrustum;
+                mathfu::vec3 eye;
+                bool backfaceCulling = false;
+                if (cull)
+                {
+                    // the clusters are tested in object space so they don't
+                    // need transforming
+                    const mathfu::mat4& world = cand.worldTransform;
+                    objFrustum = frustum.toObjectSpace(world);
+                    eye = world.Inverse() * cameraPos;
+
+                    // the cone test only holds for uniformly scaled,
+                    // non-mirrored transforms
+                    const mathfu::vec3 col0 = world.GetColumn(0).xyz();
+                    const mathfu::vec3 col1 = world.GetColumn(1).xyz();
+                    const mathfu::vec3 col2 = world.GetColumn(2).xyz();
+                    const float minScale =
+                        std::min({col0.Length(), col1.Length(), col2.Length()});
+                    const float maxScale =
+                        std::max({col0.Length(), col1.Length(), col2.Length()});
+                    const bool mirrored =
+                        mathfu::vec3::DotProduct(mathfu::vec3::CrossProduct(col0, col1), col2) <
+                        0.0f;
+                    backfaceCulling = options.backfaceCulling && !mirrored &&
+                        maxScale <= minScale * MaxUniformScaleRatio;
+                }
+
+                const auto& prims = rend->getAllRenderPrimitives();
+                for (size_t primIdx = 0; primIdx < prims.size(); ++primIdx)
+                {
+                    const IRenderPrimitive* prim = prims[primIdx];
+                    const size_t clusterCount = prim->getClusterCount();
+                    if (!cull || !clusterCount)
+                    {
+                        rend->resetVisibleClusters(primIdx);
+                        continue;
+                    }
+
+                    visible.resize(clusterCount);
+                    objFrustum.checkSphereIntersection(
+                        prim->getClusterCenters(),
+                        prim->getClusterRadii(),
+                        clusterCount,
+                        visible.data());
+                    if (backfaceCulling)
+                    {
+                        cullBackFacingClusters(
+                            prim->getClusterCenters(),
+                            prim->getClusterRadii(),
+                            prim->getClusterCones(),
+                            clusterCount,
+                            eye,
+                            visible.data());
+                    }
+                    rend->setVisibleClusters(primIdx, visible.data());
+                }
+            }
+        });
+}
+
+void IScene::cullBackFacingClusters(
+    const mathfu::vec3* __restrict centers,
+    const float* __restrict radii,
+    const mathfu::vec4* __restrict cones,
+    size_t count,
+    const mathfu::vec3& eye,
+    uint8_t* __restrict visible) noexcept
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float dx = centers[i].x - eye.x;
+        const float dy = centers[i].y - eye.y;
+        const float dz = centers[i].z - eye.z;
+        const float dist = std::sqrt(dx * dx + dy * dy + dz * dz);
+        const float dot = dx * cones[i].x + dy * cones[i].y + dz * cones[i].z;
+
+        // conservative for any point within the bounding sphere
+        const bool backFacing = dot >= cones[i].w * (dist + radii[i]) + radii[i];
+        visible[i] &= static_cast<uint8_t>(!backFacing);
+    }
+}
+
 void IScene::getVisibleLights(Frustum& frustum, std::vector<LightInstance*>& lights)
 {
     tbb::parallel_for(
@@ -338,25 +582,37 @@ void IScene::updateTransformBuffer(
         TransformInfo* transInfo = cand.transform;
 
         size_t meshOffset = staticDynAlign * staticCount++;
-        auto* currStaticPtr = reinterpret_cast<mathfu::mat4*>(transPtr + meshOffset);
-        *currStaticPtr = transInfo->modelTransform;
+        auto* currStaticPtr = reinterpret_cast<TransformUboData*>(transPtr + meshOffset);
+        currStaticPtr->modelMatrix = transInfo->modelTransform;
+
+        // all primitives of a renderable share the vertex layout
+        IVertexBuffer* vBuffer = rend->getRenderPrimitive()->getVertexBuffer();
+        currStaticPtr->positionScale = vBuffer ? vBuffer->getPositionScale() : mathfu::vec4 {1.0f};
+        currStaticPtr->positionOffset =
+            vBuffer ? vBuffer->getPositionOffset() : mathfu::vec4 {0.0f};
+
+        const MaterialOverrides& overrides = rend->getMaterialOverrides();
+        currStaticPtr->baseColourFactor = overrides.baseColourFactor;
+        currStaticPtr->emissiveFactor = overrides.emissiveFactor;
+        currStaticPtr->pbrFactors =
+            mathfu::vec4 {overrides.roughnessFactor, overrides.metallicFactor, 0.0f, 0.0f};
 
         // the dynamic buffer offsets are stored in the renderable for ease of
         // access when drawing
         rend->setMeshDynamicOffset(static_cast<uint32_t>(meshOffset));
 
-        if (!transInfo->jointMatrices.empty())
+        if (!transInfo->getJointMatrices().empty())
         {
             // NOTE: The offset needs to take into account the number of joints per model skin (i.e.
             // keep track of the previous count)
             size_t skinOffset = skinDynAlign * skinnedCount++;
             auto* currSkinPtr = reinterpret_cast<mathfu::mat4*>(skinPtr + skinDynAlign);
-            *currSkinPtr = *transInfo->jointMatrices.data();
+            *currSkinPtr = *transInfo->getJointMatrices().data();
 
             // rather than throw an error, clamp the joint if it exceeds the max
             /*uint32_t jointCount = std::min(
                 ITransformManager::MaxBoneCount,
-                static_cast<uint32_t>(transInfo->jointMatrices.size()));*/
+                static_cast<uint32_t>(transInfo->getJointMatrices().size()));*/
 
             rend->setSkinDynamicOffset(static_cast<uint32_t>(skinOffset));
         }
@@ -404,5 +660,13 @@ void IScene::setGbufferOptions(const GbufferOptions& gb) { gbufferOptions_ = gb;
 
 GbufferOptions& IScene::getGbufferOptions() { return gbufferOptions_; }
 
+void IScene::setLodOptions(const LodOptions& lod) { lodOptions_ = lod; }
+
+LodOptions& IScene::getLodOptions() { return lodOptions_; }
+
+void IScene::setClusterCullOptions(const ClusterCullOptions& cull) { clusterCullOptions_ = cull; }
+
+ClusterCullOptions& IScene::getClusterCullOptions() { return clusterCullOptions_; }
+
 
 } // namespace yave
@@ -34,6 +34,7 @@
 
 #include <deque>
 #include <memory>
+#include <unordered_set>
 #include <vector>
 
 namespace yave
@@ -41,6 +42,8 @@ namespace yave
 // forward declarations
 class Object;
 class IRenderable;
+class IRenderPrimitive;
+class IMaterial;
 struct TransformInfo;
 class ICamera;
 class Frustum;
@@ -54,6 +57,10 @@ class IScene : public Scene
 public:
     static constexpr int ModelBufferInitialSize = 20;
 
+    // the maximum ratio between the largest and smallest axis scale of a
+    // transform for it to be considered uniformly scaled
+    static constexpr float MaxUniformScaleRatio = 1.01f;
+
     /**
      * @brief A temp struct used to gather viable renderable object data ready
      * for visibility checks and passing to the render queue
@@ -80,6 +87,59 @@ public:
 
     static void getVisibleLights(Frustum& frustum, std::vector<LightInstance*>& candLightObjs);
 
+    /**
+     * @brief Selects the level of detail of each visible renderable from the
+     * projected size of its bounding sphere.
+     */
+    void selectLods(std::vector<IScene::VisibleCandidate>& renderables);
+
+    /**
+     * @brief The diameter of the renderable's bounding sphere as a fraction of
+     * the screen height, or infinity if the camera is within the sphere.
+     * @param projScale Converts a size at unit distance to a fraction of the
+     * screen height.
+     */
+    static float getProjectedSize(
+        const VisibleCandidate& cand, const mathfu::vec3& cameraPos, float projScale) noexcept;
+
+    /**
+     * @brief Requests the mip levels of the streamed textures used by the
+     * visible renderables, from the number of pixels each renderable covers,
+     * and updates the streamer.
+     */
+    void requestTextureLevels(const std::vector<IScene::VisibleCandidate>& renderables);
+
+    /**
+     * @brief Returns the coarsest lod of the primitive whose error, projected
+     * using @p projectedSize (the bounding sphere diameter as a fraction of
+     * the screen height), is within the limit set by the options.
+     */
+    static uint32_t selectLod(
+        const IRenderPrimitive& prim,
+        float projectedSize,
+        uint32_t currentLod,
+        const LodOptions& options) noexcept;
+
+    /**
+     * @brief Culls the clusters of visible renderables at full detail against
+     * the frustum and their normal cones, storing the index ranges to draw in
+     * each primitive.
+     */
+    void cullClusters(Frustum& frustum, std::vector<IScene::VisibleCandidate>& renderables);
+
+    /**
+     * @brief Clears the visibility of clusters whose triangles all face away
+     * from @p eye, using the normal cone of each cluster. All values are in
+     * object space.
+     */
+    static void cullBackFacingClusters(
+        const mathfu::vec3* __restrict centers,
+        const float* __restrict radii,
+        const mathfu::vec4* __restrict cones,
+        size_t count,
+        const mathfu::vec3& eye,
+        uint8_t* __restrict visible) noexcept;
+
     void updateTransformBuffer(
         const std::vector<IScene::VisibleCandidate>& candObjects,
         size_t staticModelCount,
@@ -89,6 +149,8 @@ public:
     void setIndirectLight(IIndirectLight* il);
     void setBloomOptions(const BloomOptions& bloom);
     void setGbufferOptions(const GbufferOptions& gb);
+    void setLodOptions(const LodOptions& lod);
+    void setClusterCullOptions(const ClusterCullOptions& cull);
     void setCamera(ICamera* cam) noexcept;
     void setWaveGenerator(IWaveGenerator* waterGen) noexcept;
 
@@ -113,8 +175,22 @@ public:
     [[nodiscard]] bool withGbuffer() const noexcept { return useGbuffer_; }
     BloomOptions& getBloomOptions();
     GbufferOptions& getGbufferOptions();
+    LodOptions& getLodOptions();
+    ClusterCullOptions& getClusterCullOptions();
 
 private:
+    // the layout of the elements in the transform ubo
+    struct TransformUboData
+    {
+        mathfu::mat4 modelMatrix;
+        mathfu::vec4 positionScale;
+        mathfu::vec4 positionOffset;
+        mathfu::vec4 baseColourFactor;
+        mathfu::vec4 emissiveFactor;
+        // x: roughness factor, y: metallic factor
+        mathfu::vec4 pbrFactors;
+    };
+
     IEngine& engine_;
 
     // Current camera used by this scene.
@@ -128,6 +204,9 @@ private:
 
     std::vector<VisibleCandidate> candRenderableObjs_;
 
+    // the materials updated for the current frame
+    std::unordered_set<IMaterial*> updatedMaterials_;
+
     RenderQueue renderQueue_;
 
     std::unique_ptr<UniformBuffer> transUbo_;
@@ -143,6 +222,8 @@ private:
     // options
     BloomOptions bloomOptions_;
     GbufferOptions gbufferOptions_;
+    LodOptions lodOptions_;
+    ClusterCullOptions clusterCullOptions_;
 
     bool usePostProcessing_;
     bool useGbuffer_;
@@ -0,0 +1,200 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "sh_projector.h"
+
+#include "compute.h"
+#include "engine.h"
+#include "utility/assertion.h"
+#include "utility/stream_convert.h"
+
+#include <tbb/tbb.h>
+#include <vulkan-api/program_manager.h>
+#include <vulkan-api/texture.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace yave
+{
+
+namespace
+{
+
+// the number of rows projected by each task
+constexpr uint32_t RowGrainSize = 8;
+
+constexpr uint32_t GroupCount =
+    (ShProjector::ProjectionSize / ShProjector::GroupDim) *
+    (ShProjector::ProjectionSize / ShProjector::GroupDim) * 6;
+
+} // namespace
+
+ShProjector::ShProjector(IEngine& engine) : engine_(engine), bundle_(nullptr) {}
+ShProjector::~ShProjector() = default;
+
+uint32_t ShProjector::getProjectionLevel(const vkapi::Texture& texture) noexcept
+{
+    const vkapi::TextureContext& params = texture.context();
+    uint32_t level = 0;
+    while (level + 1 < params.mipLevels && (params.width >> (level + 1)) >= ProjectionSize)
+    {
+        ++level;
+    }
+    return level;
+}
+
+util::sh::Coefficients ShProjector::projectCpu(const vkapi::TextureHandle& handle)
+{
+    auto& driver = engine_.driver();
+    vkapi::Texture* texture = driver.getTexture(handle);
+    const vkapi::TextureContext& params = texture->context();
+    ASSERT_FATAL(params.faceCount == 6, "Only cube maps can be projected.");
+    ASSERT_FATAL(
+        params.format == vk::Format::eR32G32B32A32Sfloat ||
+            params.format == vk::Format::eR16G16B16A16Sfloat,
+        "The cube map must be an RGBA float format for projection on the cpu.");
+    const util::stream::Type type = params.format == vk::Format::eR32G32B32A32Sfloat
+        ? util::stream::Type::Float
+        : util::stream::Type::Half;
+
+    std::vector<uint8_t> data(texture->getDataSize());
+    driver.downloadTexture(handle, data.data(), data.size());
+
+    // the download is packed by face and then level
+    const uint32_t level = getProjectionLevel(*texture);
+    size_t levelOffset = 0;
+    size_t faceStride = 0;
+    for (uint32_t i = 0; i < params.mipLevels; ++i)
+    {
+        levelOffset += i < level ? texture->getLevelSize(i) : 0;
+        faceStride += texture->getLevelSize(i);
+    }
+
+    const uint32_t size = std::max(params.width >> level, 1u);
+    const size_t faceFloatCount = static_cast<size_t>(size) * size * 4;
+    std::vector<float> faces(faceFloatCount * 6);
+    for (uint32_t face = 0; face < 6; ++face)
+    {
+        util::stream::convertToFloat(
+            data.data() + face * faceStride + levelOffset,
+            type,
+            false,
+            faces.data() + face * faceFloatCount,
+            faceFloatCount);
+    }
+
+    tbb::combinable<util::sh::Projection> projections;
+    tbb::parallel_for(
+        tbb::blocked_range<uint32_t>(0, size * 6, RowGrainSize),
+        [&](const tbb::blocked_range<uint32_t>& range) {
+            util::sh::Projection& proj = projections.local();
+            // a range may span the boundary between two faces
+            for (uint32_t row = range.begin(); row < range.end();)
+            {
+                const uint32_t face = row / size;
+                const uint32_t rowEnd = std::min(range.end(), (face + 1) * size);
+                util::sh::projectRows(
+                    faces.data() + face * faceFloatCount,
+                    size,
+                    face,
+                    row - face * size,
+                    rowEnd - face * size,
+                    proj);
+                row = rowEnd;
+            }
+        });
+
+    util::sh::Projection proj;
+    projections.combine_each([&proj](const util::sh::Projection& p) { proj += p; });
+    return util::sh::toIrradiance(proj);
+}
+
+util::sh::Coefficients ShProjector::projectGpu(const vkapi::TextureHandle& handle)
+{
+    auto& driver = engine_.driver();
+    vkapi::Texture* texture = driver.getTexture(handle);
+    ASSERT_FATAL(texture->context().faceCount == 6, "Only cube maps can be projected.");
+
+    if (!compute_)
+    {
+        auto shaderCode = vkapi::ShaderProgramBundle::loadShader("sh_project.comp");
+        ASSERT_FATAL(!shaderCode.empty(), "Error loading sh projection compute shader.");
+        compute_ = std::make_unique<Compute>(engine_, shaderCode);
+
+        compute_->addSsbo(
+            "partials",
+            backend::BufferElementType::Float4,
+            StorageBuffer::AccessType::ReadWrite,
+            0,
+            "partial_ssbo",
+            nullptr,
+            GroupCount * util::sh::CoeffCount);
+        compute_->addPushConstantParam("lod", backend::BufferElementType::Float);
+    }
+
+    compute_->addImageSampler(
+        driver,
+        "EnvMap",
+        handle,
+        0,
+        {backend::SamplerFilter::Linear,
+         backend::SamplerFilter::Linear,
+         backend::SamplerAddressMode::ClampToEdge},
+        SamplerSet::SamplerType::Cube);
+    if (!bundle_)
+    {
+        bundle_ = compute_->build(engine_);
+    }
+
+    float lod = static_cast<float>(getProjectionLevel(*texture));
+    compute_->updatePushConstantParam("lod", &lod);
+    compute_->updateGpuPush();
+
+    auto& cmdBuffer = driver.getCommands().getCmdBuffer().cmdBuffer;
+    // the partial sums may still be being read by a previous projection
+    vkapi::VkContext::writeReadComputeBarrier(cmdBuffer);
+    driver.dispatchCompute(
+        cmdBuffer, bundle_, ProjectionSize / GroupDim, ProjectionSize / GroupDim, 6);
+
+    std::vector<float> partials(GroupCount * util::sh::CoeffCount * 4);
+    compute_->downloadSsboData(engine_, 0, partials.data());
+
+    // rgb holds the projected radiance of each coefficient and w the sum of
+    // the weights of the workgroup
+    util::sh::Projection proj;
+    for (uint32_t group = 0; group < GroupCount; ++group)
+    {
+        const float* sums = partials.data() + group * util::sh::CoeffCount * 4;
+        for (uint32_t i = 0; i < util::sh::CoeffCount; ++i)
+        {
+            proj.r[i] += sums[i * 4];
+            proj.g[i] += sums[i * 4 + 1];
+            proj.b[i] += sums[i * 4 + 2];
+        }
+        proj.weight += sums[3];
+    }
+    return util::sh::toIrradiance(proj);
+}
+
+} // namespace yave
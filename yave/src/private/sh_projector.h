@@ -0,0 +1,83 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <utility/spherical_harmonics.h>
+#include <vulkan-api/common.h>
+#include <vulkan-api/driver.h>
+
+#include <memory>
+
+namespace yave
+{
+class IEngine;
+class Compute;
+
+/**
+ * @brief Projects an environment cube map onto the L2 spherical harmonic basis
+ * to give the diffuse irradiance as nine coefficients - a substitute for the
+ * irradiance cube map which is cheap enough to regenerate as the sky changes.
+ * The projection is carried out on a face size of ProjectionSize, using the
+ * nearest mip level of the cube map, as the basis only holds low frequencies.
+ */
+class ShProjector
+{
+public:
+    static constexpr uint32_t ProjectionSize = 64;
+    // the workgroup dimensions of sh_project.comp
+    static constexpr uint32_t GroupDim = 8;
+
+    explicit ShProjector(IEngine& engine);
+    ~ShProjector();
+
+    ShProjector(const ShProjector&) = delete;
+    ShProjector& operator=(const ShProjector&) = delete;
+
+    /**
+     * @brief Downloads the cube map and projects it on the cpu, with the rows
+     * of each face split across threads. The texture must be an RGBA float or
+     * half float format. Blocks until the download has completed.
+     */
+    util::sh::Coefficients projectCpu(const vkapi::TextureHandle& handle);
+
+    /**
+     * @brief Projects the cube map with a compute dispatch - only the partial
+     * sums of each workgroup are read back. Blocks until the dispatch has
+     * completed.
+     */
+    util::sh::Coefficients projectGpu(const vkapi::TextureHandle& handle);
+
+private:
+    // the level of the cube map closest to the projection size
+    static uint32_t getProjectionLevel(const vkapi::Texture& texture) noexcept;
+
+private:
+    IEngine& engine_;
+
+    std::unique_ptr<Compute> compute_;
+    // set once the shader has been built
+    vkapi::ShaderProgramBundle* bundle_;
+};
+
+} // namespace yave
@@ -0,0 +1,155 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "specular_filter.h"
+
+#include "compute.h"
+#include "engine.h"
+#include "utility/assertion.h"
+
+#include <vulkan-api/image.h>
+#include <vulkan-api/program_manager.h>
+#include <vulkan-api/texture.h>
+
+#include <algorithm>
+#include <string>
+
+namespace yave
+{
+
+SpecularFilter::SpecularFilter(IEngine& engine) : engine_(engine) {}
+SpecularFilter::~SpecularFilter() = default;
+
+SpecularFilter::Program& SpecularFilter::getProgram(vk::Format format)
+{
+    auto iter = programs_.find(format);
+    if (iter != programs_.end())
+    {
+        return iter->second;
+    }
+
+    auto shaderCode = vkapi::ShaderProgramBundle::loadShader("specular_prefilter.comp");
+    ASSERT_FATAL(!shaderCode.empty(), "Error loading specular pre-filter compute shader.");
+    auto compute = std::make_unique<Compute>(engine_, shaderCode);
+
+    compute->addPushConstantParam("size", backend::BufferElementType::Int);
+    compute->addPushConstantParam("levelCount", backend::BufferElementType::Int);
+    compute->addPushConstantParam("sampleCount", backend::BufferElementType::Int);
+
+    return programs_.emplace(format, Program {std::move(compute)}).first->second;
+}
+
+void SpecularFilter::filter(
+    vk::CommandBuffer cmdBuffer,
+    const vkapi::TextureHandle& envMap,
+    const vkapi::TextureHandle& dst,
+    uint32_t sampleCount)
+{
+    auto& driver = engine_.driver();
+    vkapi::Texture* texture = driver.getTexture(dst);
+    const vkapi::TextureContext& params = texture->context();
+    ASSERT_FATAL(
+        params.faceCount == 6 && driver.getTexture(envMap)->context().faceCount == 6,
+        "The environment and specular maps must be cube maps.");
+    ASSERT_FATAL(
+        (texture->getUsageFlags() & vk::ImageUsageFlagBits::eStorage) &&
+            driver.isStorageFormatSupported(params.format),
+        "The specular map must be created with storage usage and a storage format.");
+
+    Program& program = getProgram(params.format);
+    Compute* compute = program.compute.get();
+
+    compute->addImageSampler(
+        driver,
+        "EnvMap",
+        envMap,
+        0,
+        {backend::SamplerFilter::Linear,
+         backend::SamplerFilter::Linear,
+         backend::SamplerAddressMode::ClampToEdge},
+        SamplerSet::SamplerType::Cube);
+
+    // unused levels are bound to the last level - the shader doesn't write
+    // to levels beyond the level count
+    const uint32_t lastLevel = params.mipLevels - 1;
+    for (uint32_t level = 0; level < static_cast<uint32_t>(vkapi::Texture::MaxMipCount); ++level)
+    {
+        compute->addStorageImage(
+            "DstLevel" + std::to_string(level),
+            dst,
+            level,
+            ImageStorageSet::StorageType::WriteOnly,
+            ImageStorageSet::SamplerType::e2dArray,
+            std::min(level, lastLevel));
+    }
+    if (!program.bundle)
+    {
+        program.bundle = compute->build(engine_);
+    }
+
+    int size = static_cast<int>(params.width);
+    int levelCount = static_cast<int>(params.mipLevels);
+    int samples = static_cast<int>(sampleCount);
+    compute->updatePushConstantParam("size", &size);
+    compute->updatePushConstantParam("levelCount", &levelCount);
+    compute->updatePushConstantParam("sampleCount", &samples);
+    compute->updateGpuPush();
+
+    // the workgroups of every level are dispatched together
+    uint32_t groupCount = 0;
+    for (uint32_t level = 0; level < params.mipLevels; ++level)
+    {
+        const uint32_t levelSize = std::max(params.width >> level, 1u);
+        const uint32_t tileCount = (levelSize + GroupDim - 1) / GroupDim;
+        groupCount += tileCount * tileCount;
+    }
+
+    // the environment map may have just been rendered and its levels generated
+    vkapi::VkContext::GlobalBarrier(
+        cmdBuffer,
+        vk::PipelineStageFlagBits::eAllCommands,
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::AccessFlagBits::eMemoryWrite,
+        vk::AccessFlagBits::eShaderRead);
+
+    const vk::ImageLayout layout = texture->getImageLayout();
+    vkapi::Image::transition(
+        *texture->getImage(),
+        layout,
+        vk::ImageLayout::eGeneral,
+        cmdBuffer,
+        vk::PipelineStageFlagBits::eAllCommands,
+        vk::PipelineStageFlagBits::eComputeShader);
+
+    driver.dispatchCompute(cmdBuffer, program.bundle, groupCount, 1, 6);
+
+    vkapi::Image::transition(
+        *texture->getImage(),
+        vk::ImageLayout::eGeneral,
+        layout,
+        cmdBuffer,
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader);
+}
+
+} // namespace yave
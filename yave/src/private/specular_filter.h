@@ -0,0 +1,88 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <vulkan-api/common.h>
+#include <vulkan-api/driver.h>
+
+#include <memory>
+#include <unordered_map>
+
+namespace yave
+{
+class IEngine;
+class Compute;
+
+/**
+ * @brief Pre-filters an environment cube map into the mip levels of a specular
+ * cube map with GGX importance sampling (see specular_prefilter.comp). All
+ * faces and levels are filtered with a single dispatch, so the environment can
+ * be re-filtered at runtime as it changes.
+ */
+class SpecularFilter
+{
+public:
+    // the workgroup dimensions of specular_prefilter.comp
+    static constexpr uint32_t GroupDim = 8;
+
+    explicit SpecularFilter(IEngine& engine);
+    ~SpecularFilter();
+
+    SpecularFilter(const SpecularFilter&) = delete;
+    SpecularFilter& operator=(const SpecularFilter&) = delete;
+
+    /**
+     * @brief Records the filtering of the environment map into all levels of
+     * dst. The environment map should have a full mip chain, as the samples
+     * read from the level matching their footprint.
+     * @param dst A cube map created with storage usage - the roughness of each
+     * level increases linearly from zero at the first level to one at the last.
+     * @param sampleCount The number of samples for a roughness of one - this is
+     * scaled down with the roughness of each level.
+     */
+    void filter(
+        vk::CommandBuffer cmdBuffer,
+        const vkapi::TextureHandle& envMap,
+        const vkapi::TextureHandle& dst,
+        uint32_t sampleCount);
+
+private:
+    struct Program
+    {
+        std::unique_ptr<Compute> compute;
+        // set once the shader has been built
+        vkapi::ShaderProgramBundle* bundle = nullptr;
+    };
+
+    Program& getProgram(vk::Format format);
+
+private:
+    IEngine& engine_;
+
+    // the storage image format layout is declared in the shader, so a
+    // variant is required for each format
+    std::unordered_map<vk::Format, Program> programs_;
+};
+
+} // namespace yave
@@ -0,0 +1,333 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "texture_streamer.h"
+
+#include "backend/convert_to_vk.h"
+#include "engine.h"
+#include "mapped_texture.h"
+#include "utility/assertion.h"
+#include "vulkan-api/texture.h"
+
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace yave
+{
+
+TextureStreamer::TextureStreamer(IEngine& engine)
+    : engine_(engine), residentSize_(0), pendingSize_(0), lastUpdateFrame_(UINT64_MAX)
+{
+}
+
+TextureStreamer::~TextureStreamer() { shutDown(); }
+
+void TextureStreamer::shutDown() noexcept { loads_.wait(); }
+
+uint32_t TextureStreamer::getRequiredLevel(uint32_t textureSize, float pixels, float bias) noexcept
+{
+    if (!(pixels > 0.0f))
+    {
+        return UINT32_MAX;
+    }
+    float level = std::log2(static_cast<float>(textureSize) / pixels) + bias;
+    return level <= 0.0f ? 0 : static_cast<uint32_t>(level);
+}
+
+uint32_t TextureStreamer::getTailLevel(
+    uint32_t width, uint32_t height, uint32_t levels, uint32_t tailSize) noexcept
+{
+    uint32_t level = 0;
+    while (level + 1 < levels && std::max(width >> level, height >> level) > tailSize)
+    {
+        ++level;
+    }
+    return level;
+}
+
+size_t TextureStreamer::getSize(const Stream& stream, uint32_t first, uint32_t last) noexcept
+{
+    size_t size = 0;
+    for (uint32_t level = first; level < last; ++level)
+    {
+        size += stream.levelSizes[level];
+    }
+    return size;
+}
+
+std::vector<size_t>
+TextureStreamer::getOffsets(const Stream& stream, uint32_t first, uint32_t last) noexcept
+{
+    const uint32_t faceCount = stream.texture->getFaceCount();
+    const uint32_t levelCount = last - first;
+
+    std::vector<size_t> offsets(faceCount * levelCount);
+    size_t levelOffset = 0;
+    for (uint32_t idx = 0; idx < levelCount; ++idx)
+    {
+        const size_t faceSize = stream.levelSizes[first + idx] / faceCount;
+        for (uint32_t face = 0; face < faceCount; ++face)
+        {
+            offsets[face * levelCount + idx] = levelOffset + face * faceSize;
+        }
+        levelOffset += stream.levelSizes[first + idx];
+    }
+    return offsets;
+}
+
+vkapi::TextureHandle
+TextureStreamer::add(IMappedTexture& texture, const Texture::StreamParams& params)
+{
+    auto& driver = engine_.driver();
+    const Texture::Params& texParams = params.params;
+
+    auto stream = std::make_unique<Stream>();
+    stream->texture = &texture;
+    stream->levelSizes = params.levelSizes;
+    stream->fillFunc = params.fillFunc;
+    stream->tailLevel = options_.enabled ? getTailLevel(
+                                               texParams.width,
+                                               texParams.height,
+                                               texParams.levels,
+                                               options_.mipTailSize)
+                                         : 0;
+    stream->residentLevel = stream->tailLevel;
+    stream->requestedLevel = stream->tailLevel;
+
+    // the image is copied from when levels are added or removed so requires
+    // the src usage
+    const uint32_t tailLevel = stream->tailLevel;
+    vkapi::TextureHandle handle = driver.createTexture2d(
+        backend::textureFormatToVk(texParams.format),
+        std::max(texParams.width >> tailLevel, 1u),
+        std::max(texParams.height >> tailLevel, 1u),
+        static_cast<uint8_t>(texParams.levels - tailLevel),
+        static_cast<uint8_t>(texParams.faces),
+        1,
+        backend::imageUsageToVk(texParams.usageFlags | backend::ImageUsage::Src));
+
+    // the levels of the tail are filled in parallel, straight into the stage
+    std::vector<vkapi::TextureUpload> uploads(1);
+    uploads[0].handle = handle;
+    uploads[0].dataSize = static_cast<uint32_t>(getSize(*stream, tailLevel, texParams.levels));
+    uploads[0].offsets = getOffsets(*stream, tailLevel, texParams.levels);
+
+    vkapi::StagingPool::StageInfo* stage = driver.beginTextureUploads(uploads);
+    auto* stageData =
+        static_cast<uint8_t*>(stage->allocInfo.pMappedData) + uploads[0].stageOffset;
+    const std::vector<size_t>& offsets = uploads[0].offsets;
+    tbb::parallel_for(tailLevel, texParams.levels, [&](uint32_t level) {
+        // the offset of the first face is the start of the level
+        stream->fillFunc(level, stageData + offsets[level - tailLevel]);
+    });
+    driver.endTextureUploads(stage, uploads);
+
+    // the view switches to the new image as levels are added or evicted
+    driver.getTexture(handle)->createSampledView(driver);
+
+    streams_.emplace(&texture, std::move(stream));
+    return handle;
+}
+
+void TextureStreamer::remove(IMappedTexture& texture)
+{
+    auto iter = streams_.find(&texture);
+    if (iter == streams_.end())
+    {
+        return;
+    }
+
+    Stream& stream = *iter->second;
+    if (stream.load)
+    {
+        // the load task references the stream
+        loads_.wait();
+        pendingSize_ -= stream.load->data.size();
+    }
+    residentSize_ -= getSize(stream, stream.residentLevel, stream.tailLevel);
+    streams_.erase(iter);
+}
+
+void TextureStreamer::request(IMappedTexture* texture, uint32_t level) noexcept
+{
+    auto iter = streams_.find(texture);
+    if (iter == streams_.end())
+    {
+        return;
+    }
+    Stream& stream = *iter->second;
+    stream.requestedLevel = std::min(stream.requestedLevel, level);
+    stream.lastUsedFrame = engine_.driver().getCurrentFrame();
+}
+
+void TextureStreamer::update()
+{
+    const uint64_t frame = engine_.driver().getCurrentFrame();
+    if (frame == lastUpdateFrame_)
+    {
+        return;
+    }
+    lastUpdateFrame_ = frame;
+
+    // add the levels which have finished loading
+    for (auto& [texture, stream] : streams_)
+    {
+        if (stream->load && stream->load->ready.load(std::memory_order_acquire))
+        {
+            std::unique_ptr<Load> load = std::move(stream->load);
+            pendingSize_ -= load->data.size();
+            setResidentLevel(*stream, load->level, load->data.data());
+        }
+    }
+
+    if (residentSize_ > options_.budget)
+    {
+        evict(residentSize_ - options_.budget);
+    }
+
+    // the levels are loaded one at a time so the detail increases gradually,
+    // starting with the textures furthest from the level they require
+    std::vector<Stream*> requests;
+    for (auto& [texture, stream] : streams_)
+    {
+        if (!stream->load && stream->requestedLevel < stream->residentLevel)
+        {
+            requests.emplace_back(stream.get());
+        }
+    }
+    std::sort(requests.begin(), requests.end(), [](const Stream* lhs, const Stream* rhs) {
+        return lhs->residentLevel - lhs->requestedLevel > rhs->residentLevel - rhs->requestedLevel;
+    });
+
+    for (Stream* stream : requests)
+    {
+        const uint32_t level = stream->residentLevel - 1;
+        const size_t size = stream->levelSizes[level];
+        if (pendingSize_ > 0 && pendingSize_ + size > options_.maxPendingSize)
+        {
+            break;
+        }
+        const size_t required = residentSize_ + pendingSize_ + size;
+        if (required > options_.budget)
+        {
+            const size_t overBudget = required - options_.budget;
+            if (evict(overBudget) < overBudget)
+            {
+                continue;
+            }
+        }
+
+        auto load = std::make_unique<Load>();
+        load->level = level;
+        load->data.resize(size);
+        pendingSize_ += size;
+
+        Load* loadPtr = load.get();
+        stream->load = std::move(load);
+        loads_.run([stream, loadPtr]() {
+            stream->fillFunc(loadPtr->level, loadPtr->data.data());
+            loadPtr->ready.store(true, std::memory_order_release);
+        });
+    }
+
+    // the requests are gathered again next frame
+    for (auto& [texture, stream] : streams_)
+    {
+        stream->requestedLevel = stream->tailLevel;
+    }
+}
+
+size_t TextureStreamer::evict(size_t size)
+{
+    // only the levels finer than those last requested can be evicted - for
+    // textures not drawn this frame, this is everything above the tail
+    std::vector<Stream*> candidates;
+    for (auto& [texture, stream] : streams_)
+    {
+        if (!stream->load && stream->residentLevel < stream->requestedLevel)
+        {
+            candidates.emplace_back(stream.get());
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Stream* lhs, const Stream* rhs) {
+        return lhs->lastUsedFrame < rhs->lastUsedFrame;
+    });
+
+    size_t freed = 0;
+    for (Stream* stream : candidates)
+    {
+        if (freed >= size)
+        {
+            break;
+        }
+        uint32_t level = stream->residentLevel;
+        while (level < stream->requestedLevel && freed < size)
+        {
+            freed += stream->levelSizes[level++];
+        }
+        setResidentLevel(*stream, level, nullptr);
+    }
+    return freed;
+}
+
+void TextureStreamer::setResidentLevel(Stream& stream, uint32_t level, const uint8_t* data)
+{
+    if (level == stream.residentLevel)
+    {
+        return;
+    }
+
+    auto& driver = engine_.driver();
+    IMappedTexture* texture = stream.texture;
+    const uint32_t width = std::max(static_cast<uint32_t>(texture->getWidth()) >> level, 1u);
+    const uint32_t height = std::max(static_cast<uint32_t>(texture->getHeight()) >> level, 1u);
+    const uint32_t levelCount = texture->getMipLevels() - level;
+
+    if (level < stream.residentLevel)
+    {
+        ASSERT_LOG(data);
+        const size_t size = getSize(stream, level, stream.residentLevel);
+        vkapi::StagingPool::StageInfo* stage =
+            driver.stagingPool().getStage(size, driver.getCurrentFrame());
+        memcpy(stage->allocInfo.pMappedData, data, size);
+
+        driver.reallocateTexture(
+            texture->getBackendHandle(),
+            width,
+            height,
+            levelCount,
+            stage,
+            getOffsets(stream, level, stream.residentLevel));
+        residentSize_ += size;
+    }
+    else
+    {
+        driver.reallocateTexture(texture->getBackendHandle(), width, height, levelCount);
+        residentSize_ -= getSize(stream, stream.residentLevel, level);
+    }
+    stream.residentLevel = level;
+}
+
+} // namespace yave
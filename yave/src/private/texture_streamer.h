@@ -0,0 +1,159 @@
+/* Copyright (c) 2022 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "yave/options.h"
+#include "yave/texture.h"
+
+#include <tbb/task_group.h>
+#include <vulkan-api/driver.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace yave
+{
+class IEngine;
+class IMappedTexture;
+
+/**
+ * @brief Manages the mip levels of streamed textures. Only the mip tail of a
+ * texture is loaded up front; the larger levels are requested by the scene
+ * from the screen space size of the renderables using the texture, and are
+ * loaded on worker threads. Once loaded, the image is re-created with the new
+ * levels - the levels already resident are copied on the gpu and the sampled
+ * view switched to the new image. When over the budget, the levels of the least
+ * recently used textures are evicted by re-creating the image without them.
+ */
+class TextureStreamer
+{
+public:
+    explicit TextureStreamer(IEngine& engine);
+    ~TextureStreamer();
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    // Creates the backend texture with only the mip tail resident, or all
+    // levels if streaming is disabled.
+    vkapi::TextureHandle add(IMappedTexture& texture, const Texture::StreamParams& params);
+
+    void remove(IMappedTexture& texture);
+
+    // Records that the texture is visible this frame at a size requiring the
+    // mip level - the finest level requested during a frame is used.
+    void request(IMappedTexture* texture, uint32_t level) noexcept;
+
+    /**
+     * @brief Uploads the levels which have finished loading, evicts levels if
+     * over budget and starts loading the levels requested this frame. Must be
+     * called outside of a renderpass - only the first call per frame has any
+     * effect.
+     */
+    void update();
+
+    // waits for any loads in progress
+    void shutDown() noexcept;
+
+    /**
+     * @brief The mip level required to draw a texture of the specified size
+     * over a number of pixels, assuming the uvs span the object once. The
+     * level is not clamped to the levels of the texture.
+     */
+    static uint32_t getRequiredLevel(uint32_t textureSize, float pixels, float bias) noexcept;
+
+    // the first level of the tail - the levels no larger than the tail size.
+    static uint32_t
+    getTailLevel(uint32_t width, uint32_t height, uint32_t levels, uint32_t tailSize) noexcept;
+
+    [[nodiscard]] bool isStreamed(IMappedTexture* texture) const noexcept
+    {
+        return streams_.find(texture) != streams_.end();
+    }
+
+    void setOptions(const StreamingOptions& options) noexcept { options_ = options; }
+    StreamingOptions& getOptions() noexcept { return options_; }
+
+    [[nodiscard]] size_t getResidentSize() const noexcept { return residentSize_; }
+
+private:
+    struct Load
+    {
+        // the new top level - the levels from here to the resident level are
+        // loaded, tightly packed
+        uint32_t level = 0;
+        std::vector<uint8_t> data;
+        std::atomic<bool> ready {false};
+    };
+
+    struct Stream
+    {
+        IMappedTexture* texture = nullptr;
+        std::vector<size_t> levelSizes;
+        std::function<void(uint32_t, void*)> fillFunc;
+        // the levels from the tail level onwards are always resident
+        uint32_t tailLevel = 0;
+        uint32_t residentLevel = 0;
+        // the finest level requested this frame
+        uint32_t requestedLevel = 0;
+        uint64_t lastUsedFrame = 0;
+        std::unique_ptr<Load> load;
+    };
+
+    // Re-creates the image with the levels from the specified level resident.
+    // If levels are added, the data holds the new levels tightly packed.
+    void setResidentLevel(Stream& stream, uint32_t level, const uint8_t* data);
+
+    // Drops levels of the least recently used textures, down to the level they
+    // were last requested at, until at least the specified size is freed.
+    size_t evict(size_t size);
+
+    // the size of the levels in the range [first, last)
+    static size_t getSize(const Stream& stream, uint32_t first, uint32_t last) noexcept;
+
+    // The offset of each face of the levels [first, last) when tightly packed,
+    // indexed by face * levelCount + level.
+    static std::vector<size_t>
+    getOffsets(const Stream& stream, uint32_t first, uint32_t last) noexcept;
+
+private:
+    IEngine& engine_;
+
+    StreamingOptions options_;
+
+    std::unordered_map<IMappedTexture*, std::unique_ptr<Stream>> streams_;
+
+    // the size of the streamed levels resident, excluding the mip tails
+    size_t residentSize_;
+    // the size of the levels which are being loaded
+    size_t pendingSize_;
+
+    uint64_t lastUpdateFrame_;
+
+    tbb::task_group loads_;
+};
+
+} // namespace yave
@@ -24,6 +24,8 @@
 
 #include "engine.h"
 
+#include <spdlog/spdlog.h>
+
 namespace yave
 {
 
@@ -89,6 +91,44 @@ auto IVertexBuffer::attributeToWidthFormat(backend::BufferElementType attr)
             format = vk::Format::eR32G32B32A32Sfloat;
             break;
         }
+        case backend::BufferElementType::Half2: {
+            width = 4;
+            format = vk::Format::eR16G16Sfloat;
+            break;
+        }
+        case backend::BufferElementType::Snorm16x2: {
+            width = 4;
+            format = vk::Format::eR16G16Snorm;
+            break;
+        }
+        case backend::BufferElementType::Unorm16x2: {
+            width = 4;
+            format = vk::Format::eR16G16Unorm;
+            break;
+        }
+        case backend::BufferElementType::Unorm16x4: {
+            width = 8;
+            format = vk::Format::eR16G16B16A16Unorm;
+            break;
+        }
+        case backend::BufferElementType::Unorm8x4: {
+            width = 4;
+            format = vk::Format::eR8G8B8A8Unorm;
+            break;
+        }
+        case backend::BufferElementType::Uint8x4: {
+            width = 4;
+            format = vk::Format::eR8G8B8A8Uint;
+            break;
+        }
+        case backend::BufferElementType::Uint16x4: {
+            width = 8;
+            format = vk::Format::eR16G16B16A16Uint;
+            break;
+        }
+        default:
+            SPDLOG_CRITICAL("Unsupported vertex attribute type.");
+            break;
     }
 
     return std::make_tuple(width, format);
@@ -107,6 +147,18 @@ void IVertexBuffer::addAttribute(uint32_t binding, backend::BufferElementType ty
     attributes_[binding] = {binding, 0, format, width};
 }
 
+vk::Format IVertexBuffer::getAttributeFormat(VertexBuffer::BindingType type) const noexcept
+{
+    return attributes_[static_cast<uint32_t>(type)].format;
+}
+
+void IVertexBuffer::setPositionDequantisation(
+    const mathfu::vec3& offset, const mathfu::vec3& scale) noexcept
+{
+    positionOffset_ = mathfu::vec4 {offset, 0.0f};
+    positionScale_ = mathfu::vec4 {scale, 0.0f};
+}
+
 util::BitSetEnum<VertexBuffer::BindingType> IVertexBuffer::getAtrributeBits() const noexcept
 {
     util::BitSetEnum<VertexBuffer::BindingType> attrBits;
@@ -133,6 +185,20 @@ void IVertexBuffer::build(vkapi::VkDriver& driver, uint32_t vertexCount, void* v
         return;
     }
 
+    uint32_t stride = prepareAttributes();
+    vHandle_ = driver.addVertexBuffer(vertexCount, vertexData, stride);
+}
+
+void IVertexBuffer::build(
+    vkapi::VkDriver& driver, uint32_t vertexSize, const vkapi::GeometryFillFunc& fillFunc)
+{
+    ASSERT_FATAL(!vHandle_, "The vertex buffer has already been built.");
+    uint32_t stride = prepareAttributes();
+    vHandle_ = driver.addVertexBuffer(vertexSize, stride, fillFunc);
+}
+
+uint32_t IVertexBuffer::prepareAttributes()
+{
     // sort out the attribute stride and offsets
     uint32_t stride = 0;
     for (size_t idx = 0; idx < vkapi::PipelineCache::MaxVertexAttributeCount; ++idx)
@@ -157,12 +223,7 @@ void IVertexBuffer::build(vkapi::VkDriver& driver, uint32_t vertexCount, void* v
 
     // only supporting a single binding descriptor at present
     bindDesc_[0] = {0, stride, vk::VertexInputRate::eVertex};
-    vHandle_ = driver.addVertexBuffer(vertexCount, vertexData);
-}
-
-vkapi::VertexBuffer* IVertexBuffer::getGpuBuffer(vkapi::VkDriver& driver) noexcept
-{
-    return driver.getVertexBuffer(vHandle_);
+    return stride;
 }
 
 } // namespace yave
\ No newline at end of file
@@ -24,6 +24,7 @@
 
 #include "yave/vertex_buffer.h"
 
+#include <mathfu/glsl_mappings.h>
 #include <vulkan-api/driver.h>
 
 namespace yave
@@ -43,18 +44,37 @@ public:
 
     void build(vkapi::VkDriver& driver, uint32_t vertexCount, void* vertexData);
 
+    void build(
+        vkapi::VkDriver& driver, uint32_t vertexSize, const vkapi::GeometryFillFunc& fillFunc);
+
     vk::VertexInputAttributeDescription* getInputAttr() noexcept { return attributes_; }
 
     vk::VertexInputBindingDescription* getInputBind() noexcept { return bindDesc_; }
 
     [[nodiscard]] util::BitSetEnum<VertexBuffer::BindingType> getAtrributeBits() const noexcept;
 
-    vkapi::VertexBuffer* getGpuBuffer(vkapi::VkDriver& driver) noexcept;
+    [[nodiscard]] vk::Format getAttributeFormat(VertexBuffer::BindingType type) const noexcept;
+
+    void setPositionDequantisation(const mathfu::vec3& offset, const mathfu::vec3& scale) noexcept;
+
+    [[nodiscard]] const mathfu::vec4& getPositionOffset() const noexcept { return positionOffset_; }
+    [[nodiscard]] const mathfu::vec4& getPositionScale() const noexcept { return positionScale_; }
+
+    [[nodiscard]] const vkapi::VertexBufferHandle& getHandle() const noexcept { return vHandle_; }
+
+private:
+    // converts the attribute widths into offsets and sets up the binding
+    // description. Returns the vertex stride.
+    uint32_t prepareAttributes();
 
 private:
     vk::VertexInputAttributeDescription attributes_[vkapi::PipelineCache::MaxVertexAttributeCount];
     vk::VertexInputBindingDescription bindDesc_[vkapi::PipelineCache::MaxVertexAttributeCount];
     vkapi::VertexBufferHandle vHandle_;
+
+    // used by the shader to convert quantised positions to model space
+    mathfu::vec4 positionOffset_ = mathfu::vec4 {0.0f};
+    mathfu::vec4 positionScale_ = mathfu::vec4 {1.0f};
 };
 
 } // namespace yave
\ No newline at end of file
@@ -22,153 +22,172 @@
 
 #include "wave_generator.h"
 
+#include "camera.h"
 #include "compute.h"
 #include "engine.h"
+#include "frustum.h"
 #include "index_buffer.h"
 #include "managers/renderable_manager.h"
 #include "mapped_texture.h"
 #include "object_manager.h"
 #include "renderable.h"
 #include "scene.h"
+#include "utility/assertion.h"
 #include "vertex_buffer.h"
 #include "yave/texture_sampler.h"
 
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
 #include <random>
+#include <string>
 
 namespace yave
 {
 
-IWaveGenerator::IWaveGenerator(IEngine& engine, IScene& scene)
-    : engine_(engine), log2N_(std::log(Resolution) / log(2)), pingpong_(0), updateSpectrum_(true)
+namespace
 {
-    auto initSpecShaderCode = vkapi::ShaderProgramBundle::loadShader("initial_spectrum.comp");
-    initialSpecCompute_ = std::make_unique<Compute>(engine, initSpecShaderCode);
 
-    auto specShaderCode = vkapi::ShaderProgramBundle::loadShader("fft_spectrum.comp");
-    specCompute_ = std::make_unique<Compute>(engine, specShaderCode);
+constexpr float Pi = 3.14159265358979f;
 
-    auto butterflyShaderCode = vkapi::ShaderProgramBundle::loadShader("fft_butterfly.comp");
-    butterflyCompute_ = std::make_unique<Compute>(engine, butterflyShaderCode);
+// The boundary between the wave number bands of two cascades, in multiples of
+// the fundamental wave number of the finer cascade - waves longer than a few
+// samples of its tile are left to the coarser cascade.
+constexpr float CascadeBoundaryFactor = 6.0f;
 
-    auto fftHorizShaderCode = vkapi::ShaderProgramBundle::loadShader("fft_horiz.comp");
-    fftHorizCompute_ = std::make_unique<Compute>(engine, fftHorizShaderCode);
+// the number of points sampled per task by a displacement query
+constexpr size_t QueryGrainSize = 256;
 
-    auto fftVertShaderCode = vkapi::ShaderProgramBundle::loadShader("fft_vert.comp");
-    fftVertCompute_ = std::make_unique<Compute>(engine, fftVertShaderCode);
+// the standard deviations of the height that the patch bounds are expanded by
+constexpr float CullMarginDeviations = 4.0f;
 
-    auto displaceShaderCode = vkapi::ShaderProgramBundle::loadShader("fft_displacement.comp");
-    displaceCompute_ = std::make_unique<Compute>(engine, displaceShaderCode);
+IMappedTexture*
+createMap(IEngine& engine, uint32_t size, Texture::TextureFormat format, uint32_t usageFlags)
+{
+    IMappedTexture* texture = engine.createMappedTexture();
+    texture->setEmptyTexture(size, size, format, usageFlags, 1, 1);
+    return texture;
+}
 
-    auto genmapShaderCode = vkapi::ShaderProgramBundle::loadShader("generate_maps.comp");
-    genMapCompute_ = std::make_unique<Compute>(engine, genmapShaderCode);
+} // namespace
 
-    auto reverse = [this](int idx) -> uint32_t {
-        uint32_t res = 0;
-        for (size_t i = 0; i < log2N_; ++i)
-        {
-            res = (res << 1) + (idx & 1);
-            idx >>= 1;
-        }
-        return res;
-    };
+util::ocean::SpectrumParams
+IWaveGenerator::getSpectrumParams(const Cascade& cascade, uint32_t size) const noexcept
+{
+    util::ocean::SpectrumParams params;
+    params.size = size;
+    params.patchSize = cascade.patchSize;
+    params.amplitude = options.A;
+    params.windSpeed = options.windSpeed;
+    params.windDirection[0] = options.windDirection.x;
+    params.windDirection[1] = options.windDirection.y;
+    params.minWaveNumber = cascade.minWaveNumber;
+    params.maxWaveNumber = cascade.maxWaveNumber;
+    return params;
+}
 
-    for (size_t index = 0; index < Resolution; ++index)
-    {
-        reversedBits_[index] = reverse(index);
-    }
+IWaveGenerator::IWaveGenerator(IEngine& engine, IScene& scene, const OceanOptions& oceanOptions)
+    : engine_(engine),
+      clipmapPatchSize_(oceanOptions.clipmapPatchSize),
+      gridOffset_(0.0f, 0.0f),
+      frustumPlanes_ {},
+      cullMargin_(0.0f),
+      resolution_(static_cast<int>(oceanOptions.resolution)),
+      dxOffset_(0),
+      dyOffset_(resolution_ * resolution_),
+      dzOffset_(dyOffset_ * 2),
+      dxyzBufferSize_(resolution_ * resolution_ * 3),
+      cascadeCount_(static_cast<int>(oceanOptions.cascadeCount)),
+      updateSpectrum_(true),
+      heightVariance_(0.0f),
+      queryTimes_ {0.0f, 0.0f},
+      queryFront_(0),
+      queryOffset_(0.0f),
+      frameTime_(0.0f),
+      queryPending_(false),
+      queryReady_(false)
+{
+    const uint32_t res = oceanOptions.resolution;
+    ASSERT_FATAL(
+        res >= MinResolution && res <= MaxResolution && (res & (res - 1)) == 0,
+        "The ocean resolution must be a power of two between %d and %d (resolution: %d).",
+        MinResolution,
+        MaxResolution,
+        res);
+    const uint32_t cascadeCount = oceanOptions.cascadeCount;
+    ASSERT_FATAL(
+        cascadeCount > 0 && cascadeCount <= OceanOptions::MaxCascadeCount,
+        "The ocean cascade count must be between 1 and %d (count: %d).",
+        OceanOptions::MaxCascadeCount,
+        cascadeCount);
 
     // generate gaussian noise for initial spectrum (h0k)
     std::random_device rd {};
     std::mt19937 gen {rd()};
     std::normal_distribution<float> d {0, 1};
 
-    for (int i = 0; i < Resolution; ++i)
+    cascades_.resize(cascadeCount);
+    for (uint32_t idx = 0; idx < cascadeCount; ++idx)
     {
-        for (int j = 0; j < Resolution * 4; j += 4)
+        Cascade& cascade = cascades_[idx];
+        cascade.patchSize = oceanOptions.patchSizes[idx];
+        ASSERT_FATAL(
+            cascade.patchSize > 0.0f &&
+                (idx == 0 || cascade.patchSize < cascades_[idx - 1].patchSize),
+            "The cascade patch sizes must be in descending order.");
+
+        // the interval halves with each finer cascade
+        const uint32_t finerCount = cascadeCount - idx - 1;
+        cascade.updateInterval =
+            std::min(std::max(oceanOptions.coarsestUpdateInterval, 1u), 1u << finerCount);
+
+        cascade.noiseMap.resize(res * res * 4);
+        for (float& noise : cascade.noiseMap)
         {
-            int index = i * (Resolution * 4) + j;
-            noiseMap_[index] = d(gen);
-            noiseMap_[index + 1] = d(gen);
-            noiseMap_[index + 2] = d(gen);
-            noiseMap_[index + 3] = d(gen);
+            noise = d(gen);
         }
+        createCascade(cascade);
     }
-    noiseTexture_ = engine.createMappedTexture();
-    noiseTexture_->setTexture(
-        noiseMap_,
-        Resolution * Resolution * 4 * sizeof(float),
-        Resolution,
-        Resolution,
-        1,
-        1,
-        Texture::TextureFormat::RGBA32F,
-        backend::ImageUsage::Storage);
 
-    butterflyLut_ = engine.createMappedTexture();
-    butterflyLut_->setEmptyTexture(
-        log2N_, Resolution, Texture::TextureFormat::RGBA32F, backend::ImageUsage::Storage, 1, 1);
+    // split the spectrum into bands so the cascades don't add the same waves
+    // twice. The band of a cascade can't go beyond its nyquist wave number.
+    for (uint32_t idx = 0; idx < cascadeCount; ++idx)
+    {
+        Cascade& cascade = cascades_[idx];
+        cascade.minWaveNumber = idx == 0 ? 0.0f : cascades_[idx - 1].maxWaveNumber;
+        cascade.maxWaveNumber = std::numeric_limits<float>::max();
+        if (idx + 1 < cascadeCount)
+        {
+            const float nyquist = Pi * static_cast<float>(res) / cascade.patchSize;
+            const float boundary = 2.0f * Pi * CascadeBoundaryFactor / cascades_[idx + 1].patchSize;
+            cascade.maxWaveNumber = std::min(boundary, nyquist);
+        }
+    }
 
-    // output textures for h0k and h0-k
-    h0kTexture_ = engine.createMappedTexture();
-    h0minuskTexture_ = engine.createMappedTexture();
-    h0kTexture_->setEmptyTexture(
-        Resolution,
-        Resolution,
-        Texture::TextureFormat::RGBA32F,
-        backend::ImageUsage::Storage,
-        1,
-        1);
-    h0minuskTexture_->setEmptyTexture(
-        Resolution,
-        Resolution,
-        Texture::TextureFormat::RGBA32F,
-        backend::ImageUsage::Storage,
-        1,
-        1);
+    // the expected height of the surface, used to bound the displacement
+    const float scale = 1.0f / static_cast<float>(res * res);
+    for (const Cascade& cascade : cascades_)
+    {
+        heightVariance_ += util::ocean::heightVariance(getSpectrumParams(cascade, res), scale);
+    }
+    cullMargin_ = CullMarginDeviations * std::sqrt(heightVariance_) *
+        std::max(options.dispFactor, options.choppyFactor);
 
-    // displacement
-    fftOutputImage_ = engine_.createMappedTexture();
-    fftOutputImage_->setEmptyTexture(
-        Resolution,
-        Resolution,
-        Texture::TextureFormat::RG32F,
-        backend::ImageUsage::Storage | backend::ImageUsage::Sampled,
-        1,
-        1);
-    heightMap_ = engine_.createMappedTexture();
-    heightMap_->setEmptyTexture(
-        Resolution,
-        Resolution,
-        Texture::TextureFormat::R32F,
-        backend::ImageUsage::Storage | backend::ImageUsage::Sampled,
-        1,
-        1);
-    normalMap_ = engine_.createMappedTexture();
-    normalMap_->setEmptyTexture(
-        Resolution,
-        Resolution,
-        Texture::TextureFormat::RG32F,
-        backend::ImageUsage::Storage | backend::ImageUsage::Sampled,
-        1,
-        1);
+    initQueries(oceanOptions.queryResolution);
 
-    // map generation
-    displacementMap_ = engine_.createMappedTexture();
-    displacementMap_->setEmptyTexture(
-        Resolution,
-        Resolution,
-        Texture::TextureFormat::RGBA32F,
-        backend::ImageUsage::Storage | backend::ImageUsage::Sampled,
-        1,
-        1);
-    gradientMap_ = engine_.createMappedTexture();
-    gradientMap_->setEmptyTexture(
-        Resolution,
-        Resolution,
-        Texture::TextureFormat::RGBA32F,
-        backend::ImageUsage::Storage | backend::ImageUsage::Sampled,
-        1,
-        1);
+    // The gradients are in height per texel, so the finer cascades are scaled
+    // to the texel size of the coarsest. Unused cascades are given a unit
+    // patch size and are not sampled.
+    for (uint32_t idx = 0; idx < OceanOptions::MaxCascadeCount; ++idx)
+    {
+        const bool active = idx < cascadeCount;
+        patchSizes_[idx] = active ? cascades_[idx].patchSize : 1.0f;
+        gradientScales_[idx] = active ? cascades_[0].patchSize / cascades_[idx].patchSize : 0.0f;
+        blendWeights_[idx] = 1.0f;
+    }
 
     // create the material objects
     IRenderableManager* rm = engine_.getRenderableManager();
@@ -178,69 +197,168 @@ IWaveGenerator::IWaveGenerator(IEngine& engine, IScene& scene)
 
     material_ = rm->createMaterial();
 
-    // create the vertices for the tesselation patch
-    // NOTE: The patch size cannot be changed during runtime at present
-    generatePatch();
+    const uint32_t ringCount = oceanOptions.clipmapRingCount;
+    ASSERT_FATAL(
+        ringCount > 0 && ringCount <= MaxClipmapRingCount && clipmapPatchSize_ > 0.0f,
+        "The clipmap must have between 1 and %d rings (ring count: %d).",
+        MaxClipmapRingCount,
+        ringCount);
+    generateClipmap(clipmapPatchSize_, ringCount);
 
     buildMaterial(scene);
 }
 
-IWaveGenerator::~IWaveGenerator() = default;
+IWaveGenerator::~IWaveGenerator()
+{
+    // the worker may still be evaluating the mirror
+    queryTasks_.wait();
+}
 
-void IWaveGenerator::generatePatch() noexcept
+void IWaveGenerator::createCascade(Cascade& cascade)
 {
-    patchVertices.reserve(options.patchCount * options.patchCount * 5);
+    const uint32_t res = static_cast<uint32_t>(resolution_);
+
+    auto initSpecShaderCode = vkapi::ShaderProgramBundle::loadShader("initial_spectrum.comp");
+    cascade.initialSpecCompute = std::make_unique<Compute>(engine_, initSpecShaderCode);
+
+    auto specShaderCode = vkapi::ShaderProgramBundle::loadShader("fft_spectrum.comp");
+    cascade.specCompute = std::make_unique<Compute>(engine_, specShaderCode);
 
-    int patchCount = static_cast<int>(options.patchCount);
-    float width = 10.0f;
-    float height = 10.0f;
+    auto fftShaderCode = vkapi::ShaderProgramBundle::loadShader("fft.comp");
+    cascade.fftCompute = std::make_unique<Compute>(engine_, fftShaderCode);
 
-    // interleaved pos and uv data for tesselation patch
-    // Note: The y-axis for position is calculated from the height map on the tesselation shader
-    for (size_t y = 0; y < options.patchCount; ++y)
+    auto displaceShaderCode = vkapi::ShaderProgramBundle::loadShader("fft_displacement.comp");
+    cascade.displaceCompute = std::make_unique<Compute>(engine_, displaceShaderCode);
+
+    auto genmapShaderCode = vkapi::ShaderProgramBundle::loadShader("generate_maps.comp");
+    cascade.genMapCompute = std::make_unique<Compute>(engine_, genmapShaderCode);
+
+    cascade.noiseTexture = engine_.createMappedTexture();
+    cascade.noiseTexture->setTexture(
+        cascade.noiseMap.data(),
+        cascade.noiseMap.size() * sizeof(float),
+        res,
+        res,
+        1,
+        1,
+        Texture::TextureFormat::RGBA32F,
+        backend::ImageUsage::Storage);
+
+    // output textures for h0k and h0-k
+    cascade.h0kTexture =
+        createMap(engine_, res, Texture::TextureFormat::RGBA32F, backend::ImageUsage::Storage);
+    cascade.h0minuskTexture =
+        createMap(engine_, res, Texture::TextureFormat::RGBA32F, backend::ImageUsage::Storage);
+
+    const uint32_t usage = backend::ImageUsage::Storage | backend::ImageUsage::Sampled;
+
+    // displacement
+    cascade.fftOutputImage = createMap(engine_, res, Texture::TextureFormat::RG32F, usage);
+    cascade.heightMap = createMap(engine_, res, Texture::TextureFormat::R32F, usage);
+    cascade.normalMap = createMap(engine_, res, Texture::TextureFormat::RG32F, usage);
+
+    // map generation
+    for (uint32_t slot = 0; slot < 2; ++slot)
     {
-        for (size_t x = 0; x < options.patchCount; ++x)
-        {
-            patchVertices.push_back(
-                static_cast<float>(x) * width + width / 2.0f -
-                static_cast<float>(options.patchCount) * width / 2.0f);
-            patchVertices.push_back(0.0f);
-            patchVertices.push_back(
-                static_cast<float>(y) * height + height / 2.0f -
-                static_cast<float>(options.patchCount) * height / 2.0f);
-            patchVertices.push_back(
-                static_cast<float>(x) / static_cast<float>(options.patchCount - 1));
-            patchVertices.push_back(
-                static_cast<float>(y) / static_cast<float>(options.patchCount - 1));
-        }
+        cascade.displacementMaps[slot] =
+            createMap(engine_, res, Texture::TextureFormat::RGBA32F, usage);
+        cascade.gradientMaps[slot] =
+            createMap(engine_, res, Texture::TextureFormat::RGBA32F, usage);
     }
+}
+
+void IWaveGenerator::generateClipmap(float patchSize, uint32_t ringCount) noexcept
+{
+    const auto width = static_cast<int32_t>(ClipmapHalfWidth);
+    const int32_t innerWidth = width / 2;
 
-    // indices
-    const uint32_t w = (patchCount - 1);
-    patchIndices.resize(w * w * 4);
+    // the innermost ring is a full square - the others exclude the centre
+    const size_t patchCount = 4 * width * width + (ringCount - 1) * 3 * width * width;
+    patchVertices.reserve(patchCount * 4 * 5);
+    patchIndices.reserve(patchCount * 4);
 
-    for (uint32_t x = 0; x < w; ++x)
+    for (uint32_t ring = 0; ring < ringCount; ++ring)
     {
-        for (uint32_t y = 0; y < w; ++y)
+        const float size = patchSize * static_cast<float>(1u << ring);
+        const bool hasCoarserRing = ring + 1 < ringCount;
+
+        for (int32_t z = -width; z < width; ++z)
         {
-            uint32_t index = (x + y * w) * 4;
-            patchIndices[index] = (x + y * options.patchCount);
-            patchIndices[index + 1] = patchIndices[index] + options.patchCount;
-            patchIndices[index + 2] = patchIndices[index + 1] + 1;
-            patchIndices[index + 3] = patchIndices[index] + 1;
+            for (int32_t x = -width; x < width; ++x)
+            {
+                if (ring > 0 && x >= -innerWidth && x < innerWidth && z >= -innerWidth &&
+                    z < innerWidth)
+                {
+                    continue;
+                }
+
+                // the edges bordering the coarser ring, in the order of the
+                // outer tessellation levels
+                uint32_t edgeMask = 0;
+                if (hasCoarserRing)
+                {
+                    edgeMask |= z == -width ? 1 : 0;
+                    edgeMask |= x == -width ? 2 : 0;
+                    edgeMask |= z == width - 1 ? 4 : 0;
+                    edgeMask |= x == width - 1 ? 8 : 0;
+                }
+
+                const float x0 = static_cast<float>(x) * size;
+                const float z0 = static_cast<float>(z) * size;
+                const float corners[4][2] = {
+                    {x0, z0}, {x0, z0 + size}, {x0 + size, z0 + size}, {x0 + size, z0}};
+
+                // interleaved pos and uv data for tesselation patch
+                // Note: The y-axis for position is calculated from the height map on the
+                // tesselation shader
+                for (const auto& corner : corners)
+                {
+                    patchIndices.push_back(static_cast<uint32_t>(patchVertices.size() / 5));
+                    patchVertices.insert(
+                        patchVertices.end(),
+                        {corner[0],
+                         0.0f,
+                         corner[1],
+                         static_cast<float>(ring),
+                         static_cast<float>(edgeMask)});
+                }
+            }
         }
     }
 }
 
+void IWaveGenerator::updateClipmap(IScene& scene)
+{
+    ICamera* camera = scene.getCurrentCamera();
+    ASSERT_LOG(camera);
+
+    // The clipmap is moved in steps of the innermost patch so the vertices of
+    // the innermost ring stay at the same world positions.
+    const mathfu::vec3 pos = camera->position();
+    gridOffset_ = mathfu::vec2 {
+        std::round(pos.x / clipmapPatchSize_) * clipmapPatchSize_,
+        std::round(pos.z / clipmapPatchSize_) * clipmapPatchSize_};
+
+    Frustum frustum;
+    frustum.projection(camera->projMatrix() * camera->viewMatrix());
+    frustumPlanes_ = frustum.getPlanes();
+
+    material_->updateUboParam("gridOffset", backend::ShaderStage::Vertex, &gridOffset_);
+    material_->updateUboParam("gridOffset", backend::ShaderStage::TesselationCon, &gridOffset_);
+    material_->updateUboParam(
+        "frustumPlanes", backend::ShaderStage::TesselationCon, frustumPlanes_.data());
+}
+
 void IWaveGenerator::buildMaterial(IScene& scene)
 {
     auto& driver = engine_.driver();
     IRenderableManager* rm = engine_.getRenderableManager();
 
+    // the cascades are periodic so the maps are tiled over the patch
     TextureSampler sampler(
         backend::SamplerFilter::Linear,
         backend::SamplerFilter::Linear,
-        backend::SamplerAddressMode::ClampToEdge,
+        backend::SamplerAddressMode::Repeat,
         16);
 
     // tesselation evaluation shader
@@ -265,37 +383,99 @@ void IWaveGenerator::buildMaterial(IScene& scene)
         1,
         backend::ShaderStage::TesselationCon,
         &viewportDim);
+    material_->addUboParam(
+        "frustumPlanes",
+        backend::BufferElementType::Float4,
+        6,
+        backend::ShaderStage::TesselationCon,
+        frustumPlanes_.data());
+    material_->addUboParam(
+        "gridOffset",
+        backend::BufferElementType::Float2,
+        1,
+        backend::ShaderStage::TesselationCon,
+        &gridOffset_);
+    material_->addUboParam(
+        "maxTessLevel",
+        backend::BufferElementType::Float,
+        1,
+        backend::ShaderStage::TesselationCon,
+        &options.maxTessLevel);
+    material_->addUboParam(
+        "ringTessFalloff",
+        backend::BufferElementType::Float,
+        1,
+        backend::ShaderStage::TesselationCon,
+        &options.ringTessFalloff);
+    material_->addUboParam(
+        "clipmapPatchSize",
+        backend::BufferElementType::Float,
+        1,
+        backend::ShaderStage::TesselationCon,
+        &clipmapPatchSize_);
+    material_->addUboParam(
+        "cullMargin",
+        backend::BufferElementType::Float,
+        1,
+        backend::ShaderStage::TesselationCon,
+        &cullMargin_);
 
-    // tesselation control shader
-    material_->addImageTexture(
-        "DisplacementMap",
-        engine_.driver(),
-        displacementMap_->getBackendHandle(),
-        backend::ShaderStage::TesselationEval,
-        sampler.get(),
-        0);
+    // vertex shader
+    material_->addUboParam(
+        "gridOffset",
+        backend::BufferElementType::Float2,
+        1,
+        backend::ShaderStage::Vertex,
+        &gridOffset_);
+
+    // The maps of both slots of every cascade are bound. The bindings of
+    // unused cascades are filled with the maps of the first so the shader
+    // doesn't depend on the cascade count.
+    for (uint32_t idx = 0; idx < MaterialMapCount; ++idx)
+    {
+        const Cascade& cascade = cascades_[std::min<size_t>(idx / 2, cascades_.size() - 1)];
+        const uint32_t slot = idx & 1;
+
+        // tesselation control shader
+        material_->addImageTexture(
+            "DisplacementMap" + std::to_string(idx),
+            driver,
+            cascade.displacementMaps[slot]->getBackendHandle(),
+            backend::ShaderStage::TesselationEval,
+            sampler.get(),
+            idx);
+
+        // fragment shader
+        material_->addImageTexture(
+            "GradientMap" + std::to_string(idx),
+            driver,
+            cascade.gradientMaps[slot]->getBackendHandle(),
+            backend::ShaderStage::Fragment,
+            sampler.get(),
+            idx);
+    }
+
+    for (auto stage : {backend::ShaderStage::TesselationEval, backend::ShaderStage::Fragment})
+    {
+        material_->addUboParam(
+            "patchSizes", backend::BufferElementType::Float4, 1, stage, &patchSizes_);
+        material_->addUboParam(
+            "cascadeWeights", backend::BufferElementType::Float4, 1, stage, &blendWeights_);
+        material_->addUboParam(
+            "cascadeCount", backend::BufferElementType::Int, 1, stage, &cascadeCount_);
+    }
     material_->addUboParam(
         "dispFactor",
         backend::BufferElementType::Float,
         1,
         backend::ShaderStage::TesselationEval,
         &options.dispFactor);
-
-    // fragment shader
-    material_->addImageTexture(
-        "GradientMap",
-        engine_.driver(),
-        displacementMap_->getBackendHandle(),
-        backend::ShaderStage::Fragment,
-        sampler.get(),
-        0);
-    material_->addImageTexture(
-        "NormalMap",
-        engine_.driver(),
-        normalMap_->getBackendHandle(),
+    material_->addUboParam(
+        "gradientScales",
+        backend::BufferElementType::Float4,
+        1,
         backend::ShaderStage::Fragment,
-        sampler.get(),
-        1);
+        &gradientScales_);
 
     IRenderable* render = engine_.createRenderable();
     IVertexBuffer* vBuffer = engine_.createVertexBuffer();
@@ -327,11 +507,66 @@ void IWaveGenerator::buildMaterial(IScene& scene)
     rm->build(scene, render, waterObj_, {}, "water.glsl");
 }
 
+void IWaveGenerator::scheduleCascades(float time, float dt)
+{
+    for (size_t idx = 0; idx < cascades_.size(); ++idx)
+    {
+        Cascade& cascade = cascades_[idx];
+        cascade.updatePending = cascade.framesUntilUpdate == 0;
+
+        if (cascade.updatePending)
+        {
+            // the maps last written become the previous maps
+            cascade.nextSlot ^= 1;
+            cascade.framesUntilUpdate = cascade.updateInterval;
+
+            if (!cascade.hasUpdated)
+            {
+                // There is nothing to blend from on the first update, so the
+                // cascade is evaluated at the current time. The following
+                // updates are staggered so the coarser cascades don't all
+                // update on the same frame.
+                cascade.framesUntilUpdate += static_cast<uint32_t>(idx) % cascade.updateInterval;
+                cascade.prevTime = time;
+                cascade.nextTime = time;
+                cascade.hasUpdated = true;
+            }
+            else
+            {
+                // evaluate the maps at the time of the next update, so that
+                // the cascade can be interpolated up until then
+                cascade.prevTime = cascade.nextTime;
+                cascade.nextTime = time + static_cast<float>(cascade.framesUntilUpdate) * dt;
+            }
+        }
+        --cascade.framesUntilUpdate;
+
+        float blend = 1.0f;
+        if (cascade.nextTime > cascade.prevTime)
+        {
+            blend = std::clamp(
+                (time - cascade.prevTime) / (cascade.nextTime - cascade.prevTime), 0.0f, 1.0f);
+        }
+        cascade.blendWeight = cascade.nextSlot == 1 ? blend : 1.0f - blend;
+        blendWeights_[idx] = cascade.blendWeight;
+    }
+
+    for (auto stage : {backend::ShaderStage::TesselationEval, backend::ShaderStage::Fragment})
+    {
+        material_->updateUboParam("cascadeWeights", stage, &blendWeights_);
+    }
+}
+
 void IWaveGenerator::updateCompute(
     rg::RenderGraph& rGraph, IScene& scene, float dt, util::Timer<NanoSeconds>& timer)
 {
-    auto N = static_cast<float>(Resolution);
-    auto log2N = static_cast<float>(log2N_);
+    auto N = static_cast<float>(resolution_);
+    const uint32_t groupCount = resolution_ / 16;
+
+    float time = static_cast<float>(timer.getTimeElapsed()) / static_cast<float>(1'000'000'000);
+    scheduleCascades(time, dt);
+    updateQueries(time, dt);
+    updateClipmap(scene);
 
     // only generate the initial spectrum data if something has changed - i.e wind speed or
     // direction
@@ -340,218 +575,155 @@ void IWaveGenerator::updateCompute(
         rGraph.addExecutorPass("initial_spectrum", [=](vkapi::VkDriver& driver) {
             auto& cmds = driver.getCommands();
 
-            initialSpecCompute_->addStorageImage(
-                "NoiseImage",
-                noiseTexture_->getBackendHandle(),
-                0,
-                ImageStorageSet::StorageType::ReadOnly);
-
-            // the output textures - h0k and h0-k
-            initialSpecCompute_->addStorageImage(
-                "H0kImage",
-                h0kTexture_->getBackendHandle(),
-                1,
-                ImageStorageSet::StorageType::WriteOnly);
-            initialSpecCompute_->addStorageImage(
-                "H0minuskImage",
-                h0minuskTexture_->getBackendHandle(),
-                2,
-                ImageStorageSet::StorageType::WriteOnly);
-
-            initialSpecCompute_->addUboParam(
-                "N", backend::BufferElementType::Int, (void*)&Resolution);
-            initialSpecCompute_->addUboParam(
-                "windSpeed", backend::BufferElementType::Float, (void*)&options.windSpeed);
-            initialSpecCompute_->addUboParam(
-                "windDirection", backend::BufferElementType::Float2, (void*)&options.windDirection);
-            initialSpecCompute_->addUboParam(
-                "L", backend::BufferElementType::Int, (void*)&options.L);
-            initialSpecCompute_->addUboParam(
-                "A", backend::BufferElementType::Float, (void*)&options.A);
-
-            auto* bundle = initialSpecCompute_->build(engine_);
-            driver.dispatchCompute(
-                cmds.getCmdBuffer().cmdBuffer, bundle, Resolution / 16, Resolution / 16, 1);
-        });
-
-        // Note: the butterfly image only needs updating if user defined changes in resolution are
-        // allowed at some point. This may need moving under its own flag.
-        rGraph.addExecutorPass("fft_butterfly", [=](vkapi::VkDriver& driver) {
-            auto& cmds = driver.getCommands();
-
-            butterflyCompute_->addStorageImage(
-                "ButterflyImage",
-                butterflyLut_->getBackendHandle(),
-                0,
-                ImageStorageSet::StorageType::WriteOnly);
-
-            butterflyCompute_->addSsbo(
-                "bitReversed",
-                backend::BufferElementType::Uint,
-                StorageBuffer::AccessType::ReadWrite,
-                0,
-                "ssbo",
-                reversedBits_,
-                Resolution);
-
-            butterflyCompute_->addUboParam("N", backend::BufferElementType::Float, (void*)&N);
-            butterflyCompute_->addUboParam(
-                "log2N", backend::BufferElementType::Float, (void*)&log2N);
-
-            auto* bundle = butterflyCompute_->build(engine_);
-            driver.dispatchCompute(
-                cmds.getCmdBuffer().cmdBuffer, bundle, log2N_, Resolution / 16, 1);
+            for (Cascade& cascade : cascades_)
+            {
+                Compute* compute = cascade.initialSpecCompute.get();
+                compute->addStorageImage(
+                    "NoiseImage",
+                    cascade.noiseTexture->getBackendHandle(),
+                    0,
+                    ImageStorageSet::StorageType::ReadOnly);
+
+                // the output textures - h0k and h0-k
+                compute->addStorageImage(
+                    "H0kImage",
+                    cascade.h0kTexture->getBackendHandle(),
+                    1,
+                    ImageStorageSet::StorageType::WriteOnly);
+                compute->addStorageImage(
+                    "H0minuskImage",
+                    cascade.h0minuskTexture->getBackendHandle(),
+                    2,
+                    ImageStorageSet::StorageType::WriteOnly);
+
+                compute->addUboParam("N", backend::BufferElementType::Int, (void*)&resolution_);
+                compute->addUboParam(
+                    "windSpeed", backend::BufferElementType::Float, (void*)&options.windSpeed);
+                compute->addUboParam(
+                    "windDirection",
+                    backend::BufferElementType::Float2,
+                    (void*)&options.windDirection);
+                compute->addUboParam(
+                    "L", backend::BufferElementType::Float, (void*)&cascade.patchSize);
+                compute->addUboParam("A", backend::BufferElementType::Float, (void*)&options.A);
+                compute->addUboParam(
+                    "minWaveNumber",
+                    backend::BufferElementType::Float,
+                    (void*)&cascade.minWaveNumber);
+                compute->addUboParam(
+                    "maxWaveNumber",
+                    backend::BufferElementType::Float,
+                    (void*)&cascade.maxWaveNumber);
+
+                auto* bundle = compute->build(engine_);
+                driver.dispatchCompute(
+                    cmds.getCmdBuffer().cmdBuffer, bundle, groupCount, groupCount, 1);
+            }
         });
 
         updateSpectrum_ = false;
     }
 
-    rGraph.addExecutorPass("spectrum", [=, &timer](vkapi::VkDriver& driver) {
+    // Only the cascades scheduled for this frame are updated. Each stage is
+    // dispatched for all of these cascades before the barrier.
+    rGraph.addExecutorPass("spectrum", [=](vkapi::VkDriver& driver) {
         auto& cmds = driver.getCommands();
         auto& cmdBuffer = cmds.getCmdBuffer().cmdBuffer;
 
-        // input images from the initial spectrum compute call
-        specCompute_->addStorageImage(
-            "H0kImage", h0kTexture_->getBackendHandle(), 0, ImageStorageSet::StorageType::ReadOnly);
-        specCompute_->addStorageImage(
-            "H0minuskImage",
-            h0minuskTexture_->getBackendHandle(),
-            1,
-            ImageStorageSet::StorageType::ReadOnly);
-
-        // output images - dxyz
-        specCompute_->addSsbo(
-            "out_dxyz",
-            backend::BufferElementType::Float2,
-            StorageBuffer::AccessType::ReadWrite,
-            0,
-            "ssbo",
-            nullptr,
-            dxyzBufferSize);
-
-        float time = static_cast<float>(timer.getTimeElapsed()) / static_cast<float>(1'000'000'000);
-
-        specCompute_->addUboParam("N", backend::BufferElementType::Int, (void*)&Resolution);
-        specCompute_->addUboParam("L", backend::BufferElementType::Int, (void*)&options.L);
-        specCompute_->addUboParam("time", backend::BufferElementType::Float, (void*)&time);
-        specCompute_->addUboParam("offset_dx", backend::BufferElementType::Int, (void*)&dxOffset);
-        specCompute_->addUboParam("offset_dy", backend::BufferElementType::Int, (void*)&dyOffset);
-        specCompute_->addUboParam("offset_dz", backend::BufferElementType::Int, (void*)&dzOffset);
-
-        auto* bundle = specCompute_->build(engine_);
-
         vkapi::VkContext::writeReadComputeBarrier(cmdBuffer);
-        driver.dispatchCompute(
-            cmds.getCmdBuffer().cmdBuffer, bundle, Resolution / 16, Resolution / 16, 1);
+
+        for (Cascade& cascade : cascades_)
+        {
+            if (!cascade.updatePending)
+            {
+                continue;
+            }
+            Compute* compute = cascade.specCompute.get();
+
+            // input images from the initial spectrum compute call
+            compute->addStorageImage(
+                "H0kImage",
+                cascade.h0kTexture->getBackendHandle(),
+                0,
+                ImageStorageSet::StorageType::ReadOnly);
+            compute->addStorageImage(
+                "H0minuskImage",
+                cascade.h0minuskTexture->getBackendHandle(),
+                1,
+                ImageStorageSet::StorageType::ReadOnly);
+
+            // output images - dxyz
+            compute->addSsbo(
+                "out_dxyz",
+                backend::BufferElementType::Float2,
+                StorageBuffer::AccessType::ReadWrite,
+                0,
+                "ssbo",
+                nullptr,
+                dxyzBufferSize_);
+
+            compute->addUboParam("N", backend::BufferElementType::Int, (void*)&resolution_);
+            compute->addUboParam(
+                "L", backend::BufferElementType::Float, (void*)&cascade.patchSize);
+            compute->addUboParam(
+                "time", backend::BufferElementType::Float, (void*)&cascade.nextTime);
+            compute->addUboParam("offset_dx", backend::BufferElementType::Int, (void*)&dxOffset_);
+            compute->addUboParam("offset_dy", backend::BufferElementType::Int, (void*)&dyOffset_);
+            compute->addUboParam("offset_dz", backend::BufferElementType::Int, (void*)&dzOffset_);
+
+            auto* bundle = compute->build(engine_);
+            driver.dispatchCompute(cmdBuffer, bundle, groupCount, groupCount, 1);
+        }
     });
 
     rGraph.addExecutorPass("fft", [=](vkapi::VkDriver& driver) {
         auto& cmds = driver.getCommands();
         auto& cmdBuffer = cmds.getCmdBuffer().cmdBuffer;
 
-        // setup horizontal fft
-        fftHorizCompute_->addStorageImage(
-            "ButterflySampler",
-            butterflyLut_->getBackendHandle(),
-            0,
-            ImageStorageSet::StorageType::ReadOnly);
-
-        fftHorizCompute_->addSsbo(
-            "pingpong0",
-            backend::BufferElementType::Float2,
-            StorageBuffer::AccessType::ReadWrite,
-            0,
-            "ssbo_a",
-            nullptr,
-            dxyzBufferSize);
-
-        fftHorizCompute_->copySsbo(
-            *specCompute_, 0, 1, StorageBuffer::AccessType::ReadWrite, "SsboBufferB", "ssbo_b");
-
-        fftHorizCompute_->addUboParam("N", backend::BufferElementType::Float, (void*)&N);
-        fftHorizCompute_->addPushConstantParam("stage", backend::BufferElementType::Int);
-        fftHorizCompute_->addPushConstantParam("pingpong", backend::BufferElementType::Int);
-        fftHorizCompute_->addPushConstantParam("offset", backend::BufferElementType::Uint);
-
-        auto* horizBundle = fftHorizCompute_->build(engine_);
-
-        // setup vertical fft
-        fftVertCompute_->addStorageImage(
-            "ButterflySampler",
-            butterflyLut_->getBackendHandle(),
-            0,
-            ImageStorageSet::StorageType::ReadOnly);
-
-        fftVertCompute_->copySsbo(
-            *fftHorizCompute_, 0, 0, StorageBuffer::AccessType::ReadWrite, "SsboBufferA", "ssbo_a");
-
-        fftVertCompute_->copySsbo(
-            *fftHorizCompute_, 1, 1, StorageBuffer::AccessType::ReadWrite, "SsboBufferB", "ssbo_b");
-
-        fftVertCompute_->addUboParam("N", backend::BufferElementType::Float, (void*)&N);
-        fftVertCompute_->addPushConstantParam("stage", backend::BufferElementType::Int);
-        fftVertCompute_->addPushConstantParam("pingpong", backend::BufferElementType::Int);
-        fftVertCompute_->addPushConstantParam("offset", backend::BufferElementType::Uint);
-
-        auto* vertBundle = fftVertCompute_->build(engine_);
         vkapi::VkContext::writeReadComputeBarrier(cmdBuffer);
 
-        // dispatch horizontal fft
-        for (size_t n = 0; n < log2N_; ++n)
+        std::array<vkapi::ShaderProgramBundle*, OceanOptions::MaxCascadeCount> bundles {};
+        for (size_t idx = 0; idx < cascades_.size(); ++idx)
         {
-            pingpong_ = pingpong_ == 0 ? 1 : 0;
-            fftHorizCompute_->updatePushConstantParam("stage", &n);
-            fftHorizCompute_->updatePushConstantParam("pingpong", &pingpong_);
-
-            // horizontal dx
-            fftHorizCompute_->updatePushConstantParam("offset", (void*)&dxOffset);
-            fftHorizCompute_->updateGpuPush();
-            driver.dispatchCompute(
-                cmds.getCmdBuffer().cmdBuffer, horizBundle, Resolution / 16, Resolution / 16, 1);
-            vkapi::VkContext::writeReadComputeBarrier(cmdBuffer);
-
-            // horizontal dy
-            fftHorizCompute_->updatePushConstantParam("offset", (void*)&dyOffset);
-            fftHorizCompute_->updateGpuPush();
-            driver.dispatchCompute(
-                cmds.getCmdBuffer().cmdBuffer, horizBundle, Resolution / 16, Resolution / 16, 1);
-            vkapi::VkContext::writeReadComputeBarrier(cmdBuffer);
-
-            // horizontal dz
-            fftHorizCompute_->updatePushConstantParam("offset", (void*)&dzOffset);
-            fftHorizCompute_->updateGpuPush();
-            driver.dispatchCompute(
-                cmds.getCmdBuffer().cmdBuffer, horizBundle, Resolution / 16, Resolution / 16, 1);
+            Cascade& cascade = cascades_[idx];
+            if (!cascade.updatePending)
+            {
+                continue;
+            }
+            Compute* compute = cascade.fftCompute.get();
+            compute->copySsbo(
+                *cascade.specCompute,
+                0,
+                0,
+                StorageBuffer::AccessType::ReadWrite,
+                "SsboBuffer0",
+                "ssbo");
+            compute->addUboParam("N", backend::BufferElementType::Int, (void*)&resolution_);
+            compute->addPushConstantParam("vertical", backend::BufferElementType::Int);
+            bundles[idx] = compute->build(engine_);
         }
 
-        vkapi::VkContext::writeReadComputeBarrier(cmdBuffer);
-
-        // dispatch vertical fft
-        for (size_t n = 0; n < log2N_; ++n)
+        // Each workgroup performs all stages of the transform for one row (or
+        // column) of one of dx, dy or dz, so each pass is a single dispatch
+        // per cascade. The horizontal pass of all cascades is completed before
+        // the vertical pass.
+        for (int vertical = 0; vertical < 2; ++vertical)
         {
-            pingpong_ = pingpong_ == 0 ? 1 : 0;
-            fftVertCompute_->updatePushConstantParam("stage", &n);
-            fftVertCompute_->updatePushConstantParam("pingpong", &pingpong_);
-
-            // vertical dx
-            fftVertCompute_->updatePushConstantParam("offset", (void*)&dxOffset);
-            fftVertCompute_->updateGpuPush();
-            driver.dispatchCompute(
-                cmds.getCmdBuffer().cmdBuffer, vertBundle, Resolution / 16, Resolution / 16, 1);
-            vkapi::VkContext::writeReadComputeBarrier(cmdBuffer);
-
-            // vertical dy
-            fftVertCompute_->updatePushConstantParam("offset", (void*)&dyOffset);
-            fftVertCompute_->updateGpuPush();
-            driver.dispatchCompute(
-                cmds.getCmdBuffer().cmdBuffer, vertBundle, Resolution / 16, Resolution / 16, 1);
-            vkapi::VkContext::writeReadComputeBarrier(cmdBuffer);
-
-            // vertical dz
-            fftVertCompute_->updatePushConstantParam("offset", (void*)&dzOffset);
-            fftVertCompute_->updateGpuPush();
-            driver.dispatchCompute(
-                cmds.getCmdBuffer().cmdBuffer, vertBundle, Resolution / 16, Resolution / 16, 1);
+            if (vertical)
+            {
+                vkapi::VkContext::writeReadComputeBarrier(cmdBuffer);
+            }
+            for (size_t idx = 0; idx < cascades_.size(); ++idx)
+            {
+                if (!bundles[idx])
+                {
+                    continue;
+                }
+                Compute* compute = cascades_[idx].fftCompute.get();
+                compute->updatePushConstantParam("vertical", &vertical);
+                compute->updateGpuPush();
+                driver.dispatchCompute(cmdBuffer, bundles[idx], 1, resolution_, 3);
+            }
         }
     });
 
@@ -559,130 +731,276 @@ void IWaveGenerator::updateCompute(
         auto& cmds = driver.getCommands();
         auto& cmdBuffer = cmds.getCmdBuffer().cmdBuffer;
 
-        if (pingpong_)
+        vkapi::VkContext::writeReadComputeBarrier(cmdBuffer);
+
+        for (Cascade& cascade : cascades_)
         {
-            displaceCompute_->copySsbo(
-                *fftVertCompute_,
+            if (!cascade.updatePending)
+            {
+                continue;
+            }
+            Compute* compute = cascade.displaceCompute.get();
+
+            // the fft is performed in place so the spectrum buffer holds the result
+            compute->copySsbo(
+                *cascade.fftCompute,
                 0,
                 0,
                 StorageBuffer::AccessType::ReadWrite,
                 "SsboBufferA",
                 "ssbo");
-        }
-        else
-        {
-            displaceCompute_->copySsbo(
-                *fftVertCompute_,
-                1,
+
+            compute->addStorageImage(
+                "DisplacementMap",
+                cascade.fftOutputImage->getBackendHandle(),
+                0,
+                ImageStorageSet::StorageType::WriteOnly);
+            compute->addStorageImage(
+                "HeightMap",
+                cascade.heightMap->getBackendHandle(),
                 1,
-                StorageBuffer::AccessType::ReadWrite,
-                "SsboBufferA",
-                "ssbo");
-        }
+                ImageStorageSet::StorageType::WriteOnly);
+            compute->addStorageImage(
+                "NormalMap",
+                cascade.normalMap->getBackendHandle(),
+                2,
+                ImageStorageSet::StorageType::WriteOnly);
 
-        displaceCompute_->addStorageImage(
-            "DisplacementMap",
-            fftOutputImage_->getBackendHandle(),
-            0,
-            ImageStorageSet::StorageType::WriteOnly);
-        displaceCompute_->addStorageImage(
-            "HeightMap",
-            heightMap_->getBackendHandle(),
-            1,
-            ImageStorageSet::StorageType::WriteOnly);
-        displaceCompute_->addStorageImage(
-            "NormalMap",
-            normalMap_->getBackendHandle(),
-            2,
-            ImageStorageSet::StorageType::WriteOnly);
-
-        displaceCompute_->addUboParam("N", backend::BufferElementType::Float, (void*)&N);
-        displaceCompute_->addUboParam(
-            "choppyFactor", backend::BufferElementType::Float, (void*)&options.choppyFactor);
-        displaceCompute_->addUboParam(
-            "offset_dx", backend::BufferElementType::Int, (void*)&dxOffset);
-        displaceCompute_->addUboParam(
-            "offset_dy", backend::BufferElementType::Int, (void*)&dyOffset);
-        displaceCompute_->addUboParam(
-            "offset_dz", backend::BufferElementType::Int, (void*)&dzOffset);
-
-        auto* bundle = displaceCompute_->build(engine_);
+            compute->addUboParam("N", backend::BufferElementType::Float, (void*)&N);
+            compute->addUboParam(
+                "choppyFactor", backend::BufferElementType::Float, (void*)&options.choppyFactor);
+            compute->addUboParam("offset_dx", backend::BufferElementType::Int, (void*)&dxOffset_);
+            compute->addUboParam("offset_dy", backend::BufferElementType::Int, (void*)&dyOffset_);
+            compute->addUboParam("offset_dz", backend::BufferElementType::Int, (void*)&dzOffset_);
 
-        vkapi::VkContext::writeReadComputeBarrier(cmdBuffer);
-        driver.dispatchCompute(
-            cmds.getCmdBuffer().cmdBuffer, bundle, Resolution / 16, Resolution / 16, 1);
+            auto* bundle = compute->build(engine_);
+            driver.dispatchCompute(cmdBuffer, bundle, groupCount, groupCount, 1);
+        }
     });
 
     rGraph.addExecutorPass("generate_maps", [=](vkapi::VkDriver& driver) {
         auto& cmds = driver.getCommands();
         auto& cmdBuffer = cmds.getCmdBuffer().cmdBuffer;
 
-        // input samplers
-        genMapCompute_->addImageSampler(
-            driver,
-            "fftOutputImage",
-            fftOutputImage_->getBackendHandle(),
-            0,
-            {backend::SamplerFilter::Nearest});
-        genMapCompute_->addImageSampler(
-            driver,
-            "HeightMap",
-            heightMap_->getBackendHandle(),
-            1,
-            {backend::SamplerFilter::Nearest});
-
-        // output storage images
-        genMapCompute_->addStorageImage(
-            "DisplacementMap",
-            displacementMap_->getBackendHandle(),
-            2,
-            ImageStorageSet::StorageType::WriteOnly);
-        genMapCompute_->addStorageImage(
-            "GradientMap",
-            gradientMap_->getBackendHandle(),
-            3,
-            ImageStorageSet::StorageType::WriteOnly);
-
-        genMapCompute_->addUboParam("N", backend::BufferElementType::Float, (void*)&N);
-        genMapCompute_->addUboParam(
-            "choppyFactor", backend::BufferElementType::Float, (void*)&options.choppyFactor);
-        genMapCompute_->addUboParam(
-            "gridLength", backend::BufferElementType::Float, (void*)&options.gridLength);
-
-        auto* bundle = genMapCompute_->build(engine_);
-
         vkapi::VkContext::writeReadComputeBarrier(cmdBuffer);
-        driver.dispatchCompute(
-            cmds.getCmdBuffer().cmdBuffer, bundle, Resolution / 16, Resolution / 16, 1);
+
+        for (Cascade& cascade : cascades_)
+        {
+            if (!cascade.updatePending)
+            {
+                continue;
+            }
+            Compute* compute = cascade.genMapCompute.get();
+
+            // input samplers
+            compute->addImageSampler(
+                driver,
+                "fftOutputImage",
+                cascade.fftOutputImage->getBackendHandle(),
+                0,
+                {backend::SamplerFilter::Nearest});
+            compute->addImageSampler(
+                driver,
+                "HeightMap",
+                cascade.heightMap->getBackendHandle(),
+                1,
+                {backend::SamplerFilter::Nearest});
+            compute->addImageSampler(
+                driver,
+                "NormalMap",
+                cascade.normalMap->getBackendHandle(),
+                2,
+                {backend::SamplerFilter::Nearest});
+
+            // output storage images - the slot not being blended from
+            compute->addStorageImage(
+                "DisplacementMap",
+                cascade.displacementMaps[cascade.nextSlot]->getBackendHandle(),
+                3,
+                ImageStorageSet::StorageType::WriteOnly);
+            compute->addStorageImage(
+                "GradientMap",
+                cascade.gradientMaps[cascade.nextSlot]->getBackendHandle(),
+                4,
+                ImageStorageSet::StorageType::WriteOnly);
+
+            compute->addUboParam("N", backend::BufferElementType::Float, (void*)&N);
+            compute->addUboParam(
+                "choppyFactor", backend::BufferElementType::Float, (void*)&options.choppyFactor);
+            compute->addUboParam(
+                "gridLength", backend::BufferElementType::Float, (void*)&options.gridLength);
+
+            auto* bundle = compute->build(engine_);
+            driver.dispatchCompute(cmdBuffer, bundle, groupCount, groupCount, 1);
+        }
 
         cmds.flush();
     });
 }
 
+void IWaveGenerator::initQueries(uint32_t queryResolution)
+{
+    if (!queryResolution)
+    {
+        return;
+    }
+    const auto res = static_cast<uint32_t>(resolution_);
+    ASSERT_FATAL(
+        queryResolution <= res && (queryResolution & (queryResolution - 1)) == 0,
+        "The query resolution must be a power of two no greater than the ocean resolution "
+        "(query resolution: %d).",
+        queryResolution);
+
+    // the gpu normalises the transform by its own resolution
+    const float scale = 1.0f / static_cast<float>(res * res);
+
+    float mirrorVariance = 0.0f;
+    querySpectra_.resize(cascades_.size());
+    for (auto& grids : queryGrids_)
+    {
+        grids.resize(cascades_.size());
+    }
+    for (size_t idx = 0; idx < cascades_.size(); ++idx)
+    {
+        const Cascade& cascade = cascades_[idx];
+
+        util::ocean::SpectrumParams params = getSpectrumParams(cascade, queryResolution);
+
+        // the mirror shares the noise, so holds the longest waves of the gpu
+        // spectrum exactly
+        querySpectra_[idx].init(params, cascade.noiseMap.data(), res);
+        querySpectra_[idx].evaluate(0.0f, scale, options.choppyFactor, queryGrids_[0][idx]);
+
+        mirrorVariance += util::ocean::heightVariance(params, scale);
+    }
+
+    // The material samples the maps with linear filtering, so the gpu surface
+    // at a point is the spectrum half a gpu texel before it.
+    queryOffset_ = 0.5f * static_cast<float>(queryResolution) / static_cast<float>(res);
+
+    queryStats_.resolution = queryResolution;
+    queryStats_.varianceCaptured =
+        heightVariance_ > 0.0f ? mirrorVariance / heightVariance_ : 1.0f;
+    queryStats_.heightError =
+        std::sqrt(std::max(heightVariance_ - mirrorVariance, 0.0f)) * options.dispFactor;
+}
+
+void IWaveGenerator::updateQueries(float time, float dt)
+{
+    if (querySpectra_.empty())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queryMutex_);
+        frameTime_ = time;
+        if (queryPending_ && queryReady_.load(std::memory_order_acquire))
+        {
+            queryFront_ ^= 1;
+            queryPending_ = false;
+        }
+    }
+
+    // If the worker hasn't finished, the queries continue to use the older
+    // grids - this is reported as latency rather than stalling the frame.
+    if (queryPending_)
+    {
+        return;
+    }
+
+    // the queries are made over the next frame, so the mirror is evaluated
+    // for that time
+    const uint32_t back = queryFront_ ^ 1;
+    queryTimes_[back] = time + dt;
+    queryPending_ = true;
+    queryReady_.store(false, std::memory_order_relaxed);
+
+    const float scale = 1.0f / static_cast<float>(resolution_ * resolution_);
+    queryTasks_.run([this, back, scale]() {
+        for (size_t idx = 0; idx < querySpectra_.size(); ++idx)
+        {
+            querySpectra_[idx].evaluate(
+                queryTimes_[back], scale, options.choppyFactor, queryGrids_[back][idx]);
+        }
+        queryReady_.store(true, std::memory_order_release);
+    });
+}
+
+bool IWaveGenerator::sampleDisplacement(
+    const mathfu::vec2* positions, size_t count, mathfu::vec3* out)
+{
+    if (querySpectra_.empty())
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(queryMutex_);
+    const auto& grids = queryGrids_[queryFront_];
+
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, count, QueryGrainSize),
+        [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i < range.end(); ++i)
+            {
+                float sum[3] = {0.0f, 0.0f, 0.0f};
+                for (size_t idx = 0; idx < grids.size(); ++idx)
+                {
+                    const float toGrid =
+                        static_cast<float>(grids[idx].size) / cascades_[idx].patchSize;
+                    float value[3];
+                    util::ocean::sample(
+                        grids[idx],
+                        positions[i].x * toGrid - queryOffset_,
+                        positions[i].y * toGrid - queryOffset_,
+                        value);
+                    sum[0] += value[0];
+                    sum[1] += value[1];
+                    sum[2] += value[2];
+                }
+                out[i] = mathfu::vec3 {sum[1], sum[0] * options.dispFactor, sum[2]};
+            }
+        });
+    return true;
+}
+
+WaveGenerator::QueryStats IWaveGenerator::getQueryStats()
+{
+    std::lock_guard<std::mutex> lock(queryMutex_);
+    QueryStats stats = queryStats_;
+    if (!querySpectra_.empty())
+    {
+        stats.latency = queryTimes_[queryFront_] - frameTime_;
+    }
+    return stats;
+}
+
 void IWaveGenerator::transitionImagesToShaderRead(rg::RenderGraph& rGraph)
 {
     rGraph.addExecutorPass("transition_images_shader_read", [=](vkapi::VkDriver& driver) {
         auto& cmds = driver.getCommands();
         auto& cmdBuffer = cmds.getCmdBuffer().cmdBuffer;
 
-        displacementMap_->getBackendHandle().getResource()->transition(
-            vk::ImageLayout::eGeneral,
-            vk::ImageLayout::eShaderReadOnlyOptimal,
-            cmdBuffer,
-            vk::PipelineStageFlagBits::eComputeShader,
-            vk::PipelineStageFlagBits::eTessellationEvaluationShader);
-        normalMap_->getBackendHandle().getResource()->transition(
-            vk::ImageLayout::eGeneral,
-            vk::ImageLayout::eShaderReadOnlyOptimal,
-            cmdBuffer,
-            vk::PipelineStageFlagBits::eComputeShader,
-            vk::PipelineStageFlagBits::eFragmentShader);
-        gradientMap_->getBackendHandle().getResource()->transition(
-            vk::ImageLayout::eGeneral,
-            vk::ImageLayout::eShaderReadOnlyOptimal,
-            cmdBuffer,
-            vk::PipelineStageFlagBits::eComputeShader,
-            vk::PipelineStageFlagBits::eFragmentShader);
+        for (const Cascade& cascade : cascades_)
+        {
+            for (uint32_t slot = 0; slot < 2; ++slot)
+            {
+                driver.getTexture(cascade.displacementMaps[slot]->getBackendHandle())
+                    ->transition(
+                        vk::ImageLayout::eGeneral,
+                        vk::ImageLayout::eShaderReadOnlyOptimal,
+                        cmdBuffer,
+                        vk::PipelineStageFlagBits::eComputeShader,
+                        vk::PipelineStageFlagBits::eTessellationEvaluationShader);
+                driver.getTexture(cascade.gradientMaps[slot]->getBackendHandle())
+                    ->transition(
+                        vk::ImageLayout::eGeneral,
+                        vk::ImageLayout::eShaderReadOnlyOptimal,
+                        cmdBuffer,
+                        vk::PipelineStageFlagBits::eComputeShader,
+                        vk::PipelineStageFlagBits::eFragmentShader);
+            }
+        }
     });
 }
 
@@ -692,25 +1010,27 @@ void IWaveGenerator::transitionImagesToCompute(rg::RenderGraph& rGraph)
         auto& cmds = driver.getCommands();
         auto& cmdBuffer = cmds.getCmdBuffer().cmdBuffer;
 
-        displacementMap_->getBackendHandle().getResource()->transition(
-            vk::ImageLayout::eShaderReadOnlyOptimal,
-            vk::ImageLayout::eGeneral,
-            cmdBuffer,
-            vk::PipelineStageFlagBits::eTessellationEvaluationShader,
-            vk::PipelineStageFlagBits::eComputeShader);
-        normalMap_->getBackendHandle().getResource()->transition(
-            vk::ImageLayout::eShaderReadOnlyOptimal,
-            vk::ImageLayout::eGeneral,
-            cmdBuffer,
-            vk::PipelineStageFlagBits::eFragmentShader,
-            vk::PipelineStageFlagBits::eComputeShader);
-        gradientMap_->getBackendHandle().getResource()->transition(
-            vk::ImageLayout::eShaderReadOnlyOptimal,
-            vk::ImageLayout::eGeneral,
-            cmdBuffer,
-            vk::PipelineStageFlagBits::eFragmentShader,
-            vk::PipelineStageFlagBits::eComputeShader);
+        for (const Cascade& cascade : cascades_)
+        {
+            for (uint32_t slot = 0; slot < 2; ++slot)
+            {
+                driver.getTexture(cascade.displacementMaps[slot]->getBackendHandle())
+                    ->transition(
+                        vk::ImageLayout::eShaderReadOnlyOptimal,
+                        vk::ImageLayout::eGeneral,
+                        cmdBuffer,
+                        vk::PipelineStageFlagBits::eTessellationEvaluationShader,
+                        vk::PipelineStageFlagBits::eComputeShader);
+                driver.getTexture(cascade.gradientMaps[slot]->getBackendHandle())
+                    ->transition(
+                        vk::ImageLayout::eShaderReadOnlyOptimal,
+                        vk::ImageLayout::eGeneral,
+                        cmdBuffer,
+                        vk::PipelineStageFlagBits::eFragmentShader,
+                        vk::PipelineStageFlagBits::eComputeShader);
+            }
+        }
     });
 }
 
-} // namespace yave
\ No newline at end of file
+} // namespace yave
@@ -23,12 +23,19 @@
 #pragma once
 #include "render_graph/render_graph.h"
 #include "yave/object.h"
+#include "yave/options.h"
 #include "yave/wave_generator.h"
 
 #include <mathfu/glsl_mappings.h>
+#include <tbb/task_group.h>
+#include <utility/ocean_spectrum.h>
 #include <utility/timer.h>
 
+#include <array>
+#include <atomic>
 #include <cstdint>
+#include <mutex>
+#include <vector>
 
 namespace yave
 {
@@ -42,18 +49,22 @@ class IMaterial;
 class IWaveGenerator : public WaveGenerator
 {
 public:
-    // fixed resolution, maybe user defined at some point?
-    static constexpr int Resolution = 256;
-    // dxyz buffer offsets
-    static constexpr int dxOffset = 0;
-    static constexpr int dyOffset = Resolution * Resolution;
-    static constexpr int dzOffset = dyOffset * 2;
-    static constexpr int dxyzBufferSize = Resolution * Resolution * 3;
+    static constexpr uint32_t MinResolution = 64;
+    // limited by the workgroup memory used by fft.comp
+    static constexpr uint32_t MaxResolution = 1024;
+
+    // the number of displacement and gradient maps bound to the material -
+    // two per cascade, as the maps are double buffered.
+    static constexpr uint32_t MaterialMapCount = OceanOptions::MaxCascadeCount * 2;
+
+    // The half width of each clipmap ring in patches of that ring. This must
+    // be even so the inner edge of a ring lies on the patch grid of the next.
+    static constexpr uint32_t ClipmapHalfWidth = 4;
+    static constexpr uint32_t MaxClipmapRingCount = 16;
 
     // temp measure - move to scene!
     struct WaveOptions
     {
-        int L = 1000;
         float A = 4.0f;
         mathfu::vec2 windDirection {4.0f, 2.0f};
         float windSpeed = 40.0f;
@@ -62,13 +73,76 @@ public:
         float dispFactor = 20.0f;
         float tessFactor = 0.75f;
         float tessEdgeSize = 20.0f;
-        size_t patchCount = 64;
+        // the tessellation limit of the innermost ring - the limit is scaled
+        // by the falloff with each coarser ring
+        float maxTessLevel = 64.0f;
+        float ringTessFalloff = 0.5f;
+    };
+
+    /**
+     * @brief A spectrum simulated over a tile of a given size. The spectrum
+     * is limited to a band of wave numbers so the cascades don't overlap.
+     * The displacement and gradient maps are double buffered - when the
+     * cascade is updated, the maps are evaluated for the time of the next
+     * update and the material blends from the previous maps towards these.
+     */
+    struct Cascade
+    {
+        float patchSize = 0.0f;
+        float minWaveNumber = 0.0f;
+        float maxWaveNumber = 0.0f;
+
+        // the number of frames between updates
+        uint32_t updateInterval = 1;
+        uint32_t framesUntilUpdate = 0;
+        bool updatePending = false;
+        bool hasUpdated = false;
+
+        // the slot of the maps which were last written and the times that
+        // both slots were evaluated at
+        uint32_t nextSlot = 1;
+        float prevTime = 0.0f;
+        float nextTime = 0.0f;
+        // the weight of slot one used by the material
+        float blendWeight = 1.0f;
+
+        // 4 channels for our noise texture
+        std::vector<float> noiseMap;
+        IMappedTexture* noiseTexture = nullptr;
+
+        // initial spectrum - h0k and h0-k
+        IMappedTexture* h0kTexture = nullptr;
+        IMappedTexture* h0minuskTexture = nullptr;
+        std::unique_ptr<Compute> initialSpecCompute;
+
+        // the dxyz spectrum, which the fft transforms in place
+        std::unique_ptr<Compute> specCompute;
+        std::unique_ptr<Compute> fftCompute;
+
+        // displacement
+        IMappedTexture* fftOutputImage = nullptr;
+        IMappedTexture* heightMap = nullptr;
+        IMappedTexture* normalMap = nullptr;
+        std::unique_ptr<Compute> displaceCompute;
+
+        // map generation - height and displacement, and the gradient,
+        // jacobian and turbulence
+        IMappedTexture* displacementMaps[2] = {};
+        IMappedTexture* gradientMaps[2] = {};
+        std::unique_ptr<Compute> genMapCompute;
     };
 
-    IWaveGenerator(IEngine& engine, IScene& scene);
+    IWaveGenerator(IEngine& engine, IScene& scene, const OceanOptions& oceanOptions);
     ~IWaveGenerator();
 
-    void generatePatch() noexcept;
+    /**
+     * @brief Builds the nested rings of the clipmap, centred on the origin.
+     * Each ring is a square of patches twice the size of those of the ring
+     * it encloses. The patches don't share vertices - the uv of each vertex
+     * holds the ring and a mask of the edges on the outer edge of the ring,
+     * which are tessellated to match the coarser ring.
+     */
+    void generateClipmap(float patchSize, uint32_t ringCount) noexcept;
 
     void buildMaterial(IScene& scene);
 
@@ -84,59 +158,87 @@ public:
 
     [[maybe_unused]] void shutDown(vkapi::VkDriver& driver) { YAVE_UNUSED(driver); }
 
-private:
-    IEngine& engine_;
+    bool sampleDisplacement(const mathfu::vec2* positions, size_t count, mathfu::vec3* out);
 
-    Object waterObj_;
-    IMaterial* material_;
+    QueryStats getQueryStats();
 
-    std::vector<float> patchVertices;
-    std::vector<uint32_t> patchIndices;
+private:
+    void createCascade(Cascade& cascade);
 
-    size_t log2N_;
-    uint32_t reversedBits_[Resolution];
-    // 4 channels for our noise texture
-    float noiseMap_[Resolution * Resolution * 4];
+    // the parameters of the cpu spectrum matching the cascade
+    [[nodiscard]] util::ocean::SpectrumParams
+    getSpectrumParams(const Cascade& cascade, uint32_t size) const noexcept;
 
-    // initial spectrum compute
-    // output textures
-    IMappedTexture* h0kTexture_;
-    IMappedTexture* h0minuskTexture_;
+    // Creates the cpu mirror of the cascades and evaluates it for time zero,
+    // so queries can be made before the first frame.
+    void initQueries(uint32_t queryResolution);
 
-    std::unique_ptr<Compute> initialSpecCompute_;
-    IMappedTexture* noiseTexture_;
+    // Makes the displacement evaluated by the worker available to queries
+    // once complete, and starts evaluating the mirror for the next frame.
+    void updateQueries(float time, float dt);
 
-    // spectrum
-    IMappedTexture* dztTexture_;
-    IMappedTexture* dytTexture_;
-    IMappedTexture* dxtTexture_;
-    std::unique_ptr<Compute> specCompute_;
+    // Centres the clipmap on the camera and updates the frustum used to cull
+    // the patches.
+    void updateClipmap(IScene& scene);
 
-    // fft butterfly compute
-    IMappedTexture* butterflyLut_;
-    std::unique_ptr<Compute> butterflyCompute_;
+    // Selects the cascades to update this frame and sets the blend weights
+    // of all cascades for the current time.
+    void scheduleCascades(float time, float dt);
 
-    // fft compute
-    std::unique_ptr<Compute> fftHorizCompute_;
-    std::unique_ptr<Compute> fftVertCompute_;
-    IMappedTexture* pingpongTexture_;
+private:
+    IEngine& engine_;
 
-    // displacement
-    IMappedTexture* fftOutputImage_;
-    IMappedTexture* heightMap_;
-    IMappedTexture* normalMap_;
-    std::unique_ptr<Compute> displaceCompute_;
+    Object waterObj_;
+    IMaterial* material_;
 
-    // map generation
-    IMappedTexture* gradientMap_;
-    // height and displacement
-    IMappedTexture* displacementMap_;
-    std::unique_ptr<Compute> genMapCompute_;
+    std::vector<float> patchVertices;
+    std::vector<uint32_t> patchIndices;
 
-    int pingpong_;
+    // the clipmap is moved in steps of the innermost patch size
+    float clipmapPatchSize_;
+    mathfu::vec2 gridOffset_;
+    std::array<mathfu::vec4, 6> frustumPlanes_;
+    // the distance the patch bounds are expanded by before culling, to
+    // account for the displacement
+    float cullMargin_;
+
+    // the fft grid resolution and the offsets of dx, dy and dz within the
+    // dxyz buffer
+    int resolution_;
+    int dxOffset_;
+    int dyOffset_;
+    int dzOffset_;
+    uint32_t dxyzBufferSize_;
+
+    std::vector<Cascade> cascades_;
+
+    // the per-cascade material parameters, packed as vec4s
+    mathfu::vec4 patchSizes_;
+    mathfu::vec4 blendWeights_;
+    mathfu::vec4 gradientScales_;
+    int cascadeCount_;
 
     WaveOptions options;
 
     bool updateSpectrum_;
+
+    // the expected variance of the height of the combined cascades
+    float heightVariance_;
+
+    // The cpu mirror of each cascade used for displacement queries. The grids
+    // are double buffered - the worker evaluates the spectra into the grids
+    // not being sampled, which are swapped in at the start of a frame.
+    std::vector<util::ocean::WaveSpectrum> querySpectra_;
+    std::vector<util::ocean::DisplacementGrid> queryGrids_[2];
+    float queryTimes_[2];
+    uint32_t queryFront_;
+    // the offset of the gpu texel centres in grid points of the mirror
+    float queryOffset_;
+    float frameTime_;
+    QueryStats queryStats_;
+    bool queryPending_;
+    std::atomic<bool> queryReady_;
+    std::mutex queryMutex_;
+    tbb::task_group queryTasks_;
 };
 } // namespace yave
\ No newline at end of file
@@ -12,6 +12,21 @@ void RenderPrimitive::addMeshDrawData(size_t indexCount, size_t offset, size_t v
     static_cast<IRenderPrimitive*>(this)->addMeshDrawData(indexCount, offset, vertexCount);
 }
 
+void RenderPrimitive::addLodDrawData(size_t indexCount, size_t offset, float error)
+{
+    static_cast<IRenderPrimitive*>(this)->addLodDrawData(indexCount, offset, error);
+}
+
+void RenderPrimitive::setDimensions(const mathfu::vec3& min, const mathfu::vec3& max)
+{
+    static_cast<IRenderPrimitive*>(this)->setDimensions(min, max);
+}
+
+void RenderPrimitive::setClusters(const std::vector<ModelMesh::Cluster>& clusters)
+{
+    static_cast<IRenderPrimitive*>(this)->setClusters(clusters);
+}
+
 void RenderPrimitive::setTopology(Topology topo)
 {
     static_cast<IRenderPrimitive*>(this)->setTopology(topo);
@@ -32,6 +47,11 @@ void RenderPrimitive::setIndexBuffer(IndexBuffer* iBuffer)
     static_cast<IRenderPrimitive*>(this)->setIndexBuffer(static_cast<IIndexBuffer*>(iBuffer));
 }
 
+void RenderPrimitive::setVertexOffset(uint32_t offset)
+{
+    static_cast<IRenderPrimitive*>(this)->setVertexOffset(offset);
+}
+
 void RenderPrimitive::setMaterial(Material* mat)
 {
     static_cast<IRenderPrimitive*>(this)->setMaterial(static_cast<IMaterial*>(mat));
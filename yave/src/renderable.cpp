@@ -17,4 +17,9 @@ void Renderable::setPrimitiveCount(size_t count) noexcept
 
 void Renderable::skipVisibilityChecks() { static_cast<IRenderable*>(this)->skipVisibilityChecks(); }
 
+void Renderable::setMaterialOverrides(const MaterialOverrides& overrides) noexcept
+{
+    static_cast<IRenderable*>(this)->setMaterialOverridesI(overrides);
+}
+
 } // namespace yave
\ No newline at end of file
@@ -21,6 +21,12 @@ void RenderableManager::build(
         matShader);
 }
 
+Renderable* RenderableManager::buildInstance(
+    const Object& prototype, Object& obj, const ModelTransform& transform)
+{
+    return static_cast<IRenderableManager*>(this)->buildInstance(prototype, obj, transform);
+}
+
 Material* RenderableManager::createMaterial() noexcept
 {
     return static_cast<IRenderableManager*>(this)->createMaterial();
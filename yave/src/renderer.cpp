@@ -10,6 +10,11 @@ void Renderer::beginFrame() { static_cast<IRenderer*>(this)->beginFrame(); }
 
 void Renderer::endFrame() { static_cast<IRenderer*>(this)->endFrame(); }
 
+const vkapi::FrameContext::FrameTimings& Renderer::getFrameTimings() const
+{
+    return static_cast<const IRenderer*>(this)->getFrameTimings();
+}
+
 void Renderer::render(
     Engine* engine, Scene* scene, float dt, util::Timer<NanoSeconds>& timer, bool clearSwap)
 {
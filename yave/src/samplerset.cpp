@@ -26,6 +26,8 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+
 namespace yave
 {
 
@@ -50,6 +52,15 @@ std::string SamplerSet::samplerTypeToStr(SamplerType type)
 void SamplerSet::pushSampler(
     const std::string& name, uint8_t set, uint8_t binding, SamplerType type) noexcept
 {
+    // compute samplers are re-added before each dispatch
+    auto iter = std::find_if(samplers_.begin(), samplers_.end(), [&](const SamplerInfo& info) {
+        return info.set == set && info.binding == binding;
+    });
+    if (iter != samplers_.end())
+    {
+        *iter = {name, set, binding, type};
+        return;
+    }
     samplers_.push_back({name, set, binding, type});
 }
 
@@ -84,6 +95,14 @@ void ImageStorageSet::addStorageImage(
     StorageType storageType,
     const std::string& formatLayout) noexcept
 {
+    auto iter = std::find_if(samplers_.begin(), samplers_.end(), [&](const SamplerInfo& info) {
+        return info.set == set && info.binding == binding;
+    });
+    if (iter != samplers_.end())
+    {
+        *iter = {name, set, binding, samplerType, storageType, formatLayout};
+        return;
+    }
     samplers_.push_back({name, set, binding, samplerType, storageType, formatLayout});
 }
 
@@ -95,6 +114,9 @@ std::string ImageStorageSet::samplerTypeToStr(SamplerType type)
         case ImageStorageSet::SamplerType::e2d:
             output = "image2D";
             break;
+        case ImageStorageSet::SamplerType::e2dArray:
+            output = "image2DArray";
+            break;
         case ImageStorageSet::SamplerType::e3d:
             output = "image3D";
             break;
@@ -119,6 +141,9 @@ std::string ImageStorageSet::storageTypeToStr(ImageStorageSet::StorageType type)
         case ImageStorageSet::StorageType::ReadWrite:
             output = "";
             break;
+        case ImageStorageSet::StorageType::Coherent:
+            output = "coherent";
+            break;
     }
     return output;
 }
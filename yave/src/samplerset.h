@@ -77,6 +77,7 @@ public:
     enum class SamplerType
     {
         e2d,
+        e2dArray,
         e3d,
         Cube
     };
@@ -85,7 +86,10 @@ public:
     {
         WriteOnly,
         ReadOnly,
-        ReadWrite
+        ReadWrite,
+        // writes are visible to other workgroups once a memory barrier has
+        // been issued
+        Coherent
     };
 
     struct SamplerInfo
@@ -111,6 +115,7 @@ public:
 
     static std::string texFormatToFormatLayout(vk::Format format);
 
+    // Replaces any image previously added at the same set and binding.
     void addStorageImage(
         const std::string& name,
         uint8_t set,
@@ -52,4 +52,18 @@ GbufferOptions& Scene::getGbufferOptions()
     return static_cast<IScene*>(this)->getGbufferOptions();
 }
 
+void Scene::setLodOptions(const LodOptions& lod) { static_cast<IScene*>(this)->setLodOptions(lod); }
+
+LodOptions& Scene::getLodOptions() { return static_cast<IScene*>(this)->getLodOptions(); }
+
+void Scene::setClusterCullOptions(const ClusterCullOptions& cull)
+{
+    static_cast<IScene*>(this)->setClusterCullOptions(cull);
+}
+
+ClusterCullOptions& Scene::getClusterCullOptions()
+{
+    return static_cast<IScene*>(this)->getClusterCullOptions();
+}
+
 } // namespace yave
\ No newline at end of file
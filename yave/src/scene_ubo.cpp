@@ -58,6 +58,14 @@ SceneUbo::SceneUbo(vkapi::VkDriver& driver)
     ubo_->addElement("lightDirection", backend::BufferElementType::Float4);
     ubo_->addElement("sun", backend::BufferElementType::Float4);
 
+    // ============ spherical harmonic irradiance ====================
+
+    // the rgb coefficients are padded to a vec4 for std140
+    ubo_->addElement(
+        "irradianceSh", backend::BufferElementType::Float4, nullptr, util::sh::CoeffCount);
+    int useIrradianceSh = 0;
+    ubo_->addElement("useIrradianceSh", backend::BufferElementType::Int, &useIrradianceSh);
+
     ubo_->createGpuBuffer(driver);
 }
 
@@ -89,6 +97,14 @@ void SceneUbo::updateIbl(IIndirectLight* il)
     }
     uint32_t mips = il->getMipLevels();
     ubo_->updateElement("iblMipLevels", &mips);
+
+    int useIrradianceSh = il->hasIrradianceSh();
+    ubo_->updateElement("useIrradianceSh", &useIrradianceSh);
+    if (useIrradianceSh)
+    {
+        util::sh::Coefficients coeffs = il->getIrradianceSh();
+        ubo_->updateElement("irradianceSh", coeffs.data);
+    }
 }
 
 void SceneUbo::updateDirLight(IEngine& engine, LightInstance* instance)
@@ -1,3 +1,4 @@
+#include "private/engine.h"
 #include "private/mapped_texture.h"
 
 namespace yave
@@ -24,6 +25,21 @@ void Texture::setTexture(const Params& params, size_t* offsets) noexcept
         offsets);
 }
 
+void Texture::setTextures(Engine* engine, const std::vector<Upload>& uploads) noexcept
+{
+    IMappedTexture::setTextures(*static_cast<IEngine*>(engine), uploads);
+}
+
+bool Texture::isFormatSupported(Engine* engine, TextureFormat format) noexcept
+{
+    return IMappedTexture::isFormatSupported(*static_cast<IEngine*>(engine), format);
+}
+
+void Texture::setStreamedTexture(const StreamParams& params) noexcept
+{
+    static_cast<IMappedTexture*>(this)->setStreamedTexture(params);
+}
+
 void Texture::setEmptyTexture(
     uint32_t width,
     uint32_t height,
@@ -54,6 +70,17 @@ Texture::Params Texture::getTextureParams() noexcept
     return static_cast<IMappedTexture*>(this)->getTextureParams();
 }
 
-void Texture::generateMipMaps() { static_cast<IMappedTexture*>(this)->generateMipMaps(); }
+std::vector<uint8_t> Texture::download() { return static_cast<IMappedTexture*>(this)->download(); }
+
+void Texture::generateMipMaps(MipFilter filter, bool srgb)
+{
+    static_cast<IMappedTexture*>(this)->generateMipMaps(filter, srgb);
+}
+
+void Texture::prefilterSpecular(Texture* envMap, uint32_t sampleCount)
+{
+    static_cast<IMappedTexture*>(this)->prefilterSpecular(
+        static_cast<IMappedTexture*>(envMap), sampleCount);
+}
 
 } // namespace yave
\ No newline at end of file
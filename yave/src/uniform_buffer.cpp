@@ -276,7 +276,8 @@ UniformBuffer::UniformBuffer(
       aliasName_(std::move(aliasName)),
       binding_(binding),
       set_(set),
-      currentGpuBufferSize_(0)
+      currentGpuBufferSize_(0),
+      bufferCount_(vkapi::FrameContext::MaxFramesInFlight)
 {
 }
 
@@ -309,16 +310,36 @@ std::string UniformBuffer::createShaderStr() noexcept
     return output;
 }
 
-void UniformBuffer::createGpuBuffer(vkapi::VkDriver& driver, size_t size) noexcept
+void UniformBuffer::createGpuBuffers(
+    vkapi::VkDriver& driver, size_t size, VkBufferUsageFlags usage)
 {
-    ASSERT_FATAL(!elements_.empty(), "This uniform has no elements added.");
     if (size > currentGpuBufferSize_)
     {
-        vkHandle_ = driver.addUbo(size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+        for (uint32_t i = 0; i < bufferCount_; ++i)
+        {
+            vkHandles_[i] = driver.addUbo(size, usage);
+        }
         currentGpuBufferSize_ = size;
     }
 }
 
+void UniformBuffer::mapToFrameBuffer(vkapi::VkDriver& driver, void* data, size_t size) noexcept
+{
+    // only write to the buffer associated with the current frame so we don't
+    // overwrite data which may still be in use by the GPU.
+    uint32_t idx = bufferCount_ > 1 ? driver.getFrameIndex() : 0;
+    vkapi::Buffer* buffer = driver.getBuffer(vkHandles_[idx]);
+    ASSERT_FATAL(
+        buffer, "Buffer is nullptr - have you created the buffer before trying to map data?");
+    buffer->mapToGpuBuffer(data, size);
+}
+
+void UniformBuffer::createGpuBuffer(vkapi::VkDriver& driver, size_t size) noexcept
+{
+    ASSERT_FATAL(!elements_.empty(), "This uniform has no elements added.");
+    createGpuBuffers(driver, size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+}
+
 void UniformBuffer::createGpuBuffer(vkapi::VkDriver& driver) noexcept
 {
     createGpuBuffer(driver, accumSize_);
@@ -326,11 +347,7 @@ void UniformBuffer::createGpuBuffer(vkapi::VkDriver& driver) noexcept
 
 void UniformBuffer::mapGpuBuffer(vkapi::VkDriver& driver, void* data, size_t size) noexcept
 {
-    YAVE_UNUSED(driver);
-    vkapi::Buffer* buffer = vkHandle_.getResource();
-    ASSERT_FATAL(
-        buffer, "Buffer is nullptr - have you created the buffer before trying to map data?");
-    buffer->mapToGpuBuffer(data, size);
+    mapToFrameBuffer(driver, data, size);
 }
 
 void UniformBuffer::mapGpuBuffer(vkapi::VkDriver& driver, void* data) noexcept
@@ -341,14 +358,23 @@ void UniformBuffer::mapGpuBuffer(vkapi::VkDriver& driver, void* data) noexcept
 void UniformBuffer::downloadToHost(IEngine& engine, void* hostBuffer, size_t dataSize)
 {
     ASSERT_FATAL(currentGpuBufferSize_ > 0, "Buffer size is zero. Has this buffer been mapped?");
-    auto* res = vkHandle_.getResource();
+    uint32_t idx = bufferCount_ > 1 ? engine.driver().getFrameIndex() : 0;
+    auto* res = engine.driver().getBuffer(vkHandles_[idx]);
     ASSERT_FATAL(res, "Resource handle is NULL");
     res->downloadToHost(engine.driver(), hostBuffer, dataSize);
 }
 
 UniformBuffer::BackendBufferParams UniformBuffer::getBufferParams(vkapi::VkDriver& driver) noexcept
 {
-    return {vkHandle_.getResource()->get(), accumSize_, set_, binding_, bufferTypeFromSet(set_)};
+    FrameBuffers buffers;
+    for (uint32_t i = 0; i < buffers.size(); ++i)
+    {
+        // single buffered resources use the same buffer for all frames
+        const vkapi::BufferHandle& handle = vkHandles_[i < bufferCount_ ? i : 0];
+        ASSERT_FATAL(handle, "Gpu buffer has not been created.");
+        buffers[i] = driver.getBuffer(handle)->get();
+    }
+    return {buffers, accumSize_, set_, binding_, bufferTypeFromSet(set_)};
 }
 
 StorageBuffer::StorageBuffer(
@@ -356,9 +382,11 @@ StorageBuffer::StorageBuffer(
     uint32_t set,
     uint32_t binding,
     const std::string& memberName,
-    const std::string& aliasName)
+    const std::string& aliasName,
+    bool perFrame)
     : UniformBuffer(set, binding, memberName, aliasName), accessType_(type)
 {
+    bufferCount_ = perFrame ? vkapi::FrameContext::MaxFramesInFlight : 1;
 }
 
 StorageBuffer::~StorageBuffer() = default;
@@ -409,12 +437,7 @@ void StorageBuffer::createGpuBuffer(vkapi::VkDriver& driver, size_t size) noexce
 {
     ASSERT_FATAL(!elements_.empty(), "This storage buffer has no elements added.");
     ASSERT_LOG(size > 0);
-
-    if (size > currentGpuBufferSize_)
-    {
-        vkHandle_ = driver.addUbo(size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
-        currentGpuBufferSize_ = size;
-    }
+    createGpuBuffers(driver, size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
 }
 
 void StorageBuffer::createGpuBuffer(vkapi::VkDriver& driver) noexcept
@@ -424,11 +447,7 @@ void StorageBuffer::createGpuBuffer(vkapi::VkDriver& driver) noexcept
 
 void StorageBuffer::mapGpuBuffer(vkapi::VkDriver& driver, void* data, size_t size) noexcept
 {
-    vkapi::Buffer* buffer = vkHandle_.getResource();
-    ASSERT_FATAL(
-        buffer, "Buffer is nullptr - have you created the buffer before trying to map data?");
-    // buffer->mapAndCopyToGpu(driver, size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, data);
-    buffer->mapToGpuBuffer(data, size);
+    mapToFrameBuffer(driver, data, size);
 }
 
 void StorageBuffer::mapGpuBuffer(vkapi::VkDriver& driver, void* data) noexcept
@@ -439,7 +458,7 @@ void StorageBuffer::mapGpuBuffer(vkapi::VkDriver& driver, void* data) noexcept
 
 BufferBase::BackendBufferParams StorageBuffer::getBufferParams(vkapi::VkDriver& driver) noexcept
 {
-    return {vkHandle_.getResource()->get(), accumSize_, set_, binding_, bufferTypeFromSet(set_)};
+    return UniformBuffer::getBufferParams(driver);
 }
 
 } // namespace yave
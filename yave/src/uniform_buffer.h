@@ -28,6 +28,7 @@
 #include "vulkan-api/driver.h"
 #include "vulkan-api/resource_cache.h"
 
+#include <array>
 #include <string>
 #include <vector>
 
@@ -38,9 +39,13 @@ class IEngine;
 class BufferBase
 {
 public:
+    // Buffers which are updated by the CPU each frame have a buffer per
+    // frame in flight. Single buffered resources use the same buffer for all frames.
+    using FrameBuffers = std::array<vk::Buffer, vkapi::FrameContext::MaxFramesInFlight>;
+
     struct BackendBufferParams
     {
-        vk::Buffer buffer;
+        FrameBuffers buffers;
         size_t size = 0;
         uint32_t set = 0;
         uint32_t binding = 0;
@@ -126,6 +131,11 @@ public:
 
     BackendBufferParams getBufferParams(vkapi::VkDriver& driver) noexcept override;
 
+protected:
+    void createGpuBuffers(vkapi::VkDriver& driver, size_t size, VkBufferUsageFlags usage);
+
+    void mapToFrameBuffer(vkapi::VkDriver& driver, void* data, size_t size) noexcept;
+
 protected:
     std::string memberName_;
     std::string aliasName_;
@@ -135,7 +145,10 @@ protected:
 
     // =========== vulkan backend ============
 
-    vkapi::BufferHandle vkHandle_;
+    // The number of gpu buffers - either one per frame in flight, or
+    // a single buffer for resources written by the GPU.
+    uint32_t bufferCount_;
+    std::array<vkapi::BufferHandle, vkapi::FrameContext::MaxFramesInFlight> vkHandles_;
 };
 
 class StorageBuffer : public UniformBuffer
@@ -147,12 +160,16 @@ public:
         ReadWrite,
     };
 
+    // Storage buffers are single buffered by default as they are usually written
+    // by the GPU. If the buffer is updated by the CPU each frame, it should be
+    // created with perFrame set to true.
     StorageBuffer(
         AccessType type,
         uint32_t set,
         uint32_t binding,
         const std::string& memberName,
-        const std::string& aliasName);
+        const std::string& aliasName,
+        bool perFrame = false);
 
     ~StorageBuffer() override;
 
@@ -16,4 +16,17 @@ void VertexBuffer::build(Engine* engine, uint32_t vertexCount, void* vertexData)
         static_cast<IEngine*>(engine)->driver(), vertexCount, vertexData);
 }
 
+void VertexBuffer::build(
+    Engine* engine, uint32_t vertexSize, const std::function<void(void*)>& fillFunc)
+{
+    static_cast<IVertexBuffer*>(this)->build(
+        static_cast<IEngine*>(engine)->driver(), vertexSize, fillFunc);
+}
+
+void VertexBuffer::setPositionDequantisation(
+    const mathfu::vec3& offset, const mathfu::vec3& scale)
+{
+    static_cast<IVertexBuffer*>(this)->setPositionDequantisation(offset, scale);
+}
+
 } // namespace yave
\ No newline at end of file
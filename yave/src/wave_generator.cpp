@@ -0,0 +1,17 @@
+#include "private/wave_generator.h"
+
+namespace yave
+{
+
+bool WaveGenerator::sampleDisplacement(
+    const mathfu::vec2* positions, size_t count, mathfu::vec3* out)
+{
+    return static_cast<IWaveGenerator*>(this)->sampleDisplacement(positions, count, out);
+}
+
+WaveGenerator::QueryStats WaveGenerator::getQueryStats()
+{
+    return static_cast<IWaveGenerator*>(this)->getQueryStats();
+}
+
+} // namespace yave